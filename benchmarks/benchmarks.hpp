@@ -0,0 +1,34 @@
+#ifndef MANGANESE_BENCHMARKS_BENCHMARKS_HPP
+#define MANGANESE_BENCHMARKS_BENCHMARKS_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <span>
+#include <string>
+
+#include "benchrunner.hpp"
+
+namespace Manganese {
+namespace benchmarks {
+
+/**
+ * @brief Time lexing, parsing and analyzing `source`, naming each benchmark after its phase under `prefix` (e.g.
+ * "nesting/1M/parser/parse")
+ */
+void runPhaseBenchmarks(BenchRunner& runner, const std::string& prefix, const std::string& source);
+
+void runFrontendBenchmarks(BenchRunner& runner);
+
+/**
+ * @brief Time each phase on a generated program of every shape at each of `sizes` (in bytes), to show how the
+ * compiler scales with the size of its input, and with what the input is made of
+ * @details A program of many modules is compiled as a whole, one file at a time (to measure the work rather than how
+ * well it parallelizes)
+ * @param depth See GeneratorOptions::depth
+ */
+void runScalingBenchmarks(BenchRunner& runner, std::span<const size_t> sizes, size_t depth);
+
+}  // namespace benchmarks
+}  // namespace Manganese
+
+#endif  // MANGANESE_BENCHMARKS_BENCHMARKS_HPP
@@ -0,0 +1,105 @@
+#include "benchrunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <core.hpp>
+#include <driver/build_cache.hpp>
+#include <format>
+#include <functional>
+#include <io/logging.hpp>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace benchmarks {
+
+namespace {
+
+// Items per second, or 0 for a benchmark too quick to time
+double rate(double amount, double seconds) noexcept { return seconds > 0 ? amount / seconds : 0; }
+
+std::string escapeJSON(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') { escaped += '\\'; }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}  // namespace
+
+double BenchResult::percentile(double percent) const noexcept {
+    if (seconds.empty()) { return 0; }
+    const double rank = std::ceil(percent / 100 * static_cast<double>(seconds.size()));
+    const size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return seconds[std::min(index, seconds.size() - 1)];
+}
+
+void BenchRunner::run(const std::string& name, const std::string& unit, const std::function<void()>& setup,
+                      const std::function<Work()>& body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) { return; }
+    BenchResult result{.name = name, .unit = unit, .work = {}, .seconds = {}};
+    for (size_t i = 0; i < options.warmup; ++i) {
+        setup();
+        result.work = body();
+    }
+    result.seconds.reserve(options.repetitions);
+    for (size_t i = 0; i < options.repetitions; ++i) {
+        setup();
+        const auto start = std::chrono::steady_clock::now();
+        result.work = body();
+        const auto end = std::chrono::steady_clock::now();
+        result.seconds.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    std::ranges::sort(result.seconds);
+    results.push_back(std::move(result));
+}
+
+void BenchRunner::printSummary(std::ostream& output) const {
+    output << PINK
+           << std::format("{:<34} {:>12} {:>12} {:>20} {:>10}", "Benchmark", "Median", "p99", "Throughput", "MB/s")
+           << RESET << '\n';
+    for (const BenchResult& result : results) {
+        const double median = result.median();
+        const std::string throughput
+            = std::format("{:.3g} {}/s", rate(static_cast<double>(result.work.items), median), result.unit);
+        const std::string megabytes
+            = result.work.bytes ? std::format("{:.1f}", rate(static_cast<double>(result.work.bytes), median) / 1e6)
+                                : std::string("-");
+        output << std::format("{:<34} {:>10.3f}ms {:>10.3f}ms {:>20} {:>10}", result.name, median * 1e3,
+                              result.percentile(99) * 1e3, throughput, megabytes)
+               << '\n';
+    }
+}
+
+void BenchRunner::writeJSON(std::ostream& output) const {
+    output << "{\n";
+    output << std::format("  \"compiler_version\": \"{}\",\n", driver::BuildCache::COMPILER_VERSION);
+    output << std::format("  \"warmup\": {},\n  \"repetitions\": {},\n", options.warmup, options.repetitions);
+    output << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        const double median = result.median();
+        const double mean = result.seconds.empty()
+            ? 0
+            : std::accumulate(result.seconds.begin(), result.seconds.end(), 0.0)
+                / static_cast<double>(result.seconds.size());
+        output << (i ? ",\n" : "\n") << "    {";
+        output << std::format("\"name\": \"{}\", \"unit\": \"{}\", \"bytes\": {}, \"items\": {}, ",
+                              escapeJSON(result.name), escapeJSON(result.unit), result.work.bytes, result.work.items);
+        output << std::format("\"median_ns\": {:.0f}, \"p99_ns\": {:.0f}, \"min_ns\": {:.0f}, \"mean_ns\": {:.0f}, ",
+                              median * 1e9, result.percentile(99) * 1e9, result.percentile(0) * 1e9, mean * 1e9);
+        output << std::format("\"items_per_second\": {:.0f}, \"bytes_per_second\": {:.0f}}}",
+                              rate(static_cast<double>(result.work.items), median),
+                              rate(static_cast<double>(result.work.bytes), median));
+    }
+    output << "\n  ]\n}\n";
+}
+
+}  // namespace benchmarks
+}  // namespace Manganese
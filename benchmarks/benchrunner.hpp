@@ -0,0 +1,70 @@
+#ifndef MANGANESE_BENCHMARKS_BENCH_RUNNER_HPP
+#define MANGANESE_BENCHMARKS_BENCH_RUNNER_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace benchmarks {
+
+struct BenchOptions {
+    size_t warmup = 3;  // Untimed runs before the timed ones, to warm caches, the allocator and the branch predictors
+    size_t repetitions = 25;
+    std::string filter;  // Only run benchmarks whose name contains this (empty: all of them)
+};
+
+// What one run of a benchmark processed, from which its throughput is worked out
+struct Work {
+    size_t bytes = 0;  // Of source, if there is any
+    size_t items = 0;  // Tokens, nodes, lookups, ... (see BenchResult::unit)
+};
+
+struct BenchResult {
+    std::string name;
+    std::string unit;  // What the items are
+    Work work;
+    std::vector<double> seconds;  // Of each timed run, sorted
+
+    double median() const noexcept { return percentile(50); }
+    // Nearest-rank, so the 99th percentile of fewer than 100 runs is the slowest of them
+    double percentile(double percent) const noexcept;
+};
+
+/**
+ * @brief Times benchmarks and reports them, as a table for people and as JSON for tracking regressions
+ * @details Each benchmark is run a few times untimed, then once per repetition, timing each run on its own with a
+ * steady clock. The median is what to compare between builds; the 99th percentile shows how noisy the machine was.
+ */
+class BenchRunner {
+   private:
+    BenchOptions options;
+    std::vector<BenchResult> results;
+
+   public:
+    explicit BenchRunner(BenchOptions options_) : options(std::move(options_)) {}
+
+    /**
+     * @brief Time `body`, unless the filter excludes `name`
+     * @param setup Run (untimed) before every run of `body`, e.g. to parse the program it analyzes
+     * @param body Returns what it processed, which must be the same every run
+     */
+    void run(const std::string& name, const std::string& unit, const std::function<void()>& setup,
+             const std::function<Work()>& body);
+    void run(const std::string& name, const std::string& unit, const std::function<Work()>& body) {
+        run(name, unit, [] {}, body);
+    }
+
+    void printSummary(std::ostream& output) const;
+    void writeJSON(std::ostream& output) const;
+    const std::vector<BenchResult>& benchmarks() const noexcept { return results; }
+};
+
+}  // namespace benchmarks
+}  // namespace Manganese
+
+#endif  // MANGANESE_BENCHMARKS_BENCH_RUNNER_HPP
@@ -0,0 +1,172 @@
+#include <array>
+#include <core.hpp>
+#include <cstddef>
+#include <format>
+#include <frontend/ast/flat_ast.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/semantic.hpp>
+#include <frontend/semantic/symbol_table.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <memory>
+#include <mnstl/chunk_allocator.hxx>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "benchrunner.hpp"
+#include "program_generator.hpp"
+
+namespace Manganese {
+namespace benchmarks {
+
+namespace {
+
+constexpr size_t CORPUS_BYTES = 900 << 10;
+constexpr size_t SYMBOLS = 4096;  // Declared in the symbol table benchmark (a big module's worth)
+constexpr size_t LOOKUPS = 1 << 20;
+constexpr size_t INTERNED_TYPES = 1 << 16;
+
+// Nodes in the program `source` parses to (which every parse of it produces again)
+size_t countNodes(const std::string& source) {
+    mnstl::chunk_allocator arena;
+    parser::Parser parser(source, lexer::Mode::String, arena);
+    parser::ParsedFile file = parser.parse();
+    return ast::flat::Tree::build(file.program).size();
+}
+
+void benchmarkLexer(BenchRunner& runner, const std::string& name, const std::string& source) {
+    runner.run(name, "tokens", [&] {
+        lexer::Lexer lexer(source, lexer::Mode::String);
+        return Work{.bytes = source.size(), .items = lexer.tokenizeAll().size()};
+    });
+}
+
+void benchmarkParser(BenchRunner& runner, const std::string& name, const std::string& source) {
+    const size_t nodes = countNodes(source);
+    runner.run(name, "nodes", [&] {
+        mnstl::chunk_allocator arena;
+        parser::Parser parser(source, lexer::Mode::String, arena);
+        parser::ParsedFile file = parser.parse();
+        return Work{.bytes = source.size(), .items = file.hasError ? 0 : nodes};
+    });
+}
+
+void benchmarkTypeInterning(BenchRunner& runner) {
+    // Mostly types interned already (as in a real program, which uses the same few types over and over)
+    std::unique_ptr<mnstl::chunk_allocator> arena;
+    std::unique_ptr<semantic::TypeContext> types;
+    runner.run(
+        "types/intern", "types",
+        [&] {
+            types.reset();
+            arena = std::make_unique<mnstl::chunk_allocator>();
+            types = std::make_unique<semantic::TypeContext>(*arena);
+        },
+        [&] {
+            using enum ast::PrimitiveType_t;
+            constexpr std::array primitives = {i8, i16, i32, i64, u8, u16, u32, u64, f32, f64, boolean, character};
+            size_t distinct = 0;  // Keeps the loop from being optimized away
+            const semantic::SemanticType* previous = nullptr;
+            for (size_t i = 0; i < INTERNED_TYPES; ++i) {
+                const semantic::SemanticType* base = types->getPrimitive(primitives[i % primitives.size()]);
+                const semantic::SemanticType* type = nullptr;
+                switch (i % 3) {
+                    case 0: type = types->getPointer(base, (i & 8) != 0); break;
+                    case 1: type = types->getArray(base, i % 64); break;
+                    case 2:
+                        type = types->getFunction({{.isMutable = false, .type = base},
+                                                   {.isMutable = true, .type = previous ? previous : base}},
+                                                  base);
+                        break;
+                }
+                distinct += type != previous;
+                previous = type;
+            }
+            return Work{.bytes = 0, .items = distinct ? INTERNED_TYPES : 0};
+        });
+}
+
+void benchmarkSymbolLookup(BenchRunner& runner) {
+    std::vector<semantic::atom_t> names;
+    names.reserve(SYMBOLS);
+    for (size_t i = 0; i < SYMBOLS; ++i) {
+        names.push_back(lexer::identifierPool().intern(std::format("symbol{}", i)));
+    }
+
+    // Globals, with a few nested scopes above them (as inside a function body), looked up from the innermost
+    std::unique_ptr<mnstl::chunk_allocator> arena;
+    std::unique_ptr<semantic::SymbolTable> table;
+    runner.run(
+        "symbols/lookup", "lookups",
+        [&] {
+            table.reset();
+            arena = std::make_unique<mnstl::chunk_allocator>();
+            table = std::make_unique<semantic::SymbolTable>(*arena);
+            for (size_t i = 0; i < SYMBOLS; ++i) {
+                if (i % 1024 == 0) { table->enterScope(); }
+                DISCARD(table->declare(names[i], semantic::Symbol{.type = nullptr,
+                                                                  .node = nullptr,
+                                                                  .kind = semantic::SymbolKind::Variable,
+                                                                  .visibility = ast::Visibility::Private,
+                                                                  .isMutable = false}));
+            }
+        },
+        [&] {
+            size_t found = 0;
+            for (size_t i = 0; i < LOOKUPS; ++i) {
+                // A stride coprime to the table's size, so successive lookups land in different places
+                found += table->lookup(names[(i * 2654435761u) % SYMBOLS]) != nullptr;
+            }
+            return Work{.bytes = 0, .items = found};
+        });
+}
+
+void benchmarkAnalyzer(BenchRunner& runner, const std::string& name, const std::string& source) {
+    const size_t nodes = countNodes(source);
+    // The parser stays alive while its program is analyzed, since the AST refers to lexemes its lexer owns
+    std::unique_ptr<mnstl::chunk_allocator> arena;
+    std::unique_ptr<parser::Parser> parser;
+    std::optional<parser::ParsedFile> file;
+    std::ostringstream diagnostics;  // Discarded: the program analyzes cleanly, so only internal notes end up here
+    runner.run(
+        name, "nodes",
+        [&] {
+            file.reset();
+            parser.reset();
+            arena = std::make_unique<mnstl::chunk_allocator>();
+            parser = std::make_unique<parser::Parser>(source, lexer::Mode::String, *arena);
+            file = parser->parse();
+        },
+        [&] {
+            logging::DiagnosticCapture capture(diagnostics);
+            semantic::analyzer analyzer(*file, *arena);
+            const Result result = analyzer.analyze();
+            diagnostics.str({});
+            return Work{.bytes = source.size(), .items = result == Result::Success ? nodes : 0};
+        });
+}
+
+}  // namespace
+
+void runPhaseBenchmarks(BenchRunner& runner, const std::string& prefix, const std::string& source) {
+    benchmarkLexer(runner, prefix + "lexer/tokenize", source);
+    benchmarkParser(runner, prefix + "parser/parse", source);
+    benchmarkAnalyzer(runner, prefix + "semantic/analyze", source);
+}
+
+void runFrontendBenchmarks(BenchRunner& runner) {
+    const std::string source
+        = generateProgram({.shape = Shape::Functions, .bytes = CORPUS_BYTES, .depth = 0}).front().source;
+    benchmarkLexer(runner, "lexer/tokenize", source);
+    benchmarkParser(runner, "parser/parse", source);
+    benchmarkTypeInterning(runner);
+    benchmarkSymbolLookup(runner);
+    benchmarkAnalyzer(runner, "semantic/analyze", source);
+}
+
+}  // namespace benchmarks
+}  // namespace Manganese
@@ -0,0 +1,156 @@
+#include "program_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <core.hpp>
+#include <cstddef>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace benchmarks {
+
+namespace {
+
+constexpr size_t FUNCTIONS_PER_MODULE = 8;
+constexpr size_t ROWS_PER_LITERAL = 8;
+
+constexpr std::array SHAPE_NAMES = {"functions", "nesting", "expressions", "literals", "modules"};
+
+// Each appends one function (the unit programs of its shape grow by), the `i`th in its file. Their numbers are never
+// 0, which the lexer takes for a number with leading zeros (and warns about)
+void appendFunction(std::string& source, size_t i) {
+    source += std::format(
+        "/* Function {0}: loops, branches, a call, and arithmetic on every kind of literal */\n"
+        "func f{0}(a: mut int32, b: mut int32, scale: float64) -> int32 {{\n"
+        "    while (b > 1) {{ a = a * 3 + b % 7; b = b - 1; }}\n"
+        "    while (a <= 0b1010) {{ a += b ^ 0o17; }}\n"
+        "    if (a < {1} && b != 2) {{ return a; }} elif (a >= 0xFF || b == 3) {{ return a // 2; }}\n"
+        "    'c'; \"text {0}\\n\"; scale * 2.5e-3; true; f{2}(a, b, scale);\n"
+        "    return (a as float64 * scale) as int32;\n"
+        "}}\n",
+        i, (i * 37) % 1000 + 1, i ? i - 1 : 0);
+}
+
+void appendNesting(std::string& source, size_t i, size_t depth) {
+    source += std::format("func f{}(a: mut int32, b: mut int32) -> int32 {{\n", i);
+    for (size_t level = 0; level < depth; ++level) {
+        const std::string indent(4 * (level + 1), ' ');
+        switch (level % 3) {
+            case 0: source += std::format("{}if (a > {}) {{\n", indent, level + 1); break;
+            case 1: source += std::format("{}while (b < {}) {{\n", indent, level + 1); break;
+            case 2: source += std::format("{}{{\n", indent); break;
+        }
+        source += std::format("{}    a = a + {};\n", indent, level % 10 + 1);
+    }
+    source += std::format("{}b = b - 1;\n", std::string(4 * (depth + 1), ' '));
+    for (size_t level = depth; level-- > 0;) {
+        const std::string indent(4 * (level + 1), ' ');
+        // Give the ifs an else, so the parser has something to look for after every one of them
+        source += level % 3 == 0 ? std::format("{}}} else {{ b = b + 1; }}\n", indent) : std::format("{}}}\n", indent);
+    }
+    source += "    return a;\n}\n";
+}
+
+void appendExpression(std::string& source, size_t i, size_t depth) {
+    constexpr std::array operators = {" + ", " - ", " * ", " ^ ", " | ", " & "};
+    source += std::format("func f{}(a: int32, b: int32) -> int32 {{\n    a", i);
+    for (size_t term = 0; term < depth; ++term) {
+        source += operators[(term + i) % operators.size()];
+        switch (term % 4) {
+            case 0: source += std::format("{}", term % 100 + 1); break;
+            case 1: source += std::format("(b % {} - a)", term % 9 + 2); break;
+            case 2: source += "b << 2"; break;
+            case 3: source += std::format("(a // {}) * b", term % 7 + 1); break;
+        }
+    }
+    source += ";\n    return a;\n}\n";
+}
+
+void appendLiterals(std::string& source, size_t i, size_t depth) {
+    if (i % ROWS_PER_LITERAL == 0) {
+        constexpr std::array types = {"int32", "float64", "char", "bool", "uint8", "int64"};
+        source += std::format("aggregate A{} {{\n", i);
+        for (size_t field = 0; field < depth; ++field) {
+            source += std::format("    field{}: {};\n", field, types[field % types.size()]);
+        }
+        source += "}\n";
+    }
+    source += std::format("func f{}(a: int32) -> int32 {{\n", i);
+    for (size_t kind = 0; kind < 4; ++kind) {
+        source += "    [";
+        for (size_t row = 0; row < ROWS_PER_LITERAL; ++row) {
+            source += row ? ",\n     [" : "[";
+            for (size_t element = 0; element < depth; ++element) {
+                if (element) { source += ", "; }
+                const size_t value = (i * 31 + row * 7 + element) % 1000 + 1;
+                switch (kind) {
+                    case 0: source += std::format("{}", value); break;
+                    case 1: source += std::format("{}.{}", value, element % 10); break;
+                    case 2: source += std::format("'{}'", static_cast<char>('a' + value % 26)); break;
+                    case 3: source += std::format("\"s{}\"", value); break;
+                }
+            }
+            source += "]";
+        }
+        source += "];\n";
+    }
+    source += "    return a;\n}\n";
+}
+
+GeneratedFile generateModule(size_t i, size_t depth) {
+    GeneratedFile file{.name = std::format("m{}.mn", i), .source = std::format("module m{};\n", i)};
+    const size_t imports = std::min(depth, i);
+    for (size_t import = 1; import <= imports; ++import) { file.source += std::format("import m{};\n", i - import); }
+    for (size_t f = 0; f < FUNCTIONS_PER_MODULE; ++f) {
+        file.source += std::format("public func f{}(a: int32, b: int32) -> int32 {{\n", f);
+        // Between them, a module's functions call into every module it imports
+        for (size_t import = f + 1; import <= imports; import += FUNCTIONS_PER_MODULE) {
+            file.source += std::format("    m{}::f{}(a, b);\n", i - import, (f + import) % FUNCTIONS_PER_MODULE);
+        }
+        file.source += std::format("    return a * {} + b;\n}}\n", f + 1);
+    }
+    return file;
+}
+
+}  // namespace
+
+std::vector<GeneratedFile> generateProgram(const GeneratorOptions& options) {
+    std::vector<GeneratedFile> files;
+    if (options.shape == Shape::Modules) {
+        for (size_t i = 0, total = 0; total < options.bytes; ++i) {
+            files.push_back(generateModule(i, options.depth));
+            total += files.back().source.size();
+        }
+        return files;
+    }
+
+    std::string source = std::format("# A generated program ({} shape)\n", shapeName(options.shape));
+    source.reserve(options.bytes + options.bytes / 8);
+    for (size_t i = 0; source.size() < options.bytes; ++i) {
+        switch (options.shape) {
+            case Shape::Functions: appendFunction(source, i); break;
+            case Shape::Nesting: appendNesting(source, i, options.depth); break;
+            case Shape::Expressions: appendExpression(source, i, options.depth); break;
+            case Shape::Literals: appendLiterals(source, i, options.depth); break;
+            case Shape::Modules: ASSERT_UNREACHABLE("Modules are generated above");
+        }
+    }
+    source += "public func main() -> int32 { return 1; }\n";
+    files.push_back(GeneratedFile{.name = "program.mn", .source = std::move(source)});
+    return files;
+}
+
+std::optional<Shape> parseShape(std::string_view name) {
+    const auto* found = std::ranges::find(SHAPE_NAMES, name);
+    if (found == SHAPE_NAMES.end()) { return std::nullopt; }
+    return static_cast<Shape>(found - SHAPE_NAMES.begin());
+}
+
+std::string_view shapeName(Shape shape) noexcept { return SHAPE_NAMES[static_cast<size_t>(shape)]; }
+
+}  // namespace benchmarks
+}  // namespace Manganese
@@ -0,0 +1,54 @@
+#ifndef MANGANESE_BENCHMARKS_PROGRAM_GENERATOR_HPP
+#define MANGANESE_BENCHMARKS_PROGRAM_GENERATOR_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace benchmarks {
+
+// What a generated program is mostly made of, i.e. which part of the compiler it stresses
+enum class Shape {
+    Functions,  // Many small functions: loops, branches, a call and arithmetic on every kind of literal
+    Nesting,  // Functions whose blocks nest deeply
+    Expressions,  // Functions made of long chains of arithmetic
+    Literals,  // Big array literals, and aggregates with many fields
+    Modules,  // Many modules, each importing (and calling) the ones before it
+};
+
+struct GeneratorOptions {
+    Shape shape = Shape::Functions;
+    size_t bytes = 1 << 20;  // The program is at least this big (and at most one function or module bigger)
+    // How deep (or long) each construct gets: how deeply blocks nest, how many terms each expression chains, how many
+    // elements each row of an array literal has (and fields each aggregate has), or how many modules each imports.
+    // The compiler recurses on nested constructs, so tens of thousands of levels will overflow its stack
+    size_t depth = 64;
+};
+
+struct GeneratedFile {
+    std::string name;  // e.g. "m12.mn", for a program written out to a directory
+    std::string source;
+};
+
+/**
+ * @brief Generate a valid program of the given size and shape, the same every time for the same options, so results
+ * are comparable between builds
+ * @details Every shape but Modules is a single file. The programs lex, parse and analyze without errors; they steer
+ * clear of what the analyzer doesn't handle yet (such as `let` declarations and aggregate instantiations), so every
+ * part of them is actually checked
+ */
+std::vector<GeneratedFile> generateProgram(const GeneratorOptions& options);
+
+std::optional<Shape> parseShape(std::string_view name);
+std::string_view shapeName(Shape shape) noexcept;
+inline constexpr Shape ALL_SHAPES[] = {Shape::Functions, Shape::Nesting, Shape::Expressions, Shape::Literals,
+                                       Shape::Modules};
+
+}  // namespace benchmarks
+}  // namespace Manganese
+
+#endif  // MANGANESE_BENCHMARKS_PROGRAM_GENERATOR_HPP
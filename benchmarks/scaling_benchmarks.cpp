@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstddef>
+#include <driver/driver.hpp>
+#include <driver/options.hpp>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <io/diagnostics.hpp>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "benchrunner.hpp"
+#include "program_generator.hpp"
+
+namespace Manganese {
+namespace benchmarks {
+
+namespace {
+
+// A program split across modules can't be lexed or parsed as one, so it's compiled as a whole, one file at a time
+void benchmarkModules(BenchRunner& runner, const std::string& prefix, const std::vector<GeneratedFile>& files) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_bench_modules";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    driver::Options options{.inputs = {}, .jobs = 1, .moduleDirectory = {}, .cacheDirectory = {}, .output = {},
+                            .optimization = codegen::OptimizationLevel::O0, .run = false, .server = false,
+                            .serverSocket = {}, .timeReport = false, .trace = {},
+                            .diagnosticFormat = logging::DiagnosticFormat::Text, .showHelp = false};
+    size_t bytes = 0;
+    for (const GeneratedFile& file : files) {
+        const std::filesystem::path path = directory / file.name;
+        std::ofstream(path) << file.source;
+        options.inputs.push_back(path.string());
+        bytes += file.source.size();
+    }
+
+    runner.run(prefix + "driver/compile", "files", [&] {
+        std::ostringstream diagnostics;
+        const std::vector<driver::FileResult> results = driver::Driver(options).compile(diagnostics);
+        const bool compiled
+            = std::ranges::all_of(results, [](const driver::FileResult& r) { return r.result == Result::Success; });
+        return Work{.bytes = bytes, .items = compiled ? results.size() : 0};
+    });
+    std::filesystem::remove_all(directory);
+}
+
+std::string formatSize(size_t bytes) {
+    if (bytes >= (1 << 20) && bytes % (1 << 20) == 0) { return std::format("{}M", bytes >> 20); }
+    if (bytes >= (1 << 10) && bytes % (1 << 10) == 0) { return std::format("{}K", bytes >> 10); }
+    return std::format("{}", bytes);
+}
+
+}  // namespace
+
+void runScalingBenchmarks(BenchRunner& runner, std::span<const size_t> sizes, size_t depth) {
+    for (Shape shape : ALL_SHAPES) {
+        for (size_t size : sizes) {
+            const std::string prefix = std::format("{}/{}/", shapeName(shape), formatSize(size));
+            const std::vector<GeneratedFile> files
+                = generateProgram({.shape = shape, .bytes = size, .depth = depth});
+            if (shape == Shape::Modules) {
+                benchmarkModules(runner, prefix, files);
+            } else {
+                runPhaseBenchmarks(runner, prefix, files.front().source);
+            }
+        }
+    }
+}
+
+}  // namespace benchmarks
+}  // namespace Manganese
@@ -0,0 +1,9 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_CODEGEN_HPP
+#define MANGANESE_INCLUDE_BACKEND_CODEGEN_HPP
+
+#include <backend/codegen/ir_generator.hpp>
+#include <backend/codegen/jit.hpp>
+#include <backend/codegen/object_emitter.hpp>
+#include <backend/codegen/optimizer.hpp>
+
+#endif  // MANGANESE_INCLUDE_BACKEND_CODEGEN_HPP
@@ -0,0 +1,136 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_CODEGEN_IR_GENERATOR_HPP
+#define MANGANESE_INCLUDE_BACKEND_CODEGEN_IR_GENERATOR_HPP
+
+#include <backend/mir.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <memory>
+#include <mnstl/fold_result.hxx>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace codegen {
+
+/**
+ * @brief Lowers an analyzed file (one whose nodes carry their semantic types) to an LLVM module
+ * @details Each function is first lowered to the mid-level IR (see mir::Builder), which is already in SSA form and has
+ * been simplified by its own passes (see mir::optimize()), so it maps onto LLVM one instruction at a time. That leaves
+ * the pass pipeline (see optimize()) less to clean up, and the code from -O0 less naive: only the locals whose address
+ * is taken get a stack slot.
+ * One IRBuilder emits the whole module. Value names are only kept in debug builds (see
+ * llvm::LLVMContext::setDiscardValueNames()), so release builds don't allocate a string per instruction. Constructs
+ * the analyzer doesn't type yet (e.g. aggregates, generics and local variables) are reported as errors rather than
+ * lowered.
+ * @note The context must outlive the module
+ */
+class IRGenerator final {
+   private:
+    llvm::LLVMContext& context;
+    std::unique_ptr<llvm::Module> module;
+    llvm::IRBuilder<> builder;
+    parser::ParsedFile& parsedFile;
+
+    mir::FunctionTable functions;  // Every (non-generic) function in the file, by name
+    std::unordered_map<const ast::FunctionDeclarationStatement*, llvm::Function*> declarations;
+    bool hasError = false;
+
+    // The function being lowered
+    const mir::Function* currentBody = nullptr;
+    llvm::Function* currentFunction = nullptr;
+    std::vector<llvm::Value*> values;  // By instruction
+    std::vector<llvm::BasicBlock*> blocks;  // By block
+    llvm::DenseMap<llvm::BasicBlock*, mir::BlockId> origins;  // The block each LLVM block was lowered from
+    std::vector<std::pair<mir::ValueId, mir::BlockId>> phis;  // Given their operands once every block is lowered
+
+    /**
+     * @brief Declare every function first, so calls can refer to functions defined later in the file
+     * @param defined Whether each statement of the program is defined in this module. Only the module that defines a
+     * function reports a signature that can't be lowered, so a file split into partitions reports it once
+     * @param privatePrefix Empty to give private functions internal linkage. Otherwise they are defined in one
+     * partition and called from others, so they are hidden (not exported from the program) external symbols instead,
+     * named with this prefix so they don't clash with another file's private functions
+     */
+    Result declareFunctions(std::span<const uint8_t> defined, std::string_view privatePrefix);
+
+    // The LLVM type values of `type` have, or (after reporting why, if there is a node to report it on) nullptr
+    llvm::Type* lower(const semantic::SemanticType* type, const ast::ASTNode* node = nullptr);
+    llvm::AllocaInst* createEntryBlockAlloca(llvm::Type* type);
+
+    // Lower a function's body (in the mid-level IR) into its declaration
+    Result lowerFunction(const mir::Function& body, llvm::Function* declaration);
+    // The value of an instruction, or nullptr if it couldn't be lowered (after reporting why)
+    llvm::Value* lowerInstruction(mir::ValueId instruction);
+    Result lowerTerminator(mir::BlockId block);
+    llvm::Value* lowerConstant(const mnstl::fold_result_t& value, const semantic::SemanticType* type,
+                               const ast::ASTNode* node);
+
+    /**
+     * @brief Convert `value`, of type `from`, to type `to`
+     * @return The converted value, or nullptr if there is no such conversion between the types
+     */
+    llvm::Value* convert(llvm::Value* value, const semantic::SemanticType* from, const semantic::SemanticType* to);
+    // Whether `value` is non-zero, as an i1 (or nullptr, if it isn't a scalar)
+    llvm::Value* truthValue(llvm::Value* value);
+    llvm::Value* emitArithmetic(lexer::TokenType op, llvm::Value* lhs, llvm::Value* rhs,
+                                const semantic::SemanticType* type, const ast::ASTNode* node);
+    llvm::Value* emitComparison(lexer::TokenType op, llvm::Value* lhs, llvm::Value* rhs,
+                                const semantic::SemanticType* type, const ast::ASTNode* node);
+
+    Result unsupported(const ast::ASTNode* node, std::string_view what) noexcept {
+        logError(node, "Code generation for {} is not supported yet", what);
+        return Result::Failure;
+    }
+
+    template <class... Args>
+    void logError(const ast::ASTNode* node, std::format_string<Args...> message, Args&&... args) noexcept {
+        hasError = true;
+        logging::logError(node->getLocation(), message, std::forward<Args>(args)...);
+    }
+
+   public:
+    IRGenerator(parser::ParsedFile& file, llvm::LLVMContext& llvmContext, std::string_view moduleName);
+
+    IRGenerator(const IRGenerator&) = delete;
+    IRGenerator& operator=(const IRGenerator&) = delete;
+
+    /**
+     * @brief Lower the whole file
+     * @return The module, or nullptr if any construct couldn't be lowered or the module doesn't verify (after reporting
+     * why)
+     */
+    std::unique_ptr<llvm::Module> generate();
+
+    /**
+     * @brief Lower only some of the file's top-level statements, declaring the functions among the rest (which another
+     * module defines)
+     * @param statements Indices into the program of the statements to lower, in ascending order
+     * @param privatePrefix What to prefix private functions' symbols with (see declareFunctions()). Every partition of
+     * a file must be given the same one, and no two files the same one
+     * @details Lets a file be split into partitions that are lowered, optimized and emitted independently (each in its
+     * own context, on its own thread) and then linked back together
+     * @return The module, or nullptr if any construct couldn't be lowered or the module doesn't verify (after reporting
+     * why)
+     */
+    std::unique_ptr<llvm::Module> generate(std::span<const size_t> functions, std::string_view privatePrefix);
+};
+
+}  // namespace codegen
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_CODEGEN_IR_GENERATOR_HPP
@@ -0,0 +1,29 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_CODEGEN_JIT_HPP
+#define MANGANESE_INCLUDE_BACKEND_CODEGEN_JIT_HPP
+
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace Manganese {
+namespace codegen {
+
+/**
+ * @brief Run a program's `main` in this process, compiling it with an ORC JIT rather than linking an executable
+ * @details Each module (bitcode from emitCode(), one per file) is added to an llvm::orc::LLLazyJIT, which compiles a
+ * function to machine code only when it is first called. Calls go through stubs that compile their target and then
+ * jump straight to it, so starting a program costs as much as the code it actually runs, however big it is. The
+ * program can call anything the compiler itself links against (e.g. the C library).
+ * `main` must take nothing, and return an int32 or nothing (which exits with 0).
+ * @param level How hard the code generator works on each function it compiles (the IR was optimized when it was
+ * emitted)
+ * @return What `main` returned, or nothing if the program couldn't be loaded (after reporting why)
+ */
+std::optional<int> runMain(std::span<const std::string> modules, OptimizationLevel level);
+
+}  // namespace codegen
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_CODEGEN_JIT_HPP
@@ -0,0 +1,54 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_CODEGEN_OBJECT_EMITTER_HPP
+#define MANGANESE_INCLUDE_BACKEND_CODEGEN_OBJECT_EMITTER_HPP
+
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <frontend/parser.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace codegen {
+
+// Below this many functions per thread, splitting a file up costs more (a context, a module and a target per
+// partition) than compiling the partitions at the same time saves
+constexpr size_t MIN_FUNCTIONS_PER_PARTITION = 8;
+
+enum class CodeFormat : uint8_t {
+    Object,  // Native object files, to link
+    Bitcode  // Optimized LLVM bitcode, for the JIT to compile (see runMain())
+};
+
+struct EmitOptions {
+    CodeFormat format = CodeFormat::Object;
+    OptimizationLevel level = OptimizationLevel::O0;
+    size_t threads = 1;  // How many partitions a file's functions may be split into, each compiled on its own thread
+    // Made part of the symbols of the file's private functions, so they don't clash with another file's when linked
+    std::string_view privatePrefix = {};
+};
+
+/**
+ * @brief Lower an analyzed file to native object code for the host (or to bitcode)
+ * @details A file with enough functions is split into partitions of roughly equal size (by how many statements the
+ * functions span), one per thread, and each partition is lowered, optimized and emitted on its own thread, in its own
+ * llvm::LLVMContext (which isn't thread safe, so nothing is shared between them but the read-only AST). Each partition
+ * declares the functions it calls from the others, and the linker puts the pieces back together, as with ThinLTO's
+ * partitions (but without its cross-partition inlining: only functions in the same partition can be inlined).
+ * Diagnostics are buffered per partition and replayed in partition order, so the output doesn't depend on how the
+ * threads are scheduled.
+ * Bitcode is never partitioned, since the JIT splits modules up by function itself.
+ * @note The types the analysis left on the AST must still be alive
+ * @return One object file (or bitcode module) per partition, or nothing if the file couldn't be lowered or emitted
+ * (after reporting why)
+ */
+std::optional<std::vector<std::string>> emitCode(parser::ParsedFile& file, std::string_view moduleName,
+                                                 const EmitOptions& options);
+
+}  // namespace codegen
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_CODEGEN_OBJECT_EMITTER_HPP
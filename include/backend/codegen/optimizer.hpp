@@ -0,0 +1,40 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_CODEGEN_OPTIMIZER_HPP
+#define MANGANESE_INCLUDE_BACKEND_CODEGEN_OPTIMIZER_HPP
+
+#include <core.hpp>
+#include <cstdint>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+#include <optional>
+#include <string_view>
+
+namespace Manganese {
+namespace codegen {
+
+enum class OptimizationLevel : uint8_t {
+    O0,  // Only what the IR needs to be correct (e.g. always-inline functions)
+    O1,
+    O2,
+    O3,
+};
+
+/**
+ * @brief The level a command-line flag (`O0` to `O3`, without the dash) names, if any
+ */
+std::optional<OptimizationLevel> parseOptimizationLevel(std::string_view flag) noexcept;
+
+/**
+ * @brief Run LLVM's default pass pipeline for `level` over the module
+ * @details If a target machine is given, the passes can use what it knows about the target (e.g. the cost of
+ * instructions for the vectorizers); otherwise they make generic assumptions
+ */
+void optimize(llvm::Module& module, OptimizationLevel level, llvm::TargetMachine* target = nullptr);
+
+// How hard the code generator (instruction selection, scheduling and register allocation) works at `level`
+llvm::CodeGenOpt::Level codeGenLevel(OptimizationLevel level) noexcept;
+
+}  // namespace codegen
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_CODEGEN_OPTIMIZER_HPP
@@ -0,0 +1,8 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_MIR_HPP
+#define MANGANESE_INCLUDE_BACKEND_MIR_HPP
+
+#include <backend/mir/mir.hpp>
+#include <backend/mir/mir_builder.hpp>
+#include <backend/mir/passes.hpp>
+
+#endif  // MANGANESE_INCLUDE_BACKEND_MIR_HPP
@@ -0,0 +1,133 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_MIR_MIR_HPP
+#define MANGANESE_INCLUDE_BACKEND_MIR_MIR_HPP
+
+#include <core.hpp>
+#include <cstdint>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_type.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <limits>
+#include <llvm/ADT/SmallVector.h>
+#include <mnstl/fold_result.hxx>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace mir {
+
+using ValueId = uint32_t;  // An instruction, by its index in its function
+using BlockId = uint32_t;  // A block, by its index in its function
+constexpr inline ValueId NO_VALUE = std::numeric_limits<ValueId>::max();
+constexpr inline BlockId NO_BLOCK = std::numeric_limits<BlockId>::max();
+
+enum class Opcode : uint8_t {
+    Constant,  // constant
+    Zero,  // The zero (or null) value of its type
+    Parameter,  // The function's index-th parameter
+    Function,  // callee, as a value
+    Slot,  // A stack slot holding a value of its type (for a local whose address is taken)
+    AddressOf,  // The address of the slot operands[0]
+    Load,  // The value of its type at the address operands[0]
+    Store,  // Store operands[1] at the address operands[0]
+    Unary,  // operation operands[0]
+    Binary,  // operands[0] operation operands[1]: comparisons are in the operands' type, anything else in its own
+    Convert,  // operands[0] as its type
+    Call,  // callee(operands...)
+    Phi,  // operands[i] if the block was entered from its i-th predecessor
+};
+
+struct Instruction {
+    Opcode opcode;
+    lexer::TokenType operation{};
+    BlockId block = NO_BLOCK;  // NO_BLOCK once it has been removed
+    uint32_t index = 0;  // A parameter's
+    const semantic::SemanticType* type = nullptr;  // nullptr if it has no value (a store, or a call returning nothing)
+    llvm::SmallVector<ValueId, 2> operands = {};
+    mnstl::fold_result_t constant = {};  // A constant's value, which is always of its type
+    const ast::FunctionDeclarationStatement* callee = nullptr;
+    const ast::ASTNode* node = nullptr;  // What it was lowered from, to report problems lowering it further on
+};
+
+enum class TerminatorKind : uint8_t {
+    None,  // Not terminated yet (only while building)
+    Jump,  // Continue at successors[0]
+    Branch,  // Continue at successors[0] if value is true (or non-zero), else at successors[1]
+    Switch,  // Continue at successors[i + 1] if value is cases[i], else at successors[0]
+    JumpTable,  // Continue at successors[value - cases[0] + 1] if there is one, else at successors[0]
+    Return,  // Return value (or nothing, if it is NO_VALUE)
+};
+
+struct Terminator {
+    TerminatorKind kind = TerminatorKind::None;
+    ValueId value = NO_VALUE;
+    llvm::SmallVector<BlockId, 2> successors = {};  // A block can be more than one of them (e.g. a jump table's holes)
+    std::vector<mnstl::fold_result_t> cases = {};  // Of the type of value
+    const ast::ASTNode* node = nullptr;
+};
+
+struct Block {
+    std::string_view name;  // What kind of block it is (e.g. "while.cond"), to make the IR easier to read
+    std::vector<ValueId> instructions;  // In order, phis (and constants) first
+    std::vector<BlockId> predecessors;  // Each block with this as a successor, once, in the order of phis' operands
+    Terminator terminator;
+    bool isRemoved = false;
+};
+
+/**
+ * @brief One function in the mid-level IR, between the analyzed AST (see mir::Builder) and LLVM (see
+ * codegen::IRGenerator): basic blocks of instructions in SSA form, each value typed by the SemanticType of what it was
+ * lowered from
+ * @details Its own passes (see passes.hpp) do the optimizations that are cheap with the source's types and structure at
+ * hand, so LLVM is handed less code, and the code from -O0 is less naive.
+ * The first block is the entry, which holds every constant, so any block can use one. Passes replace an instruction by
+ * redirecting it to another value (see replace()), so operands are read through resolve() until compact() rewrites
+ * them, rather than each replacement searching for the instruction's uses.
+ */
+struct Function {
+    const ast::FunctionDeclarationStatement* declaration = nullptr;
+    std::vector<Instruction> instructions = {};
+    std::vector<Block> blocks = {};
+    std::vector<ValueId> replacements = {};  // What each instruction was replaced by, or NO_VALUE
+
+    BlockId addBlock(std::string_view name);
+    // Append an instruction to the end of `block` (or, for a phi or a constant, after the others like it)
+    ValueId add(BlockId block, Instruction instruction);
+
+    /**
+     * @brief Set the terminator of `block`, adding and removing the edges to its successors to match
+     * @details A successor `block` no longer branches to loses the operands its phis had for `block`, so the phis of a
+     * successor `block` becomes one of must be given operands for it afterwards
+     * @return Whether each successor gained `block` as a predecessor (false for those it already was one of)
+     */
+    llvm::SmallVector<bool, 2> setTerminator(BlockId block, Terminator terminator);
+
+    // Remove a block no other block branches to, with its instructions (whose values mustn't be used elsewhere)
+    void removeBlock(BlockId block);
+
+    // Replace every use of `value` with `with`, and remove `value`
+    void replace(ValueId value, ValueId with);
+    ValueId resolve(ValueId value) noexcept;
+    // Rewrite every operand through resolve(), and drop the removed instructions from their blocks
+    void compact();
+
+    // The blocks reachable from the entry, each before its successors (apart from the targets of back edges)
+    std::vector<BlockId> reversePostorder() const;
+
+    std::string toString() const;
+};
+
+// The position of `predecessor` among the predecessors of `block` (which it must be one of)
+size_t predecessorIndex(const Block& block, BlockId predecessor) noexcept;
+
+/**
+ * @brief A constant `value` as a constant of type `type` (see ast::foldCast())
+ * @return The converted value, or nothing if it isn't one (e.g. an arithmetic error) or couldn't be converted exactly
+ * the way the generated code would (a float outside of an integer type's range)
+ */
+mnstl::fold_result_t castConstant(const mnstl::fold_result_t& value, const semantic::SemanticType* type) noexcept;
+
+}  // namespace mir
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_MIR_MIR_HPP
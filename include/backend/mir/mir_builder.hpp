@@ -0,0 +1,172 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_MIR_MIR_BUILDER_HPP
+#define MANGANESE_INCLUDE_BACKEND_MIR_MIR_BUILDER_HPP
+
+#include <backend/mir/mir.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <mnstl/fold_result.hxx>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace mir {
+
+// The functions a body can call, by name
+using FunctionTable = std::unordered_map<std::string_view, ast::FunctionDeclarationStatement*>;
+
+class Builder;
+using _builder_base_t = ast::StaticVisitor<Builder, ValueId, Result, std::nullptr_t>;
+
+/**
+ * @brief Lowers the body of an analyzed function to the mid-level IR, in SSA form
+ * @details SSA is built in one walk over the body, since its structure says where control flow meets: each block is
+ * entered once every branch to it has been made, so a local's value there is the one value each predecessor left it
+ * with, or a phi of theirs. Only a loop's first block is entered before all of its predecessors are known (the back
+ * edges come at the end of the body), so it starts with a phi for every local, whose operands the back edges add. The
+ * phis that turn out to only ever have one value are removed by propagateConstants(). A local whose address is taken
+ * lives in a stack slot instead.
+ * Constant expressions are lowered to their folded value (see ast::Expression::fold()) rather than the operators making
+ * them up. Expressions lower to the value they produce (NO_VALUE if they couldn't be lowered), and statements to
+ * whether they could be. Constructs the analyzer doesn't type yet (e.g. aggregates, generics and local variables) are
+ * reported as errors rather than lowered.
+ */
+class Builder final : public _builder_base_t {
+   private:
+    friend _builder_base_t;  // Dispatches to the (protected) visit() overloads below
+
+    struct Local {
+        std::string_view name;  // Points into the AST
+        uint32_t variable;  // Which of `definitions` holds its value (if it isn't in a slot)
+        ValueId slot;  // NO_VALUE if it isn't in one
+        const semantic::SemanticType* type;
+    };
+
+    struct Loop {
+        BlockId continueTarget;  // NO_BLOCK for a switch outside of any loop
+        BlockId breakTarget;
+    };
+
+    // Where an assignment stores to: a local's SSA variable, or an address
+    struct Place {
+        const Local* local = nullptr;
+        ValueId address = NO_VALUE;
+    };
+
+    // What is known about a block while its function is built
+    struct BlockState {
+        std::vector<std::vector<ValueId>> incoming;  // Each predecessor's definitions, until the block is entered
+        std::vector<std::pair<uint32_t, ValueId>> phis;  // A loop header's phi for each variable
+        bool isEntered = false;
+    };
+
+    const FunctionTable& functions;
+    Function function;
+    std::vector<BlockState> states;  // By block
+    BlockId current = NO_BLOCK;  // NO_BLOCK where the code can't be reached
+    std::vector<ValueId> definitions;  // Each variable's value at the end of the current block (NO_VALUE if undefined)
+    std::vector<const semantic::SemanticType*> variableTypes;
+    std::vector<Local> locals;  // Innermost last
+    std::vector<size_t> scopes;  // How many locals were in scope when each enclosing block began
+    std::vector<Loop> loops;  // Innermost last (switch statements included, since they can be broken out of)
+    std::vector<std::string_view> addressTaken;  // The locals that need a slot
+    const semantic::SemanticType* returnType = nullptr;  // nullptr for void
+    bool hasError = false;
+
+    BlockId newBlock(std::string_view name);
+    // Append an instruction to the current block
+    ValueId emit(Instruction instruction);
+    ValueId constant(const mnstl::fold_result_t& value, const semantic::SemanticType* type, const ast::ASTNode* node);
+
+    /**
+     * @brief End the current block with `terminator`, after which the code is unreachable until a block is entered
+     * @details The current definitions flow into each successor (or, for a loop header, into its phis)
+     */
+    void terminate(Terminator terminator);
+    void jump(BlockId target);
+    void branch(ValueId condition, BlockId ifTrue, BlockId ifFalse, const ast::ASTNode* node);
+    // Continue in `block`, all of whose predecessors have been terminated
+    void enter(BlockId block);
+    // Continue in a loop's first block, which is given a phi for each variable for the back edges to come
+    void enterHeader(BlockId block);
+
+    uint32_t newVariable(const semantic::SemanticType* type, ValueId value);
+    const Local* lookupLocal(std::string_view name) const noexcept;
+
+    // The value of `expression`: its folded value if it is a constant, otherwise what its operators compute
+    ValueId lower(ast::Expression* expression);
+    /**
+     * @brief Convert `value` to type `to` (e.g. for an assignment or an argument)
+     * @return The converted value, or NO_VALUE if there is no such conversion between the types
+     */
+    ValueId convert(ValueId value, const semantic::SemanticType* to, const ast::ASTNode* node);
+    // Lower a condition (any scalar the analyzer accepted as one)
+    ValueId lowerCondition(ast::Expression* condition);
+    std::optional<Place> placeOf(ast::Expression* expression);
+    ValueId load(const Place& place, const semantic::SemanticType* type, const ast::ASTNode* node);
+    void store(const Place& place, ValueId value, const ast::ASTNode* node);
+    // `place += 1` (or -= 1, for Dec), returning the value before and after
+    std::pair<ValueId, ValueId> step(ast::Expression* place, lexer::TokenType op, const ast::Expression* node);
+    ValueId lowerComparison(ast::BinaryExpression* expression);
+    ValueId lowerShortCircuit(ast::BinaryExpression* expression);
+
+    Result unsupported(const ast::ASTNode* node, std::string_view what) noexcept {
+        logError(node, "Code generation for {} is not supported yet", what);
+        return Result::Failure;
+    }
+
+    template <class... Args>
+    void logError(const ast::ASTNode* node, std::format_string<Args...> message, Args&&... args) noexcept {
+        hasError = true;
+        logging::logError(node->getLocation(), message, std::forward<Args>(args)...);
+    }
+
+   protected:
+    using _builder_base_t::visit;
+
+#define STMT(name, str) stmtvisit_t visit(ast::name*);
+#define EXPR(name, str) exprvisit_t visit(ast::name*);
+#define TYPE(name, str) \
+    typevisit_t visit(ast::name*) { return nullptr; }  // Types are read from the analysis instead
+
+#include <frontend/ast/ast.def>
+
+#undef STMT
+#undef EXPR
+#undef TYPE
+
+    // Lower the statements of a block in a scope of their own, stopping at the first one that can't be reached
+    Result visit(ast::Block& block);
+
+   public:
+    explicit Builder(const FunctionTable& callable) noexcept : functions(callable) {}
+
+    Builder(const Builder&) = delete;
+    Builder& operator=(const Builder&) = delete;
+
+    /**
+     * @brief Lower a (non-generic) function
+     * @param declaration Must have been analyzed, with its types still alive
+     * @return The function, or nothing if any construct in it couldn't be lowered (after reporting why)
+     */
+    std::optional<Function> build(ast::FunctionDeclarationStatement* declaration);
+};
+
+/**
+ * @brief Whether there is a conversion from values of type `from` to type `to` (implicit or through a cast)
+ * @note Between types that are neither primitives nor pointers, this only means the two could lower to the same thing
+ */
+bool isConvertible(const semantic::SemanticType* from, const semantic::SemanticType* to) noexcept;
+
+}  // namespace mir
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_MIR_MIR_BUILDER_HPP
@@ -0,0 +1,52 @@
+#ifndef MANGANESE_INCLUDE_BACKEND_MIR_PASSES_HPP
+#define MANGANESE_INCLUDE_BACKEND_MIR_PASSES_HPP
+
+#include <backend/mir/mir.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Manganese {
+namespace mir {
+
+// The fewest cases a switch needs to be lowered to a jump table (fewer are about as fast as comparisons)
+constexpr inline size_t MIN_JUMP_TABLE_CASES = 4;
+// The largest jump table a switch is lowered to, so a few far apart cases don't make a huge one
+constexpr inline uint64_t MAX_JUMP_TABLE_SIZE = 4096;
+// The fewest cases per entry of the jump table (the rest of whose entries go to the default)
+constexpr inline double MIN_JUMP_TABLE_DENSITY = 0.4;
+
+/**
+ * @brief Fold the instructions whose operands are constants, and the branches on them, with the same folding the
+ * frontend uses (see ast::foldBinaryOperator()), so a constant has the same value at compile time and at run time
+ * @details Phis whose operands (apart from themselves) are all the same value are replaced with it, which removes the
+ * phis SSA construction gave a loop's locals that the loop never changes. A branch or switch on a constant becomes a
+ * jump to the one successor it takes. Operations whose result would be undefined (e.g. dividing by zero) are left for
+ * run time
+ * @return Whether anything was folded
+ */
+bool propagateConstants(Function& function);
+
+/**
+ * @brief Remove the blocks that can't be reached and the instructions whose values aren't used, and merge each block
+ * that only jumps to a block with no other predecessor with it
+ * @details Calls, stores and the values of terminators are live, and so is everything they use
+ * @return Whether anything was removed
+ */
+bool eliminateDeadCode(Function& function);
+
+/**
+ * @brief Lower each switch whose cases are dense enough (see MIN_JUMP_TABLE_DENSITY) to a jump table, indexed by the
+ * value being switched on less its smallest case
+ * @details Sparse switches are left for LLVM to lower to comparisons. A switch with no cases becomes a jump to its
+ * default
+ */
+void lowerSwitches(Function& function);
+
+// Run every pass over the function, until none of them changes it any more
+void optimize(Function& function);
+
+}  // namespace mir
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_BACKEND_MIR_PASSES_HPP
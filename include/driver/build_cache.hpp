@@ -0,0 +1,93 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_BUILD_CACHE_HPP
+#define MANGANESE_INCLUDE_DRIVER_BUILD_CACHE_HPP
+
+#include <atomic>
+#include <core.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <frontend/semantic/module_interface.hpp>
+#include <io/diagnostics.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utils/result.hpp>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief An on-disk cache of compiled files, so a file that hasn't changed is never lexed, parsed or analyzed again
+ * @details Entries are content-addressed: each is stored under a key derived from the file's contents, the hashes of
+ * the interfaces it imports (see interfaceHash()) and the compiler's version, so an entry can never be stale. Editing
+ * a file, or any module it depends on, gives it a new key rather than invalidating the old entry, and going back to an
+ * earlier version of the sources finds the earlier entries again.
+ * An entry records everything compiling the file produced: its result, its diagnostics (which are replayed on a hit)
+ * and its module interface. Later stages of the compiler add their output (e.g. object code) as more sections.
+ * Entries are written to a temporary file and renamed into place, so several builds can share one cache directory.
+ * @note Safe to use from several threads at once
+ */
+class BuildCache {
+   public:
+    constexpr static inline uint32_t FORMAT_VERSION = 2;
+    // Part of every key, so entries from another compiler never match. Bump it with any change to compiled output
+    constexpr static inline std::string_view COMPILER_VERSION = "0.1.0";
+    constexpr static inline std::string_view FILE_EXTENSION = ".mnc";
+
+    struct Entry {
+        Result result = Result::Success;
+        logging::DiagnosticList diagnostics;
+        std::optional<semantic::ModuleInterface> interface;  // If the file declares a module (and compiled)
+    };
+
+    struct Statistics {
+        size_t hits = 0, misses = 0;
+        size_t writeFailures = 0;  // Entries that couldn't be stored (which doesn't fail the build)
+    };
+
+   private:
+    std::filesystem::path directory;
+    std::atomic<size_t> hits = 0, misses = 0, writeFailures = 0;
+
+    std::filesystem::path entryPath(uint64_t key) const;
+
+   public:
+    // The directory is created if it doesn't exist (and if it can't be, every store() fails)
+    explicit BuildCache(const std::string& cacheDirectory);
+
+    /**
+     * @brief The key for a file whose interfaceHash() is `sourceHash`
+     */
+    static uint64_t key(uint64_t sourceHash);
+
+    /**
+     * @brief The entry stored under `key`, counted as a hit, or (as a miss) nothing if there isn't a valid one
+     */
+    std::optional<Entry> lookup(uint64_t key);
+
+    /**
+     * @brief Store what compiling a file produced under `key`, replacing any entry already there
+     * @details The diagnostics must be resolved (see logging::Diagnostic::resolve()), as compileFile()'s are
+     * @return Whether the entry was written
+     */
+    bool store(uint64_t key, Result result, const logging::DiagnosticList& diagnostics,
+               const semantic::ModuleInterface* interface);
+
+    Statistics statistics() const noexcept {
+        return Statistics{.hits = hits.load(std::memory_order_relaxed),
+                          .misses = misses.load(std::memory_order_relaxed),
+                          .writeFailures = writeFailures.load(std::memory_order_relaxed)};
+    }
+};
+
+/**
+ * @brief Replace the file at `path` with `contents`, which readers see all at once (or not at all)
+ * @details The contents are written beside `path` and then renamed over it, so a reader (even in another build) never
+ * sees a half-written file
+ * @return Whether the file was written
+ */
+bool writeAtomically(const std::filesystem::path& path, std::string_view contents);
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_BUILD_CACHE_HPP
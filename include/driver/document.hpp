@@ -0,0 +1,130 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_DOCUMENT_HPP
+#define MANGANESE_INCLUDE_DRIVER_DOCUMENT_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <frontend/ast.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/diagnostics.hpp>
+#include <mnstl/chunk_allocator.hxx>
+#include <mnstl/string_pool.hxx>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utils/result.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief A source file open in an editor, kept parsed and analyzed as it is edited, without redoing the whole file
+ * each time
+ * @details An edit only re-lexes and reparses the top-level statements it touches, and the one before them (whose
+ * parse can depend on what follows it, as an `if`'s does on an `else`). Every other statement keeps its AST, as do
+ * reparsed statements whose text turns out not to have changed. The whole file is parsed again instead if the edit is
+ * before the first statement (i.e. in the module declaration or imports), if the lexer reports anything about the
+ * edited text (e.g. a comment that's opened but runs past it), or if imports are added or removed.
+ * Statements that fail to parse are reparsed along with whatever the next edit touches, until they parse again, so
+ * their errors are always those of the latest text. While any statement has a syntax error, nothing is analyzed.
+ * Analysis keeps each function's check (see semantic::StatementCheck) while nothing it depends on changes: a function
+ * is only checked again if its text changed, or if it refers to a name that a changed statement declares (or did
+ * before the edit). A function refers to every name among its tokens.
+ */
+class Document {
+   public:
+    /**
+     * @brief Replace `length` bytes from `offset` with `text`
+     */
+    struct Edit {
+        size_t offset = 0;
+        size_t length = 0;
+        std::string_view text;
+    };
+
+    // How much work the updates so far have done, and how much they saved
+    struct Statistics {
+        size_t fullParses = 0;
+        size_t reparsedStatements = 0, reusedStatements = 0;
+        size_t checkedFunctions = 0, reusedChecks = 0;
+    };
+
+   private:
+    // What is known about each statement of the program (at the same index)
+    struct TopLevelStatement {
+        parser::StatementDiagnostics syntax;  // What parsing it reported
+        uint64_t hash = 0;  // Of its text, to tell whether a reparse changed it
+        std::vector<mnstl::string_pool::atom_t> declares;  // The names it declares
+        std::vector<mnstl::string_pool::atom_t> references;  // Every identifier in it (sorted)
+        bool isHeaderStatement = false;  // Whether it is a (misplaced) import or module declaration
+        // How far its text has moved since it was parsed, which the locations in its AST don't account for yet
+        ptrdiff_t shift = 0;
+        semantic::StatementCheck check;
+    };
+
+    std::string text;
+    uint32_t sourceId;  // The text's id in io::sourceMap(), which follows every edit rather than lexing adding more
+    mnstl::chunk_allocator astArena;  // Statements replaced by edits stay here until the next full parse
+    mnstl::chunk_allocator typeArena;
+    // Outlives every analysis, since the types analyses leave on reused statements point into it
+    semantic::TypeContext typeContext;
+    mnstl::chunk_allocator analysisArena;  // Reset for every analysis
+    parser::ParsedFile file;
+    std::vector<TopLevelStatement> statements;  // One per statement of file.program
+    // What the lexer and the file's header reported in the last full parse (reparses only go ahead if the lexer has
+    // nothing to report, and never touch the header)
+    logging::DiagnosticList lexerDiagnostics, headerDiagnostics;
+    bool lexerHasError = false, headerHasError = false;
+    logging::DiagnosticList declarationDiagnostics;  // What the last analysis reported before checking any statement
+    Result analysisResult = Result::Success;
+    Statistics stats;
+
+    // Lex and parse all of `text` again
+    void parseAll();
+    /**
+     * @brief Lex and parse text[begin, end), which starts with a statement, as statements only
+     * @return Whether the lexer had nothing to report about it (otherwise, nothing is parsed)
+     */
+    bool parseRange(size_t begin, size_t end, parser::ParsedFile& parsed,
+                    std::vector<TopLevelStatement>& parsedStatements);
+    // Record what the statements `parsed` from `tokens` (which ends at `end`) are, with what parsing each reported
+    std::vector<TopLevelStatement> describe(std::span<const lexer::Token> tokens, const parser::ParsedFile& parsed,
+                                            std::vector<parser::StatementDiagnostics>&& syntax, size_t end) const;
+    bool hasSyntaxError() const noexcept;
+    // Analyze the program (if it has no syntax errors), checking the statements whose checks are stale
+    void analyze();
+
+   public:
+    explicit Document(std::string source);
+    ~Document() noexcept;
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    /**
+     * @brief Apply an edit, then bring the AST and diagnostics up to date
+     * @note The edit must lie within the text
+     */
+    void edit(const Edit& change);
+
+    std::string_view source() const noexcept { return text; }
+    const parser::ParsedFile& parsed() const noexcept { return file; }
+    Statistics statistics() const noexcept { return stats; }
+
+    // Whether the current text compiles
+    Result result() const noexcept { return hasSyntaxError() ? Result::Failure : analysisResult; }
+
+    /**
+     * @brief Everything compiling the current text reports, sorted as compileFile() sorts it
+     */
+    logging::DiagnosticList diagnostics() const;
+};
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_DOCUMENT_HPP
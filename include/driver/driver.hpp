@@ -0,0 +1,174 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_DRIVER_HPP
+#define MANGANESE_INCLUDE_DRIVER_DRIVER_HPP
+
+#include <backend/codegen/object_emitter.hpp>
+#include <core.hpp>
+#include <cstdint>
+#include <driver/build_cache.hpp>
+#include <driver/options.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <io/diagnostics.hpp>
+#include <iosfwd>
+#include <mnstl/chunk_allocator.hxx>
+#include <mnstl/chunk_pool.hxx>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief The outcome of compiling one input file
+ */
+struct FileResult {
+    std::string path;
+    logging::DiagnosticList diagnostics;  // Everything reported while compiling the file (sorted, see sort())
+    Result result = Result::Success;
+    // The interface of the module the file declares, if it compiled (and declares one)
+    std::optional<semantic::ModuleInterface> interface;
+    std::vector<std::string> code;  // What it was lowered to, if it compiled and that was asked for (see emitCode())
+};
+
+/**
+ * @brief The hash recorded in the interface of the module in `path`, when compiled against (exactly) `imports`
+ * @details It covers the file's contents and the hashes of the interfaces it imports, which in turn cover their own
+ * imports, so an interface is only up to date if nothing the module depends on has changed either.
+ * @return The hash, or nothing if the file can't be read
+ */
+std::optional<uint64_t> interfaceHash(const std::string& path,
+                                      std::span<const semantic::ModuleInterface* const> imports);
+
+/**
+ * @brief Lexes, parses and analyzes a single file, capturing its diagnostics rather than printing them
+ * @param arena Holds the file's AST and semantic data. It is left as it was found, so one arena can serve many files
+ * @param imports The interfaces of modules the file may import, whose members it can then refer to. Importing a module
+ * that isn't among them is not an error, but its members are left unchecked
+ * @param hash The file's interfaceHash(), if the caller has already computed it
+ * @param emit If given, a file that analyzes cleanly is also lowered to native code (FileResult::code), and fails if
+ * it can't be. Its private functions' symbols are made unique to the file
+ */
+FileResult compileFile(const std::string& path, mnstl::chunk_allocator& arena,
+                       std::span<const semantic::ModuleInterface* const> imports = {},
+                       std::optional<uint64_t> hash = std::nullopt, const codegen::EmitOptions* emit = nullptr);
+
+/**
+ * @brief Compiles a set of files, several at a time, in an order that respects their imports
+ * @details Every file's header (its module declaration and imports) is parsed first, to build the ModuleGraph. A file
+ * is then compiled once every file it imports is done, so independent modules are compiled at the same time and a
+ * module's dependents start as soon as it finishes. Files in an import cycle fail without being compiled, as do files
+ * that import a module which failed.
+ * Each worker thread takes the earliest ready file, and compiles it into its own arena (drawn from a chunk pool shared
+ * by every worker, so memory freed by one file is reused by the next, whichever worker gets it). Diagnostics are
+ * written out file by file, in input order, as soon as every earlier file is done, so the output is the same however
+ * many jobs there are and however the files happen to be scheduled.
+ * Each module is compiled against the interfaces of the modules it imports: those compiled in this build, or else those
+ * given to useInterfaces() or found in the module directory. With a module directory, a module's own interface is
+ * written there once it compiles. A module
+ * whose interface there is up to date (see interfaceHash()) isn't compiled again, so its warnings aren't repeated.
+ * With a cache directory, every file is first looked up in a BuildCache, and a hit stands in for compiling the file
+ * (replaying its diagnostics). Misses are compiled and then stored, failures included.
+ * With an output file, every file is also lowered to native code, and run() links the objects into an executable (or,
+ * to run the program, to bitcode, which run() hands to the JIT). The threads not busy with a file of their own split a
+ * file's functions between them (see codegen::emitCode()), so a build of a single big file still uses every job.
+ * Neither the cache nor an up-to-date interface holds generated code, so such a build compiles every file (and doesn't
+ * store them in the cache either).
+ */
+class Driver {
+   private:
+    Options options;
+    std::optional<mnstl::chunk_pool> ownedPool;  // Empty if the arenas come from a pool that outlives the driver
+    mnstl::chunk_pool& pool;
+    std::optional<BuildCache> cache;  // If there is a cache directory
+    std::vector<const semantic::ModuleInterface*> knownInterfaces;
+
+    // Compile one input (which declares `module`, if it isn't empty), or reuse what an earlier build made of it
+    FileResult compileInput(const std::string& path, const std::string& module, mnstl::chunk_allocator& arena,
+                            std::span<const semantic::ModuleInterface* const> imports);
+
+    Driver(Options options_, mnstl::chunk_pool* sharedPool) :
+        options(std::move(options_)), pool(sharedPool ? *sharedPool : ownedPool.emplace()) {
+        if (!options.cacheDirectory.empty()) { cache.emplace(options.cacheDirectory); }
+    }
+
+   public:
+    explicit Driver(Options options_) : Driver(std::move(options_), nullptr) {}
+
+    /**
+     * @brief A driver whose arenas draw their memory from `sharedPool`, so that memory stays allocated (and warm) for
+     * whatever compiles next, e.g. the next request to a Server
+     */
+    Driver(Options options_, mnstl::chunk_pool& sharedPool) : Driver(std::move(options_), &sharedPool) {}
+
+    /**
+     * @brief Make the interfaces of modules compiled before (e.g. by an earlier request to a Server) importable, ahead
+     * of any in the module directory. Modules among the inputs are always compiled, whatever is given here
+     * @note The interfaces must outlive the driver
+     */
+    void useInterfaces(std::span<const semantic::ModuleInterface* const> interfaces) {
+        knownInterfaces.assign(interfaces.begin(), interfaces.end());
+    }
+
+    /**
+     * @brief Compile every input, writing each file's diagnostics to `output` (under a header naming the file) as soon
+     * as it and every input before it are done. With JSON diagnostics, they are all written once every file is done
+     * instead, as one document (see printResultsAsJson())
+     * @return The result for each input, in input order
+     */
+    std::vector<FileResult> compile(std::ostream& output);
+
+    /**
+     * @brief Compile every input, summarise the build, and link the executable if there is an output file (or run the
+     * program, with Options::run)
+     * @return The process exit code: 0 if every file compiled (and linked), 1 otherwise. A program that was run exits
+     * with what its main() returned
+     * @details The summary names how many files failed, and how many were found in the cache (if there is one)
+     */
+    int run(std::ostream& output);
+
+    /**
+     * @brief Link the objects of `results` (from compile(), every file of which compiled) into the output file, writing
+     * any error to `output`. Does nothing without an output file
+     */
+    Result link(const std::vector<FileResult>& results, std::ostream& output) const;
+
+    /**
+     * @brief Write the summary run() ends with, for `results` from compile() (nothing with JSON diagnostics, whose
+     * document says what failed already)
+     * @return The same exit code run() returns
+     */
+    int summarize(const std::vector<FileResult>& results, std::ostream& output) const;
+
+    // How many worker threads compile() uses for the current inputs
+    size_t workerCount() const noexcept;
+
+    // How many threads the build may use in all (Options::jobs, or one per hardware thread)
+    size_t jobCount() const noexcept;
+
+    // How the cache did so far (all zeros without a cache directory)
+    BuildCache::Statistics cacheStatistics() const noexcept {
+        return cache ? cache->statistics() : BuildCache::Statistics{};
+    }
+};
+
+/**
+ * @brief Write a file's diagnostics (if it has any) under a header naming the file, in a single write
+ */
+void printFileResult(const FileResult& file, std::ostream& output);
+
+/**
+ * @brief Write every file's result and diagnostics to `output` as one JSON document (and a newline), in a single write
+ * @details The document is `{"files": [...]}`, with an object per file: `{"path": ..., "result": "success" or
+ * "failure", "diagnostics": [...]}`. Each diagnostic is `{"level": ..., "line": ..., "column": ..., "message": ...}`,
+ * where the level is "warning", "error" or "critical", and the line and column are left out for a diagnostic about no
+ * place in particular. The message is plain text, without the colors the terminal output has
+ */
+void printResultsAsJson(std::span<const FileResult> results, std::ostream& output);
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_DRIVER_HPP
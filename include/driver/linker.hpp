@@ -0,0 +1,25 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_LINKER_HPP
+#define MANGANESE_INCLUDE_DRIVER_LINKER_HPP
+
+#include <core.hpp>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <utils/result.hpp>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief Link object files (their contents) into an executable
+ * @details The objects are written to a temporary directory (removed afterwards) and linked by the system's C compiler
+ * driver (`cc`, or whatever the `CC` environment variable names), which finds the linker and adds the C runtime that
+ * calls `main`. What the linker reports goes to standard error.
+ * @return Success, or Failure (after writing why to `diagnostics`)
+ */
+Result linkExecutable(std::span<const std::string> objects, const std::string& output, std::ostream& diagnostics);
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_LINKER_HPP
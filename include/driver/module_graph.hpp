@@ -0,0 +1,60 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_MODULE_GRAPH_HPP
+#define MANGANESE_INCLUDE_DRIVER_MODULE_GRAPH_HPP
+
+#include <core.hpp>
+#include <frontend/parser/parser_base.hpp>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief Which input files import which, built from their headers before any body is parsed
+ * @details File `i` depends on file `j` if one of `i`'s imports names the module `j` declares (an import's first path
+ * element is the module, the rest names something inside it). Imports of modules that aren't among the inputs add no
+ * edge, and files without a module declaration can't be imported.
+ * Files that are part of an import cycle, or that declare a module another input already declared, can't be ordered, so
+ * they are flagged with an error instead.
+ */
+class ModuleGraph {
+   public:
+    constexpr static inline size_t NO_FILE = std::numeric_limits<size_t>::max();
+
+   private:
+    struct Node {
+        std::vector<size_t> dependencies;  // Files this file imports, in input order
+        std::vector<size_t> dependents;  // Files that import this file, in input order
+        std::string error;  // Set if the file can't be scheduled
+    };
+    std::vector<Node> nodes;
+
+    void findCycles(std::span<const parser::FileHeader> headers);
+
+   public:
+    /**
+     * @brief Build the graph for `headers`, where headers[i] belongs to the i-th input file
+     */
+    explicit ModuleGraph(std::span<const parser::FileHeader> headers);
+
+    size_t size() const noexcept { return nodes.size(); }
+    std::span<const size_t> dependencies(size_t file) const noexcept { return nodes[file].dependencies; }
+    std::span<const size_t> dependents(size_t file) const noexcept { return nodes[file].dependents; }
+
+    // Why the file can't be compiled (e.g. the import cycle it is part of), or empty if nothing is wrong with it
+    const std::string& error(size_t file) const noexcept { return nodes[file].error; }
+
+    /**
+     * @brief The files grouped so that every file only depends on files in earlier groups
+     * @details The files in one wave are independent of each other, so they can all be compiled at once. Files with an
+     * error, and anything that (indirectly) depends on one, are left out.
+     */
+    std::vector<std::vector<size_t>> waves() const;
+};
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_MODULE_GRAPH_HPP
@@ -0,0 +1,53 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_OPTIONS_HPP
+#define MANGANESE_INCLUDE_DRIVER_OPTIONS_HPP
+
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <io/diagnostics.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief What the compiler was asked to do, as given on the command line
+ */
+struct Options {
+    std::vector<std::string> inputs;  // Source files, compiled (and reported) in this order
+    size_t jobs = 0;  // How many files to compile at once (0: one per hardware thread)
+    std::string moduleDirectory;  // Where module interfaces are read from and written to (empty: nowhere)
+    std::string cacheDirectory;  // Where the build cache is kept (empty: no cache)
+    std::string output;  // The executable to link the inputs into (empty: only check them)
+    codegen::OptimizationLevel optimization = codegen::OptimizationLevel::O0;
+    bool run = false;  // Run the program in a JIT instead of linking it (see codegen::runMain())
+    bool server = false;  // Serve compile requests (see Server) instead of compiling the inputs
+    std::string serverSocket;  // Where the server listens (empty: standard input and output)
+    bool timeReport = false;  // Print how long each phase took (see timing::printReport())
+    std::string trace;  // Where to write a trace of the build's phases on each thread (empty: don't trace it)
+    logging::DiagnosticFormat diagnosticFormat = logging::DiagnosticFormat::Text;  // How files' diagnostics are written
+    bool showHelp = false;
+};
+
+/**
+ * @brief Parse the command line (without the program name) into Options
+ * @return The options, or nothing (after printing why) if the command line is malformed
+ * @details Recognised flags are `-j N`, `-jN`, `--jobs N` and `--jobs=N`, `--module-dir DIR` and `--module-dir=DIR`,
+ * `--cache-dir DIR` and `--cache-dir=DIR`, `-o FILE`, `-O0` to `-O3`, `--run`, `--time-report`, `--trace FILE` and
+ * `--trace=FILE`, `--diagnostic-format text|json` and `--diagnostic-format=text|json`, `--server` and
+ * `--server=SOCKET`, and `-h`/`--help`. Anything else that starts with '-' is an error (as is giving both `-o` and
+ * `--run`), and everything else is an input file.
+ */
+std::optional<Options> parseArguments(std::span<const char* const> arguments);
+
+/**
+ * @brief The usage message printed by `--help` (and when there is nothing to compile)
+ */
+std::string usage(const char* programName);
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_OPTIONS_HPP
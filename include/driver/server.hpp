@@ -0,0 +1,68 @@
+#ifndef MANGANESE_INCLUDE_DRIVER_SERVER_HPP
+#define MANGANESE_INCLUDE_DRIVER_SERVER_HPP
+
+#include <core.hpp>
+#include <driver/options.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <iosfwd>
+#include <mnstl/chunk_pool.hxx>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+/**
+ * @brief A long-lived compiler process that serves compile requests, so each build doesn't pay for starting it over
+ * @details Whatever outlives one request stays warm for the next: the memory of the compile arenas (which are reset
+ * after every request, but draw from one chunk pool that keeps its blocks), the identifiers interned so far, and the
+ * interface of every module compiled so far (which later requests can import without compiling the module again).
+ * Before each request, a kept interface is checked against its file, and dropped if the file or anything it imports
+ * has changed since.
+ * The protocol is line-based. A request is one line holding the command-line arguments of a build, separated by tabs
+ * (so paths may contain spaces). Its response is a line holding the build's exit code and the size of its output,
+ * separated by a space, followed by exactly that many bytes of output (the diagnostics and summary the build would
+ * have written to stderr). An empty line (or the end of the input) ends the session, and the request `--shutdown`
+ * also stops the server.
+ */
+class Server {
+   private:
+    struct CachedInterface {
+        semantic::ModuleInterface interface;
+        std::string path;  // The file it was compiled from
+        std::vector<std::string> imports;  // The modules that file imports
+    };
+
+    mnstl::chunk_pool pool;
+    // The latest interface of each module compiled through this server, by module name
+    std::unordered_map<std::string, CachedInterface> interfaces;
+    bool stopped = false;
+
+    // The exit code and output for one request
+    int handle(std::string_view request, std::string& output);
+    // Forget the interfaces whose file, or any interface they were compiled against, has changed since
+    void dropStaleInterfaces();
+
+   public:
+    Server() = default;
+
+    /**
+     * @brief Answer the requests read from `in` on `out`, until the session ends (or `out` fails, e.g. because the
+     * client hung up)
+     * @return Whether the server should keep serving (i.e. the session didn't ask it to shut down)
+     */
+    bool serve(std::istream& in, std::ostream& out);
+
+    /**
+     * @brief Serve sessions, one connection at a time, on the Unix domain socket at `path` until one shuts it down
+     * @return The process exit code: 0 once shut down, or 1 (after saying why) if the socket couldn't be set up
+     */
+    int listen(const std::string& path);
+};
+
+}  // namespace driver
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_DRIVER_SERVER_HPP
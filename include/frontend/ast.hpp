@@ -5,6 +5,7 @@
 #include <frontend/ast/ast_expressions.hpp>
 #include <frontend/ast/ast_statements.hpp>
 #include <frontend/ast/ast_types.hpp>
+#include <frontend/ast/flat_ast.hpp>
 #include <frontend/ast/visitor_base.hpp>
 
 #endif  // MANGANESE_INCLUDE_FRONTEND_AST_HPP
@@ -3,19 +3,26 @@
 
 #include <core.hpp>
 #include <frontend/lexer.hpp>
+#include <io/source_map.hpp>
+#include <mnstl/chunk_allocator.hxx>
 #include <mnstl/fold_result.hxx>
 #include <string>
+#include <type_traits>
+#include <utils/time_report.hpp>
 #include <utils/type_names.hpp>
 #include <vector>
 
 #if MN_DEBUG
-#define MN_AST_DUMP void dump(std::ostream& os, size_t indent = 0) const override;
+#define MN_AST_DUMP                                                 \
+    using ASTNode::dump;                                            \
+    void dump(std::string& out, size_t indent = 0) const override;
 #else
 #define MN_AST_DUMP
 #endif
 
-#define MN_AST_STANDARD_INTERFACE                           \
-    std::string toString(size_t indent = 0) const override; \
+#define MN_AST_STANDARD_INTERFACE                                   \
+    using ASTNode::toString;                                        \
+    void toString(std::string& out, size_t indent = 0) const override; \
     MN_AST_DUMP
 
 namespace Manganese {
@@ -31,7 +38,7 @@ struct Expression;
 struct Statement;
 struct Type;
 
-using Block = std::vector<Statement*>;
+using Block = mnstl::arena_vector<Statement*>;  // Allocated from the parser's arena
 
 enum class ExpressionKind : uint8_t;
 enum class StatementKind : uint8_t;
@@ -63,10 +70,12 @@ enum class Visibility : uint8_t {
 
 struct ASTNode {
    protected:
-    size_t line = 0, column = 0;
+    io::SourceLocation location;
 
    public:
-    constexpr ASTNode() noexcept = default;
+    constexpr ASTNode() noexcept {
+        if (!std::is_constant_evaluated()) { timing::count(timing::Counter::Nodes); }
+    }
 
     ASTNode(const ASTNode&) = delete;
     ASTNode& operator=(const ASTNode&) = delete;
@@ -75,22 +84,57 @@ struct ASTNode {
 
     virtual ~ASTNode() noexcept = default;
 
-    virtual std::string toString(size_t indent = 0) const = 0;
+    std::string toString(size_t indent = 0) const {
+        std::string out;
+        toString(out, indent);
+        return out;
+    }
+
+    /**
+     * @brief Append this node's source form to `out`
+     * Nodes print their children into the same buffer, so printing a whole program takes time linear in its size.
+     */
+    virtual void toString(std::string& out, size_t indent = 0) const = 0;
 
-    constexpr size_t getLine() const noexcept { return line; }
-    constexpr size_t getColumn() const noexcept { return column; }
+    constexpr io::SourceLocation getLocation() const noexcept { return location; }
+    constexpr void setLocation(io::SourceLocation newLocation) noexcept { location = newLocation; }
+    size_t getLine() const { return io::sourceMap().resolve(location).line; }
+    size_t getColumn() const { return io::sourceMap().resolve(location).column; }
 
 #if MN_DEBUG
-    virtual void dump(std::ostream& os, size_t indentDepth = 0) const = 0;
+    void dump(std::ostream& os, size_t indentDepth = 0) const;  // Written to `os` in one go
+
+    /**
+     * @brief Append a description of this node and everything under it to `out`, for debugging
+     */
+    virtual void dump(std::string& out, size_t indentDepth = 0) const = 0;
 #endif  // MN_DEBUG
 };
 
 struct Expression : public ASTNode {
     const ExpressionKind kind;
+
+   private:
+    mutable bool _isFolded = false;
+    mutable mnstl::fold_result_t _folded;
+
+   public:
     const semantic::SemanticType* semanticType = nullptr;
 
     virtual ~Expression() noexcept = default;
-    virtual mnstl::fold_result_t fold() const noexcept { return mnstl::fold_result_t{}; }
+
+    /**
+     * @brief The constant value of this expression (Void if it isn't a constant)
+     * Each node is folded at most once: the first call folds the whole subtree bottom-up, without recursing, and every
+     * node remembers its value, so later calls (from the analyzer, codegen, or a parent's fold) are just a lookup.
+     * @note The value isn't recomputed, so an expression must not be changed after it has been folded
+     */
+    const mnstl::fold_result_t& fold() const noexcept;
+
+    /**
+     * @brief This node's value, given that its operands are already folded (only fold() should call this)
+     */
+    virtual mnstl::fold_result_t foldNode() const noexcept { return mnstl::fold_result_t{}; }
 
    protected:
     constexpr explicit Expression(ExpressionKind _kind) noexcept : kind(_kind) {}
@@ -142,6 +186,24 @@ inline std::string toStringOr(const Type* type, const char* fallback = "no type"
     return type ? type->toString() : fallback;
 }
 
+/**
+ * @brief Append the node's source form to `out`, or `fallback` if the node is a nullptr
+ */
+inline void toStringOr(std::string& out, const ASTNode* node, const char* fallback) {
+    if (node) {
+        node->toString(out);
+    } else {
+        out += fallback;
+    }
+}
+inline void toStringOr(std::string& out, const Expression* expression) {
+    toStringOr(out, expression, "unknown expression");
+}
+inline void toStringOr(std::string& out, const Statement* statement) {
+    toStringOr(out, statement, "unknown statement");
+}
+inline void toStringOr(std::string& out, const Type* type) { toStringOr(out, type, "no type"); }
+
 constexpr std::string_view primitiveTypeToString(PrimitiveType_t prim) {
     switch (prim) {
         case PrimitiveType_t::not_primitive: return "not primitive";
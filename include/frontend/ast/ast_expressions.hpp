@@ -48,9 +48,9 @@ struct AggregateInstantiationExpression final : public Expression {
  * @brief represents a sequence of elements of different types
  */
 struct AggregateLiteralExpression final : public Expression {
-    std::vector<Expression*> elements;
+    mnstl::arena_vector<Expression*> elements;
 
-    explicit AggregateLiteralExpression(std::vector<Expression*>&& _elements) noexcept :
+    explicit AggregateLiteralExpression(mnstl::arena_vector<Expression*>&& _elements) noexcept :
         Expression(ExpressionKind::AggregateLiteralExpression), elements(std::move(_elements)) {}
 
     MN_AST_STANDARD_INTERFACE;
@@ -68,11 +68,11 @@ struct AlignofExpression final : public Expression {
  * @brief e.g. [1, 2, 3]
  */
 struct ArrayLiteralExpression final : public Expression {
-    std::vector<Expression*> elements;
+    mnstl::arena_vector<Expression*> elements;
     Type* elementType;  // Optional, can be inferred from the elements
     Expression* lengthExpression = nullptr;
 
-    explicit ArrayLiteralExpression(std::vector<Expression*>&& _elements, Type* _elementType = nullptr) noexcept :
+    explicit ArrayLiteralExpression(mnstl::arena_vector<Expression*>&& _elements, Type* _elementType = nullptr) noexcept :
         Expression(ExpressionKind::ArrayLiteralExpression), elements(std::move(_elements)), elementType(_elementType) {}
 
     MN_AST_STANDARD_INTERFACE;
@@ -105,7 +105,7 @@ struct BinaryExpression final : public Expression {
 
     MN_AST_STANDARD_INTERFACE;
 
-    mnstl::fold_result_t fold() const noexcept override;
+    mnstl::fold_result_t foldNode() const noexcept override;
 };
 
 /**
@@ -119,7 +119,7 @@ struct BoolLiteralExpression final : public Expression {
 
     MN_AST_STANDARD_INTERFACE;
 
-    mnstl::fold_result_t fold() const noexcept override { return mnstl::fold_result_t{value}; }
+    mnstl::fold_result_t foldNode() const noexcept override { return mnstl::fold_result_t{value}; }
 };
 
 /**
@@ -135,7 +135,7 @@ struct CharLiteralExpression final : public Expression {
 
     MN_AST_STANDARD_INTERFACE;
 
-    mnstl::fold_result_t fold() const noexcept override { return mnstl::fold_result_t{value}; }
+    mnstl::fold_result_t foldNode() const noexcept override { return mnstl::fold_result_t{value}; }
 };
 
 /**
@@ -143,9 +143,9 @@ struct CharLiteralExpression final : public Expression {
  */
 struct FunctionCallExpression final : public Expression {
     Expression* callee;
-    std::vector<Expression*> arguments;
+    mnstl::arena_vector<Expression*> arguments;
 
-    FunctionCallExpression(Expression* _callee, std::vector<Expression*>&& _arguments) noexcept :
+    FunctionCallExpression(Expression* _callee, mnstl::arena_vector<Expression*>&& _arguments) noexcept :
         Expression(ExpressionKind::FunctionCallExpression), callee(_callee), arguments(std::move(_arguments)) {}
 
     MN_AST_STANDARD_INTERFACE;
@@ -213,7 +213,7 @@ struct NumberLiteralExpression final : public Expression {
 
     MN_AST_STANDARD_INTERFACE;
 
-    mnstl::fold_result_t fold() const noexcept override { return mnstl::fold_result_t{value}; }
+    mnstl::fold_result_t foldNode() const noexcept override { return mnstl::fold_result_t{value}; }
 };
 
 /**
@@ -227,7 +227,7 @@ struct PostfixExpression final : public Expression {
         Expression(ExpressionKind::PostfixExpression), left(_left), op(_op) {}
 
     MN_AST_STANDARD_INTERFACE;
-    mnstl::fold_result_t fold() const noexcept override;
+    mnstl::fold_result_t foldNode() const noexcept override;
 };
 
 /**
@@ -242,7 +242,7 @@ struct PrefixExpression final : public Expression {
 
     MN_AST_STANDARD_INTERFACE;
 
-    mnstl::fold_result_t fold() const noexcept override;
+    mnstl::fold_result_t foldNode() const noexcept override;
 };
 
 /**
@@ -279,7 +279,7 @@ struct StringLiteralExpression final : public Expression {
     //     Expression(ExpressionKind::StringLiteralExpression), value(_value) {};
 
     MN_AST_STANDARD_INTERFACE;
-    virtual mnstl::fold_result_t fold() const noexcept override { return mnstl::fold_result_t{value}; }
+    virtual mnstl::fold_result_t foldNode() const noexcept override { return mnstl::fold_result_t{value}; }
 };
 
 /**
@@ -295,6 +295,25 @@ struct TypeCastExpression final : public Expression {
     MN_AST_STANDARD_INTERFACE;
 };
 
+/**
+ * @brief The value of `left op right` for constant operands, or nothing if `op` doesn't apply to them (e.g. `true + 1`)
+ * @details Shared by folding and by compile-time evaluation (see semantic::ConstEvaluator), so the two agree. As in
+ * the generated code, `/` on two integers truncates
+ */
+mnstl::fold_result_t foldBinaryOperator(lexer::TokenType op, const mnstl::fold_result_t& left,
+                                        const mnstl::fold_result_t& right) noexcept;
+
+/**
+ * @brief The value of `op operand` for a constant operand, or nothing if `op` doesn't apply to it (e.g. `&1`)
+ */
+mnstl::fold_result_t foldPrefixOperator(lexer::TokenType op, const mnstl::fold_result_t& operand) noexcept;
+
+/**
+ * @brief The value of `value as target` for a constant value, or nothing if it can't be converted (e.g. a string to a
+ * number). not_primitive leaves the value as it is
+ */
+mnstl::fold_result_t foldCast(const mnstl::fold_result_t& value, PrimitiveType_t target) noexcept;
+
 }  // namespace ast
 
 }  // namespace Manganese
@@ -191,6 +191,7 @@ struct ReturnStatement final : public Statement {
 struct CaseClause {
     Expression* literalValue;
     Block body;
+    mnstl::fold_result_t value = {};  // literalValue, evaluated by the analyzer (as the type of the switch's variable)
 };
 
 struct SwitchStatement final : public Statement {
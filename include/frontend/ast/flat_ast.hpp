@@ -0,0 +1,169 @@
+#ifndef MANGANESE_INCLUDE_FRONTEND_AST_FLAT_AST_HPP
+#define MANGANESE_INCLUDE_FRONTEND_AST_FLAT_AST_HPP
+
+#include <core.hpp>
+#include <cstdint>
+#include <format>
+#include <frontend/ast/ast_base.hpp>
+#include <frontend/ast/ast_expressions.hpp>
+#include <frontend/ast/ast_statements.hpp>
+#include <frontend/ast/ast_types.hpp>
+#include <io/source_map.hpp>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace ast {
+namespace flat {
+
+using NodeId = uint32_t;
+constexpr inline NodeId NO_NODE = std::numeric_limits<NodeId>::max();  // A missing optional child
+
+enum class NodeClass : uint8_t {
+    Block,
+    Statement,
+    Expression,
+    Type
+};
+
+struct ChildRange {
+    uint32_t first = 0, count = 0;
+};
+
+/**
+ * @brief A compact, index-based view of a parsed program, with each property of a node kept in its own array
+ * @details Nodes are numbered in pre-order, so a parent always comes before its children, and a subtree is the id range
+ * [id, subtreeEnd(id)). A pass that only needs kinds or locations walks a few dense arrays instead of chasing pointers
+ * through the arena; anything else (names, literal values, ...) is read from the original node, which must outlive the
+ * tree.
+ * Each node's children are stored contiguously and always in the same positions, with NO_NODE for a missing optional
+ * child, and blocks (function bodies, branches, ...) get a node of their own. In order, the children are:
+ *  - Statements: the field types of an aggregate declaration; the base type of an alias; the base type, then the
+ *    values, of an enum declaration; the expression of an expression statement; the initialization step, stop
+ *    condition, post expression and body of a for loop; the parameter types, return type and body of a function
+ *    declaration; the condition, body, each elif's condition and body, then the else body of an if statement; the
+ *    block of a nested block; the value of a return statement; the variable, each case's value and body, then the
+ *    default body of a switch statement; the type, then the value, of a variable declaration; the condition and body of
+ *    a (do-)while loop
+ *  - Expressions: the generic types, then the field values, of an aggregate instantiation; the elements of an aggregate
+ *    literal; the type of alignof/sizeof; the element type, length and then the elements of an array literal; the
+ *    assignee and value of an assignment; the operands of binary, prefix and postfix expressions; the callee, then the
+ *    arguments, of a call; the identifier, then the types, of a generic expression; the variable and index of an index
+ *    expression; the object of a member access; the scope of a scope resolution; the value, then the target type, of a
+ *    cast. Literals and identifiers have no children.
+ *  - Types: the field types of an aggregate type; the element type and length of an array type; the parameter types,
+ *    then the return type, of a function type; the base type, then the parameters, of a generic type; the base type of
+ *    a pointer type; the expression of a typeof type. Symbol types have no children.
+ */
+class Tree {
+   private:
+    std::vector<NodeClass> _classes;
+    std::vector<uint8_t> _kinds;  // A StatementKind, ExpressionKind or TypeKind, depending on the class
+    std::vector<io::SourceLocation> _locations;
+    std::vector<ChildRange> _ranges;
+    std::vector<NodeId> _subtreeEnds;
+    std::vector<const void*> _origins;  // The Block, Statement, Expression or Type each node was built from
+    std::vector<NodeId> _children;
+
+    friend class TreeBuilder;
+
+   public:
+    /**
+     * @brief Flatten a program (e.g. ParsedFile::program), whose block becomes node 0
+     */
+    static Tree build(const Block& program);
+    // Flatten one statement, which becomes node 0
+    static Tree build(const Statement& statement);
+
+    constexpr static NodeId root() noexcept { return 0; }
+    size_t size() const noexcept { return _classes.size(); }
+
+    NodeClass nodeClass(NodeId id) const noexcept { return _classes[id]; }
+    StatementKind statementKind(NodeId id) const noexcept { return static_cast<StatementKind>(_kinds[id]); }
+    ExpressionKind expressionKind(NodeId id) const noexcept { return static_cast<ExpressionKind>(_kinds[id]); }
+    TypeKind typeKind(NodeId id) const noexcept { return static_cast<TypeKind>(_kinds[id]); }
+    io::SourceLocation location(NodeId id) const noexcept { return _locations[id]; }
+
+    std::span<const NodeId> children(NodeId id) const noexcept {
+        return std::span<const NodeId>(_children).subspan(_ranges[id].first, _ranges[id].count);
+    }
+    NodeId child(NodeId id, size_t index) const noexcept { return _children[_ranges[id].first + index]; }
+    // One past the last node in the subtree rooted at `id`, i.e. the next node that isn't a descendant
+    NodeId subtreeEnd(NodeId id) const noexcept { return _subtreeEnds[id]; }
+
+    /**
+     * @brief The node `id` was built from, for properties the tree doesn't store itself
+     * @note T must match the node's class and kind (e.g. ast::Block for blocks, ast::IfStatement for if statements)
+     */
+    template <class T>
+    const T& node(NodeId id) const noexcept {
+        return *static_cast<const T*>(_origins[id]);
+    }
+};
+
+/**
+ * @brief Call `visitor(id, node)` with the node's original, concretely typed object (e.g. `const ast::IfStatement&`)
+ * This plays the role of ast::Visitor's dispatch for passes that walk a Tree, so one overloaded callable (or a generic
+ * lambda) can handle every kind of node.
+ */
+template <class Visitor>
+decltype(auto) dispatch(const Tree& tree, NodeId id, Visitor&& visitor) {
+    switch (tree.nodeClass(id)) {
+        case NodeClass::Block: return visitor(id, tree.node<Block>(id));
+        case NodeClass::Statement:
+            switch (tree.statementKind(id)) {
+#define STMT(name, str) \
+    case StatementKind::name: return visitor(id, tree.node<name>(id));
+#define EXPR(name, str)
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            }
+            break;
+        case NodeClass::Expression:
+            switch (tree.expressionKind(id)) {
+#define STMT(name, str)
+#define EXPR(name, str) \
+    case ExpressionKind::name: return visitor(id, tree.node<name>(id));
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            }
+            break;
+        case NodeClass::Type:
+            switch (tree.typeKind(id)) {
+#define STMT(name, str)
+#define EXPR(name, str)
+#define TYPE(name, str) \
+    case TypeKind::name: return visitor(id, tree.node<name>(id));
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            }
+            break;
+    }
+    ASSERT_UNREACHABLE(std::format("Invalid flat AST node {}", id));
+}
+
+/**
+ * @brief Dispatch every node in the subtree rooted at `first` (the whole tree by default), parents before children
+ * @note Ids are visited in increasing order, so this is a single linear pass over the tree's arrays
+ */
+template <class Visitor>
+void forEach(const Tree& tree, Visitor&& visitor, NodeId first = Tree::root()) {
+    if (tree.size() == 0) { return; }
+    for (NodeId id = first, end = tree.subtreeEnd(first); id < end; ++id) { dispatch(tree, id, visitor); }
+}
+
+}  // namespace flat
+}  // namespace ast
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_FRONTEND_AST_FLAT_AST_HPP
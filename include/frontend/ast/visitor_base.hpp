@@ -2,6 +2,7 @@
 #define MANGANESE_INCLUDE_FRONTEND_VISITOR_VISITOR_BASE_HPP
 
 #include <core.hpp>
+#include <format>
 #include <frontend/ast/ast_base.hpp>
 #include <frontend/ast/ast_expressions.hpp>
 #include <frontend/ast/ast_statements.hpp>
@@ -35,6 +36,78 @@ class Visitor {
     typevisit_t visit(ast::Type*);
 };
 
+/**
+ * @brief A statically dispatched counterpart to Visitor, for passes built into the compiler
+ * @details Derived is the pass itself (`class pass : public StaticVisitor<pass, ...>`), and must provide a visit()
+ * overload for every node type in ast.def. The kind switch calls those directly, so they can be inlined rather than
+ * going through a vtable; Visitor stays available for passes that need to be swapped at runtime.
+ * @note A missing overload isn't a compile error: the call would convert to the base node type and recurse forever, so
+ * passes should declare their overloads with the same ast.def X-macros. If the overloads aren't public, the pass must
+ * befriend its StaticVisitor base.
+ */
+template <class Derived, class ExpressionResult, class StatementResult, class TypeResult>
+class StaticVisitor {
+   public:
+    using exprvisit_t = ExpressionResult;
+    using stmtvisit_t = StatementResult;
+    using typevisit_t = TypeResult;
+
+   protected:
+    ~StaticVisitor() noexcept = default;  // Only ever destroyed as part of Derived
+
+    // Dispatch for the different kinds of nodes
+
+    exprvisit_t visit(ast::Expression* expr) {
+        switch (expr->kind) {
+#define STMT(name, str)
+#define EXPR(name, str) \
+    case ast::ExpressionKind::name: return derived().visit(static_cast<ast::name*>(expr));
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            default:
+                ASSERT_UNREACHABLE(
+                    std::format("No visit() overload for expression kind {}", static_cast<int>(expr->kind)));
+        }
+    }
+
+    stmtvisit_t visit(ast::Statement* stmt) {
+        switch (stmt->kind) {
+#define STMT(name, str) \
+    case ast::StatementKind::name: return derived().visit(static_cast<ast::name*>(stmt));
+#define EXPR(name, str)
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            default:
+                ASSERT_UNREACHABLE(
+                    std::format("No visit() overload for statement kind {}", static_cast<int>(stmt->kind)));
+        }
+    }
+
+    typevisit_t visit(ast::Type* type) {
+        switch (type->kind) {
+#define STMT(name, str)
+#define EXPR(name, str)
+#define TYPE(name, str) \
+    case ast::TypeKind::name: return derived().visit(static_cast<ast::name*>(type));
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+            default:
+                ASSERT_UNREACHABLE(std::format("No visit() overload for type kind {}", static_cast<int>(type->kind)));
+        }
+    }
+
+   private:
+    Derived& derived() noexcept { return static_cast<Derived&>(*this); }
+};
+
 }  // namespace ast
 
 }  // namespace Manganese
@@ -2,23 +2,29 @@
 #define MANGANESE_INCLUDE_FRONTEND_LEXER_LEXER_BASE_HPP
 
 #include <core.hpp>
-#include <deque>
 #include <frontend/lexer/token.hpp>
-#include <io/filereader.hpp>
-#include <io/reader.hpp>
-#include <io/stringreader.hpp>
+#include <io/bufferreader.hpp>
+#include <io/mappedfilereader.hpp>
+#include <io/source_map.hpp>
 #include <memory>
+#include <mnstl/chunk_allocator.hxx>
 #include <mnstl/number.hxx>
+#include <mnstl/ring_buffer.hxx>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utils/result.hpp>
+#include <vector>
 
 namespace Manganese {
 namespace lexer {
 
 enum class Mode : uint8_t {
     String = 's',  // Source code passed in as a string
-    File = 'f'  // Filename passed in
+    File = 'f',  // Filename passed in
+    // Filename passed in, but only the module declaration and imports at the top of the file are lexed: the first
+    // token of anything else ends the input, so the rest of the file is never read
+    FileHeader = 'h'
 };
 
 struct NumberPrefixResult {
@@ -32,16 +38,53 @@ struct NumberPrefixResult {
  * understand.
  */
 class Lexer {
+   public:
+    constexpr static const size_t TOKEN_BUFFER_CAPACITY = 64;  // Must be a power of two
+    constexpr static const size_t DEFAULT_LOOKAHEAD_DEPTH = 8;
+    // The token buffer always keeps a slot free for the end of file token
+    constexpr static const size_t MAX_LOOKAHEAD = TOKEN_BUFFER_CAPACITY - 1;
+    // Inputs are only split for parallel lexing if every chunk would be at least this long
+    constexpr static const size_t DEFAULT_MIN_CHUNK_SIZE = 256 * 1024;
+
    private:
-    std::unique_ptr<io::Reader> reader;
-    size_t tokenStartLine, tokenStartCol;  // Keep track of where the token started for error reporting
-    constexpr static const size_t QUEUE_LOOKAHEAD_AMOUNT = 8;  // how many tokens to look ahead
+    // The lexer always reads from one contiguous buffer through a concrete (non-virtual) reader
+    // The buffer is either the caller's string, a memory-mapped file, or a file drained into ownedSource
+    io::BufferReader reader;
+    std::unique_ptr<io::MappedFileReader> mappedSource;
+    std::string ownedSource;
+    // Lexemes that differ from their spelling in the source (e.g. literals with escape sequences) are stored here,
+    // so that tokens can view them without owning a string
+    mnstl::chunk_allocator lexemeArena;
+    uint32_t sourceId;  // The buffer's id in io::sourceMap(), which resolves token offsets to lines and columns
+    size_t baseOffset = 0;  // Where the reader's buffer starts in that source (non-zero for chunks)
+    size_t tokenStart = 0;  // Offset of the token being lexed
+    // Chunk lexers lex part of another lexer's source on a worker thread. They share its source id, and leave
+    // identifiers uninterned so that the parent can intern them in source order
+    bool isChunk = false;
+    bool ownsSource = true;  // Whether the lexer registered its source, and so releases it
+    std::vector<std::unique_ptr<Lexer>> chunkLexers;  // Own the lexemes of tokens from tokenizeAllParallel()
     bool _hasError = false;
-    std::deque<Token> tokenStream;
+    // Mode::FileHeader only: whether the next token starts a statement, and where the header ended (once it has)
+    bool isHeaderOnly = false;
+    bool atHeaderStatementStart = true;
+    size_t headerEnd = std::string_view::npos;
+    size_t lookaheadDepth;  // How many tokens to lex each time the buffer runs dry
+    mnstl::ring_buffer<Token, TOKEN_BUFFER_CAPACITY> tokenStream;
+    Token endOfFile;  // Returned once the buffer has been drained
 
    public:
-    explicit Lexer(const std::string& source, Mode mode = Mode::File);
-    ~Lexer() noexcept = default;
+    explicit Lexer(const std::string& source, Mode mode = Mode::File, size_t lookahead = DEFAULT_LOOKAHEAD_DEPTH);
+
+    /**
+     * @brief Lex only `source[begin, end)`, e.g. the part of a file that an edit touched
+     * @details Locations point into the whole of `source`, which the caller has registered with io::sourceMap() as
+     * `id`, so diagnostics give the same lines and columns as they would lexing all of it. The caller keeps the
+     * source map up to date as the source changes, and removes it when done, so lexing it again adds nothing
+     */
+    Lexer(std::string_view source, uint32_t id, size_t begin, size_t end);
+    ~Lexer() noexcept {
+        if (ownsSource) { io::sourceMap().release(sourceId, headerEnd); }
+    }
 
     // Avoid file ownership issues
     Lexer(const Lexer&) = delete;
@@ -49,15 +92,42 @@ class Lexer {
     Lexer& operator=(const Lexer&) = delete;
     Lexer& operator=(Lexer&&) = delete;
 
-    Token peekToken() noexcept;
+    /**
+     * @brief Look `n` tokens ahead (0 being the next token) without consuming anything
+     * @note `n` must be below MAX_LOOKAHEAD. The reference stays valid until that token is consumed
+     */
+    const Token& peekToken(size_t n = 0) noexcept;
     Token consumeToken() noexcept;
-    inline bool done() const noexcept { return reader->done(); }
+
+    /**
+     * @brief Lex the rest of the input in one go, ending with an EndOfFile token
+     * @note Lexemes view storage owned by the lexer, so the tokens are only valid while it is alive
+     */
+    std::vector<Token> tokenizeAll();
+
+    /**
+     * @brief Like tokenizeAll(), but splits the rest of the input into chunks that are lexed on `threadCount` threads
+     * @details Chunks start after newlines that are outside of any literal or comment, so each one can be lexed on
+     * its own. The resulting tokens, diagnostics and error state are the same (and in the same order) as if the input
+     * had been lexed sequentially.
+     * @param threadCount 0 to use one thread per hardware thread
+     * @param minChunkSize Inputs too short to give every thread a chunk this long are split into fewer chunks
+     * (or lexed sequentially)
+     * @note Lexemes view storage owned by the lexer, so the tokens are only valid while it is alive
+     */
+    std::vector<Token> tokenizeAllParallel(size_t threadCount = 0, size_t minChunkSize = DEFAULT_MIN_CHUNK_SIZE);
+    inline bool done() const noexcept { return reader.done(); }
     constexpr bool hasError() const noexcept { return _hasError; }
 
    private:
+    // Lex `chunk` (a copy of part of source `source`, starting at `offset` in it)
+    Lexer(std::string_view chunk, uint32_t source, size_t offset);
+
     //~ Main tokenization functions
 
     void lex(size_t numTokens = 1);
+    // Mode::FileHeader: end the input at `token` (the one just lexed) if it can't be part of the header
+    bool endHeaderAt(Token& token) noexcept;
     Result tokenizeCharLiteral();
     Result tokenizeKeywordOrIdentifier();
     Result tokenizeNumber();
@@ -67,16 +137,33 @@ class Lexer {
 
     //~ Helper functions
     NumberPrefixResult processNumberPrefix();
-    Result processNumberSuffix(mnstl::Base base, std::string& numberLiteral, bool isFloat);
-    std::optional<std::string> resolveEscapeCharacters(const std::string& escapeString);
-    Result processCharEscapeSequence(const std::string& charLiteral);
+    Result processNumberSuffix(mnstl::Base base, std::string& numberLiteral, bool& isFloat);
+    /**
+     * @brief Resolve the escape sequences in a literal's body, in one pass, straight into the lexeme arena
+     * @param lineContinuations Whether a backslash before a newline joins the lines (as in string literals)
+     * @return The decoded literal (null-terminated), or nothing if an escape sequence is invalid
+     */
+    std::optional<std::string_view> decodeLiteral(std::string_view body, bool lineContinuations);
+    Result processCharEscapeSequence(std::string_view charLiteral);
+    // A literal's body so far: from `bodyStart` up to the reader's position (a view into the source buffer)
+    FORCE_INLINE std::string_view literalBody(size_t bodyStart) const noexcept {
+        return reader.slice(bodyStart, reader.getPosition() - bodyStart);
+    }
+    // Check that a literal's body (which starts at `bodyStart`) is well-formed UTF-8, logging an error where it isn't
+    bool validateUTF8(size_t bodyStart, std::string_view body);
+    FORCE_INLINE std::string_view storeLexeme(std::string_view lexeme) { return lexemeArena.copy_string(lexeme); }
+    // Store a number literal's lexeme with its value just before it, where Token::getNumber() expects it
+    std::string_view storeNumberLexeme(std::string_view lexeme, const NumberLiteralValue& value);
 
     //~ Reader wrapper functions
-    inline char peekChar(size_t offset = 0) const noexcept { return reader->peekChar(offset); }
-    [[nodiscard]] inline char consumeChar() const noexcept { return reader->consumeChar(); }
-    inline size_t getLine() const noexcept { return reader->getLine(); }
-    inline size_t getCol() const noexcept { return reader->getColumn(); }
-    inline void advance(size_t n = 1) noexcept { reader->setPosition(reader->getPosition() + n); }
+    FORCE_INLINE char peekChar(size_t offset = 0) noexcept { return reader.peekChar(offset); }
+    [[nodiscard]] FORCE_INLINE char consumeChar() noexcept { return reader.consumeChar(); }
+    FORCE_INLINE io::SourceLocation location(size_t offset) const noexcept {
+        return io::SourceLocation{.source = sourceId, .offset = static_cast<uint32_t>(baseOffset + offset)};
+    }
+    FORCE_INLINE io::SourceLocation currentLocation() const noexcept { return location(reader.getPosition()); }
+    FORCE_INLINE io::SourceLocation tokenLocation() const noexcept { return location(tokenStart); }
+    FORCE_INLINE void advance(size_t n = 1) noexcept { reader.advance(n); }
 };
 
 //~ Static helper functions
@@ -94,10 +181,11 @@ constexpr char tolower(char c) noexcept {
     return c;
 }
 
-std::optional<char> getEscapeCharacter(const char escapeChar, size_t line, size_t col);
-std::string encodeUTF8String(char32_t wideChar);
-std::optional<char32_t> resolveHexCharacters(const std::string& escDigits);
-std::optional<char32_t> resolveUnicodeCharacters(const std::string& escDigits, size_t line, size_t col,
+std::optional<char> getEscapeCharacter(const char escapeChar, io::SourceLocation location);
+// Write a code point's UTF-8 encoding to `out` (which has room for 4 bytes), returning how many bytes it takes
+size_t encodeUTF8(char32_t wideChar, char* out) noexcept;
+std::optional<char32_t> resolveHexCharacters(std::string_view escDigits);
+std::optional<char32_t> resolveUnicodeCharacters(std::string_view escDigits, io::SourceLocation location,
                                                  bool isLongUnicode = false);
 
 }  // namespace lexer
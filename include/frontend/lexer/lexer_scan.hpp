@@ -0,0 +1,47 @@
+#ifndef MANGANESE_INCLUDE_FRONTEND_LEXER_LEXER_SCAN_HPP
+#define MANGANESE_INCLUDE_FRONTEND_LEXER_LEXER_SCAN_HPP
+
+/**
+ * Scanning kernels for the lexer's hot loops
+ * Each kernel takes the unread part of the source buffer as [begin, end) and returns a pointer to the first character
+ * that does not belong to the run it skips (or `end`).
+ * They process 32 (AVX2) or 16 (SSE2, NEON) bytes at a time where available, with a scalar loop for the tail and for
+ * other targets.
+ */
+
+namespace Manganese {
+namespace lexer {
+namespace scan {
+
+/**
+ * @brief Skip a run of whitespace (' ', '\t', '\n', '\v', '\f', '\r')
+ */
+const char* skipWhitespace(const char* begin, const char* end) noexcept;
+
+/**
+ * @brief Skip a run of identifier characters ([A-Za-z0-9_])
+ */
+const char* skipIdentifier(const char* begin, const char* end) noexcept;
+
+/**
+ * @brief Find the end of a single line comment (the next '\n')
+ */
+const char* findLineEnd(const char* begin, const char* end) noexcept;
+
+/**
+ * @brief Skip the ordinary characters in a string literal body, stopping at the next '"', '\\' or '\n'
+ */
+const char* skipStringBody(const char* begin, const char* end) noexcept;
+
+/**
+ * @brief Skip well-formed UTF-8, stopping at the first byte of a sequence that is malformed (overlong, a surrogate,
+ * past U+10FFFF, or cut short)
+ * ASCII is skipped a vector at a time; only the multi-byte sequences are checked one by one.
+ */
+const char* skipValidUTF8(const char* begin, const char* end) noexcept;
+
+}  // namespace scan
+}  // namespace lexer
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_FRONTEND_LEXER_LEXER_SCAN_HPP
@@ -1,47 +1,119 @@
 #ifndef MANGANESE_INCLUDE_FRONTEND_AST_LEXER_TOKEN_BASE_HPP
 #define MANGANESE_INCLUDE_FRONTEND_AST_LEXER_TOKEN_BASE_HPP
 
+#include <concepts>
 #include <core.hpp>
+#include <cstdint>
 #include <frontend/lexer/token_type.hpp>
+#include <io/source_map.hpp>
 #include <mnstl/enum_matches.hxx>
+#include <mnstl/number.hxx>
+#include <mnstl/string_pool.hxx>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace Manganese {
 namespace lexer {
 
+//~ Token type categories, for when only the type of a token is at hand
+
+constexpr bool isOperator(TokenType type) noexcept {
+    return type >= TokenType::_operatorStart && type <= TokenType::_operatorEnd;
+}
+
+constexpr bool hasUnaryCounterpart(TokenType type) noexcept {
+    using enum TokenType;
+    return mnstl::enum_matches<TokenType>(type, Plus,  // + can be addition or unary plus
+                                          Minus,  // - can be subtraction or unary minus
+                                          BitAnd,  // & can be bitwise AND or address-of operator
+                                          Mul);  // * can be multiplication or dereference operator
+}
+
+/**
+ * @brief The unary version of an operator that can also be binary (e.g. `-` as negation), or `type` if there isn't one
+ */
+constexpr TokenType unaryCounterpart(TokenType type) noexcept {
+    switch (type) {
+        case TokenType::Plus: return TokenType::UnaryPlus;
+        case TokenType::Minus: return TokenType::UnaryMinus;
+        case TokenType::BitAnd: return TokenType::AddressOf;
+        case TokenType::Mul: return TokenType::Dereference;
+        default: return type;
+    }
+}
+
+/**
+ * @brief The value of a number literal, and whether it was valid and fit in its type
+ */
+using NumberLiteralValue = mnstl::string_conversion_result_t<mnstl::number_t>;
+
+/**
+ * @brief A single lexed token, kept small enough to be passed around by value
+ * @details The lexeme is a view, either into the source buffer (keywords and operators), into identifierPool()
+ * (identifiers) or into storage owned by the lexer that produced the token (processed literals), so a token must not
+ * outlive its lexer.
+ */
 class Token {
    private:
-    bool _isInvalid;
-    TokenType _type;
-    std::string _lexeme;
-    size_t _line, _column;
+    const char* _lexemeData = "";
+    uint32_t _lexemeLength = 0;
+    io::SourceLocation _location;  // Resolved to a line and column only when asked for
+    TokenType _type = TokenType::Unknown;
+    bool _isInvalid : 1 = false;
+    bool _isInterned : 1 = false;  // Whether the lexeme is a view into identifierPool()
+
+    friend class Lexer;  // The lexer interns identifiers as it produces them
 
    public:
     Token() noexcept = default;
-    Token(const TokenType type, const std::string& lexeme, const size_t line, const size_t column,
-          bool isInvalid = false) :
-        _isInvalid(isInvalid), _type(type), _lexeme(lexeme), _line(line), _column(column) {
+    Token(const TokenType type, std::string_view lexeme, io::SourceLocation location, bool isInvalid = false) noexcept :
+        _lexemeData(lexeme.data()),
+        _lexemeLength(static_cast<uint32_t>(lexeme.length())),
+        _location(location),
+        _type(type),
+        _isInvalid(isInvalid) {
         // Special lexeme override cases
         if (_type == TokenType::Int32) {
-            _lexeme = "int32";
+            setLexeme("int32");
         } else if (_type == TokenType::Float32) {
-            _lexeme = "float32";
+            setLexeme("float32");
         }
     }
+    // A token only views its lexeme, so building one from a std::string would leave it dangling
+    template <typename S>
+        requires std::same_as<std::remove_cvref_t<S>, std::string>
+    Token(TokenType, S&&, io::SourceLocation, bool = false) = delete;
     ~Token() noexcept = default;
 
     constexpr bool isKeyword() const noexcept {
         return _type >= TokenType::_keywordStart && _type <= TokenType::_keywordEnd;
     }
-    constexpr bool isOperator() const noexcept {
-        return _type >= TokenType::_operatorStart && _type <= TokenType::_operatorEnd;
-    }
+    constexpr bool isOperator() const noexcept { return lexer::isOperator(_type); }
 
     constexpr bool isInvalid() const noexcept { return _isInvalid; }
     constexpr TokenType getType() const noexcept { return _type; }
-    constexpr std::string getLexeme() const noexcept { return _lexeme; }
-    constexpr size_t getLine() const noexcept { return _line; }
-    constexpr size_t getColumn() const noexcept { return _column; }
+    constexpr std::string_view getLexeme() const noexcept { return std::string_view(_lexemeData, _lexemeLength); }
+    constexpr io::SourceLocation getLocation() const noexcept { return _location; }
+    inline size_t getLine() const { return io::sourceMap().resolve(_location).line; }
+    inline size_t getColumn() const { return io::sourceMap().resolve(_location).column; }
+
+    /**
+     * @brief The atom of an identifier's name in identifierPool(), or invalid_atom for tokens that weren't interned
+     */
+    inline mnstl::string_pool::atom_t getAtom() const noexcept {
+        return _isInterned ? mnstl::string_pool::atom_of(getLexeme()) : mnstl::string_pool::invalid_atom;
+    }
+
+    /**
+     * @brief The value of an IntegerLiteral or FloatLiteral token, which the lexer converts once as it lexes it
+     * @details The value is stored in the lexer's arena directly before the lexeme, so tokens don't grow to carry it
+     * @note Only valid for number literals produced by a Lexer
+     */
+    inline const NumberLiteralValue& getNumber() const noexcept {
+        return *std::launder(reinterpret_cast<const NumberLiteralValue*>(_lexemeData - sizeof(NumberLiteralValue)));
+    }
 
     constexpr bool isPrefixOperator() const noexcept {
         using enum TokenType;
@@ -67,26 +139,33 @@ class Token {
         return mnstl::enum_matches<TokenType>(_type, Int8, Int16, Int32, Int64, UInt8, UInt16, UInt32, UInt64, Int128,
                                               UInt128);
     }
-    constexpr bool hasUnaryCounterpart() const noexcept {
-        using enum TokenType;
-        return mnstl::enum_matches<TokenType>(_type, Plus,  // + can be addition or unary plus
-                                              Minus,  // - can be subtraction or unary minus
-                                              BitAnd,  // & can be bitwise AND or address-of operator
-                                              Mul);  // * can be multiplication or dereference operator
-    }
-
-    /**
-     * @note Parser only: be careful
-     */
-    void overrideType(TokenType, std::string = "");
+    constexpr bool hasUnaryCounterpart() const noexcept { return lexer::hasUnaryCounterpart(_type); }
 
     // These functions are long, so are implemented in a separate header
     TokenType getUnaryCounterpart() const NOEXCEPT_IF_RELEASE;
     std::string toString() const noexcept;
+
+   private:
+    constexpr void setLexeme(std::string_view lexeme) noexcept {
+        _lexemeData = lexeme.data();
+        _lexemeLength = static_cast<uint32_t>(lexeme.length());
+    }
 };
 
+static_assert(sizeof(Token) <= 24, "Tokens are copied freely, so should stay small");
+static_assert(std::is_trivially_copyable_v<Token>);
+
 //~ Helpers, not tied to the Token class
+
+/**
+ * @brief The pool identifier names are interned into, shared by the lexer, parser and semantic analysis
+ */
+mnstl::string_pool& identifierPool() noexcept;
 std::string tokenTypeToString(TokenType type);
+/**
+ * @brief The operator a compound assignment applies (e.g. Plus for PlusAssign)
+ */
+TokenType getBinaryOperatorFromAssignmentOperator(TokenType assignmentOp) NOEXCEPT_IF_RELEASE;
 TokenType keywordLookup(const std::string_view& s) noexcept;
 
 }  // namespace lexer
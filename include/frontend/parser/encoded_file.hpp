@@ -0,0 +1,135 @@
+#ifndef MANGANESE_INCLUDE_FRONTEND_PARSER_ENCODED_FILE_HPP
+#define MANGANESE_INCLUDE_FRONTEND_PARSER_ENCODED_FILE_HPP
+
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <frontend/ast/flat_ast.hpp>
+#include <frontend/parser/parser_base.hpp>
+#include <io/mappedfilereader.hpp>
+#include <io/source_map.hpp>
+#include <memory>
+#include <mnstl/chunk_allocator.hxx>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace parser {
+
+/**
+ * @brief A parsed file (its module name, imports and program) in a compact binary form, so that it can be cached
+ * (e.g. memory-mapped from a file) and loaded again instead of lexing and parsing the source
+ * @details Like a ModuleInterface, the buffer is a sequence of 32-bit words in the host's byte order, every offset
+ * counts bytes from the start of the buffer (so the buffer can be used wherever it is mapped), and strings are
+ * (offset, length) pairs into the characters after the header. In order, it holds:
+ *  - A header: the magic number, the format version, whether parsing reported an error, the module's name, and the
+ *    size of each of the sections below and where it starts
+ *  - The characters of every string in the file
+ *  - The nodes, six words each: the node's class, kind and whether it has a location; its location's byte offset;
+ *    where its children start in the child table and how many it has; its subtree's end; and where its payload starts
+ *  - The child table, a node id (or ast::flat::NO_NODE) per child
+ *  - The payloads: what each node holds besides its children (names, operators, literal values, flags ...)
+ *  - The imports, and the offset of each statement in the program
+ * The nodes are those of an ast::flat::Tree of the program: numbered in pre-order, with the same children in the same
+ * positions. So the tree can be walked in place, and is rebuilt children first, by going through the nodes backwards.
+ * A buffer is validated once, when it is loaded, so nothing read from it afterwards needs checking.
+ */
+class EncodedFile {
+   public:
+    constexpr static inline uint32_t VERSION = 1;
+    constexpr static inline std::string_view FILE_EXTENSION = ".mnp";
+
+    using NodeId = ast::flat::NodeId;
+
+   private:
+    std::vector<char> ownedBytes;  // The buffer, if it was handed over as bytes
+    std::unique_ptr<io::MappedFileReader> mapping;  // Or the file it was mapped from
+    std::string_view bytes;  // Whichever of the two it is
+
+    uint32_t nodeCount = 0, nodes = 0, children = 0, payloads = 0, payloadWords = 0;
+
+    uint32_t word(size_t offset) const noexcept {
+        uint32_t value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    }
+    std::string_view string(size_t offset) const noexcept {
+        return bytes.substr(word(offset), word(offset + 4));  // An (offset, length) pair
+    }
+    uint32_t nodeWord(NodeId id, size_t field) const noexcept { return word(nodes + 24 * size_t{id} + 4 * field); }
+    uint32_t kind(NodeId id) const noexcept { return (nodeWord(id, 0) >> 8) & 0xFF; }
+    size_t payload(NodeId id) const noexcept { return payloads + 4 * size_t{nodeWord(id, 5)}; }
+
+    // Check that every offset, string, node and payload in the buffer is well-formed
+    bool validate() noexcept;
+    bool validateNode(NodeId id) const noexcept;
+    static std::optional<EncodedFile> load(EncodedFile file);
+
+    friend class Rehydrator;
+
+   public:
+    /**
+     * @brief Encode a parsed file, e.g. to cache it
+     */
+    static std::vector<char> encode(const ParsedFile& file);
+
+    /**
+     * @brief Load an encoded file, which is kept alive by the returned object
+     * @return The file, or nothing if `encoded` isn't a valid encoded file (of this version)
+     */
+    static std::optional<EncodedFile> fromBytes(std::vector<char> encoded);
+
+    /**
+     * @brief Memory-map an encoded file (e.g. one written from encode()'s output)
+     * @return The file, or nothing if it can't be mapped or isn't a valid encoded file (of this version)
+     */
+    static std::optional<EncodedFile> open(const std::string& path);
+
+    // The encoded buffer, e.g. to write to a file
+    std::string_view data() const noexcept { return bytes; }
+    std::string_view moduleName() const noexcept { return string(12); }
+    bool hasError() const noexcept { return (word(8) & 1) != 0; }
+    std::vector<Import> imports() const;
+    std::vector<uint32_t> statementOffsets() const;
+
+    //~ The program, as a tree laid out like an ast::flat::Tree (node 0 is the program's block)
+
+    size_t size() const noexcept { return nodeCount; }
+    ast::flat::NodeClass nodeClass(NodeId id) const noexcept {
+        return static_cast<ast::flat::NodeClass>(nodeWord(id, 0) & 0xFF);
+    }
+    ast::StatementKind statementKind(NodeId id) const noexcept { return static_cast<ast::StatementKind>(kind(id)); }
+    ast::ExpressionKind expressionKind(NodeId id) const noexcept {
+        return static_cast<ast::ExpressionKind>(kind(id));
+    }
+    ast::TypeKind typeKind(NodeId id) const noexcept { return static_cast<ast::TypeKind>(kind(id)); }
+    // Where the node is in the source buffer registered as `source` (invalid if the node had no location)
+    io::SourceLocation location(NodeId id, uint32_t source) const noexcept {
+        if ((nodeWord(id, 0) & (1 << 16)) == 0) { return io::SourceLocation{}; }
+        return io::SourceLocation{.source = source, .offset = nodeWord(id, 1)};
+    }
+    size_t childCount(NodeId id) const noexcept { return nodeWord(id, 3); }
+    NodeId child(NodeId id, size_t index) const noexcept { return word(children + 4 * (nodeWord(id, 2) + index)); }
+    NodeId subtreeEnd(NodeId id) const noexcept { return nodeWord(id, 4); }
+
+    /**
+     * @brief The node's name: what a declaration declares, an identifier, a member or scope element, a string
+     * literal's value or a symbol type's name (empty for any other node)
+     * @note The view is into the buffer, so it is only valid as long as this object is
+     */
+    std::string_view name(NodeId id) const noexcept;
+
+    /**
+     * @brief Rebuild the parsed file, with its AST in `arena` (which gets room for all of it at once)
+     * @param source The source buffer the nodes' locations should refer to (e.g. the file's source, registered with
+     * the source map again), or none
+     */
+    ParsedFile rehydrate(mnstl::chunk_allocator& arena, uint32_t source = io::SourceLocation::INVALID_SOURCE) const;
+};
+
+}  // namespace parser
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_FRONTEND_PARSER_ENCODED_FILE_HPP
@@ -2,12 +2,14 @@
 #define MANGANESE_INCLUDE_FRONTEND_PARSER_PARSER_BASE_HPP
 
 #include <core.hpp>
+#include <cstdint>
 #include <frontend/ast.hpp>
 #include <frontend/lexer.hpp>
 #include <frontend/parser/operators.hpp>
 #include <io/logging.hpp>
 #include <memory>
 #include <mnstl/chunk_allocator.hxx>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -21,10 +23,29 @@ struct Import {
     std::string alias;
 };
 
+/**
+ * @brief The module declaration and imports at the top of a file, which are enough to place it in the module graph
+ */
+struct FileHeader {
+    std::string moduleName;
+    std::vector<Import> imports;
+    bool hasError = false;
+};
+
 struct ParsedFile {
     std::string moduleName;
     std::vector<Import> imports;
     ast::Block program;
+    std::vector<uint32_t> statementOffsets;  // Where each statement of the program starts (its first token's offset)
+    bool hasError = false;  // Whether lexing or parsing reported an error (the program may be incomplete)
+};
+
+/**
+ * @brief What parsing one statement reported
+ */
+struct StatementDiagnostics {
+    logging::DiagnosticList diagnostics;
+    bool hasError = false;
 };
 
 //~ Helper functions that don't depend on the parser class's methods/variables
@@ -32,27 +53,40 @@ std::string importToString(const Import& import);
 
 class Parser {
    private:
+    // Tokens come either from a lexer owned by the parser, or from a caller-provided (already lexed) array
     std::unique_ptr<lexer::Lexer> lexer;
+    std::span<const Token> tokens;
+    size_t tokenCursor = 0;
+    Token endOfFile;  // Returned when peeking past the end of `tokens`
     constexpr static inline ast::Visibility defaultVisibility = ast::Visibility::Private;
-    std::optional<Token> previousToken;
+    Token consumedToken;  // The last token taken from `lexer`, which no longer holds it
+    TokenType previousTokenType = TokenType::Unknown;
 
     std::string moduleName;
     std::vector<Import> imports;
     mnstl::chunk_allocator& arena;
+    std::vector<StatementDiagnostics>* statementDiagnostics = nullptr;  // See captureStatementDiagnostics()
 
     // Some flags
     struct {
         bool hasParsedFileHeader : 1 = false;  // Processing module and import
         bool hasError : 1 = false;
         bool isParsingBlockPrecursor : 1 = false;  // if/for/while, etc.
+        bool hasPreviousToken : 1 = false;  // Whether previousTokenType is set (it's reset between statements)
     };
 
    public:
     Parser(const std::string& source, lexer::Mode mode, mnstl::chunk_allocator& allocatorReference) :
-        lexer(std::make_unique<lexer::Lexer>(source, mode)), arena(allocatorReference) {
-        initializeLookups();
-        initializeTypeLookups();
-    }
+        lexer(std::make_unique<lexer::Lexer>(source, mode)), arena(allocatorReference) {}
+
+    /**
+     * @brief Parse an already-lexed token array (e.g. from Lexer::tokenizeAll())
+     * @note The tokens (and the lexer that produced them) must outlive the parser
+     */
+    Parser(std::span<const Token> tokenArray, mnstl::chunk_allocator& allocatorReference) :
+        tokens(tokenArray),
+        endOfFile(TokenType::EndOfFile, "EOF", tokenArray.empty() ? io::SourceLocation{} : tokenArray.back().getLocation()),
+        arena(allocatorReference) {}
 
     // Avoid file ownership issues
     Parser(const Parser&) = delete;
@@ -64,6 +98,31 @@ class Parser {
 
     ParsedFile parse();
 
+    /**
+     * @brief Parse only the module declaration and imports, stopping before the first statement of the body
+     * @details A later parse() picks up where this left off, so a file's header and body can be parsed separately
+     */
+    FileHeader parseHeader();
+
+    /**
+     * @brief Parse the tokens as statements of a file's body (e.g. the ones an edit touched), without looking for a
+     * module declaration or imports first
+     */
+    ParsedFile parseStatements() {
+        hasParsedFileHeader = true;
+        return parse();
+    }
+
+    /**
+     * @brief Have parse() keep what each statement of the program reports apart, in `diagnostics` (which gets one
+     * entry per statement), rather than writing it out
+     * @details e.g. so that a statement's diagnostics can be kept while other statements are parsed again. Whatever the
+     * header and the lexer report is still written out
+     */
+    void captureStatementDiagnostics(std::vector<StatementDiagnostics>& diagnostics) noexcept {
+        statementDiagnostics = &diagnostics;
+    }
+
    private:  // private methods
     using statementHandler_t = ast::Statement* (Parser::*)();
     using nudHandler_t = ast::Expression* (Parser::*)();
@@ -72,14 +131,28 @@ class Parser {
     using ledHandler_types_t = ast::Type* (Parser::*)(ast::Type*, Precedence);
 
     //~ Lookups
-    static inline std::array<statementHandler_t, static_cast<size_t>(TokenType::_tokenCount)> statementLookup{};
-    static inline std::array<nudHandler_t, static_cast<size_t>(TokenType::_tokenCount)> nudLookup{};
-    static inline std::array<ledHandler_t, static_cast<size_t>(TokenType::_tokenCount)> ledLookup{};
-    static inline std::array<Operator, static_cast<size_t>(TokenType::_tokenCount)> operatorPrecedenceMap{};
+    // Generated at compile time (see parser_lookups.cpp), so constructing a parser costs nothing and is thread-safe
+    constexpr static inline size_t lookupSize = static_cast<size_t>(TokenType::_tokenCount);
+    struct ExpressionLookups {
+        std::array<statementHandler_t, lookupSize> statement{};
+        std::array<nudHandler_t, lookupSize> nud{};
+        std::array<ledHandler_t, lookupSize> led{};
+        std::array<Operator, lookupSize> precedence{};
+    };
+    struct TypeLookups {
+        std::array<nudHandler_types_t, lookupSize> nud{};
+        std::array<ledHandler_types_t, lookupSize> led{};
+        std::array<Operator, lookupSize> precedence{};
+    };
 
-    static inline std::array<nudHandler_types_t, static_cast<size_t>(TokenType::_tokenCount)> nudLookup_types{};
-    static inline std::array<ledHandler_types_t, static_cast<size_t>(TokenType::_tokenCount)> ledLookup_types{};
-    static inline std::array<Operator, static_cast<size_t>(TokenType::_tokenCount)> operatorPrecedenceMap_type{};
+    static const std::array<statementHandler_t, lookupSize> statementLookup;
+    static const std::array<nudHandler_t, lookupSize> nudLookup;
+    static const std::array<ledHandler_t, lookupSize> ledLookup;
+    static const std::array<Operator, lookupSize> operatorPrecedenceMap;
+
+    static const std::array<nudHandler_types_t, lookupSize> nudLookup_types;
+    static const std::array<ledHandler_types_t, lookupSize> ledLookup_types;
+    static const std::array<Operator, lookupSize> operatorPrecedenceMap_type;
 
     //~ Parsing functions
 
@@ -139,21 +212,44 @@ class Parser {
     ast::Block parseBlock(const std::string& blockName);
 
     bool isUnaryContext() const noexcept;
+    /**
+     * @brief The type `token` is parsed as, which for an operator with a unary form depends on what came before it
+     */
+    inline TokenType operatorType(const Token& token) const noexcept {
+        const TokenType type = token.getType();
+        return (lexer::hasUnaryCounterpart(type) && isUnaryContext()) ? lexer::unaryCounterpart(type) : type;
+    }
 
-    [[nodiscard]] inline Token peekToken() const noexcept { return lexer->peekToken(); }
-    [[nodiscard]] inline TokenType peekTokenType() noexcept { return lexer->peekToken().getType(); }
-
-    [[nodiscard]] inline Token consumeToken() noexcept {
-        previousToken = peekToken();
-        return lexer->consumeToken();
+    // The reference stays valid until the token is consumed
+    [[nodiscard]] inline const Token& peekToken(size_t n = 0) const noexcept {
+        if (lexer) { return lexer->peekToken(n); }
+        return tokenCursor + n < tokens.size() ? tokens[tokenCursor + n] : endOfFile;
+    }
+    [[nodiscard]] inline TokenType peekTokenType(size_t n = 0) noexcept { return peekToken(n).getType(); }
+
+    /**
+     * @note The reference stays valid until the next token is consumed
+     */
+    [[nodiscard]] inline const Token& consumeToken() noexcept {
+        const Token* token;
+        if (lexer) {
+            consumedToken = lexer->consumeToken();
+            token = &consumedToken;
+        } else {
+            token = &peekToken();
+            tokenCursor += (tokenCursor < tokens.size()) ? 1 : 0;
+        }
+        previousTokenType = token->getType();
+        hasPreviousToken = true;
+        return *token;
     }
 
     Token expectToken(TokenType expectedType);
     Token expectToken(TokenType expectedType, const std::string& errorMessage);
 
     template <class... Args>
-    inline void logError(size_t line, size_t col, std::format_string<Args...> message, Args&&... args) noexcept {
-        logging::logError(line, col, message, std::forward<Args>(args)...);
+    inline void logError(io::SourceLocation location, std::format_string<Args...> message, Args&&... args) noexcept {
+        logging::logError(location, message, std::forward<Args>(args)...);
         hasError = true;
     }
 
@@ -162,19 +258,27 @@ class Parser {
     // ~ Helpers for lookups
     constexpr static size_t tokenToIndex(TokenType t) noexcept { return static_cast<size_t>(t); }
 
-    static void registerLedHandler_binary(TokenType type, Precedence precedence, ledHandler_t handler) noexcept;
-    static void registerLedHandler_postfix(TokenType type, Precedence precedence, ledHandler_t handler) noexcept;
-    static void registerLedHandler_prefix(TokenType type, Precedence precedence, ledHandler_t handler) noexcept;
-    static void registerLedHandler_type(TokenType type, Precedence precedence, ledHandler_types_t handler) noexcept;
-
-    static void registerNudHandler_binary(TokenType type, nudHandler_t handler) noexcept;
-    static void registerNudHandler_prefix(TokenType type, nudHandler_t handler) noexcept;
-    static void registerNudHandler_type(TokenType type, nudHandler_types_t handler) noexcept;
-
-    static void registerStmtHandler(TokenType type, statementHandler_t handler) noexcept;
-
-    static void initializeLookups() noexcept;
-    static void initializeTypeLookups() noexcept;
+    constexpr static void registerLedHandler_binary(ExpressionLookups& lookups, TokenType type, Precedence precedence,
+                                                    ledHandler_t handler) noexcept;
+    constexpr static void registerLedHandler_postfix(ExpressionLookups& lookups, TokenType type, Precedence precedence,
+                                                     ledHandler_t handler) noexcept;
+    constexpr static void registerLedHandler_prefix(ExpressionLookups& lookups, TokenType type, Precedence precedence,
+                                                    ledHandler_t handler) noexcept;
+    constexpr static void registerLedHandler_type(TypeLookups& lookups, TokenType type, Precedence precedence,
+                                                  ledHandler_types_t handler) noexcept;
+
+    constexpr static void registerNudHandler_binary(ExpressionLookups& lookups, TokenType type,
+                                                    nudHandler_t handler) noexcept;
+    constexpr static void registerNudHandler_prefix(ExpressionLookups& lookups, TokenType type,
+                                                    nudHandler_t handler) noexcept;
+    constexpr static void registerNudHandler_type(TypeLookups& lookups, TokenType type,
+                                                  nudHandler_types_t handler) noexcept;
+
+    constexpr static void registerStmtHandler(ExpressionLookups& lookups, TokenType type,
+                                              statementHandler_t handler) noexcept;
+
+    constexpr static ExpressionLookups makeLookups() noexcept;
+    constexpr static TypeLookups makeTypeLookups() noexcept;
 };
 
 }  // namespace parser
@@ -9,12 +9,21 @@
 #include <frontend/lexer.hpp>
 #include <frontend/lexer/token_type.hpp>
 #include <frontend/parser.hpp>
+#include <frontend/semantic/const_eval.hpp>
+#include <frontend/semantic/module_interface.hpp>
 #include <frontend/semantic/symbol_table.hpp>
 #include <frontend/semantic/type_context.hpp>
+#include <functional>
+#include <io/diagnostics.hpp>
 #include <mnstl/chunk_allocator.hxx>
 #include <mnstl/enum_matches.hxx>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 
 namespace Manganese {
@@ -37,16 +46,71 @@ struct [[nodiscard]] ContextGuard {
     ContextGuard& operator=(const ContextGuard&) = delete;
 };
 
-using _analyzer_base_t = ast::Visitor<Result, Result, Result>;
+enum class Compatible_t : std::int8_t {
+    Error = -1,
+    Warning = 0,
+    Valid = 1
+};
+
+// Why a conversion is an error or a warning
+enum class Incompatibility : uint8_t {
+    None,
+    UndeducedType,
+    // Between primitives
+    StringToBool,
+    StringToNonBool,
+    NonCharToString,
+    BoolConversion,
+    LosesPrecision,
+    TruncatesDecimals,
+    SignMismatch,
+    Narrowing,
+    // Between compound types
+    DifferentKinds,
+    AggregateConversion,
+    ArrayLengthMismatch,
+    ArrayElementMismatch,
+    ParameterCountMismatch,
+    ParameterTypeMismatch,
+    ParameterMutabilityMismatch,
+    GenericBaseMismatch,
+    TypeArgumentCountMismatch,
+    TypeArgumentMismatch,
+    PointerMutabilityMismatch
+};
+
+/**
+ * @brief What checking one top-level statement found, which can be kept for as long as nothing it depends on changes
+ */
+struct StatementCheck {
+    Result result = Result::Success;
+    logging::DiagnosticList diagnostics;
+    bool isStale = true;  // Whether the statement needs checking (again)
+};
+
+class analyzer;
+using _analyzer_base_t = ast::StaticVisitor<analyzer, Result, Result, Result>;
 
 class analyzer final : public _analyzer_base_t {
    private:
+    friend _analyzer_base_t;  // Dispatches to the (protected) visit() overloads below
+
     SymbolTable symbolTable;
-    TypeContext typeContext;
+    std::optional<TypeContext> ownedTypeContext;  // Empty for the checkers made by checkStatementsInParallel()
+    TypeContext& typeContext;
     parser::ParsedFile& parsedFile;
+    mnstl::chunk_allocator& arena;
+    size_t checkingThreads;
+
+    struct ImportedModule {
+        std::string name;  // What the importing file calls it (its alias, if it has one)
+        const ModuleInterface* interface;
+    };
+    std::vector<ImportedModule> importedModules;
 
+    // Per-checker state, so each thread checking in parallel has its own
     struct {
-        bool inFunction : 1 = false;
+        bool inFunction = false;
         uint8_t typeCastDepth = 0;
         uint8_t ifStatementDepth = 0;
         uint8_t switchStatementDepth = 0;
@@ -56,26 +120,97 @@ class analyzer final : public _analyzer_base_t {
         const SemanticType* currentVariableDeclarationType = nullptr;
     } context;
 
-    enum class Compatible_t : std::int8_t {
-        Error = -1,
-        Warning = 0,
-        Valid = 1
-    };
-
     struct typeCompatibilityResult {
-        const Compatible_t result;
-        const std::string message = "";
+        Compatible_t result;
+        Incompatibility reason = Incompatibility::None;
+        // The types the reason is about (e.g. two functions whose parameters differ), and the position involved
+        const SemanticType* from = nullptr;
+        const SemanticType* to = nullptr;
+        uint32_t position = 0;
 
         constexpr operator bool() const noexcept { return result != Compatible_t::Error; }
+        // Formatted on demand, so checks whose result is never reported don't pay for building a string
+        std::string message() const;
     };
 
+    struct CompatibilityKey {
+        const SemanticType* from;
+        const SemanticType* to;
+        bool inCondition, inCast;
+
+        bool operator==(const CompatibilityKey&) const noexcept = default;
+    };
+    struct CompatibilityKeyHash {
+        size_t operator()(const CompatibilityKey& key) const noexcept {
+            const std::hash<const SemanticType*> hashType;
+            const size_t hash = hashType(key.from) * 31 + hashType(key.to);
+            return (hash << 2) ^ (size_t{key.inCondition} << 1) ^ size_t{key.inCast};
+        }
+    };
+    // Compound types compared so far (via areTypesCompatible), per checker so that lookups need no locking
+    mutable std::unordered_map<CompatibilityKey, typeCompatibilityResult, CompatibilityKeyHash> compatibilityCache;
+    // Evaluates what must be known at compile time (e.g. array lengths), remembering calls per checker too
+    ConstEvaluator constEvaluator{symbolTable, typeContext};
+
+    // A checker for one thread of checkStatementsInParallel(), sharing everything `parent` has collected
+    analyzer(analyzer& parent, mnstl::chunk_allocator& taskArena) :
+        symbolTable(parent.symbolTable, taskArena),
+        typeContext(parent.typeContext),
+        parsedFile(parent.parsedFile),
+        arena(taskArena),
+        checkingThreads(1),
+        importedModules(parent.importedModules) {}
+
    public:
-    analyzer(parser::ParsedFile& file, mnstl::chunk_allocator& arena) :
-        symbolTable(arena), typeContext(arena), parsedFile(file) {}
+    /**
+     * @param threads How many threads check function bodies once every declaration has been collected (0 for one per
+     * hardware thread). Diagnostics come out in source order whatever the number
+     */
+    analyzer(parser::ParsedFile& file, mnstl::chunk_allocator& allocatorReference, size_t threads = 1) :
+        symbolTable(allocatorReference),
+        ownedTypeContext(std::in_place, allocatorReference),
+        typeContext(*ownedTypeContext),
+        parsedFile(file),
+        arena(allocatorReference),
+        checkingThreads(threads) {}
+
+    /**
+     * @brief Analyze with types from `sharedContext`, which (unlike an analyzer's own) outlives the analysis, so that the
+     * types it leaves on the AST stay valid for later analyses of the same program (see analyze(std::span))
+     */
+    analyzer(parser::ParsedFile& file, TypeContext& sharedContext, mnstl::chunk_allocator& allocatorReference) :
+        symbolTable(allocatorReference),
+        typeContext(sharedContext),
+        parsedFile(file),
+        arena(allocatorReference),
+        checkingThreads(1) {}
 
     Result analyze();
 
-    ~analyzer() override = default;
+    /**
+     * @brief Like analyze(), but only check the top-level statements whose check in `checks` is stale, keeping the rest
+     * @details `checks[i]` is the check of `program[i]`. Only function declarations are ever skipped: the other
+     * top-level statements can declare globals the functions rely on, so they are always checked. A statement's
+     * diagnostics go into its check rather than out (declaration errors, found before checking, still go out).
+     * If collecting the declarations fails, nothing is checked and every check is left stale
+     */
+    Result analyze(std::span<StatementCheck> checks);
+
+    /**
+     * @brief Make the public symbols of an already-analyzed module visible as `name::symbol`, without its source
+     * @note Call before analyze(). `interface` must outlive the analysis
+     */
+    void addImport(std::string_view name, const ModuleInterface& interface) {
+        importedModules.push_back(ImportedModule{.name = std::string(name), .interface = &interface});
+    }
+
+    /**
+     * @brief The file's public global declarations, as a ModuleInterface records them
+     * @note Call after analyze(). Only functions' types are known at this stage; other symbols have no type yet
+     */
+    std::vector<ExportedSymbol> exportedSymbols() const;
+
+    ~analyzer() = default;
 
    private:
     Result collectTypes();
@@ -84,32 +219,72 @@ class analyzer final : public _analyzer_base_t {
     Result _collectTypesInStatement(ast::Statement*);
     Result _collectTypesInStatementBody(const ast::Block&);
     Result collectGlobals();
+    /**
+     * @brief Give top-level aggregates and functions their types (so calls can be checked, and evaluated, before the
+     * callee's body is), and generic declarations the types they are specialized from
+     * @details A generic declaration's type mentions its parameters as TypeParameters. Each use of it with type
+     * arguments (e.g. Pair@[int32]) is specialized by TypeContext::specialize(), which makes each instance once and
+     * shares it with every other use (from any checking thread).
+     */
     Result collectAndSpecializeGenerics();
+    Result _declareTypeParameters(const std::vector<std::string>& names, ast::ASTNode* owner);
+    Result _resolveAggregate(ast::AggregateDeclarationStatement*);
+    Result _resolveSignature(ast::FunctionDeclarationStatement*);
+    // How many type parameters the declaration behind `symbol` has (0 if it isn't generic)
+    static size_t _typeParameterCount(const Symbol& symbol) noexcept;
+    /**
+     * @brief Specialize a generic declaration called `name`, whose type is `type` and which has `typeParameterCount` type
+     * parameters, reporting at `node` why it can't be (as nullptr)
+     */
+    const SemanticType* _specialize(size_t typeParameterCount, const SemanticType* type, std::string_view name,
+                                    std::span<const SemanticType* const> typeArguments, const ast::ASTNode* node);
+    const SemanticType* _specialize(const Symbol& symbol, std::string_view name,
+                                    std::span<const SemanticType* const> typeArguments, const ast::ASTNode* node) {
+        return _specialize(_typeParameterCount(symbol), symbol.type, name, typeArguments, node);
+    }
+    // The module imported as `name`, if there is one
+    const ImportedModule* _findImport(std::string_view name) const noexcept;
+    struct ImportedMember {
+        ModuleInterface::Symbol symbol;
+        const SemanticType* type;  // Rebuilt in this analyzer's type context
+    };
+    /**
+     * @brief Public member `member` of the module imported as `module` (e.g. `lib::Box`), reporting at `node` if there
+     * isn't one
+     */
+    std::optional<ImportedMember> _findImportedMember(std::string_view module, std::string_view member,
+                                                      const ast::ASTNode* node) const;
+    // Check sizeof/alignof (`property` says which) of `type`, which must have a layout
+    Result _checkLayoutQuery(ast::Expression* expression, ast::Type* type, std::string_view property);
+    // Report `type` (formed at `node`) if its parts all have layouts but together are too big for it to have one
+    Result _checkFitsInMemory(ast::ASTNode* node, const SemanticType* type);
     Result checkStatements();
+    Result checkStatementsInParallel();
 
     typeCompatibilityResult areTypesCompatible(const SemanticType* from, const SemanticType* to) const;
     typeCompatibilityResult arePrimitivesCompatible(const SemanticType* from, const SemanticType* to) const;
+    typeCompatibilityResult compareCompoundTypes(const SemanticType* from, const SemanticType* to) const;
     typeCompatibilityResult areTypesComparable(const SemanticType* lhs, const SemanticType* rhs) const;
     const SemanticType* promoteNumericTypes(const SemanticType* lhs, const SemanticType* rhs) const;
     Result analyzePointerArithmetic(const SemanticType* lhs, const SemanticType* rhs) const;
 
     template <class... Args>
     static void logError(const ast::ASTNode* node, std::format_string<Args...> message, Args&&... args) noexcept {
-        logging::logError(node->getLine(), node->getColumn(), message, std::forward<Args>(args)...);
+        logging::logError(node->getLocation(), message, std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static void logWarning(ast::ASTNode* node, std::format_string<Args...> message, Args&&... args) noexcept {
-        logging::logWarning(node->getLine(), node->getColumn(), message, std::forward<Args>(args)...);
+        logging::logWarning(node->getLocation(), message, std::forward<Args>(args)...);
     }
 
    protected:
     // overrides for visitor functions
     using _analyzer_base_t::visit;
 
-#define STMT(name, str) stmtvisit_t visit(ast::name*) override;
-#define EXPR(name, str) exprvisit_t visit(ast::name*) override;
-#define TYPE(name, str) typevisit_t visit(ast::name*) override;
+#define STMT(name, str) stmtvisit_t visit(ast::name*);
+#define EXPR(name, str) exprvisit_t visit(ast::name*);
+#define TYPE(name, str) typevisit_t visit(ast::name*);
 
 #include <frontend/ast/ast.def>
 
@@ -117,14 +292,23 @@ class analyzer final : public _analyzer_base_t {
 #undef EXPR
 #undef TYPE
 
+    /**
+     * @brief Stands in for the checks that haven't been written yet (static dispatch needs every overload to exist)
+     */
+    Result notYetAnalyzed(const ast::ASTNode* node) const noexcept {
+        // Formatting the node is only worth it where the message gets logged
+        LOG_INTERNAL(Warning, "Semantic analysis of '{}' is not implemented yet", node->toString());
+        return Result::Success;
+    }
+
     Result visit(std::nullptr_t) const noexcept {
-        logging::logInternal(logging::LogLevel::Warning, "visit() called on nullptr in analyzer");
+        LOG_INTERNAL(Warning, "visit() called on nullptr in analyzer");
         return Result::Failure;
     }
 
     Result visit(ast::Block& block) {
         Result result = Result::Success;
-        symbolTable.enterScope();
+        symbolTable.enterScope(&block);  // The scope recorded for this block while collecting types, if any
         for (ast::Statement* statement : block) {
             auto stmtResult = visit(statement);
             if (stmtResult == Result::Failure) { result = Result::Failure; }
@@ -0,0 +1,121 @@
+#ifndef MANGANESE_INCLUDE_FRONTEND_SEMANTIC_CONST_EVAL_HPP
+#define MANGANESE_INCLUDE_FRONTEND_SEMANTIC_CONST_EVAL_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_type.hpp>
+#include <frontend/semantic/symbol_table.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <memory>
+#include <mnstl/fold_result.hxx>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Manganese {
+namespace semantic {
+
+/**
+ * @brief Evaluates the expressions that must be known at compile time (e.g. array lengths), including calls to
+ * ordinary functions, casts, sizeof/alignof, and aggregate and array values
+ * @details Where fold() only combines literals, this compiles what an expression needs (the expression itself, then
+ * each function it calls, once) to bytecode for a small register machine, and runs that. Frames live on an explicit
+ * stack, so deep recursion can't overflow the compiler's own, and a step budget bounds the work, so evaluating
+ * something that never finishes is an error rather than a hang. Scalar results of calls are remembered by callee and
+ * arguments, which makes repeated (and recursive, e.g. fib(n - 1) + fib(n - 2)) calls cheap.
+ * Function bodies are read without relying on anything the analyzer records on them, so a function can be evaluated
+ * while another thread is still checking it. Each checker has its own evaluator: none of this is shared.
+ */
+class ConstEvaluator {
+   public:
+    constexpr static inline size_t DEFAULT_STEP_BUDGET = size_t{1} << 22;
+    constexpr static inline size_t MAX_CALL_DEPTH = 1024;
+
+    ConstEvaluator(const SymbolTable& symbols, TypeContext& types, size_t stepBudget = DEFAULT_STEP_BUDGET) noexcept :
+        _symbols(symbols), _types(types), _stepBudget(stepBudget) {}
+
+    ConstEvaluator(const ConstEvaluator&) = delete;
+    ConstEvaluator& operator=(const ConstEvaluator&) = delete;
+
+    /**
+     * @brief The value of `expression`, or nullopt (having logged why) if it can't be evaluated at compile time
+     * @param expression Must have been checked already, on this thread (the types recorded on it are read)
+     */
+    std::optional<mnstl::fold_result_t> evaluate(const ast::Expression* expression);
+
+    /**
+     * @brief How many instructions the last evaluate() ran
+     */
+    size_t stepsTaken() const noexcept { return _steps; }
+
+   private:
+    // A scalar, or an aggregate or array whose elements are `count` consecutive values in _elements
+    struct Value {
+        mnstl::fold_result_t scalar = {};  // Nothing, for aggregates and arrays
+        uint32_t first = 0, count = 0;
+        bool isCompound = false;
+    };
+
+    enum class Op : uint8_t {
+        Constant,  // a = constants[b]
+        Move,  // a = b
+        Unary,  // a = operation b
+        Binary,  // a = b operation c
+        RequireBool,  // Fail unless a is a boolean (the right operand of a short-circuiting && or ||)
+        Cast,  // a = b as primitive
+        Jump,  // Continue at b
+        JumpIfFalse,  // Continue at b if a is false
+        JumpIfTrue,  // Continue at b if a is true
+        Call,  // a = callees[b](c, ..., c + parameter count - 1)
+        Return,  // Return a (or nothing, if b is 0)
+        MakeCompound,  // a = {c, ..., c + count - 1}, fields named by names[b...] (unnamed if b is NO_NAMES)
+        GetField,  // a = b.names[c]
+        Index,  // a = b[c]
+    };
+    constexpr static inline uint32_t NO_NAMES = UINT32_MAX;
+
+    struct Instruction {
+        Op op;
+        lexer::TokenType operation{};
+        ast::PrimitiveType_t primitive = ast::PrimitiveType_t::not_primitive;
+        uint32_t a = 0, b = 0, c = 0, count = 0;
+        const ast::ASTNode* node = nullptr;  // Where errors running this are reported
+    };
+
+    // A compiled function (or the expression being evaluated), whose parameters are its first registers
+    struct Chunk {
+        std::string_view name;
+        std::vector<Instruction> code;
+        std::vector<mnstl::fold_result_t> constants;
+        std::vector<std::string_view> names;
+        std::vector<const ast::FunctionDeclarationStatement*> callees;
+        std::vector<ast::PrimitiveType_t> parameterTypes;  // not_primitive for parameters passed as they are
+        ast::PrimitiveType_t returnType = ast::PrimitiveType_t::not_primitive;
+        bool returnsValue = false;
+        uint32_t registerCount = 0;
+    };
+
+    class Compiler;
+
+    const SymbolTable& _symbols;
+    TypeContext& _types;
+    size_t _stepBudget;
+    size_t _steps = 0;
+    std::vector<Value> _elements;
+    std::vector<std::string_view> _elementNames;  // Each element's field name (empty in arrays)
+    // nullptr for functions that can't be evaluated at compile time, so they are only reported once
+    std::unordered_map<const ast::FunctionDeclarationStatement*, std::unique_ptr<Chunk>> _functions;
+    std::unordered_map<std::string, mnstl::fold_result_t> _results;  // By callee and arguments
+
+    const Chunk* _compiled(const ast::FunctionDeclarationStatement* function);
+    std::optional<Value> _run(const Chunk& entry);
+};
+
+}  // namespace semantic
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_FRONTEND_SEMANTIC_CONST_EVAL_HPP
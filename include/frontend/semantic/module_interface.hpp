@@ -0,0 +1,126 @@
+#ifndef MANGANESE_INCLUDE_FRONTEND_SEMANTIC_MODULE_INTERFACE_HPP
+#define MANGANESE_INCLUDE_FRONTEND_SEMANTIC_MODULE_INTERFACE_HPP
+
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <frontend/semantic/symbol_table.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/mappedfilereader.hpp>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace semantic {
+
+/**
+ * @brief A declaration that a module makes visible to the modules importing it
+ */
+struct ExportedSymbol {
+    std::string_view name;
+    SymbolKind kind = SymbolKind::Invalid;
+    bool isMutable = false;
+    const SemanticType* type = nullptr;  // nullptr if it isn't known (e.g. aggregates, until they are analyzed)
+    uint32_t typeParameterCount = 0;  // Non-zero for a generic declaration, which importers specialize themselves
+};
+
+/**
+ * @brief The public declarations of an analyzed module, in a compact binary form that importers can load (e.g.
+ * memory-mapped from a file) instead of analyzing the module's source again
+ * @details The buffer is a sequence of 32-bit words in the host's byte order (a buffer from a host with the other
+ * byte order is rejected by its magic number). Offsets count bytes from the start of the buffer, and types are
+ * referred to by their index in the type table. In order, it holds:
+ *  - A header: the magic number, the format version, a content hash of the module's source, the module's name, and
+ *    where each of the sections below starts
+ *  - The type table: an offset to each type's record. A record only refers to types before it in the table, so each
+ *    type can be rebuilt from types that already have been
+ *  - The symbols, four words each (name offset, name length, type, and the kind, mutability and number of type
+ *    parameters), sorted by name so that finding one is a binary search
+ *  - The characters of every name (the module's, the symbols', aggregates' and their fields', and type parameters')
+ * A buffer is validated once, when it is loaded, so nothing read from it afterwards needs checking.
+ */
+class ModuleInterface {
+   public:
+    constexpr static inline uint32_t VERSION = 3;
+    constexpr static inline uint32_t NO_TYPE = std::numeric_limits<uint32_t>::max();  // Unknown, or void
+    constexpr static inline std::string_view FILE_EXTENSION = ".mni";
+
+    // A symbol as stored (the type is an index into the type table, so it can be rebuilt with resolveType())
+    struct Symbol {
+        std::string_view name;
+        SymbolKind kind;
+        bool isMutable;
+        uint32_t type;
+        uint32_t typeParameterCount;
+    };
+
+   private:
+    std::vector<char> ownedBytes;  // The buffer, if it was handed over as bytes
+    std::unique_ptr<io::MappedFileReader> mapping;  // Or the file it was mapped from
+    std::string_view bytes;  // Whichever of the two it is
+
+    uint32_t typeCount = 0, typeTable = 0, symbolCount = 0, symbols = 0;
+
+    uint32_t word(size_t offset) const noexcept {
+        uint32_t value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    }
+    std::string_view string(size_t offset) const noexcept {
+        return bytes.substr(word(offset), word(offset + 4));  // An (offset, length) pair
+    }
+    Symbol symbolAt(size_t index) const noexcept;
+
+    // Check that every offset, type reference and symbol in the buffer is well-formed
+    bool validate() noexcept;
+    static std::optional<ModuleInterface> load(ModuleInterface interface);
+
+   public:
+    /**
+     * @brief Encode the interface of module `moduleName`, whose source hashes to `contentHash`
+     * @note Symbols with the same name must not appear twice (as they can't in a module's global scope)
+     */
+    static std::vector<char> encode(std::string_view moduleName, uint64_t contentHash,
+                                    std::span<const ExportedSymbol> exports);
+
+    /**
+     * @brief Load an encoded interface, which is kept alive by the returned object
+     * @return The interface, or nothing if `encoded` isn't a valid interface (of this version)
+     */
+    static std::optional<ModuleInterface> fromBytes(std::vector<char> encoded);
+
+    /**
+     * @brief Memory-map an interface file (e.g. one written from encode()'s output)
+     * @return The interface, or nothing if the file can't be mapped or isn't a valid interface (of this version)
+     */
+    static std::optional<ModuleInterface> open(const std::string& path);
+
+    // The encoded buffer, e.g. to write to a file
+    std::string_view data() const noexcept { return bytes; }
+    std::string_view moduleName() const noexcept { return string(16); }
+    uint64_t contentHash() const noexcept { return word(8) | (uint64_t{word(12)} << 32); }
+
+    size_t size() const noexcept { return symbolCount; }
+    Symbol symbol(size_t index) const noexcept { return symbolAt(index); }
+
+    /**
+     * @brief The exported symbol called `name`, if there is one
+     */
+    std::optional<Symbol> find(std::string_view name) const noexcept;
+
+    /**
+     * @brief Rebuild type `type` (as referred to by a Symbol) in `context`
+     * @return The type, or nullptr for NO_TYPE
+     */
+    const SemanticType* resolveType(uint32_t type, TypeContext& context) const;
+};
+
+}  // namespace semantic
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_FRONTEND_SEMANTIC_MODULE_INTERFACE_HPP
@@ -3,17 +3,21 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <core.hpp>
 #include <format>
 #include <frontend/ast.hpp>
-#include <functional>
+#include <frontend/lexer.hpp>
 #include <io/logging.hpp>
 #include <mnstl/chunk_allocator.hxx>
+#include <mnstl/flat_map.hxx>
+#include <mnstl/string_pool.hxx>
+#include <memory_resource>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <utils/result.hpp>
+#include <utils/time_report.hpp>
 #include <vector>
 
 namespace Manganese {
@@ -35,7 +39,7 @@ enum class SymbolKind : uint8_t {
 };
 
 struct Symbol {
-    SemanticType* type = nullptr;
+    const SemanticType* type = nullptr;
     ast::ASTNode* node = nullptr;
     SymbolKind kind;
     ast::Visibility visibility = ast::Visibility::Private;
@@ -43,22 +47,36 @@ struct Symbol {
     std::string toString() const noexcept;
 };
 
+using atom_t = mnstl::string_pool::atom_t;
+
 struct Scope {
-    // std::equal_to<> enables heterogenous lookup (e.g. looking up with std::string or const char*)
-    // so explicit conversions are not required
-    std::unordered_map<std::string_view, Symbol, std::hash<std::string_view>, std::equal_to<>> symbols;
+    // Symbols are keyed by their interned name (see lexer::identifierPool()), so lookups hash and compare integers.
+    // Most scopes are small block scopes, whose symbols never leave the inline storage
+    mnstl::flat_map<atom_t, Symbol> symbols;
     Scope* parent = nullptr;
-    std::vector<Scope*> children;
+    mnstl::arena_vector<Scope*> children;
     size_t currentChildIndex = 0;
+    // In a fork of the symbol table, the recorded (shared) scope this one adds declarations to
+    Scope* extends = nullptr;
 
-    inline Result insert(std::string_view name, Symbol symbol) {
-        bool emplace_succeeded = symbols.emplace(name, std::move(symbol)).second;
+    // Both containers allocate from `resource` (normally the symbol table's arena)
+    explicit Scope(std::pmr::memory_resource* resource) : symbols(resource), children(resource) {}
+
+    inline Result insert(atom_t name, Symbol symbol) {
+        bool emplace_succeeded = symbols.try_emplace(name, std::move(symbol)).second;
         return emplace_succeeded ? Result::Success : Result::Failure;
     }
+    inline Result insert(std::string_view name, Symbol symbol) {
+        return insert(lexer::identifierPool().intern(name), std::move(symbol));
+    }
 
+    [[nodiscard]] inline const Symbol* lookup(atom_t name) const noexcept {
+        return symbols.find(name);
+    }
     [[nodiscard]] inline const Symbol* lookup(std::string_view name) const noexcept {
-        auto it = symbols.find(name);
-        return it == symbols.end() ? nullptr : &(it->second);
+        // A name that was never interned can't have been declared anywhere
+        const atom_t atom = lexer::identifierPool().find(name);
+        return atom == mnstl::string_pool::invalid_atom ? nullptr : lookup(atom);
     }
 };
 
@@ -67,15 +85,84 @@ class SymbolTable {
     mnstl::chunk_allocator& _arena;
     Scope* _root;
     Scope* _currentScope;
+    // For each atom, the visible scopes declaring it, innermost last, so resolving a name doesn't walk the scope chain.
+    // The scope (rather than the symbol) is recorded because a symbol can move when its scope's map grows
+    std::vector<std::vector<Scope*>> _bindings;
+    // The scope recorded for each owner passed to enterScope(const void*), keyed by address
+    mnstl::flat_map<uintptr_t, Scope*> _scopeOwners;
+    const SymbolTable* _shared = nullptr;  // The table this one was forked from, if any
     struct {
         bool _isFirstPass : 1 = true;  // Toggles table from allocation mode to tree-tracking mode
     } _flags;
 
     inline bool noScopeAvailable() const noexcept { return _currentScope == nullptr; }
 
+    Scope* newChildScope() {
+        Scope* scope = newScope();
+        timing::count(timing::Counter::Scopes);
+        scope->parent = _currentScope;
+        // Children are only needed to replay pass 1, and a fork's parent scope may be shared
+        if (!_shared) { _currentScope->children.push_back(scope); }
+        return scope;
+    }
+
+    /**
+     * @brief Make `target` the current scope, updating which symbols are visible to match
+     */
+    void moveTo(Scope* target) {
+        if (target->parent == _currentScope) {
+            // The usual case: entering a child of the current scope
+            bindAll(target);
+            _currentScope = target;
+            return;
+        }
+        std::vector<Scope*> path;  // From target up to the root
+        for (Scope* s = target; s; s = s->parent) { path.push_back(s); }
+        auto onPath = [&](Scope* s) { return std::find(path.begin(), path.end(), s) != path.end(); };
+        Scope* common = _currentScope;
+        for (; common && !onPath(common); common = common->parent) { unbindAll(common); }
+        // Bind from just below the common ancestor back down to the target
+        auto it = std::find(path.begin(), path.end(), common);
+        while (it != path.begin()) { bindAll(*--it); }
+        _currentScope = target;
+    }
+
+    void bind(atom_t name, Scope* scope) {
+        if (name >= _bindings.size()) { _bindings.resize(name + 1); }
+        _bindings[name].push_back(scope);
+    }
+    void bindAll(Scope* scope) {
+        scope->symbols.for_each([&](atom_t name, const Symbol&) { bind(name, scope); });
+    }
+    void unbindAll(Scope* scope) noexcept {
+        scope->symbols.for_each([&](atom_t name, const Symbol&) { _bindings[name].pop_back(); });
+    }
+    // The innermost visible scope declaring `name`, if any
+    Scope* innermostBinding(atom_t name) const noexcept {
+        if (name >= _bindings.size() || _bindings[name].empty()) { return nullptr; }
+        return _bindings[name].back();
+    }
+    Scope* newScope() {
+        mnstl::chunk_allocator::tag_scope tag(_arena, mnstl::alloc_tag::scopes);
+        return _arena.emplace<Scope>(_arena.resource());
+    }
+
    public:
     SymbolTable(mnstl::chunk_allocator& arena) noexcept :
-        _arena(arena), _root(_arena.emplace<Scope>()), _currentScope(_root) {}
+        _arena(arena), _root(newScope()), _currentScope(_root), _scopeOwners(arena.resource()) {}
+
+    /**
+     * @brief A checking-mode view of `shared` for one task, such as checking a single function on another thread
+     * Scopes recorded by `shared` are only ever read: entering one makes a scope of the fork's own (allocated from
+     * `arena`) that extends it, and declarations go there. So any number of forks can check the program at once.
+     * @note `shared` must be in checking mode, outlive the fork, and not change while the fork is in use. A fork can
+     * declare names that aren't interned yet, since lexer::identifierPool() can be interned into from any thread
+     */
+    SymbolTable(const SymbolTable& shared, mnstl::chunk_allocator& arena) :
+        _arena(arena), _root(shared._root), _currentScope(_root), _scopeOwners(arena.resource()), _shared(&shared) {
+        _flags._isFirstPass = false;
+        bindAll(_root);
+    }
 
     ~SymbolTable() noexcept = default;
 
@@ -90,66 +177,133 @@ class SymbolTable {
 
         resetIndices(resetIndices, _root);
         _currentScope = _root;
+        // Only the global scope is visible again until pass 2 re-enters the others
+        for (std::vector<Scope*>& stack : _bindings) { stack.clear(); }
+        bindAll(_root);
     }
 
+    /**
+     * @brief Enter a new scope (pass 1), or the next one recorded under the current scope (pass 2)
+     */
     void enterScope() {
         if (_flags._isFirstPass) {
-            // Allocate memory to build a new scope
-            Scope* newScope = _arena.emplace<Scope>();
-            newScope->parent = _currentScope;
-
-            _currentScope->children.push_back(newScope);
-            _currentScope = newScope;
+            _currentScope = newChildScope();
         } else {
             // Retrieve the next child scope in the same order it was recorded in in pass 1
             if (_currentScope->currentChildIndex >= _currentScope->children.size()) [[unlikely]] {
-                logging::logInternal(logging::LogLevel::Error, "Mismatched scope structural traversal");
+                LOG_INTERNAL(Error, "Mismatched scope structural traversal");
                 return;
             }
             _currentScope = _currentScope->children[_currentScope->currentChildIndex++];
+            bindAll(_currentScope);
         }
     }
 
+    /**
+     * @brief Enter the scope belonging to `owner` (e.g. the ast::Block it is the scope of), creating it the first time
+     * Unlike the replay done by enterScope(), this doesn't depend on scopes being entered in the same order (or at all)
+     * in both passes, so the checking pass can start from any recorded scope, such as a single function's body.
+     */
+    void enterScope(const void* owner) {
+        if (_shared) {
+            Scope* const* recorded = _shared->_scopeOwners.find(reinterpret_cast<uintptr_t>(owner));
+            _currentScope = newChildScope();
+            if (recorded) {
+                _currentScope->extends = *recorded;
+                bindAll(*recorded);
+            }
+            return;
+        }
+        if (Scope** recorded = _scopeOwners.find(reinterpret_cast<uintptr_t>(owner))) {
+            moveTo(*recorded);
+            return;
+        }
+        _currentScope = newChildScope();
+        DISCARD(_scopeOwners.try_emplace(reinterpret_cast<uintptr_t>(owner), _currentScope));
+    }
+
     void exitScope() noexcept {
         if (noScopeAvailable() || !_currentScope->parent) [[unlikely]] {
-            logging::logInternal(logging::LogLevel::Warning,
-                                 "Attempted to exit scope when no parent scope was available");
+            LOG_INTERNAL(Warning, "Attempted to exit scope when no parent scope was available");
             return;
         }
+        unbindAll(_currentScope);
+        if (_currentScope->extends) { unbindAll(_currentScope->extends); }
         _currentScope = _currentScope->parent;
     }
 
-    Result declare(std::string_view name, Symbol symbol) {
+    Result declare(atom_t name, Symbol symbol) {
         if (noScopeAvailable()) [[unlikely]] {
-            logging::logInternal(logging::LogLevel::Error, "No active scope in which to declare a symbol");
+            LOG_INTERNAL(Error, "No active scope in which to declare a symbol");
             return Result::Failure;
         }
-        return _currentScope->insert(name, std::move(symbol));
+        if (_shared && _currentScope == _root) [[unlikely]] {
+            LOG_INTERNAL(Error, "A fork of the symbol table cannot declare globals");
+            return Result::Failure;
+        }
+        if (_currentScope->extends && _currentScope->extends->lookup(name)) { return Result::Failure; }
+        if (_currentScope->insert(name, std::move(symbol)) == Result::Failure) { return Result::Failure; }
+        bind(name, _currentScope);
+        return Result::Success;
+    }
+    Result declare(std::string_view name, Symbol symbol) {
+        return declare(lexer::identifierPool().intern(name), std::move(symbol));
     }
 
+    /**
+     * @brief Resolve a name to its innermost visible declaration, or nullptr if there isn't one
+     * @note Constant time whatever the nesting depth, and a miss is silent (reporting it is up to the caller)
+     */
+    const Symbol* lookup(atom_t name) const noexcept {
+        const Scope* scope = innermostBinding(name);
+        return scope ? scope->lookup(name) : nullptr;
+    }
     const Symbol* lookup(std::string_view name) const noexcept {
-        // Safe, upward lexical lookup through parent scopes without index array tracking
-        const Scope* probe = _currentScope;
-        while (probe) {
-            const Symbol* symbol = probe->lookup(name);
-            if (symbol) { return symbol; }
-            probe = probe->parent;
+        // A name that was never interned can't have been declared anywhere
+        const atom_t atom = lexer::identifierPool().find(name);
+        return atom == mnstl::string_pool::invalid_atom ? nullptr : lookup(atom);
+    }
+
+    /**
+     * @brief Resolve a name in the global scope only, whatever the current scope (and whatever it shadows)
+     * @note Safe to call from any fork of the table, since globals are never changed once checking starts
+     */
+    const Symbol* lookupGlobal(std::string_view name) const noexcept { return _root->lookup(name); }
+
+    /**
+     * @brief Give global `name` its type, for declarations whose type is only known once the globals are collected
+     * (e.g. an aggregate's, which depends on the types of its fields)
+     * @note Not for forks of the table, whose globals are shared
+     */
+    void setGlobalType(atom_t name, const SemanticType* type) noexcept {
+        if (_shared) [[unlikely]] {
+            LOG_INTERNAL(Error, "A fork of the symbol table cannot change globals");
+            return;
         }
+        if (Symbol* symbol = _root->symbols.find(name)) { symbol->type = type; }
+    }
 
-        logging::logInternal(logging::LogLevel::Warning, "Symbol '{}' not found in any visible lexical scope.", name);
-        return nullptr;
+    /**
+     * @brief Call `fn(name, symbol)` for every symbol declared in the global scope, in no particular order
+     */
+    template <class Fn>
+    void forEachGlobal(Fn&& fn) const {
+        _root->symbols.for_each(
+            [&](atom_t name, const Symbol& symbol) { fn(lexer::identifierPool().view(name), symbol); });
     }
 
-    const Symbol* lookupAtCurrentDepth(std::string_view name) const noexcept {
+    const Symbol* lookupAtCurrentDepth(atom_t name) const noexcept {
         if (noScopeAvailable()) {
-            logging::logInternal(logging::LogLevel::Error, "No active scope in which to look up symbol");
+            LOG_INTERNAL(Error, "No active scope in which to look up symbol");
             return nullptr;
         }
-        const Symbol* symbol = _currentScope->lookup(name);
-        if (!symbol) {
-            logging::logInternal(logging::LogLevel::Warning, "Symbol '{}' not found at current local depth", name);
-        }
-        return symbol;
+        const Scope* scope = innermostBinding(name);
+        const bool atCurrentDepth = scope && (scope == _currentScope || scope == _currentScope->extends);
+        return atCurrentDepth ? scope->lookup(name) : nullptr;
+    }
+    const Symbol* lookupAtCurrentDepth(std::string_view name) const noexcept {
+        const atom_t atom = lexer::identifierPool().find(name);
+        return atom == mnstl::string_pool::invalid_atom ? nullptr : lookupAtCurrentDepth(atom);
     }
 };
 
@@ -1,13 +1,21 @@
 #ifndef MANGANESE_INCLUDE_FRONTEND_SEMANTIC_TYPE_CONTEXT_HPP
 #define MANGANESE_INCLUDE_FRONTEND_SEMANTIC_TYPE_CONTEXT_HPP 1
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <frontend/ast.hpp>
+#include <frontend/lexer.hpp>
+#include <memory_resource>
 #include <mnstl/chunk_allocator.hxx>
+#include <mnstl/flat_map.hxx>
+#include <mnstl/string_pool.hxx>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <string>
-#include <type_traits>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -23,6 +31,7 @@ enum class Kind : uint8_t {
     Generic,
     Pointer,
     Primitive,
+    TypeParameter,
 };
 
 struct SemanticType {
@@ -41,18 +50,40 @@ struct SemanticType {
     constexpr bool isGeneric() const noexcept { return kind == Kind::Generic; }
     constexpr bool isPointer() const noexcept { return kind == Kind::Pointer; }
     constexpr bool isPrimitive() const noexcept { return kind == Kind::Primitive; }
+    constexpr bool isTypeParameter() const noexcept { return kind == Kind::TypeParameter; }
     constexpr bool isBoolean() const noexcept {
         return isPrimitive() && primitiveType == ast::PrimitiveType_t::boolean;
     }
 
     virtual std::string toString() const { return std::string(ast::primitiveTypeToString(primitiveType)); }
 
+    // The structural hash TypeContext interned this type under (computed once, when the type was created)
+    constexpr size_t hash() const noexcept { return _hash; }
+
    private:
+    size_t _hash = 0;
+
     constexpr SemanticType() noexcept : kind(Kind::Primitive), primitiveType(ast::PrimitiveType_t::not_primitive) {}
 
     friend class TypeContext;
 };
 
+/**
+ * @brief Where a type's values sit in memory: how many bytes one takes, and what its address must be a multiple of
+ */
+struct Layout {
+    uint64_t size;
+    uint64_t alignment;
+
+    bool operator==(const Layout&) const noexcept = default;
+};
+
+/**
+ * @brief The layout of `type`, or nullopt if it doesn't have one (yet), as with a type parameter (or anything made
+ * from one) or void (nullptr), or if it is too big for its size to fit in 64 bits
+ */
+std::optional<Layout> layoutOf(const SemanticType* type) noexcept;
+
 struct AggregateField {
     std::string_view name;  // empty for anonymous aggregates
     const SemanticType* type;
@@ -62,22 +93,47 @@ struct AggregateField {
 
 struct Aggregate final : public SemanticType {
     std::vector<AggregateField> fields;
+    const mnstl::string_pool::atom_t nameAtom;  // Named aggregates are nominal, so hash and compare by this
     const std::string_view name;
-
-    Aggregate(std::vector<AggregateField>&& fieldTypes, std::string_view aggregateName = "") noexcept :
-        SemanticType(Kind::Aggregate), fields(std::move(fieldTypes)), name(aggregateName) {}
+    // Computed once, when the aggregate is created (see _layOut()); nullopt if a field has no layout or they're too big
+    std::optional<Layout> layout;
+    std::vector<uint64_t> fieldOffsets;  // In bytes, by field index (empty without a layout)
+    // Each named field's index, by its name's atom in lexer::identifierPool(), so finding a field doesn't compare names
+    mnstl::flat_map<mnstl::string_pool::atom_t, uint32_t> fieldIndices;
+
+    Aggregate(std::pmr::memory_resource* resource, std::vector<AggregateField>&& fieldTypes,
+              std::string_view aggregateName = "") :
+        SemanticType(Kind::Aggregate),
+        fields(std::move(fieldTypes)),
+        nameAtom(lexer::identifierPool().intern(aggregateName)),
+        name(lexer::identifierPool().view(nameAtom)),
+        fieldIndices(resource) {
+        _layOut();
+    }
 
     // For anonymous aggregates
-    Aggregate(std::vector<const SemanticType*>&& rawTypes) noexcept : SemanticType(Kind::Aggregate), name("") {
+    Aggregate(std::pmr::memory_resource* resource, std::vector<const SemanticType*>&& rawTypes) :
+        SemanticType(Kind::Aggregate), nameAtom(mnstl::string_pool::empty_atom), name(""), fieldIndices(resource) {
         fields.reserve(rawTypes.size());
         for (const SemanticType* t : rawTypes) { fields.push_back(AggregateField{.name = "", .type = t}); }
+        _layOut();
     }
 
-    const SemanticType* getFieldType(const std::string_view& fieldName) const noexcept {
-        for (const AggregateField& field : fields) {
-            if (field.name == fieldName) { return field.type; }
-        }
-        return nullptr;
+    /**
+     * @brief The index of the field whose name is `fieldAtom` (an atom in lexer::identifierPool()), or -1 if there is
+     * no such field
+     */
+    int64_t getFieldIndex(mnstl::string_pool::atom_t fieldAtom) const noexcept {
+        const uint32_t* index = fieldIndices.find(fieldAtom);
+        return index ? int64_t{*index} : -1;
+    }
+
+    const SemanticType* getFieldType(std::string_view fieldName) const noexcept {
+        // A name that was never interned can't be any field's
+        const mnstl::string_pool::atom_t fieldAtom = lexer::identifierPool().find(fieldName);
+        if (fieldAtom == mnstl::string_pool::invalid_atom) { return nullptr; }
+        const int64_t index = getFieldIndex(fieldAtom);
+        return index < 0 ? nullptr : fields[static_cast<size_t>(index)].type;
     }
 
     const SemanticType* getFieldType(size_t index) const noexcept {
@@ -88,6 +144,10 @@ struct Aggregate final : public SemanticType {
     ~Aggregate() override = default;
 
     std::string toString() const override;
+
+   private:
+    // Index the fields by name, and (if every field has a layout) place each at the next offset its alignment allows
+    void _layOut();
 };
 
 struct Array final : public SemanticType {
@@ -129,9 +189,12 @@ struct Function final : public SemanticType {
 struct GenericInstance final : public SemanticType {
     const SemanticType* baseType;
     std::vector<const SemanticType*> typeArguments;
+    // The base type with the arguments substituted in (see TypeContext::specialize()), once it has been made. Since
+    // instances are interned, this makes each (generic declaration, type arguments) pair be specialized only once
+    mutable std::atomic<const SemanticType*> specialization = nullptr;
 
-    GenericInstance(const SemanticType* base, std::vector<const SemanticType*>&& args) noexcept :
-        SemanticType(Kind::Generic), baseType(base), typeArguments(std::move(args)) {}
+    GenericInstance(const SemanticType* base, std::span<const SemanticType* const> args) :
+        SemanticType(Kind::Generic), baseType(base), typeArguments(args.begin(), args.end()) {}
 
     ~GenericInstance() override = default;
     std::string toString() const override;
@@ -147,25 +210,52 @@ struct Pointer final : public SemanticType {
     std::string toString() const override;
 };
 
-struct TypeLookup {
-    using is_transparent = void;  // enables heterogenous lookup inside std::unordered_set
-    using kind_int_t = std::underlying_type_t<Kind>;
-    using prim_int_t = std::underlying_type_t<ast::PrimitiveType_t>;
-
-    // Hashing
-    size_t operator()(const SemanticType* t) const noexcept;
+/**
+ * @brief A generic declaration's type parameter (e.g. the T in `aggregate Pair[T]`), which stands in for its type
+ * argument in the declaration's type until it is specialized
+ */
+struct TypeParameter final : public SemanticType {
+    const std::string_view name;
+    const uint32_t index;  // Its position in the declaration's type parameters
 
-    // Lookup
-    bool operator()(const SemanticType* lhs, const SemanticType* rhs) const noexcept;
+    TypeParameter(std::string_view _name, uint32_t _index) noexcept :
+        SemanticType(Kind::TypeParameter), name(_name), index(_index) {}
+    ~TypeParameter() override = default;
+    std::string toString() const override { return std::string(name); }
 };
 
+/**
+ * @brief Creates and deduplicates (hash-conses) semantic types, so that equal types can be compared by address
+ * @details Safe to use from several threads at once (e.g. while checking functions in parallel). The table is split
+ * into shards by hash, each with its own lock, and most requests are for types that already exist, so threads rarely
+ * wait on each other: lookups share a shard's lock and only creating a new type takes it exclusively.
+ * Lookups hash and compare a lightweight key (e.g. a span over the requested parameters) against each type's stored
+ * hash and fields, so a request for an existing type doesn't build (or allocate for) a candidate type first.
+ */
 class TypeContext {
    private:
     mnstl::chunk_allocator& _allocator;
     constexpr static inline unsigned NUM_PRIMITIVES = static_cast<unsigned>(ast::PrimitiveType_t::boolean) + 1;
+    constexpr static inline unsigned SHARD_BITS = 4;
+
+    // One slice of the table: open addressing (with linear probing) over types, which each carry their own hash
+    struct Shard {
+        std::shared_mutex mutex;
+        std::vector<const SemanticType*> slots;  // nullptr for empty slots; the size is zero or a power of two
+        size_t size = 0;
+    };
 
-    std::unordered_set<const SemanticType*, TypeLookup, TypeLookup> _cache;
     std::array<SemanticType, NUM_PRIMITIVES> _primitives;
+    std::array<Shard, size_t{1} << SHARD_BITS> _shards;
+    std::mutex _allocatorMutex;  // Every shard allocates from the one arena
+
+    /**
+     * @brief The interned type matching `key`, or the one `create()` makes (and interns) if there isn't one yet
+     */
+    template <class Key, class Create>
+    const SemanticType* _intern(const Key& key, Create&& create);
+
+    const SemanticType* _substitute(const SemanticType* type, std::span<const SemanticType* const> arguments);
 
     template <std::size_t... Is>
     constexpr static std::array<SemanticType, sizeof...(Is)> _makePrimitives(std::index_sequence<Is...>) noexcept {
@@ -193,7 +283,25 @@ class TypeContext {
     const SemanticType* getFunction(std::vector<Parameter>&& parameterTypes, const SemanticType* returnType);
 
     const SemanticType* getGenericInstance(const SemanticType* baseType,
-                                           std::vector<const SemanticType*>&& typeArguments);
+                                           std::span<const SemanticType* const> typeArguments);
+
+    /**
+     * @param name Must outlive the context (e.g. be interned in lexer::identifierPool())
+     */
+    const SemanticType* getTypeParameter(std::string_view name, uint32_t index);
+
+    /**
+     * @brief A generic declaration's type (`genericType`, in which its parameters are TypeParameters) with
+     * `typeArguments` substituted for its parameters, e.g. aggregate Pair { first: int32 } for Pair@[int32]
+     * @details Each instance is specialized once, and shared from then on by whoever asks for it (from any thread,
+     * and through module interfaces, from any module importing this one). While an argument still depends on a type
+     * parameter (as in another generic declaration), this is the GenericInstance itself, which is specialized when
+     * that declaration is.
+     */
+    const SemanticType* specialize(const SemanticType* genericType, std::span<const SemanticType* const> typeArguments);
+
+    // Whether a type mentions a type parameter anywhere, so can't be specialized yet
+    static bool dependsOnTypeParameters(const SemanticType* type) noexcept;
 };
 
 }  // namespace semantic
@@ -0,0 +1,88 @@
+#ifndef MANGANESE_INCLUDE_IO_BUFFERREADER_HPP
+#define MANGANESE_INCLUDE_IO_BUFFERREADER_HPP
+
+#include <algorithm>
+#include <core.hpp>
+#include <cstddef>
+#include <io/reader.hpp>
+#include <string_view>
+
+namespace Manganese {
+namespace io {
+
+/**
+ * @brief A non-owning reader over a contiguous, null-terminated buffer, using a raw pointer as its cursor
+ * The class is final and defined entirely in this header, so calls made through a BufferReader are resolved statically
+ * and inlined rather than dispatched virtually.
+ * Only the byte offset is tracked while reading; lines and columns are meant to be resolved from offsets through
+ * io::SourceMap, and are only worked out here (by rescanning the buffer) for occasional use.
+ * @note `source.data()[source.size()]` must be readable and equal to '\0'. This holds for std::string, string literals
+ * and MappedFileReader::view(), and is what lets done() be a single sentinel compare in the common case.
+ */
+class BufferReader final : public Reader {
+   private:
+    const char* _begin;
+    const char* _current;
+    const char* _end;
+
+   public:
+    BufferReader() noexcept : BufferReader(std::string_view("")) {}
+    explicit BufferReader(std::string_view source) noexcept :
+        _begin(source.data()), _current(source.data()), _end(source.data() + source.size()) {}
+    ~BufferReader() noexcept override = default;
+
+    /**
+     * @brief Point the reader at a new buffer and rewind to the start of it
+     */
+    void reset(std::string_view source) noexcept {
+        _begin = _current = source.data();
+        _end = source.data() + source.size();
+    }
+
+    char peekChar(size_t offset = 0) noexcept override {
+        // The terminator makes peeking at offset 0 always safe
+        return (offset == 0 || offset < static_cast<size_t>(_end - _current)) ? _current[offset] : '\0';
+    }
+
+    [[nodiscard]] char consumeChar() noexcept override {
+        const char c = *_current;
+        _current += (_current != _end) ? 1 : 0;
+        return c;
+    }
+
+    void setPosition(size_t newPosition) noexcept override {
+        const size_t position = getPosition();
+        if (newPosition > position) { advance(newPosition - position); }
+    }
+
+    /**
+     * @brief Skip `n` characters (or up to the end of the buffer) in one step
+     */
+    void advance(size_t n = 1) noexcept { _current += std::min(n, static_cast<size_t>(_end - _current)); }
+
+    /**
+     * @brief A view of `length` characters of the underlying buffer, starting at `start`
+     * @note The view is only valid for as long as the buffer the reader was given
+     */
+    constexpr std::string_view slice(size_t start, size_t length) const noexcept {
+        return std::string_view(_begin + start, length);
+    }
+
+    constexpr const char* cursor() const noexcept { return _current; }
+    constexpr const char* end() const noexcept { return _end; }
+
+    constexpr size_t getPosition() const noexcept override { return static_cast<size_t>(_current - _begin); }
+    size_t getLine() const noexcept override { return 1 + static_cast<size_t>(std::count(_begin, _current, '\n')); }
+    size_t getColumn() const noexcept override {
+        const char* lineStart = _current;
+        while (lineStart != _begin && lineStart[-1] != '\n') { --lineStart; }
+        return static_cast<size_t>(_current - lineStart) + 1;
+    }
+
+    constexpr bool done() const noexcept override { return *_current == '\0' && _current == _end; }
+};
+
+}  // namespace io
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_IO_BUFFERREADER_HPP
@@ -0,0 +1,113 @@
+#ifndef MANGANESE_INCLUDE_IO_DIAGNOSTICS_HPP
+#define MANGANESE_INCLUDE_IO_DIAGNOSTICS_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <io/source_map.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace logging {
+
+enum class LogLevel : uint8_t {
+    Info,
+    Warning,
+    Error,
+    Critical
+};
+
+/**
+ * @brief How diagnostics are written out: as text for people to read, or as JSON for tools
+ */
+enum class DiagnosticFormat : uint8_t {
+    Text,
+    Json,
+};
+
+// The line and column of a diagnostic about no place in particular (e.g. that a file couldn't be opened)
+constexpr inline uint32_t NO_POSITION = UINT32_MAX;
+
+/**
+ * @brief Something reported to the user, kept as its parts until it is written out
+ * @details Where it is stays a source location (an offset), which is only resolved to a line and column when it is
+ * written out, or by resolve() if it has to outlive its source. The message is formatted when it is reported, since
+ * what goes into it (names in an arena, types) doesn't last as long as the diagnostic can.
+ */
+struct Diagnostic {
+    LogLevel level = LogLevel::Error;
+    io::SourceLocation location;  // Invalid once resolved, or if it is about no place in particular
+    uint32_t line = NO_POSITION;  // Set (with column) by resolve()
+    uint32_t column = NO_POSITION;
+    std::string message;
+
+    /**
+     * @brief Replace the location with its line and column, while its source is still in io::sourceMap()
+     */
+    void resolve();
+
+    bool operator==(const Diagnostic&) const = default;
+};
+
+/**
+ * @brief Diagnostics collected (e.g. by one thread, for one file) to be written out later in one go
+ */
+class DiagnosticList {
+   private:
+    std::vector<Diagnostic> diagnostics;
+
+   public:
+    void add(Diagnostic diagnostic) { diagnostics.push_back(std::move(diagnostic)); }
+    void append(const DiagnosticList& other) {
+        diagnostics.insert(diagnostics.end(), other.diagnostics.begin(), other.diagnostics.end());
+    }
+    void clear() noexcept { diagnostics.clear(); }
+
+    /**
+     * @brief Resolve every diagnostic's location (see Diagnostic::resolve())
+     */
+    void resolve();
+    /**
+     * @brief Move the diagnostics that are still locations by `offset` bytes, after the text before them changed
+     */
+    void shift(ptrdiff_t offset) noexcept;
+
+    /**
+     * @brief Order the diagnostics by where they are (those about no place in particular last), keeping the order
+     * they were reported in otherwise, and drop any that were reported more than once
+     * What is written out then doesn't depend on which phase (or thread) found what first. The diagnostics are
+     * resolved first, so their sources must still be in io::sourceMap().
+     */
+    void sort();
+
+    bool empty() const noexcept { return diagnostics.empty(); }
+    size_t size() const noexcept { return diagnostics.size(); }
+    auto begin() const noexcept { return diagnostics.begin(); }
+    auto end() const noexcept { return diagnostics.end(); }
+
+    bool operator==(const DiagnosticList&) const = default;
+
+    /**
+     * @brief Append the diagnostics to `output`, as a line of text each or as a JSON array of objects
+     */
+    void render(std::string& output, DiagnosticFormat format = DiagnosticFormat::Text) const;
+    std::string render(DiagnosticFormat format = DiagnosticFormat::Text) const;
+};
+
+/**
+ * @brief Append a diagnostic to `output` as the line of text it is written out as
+ */
+void renderDiagnostic(std::string& output, const Diagnostic& diagnostic);
+
+/**
+ * @brief Append `text` to `output` as a JSON string (quoted, with anything JSON can't hold as is escaped)
+ */
+void appendJsonString(std::string& output, std::string_view text);
+
+}  // namespace logging
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_IO_DIAGNOSTICS_HPP
@@ -1,9 +1,16 @@
 #ifndef MANGANESE_INCLUDE_IO_LOGGING_HPP
 #define MANGANESE_INCLUDE_IO_LOGGING_HPP
 
+#include <atomic>
 #include <core.hpp>
+#include <cstdint>
 #include <format>  // Include format here so any files that use logging have it included
+#include <io/diagnostics.hpp>
+#include <io/source_map.hpp>
 #include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 // ANSI color codes for terminal output
@@ -19,64 +26,153 @@ constexpr inline const char* RESET = "\033[0m";
 namespace Manganese {
 namespace logging {
 
-enum class LogLevel : uint8_t {
-    Info,
-    Warning,
-    Error,
-    Critical
+/**
+ * @brief Where user-facing diagnostics logged on the calling thread are written (std::cerr unless captured), when they
+ * aren't being collected into a list
+ */
+inline std::ostream*& diagnosticStream() noexcept {
+    thread_local std::ostream* stream = &std::cerr;
+    return stream;
+}
+
+/**
+ * @brief The list the calling thread's diagnostics are being collected into, if any (rather than written out)
+ */
+inline DiagnosticList*& diagnosticList() noexcept {
+    thread_local DiagnosticList* list = nullptr;
+    return list;
+}
+
+/**
+ * @brief Diverts the calling thread's diagnostics into `buffer` (as text) or `list` for as long as it is alive
+ * Lets work done in parallel replay its diagnostics in a deterministic order once it is finished.
+ */
+class DiagnosticCapture {
+   private:
+    std::ostream* previousStream;
+    DiagnosticList* previousList;
+
+   public:
+    explicit DiagnosticCapture(std::ostream& buffer) noexcept :
+        previousStream(std::exchange(diagnosticStream(), &buffer)),
+        previousList(std::exchange(diagnosticList(), nullptr)) {}
+    explicit DiagnosticCapture(DiagnosticList& list) noexcept :
+        previousStream(diagnosticStream()), previousList(std::exchange(diagnosticList(), &list)) {}
+    ~DiagnosticCapture() noexcept {
+        diagnosticStream() = previousStream;
+        diagnosticList() = previousList;
+    }
+
+    DiagnosticCapture(const DiagnosticCapture&) = delete;
+    DiagnosticCapture& operator=(const DiagnosticCapture&) = delete;
 };
 
-template <class... Args>
-void logInternal(LogLevel level, std::format_string<Args...> fmt, Args&&... args) NOEXCEPT_IF_RELEASE {
+// The least severe internal log level compiled in, as a LogLevel's value (4 compiles internal logging out). Unless the
+// build gives one (see INTERNAL_LOG_LEVEL in CMakeLists.txt), debug builds log everything and release builds nothing
+#ifndef MN_INTERNAL_LOG_LEVEL
 #if MN_DEBUG
-    std::string message = std::format(fmt, std::forward<Args>(args)...);
-    switch (level) {
-        case LogLevel::Info: std::cerr << BLUE << "[Internal Info] " << message << RESET << "\n"; break;
-        case LogLevel::Warning: std::cerr << YELLOW << "[Internal Warning] " << message << RESET << "\n"; break;
-        case LogLevel::Error: std::cerr << RED << "[Internal Error] " << message << RESET << "\n"; break;
-        case LogLevel::Critical:
-            std::cerr << RED << "[Internal Critical Error] " << message << RESET << "\n";
-            std::cerr << "Critical error encountered";
-            throw std::runtime_error("Critical error");
-    }
+#define MN_INTERNAL_LOG_LEVEL 0
 #else  // ^^ MN_DEBUG vv !MN_DEBUG
-    DISCARD(level);
-    DISCARD(fmt);
-    (void)((void)args, ...);
-    return;  // No internal logging in non-debug builds
+#define MN_INTERNAL_LOG_LEVEL 4
 #endif  // MN_DEBUG
+#endif  // MN_INTERNAL_LOG_LEVEL
+
+namespace detail {
+// Internal messages less severe than this are skipped (if compiled in at all)
+inline std::atomic<LogLevel> internalLogLevel = LogLevel::Info;
+}  // namespace detail
+
+constexpr inline int INTERNAL_LOG_LEVEL = MN_INTERNAL_LOG_LEVEL;
+constexpr bool isInternalLogCompiled(LogLevel level) noexcept { return static_cast<int>(level) >= INTERNAL_LOG_LEVEL; }
+inline bool isInternalLogEnabled(LogLevel level) noexcept {
+    return level >= detail::internalLogLevel.load(std::memory_order_relaxed);
+}
+/**
+ * @brief Skip internal messages less severe than `level` from now on (those compiled out stay out whatever it is)
+ */
+inline void setInternalLogLevel(LogLevel level) noexcept {
+    detail::internalLogLevel.store(level, std::memory_order_relaxed);
 }
 
+/**
+ * @brief Write an internal message (one about the compiler itself, for its developers) to std::cerr
+ * @note Call this through LOG_INTERNAL(), which doesn't evaluate the arguments unless the message is logged
+ */
 template <class... Args>
-void log(LogLevel level, size_t line, size_t col, std::format_string<Args...> fmt, Args&&... args) noexcept {
-    std::string message = std::format(fmt, std::forward<Args>(args)...);
+void logInternal(LogLevel level, std::format_string<Args...> fmt, Args&&... args) NOEXCEPT_IF_RELEASE {
+    const std::string message = std::format(fmt, std::forward<Args>(args)...);
     switch (level) {
-        case LogLevel::Info: return;  // No user info
-        case LogLevel::Warning: std::cerr << YELLOW << "Warning: " << message << RESET; break;
-        case LogLevel::Error: std::cerr << RED << "Error: " << message << RESET; break;
-        case LogLevel::Critical:
-            std::cerr << CRITICAL << "Critical error: " << message << " Compilation aborted." << RESET;
+        case LogLevel::Info: std::cerr << std::format("{}[Internal Info] {}{}\n", BLUE, message, RESET); break;
+        case LogLevel::Warning:
+            std::cerr << std::format("{}[Internal Warning] {}{}\n", YELLOW, message, RESET);
             break;
+        case LogLevel::Error: std::cerr << std::format("{}[Internal Error] {}{}\n", RED, message, RESET); break;
+        case LogLevel::Critical:
+            std::cerr << std::format("{}[Internal Critical Error] {}{}\nCritical error encountered", RED, message,
+                                     RESET);
+            throw std::runtime_error("Critical error");
     }
-    std::cerr << " (line " << line << ", column " << col << ")\n";
+}
+
+/**
+ * @brief Add `diagnostic` to the list being captured into, or else write it out (in a single write)
+ */
+void report(Diagnostic&& diagnostic) noexcept;
+/**
+ * @brief Report each of `diagnostics` in order, e.g. to replay what a worker thread collected
+ */
+void report(const DiagnosticList& diagnostics) noexcept;
+
+// Report an error about no place in particular (e.g. a malformed argument)
+FORCE_INLINE void reportError(std::string message) noexcept {
+    report(Diagnostic{.level = LogLevel::Error,
+                      .location = {},
+                      .line = NO_POSITION,
+                      .column = NO_POSITION,
+                      .message = std::move(message)});
+}
+
+template <class... Args>
+void log(LogLevel level, io::SourceLocation location, std::format_string<Args...> fmt, Args&&... args) noexcept {
+    if (level == LogLevel::Info) { return; }  // No user info
+    report(Diagnostic{.level = level,
+                      .location = location,
+                      .line = NO_POSITION,
+                      .column = NO_POSITION,
+                      .message = std::format(fmt, std::forward<Args>(args)...)});
 }
 
 template <class... Args>
-FORCE_INLINE void logWarning(size_t line, size_t col, std::format_string<Args...> fmt, Args&&... args) noexcept {
-    log(LogLevel::Warning, line, col, fmt, std::forward<Args>(args)...);
+FORCE_INLINE void logWarning(io::SourceLocation location, std::format_string<Args...> fmt, Args&&... args) noexcept {
+    log(LogLevel::Warning, location, fmt, std::forward<Args>(args)...);
 }
 
 template <class... Args>
-FORCE_INLINE void logError(size_t line, size_t col, std::format_string<Args...> fmt, Args&&... args) noexcept {
-    log(LogLevel::Error, line, col, fmt, std::forward<Args>(args)...);
+FORCE_INLINE void logError(io::SourceLocation location, std::format_string<Args...> fmt, Args&&... args) noexcept {
+    log(LogLevel::Error, location, fmt, std::forward<Args>(args)...);
 }
 
 template <class... Args>
-FORCE_INLINE void logCritical(size_t line, size_t col, std::format_string<Args...> fmt, Args&&... args) noexcept {
-    log(LogLevel::Critical, line, col, fmt, std::forward<Args>(args)...);
+FORCE_INLINE void logCritical(io::SourceLocation location, std::format_string<Args...> fmt, Args&&... args) noexcept {
+    log(LogLevel::Critical, location, fmt, std::forward<Args>(args)...);
 }
 
 }  // namespace logging
 }  // namespace Manganese
 
+/**
+ * @brief Log an internal message at `level` (a LogLevel's name), e.g. LOG_INTERNAL(Warning, "{} is odd", describe(x))
+ * The format arguments are only evaluated if the message is logged: never if `level` is compiled out (see
+ * MN_INTERNAL_LOG_LEVEL), and otherwise only after a single branch on the level set at runtime
+ */
+#define LOG_INTERNAL(level, ...)                                                                         \
+    do {                                                                                                 \
+        constexpr ::Manganese::logging::LogLevel internalLevel_ = ::Manganese::logging::LogLevel::level; \
+        if constexpr (::Manganese::logging::isInternalLogCompiled(internalLevel_)) {                     \
+            if (::Manganese::logging::isInternalLogEnabled(internalLevel_)) [[unlikely]] {               \
+                ::Manganese::logging::logInternal(internalLevel_, __VA_ARGS__);                          \
+            }                                                                                            \
+        }                                                                                                \
+    } while (false)
+
 #endif  // MANGANESE_INCLUDE_IO_LOGGING_HPP
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef MANGANESE_INCLUDE_IO_MAPPEDFILEREADER_HPP
+#define MANGANESE_INCLUDE_IO_MAPPEDFILEREADER_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <io/reader.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Manganese {
+namespace io {
+
+/**
+ * @brief A reader that maps an entire file into memory (mmap on POSIX, MapViewOfFile on Windows)
+ * The file is exposed as one contiguous, read-only view, so reading never copies or refills a buffer.
+ * The byte just past the end of the view is always '\0', which allows sentinel-based end-of-input checks.
+ * @note Only regular, non-empty files can be mapped (see isMappable); use FileReader for pipes and stdin.
+ */
+class MappedFileReader : public Reader {
+   private:
+    size_t _position, _line, _column;
+    std::string_view _source;
+    void* _mapping = nullptr;  // Base address of the mapped view (nullptr if the file was copied instead)
+    size_t _mappingSize = 0;
+    std::unique_ptr<char[]> _ownedBuffer;  // Used when the mapping would not leave room for a null terminator
+
+    void unmap() noexcept;
+
+   public:
+    explicit MappedFileReader(const std::string& filename);
+    ~MappedFileReader() noexcept override { unmap(); }
+
+    /**
+     * @brief Whether `filename` refers to a regular, non-empty file that can be memory-mapped
+     */
+    static bool isMappable(const std::string& filename) noexcept;
+
+    constexpr std::string_view view() const noexcept { return _source; }
+    constexpr const char* data() const noexcept { return _source.data(); }
+    constexpr size_t size() const noexcept { return _source.size(); }
+
+    char peekChar(size_t offset = 0) noexcept override {
+        return (_position + offset >= _source.length()) ? '\0' : _source[_position + offset];
+    }
+    [[nodiscard]] char consumeChar() noexcept override {
+        if (_position >= _source.length()) { return '\0'; }
+        const char c = _source[_position++];
+        _line += (c == '\n') ? 1 : 0;
+        _column = (c == '\n') ? 1 : _column + 1;
+        return c;
+    }
+
+    void setPosition(size_t newPosition) noexcept override;
+    constexpr size_t getPosition() const noexcept override { return _position; }
+    constexpr size_t getLine() const noexcept override { return _line; }
+    constexpr size_t getColumn() const noexcept override { return _column; }
+
+    constexpr bool done() const noexcept override { return _position >= _source.length(); }
+};
+}  // namespace io
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_IO_MAPPEDFILEREADER_HPP
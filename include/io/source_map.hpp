@@ -0,0 +1,149 @@
+#ifndef MANGANESE_INCLUDE_IO_SOURCE_MAP_HPP
+#define MANGANESE_INCLUDE_IO_SOURCE_MAP_HPP
+
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace io {
+
+/**
+ * @brief A position in a source buffer registered with the SourceMap, stored as a byte offset
+ * Line and column numbers are only needed for diagnostics, so they are worked out on demand rather than tracked while
+ * reading.
+ */
+struct SourceLocation {
+    constexpr static inline uint32_t INVALID_SOURCE = std::numeric_limits<uint32_t>::max();
+
+    uint32_t source = INVALID_SOURCE;
+    uint32_t offset = 0;
+
+    constexpr bool isValid() const noexcept { return source != INVALID_SOURCE; }
+
+    constexpr bool operator==(const SourceLocation&) const noexcept = default;
+};
+
+struct LineColumn {
+    size_t line = 0, column = 0;  // 1-based (0 for an invalid location)
+};
+
+/**
+ * @brief The offsets at which each line of a source buffer starts, built the first time they are needed
+ */
+class LineTable {
+   private:
+    std::string_view _source;  // Cleared once the table is built
+    std::once_flag _built;
+    bool _isBuilt = false;
+    std::vector<uint32_t> _lineStarts;
+
+    void build();
+
+   public:
+    explicit LineTable(std::string_view source) noexcept : _source(source) {}
+
+    LineColumn resolve(uint32_t offset);
+
+    /**
+     * @brief Follow an edit to the source, which is now `source`: `removedLength` bytes at `offset` were replaced with
+     * `inserted`
+     * @details A built table shifts the lines after the edit rather than scanning the source again
+     */
+    void edit(std::string_view source, size_t offset, size_t removedLength, std::string_view inserted);
+
+    /**
+     * @brief Build the table now, so that it no longer needs the source buffer
+     * @param usedLength Only the source's first `usedLength` bytes are scanned (e.g. all a header-only lexer read)
+     */
+    void detach(size_t usedLength = std::string_view::npos) {
+        std::call_once(_built, [this, usedLength]() {
+            _source = _source.substr(0, usedLength);
+            build();
+        });
+    }
+};
+
+/**
+ * @brief Every source buffer the compiler has loaded, so that a SourceLocation can be resolved from anywhere
+ * @note Thread-safe
+ */
+class SourceMap {
+   private:
+    mutable std::mutex _mutex;
+    // Indexed by source id. Ids are never reused: a removed source's slot is left empty, so a location that outlives
+    // its source resolves to nothing rather than to another file's lines
+    std::vector<std::shared_ptr<LineTable>> _tables;
+    size_t _removedCount = 0;
+
+    // Shared, so that a table removed while another thread is using it lives until that thread is done
+    std::shared_ptr<LineTable> table(uint32_t source) const noexcept;
+
+   public:
+    SourceMap() = default;
+    SourceMap(const SourceMap&) = delete;
+    SourceMap& operator=(const SourceMap&) = delete;
+
+    /**
+     * @brief Register a source buffer, returning the id locations in it should use
+     * @note The buffer must stay alive until release() is called with the returned id
+     */
+    uint32_t addSource(std::string_view source);
+
+    /**
+     * @brief Stop referring to a source buffer (e.g. because it is about to be freed)
+     * Locations in it can still be resolved afterwards, as long as they are within its first `usedLength` bytes.
+     */
+    void release(uint32_t source, size_t usedLength = std::string_view::npos);
+
+    /**
+     * @brief Follow an edit to a source buffer that is still registered (see LineTable::edit())
+     * @note Locations in the source mustn't be resolved on another thread meanwhile
+     */
+    void edit(uint32_t source, std::string_view text, size_t offset, size_t removedLength, std::string_view inserted);
+
+    /**
+     * @brief Forget a source buffer, freeing its line table, so sources that come and go (e.g. a server's) don't add
+     * up. Locations in it resolve to an invalid LineColumn afterwards
+     */
+    void remove(uint32_t source);
+
+    // How many sources are registered, not counting removed ones
+    size_t sourceCount() const;
+
+    LineColumn resolve(SourceLocation location);
+};
+
+SourceMap& sourceMap() noexcept;
+
+/**
+ * @brief Removes every source this thread adds to sourceMap() while the scope is alive once it ends
+ * @details For work that has resolved every location it reports by the time it ends (e.g. compiling one file), so that
+ * a long-lived process doesn't keep the line tables of everything it has ever compiled. Scopes nest: an inner one
+ * removes its own sources, which the outer one then never sees
+ * @note The lexers of those sources must be gone before the scope is
+ */
+class SourceScope {
+   private:
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t>* outer;
+
+   public:
+    SourceScope() noexcept;
+    ~SourceScope() noexcept;
+
+    SourceScope(const SourceScope&) = delete;
+    SourceScope& operator=(const SourceScope&) = delete;
+
+    size_t size() const noexcept { return sources.size(); }  // How many sources it will remove
+};
+
+}  // namespace io
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_IO_SOURCE_MAP_HPP
@@ -1,39 +1,337 @@
 #ifndef MNSTL_CHUNK_ALLOCATOR
 #define MNSTL_CHUNK_ALLOCATOR 1
 
+#include <array>
 #include <core.hpp>
 #include <cstddef>
+#include <cstring>
+#include <format>
 #include <memory>
+#include <memory_resource>
+#include <mnstl/chunk_pool.hxx>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace mnstl {
 
+class chunk_allocator;
+
+/**
+ * @brief A std::pmr::memory_resource that allocates from a chunk_allocator, so that standard containers can keep their
+ * elements in the arena
+ * @details Deallocation does nothing; the memory is reclaimed along with the rest of the arena.
+ */
+class arena_resource final : public std::pmr::memory_resource {
+   private:
+    chunk_allocator* _arena;
+    friend class chunk_allocator;  // Re-points the resource when the allocator is moved
+
+   public:
+    explicit arena_resource(chunk_allocator* arena) noexcept : _arena(arena) {}
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) noexcept override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/**
+ * @brief What an arena allocation is for, so that usage can be broken down by category
+ */
+enum class alloc_tag : uint8_t {
+    general,
+    ast,
+    scopes,
+    types,
+};
+constexpr inline size_t alloc_tag_count = 4;
+constexpr inline std::array<const char*, alloc_tag_count> alloc_tag_names = {"general", "ast", "scopes", "types"};
+
+/**
+ * @brief Usage counters for a chunk_allocator
+ * Padding, waste and the per-tag totals count everything allocated since the last reset() or release() (including
+ * anything since rewound), while the high-water mark covers the allocator's whole life.
+ */
+struct chunk_allocator_stats {
+    size_t chunks = 0;
+    size_t bytes_reserved = 0;  // Total capacity of the chunks
+    size_t bytes_in_use = 0;  // Handed out (including padding) and not yet reset or rewound
+    size_t high_water_mark = 0;  // The most bytes ever in use at once
+    size_t alignment_padding = 0;  // Skipped to align allocations
+    size_t tail_waste = 0;  // Left unused at the end of chunks that were too full for the next allocation
+    std::array<size_t, alloc_tag_count> bytes_by_tag{};
+
+    std::string to_string() const {
+        std::string result = std::format(
+            "{} chunks, {} bytes reserved, {} in use (peak {}), {} bytes of alignment padding, {} bytes of tail waste",
+            chunks, bytes_reserved, bytes_in_use, high_water_mark, alignment_padding, tail_waste);
+        for (size_t i = 0; i < alloc_tag_count; ++i) {
+            result += std::format("{} {}: {}", i == 0 ? ";" : ",", alloc_tag_names[i], bytes_by_tag[i]);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief How a chunk_allocator sizes the chunks it adds
+ * Each new chunk is `growth_factor` times bigger than the last (up to `max_size`), so a large input needs a handful
+ * of allocations rather than one per `initial_size` bytes.
+ */
+struct chunk_growth_policy {
+    size_t initial_size = 4096;
+    size_t growth_factor = 2;
+    size_t max_size = size_t{1} << 20;
+};
+
+/**
+ * @brief A bump allocator that hands out storage from a list of chunks
+ * @details Objects that aren't trivially destructible are registered when they are emplaced, and destroyed (newest
+ * first) by reset(), release(), rewind() or the allocator's destructor. Nothing is freed individually.
+ * An allocator can draw its chunks from a chunk_pool shared with other threads' allocators, in which case the chunks
+ * go back to the pool (rather than the system) when it is released or destroyed. Allocators are single-threaded, but
+ * can be moved to hand everything in them over to another thread.
+ */
 class chunk_allocator {
    private:
-    constexpr static inline size_t _default_chunksize = 4096;
+    // Frees a chunk's memory, or gives it back to the pool it came from
+    struct chunk_deleter {
+        chunk_pool* pool = nullptr;
+        uint32_t slot = chunk_pool::no_slot;
+        void operator()(std::byte* data) const noexcept {
+            if (pool) {
+                pool->release(slot);
+            } else {
+                delete[] data;
+            }
+        }
+    };
     struct chunk {
-        std::unique_ptr<std::byte[]> data;
+        std::unique_ptr<std::byte[], chunk_deleter> data;
         size_t used, capacity;
     };
+    // Stored in the arena just before the object it destroys, and linked from newest to oldest
+    struct destructor_record {
+        void (*destroy)(void*) noexcept;
+        void* object;
+        destructor_record* previous;
+    };
     constexpr static inline size_t _max(size_t a, size_t b) noexcept { return a > b ? a : b; }
 
+    chunk_growth_policy _policy;
+    chunk_pool* _pool;  // Where chunks of the pool's block size (or smaller) come from, if any
+    size_t _next_chunk_size;  // Capacity of the next chunk to be added
     std::vector<chunk> _chunks;
+    size_t _current = 0;  // The chunk being allocated from; any after it are empty and waiting to be reused
+    destructor_record* _destructors = nullptr;
+    // Updated on every allocation, so only the counters that are cheap to maintain are kept (the rest are computed
+    // by stats())
+    chunk_allocator_stats _stats;
+    size_t _used_before_current = 0;  // Bytes used in the chunks before _current
+    alloc_tag _tag = alloc_tag::general;
+    // Kept on the heap so that containers using it stay valid when the allocator is moved
+    std::unique_ptr<arena_resource> _resource;
     constexpr static uintptr_t align_up(uintptr_t ptr, uintptr_t alignment) noexcept {
         uintptr_t mask = alignment - 1;
         return (ptr + mask) & ~mask;
     }
 
-    void add_chunk(size_t size = _default_chunksize) {
-        _chunks.push_back(
-            chunk{.data = std::make_unique_for_overwrite<std::byte[]>(size),  // avoids initialization of values
-                  .used = 0,
-                  .capacity = size});
+    // The size of the chunk after one of `size` bytes (never smaller, and capped at the policy's maximum)
+    constexpr size_t grown(size_t size) const noexcept {
+        const size_t next = size * _policy.growth_factor;
+        return _max(size, next < _policy.max_size ? next : _policy.max_size);
+    }
+
+    chunk make_chunk(size_t size) {
+        if (_pool && size <= _pool->block_size()) {
+            const chunk_pool::block b = _pool->acquire();
+            return chunk{.data = std::unique_ptr<std::byte[], chunk_deleter>(b.data, chunk_deleter{_pool, b.slot}),
+                         .used = 0,
+                         .capacity = _pool->block_size()};
+        }
+        // `new std::byte[size]` rather than `new std::byte[size]()` avoids initializing the memory
+        return chunk{.data = std::unique_ptr<std::byte[], chunk_deleter>(new std::byte[size], chunk_deleter{}),
+                     .used = 0,
+                     .capacity = size};
+    }
+
+    /**
+     * @brief Move on to a chunk with room for at least `size` bytes, reusing the next one if it is big enough
+     */
+    void next_chunk(size_t size) {
+        _stats.tail_waste += _chunks[_current].capacity - _chunks[_current].used;
+        _used_before_current += _chunks[_current].used;
+        if (_current + 1 < _chunks.size() && _chunks[_current + 1].capacity >= size) {
+            ++_current;
+            return;
+        }
+        // Put the new chunk next, so that smaller spare chunks are kept for later
+        _chunks.insert(_chunks.begin() + static_cast<std::ptrdiff_t>(_current + 1),
+                       make_chunk(_max(_next_chunk_size, size)));
+        ++_current;
+        _next_chunk_size = grown(_next_chunk_size);
+    }
+
+    template <class T>
+    static void destroy(void* object) noexcept {
+        static_cast<T*>(object)->~T();
+    }
+
+    // Destroy objects, newest first, until `until` is the newest one left
+    void clear_stats() noexcept {
+        _stats = chunk_allocator_stats{.high_water_mark = _stats.high_water_mark};
+        _used_before_current = 0;
+    }
+
+    void run_destructors(destructor_record* until = nullptr) noexcept {
+        while (_destructors != until) {
+            destructor_record* record = _destructors;
+            _destructors = record->previous;
+            record->destroy(record->object);
+        }
+    }
+
+   public:
+    explicit chunk_allocator(chunk_growth_policy policy = {}, chunk_pool* pool = nullptr) :
+        _policy(policy),
+        _pool(pool),
+        _next_chunk_size(grown(policy.initial_size)),
+        _resource(std::make_unique<arena_resource>(this)) {
+        _chunks.push_back(make_chunk(_policy.initial_size));
+    }
+    /**
+     * @brief An allocator whose chunks come from (and go back to) `pool`
+     */
+    explicit chunk_allocator(chunk_pool& pool) :
+        chunk_allocator(chunk_growth_policy{.initial_size = pool.block_size(), .growth_factor = 1,
+                                            .max_size = pool.block_size()},
+                        &pool) {}
+    ~chunk_allocator() noexcept { run_destructors(); }
+
+    chunk_allocator(const chunk_allocator&) = delete;
+    chunk_allocator& operator=(const chunk_allocator&) = delete;
+    chunk_allocator(chunk_allocator&& other) noexcept :
+        _policy(other._policy),
+        _pool(other._pool),
+        _next_chunk_size(other._next_chunk_size),
+        _chunks(std::move(other._chunks)),
+        _current(std::exchange(other._current, 0)),
+        _destructors(std::exchange(other._destructors, nullptr)),
+        _stats(other._stats),
+        _used_before_current(other._used_before_current),
+        _tag(other._tag),
+        _resource(std::move(other._resource)) {
+        _resource->_arena = this;
+    }
+    chunk_allocator& operator=(chunk_allocator&& other) noexcept {
+        if (this != &other) {
+            run_destructors();
+            _policy = other._policy;
+            _pool = other._pool;
+            _next_chunk_size = other._next_chunk_size;
+            _chunks = std::move(other._chunks);
+            _current = std::exchange(other._current, 0);
+            _destructors = std::exchange(other._destructors, nullptr);
+            _stats = other._stats;
+            _used_before_current = other._used_before_current;
+            _tag = other._tag;
+            _resource = std::move(other._resource);
+            _resource->_arena = this;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief A memory resource for standard (std::pmr) containers that should allocate from this arena
+     */
+    std::pmr::memory_resource* resource() const noexcept { return _resource.get(); }
+
+    /**
+     * @brief Destroy everything in the arena, keeping its chunks to reuse for later allocations
+     * @note Invalidates every pointer the allocator has handed out
+     */
+    void reset() noexcept {
+        run_destructors();
+        for (chunk& c : _chunks) { c.used = 0; }
+        _current = 0;
+        clear_stats();
+    }
+
+    /**
+     * @brief Destroy everything in the arena and give its memory back (to the system or its pool), leaving a single
+     * fresh chunk
+     * @note Invalidates every pointer the allocator has handed out
+     */
+    void release() {
+        run_destructors();
+        _chunks.clear();
+        _current = 0;
+        _chunks.push_back(make_chunk(_policy.initial_size));
+        _next_chunk_size = grown(_policy.initial_size);
+        clear_stats();
+    }
+
+    /**
+     * @brief A point in the arena's history that it can later be rewound to
+     */
+    struct marker {
+        size_t chunk, used;
+        destructor_record* destructors;
+    };
+
+    constexpr marker mark() const noexcept {
+        return marker{.chunk = _current, .used = _chunks[_current].used, .destructors = _destructors};
+    }
+
+    /**
+     * @brief Destroy and give back (for reuse) everything allocated since `point` was marked
+     * @details Costs one step per chunk used and per object with a destructor since then, so dropping a phase's
+     * worth of trivially destructible allocations is effectively O(1)
+     * @note `point` must have come from this allocator, and nothing earlier can have been rewound or reset since
+     */
+    void rewind(marker point) noexcept {
+        run_destructors(point.destructors);
+        for (size_t i = point.chunk + 1; i <= _current; ++i) { _chunks[i].used = 0; }
+        _chunks[point.chunk].used = point.used;
+        _current = point.chunk;
+        _used_before_current = 0;
+        for (size_t i = 0; i < _current; ++i) { _used_before_current += _chunks[i].used; }
     }
 
+    chunk_allocator_stats stats() const noexcept {
+        chunk_allocator_stats result = _stats;
+        result.chunks = _chunks.size();
+        for (const chunk& c : _chunks) { result.bytes_reserved += c.capacity; }
+        result.bytes_in_use = _used_before_current + _chunks[_current].used;
+        return result;
+    }
+
+    /**
+     * @brief Attributes everything allocated from an arena to `tag` while alive
+     */
+    class tag_scope {
+       private:
+        chunk_allocator& _arena;
+        alloc_tag _previous;
+
+       public:
+        tag_scope(chunk_allocator& arena, alloc_tag tag) noexcept : _arena(arena), _previous(arena._tag) {
+            arena._tag = tag;
+        }
+        ~tag_scope() noexcept { _arena._tag = _previous; }
+
+        tag_scope(const tag_scope&) = delete;
+        tag_scope& operator=(const tag_scope&) = delete;
+    };
+
+    /**
+     * @brief Get `size` bytes of uninitialized storage aligned to `alignment`
+     */
     FORCE_INLINE void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
     _do_allocation:
-        chunk& c = _chunks[_chunks.size() - 1];
+        chunk& c = _chunks[_current];
         uintptr_t current_position = reinterpret_cast<uintptr_t>(c.data.get() + c.used);
         // the next place we can safely construct a type, taking padding into account
         uintptr_t aligned_position = align_up(current_position, alignment);
@@ -42,28 +340,75 @@ class chunk_allocator {
 
         if (c.used + adjustment + size > c.capacity) {
             // can't fit data here anymore
-            add_chunk(_max(_default_chunksize, size + alignment));
+            next_chunk(size + alignment);
             goto _do_allocation;  // avoids recursion
         }
         c.used += adjustment;
         void* ptr = c.data.get() + c.used;
         c.used += size;
 
+        _stats.alignment_padding += adjustment;
+        _stats.bytes_by_tag[static_cast<size_t>(_tag)] += size;
+        _stats.high_water_mark = _max(_stats.high_water_mark, _used_before_current + c.used);
         return ptr;
     }
 
-   public:
-    chunk_allocator() { add_chunk(); }
-    ~chunk_allocator() noexcept = default;
+    /**
+     * @brief Make sure the next `size` bytes of allocations fit in the current chunk, adding (at most) one chunk for
+     * them now rather than one at a time as they run out of room
+     */
+    void reserve(size_t size) {
+        if (_chunks[_current].used + size > _chunks[_current].capacity) { next_chunk(size); }
+    }
+
+    /**
+     * @brief The most arena storage an emplace<T>() can take, alignment padding (and the record that destroys the
+     * object) included, e.g. to reserve() room for many objects at once
+     */
+    template <class T>
+    constexpr static size_t emplace_size() noexcept {
+        const size_t object = sizeof(T) + alignof(T) - 1;
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            return object;
+        } else {
+            return object + sizeof(destructor_record) + alignof(destructor_record) - 1;
+        }
+    }
 
     template <class T, class... Args>
         requires(std::is_constructible_v<T, Args...>)
     T* emplace(Args&&... args) {
-        void* mem = allocate(sizeof(T), alignof(T));
-        return new (mem) T(std::forward<Args>(args)...);
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            void* mem = allocate(sizeof(T), alignof(T));
+            return new (mem) T(std::forward<Args>(args)...);
+        } else {
+            void* record = allocate(sizeof(destructor_record), alignof(destructor_record));
+            T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            // Only registered once construction has succeeded
+            _destructors = new (record)
+                destructor_record{.destroy = &destroy<T>, .object = object, .previous = _destructors};
+            return object;
+        }
+    }
+
+    /**
+     * @brief Copy a string into the arena (followed by a null terminator), returning a view of the copy
+     */
+    std::string_view copy_string(std::string_view str) {
+        char* mem = static_cast<char*>(allocate(str.size() + 1, alignof(char)));
+        if (!str.empty()) { std::memcpy(mem, str.data(), str.size()); }
+        mem[str.size()] = '\0';
+        return std::string_view(mem, str.size());
     }
 };
 
+inline void* arena_resource::do_allocate(size_t bytes, size_t alignment) { return _arena->allocate(bytes, alignment); }
+
+// Containers whose storage comes from a chunk_allocator (construct them with `arena.resource()`)
+template <class T>
+using arena_vector = std::pmr::vector<T>;
+using arena_string = std::pmr::string;
+
 }  // namespace mnstl
 
 #endif  // MNSTL_CHUNK_ALLOCATOR
\ No newline at end of file
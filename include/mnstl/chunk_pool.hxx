@@ -0,0 +1,133 @@
+#ifndef MNSTL_CHUNK_POOL
+#define MNSTL_CHUNK_POOL 1
+
+#include <array>
+#include <atomic>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+
+namespace mnstl {
+
+/**
+ * @brief A lock-free free-list of fixed-size memory blocks, shared by the arenas of several threads
+ * @details Blocks are identified by a 32-bit slot, and the free-list is a stack of slots whose head is packed together
+ * with a version tag into one 64-bit atomic, so that a slot being popped and pushed back between a load and a
+ * compare-and-swap (the ABA problem) is caught. Slot records live in segments that are created on demand and never
+ * move, so acquiring and releasing blocks never takes a lock.
+ * @note Blocks are only freed when the pool is destroyed, so it must outlive every arena using it
+ */
+class chunk_pool {
+   public:
+    constexpr static inline size_t default_block_size = size_t{64} << 10;
+    constexpr static inline uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+    struct block {
+        std::byte* data;
+        uint32_t slot;
+    };
+
+   private:
+    constexpr static inline size_t _segment_size = 1024;  // slots per segment
+    constexpr static inline size_t _max_segments = 4096;  // up to 4M blocks
+    struct slot_record {
+        std::byte* data = nullptr;
+        std::atomic<uint32_t> next = 0;  // 1 + the slot below this one on the free-list (0 at the bottom)
+    };
+    struct segment {
+        std::array<slot_record, _segment_size> slots;
+    };
+
+    const size_t _block_size;
+    std::atomic<uint64_t> _head = 0;  // version tag in the top 32 bits, 1 + the top slot (0 if empty) in the bottom 32
+    std::atomic<uint32_t> _created = 0;
+    std::array<std::atomic<segment*>, _max_segments> _segments{};
+
+    slot_record& record(uint32_t slot) noexcept {
+        return _segments[slot / _segment_size].load(std::memory_order_acquire)->slots[slot % _segment_size];
+    }
+
+    constexpr static uint64_t pack(uint64_t head, uint32_t top) noexcept {
+        return (((head >> 32) + 1) << 32) | top;  // Bump the tag on every change
+    }
+
+    block create() {
+        const uint32_t slot = _created.fetch_add(1, std::memory_order_relaxed);
+        if (slot / _segment_size >= _max_segments) { throw std::bad_alloc(); }
+        std::atomic<segment*>& owner = _segments[slot / _segment_size];
+        if (owner.load(std::memory_order_acquire) == nullptr) {
+            // Whichever thread gets here first publishes its segment; the others throw theirs away
+            auto fresh = std::make_unique<segment>();
+            segment* expected = nullptr;
+            if (owner.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel)) {
+                DISCARD(fresh.release());
+            }
+        }
+        slot_record& r = record(slot);
+        r.data = new std::byte[_block_size];
+        return block{.data = r.data, .slot = slot};
+    }
+
+   public:
+    explicit chunk_pool(size_t block_size = default_block_size) noexcept : _block_size(block_size) {}
+    ~chunk_pool() noexcept {
+        for (std::atomic<segment*>& owner : _segments) {
+            segment* s = owner.load(std::memory_order_relaxed);
+            if (!s) { continue; }
+            for (slot_record& r : s->slots) { delete[] r.data; }
+            delete s;
+        }
+    }
+
+    chunk_pool(const chunk_pool&) = delete;
+    chunk_pool& operator=(const chunk_pool&) = delete;
+
+    constexpr size_t block_size() const noexcept { return _block_size; }
+    // How many blocks have been allocated from the system (as opposed to reused)
+    size_t blocks_created() const noexcept { return _created.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Take a free block, allocating a new one if there are none
+     */
+    block acquire() {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t top = static_cast<uint32_t>(head);
+            if (top == 0) { return create(); }
+            slot_record& r = record(top - 1);
+            const uint32_t below = r.next.load(std::memory_order_relaxed);
+            if (_head.compare_exchange_weak(head, pack(head, below), std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                return block{.data = r.data, .slot = top - 1};
+            }
+        }
+    }
+
+    /**
+     * @brief Give a block back to the pool for another arena to use
+     */
+    void release(uint32_t slot) noexcept {
+        slot_record& r = record(slot);
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        do {
+            r.next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!_head.compare_exchange_weak(head, pack(head, slot + 1), std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief The pool that worker arenas share by default
+     */
+    static chunk_pool& shared() noexcept {
+        // Never destroyed, so arenas with static storage duration can still hand their blocks back at exit
+        static chunk_pool* pool = new chunk_pool();
+        return *pool;
+    }
+};
+
+}  // namespace mnstl
+
+#endif  // MNSTL_CHUNK_POOL
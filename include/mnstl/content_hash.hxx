@@ -0,0 +1,84 @@
+#ifndef MNSTL_CONTENT_HASH
+#define MNSTL_CONTENT_HASH 1
+
+#include <bit>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace mnstl {
+
+namespace detail {
+
+constexpr inline uint64_t _xxh_prime_1 = 0x9E3779B185EBCA87ull;
+constexpr inline uint64_t _xxh_prime_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr inline uint64_t _xxh_prime_3 = 0x165667B19E3779F9ull;
+constexpr inline uint64_t _xxh_prime_4 = 0x85EBCA77C2B2AE63ull;
+constexpr inline uint64_t _xxh_prime_5 = 0x27D4EB2F165667C5ull;
+
+// Read little-endian words one byte at a time, which compilers turn into a single (unaligned) load
+inline uint64_t _load_le64(const char* p) noexcept {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) { value |= uint64_t{static_cast<unsigned char>(p[i])} << (8 * i); }
+    return value;
+}
+inline uint64_t _load_le32(const char* p) noexcept {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 4; ++i) { value |= uint64_t{static_cast<unsigned char>(p[i])} << (8 * i); }
+    return value;
+}
+
+constexpr uint64_t _xxh_round(uint64_t accumulator, uint64_t input) noexcept {
+    return std::rotl(accumulator + input * _xxh_prime_2, 31) * _xxh_prime_1;
+}
+constexpr uint64_t _xxh_merge(uint64_t hash, uint64_t accumulator) noexcept {
+    return (hash ^ _xxh_round(0, accumulator)) * _xxh_prime_1 + _xxh_prime_4;
+}
+
+}  // namespace detail
+
+/**
+ * @brief A 64-bit hash of `data` (XXH64) that is the same on every platform and in every run
+ * @details For fingerprinting file contents (e.g. in module interfaces and build caches), where std::hash, which can
+ * differ between implementations and isn't meant for long inputs, won't do. Long inputs are consumed 32 bytes at a
+ * time across four independent lanes, so it runs at several bytes per cycle.
+ */
+inline uint64_t content_hash(std::string_view data, uint64_t seed = 0) noexcept {
+    using namespace detail;
+    const char* p = data.data();
+    const char* const end = p + data.size();
+    uint64_t hash;
+    if (data.size() >= 32) {
+        uint64_t lanes[4] = {seed + _xxh_prime_1 + _xxh_prime_2, seed + _xxh_prime_2, seed, seed - _xxh_prime_1};
+        for (; end - p >= 32; p += 32) {
+            for (size_t i = 0; i < 4; ++i) { lanes[i] = _xxh_round(lanes[i], _load_le64(p + 8 * i)); }
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (uint64_t lane : lanes) { hash = _xxh_merge(hash, lane); }
+    } else {
+        hash = seed + _xxh_prime_5;
+    }
+    hash += data.size();
+
+    for (; end - p >= 8; p += 8) {
+        hash = std::rotl(hash ^ _xxh_round(0, _load_le64(p)), 27) * _xxh_prime_1 + _xxh_prime_4;
+    }
+    if (end - p >= 4) {
+        hash = std::rotl(hash ^ (_load_le32(p) * _xxh_prime_1), 23) * _xxh_prime_2 + _xxh_prime_3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash = std::rotl(hash ^ (static_cast<unsigned char>(*p) * _xxh_prime_5), 11) * _xxh_prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= _xxh_prime_2;
+    hash ^= hash >> 29;
+    hash *= _xxh_prime_3;
+    return hash ^ (hash >> 32);
+}
+
+}  // namespace mnstl
+
+#endif  // MNSTL_CONTENT_HASH
@@ -34,6 +34,19 @@ using int128_t = _basic_int128<true>;
 using uint128_t = _basic_int128<false>;
 #endif
 
+// Whether the emulated int128_t's arithmetic is done with the hardware's 128-bit support, rather than 64-bit pieces:
+// 1 for the compiler's __int128 (GCC and Clang, on 64-bit targets), 2 for MSVC's x64 intrinsics (_umul128, _udiv128),
+// 0 to always use the portable implementation
+#ifndef MNSTL_I128_INTRINSICS
+#if defined(__SIZEOF_INT128__)
+#define MNSTL_I128_INTRINSICS 1
+#elif defined(_MSC_VER) && defined(_M_X64) && _MSC_VER >= 1920
+#define MNSTL_I128_INTRINSICS 2
+#else
+#define MNSTL_I128_INTRINSICS 0
+#endif
+#endif  // MNSTL_I128_INTRINSICS
+
 // C++23 added (optional) support for fixed-width floating point numbers
 // If possible, use those
 // otherwise, fall back on the assumption that float is 32 bits and double is 64 bits (usually true on 64-bit systems)
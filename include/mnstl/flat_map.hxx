@@ -0,0 +1,217 @@
+#ifndef MNSTL_FLAT_MAP
+#define MNSTL_FLAT_MAP 1
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mnstl {
+
+/**
+ * @brief An insert-only hash map from integer keys (e.g. string_pool atoms) to values, stored without per-entry nodes
+ * @details The first `InlineCapacity` entries live inside the map itself and are found with a linear scan over their
+ * keys, which for a handful of keys is cheaper than hashing. Past that, entries move into an open-addressing table
+ * (allocated from `resource`) with linear probing: a byte per slot holds 7 bits of the key's hash, so most probes that
+ * miss are rejected without touching the keys or values.
+ * Entries are never removed one at a time, so the table needs no tombstones.
+ * @note Pointers to values are invalidated by inserting, since that can move entries into a bigger table
+ */
+template <std::integral Key, class Value, size_t InlineCapacity = 8>
+class flat_map {
+    static_assert(InlineCapacity > 0);
+
+   private:
+    constexpr static inline uint8_t _empty = 0;
+    constexpr static inline uint8_t _occupied = 0x80;  // Set in the control byte of every occupied slot
+    constexpr static inline size_t _min_table_size = std::bit_ceil(InlineCapacity * 2);
+
+    std::pmr::memory_resource* _resource;
+    size_t _size = 0;
+    // Table mode only (_capacity == 0 while the entries are inline)
+    size_t _capacity = 0;
+    uint8_t* _control = nullptr;
+    Key* _keys = nullptr;
+    Value* _values = nullptr;
+
+    std::array<Key, InlineCapacity> _inline_keys{};
+    alignas(Value) std::byte _inline_values[sizeof(Value) * InlineCapacity];
+
+    Value* inline_values() noexcept { return std::launder(reinterpret_cast<Value*>(_inline_values)); }
+    const Value* inline_values() const noexcept {
+        return std::launder(reinterpret_cast<const Value*>(_inline_values));
+    }
+
+    constexpr static uint64_t hash(Key key) noexcept {
+        // Fibonacci hashing spreads small, dense keys (like atoms) across the table
+        return static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+    }
+    size_t home(uint64_t h) const noexcept { return static_cast<size_t>(h >> (64 - std::countr_zero(_capacity))); }
+    constexpr static uint8_t tag(uint64_t h) noexcept { return static_cast<uint8_t>(_occupied | (h & 0x7F)); }
+
+    template <class T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(_resource->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void destroy_entries() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<Value>) {
+            if (_capacity == 0) {
+                std::destroy_n(inline_values(), _size);
+            } else {
+                for (size_t i = 0; i < _capacity; ++i) {
+                    if (_control[i] != _empty) { std::destroy_at(_values + i); }
+                }
+            }
+        }
+    }
+
+    void free_table() noexcept {
+        if (_capacity == 0) { return; }
+        _resource->deallocate(_control, _capacity, alignof(uint8_t));
+        _resource->deallocate(_keys, sizeof(Key) * _capacity, alignof(Key));
+        _resource->deallocate(_values, sizeof(Value) * _capacity, alignof(Value));
+        _capacity = 0;
+        _control = nullptr;
+        _keys = nullptr;
+        _values = nullptr;
+    }
+
+    // Place an entry known not to be present, in a table with room for it
+    template <class... Args>
+    Value* place(uint64_t h, Key key, Args&&... args) {
+        const size_t mask = _capacity - 1;
+        size_t i = home(h);
+        while (_control[i] != _empty) { i = (i + 1) & mask; }
+        Value* value = std::construct_at(_values + i, std::forward<Args>(args)...);
+        _control[i] = tag(h);
+        _keys[i] = key;
+        return value;
+    }
+
+    void grow(size_t new_capacity) {
+        uint8_t* old_control = _control;
+        Key* old_keys = _keys;
+        Value* old_values = _values;
+        const size_t old_capacity = _capacity;
+
+        _control = allocate_array<uint8_t>(new_capacity);
+        _keys = allocate_array<Key>(new_capacity);
+        _values = allocate_array<Value>(new_capacity);
+        _capacity = new_capacity;
+        std::fill_n(_control, new_capacity, _empty);
+
+        if (old_capacity == 0) {
+            Value* values = inline_values();
+            for (size_t i = 0; i < _size; ++i) {
+                place(hash(_inline_keys[i]), _inline_keys[i], std::move(values[i]));
+                std::destroy_at(values + i);
+            }
+            return;
+        }
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_control[i] == _empty) { continue; }
+            place(hash(old_keys[i]), old_keys[i], std::move(old_values[i]));
+            std::destroy_at(old_values + i);
+        }
+        _resource->deallocate(old_control, old_capacity, alignof(uint8_t));
+        _resource->deallocate(old_keys, sizeof(Key) * old_capacity, alignof(Key));
+        _resource->deallocate(old_values, sizeof(Value) * old_capacity, alignof(Value));
+    }
+
+    template <class Self>
+    static auto find_in(Self& self, Key key) noexcept -> decltype(self.inline_values()) {
+        if (self._capacity == 0) {
+            for (size_t i = 0; i < self._size; ++i) {
+                if (self._inline_keys[i] == key) { return self.inline_values() + i; }
+            }
+            return nullptr;
+        }
+        const uint64_t h = hash(key);
+        const uint8_t t = tag(h);
+        const size_t mask = self._capacity - 1;
+        // The load factor is capped below 1, so an empty slot always ends the probe
+        for (size_t i = self.home(h);; i = (i + 1) & mask) {
+            const uint8_t c = self._control[i];
+            if (c == _empty) { return nullptr; }
+            if (c == t && self._keys[i] == key) { return self._values + i; }
+        }
+    }
+
+   public:
+    explicit flat_map(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept :
+        _resource(resource) {}
+    ~flat_map() noexcept {
+        destroy_entries();
+        free_table();
+    }
+
+    // Lives in place (like the scopes that hold one), so it can't be copied or moved
+    flat_map(const flat_map&) = delete;
+    flat_map(flat_map&&) = delete;
+    flat_map& operator=(const flat_map&) = delete;
+    flat_map& operator=(flat_map&&) = delete;
+
+    constexpr size_t size() const noexcept { return _size; }
+    constexpr bool empty() const noexcept { return _size == 0; }
+    constexpr static size_t inline_capacity() noexcept { return InlineCapacity; }
+    // Whether the entries have outgrown the inline storage
+    constexpr bool is_spilled() const noexcept { return _capacity != 0; }
+
+    Value* find(Key key) noexcept { return find_in(*this, key); }
+    const Value* find(Key key) const noexcept { return find_in(*this, key); }
+    bool contains(Key key) const noexcept { return find(key) != nullptr; }
+
+    /**
+     * @brief Insert a value constructed from `args` if `key` isn't already present
+     * @return The value for `key`, and whether it was inserted (an existing value is left untouched)
+     */
+    template <class... Args>
+    std::pair<Value*, bool> try_emplace(Key key, Args&&... args) {
+        if (Value* existing = find(key)) { return {existing, false}; }
+        if (_capacity == 0 && _size < InlineCapacity) {
+            _inline_keys[_size] = key;
+            Value* value = std::construct_at(inline_values() + _size, std::forward<Args>(args)...);
+            ++_size;
+            return {value, true};
+        }
+        // Keep at least one slot in eight empty, so probes stay short
+        if (_capacity == 0 || (_size + 1) * 8 > _capacity * 7) {
+            grow(_capacity == 0 ? _min_table_size : _capacity * 2);
+        }
+        Value* value = place(hash(key), key, std::forward<Args>(args)...);
+        ++_size;
+        return {value, true};
+    }
+
+    /**
+     * @brief Call `fn(key, value)` for every entry, in no particular order
+     */
+    template <class Fn>
+    void for_each(Fn&& fn) const {
+        if (_capacity == 0) {
+            for (size_t i = 0; i < _size; ++i) { fn(_inline_keys[i], inline_values()[i]); }
+            return;
+        }
+        for (size_t i = 0; i < _capacity; ++i) {
+            if (_control[i] != _empty) { fn(_keys[i], _values[i]); }
+        }
+    }
+
+    void clear() noexcept {
+        destroy_entries();
+        free_table();
+        _size = 0;
+    }
+};
+
+}  // namespace mnstl
+
+#endif  // MNSTL_FLAT_MAP
@@ -13,6 +13,10 @@
 #include <type_traits>
 #include <utility>
 
+#if !MNSTL_NATIVE_I128 && MNSTL_I128_INTRINSICS == 2
+#include <intrin.h>
+#endif
+
 // macros to make definitions of op= (e.g. +=) more concise
 namespace mnstl {
 #if !MNSTL_NATIVE_I128
@@ -45,6 +49,12 @@ namespace i128_detail {
 template <class T>
 using i128_arithmetic_result_t = std::conditional_t<std::is_signed_v<T>, int128_t, uint128_t>;
 
+#if MNSTL_I128_INTRINSICS == 1
+// The compiler's own 128-bit types, which the emulated ones convert to for their slower operations
+__extension__ typedef unsigned __int128 native_u128;
+__extension__ typedef __int128 native_i128;
+#endif
+
 /**
  * helper for bitwise left shift of a 128-bit int
  */
@@ -144,7 +154,18 @@ struct _basic_int128 {
 
     template <FloatingPoint F>
     constexpr operator F() const noexcept {
+#if MNSTL_I128_INTRINSICS == 1
+        // Converting the whole value at once rounds correctly, where adding the scaled halves can round twice
+        const i128_detail::native_u128 bits
+            = (static_cast<i128_detail::native_u128>(static_cast<std::uint64_t>(_upper)) << 64) | _lower;
+        if constexpr (IsSigned) {
+            return static_cast<F>(static_cast<i128_detail::native_i128>(bits));
+        } else {
+            return static_cast<F>(bits);
+        }
+#else
         return static_cast<F>(_upper) * static_cast<F>(TWO_POW_64) + static_cast<F>(_lower);
+#endif  // MNSTL_I128_INTRINSICS == 1
     }
     template <Numeric T>
         requires(!detail::is_any_of<T, int128_t, uint128_t>)  // avoid ambiguity with the copy/move assignment operators
@@ -690,12 +711,24 @@ constexpr int _clz_u128(uint128_t x) noexcept {
     return 64 + static_cast<int>(std::countl_zero(x._lower));
 }
 
+#if MNSTL_I128_INTRINSICS == 1
+constexpr native_u128 _to_native(uint128_t i) noexcept { return (static_cast<native_u128>(i._upper) << 64) | i._lower; }
+constexpr uint128_t _from_native(native_u128 i) noexcept {
+    return uint128_t{static_cast<std::uint64_t>(i >> 64), static_cast<std::uint64_t>(i)};
+}
+#endif  // MNSTL_I128_INTRINSICS == 1
+
 constexpr uint128_t _mul_64(std::uint64_t a, std::uint64_t b) noexcept {
-#if defined(_MSC_VER)
-    unsigned long long high;
-    std::uint64_t low = _umul128(a, b, &high);
-    return uint128_t{static_cast<std::uint64_t>(high), low};
+#if MNSTL_I128_INTRINSICS == 1
+    return _from_native(static_cast<native_u128>(a) * b);
 #else
+#if MNSTL_I128_INTRINSICS == 2
+    if (!std::is_constant_evaluated()) {
+        unsigned long long high;
+        const std::uint64_t low = _umul128(a, b, &high);
+        return uint128_t{static_cast<std::uint64_t>(high), low};
+    }
+#endif  // MNSTL_I128_INTRINSICS == 2
     std::uint64_t a_low = static_cast<std::uint32_t>(a);
     std::uint64_t b_low = static_cast<std::uint32_t>(b);
     std::uint64_t a_high = a >> 32;
@@ -715,10 +748,13 @@ constexpr uint128_t _mul_64(std::uint64_t a, std::uint64_t b) noexcept {
     // the lower 64 bits are the lower 32 bits of mid and the lower 32 bits of p0.
     // the upper 64 bits are p3 and the upper 32 bits of p1 and p2
     return uint128_t{p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32), (mid << 32) | static_cast<std::uint32_t>(p0)};
-#endif
+#endif  // MNSTL_I128_INTRINSICS == 1
 }
 
 constexpr uint128_t _mul_u128(uint128_t a, uint128_t b) noexcept {
+#if MNSTL_I128_INTRINSICS == 1
+    return _from_native(_to_native(a) * _to_native(b));  // A couple of multiply instructions, with no branches
+#else
     if (a == 0 || b == 0) { return 0; }
     if (a == 1) { return b; }
     if (b == 1) { return a; }
@@ -776,6 +812,7 @@ constexpr uint128_t _mul_u128(uint128_t a, uint128_t b) noexcept {
     if (carry < mid_low) { ++mid_carry; }
     std::uint64_t high = lh._upper + hl._upper + mid_carry;
     return uint128_t{high, low};
+#endif  // MNSTL_I128_INTRINSICS == 1
 }
 
 constexpr divmod_u128_result _divmod_u128(uint128_t numerator, uint128_t denominator) {
@@ -787,6 +824,10 @@ constexpr divmod_u128_result _divmod_u128(uint128_t numerator, uint128_t denomin
 #endif
     }
 
+#if MNSTL_I128_INTRINSICS == 1
+    const native_u128 n = _to_native(numerator), d = _to_native(denominator);
+    return divmod_u128_result{.quotient = _from_native(n / d), .remainder = _from_native(n % d)};
+#else
     // shortcuts for easy values (0/x = 0 and x/1 = x)
     if (numerator == 0) { return divmod_u128_result{.quotient = 0, .remainder = 0}; }
     if (denominator == 1) { return divmod_u128_result{.quotient = numerator, .remainder = 0}; }
@@ -811,6 +852,18 @@ constexpr divmod_u128_result _divmod_u128(uint128_t numerator, uint128_t denomin
         return divmod_u128_result{.quotient = numerator >> shift, .remainder = numerator & (denominator - 1)};
     }
 
+#if MNSTL_I128_INTRINSICS == 2
+    if (denominator._upper == 0 && !std::is_constant_evaluated()) {
+        // Long division by a 64-bit divisor: the upper half's remainder is always less than the divisor, so the rest
+        // fits in one 128-by-64-bit hardware division
+        const std::uint64_t d = denominator._lower;
+        unsigned __int64 remainder;
+        const std::uint64_t lower_quotient = _udiv128(numerator._upper % d, numerator._lower, d, &remainder);
+        return divmod_u128_result{.quotient = uint128_t{numerator._upper / d, lower_quotient},
+                                  .remainder = remainder};
+    }
+#endif  // MNSTL_I128_INTRINSICS == 2
+
     // this is a restoring divider
     uint128_t quotient = 0;
     uint128_t remainder = 0;
@@ -828,6 +881,7 @@ constexpr divmod_u128_result _divmod_u128(uint128_t numerator, uint128_t denomin
         }
     }
     return divmod_u128_result{.quotient = quotient, .remainder = remainder};
+#endif  // MNSTL_I128_INTRINSICS == 1
 }
 
 }  // namespace i128_detail
@@ -865,23 +919,33 @@ constexpr uint128_t _abs_i128(int128_t i) noexcept {
 
 constexpr std::string _tostr_u128(const uint128_t& i) {
     if (i == 0) { return "0"; }
+    // Split off 19 digits (the most a uint64_t always holds) per 128-bit division, and print each piece with 64-bit
+    // arithmetic, so even the largest value takes two wide divisions rather than one per digit
+    constexpr std::uint64_t piece_divisor = 10'000'000'000'000'000'000ull;
+    constexpr int piece_digits = 19;
     char buffer[40];  // 128 bits fits in ceil(log10(2^128)) = 39 decimal digits + 1 for null terminator
     char* ptr = buffer + sizeof(buffer) - sizeof(char);  // fill the buffer from the end
     *ptr = '\0';
     uint128_t temp = i;
-    while (temp != 0) {
+    while (temp >= piece_divisor) {
 #if MNSTL_NATIVE_I128
-        auto quotient = temp / uint128_t{10};
-        auto remainder = temp % uint128_t{10};
+        auto quotient = temp / uint128_t{piece_divisor};
+        auto remainder = temp % uint128_t{piece_divisor};
 #else
-        const i128_detail::divmod_u128_result divmod = i128_detail::_divmod_u128(temp, uint128_t{10});
+        const i128_detail::divmod_u128_result divmod = i128_detail::_divmod_u128(temp, uint128_t{piece_divisor});
         const auto quotient = divmod.quotient;
         const auto remainder = divmod.remainder;
 #endif
-        --ptr;
-        *ptr = static_cast<char>('0' + std::uint8_t(remainder));  // 0 <= remainder <= 9
+        // Pieces below the leading one keep their leading zeroes
+        auto piece = static_cast<std::uint64_t>(remainder);
+        for (int digit = 0; digit < piece_digits; ++digit, piece /= 10) {
+            *--ptr = static_cast<char>('0' + piece % 10);
+        }
         temp = quotient;
     }
+    for (auto piece = static_cast<std::uint64_t>(temp); piece != 0; piece /= 10) {
+        *--ptr = static_cast<char>('0' + piece % 10);
+    }
     return std::string(ptr);
 }
 
@@ -954,7 +1018,9 @@ class numeric_limits<mnstl::int128_t> {
     constexpr static inline bool traps = false;
     constexpr static inline bool tinyness_before = false;
 
-    constexpr static inline mnstl::int128_t min() noexcept { return -(mnstl::int128_t{1} << 127); }
+    constexpr static inline mnstl::int128_t min() noexcept {
+        return mnstl::int128_t{std::numeric_limits<std::int64_t>::min(), 0};
+    }
     constexpr static inline mnstl::int128_t lowest() noexcept { return min(); }
     constexpr static inline mnstl::int128_t max() noexcept {
         return mnstl::int128_t{std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::uint64_t>::max()};
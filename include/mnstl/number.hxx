@@ -1,31 +1,23 @@
 #ifndef MNSTL_NUMBER
 #define MNSTL_NUMBER 1
 
+#include <algorithm>
+#include <bit>
+#include <charconv>
 #include <cmath>
 #include <core.hpp>
+#include <cstdint>
 #include <limits>
 #include <mnstl/enum_matches.hxx>
 #include <mnstl/i128.hxx>
 #include <mnstl/safe_cmp.hxx>
+#include <span>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <type_traits>
 #include <utility>
 
-#define MNSTL_NUMBER_BINARY_OP(op)                                                                            \
-    return _visit([&](auto l) {                                                                               \
-        return other._visit([&](auto r) {                                                                     \
-            if constexpr (std::is_same_v<decltype(l), const char*>) {                                         \
-                return number_t{l};                                                                           \
-            } else if constexpr (std::is_same_v<decltype(r), const char*>) {                                  \
-                return number_t{r};                                                                           \
-            } else {                                                                                          \
-                using common_t = std::common_type_t<decltype(l), decltype(r)>;                                \
-                return number_t{static_cast<common_t>(static_cast<common_t>(l) op static_cast<common_t>(r))}; \
-            }                                                                                                 \
-        });                                                                                                   \
-    });
-
 #define MNSTL_NUMBER_INTEGRAL_BINARY_OP(op)                                                                   \
     return _visit([&](auto l) {                                                                               \
         return other._visit([&](auto r) {                                                                     \
@@ -57,6 +49,54 @@ enum class Base : uint8_t {
     Hexadecimal = 16  // 0x prefix
 };
 
+/**
+ * @brief The arithmetic operators that number_t has same-type fast paths for
+ */
+enum class arithmetic_op : uint8_t {
+    add,
+    subtract,
+    multiply
+};
+
+namespace detail {
+
+// Returns true (leaving `result` unspecified) if `l op r` doesn't fit in T
+template <SignedIntegral T>
+[[nodiscard]] constexpr bool _overflowing_arithmetic(arithmetic_op op, T l, T r, T& result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    // The builtins only take the compiler's own integers, so the software int128_t is checked by hand below
+    if constexpr (std::is_integral_v<T>) {
+        switch (op) {
+            case arithmetic_op::add: return __builtin_add_overflow(l, r, &result);
+            case arithmetic_op::subtract: return __builtin_sub_overflow(l, r, &result);
+            case arithmetic_op::multiply: return __builtin_mul_overflow(l, r, &result);
+        }
+        manganese_unreachable();
+    }
+#endif  // __GNUC__ || __clang__
+    constexpr T max = std::numeric_limits<T>::max(), min = std::numeric_limits<T>::min();
+    switch (op) {
+        case arithmetic_op::add:
+            if ((r > 0 && l > max - r) || (r < 0 && l < min - r)) { return true; }
+            result = static_cast<T>(l + r);
+            return false;
+        case arithmetic_op::subtract:
+            if ((r < 0 && l > max + r) || (r > 0 && l < min + r)) { return true; }
+            result = static_cast<T>(l - r);
+            return false;
+        case arithmetic_op::multiply:
+            // Compare against the bounds divided by one operand, since computing an overflowing product is UB
+            if (l > 0 ? (r > 0 ? l > max / r : r < min / l) : (r > 0 ? l < min / r : (l != 0 && r < max / l))) {
+                return true;
+            }
+            result = static_cast<T>(l * r);
+            return false;
+    }
+    manganese_unreachable();
+}
+
+}  // namespace detail
+
 constexpr const char* baseToString(Base b) noexcept {
     switch (b) {
         case Base::Binary: return "binary";
@@ -104,6 +144,96 @@ class number_t {
     };
     held_type _underlying;
 
+    template <class T>
+    constexpr T _get() const noexcept {
+        if constexpr (std::is_same_v<T, int32_t>) {
+            return _i32;
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return _i64;
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return _u32;
+        } else if constexpr (std::is_same_v<T, uint64_t>) {
+            return _u64;
+        } else if constexpr (std::is_same_v<T, float32_t>) {
+            return _f32;
+        } else {
+            static_assert(std::is_same_v<T, float64_t>, "number_t::_get only covers the fast path types");
+            return _f64;
+        }
+    }
+
+    // The types literals and folded constants usually have, so arithmetic between two of the same one is special-cased
+    constexpr static bool _has_fast_path(held_type t) noexcept {
+        using enum held_type;
+        return enum_matches<held_type>(t, int32, int64, uint32, uint64, float32, float64);
+    }
+
+    template <class T>
+    constexpr static number_t _arithmetic_as(arithmetic_op op, T l, T r) noexcept {
+        if constexpr (SignedIntegral<T>) {
+            T result{};
+            if (detail::_overflowing_arithmetic(op, l, r, result)) [[unlikely]] {
+                return number_t{"Integer overflow in constant expression"};
+            }
+            return number_t{result};
+        } else {
+            // Unsigned arithmetic wraps, and floats go to +/- inf
+            switch (op) {
+                case arithmetic_op::add: return number_t{static_cast<T>(l + r)};
+                case arithmetic_op::subtract: return number_t{static_cast<T>(l - r)};
+                case arithmetic_op::multiply: return number_t{static_cast<T>(l * r)};
+            }
+            manganese_unreachable();
+        }
+    }
+
+    // Whether `l / r` (or `l % r`) overflows, as the smallest signed value divided by -1 does
+    template <Integral T>
+    constexpr static bool _is_overflowing_division(T l, T r) noexcept {
+        if constexpr (SignedIntegral<T>) {
+            return r == static_cast<T>(-1) && l == std::numeric_limits<T>::min();
+        } else {
+            return false;
+        }
+    }
+
+    // `l` shifted by `r` bits, which must be fewer than T has (the hardware doesn't agree on anything else)
+    template <Integral T>
+    constexpr static number_t _shift(T l, T r, bool is_left) noexcept {
+        constexpr int bits = std::numeric_limits<T>::digits + (std::numeric_limits<T>::is_signed ? 1 : 0);
+        bool is_out_of_range = r >= static_cast<T>(bits);
+        if constexpr (SignedIntegral<T>) { is_out_of_range = is_out_of_range || r < static_cast<T>(0); }
+        if (is_out_of_range) [[unlikely]] {
+            return number_t{"Cannot shift an integer by a negative number of bits, or by at least its width"};
+        }
+        return number_t{static_cast<T>(is_left ? l << r : l >> r)};
+    }
+
+    // `op` on every operand in turn, which must all hold T
+    template <class T>
+    constexpr static number_t _fold_as(arithmetic_op op, std::span<const number_t> operands) noexcept {
+        number_t result = operands.front();
+        for (const number_t& operand : operands.subspan(1)) {
+            result = _arithmetic_as<T>(op, result._get<T>(), operand._get<T>());
+            if (result.is_error()) [[unlikely]] { break; }
+        }
+        return result;
+    }
+
+    // With both operands holding the same fast path type, dispatch on it once rather than visiting each operand
+    constexpr number_t _same_type_arithmetic(arithmetic_op op, const number_t& other) const noexcept {
+        using enum held_type;
+        switch (_underlying) {
+            case int32: return _arithmetic_as(op, _i32, other._i32);
+            case int64: return _arithmetic_as(op, _i64, other._i64);
+            case uint32: return _arithmetic_as(op, _u32, other._u32);
+            case uint64: return _arithmetic_as(op, _u64, other._u64);
+            case float32: return _arithmetic_as(op, _f32, other._f32);
+            case float64: return _arithmetic_as(op, _f64, other._f64);
+            default: manganese_unreachable();
+        }
+    }
+
     template <class F>
     constexpr decltype(auto) _visit(F&& f) const NOEXCEPT_IF_RELEASE {
         using enum held_type;
@@ -245,6 +375,60 @@ class number_t {
         return result;
     }
 
+    /**
+     * @brief `*this op other` in the operands' common type, with signed overflow reported as an error
+     * @details Two operands of the same common type (32- and 64-bit integers, floats) skip the generic double
+     * dispatch; anything else goes through _visit, converting both to their common type first. Either way the
+     * result is computed (and checked) in that type, so e.g. an int32 plus an int8 overflows as an int32 would.
+     */
+    constexpr number_t arithmetic(arithmetic_op op, const number_t& other) const noexcept {
+        if (_underlying == other._underlying && _has_fast_path(_underlying)) [[likely]] {
+            return _same_type_arithmetic(op, other);
+        }
+        return _visit([&](auto l) {
+            return other._visit([&](auto r) {
+                if constexpr (std::is_same_v<decltype(l), const char*>) {
+                    return number_t{l};
+                } else if constexpr (std::is_same_v<decltype(r), const char*>) {
+                    return number_t{r};
+                } else {
+                    using common_t = std::common_type_t<decltype(l), decltype(r)>;
+                    return _arithmetic_as<common_t>(op, static_cast<common_t>(l), static_cast<common_t>(r));
+                }
+            });
+        });
+    }
+
+    /**
+     * @brief Apply `op` left to right across `operands` (e.g. a chain like `a + b + c`), stopping at the first error
+     * When every operand holds the same fast path type, the type is dispatched on once for the whole chain.
+     * @return A number_t holding nothing if there are no operands
+     */
+    constexpr static number_t fold(arithmetic_op op, std::span<const number_t> operands) noexcept {
+        if (operands.empty()) { return number_t{}; }
+        const held_type first = operands.front()._underlying;
+        bool same_type = _has_fast_path(first);
+        for (size_t i = 1; same_type && i < operands.size(); ++i) { same_type = operands[i]._underlying == first; }
+        if (same_type) [[likely]] {
+            using enum held_type;
+            switch (first) {
+                case int32: return _fold_as<int32_t>(op, operands);
+                case int64: return _fold_as<int64_t>(op, operands);
+                case uint32: return _fold_as<uint32_t>(op, operands);
+                case uint64: return _fold_as<uint64_t>(op, operands);
+                case float32: return _fold_as<float32_t>(op, operands);
+                case float64: return _fold_as<float64_t>(op, operands);
+                default: manganese_unreachable();
+            }
+        }
+        number_t result = operands.front();
+        for (const number_t& operand : operands.subspan(1)) {
+            if (result.is_error()) [[unlikely]] { break; }
+            result = result.arithmetic(op, operand);
+        }
+        return result;
+    }
+
     // Operators
     constexpr number_t operator-() const noexcept {
         return _visit([](auto val) {
@@ -276,9 +460,13 @@ class number_t {
         });
     }
 
-    constexpr number_t operator+(const number_t& other) const noexcept { MNSTL_NUMBER_BINARY_OP(+); }
-    constexpr number_t operator-(const number_t& other) const noexcept { MNSTL_NUMBER_BINARY_OP(-); }
-    constexpr number_t operator*(const number_t& other) const noexcept { MNSTL_NUMBER_BINARY_OP(*); }
+    constexpr number_t operator+(const number_t& other) const noexcept { return arithmetic(arithmetic_op::add, other); }
+    constexpr number_t operator-(const number_t& other) const noexcept {
+        return arithmetic(arithmetic_op::subtract, other);
+    }
+    constexpr number_t operator*(const number_t& other) const noexcept {
+        return arithmetic(arithmetic_op::multiply, other);
+    }
     constexpr number_t operator%(const number_t& other) const noexcept {
         return _visit([&](auto l) {
             return other._visit([&](auto r) {
@@ -291,6 +479,9 @@ class number_t {
                     auto val_l = static_cast<common_t>(l);
                     auto val_r = static_cast<common_t>(r);
                     if (val_r == 0) { return number_t{"Cannot modulo by 0"}; }
+                    if (_is_overflowing_division(val_l, val_r)) [[unlikely]] {
+                        return number_t{"Integer overflow in constant expression"};
+                    }
                     return number_t{static_cast<common_t>(val_l % val_r)};
                 } else {
                     return number_t{};
@@ -300,6 +491,9 @@ class number_t {
     }
 
     constexpr number_t true_div(const number_t& other) const noexcept {
+        if (_underlying == held_type::float64 && other._underlying == held_type::float64) [[likely]] {
+            return number_t{_f64 / other._f64};
+        }
         return _visit([&](auto l) {
             return other._visit([&](auto r) {
                 if constexpr (std::is_same_v<decltype(l), const char*>) {
@@ -330,6 +524,9 @@ class number_t {
                     if constexpr (FloatingPoint<common_t>) {
                         return number_t(std::floor(val_l / val_r));
                     } else {
+                        if (_is_overflowing_division(val_l, val_r)) [[unlikely]] {
+                            return number_t{"Integer overflow in constant expression"};
+                        }
                         auto res = val_l / val_r;
                         auto rem = val_l % val_r;
                         if (((val_l < 0) ^ (val_r < 0)) && rem != 0) { --res; }
@@ -343,8 +540,27 @@ class number_t {
     constexpr number_t operator&(const number_t& other) const noexcept { MNSTL_NUMBER_INTEGRAL_BINARY_OP(&); }
     constexpr number_t operator|(const number_t& other) const noexcept { MNSTL_NUMBER_INTEGRAL_BINARY_OP(|); }
     constexpr number_t operator^(const number_t& other) const noexcept { MNSTL_NUMBER_INTEGRAL_BINARY_OP(^); }
-    constexpr number_t operator<<(const number_t& other) const noexcept { MNSTL_NUMBER_INTEGRAL_BINARY_OP(<<); }
-    constexpr number_t operator>>(const number_t& other) const noexcept { MNSTL_NUMBER_INTEGRAL_BINARY_OP(>>); }
+    constexpr number_t operator<<(const number_t& other) const noexcept { return shift(other, true); }
+    constexpr number_t operator>>(const number_t& other) const noexcept { return shift(other, false); }
+
+    // This shifted left (or right) by `other` bits, in their common type
+    constexpr number_t shift(const number_t& other, bool is_left) const noexcept {
+        return _visit([&](auto l) {
+            return other._visit([&](auto r) {
+                if constexpr (std::is_same_v<decltype(l), const char*>) {
+                    return number_t{l};
+                } else if constexpr (std::is_same_v<decltype(r), const char*>) {
+                    return number_t{r};
+                } else if constexpr (Integral<decltype(l)> && Integral<decltype(r)>) {
+                    using common_t = std::common_type_t<decltype(l), decltype(r)>;
+                    return _shift(static_cast<common_t>(l), static_cast<common_t>(r), is_left);
+                } else {
+                    return number_t{is_left ? "Cannot apply operator << to floating point values"
+                                            : "Cannot apply operator >> to floating point values"};
+                }
+            });
+        });
+    }
 
     constexpr bool operator==(const number_t& other) const noexcept {
         return _visit([&](auto l) {
@@ -414,10 +630,89 @@ namespace detail {
         }
         return result;
     } else {
-        return static_cast<double>(std::pow(1, exp));
+        return std::pow(10.0, exp);
     }
 }
 
+// Load 8 characters with the first one in the lowest byte, whatever the platform's byte order
+[[nodiscard]] constexpr uint64_t _load_eight_chars(const char* ptr) noexcept {
+    uint64_t chunk = 0;
+    for (unsigned i = 0; i < 8; ++i) { chunk |= static_cast<uint64_t>(static_cast<unsigned char>(ptr[i])) << (8 * i); }
+    return chunk;
+}
+
+// Whether every byte of a chunk from _load_eight_chars is an ASCII digit (0x30 to 0x39)
+[[nodiscard]] constexpr bool _is_eight_digits(uint64_t chunk) noexcept {
+    // Every high nibble must be 3, and adding 6 must not carry any low nibble into it (which 0x3A to 0x3F would)
+    return (chunk & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull
+        && ((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull;
+}
+
+// The value of 8 decimal digits, computed a register at a time: digits are combined into pairs, then fours, then all 8
+[[nodiscard]] constexpr uint32_t _parse_eight_digits(uint64_t chunk) noexcept {
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFull;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFull;
+    return static_cast<uint32_t>((chunk * 10000 + (chunk >> 32)) & 0xFFFFFFFFull);
+}
+
+// Whether a decimal float literal (without its sign or suffix) is below 1. An out of range literal below 1 is too small
+// to represent and any other is too large, so this is worked out from where its first significant digit lands once
+// the exponent is applied
+[[nodiscard]] constexpr bool _is_below_one(const char* ptr, const char* end) noexcept {
+    int64_t leading = 0;  // The power of ten of the first significant digit, before the exponent
+    bool found = false;
+    for (; ptr != end && isdigit(*ptr); ++ptr) {
+        if (found) {
+            ++leading;
+        } else if (*ptr != '0') {
+            found = true;
+        }
+    }
+    if (ptr != end && *ptr == '.') {
+        int64_t zeros = 0;
+        for (++ptr; ptr != end && isdigit(*ptr); ++ptr) {
+            if (found) { continue; }
+            if (*ptr == '0') {
+                ++zeros;
+            } else {
+                found = true;
+                leading = -(zeros + 1);
+            }
+        }
+    }
+    if (!found) { return true; }  // Zero (which can't be out of range anyway)
+
+    int64_t exponent = 0;
+    bool exponent_negative = false;
+    if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+        ++ptr;
+        if (ptr != end && (*ptr == '+' || *ptr == '-')) { exponent_negative = *ptr++ == '-'; }
+        constexpr int64_t saturated = int64_t{1} << 40;  // Far beyond any float's range, and leading can't cancel it
+        for (; ptr != end && isdigit(*ptr); ++ptr) { exponent = std::min(exponent * 10 + (*ptr - '0'), saturated); }
+    }
+    return leading + (exponent_negative ? -exponent : exponent) < 0;
+}
+
+// _stox for floats outside of constant evaluation, where std::from_chars can round correctly (and quickly)
+template <FloatingPoint T>
+[[nodiscard]] string_conversion_result_t<T> _stof_from_chars(const char* ptr, const char* end,
+                                                             bool is_negative) noexcept {
+    string_conversion_result_t<T> result;
+    T value{};
+    const auto [parsed_end, error] = std::from_chars(ptr, end, value, std::chars_format::general);
+    if (error == std::errc::invalid_argument || parsed_end != end) { return result; }
+    result.exists = true;
+    if (error == std::errc::result_out_of_range) {
+        // Like the portable parser, values too small to represent become 0 and values too large become infinite
+        result.overflowed = true;
+        result.value = _is_below_one(ptr, end) ? T{0} : (is_negative ? -1 : 1) * std::numeric_limits<T>::infinity();
+        return result;
+    }
+    result.value = is_negative ? -value : value;
+    return result;
+}
+
 template <FloatingPoint T>
 [[nodiscard]] constexpr string_conversion_result_t<T> _stox(const char* ptr, const char* end, Base b,
                                                             bool is_negative) noexcept {
@@ -431,6 +726,8 @@ template <FloatingPoint T>
         result.exists = false;
         return result;
     }
+    // The digit-by-digit parser below is only needed for constant evaluation, where from_chars isn't available
+    if (!std::is_constant_evaluated()) { return _stof_from_chars<T>(ptr, end, is_negative); }
 
     T integer_part = 0;
     bool hasDigits = false;
@@ -525,6 +822,35 @@ constexpr string_conversion_result_t<T> _stox(const char* ptr, const char* end,
     U value = 0;
     const U max_before_mul = static_cast<U>(std::numeric_limits<U>::max() / static_cast<unsigned>(radix));
 
+    if (b != Base::Decimal) {
+        // Each digit of a power of two base is a fixed number of bits, so digits can be shifted into place
+        const unsigned shift = static_cast<unsigned>(std::countr_zero(static_cast<unsigned>(radix)));
+        constexpr unsigned bits = static_cast<unsigned>(std::numeric_limits<U>::digits);
+        for (; ptr != end; ++ptr) {
+            const int d = _chtoi(*ptr);
+            if (d < 0 || d >= radix) {
+                result.exists = false;
+                return result;
+            }
+            if ((value >> (bits - shift)) != 0) { result.overflowed = true; }
+            value = static_cast<U>((value << shift) | static_cast<U>(d));
+        }
+    } else if constexpr (sizeof(U) >= sizeof(uint32_t)) {
+        // Take decimal digits 8 at a time while they last (10^8 fits in 32 bits), and finish digit by digit below
+        const U chunk_scale = static_cast<U>(100'000'000u);
+        const U max_before_chunk = static_cast<U>(std::numeric_limits<U>::max() / chunk_scale);
+        while (end - ptr >= 8) {
+            const uint64_t chunk = _load_eight_chars(ptr);
+            if (!_is_eight_digits(chunk)) { break; }
+            const U digits = static_cast<U>(_parse_eight_digits(chunk));
+            if (value > max_before_chunk) { result.overflowed = true; }
+            value *= chunk_scale;
+            if (value > std::numeric_limits<U>::max() - digits) { result.overflowed = true; }
+            value += digits;
+            ptr += 8;
+        }
+    }
+
     for (; ptr != end; ++ptr) {
         int d = _chtoi(*ptr);
         if (d < 0 || d >= radix) {
@@ -539,7 +865,7 @@ constexpr string_conversion_result_t<T> _stox(const char* ptr, const char* end,
         value += static_cast<U>(d);
     }
 
-    if constexpr (std::is_signed_v<T>) {
+    if constexpr (SignedIntegral<T>) {  // Unlike std::is_signed_v, this covers the emulated int128_t
         if (is_negative) {
             if (value <= static_cast<U>(std::numeric_limits<T>::max()) + 1) {
                 result.value = static_cast<T>(-value);
@@ -691,7 +1017,6 @@ constexpr string_conversion_result_t<number_t> str_to_num(std::string_view str,
 }
 
 }  // namespace mnstl
-#undef MNSTL_NUMBER_BINARY_OP
 #undef MNSTL_NUMBER_INTEGRAL_BINARY_OP
 #undef MNSTL_NUMBER_COMPARISON_OP
 #endif  // MNSTL_NUMBER
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef MNSTL_RING_BUFFER
+#define MNSTL_RING_BUFFER 1
+
+#include <array>
+#include <core.hpp>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace mnstl {
+
+/**
+ * @brief A fixed-capacity FIFO queue stored inline, which never allocates
+ * @details The capacity must be a power of two so that indices wrap with a mask. Elements are default-constructed
+ * up front and overwritten in place, so `T` should be cheap to default-construct and assign.
+ * @note Pushing onto a full buffer, or reading from an empty one, is a logic error (checked in debug builds)
+ */
+template <class T, size_t Capacity>
+class ring_buffer {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "ring_buffer capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<T>);
+
+   private:
+    constexpr static inline size_t _mask = Capacity - 1;
+
+    std::array<T, Capacity> _data{};
+    size_t _head = 0;  // index of the front element (grows without bound; masked on access)
+    size_t _size = 0;
+
+   public:
+    constexpr ring_buffer() noexcept(std::is_nothrow_default_constructible_v<T>) = default;
+
+    constexpr static size_t capacity() noexcept { return Capacity; }
+    constexpr size_t size() const noexcept { return _size; }
+    constexpr bool empty() const noexcept { return _size == 0; }
+    constexpr bool full() const noexcept { return _size == Capacity; }
+
+    template <class... Args>
+    constexpr T& emplace_back(Args&&... args) {
+#if MN_DEBUG
+        if (full()) { ASSERT_UNREACHABLE("ring_buffer::emplace_back called on a full buffer"); }
+#endif  // MN_DEBUG
+        T& slot = _data[(_head + _size++) & _mask];
+        slot = T(std::forward<Args>(args)...);
+        return slot;
+    }
+
+    constexpr void pop_front() NOEXCEPT_IF_RELEASE {
+#if MN_DEBUG
+        if (empty()) { ASSERT_UNREACHABLE("ring_buffer::pop_front called on an empty buffer"); }
+#endif  // MN_DEBUG
+        ++_head;
+        --_size;
+    }
+
+    constexpr void clear() noexcept { _head = _size = 0; }
+
+    constexpr T& front() noexcept { return _data[_head & _mask]; }
+    constexpr const T& front() const noexcept { return _data[_head & _mask]; }
+    constexpr T& back() noexcept { return _data[(_head + _size - 1) & _mask]; }
+    constexpr const T& back() const noexcept { return _data[(_head + _size - 1) & _mask]; }
+
+    // Index relative to the front of the queue
+    constexpr T& operator[](size_t index) noexcept { return _data[(_head + index) & _mask]; }
+    constexpr const T& operator[](size_t index) const noexcept { return _data[(_head + index) & _mask]; }
+};
+
+}  // namespace mnstl
+
+#endif  // MNSTL_RING_BUFFER
@@ -0,0 +1,108 @@
+#ifndef MNSTL_STRING_POOL
+#define MNSTL_STRING_POOL 1
+
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mnstl/chunk_allocator.hxx>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mnstl {
+
+/**
+ * @brief Interns strings, handing out a stable 32-bit atom for each distinct string
+ * @details Each string is stored once (null-terminated) and never moves, so views handed out by the pool stay valid for
+ * as long as the pool does. Every stored string is prefixed by its atom, which lets atom_of() recover the atom of an
+ * interned view without hashing it again. Atom 0 is always the empty string.
+ * Safe to use from several threads at once (e.g. lexing many files in parallel): lookups, which almost every intern()
+ * is, share a lock, and only storing a new string takes it exclusively.
+ */
+class string_pool {
+   public:
+    using atom_t = uint32_t;
+    constexpr static inline atom_t empty_atom = 0;
+    constexpr static inline atom_t invalid_atom = std::numeric_limits<atom_t>::max();
+
+   private:
+    mutable std::shared_mutex _mutex;
+    chunk_allocator _storage;
+    std::vector<std::string_view> _strings;  // indexed by atom
+    std::unordered_map<std::string_view, atom_t> _atoms;
+
+   public:
+    string_pool() { DISCARD(intern("")); }
+    ~string_pool() noexcept = default;
+
+    // Views into the pool must stay valid, so it can't be copied or moved
+    string_pool(const string_pool&) = delete;
+    string_pool(string_pool&&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+    string_pool& operator=(string_pool&&) = delete;
+
+    /**
+     * @brief Get the atom for `str`, storing a copy of it if it hasn't been seen before
+     */
+    atom_t intern(std::string_view str) {
+        {
+            std::shared_lock lock(_mutex);
+            if (auto it = _atoms.find(str); it != _atoms.end()) { return it->second; }
+        }
+        std::unique_lock lock(_mutex);
+        // Another thread may have stored it in between the two locks
+        if (auto it = _atoms.find(str); it != _atoms.end()) { return it->second; }
+
+        const atom_t atom = static_cast<atom_t>(_strings.size());
+        char* mem = static_cast<char*>(_storage.allocate(sizeof(atom_t) + str.size() + 1, alignof(atom_t)));
+        std::memcpy(mem, &atom, sizeof(atom_t));
+        char* chars = mem + sizeof(atom_t);
+        if (!str.empty()) { std::memcpy(chars, str.data(), str.size()); }
+        chars[str.size()] = '\0';
+
+        const std::string_view stored(chars, str.size());
+        _strings.push_back(stored);
+        _atoms.emplace(stored, atom);
+        return atom;
+    }
+
+    /**
+     * @brief The atom for `str` if it has been interned, or invalid_atom if not (the pool is left unchanged)
+     */
+    atom_t find(std::string_view str) const noexcept {
+        std::shared_lock lock(_mutex);
+        auto it = _atoms.find(str);
+        return it == _atoms.end() ? invalid_atom : it->second;
+    }
+
+    /**
+     * @brief The (null-terminated) string an atom refers to
+     */
+    std::string_view view(atom_t atom) const noexcept {
+        std::shared_lock lock(_mutex);  // _strings can reallocate while another thread interns
+        return _strings[atom];
+    }
+
+    /**
+     * @brief Recover the atom of a view returned by view()
+     * @note Only valid for views handed out by a string_pool
+     */
+    static atom_t atom_of(std::string_view interned) noexcept {
+        atom_t atom;
+        std::memcpy(&atom, interned.data() - sizeof(atom_t), sizeof(atom_t));
+        return atom;
+    }
+
+    size_t size() const noexcept {
+        std::shared_lock lock(_mutex);
+        return _strings.size();
+    }
+};
+
+}  // namespace mnstl
+
+#endif  // MNSTL_STRING_POOL
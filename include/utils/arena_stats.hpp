@@ -0,0 +1,29 @@
+#ifndef MANGANESE_INCLUDE_UTILS_ARENA_STATS_HPP
+#define MANGANESE_INCLUDE_UTILS_ARENA_STATS_HPP
+
+#include <core.hpp>
+#include <io/logging.hpp>
+#include <iostream>
+#include <mnstl/chunk_allocator.hxx>
+#include <string_view>
+
+// ARENA_STATS is defined in CMakeLists.txt
+
+namespace Manganese {
+
+/**
+ * @brief Report how much of `arena` is in use at the end of compiler phase `phase` (only with ARENA_STATS)
+ * The counters are always kept, so this also works in release builds, which is where chunk sizes should be tuned.
+ */
+inline void logArenaStats(std::string_view phase, const mnstl::chunk_allocator& arena) {
+#if ARENA_STATS
+    std::cerr << PINK << "[Arena stats] After " << phase << ": " << arena.stats().to_string() << RESET << '\n';
+#else  // ^^ ARENA_STATS vv !ARENA_STATS
+    DISCARD(phase);
+    DISCARD(arena);
+#endif  // ARENA_STATS
+}
+
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_UTILS_ARENA_STATS_HPP
@@ -0,0 +1,56 @@
+#ifndef MANGANESE_INCLUDE_UTILS_MEMORY_PHASE_HPP
+#define MANGANESE_INCLUDE_UTILS_MEMORY_PHASE_HPP
+
+#include <array>
+#include <core.hpp>
+#include <cstddef>
+#include <utility>
+
+// MEMORY_TRACKING is defined in CMakeLists.txt
+
+namespace Manganese {
+namespace memory {
+
+/**
+ * @brief The compiler phases that memory tracking attributes allocations to
+ */
+enum class Phase : uint8_t {
+    Other,
+    Lex,
+    Parse,
+    Analyze,
+    Codegen
+};
+constexpr inline size_t PHASE_COUNT = 5;
+constexpr inline std::array<const char*, PHASE_COUNT> PHASE_NAMES = {"other", "lex", "parse", "analyze", "codegen"};
+
+#if MEMORY_TRACKING && MN_DEBUG
+// The phase allocations on this thread are attributed to (read by the operator new overrides in memory_tracking.hpp)
+inline thread_local Phase currentPhase = Phase::Other;
+#endif  // MEMORY_TRACKING && MN_DEBUG
+
+/**
+ * @brief Attributes allocations made on the calling thread to `phase` while alive
+ * Compiles to nothing unless memory tracking is enabled, so it can be used on hot paths.
+ */
+class PhaseScope {
+#if MEMORY_TRACKING && MN_DEBUG
+   private:
+    Phase previous;
+
+   public:
+    explicit PhaseScope(Phase phase) noexcept : previous(std::exchange(currentPhase, phase)) {}
+    ~PhaseScope() noexcept { currentPhase = previous; }
+#else  // ^^ MEMORY_TRACKING && MN_DEBUG vv !(MEMORY_TRACKING && MN_DEBUG)
+   public:
+    constexpr explicit PhaseScope(Phase) noexcept {}
+#endif  // MEMORY_TRACKING && MN_DEBUG
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+};
+
+}  // namespace memory
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_UTILS_MEMORY_PHASE_HPP
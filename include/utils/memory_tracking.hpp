@@ -3,113 +3,196 @@
 
 #include <core.hpp>
 #include <io/logging.hpp>
+#include <utils/memory_phase.hpp>
 
 // MEMORY_TRACKING is defined in CMakeLists.txt
+// This header replaces the global operator new and delete, so it must only be included in one translation unit
 
 #if MEMORY_TRACKING && MN_DEBUG
+#include <stdio.h>
 #include <stdlib.h>
 
-#include <fstream>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <mutex>
+#include <new>
 
-size_t lifetimeBytesAllocated = 0;  // How much memory has been allocated in total (ignores deallocations)
-#ifdef CONTINUOUS_MEMORY_TRACKING
-size_t bytesCurrentlyAllocated = 0;  // How much memory is currently allocated (accounts for deallocations)
-std::ofstream memoryLogFile("logs/memory_tracking.log", std::ios::out | std::ios::trunc);
-#endif  // CONTINUOUS_MEMORY_TRACKING
+namespace Manganese {
+namespace memory {
+namespace detail {
 
-void* operator new(size_t size) {
-    void* ptr = malloc(size);
-    if (ptr == nullptr) { throw std::bad_alloc(); }
-    lifetimeBytesAllocated += size;
-#ifdef CONTINUOUS_MEMORY_TRACKING
-    bytesCurrentlyAllocated += size;
-    if (memoryLogFile.is_open()) {
-        memoryLogFile << "Allocated " << size << " bytes at " << ptr
-                      << " (estimation of total memory currently allocated: " << bytesCurrentlyAllocated << " bytes)"
-                      << '\n';
-    }
-#endif  // CONTINUOUS_MEMORY_TRACKING
-    return ptr;
-}
+/**
+ * @brief A counter that only its owning thread writes to, but any thread can read
+ * Being atomic makes reading it from another thread well-defined, but since there is only ever one writer, updating it
+ * is a plain load and store rather than a locked read-modify-write.
+ */
+struct Counter {
+    std::atomic<size_t> value{0};
 
-void* operator new[](size_t size) {
-    void* ptr = malloc(size);
-    if (ptr == nullptr) { throw std::bad_alloc(); }
-    lifetimeBytesAllocated += size;
-#ifdef CONTINUOUS_MEMORY_TRACKING
-    bytesCurrentlyAllocated += size;
-    if (memoryLogFile.is_open()) {
-        memoryLogFile << "Allocated " << size << " bytes at " << ptr
-                      << " (estimation of total memory currently allocated: " << bytesCurrentlyAllocated << " bytes)"
-                      << '\n';
+    void add(size_t n) noexcept { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void raiseTo(size_t n) noexcept {
+        if (n > value.load(std::memory_order_relaxed)) { value.store(n, std::memory_order_relaxed); }
     }
+    size_t get() const noexcept { return value.load(std::memory_order_relaxed); }
+};
+
+struct PhaseCounters {
+    Counter bytes, allocations, peak;
+};
+
+#if CONTINUOUS_MEMORY_TRACKING
+// One allocation or deallocation, as written to logs/memory_tracking.bin
+struct LogRecord {
+    uint64_t size;
+    uint32_t thread;
+    uint8_t phase;
+    uint8_t isAllocation;
+    uint16_t reserved = 0;
+};
+constexpr size_t LOG_BUFFER_RECORDS = 4096;
 #endif  // CONTINUOUS_MEMORY_TRACKING
-    return ptr;
-}
 
-void operator delete(void* ptr, size_t size) noexcept {
-    if (ptr != nullptr) {
-#ifdef CONTINUOUS_MEMORY_TRACKING
-        bytesCurrentlyAllocated -= size;
-        if (memoryLogFile.is_open()) {
-            memoryLogFile << "Deallocated " << size << " bytes at " << ptr
-                          << " (estimation of total memory currently allocated: " << bytesCurrentlyAllocated
-                          << " bytes)" << '\n';
-        }
+struct ThreadCounters {
+    Counter bytesAllocated, bytesFreed, allocations, peak;
+    size_t current = 0;  // Bytes allocated minus bytes freed on this thread (only touched by the owning thread)
+    std::array<PhaseCounters, PHASE_COUNT> phases;
+    ThreadCounters* next = nullptr;
+    uint32_t id = 0;
+#if CONTINUOUS_MEMORY_TRACKING
+    size_t logged = 0;
+    LogRecord log[LOG_BUFFER_RECORDS];
 #endif  // CONTINUOUS_MEMORY_TRACKING
-        free(ptr);
-        DISCARD(size);  // Avoid unused parameter warning
+};
+
+// Every thread's counters, newest first. They are never freed, so totals survive the threads that made them
+inline std::atomic<ThreadCounters*> allThreads = nullptr;
+inline std::atomic<uint32_t> threadCount = 0;
+inline thread_local ThreadCounters* localCounters = nullptr;
+
+// Allocations are prefixed with their size, so that every deallocation can be attributed too
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+inline ThreadCounters& counters() noexcept {
+    if (!localCounters) [[unlikely]] {
+        // Allocated with malloc, since calling operator new here would recurse
+        void* memory = malloc(sizeof(ThreadCounters));
+        if (!memory) { abort(); }
+        ThreadCounters* created = new (memory) ThreadCounters();
+        created->id = threadCount.fetch_add(1, std::memory_order_relaxed);
+        created->next = allThreads.load(std::memory_order_relaxed);
+        while (!allThreads.compare_exchange_weak(created->next, created, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {}
+        localCounters = created;
     }
+    return *localCounters;
 }
 
-void operator delete[](void* ptr, size_t size) noexcept {
-    if (ptr != nullptr) {
-#ifdef CONTINUOUS_MEMORY_TRACKING
-        bytesCurrentlyAllocated -= size;
-        if (memoryLogFile.is_open()) {
-            memoryLogFile << "Deallocated " << size << " bytes at " << ptr
-                          << " (estimation of total memory currently allocated: " << bytesCurrentlyAllocated
-                          << " bytes)" << '\n';
-        }
-#endif  // CONTINUOUS_MEMORY_TRACKING
-        free(ptr);
-        DISCARD(size);  // Avoid unused parameter warning
-    }
+#if CONTINUOUS_MEMORY_TRACKING
+inline std::mutex logMutex;
+inline FILE* logFile = nullptr;
+
+inline void flushLog(ThreadCounters& c) noexcept {
+    std::lock_guard lock(logMutex);
+    if (!logFile) { logFile = fopen("logs/memory_tracking.bin", "wb"); }
+    if (logFile) { fwrite(c.log, sizeof(LogRecord), c.logged, logFile); }
+    c.logged = 0;
 }
 
-void operator delete(void* ptr) noexcept {
-    if (ptr != nullptr) {
-#ifdef CONTINUOUS_MEMORY_TRACKING
-        if (memoryLogFile.is_open()) {
-            memoryLogFile << "Deallocated (unknown size) at " << ptr
-                          << " (cannot calculate number of bytes deallocated on a call to delete(void*))" << '\n';
-        }
+inline void logEvent(ThreadCounters& c, size_t size, Phase phase, bool isAllocation) noexcept {
+    // Buffered in binary and written out in bulk, so that tracking doesn't dominate the timings
+    c.log[c.logged++] = LogRecord{.size = size,
+                                  .thread = c.id,
+                                  .phase = static_cast<uint8_t>(phase),
+                                  .isAllocation = static_cast<uint8_t>(isAllocation)};
+    if (c.logged == LOG_BUFFER_RECORDS) { flushLog(c); }
+}
 #endif  // CONTINUOUS_MEMORY_TRACKING
-        free(ptr);
-    }
+
+inline void* trackedAllocate(size_t size) {
+    auto* base = static_cast<std::byte*>(malloc(size + HEADER_SIZE));
+    if (base == nullptr) { throw std::bad_alloc(); }
+    *reinterpret_cast<size_t*>(base) = size;
+
+    ThreadCounters& c = counters();
+    const Phase phase = currentPhase;
+    PhaseCounters& p = c.phases[static_cast<size_t>(phase)];
+    c.bytesAllocated.add(size);
+    c.allocations.add(1);
+    c.current += size;
+    c.peak.raiseTo(c.current);
+    p.bytes.add(size);
+    p.allocations.add(1);
+    p.peak.raiseTo(c.current);
+#if CONTINUOUS_MEMORY_TRACKING
+    logEvent(c, size, phase, true);
+#endif  // CONTINUOUS_MEMORY_TRACKING
+    return base + HEADER_SIZE;
 }
 
-void operator delete[](void* ptr) noexcept {
-    if (ptr != nullptr) {
-#ifdef CONTINUOUS_MEMORY_TRACKING
-        if (memoryLogFile.is_open()) {
-            memoryLogFile << "Deallocated (unknown size) at " << ptr
-                          << " (cannot calculate number of bytes deallocated on a call to delete(void*))" << '\n';
-        }
+inline void trackedFree(void* ptr) noexcept {
+    if (ptr == nullptr) { return; }
+    std::byte* base = static_cast<std::byte*>(ptr) - HEADER_SIZE;
+    const size_t size = *reinterpret_cast<size_t*>(base);
+
+    ThreadCounters& c = counters();
+    c.bytesFreed.add(size);
+    // Memory can be freed on a different thread to the one that allocated it
+    c.current = c.current > size ? c.current - size : 0;
+#if CONTINUOUS_MEMORY_TRACKING
+    logEvent(c, size, currentPhase, false);
 #endif  // CONTINUOUS_MEMORY_TRACKING
-        free(ptr);
-    }
+    free(base);
 }
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace Manganese
+
+void* operator new(size_t size) { return Manganese::memory::detail::trackedAllocate(size); }
+void* operator new[](size_t size) { return Manganese::memory::detail::trackedAllocate(size); }
+void operator delete(void* ptr) noexcept { Manganese::memory::detail::trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { Manganese::memory::detail::trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Manganese::memory::detail::trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Manganese::memory::detail::trackedFree(ptr); }
 #endif  // MEMORY_TRACKING && MN_DEBUG
+
+/**
+ * @brief Print the totals (and a per-phase breakdown) of every thread's allocations
+ * Per-thread counters are only summed here, so allocation itself never contends on shared state. Peaks are per-thread
+ * high-water marks added together, so they are exact for single-threaded runs and an upper bound otherwise.
+ */
 inline void logTotalAllocatedMemory() {
 #if MEMORY_TRACKING && MN_DEBUG
-    std::cout << PINK << "Total memory allocated (over the course of the program): " << lifetimeBytesAllocated
-              << " bytes" << RESET << '\n';
-#ifdef CONTINUOUS_MEMORY_TRACKING
-    memoryLogFile.close();
+    using namespace Manganese::memory;
+    size_t allocated = 0, freed = 0, allocations = 0, peak = 0;
+    std::array<size_t, PHASE_COUNT> phaseBytes{}, phaseAllocations{}, phasePeaks{};
+    for (detail::ThreadCounters* c = detail::allThreads.load(std::memory_order_acquire); c; c = c->next) {
+        allocated += c->bytesAllocated.get();
+        freed += c->bytesFreed.get();
+        allocations += c->allocations.get();
+        peak += c->peak.get();
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            phaseBytes[i] += c->phases[i].bytes.get();
+            phaseAllocations[i] += c->phases[i].allocations.get();
+            phasePeaks[i] += c->phases[i].peak.get();
+        }
+#if CONTINUOUS_MEMORY_TRACKING
+        detail::flushLog(*c);  // Called once other threads are done, so their buffers are safe to drain
+#endif  // CONTINUOUS_MEMORY_TRACKING
+    }
+    std::cout << PINK << "Total memory allocated (over the course of the program): " << allocated << " bytes in "
+              << allocations << " allocations (" << freed << " bytes freed, peak " << peak << " bytes)" << '\n';
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        std::cout << "  " << PHASE_NAMES[i] << ": " << phaseBytes[i] << " bytes in " << phaseAllocations[i]
+                  << " allocations (peak " << phasePeaks[i] << " bytes)" << '\n';
+    }
+    std::cout << RESET;
+#if CONTINUOUS_MEMORY_TRACKING
+    if (detail::logFile) { fclose(detail::logFile); }
+    detail::logFile = nullptr;
 #endif  // CONTINUOUS_MEMORY_TRACKING
 #endif  // MEMORY_TRACKING && MN_DEBUG
 }
 
-#endif  // MANGANESE_INCLUDE_UTILS_MEMORY_TRACKING_HPP
\ No newline at end of file
+#endif  // MANGANESE_INCLUDE_UTILS_MEMORY_TRACKING_HPP
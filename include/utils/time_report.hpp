@@ -0,0 +1,162 @@
+#ifndef MANGANESE_INCLUDE_UTILS_TIME_REPORT_HPP
+#define MANGANESE_INCLUDE_UTILS_TIME_REPORT_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mnstl/chunk_allocator.hxx>
+#include <utility>
+
+// TIME_REPORT is defined in CMakeLists.txt
+
+namespace Manganese {
+namespace timing {
+
+/**
+ * @brief The compiler phases --time-report times
+ */
+enum class Phase : uint8_t {
+    Lex,
+    Parse,
+    CollectTypes,
+    CheckStatements,
+};
+constexpr inline size_t PHASE_COUNT = 4;
+constexpr inline std::array<const char*, PHASE_COUNT> PHASE_NAMES
+    = {"lex", "parse", "collect types", "check statements"};
+
+enum class Counter : uint8_t {
+    Tokens,
+    Nodes,
+    Scopes,
+    TypesInterned,  // Created, i.e. misses in the type context's cache
+    TypeCacheHits,
+    Specializations,  // Generic instances specialized, i.e. misses in their specialization cache
+};
+constexpr inline size_t COUNTER_COUNT = 6;
+constexpr inline std::array<const char*, COUNTER_COUNT> COUNTER_NAMES
+    = {"tokens", "AST nodes", "scopes entered", "types interned", "type cache hits", "generics specialized"};
+
+#if TIME_REPORT
+class PhaseTimer;
+
+namespace detail {
+
+// Set once, before compiling anything (by --time-report), so a relaxed load is enough to see it
+inline std::atomic<bool> enabled = false;
+
+struct PhaseTotals {
+    std::atomic<uint64_t> nanoseconds = 0;  // Excluding the phases nested in it (e.g. the lexing done while parsing)
+    std::atomic<uint64_t> calls = 0;
+    std::atomic<uint64_t> arenaBytes = 0;  // Allocated from the phase's arena (including by nested phases)
+};
+inline std::array<PhaseTotals, PHASE_COUNT> phases;
+inline std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters;
+
+// Counted on each thread without synchronizing, and added to the totals when the phase they were counted in ends
+inline thread_local std::array<uint64_t, COUNTER_COUNT> pendingCounts{};
+// The time this thread has spent in each phase (which a trace::Scope reads to tell how much of it was lexing)
+inline thread_local std::array<uint64_t, PHASE_COUNT> threadNanoseconds{};
+inline thread_local PhaseTimer* activeTimer = nullptr;
+
+inline void flushCounts() noexcept {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        if (pendingCounts[i]) { counters[i].fetch_add(std::exchange(pendingCounts[i], 0), std::memory_order_relaxed); }
+    }
+}
+
+}  // namespace detail
+
+inline bool isEnabled() noexcept { return detail::enabled.load(std::memory_order_relaxed); }
+
+// How long the calling thread has spent in `phase` so far (not counting the phases nested in it)
+inline uint64_t threadNanoseconds(Phase phase) noexcept {
+    return detail::threadNanoseconds[static_cast<size_t>(phase)];
+}
+
+/**
+ * @brief Add `amount` to `counter` (if --time-report was given)
+ */
+inline void count(Counter counter, uint64_t amount = 1) noexcept {
+    if (isEnabled()) { detail::pendingCounts[static_cast<size_t>(counter)] += amount; }
+}
+
+/**
+ * @brief Times `phase` while alive (if --time-report was given), along with what it allocates from `arena`
+ * Time spent in a phase nested in this one (on the same thread) is counted towards that phase only, so the phases'
+ * times add up to the time spent in all of them.
+ */
+class PhaseTimer {
+   private:
+    Phase phase;
+    bool timing;
+    const mnstl::chunk_allocator* arena;
+    size_t arenaBytes = 0;
+    PhaseTimer* parent = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration nested{};
+
+   public:
+    explicit PhaseTimer(Phase phase_, const mnstl::chunk_allocator* arena_ = nullptr) noexcept :
+        phase(phase_), timing(isEnabled()), arena(arena_) {
+        if (!timing) { return; }
+        if (arena) { arenaBytes = arena->stats().bytes_in_use; }
+        parent = std::exchange(detail::activeTimer, this);
+        start = std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer() noexcept {
+        if (!timing) { return; }
+        const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        detail::PhaseTotals& totals = detail::phases[static_cast<size_t>(phase)];
+        const auto self
+            = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed - nested).count());
+        totals.nanoseconds.fetch_add(self, std::memory_order_relaxed);
+        detail::threadNanoseconds[static_cast<size_t>(phase)] += self;
+        totals.calls.fetch_add(1, std::memory_order_relaxed);
+        if (arena) {
+            // An arena rewound during the phase (e.g. by a failed speculative parse) can end up smaller
+            const size_t used = arena->stats().bytes_in_use;
+            totals.arenaBytes.fetch_add(used > arenaBytes ? used - arenaBytes : 0, std::memory_order_relaxed);
+        }
+        if (parent) { parent->nested += elapsed; }
+        detail::activeTimer = parent;
+        detail::flushCounts();
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+#else  // ^^ TIME_REPORT vv !TIME_REPORT
+constexpr bool isEnabled() noexcept { return false; }
+constexpr uint64_t threadNanoseconds(Phase) noexcept { return 0; }
+constexpr void count(Counter, uint64_t = 1) noexcept {}
+
+class PhaseTimer {
+   public:
+    constexpr explicit PhaseTimer(Phase, const mnstl::chunk_allocator* = nullptr) noexcept {}
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+#endif  // TIME_REPORT
+
+/**
+ * @brief Start timing phases and counting (for --time-report, or to break a trace's phases down)
+ * @return Whether this build can, i.e. it was built with TIME_REPORT
+ */
+bool enable() noexcept;
+
+/**
+ * @brief Print a table of how long each phase took (summed over every thread), what it allocated, and the counters
+ * @param total The wall time of the whole compilation, which the phases' times are given as a share of
+ */
+void printReport(std::ostream& output, std::chrono::steady_clock::duration total);
+
+}  // namespace timing
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_UTILS_TIME_REPORT_HPP
@@ -0,0 +1,92 @@
+#ifndef MANGANESE_INCLUDE_UTILS_TRACE_HPP
+#define MANGANESE_INCLUDE_UTILS_TRACE_HPP
+
+#include <atomic>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/result.hpp>
+#include <utils/time_report.hpp>
+
+namespace Manganese {
+namespace trace {
+
+// Events each thread keeps. Past this, a thread's oldest events are overwritten, so a long build keeps its end
+constexpr inline size_t MAX_EVENTS_PER_THREAD = size_t{1} << 16;
+
+namespace detail {
+
+// Set once, before compiling anything (by --trace), so a relaxed load is enough to see it
+inline std::atomic<bool> enabled = false;
+
+struct Event {
+    const char* name = nullptr;
+    std::string detail;  // e.g. the file being compiled
+    const char* argumentName = nullptr;  // An optional count, e.g. of the functions a codegen partition has
+    uint64_t argument = 0;
+    int64_t start = 0;  // In nanoseconds since tracing was enabled
+    int64_t duration = 0;
+    uint64_t lexNanoseconds = 0;  // Spent lexing during the event (see timing::threadNanoseconds())
+};
+
+int64_t now() noexcept;
+void record(Event&& event);
+
+}  // namespace detail
+
+inline bool isEnabled() noexcept { return detail::enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Records the time it is alive as a trace event (if --trace was given), on the thread that created it
+ * Events on a thread nest as their scopes do. Each notes how much of its time went on lexing, since the parser lexes
+ * on demand in small batches, which would be far too many events of their own.
+ */
+class Scope {
+   private:
+    detail::Event event;
+    bool tracing;
+
+   public:
+    explicit Scope(const char* name, std::string_view detail = {}) : tracing(isEnabled()) {
+        if (!tracing) { return; }
+        event.name = name;
+        event.detail = detail;
+        event.lexNanoseconds = timing::threadNanoseconds(timing::Phase::Lex);
+        event.start = detail::now();
+    }
+    ~Scope() {
+        if (!tracing) { return; }
+        event.duration = detail::now() - event.start;
+        event.lexNanoseconds = timing::threadNanoseconds(timing::Phase::Lex) - event.lexNanoseconds;
+        detail::record(std::move(event));
+    }
+
+    // Attach a count to the event (only the last one set is kept)
+    void setArgument(const char* name, uint64_t value) noexcept {
+        event.argumentName = name;
+        event.argument = value;
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+/**
+ * @brief Start tracing, timing from now on. The thread this is called on is named the main thread
+ */
+void enable();
+
+/**
+ * @brief Write every thread's events to `path`, as JSON in the Chrome trace event format (which chrome://tracing and
+ * Perfetto load)
+ * @note Every thread that recorded events must be done by now (e.g. every worker joined)
+ */
+Result write(const std::string& path);
+
+}  // namespace trace
+}  // namespace Manganese
+
+#endif  // MANGANESE_INCLUDE_UTILS_TRACE_HPP
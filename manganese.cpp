@@ -1,9 +1,52 @@
-#include <stdio.h>
-
-// This is a placeholder
+#include <chrono>
+#include <core.hpp>
+#include <driver/driver.hpp>
+#include <driver/options.hpp>
+#include <driver/server.hpp>
+#include <io/diagnostics.hpp>
+#include <io/logging.hpp>
+#include <iostream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <utility>
+#include <utils/memory_tracking.hpp>
+#include <utils/time_report.hpp>
+#include <utils/trace.hpp>
 
 int main(int argc, const char* argv[]) {
-    printf("Hello from Manganese!\n");
-    for (int i = 1; i < argc; ++i) {printf("Arg %d : %s\n", i, argv[i]); }
-    return 0;
+    using namespace Manganese;
+    std::optional<driver::Options> options
+        = driver::parseArguments(std::span<const char* const>(argv + 1, static_cast<size_t>(argc - 1)));
+    if (!options) {
+        std::cerr << driver::usage(argv[0]);
+        return 2;
+    }
+    if (options->server && !options->showHelp) {
+        driver::Server server;
+        if (!options->serverSocket.empty()) { return server.listen(options->serverSocket); }
+        DISCARD(server.serve(std::cin, std::cout));
+        return 0;
+    }
+    if (options->showHelp || options->inputs.empty()) {
+        (options->showHelp ? std::cout : std::cerr) << driver::usage(argv[0]);
+        return options->showHelp ? 0 : 2;
+    }
+
+    const bool timeReport = options->timeReport;
+    const std::string tracePath = options->trace;
+    if (timeReport) { DISCARD(timing::enable()); }  // A build that can't still says so in the report
+    if (!tracePath.empty()) { trace::enable(); }
+    const auto start = std::chrono::steady_clock::now();
+    // JSON diagnostics are for tools to read, so they go to standard output, apart from anything else printed
+    std::ostream& output = options->diagnosticFormat == logging::DiagnosticFormat::Json ? std::cout : std::cerr;
+    int exitCode = driver::Driver(std::move(*options)).run(output);
+    if (timeReport) { timing::printReport(std::cerr, std::chrono::steady_clock::now() - start); }
+    if (!tracePath.empty() && trace::write(tracePath) == Result::Failure) {
+        std::cerr << RED << "Error: Could not write the trace to '" << tracePath << "'" << RESET << '\n';
+        exitCode = 1;
+    }
+    logTotalAllocatedMemory();  // Only does something if memory tracking is enabled
+    return exitCode;
 }
@@ -0,0 +1,159 @@
+#include <charconv>
+#include <core.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <io/logging.hpp>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "benchmarks/benchmarks.hpp"
+#include "benchmarks/benchrunner.hpp"
+#include "benchmarks/program_generator.hpp"
+
+namespace {
+
+std::optional<size_t> parseCount(std::string_view text) {
+    size_t count = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    if (text.empty() || error != std::errc{} || end != text.data() + text.size()) { return std::nullopt; }
+    return count;
+}
+
+// A count of bytes, optionally in KiB, MiB or GiB (e.g. 64K)
+std::optional<size_t> parseSize(std::string_view text) {
+    size_t shift = 0;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 'K': shift = 10; break;
+            case 'M': shift = 20; break;
+            case 'G': shift = 30; break;
+            default: break;
+        }
+    }
+    std::optional<size_t> count = parseCount(shift ? text.substr(0, text.size() - 1) : text);
+    if (!count || *count > (SIZE_MAX >> shift)) { return std::nullopt; }
+    return *count << shift;
+}
+
+// Comma-separated sizes (e.g. 1K,1M,100M)
+std::optional<std::vector<size_t>> parseSizes(std::string_view text) {
+    std::vector<size_t> sizes;
+    while (true) {
+        const size_t comma = text.find(',');
+        std::optional<size_t> size = parseSize(text.substr(0, comma));
+        if (!size || *size == 0) { return std::nullopt; }
+        sizes.push_back(*size);
+        if (comma == std::string_view::npos) { return sizes; }
+        text.remove_prefix(comma + 1);
+    }
+}
+
+// Write the files of a generated program to `directory`
+bool writeProgram(const std::filesystem::path& directory,
+                  const std::vector<Manganese::benchmarks::GeneratedFile>& files) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    for (const Manganese::benchmarks::GeneratedFile& file : files) {
+        std::ofstream stream(directory / file.name);
+        stream << file.source;
+        if (!stream) { return false; }
+    }
+    return !error;
+}
+
+void usage(const char* programName) {
+    std::cerr << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  --repetitions <n>   Timed runs of each benchmark (default: 25)\n"
+              << "  --warmup <n>        Untimed runs before them (default: 3)\n"
+              << "  --filter <text>     Only run the benchmarks whose name contains <text>\n"
+              << "  --json <file>       Also write the results to <file> as JSON ('-' for standard output)\n"
+              << "  --scaling <sizes>   Instead, time each phase on generated programs of each shape and of each\n"
+              << "                      size (comma-separated, e.g. 1K,1M,100M)\n"
+              << "  --depth <n>         How deeply generated programs nest (or how long their expressions are)\n"
+              << "                      (default: 64)\n"
+              << "  --generate <dir>    Instead, write a generated program to <dir>, of the shape and size given by\n"
+              << "  --shape <shape>     functions, nesting, expressions, literals or modules (default: functions)\n"
+              << "  --size <size>       e.g. 64K (default: 1M)\n";
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    using namespace Manganese;
+    benchmarks::BenchOptions options;
+    benchmarks::GeneratorOptions generator;
+    std::string json;
+    std::string generate;
+    std::vector<size_t> scaling;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if (argument == "-h" || argument == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 == argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const std::string_view value = argv[++i];
+        if (argument == "--filter") {
+            options.filter = value;
+        } else if (argument == "--json") {
+            json = value;
+        } else if (argument == "--generate") {
+            generate = value;
+        } else if (std::optional<benchmarks::Shape> shape = benchmarks::parseShape(value);
+                   shape && argument == "--shape") {
+            generator.shape = *shape;
+        } else if (std::optional<size_t> size = parseSize(value); size && argument == "--size") {
+            generator.bytes = *size;
+        } else if (std::optional<std::vector<size_t>> sizes = parseSizes(value); sizes && argument == "--scaling") {
+            scaling = std::move(*sizes);
+        } else if (std::optional<size_t> count = parseCount(value);
+                   count && (argument == "--repetitions" || argument == "--warmup" || argument == "--depth")) {
+            (argument == "--warmup" ? options.warmup
+             : argument == "--depth" ? generator.depth
+                                     : options.repetitions)
+                = *count;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!generate.empty()) {
+        if (!writeProgram(generate, benchmarks::generateProgram(generator))) {
+            std::cerr << RED << "Error: Could not write the program to '" << generate << "'" << RESET << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (options.repetitions == 0) {
+        std::cerr << RED << "Error: There must be at least one repetition" << RESET << '\n';
+        return 2;
+    }
+
+    benchmarks::BenchRunner runner(options);
+    if (scaling.empty()) {
+        benchmarks::runFrontendBenchmarks(runner);
+    } else {
+        benchmarks::runScalingBenchmarks(runner, scaling, generator.depth);
+    }
+    runner.printSummary(std::cout);
+    if (json == "-") {
+        runner.writeJSON(std::cout);
+    } else if (!json.empty()) {
+        std::ofstream file(json);
+        runner.writeJSON(file);
+        if (!file) {
+            std::cerr << RED << "Error: Could not write '" << json << "'" << RESET << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
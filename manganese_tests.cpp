@@ -1,6 +1,8 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <chrono>
 #include <core.hpp>
 #include <filesystem>
@@ -8,6 +10,7 @@
 #include <io/filereader.hpp>
 #include <io/logging.hpp>
 #include <io/stringreader.hpp>
+#include <thread>
 #include <utils/memory_tracking.hpp>
 
 #include "tests/testrunner.hpp"
@@ -19,7 +22,10 @@ bool strneq(const char* a, const char* b, size_t max_count) {
 
 int main(int argc, char const* argv[]) {
     if (argc == 1) {
-        fprintf(stderr, "Usage: %s [--lexer] [--parser] [--semantic] [--codegen] [--all]\n", argv[0]);
+        fprintf(stderr,
+                "Usage: %s [--lexer] [--parser] [--semantic] [--codegen] [--driver] [--all] [--jobs <n>]"
+                " [--budget-scale <factor>]\n",
+                argv[0]);
         return 1;
     }
 
@@ -29,6 +35,10 @@ int main(int argc, char const* argv[]) {
     bool parser = false;
     bool semantic = false;
     bool codegen = false;
+    bool driver = false;
+    // Tests run at the same time by default; time budgets can be scaled for slower builds (e.g. with sanitizers)
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    double budgetScale = 1;
 
     // TODO: Replace this with proper argument parser later (when working on argparser for main executable)
 
@@ -41,28 +51,36 @@ int main(int argc, char const* argv[]) {
             semantic = true;
         } else if (strneq(argv[i], "--codegen", 9)) {
             codegen = true;
+        } else if (strneq(argv[i], "--driver", 8)) {
+            driver = true;
         } else if (strneq(argv[i], "--all", 5)) {
             lexer = true;
             parser = true;
             semantic = true;
             codegen = true;
-            break;
+            driver = true;
+        } else if ((strneq(argv[i], "--jobs", 6) || strneq(argv[i], "-j", 2)) && i + 1 < argc) {
+            jobs = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+        } else if (strneq(argv[i], "--budget-scale", 14) && i + 1 < argc) {
+            budgetScale = strtod(argv[++i], nullptr);
         } else {
             fprintf(stderr, "Skipping unknown argument: %s\n", argv[i]);
         }
     }
     std::filesystem::create_directories("logs");
 
-    Manganese::tests::TestRunner runner;
+    Manganese::tests::TestRunner runner(jobs, budgetScale);
 
     if (lexer) {
         printf("%sLexer Tests%s\n", PINK, RESET);
         Manganese::tests::runLexerTests(runner);
+        runner.runQueued();
         printf("\n");
     }
     if (parser) {
         printf("%sParser Tests%s\n", PINK, RESET);
         Manganese::tests::runParserTests(runner);
+        runner.runQueued();
         printf("\n");
     }
     if (semantic) {
@@ -73,8 +91,14 @@ int main(int argc, char const* argv[]) {
     }
     if (codegen) {
         printf("%sCodegen Tests%s\n", PINK, RESET);
-        // TODO: Add once codegen has progress
-        printf("To be implemented.\n");
+        Manganese::tests::runCodeGenerationTests(runner);
+        runner.runQueued();
+        printf("\n");
+    }
+    if (driver) {
+        printf("%sDriver Tests%s\n", PINK, RESET);
+        Manganese::tests::runDriverTests(runner);
+        runner.runQueued();
         printf("\n");
     }
 
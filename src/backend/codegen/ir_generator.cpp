@@ -0,0 +1,246 @@
+#include <backend/codegen/ir_generator.hpp>
+#include <core.hpp>
+#include <cstdint>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/memory_phase.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace codegen {
+
+IRGenerator::IRGenerator(parser::ParsedFile& file, llvm::LLVMContext& llvmContext, std::string_view moduleName) :
+    context(llvmContext),
+    module(std::make_unique<llvm::Module>(llvm::StringRef(moduleName.data(), moduleName.size()), llvmContext)),
+    builder(llvmContext),
+    parsedFile(file) {
+    context.setDiscardValueNames(!MN_DEBUG);
+}
+
+std::unique_ptr<llvm::Module> IRGenerator::generate() {
+    std::vector<size_t> statements(parsedFile.program.size());
+    std::iota(statements.begin(), statements.end(), size_t{0});
+    return generate(statements, {});
+}
+
+std::unique_ptr<llvm::Module> IRGenerator::generate(std::span<const size_t> statements,
+                                                    std::string_view privatePrefix) {
+    memory::PhaseScope phase(memory::Phase::Codegen);
+    std::vector<uint8_t> defined(parsedFile.program.size(), false);  // Not vector<bool>, to hand out as a span
+    for (size_t index : statements) { defined[index] = true; }
+
+    // A signature that couldn't be lowered was reported by whichever module defines the function
+    if (declareFunctions(defined, privatePrefix) == Result::Failure) { return nullptr; }
+    mir::Builder functionBuilder(functions);
+    for (size_t index : statements) {
+        ast::Statement* statement = parsedFile.program[index];
+        using enum ast::StatementKind;
+        switch (statement->kind) {
+            case FunctionDeclarationStatement: {
+                auto* declaration = static_cast<ast::FunctionDeclarationStatement*>(statement);
+                if (!declaration->genericTypes.empty()) { break; }  // Only its specializations are lowered
+                std::optional<mir::Function> body = functionBuilder.build(declaration);
+                if (!body) {
+                    hasError = true;
+                    break;
+                }
+                mir::optimize(*body);
+                DISCARD(lowerFunction(*body, declarations.at(declaration)));
+                break;
+            }
+            case VariableDeclarationStatement:
+                DISCARD(unsupported(statement, "variable declarations"));  // The analyzer doesn't type them yet
+                break;
+            // Type declarations don't emit any code themselves: their types are lowered wherever they are used
+            case AggregateDeclarationStatement:
+            case AliasStatement:
+            case EmptyStatement:
+            case EnumDeclarationStatement: break;
+            default: DISCARD(unsupported(statement, "statements outside of functions")); break;
+        }
+    }
+    if (hasError) { return nullptr; }
+
+    std::string problems;
+    llvm::raw_string_ostream stream(problems);
+    if (llvm::verifyModule(*module, &stream)) {
+        LOG_INTERNAL(Error, "Generated invalid IR for module '{}':\n{}", module->getName().str(), stream.str());
+        return nullptr;
+    }
+    return std::move(module);
+}
+
+Result IRGenerator::declareFunctions(std::span<const uint8_t> defined, std::string_view privatePrefix) {
+    Result result = Result::Success;
+    llvm::SmallVector<llvm::Type*, 8> parameterTypes;
+    for (size_t index = 0; index < parsedFile.program.size(); ++index) {
+        ast::Statement* statement = parsedFile.program[index];
+        if (statement->kind != ast::StatementKind::FunctionDeclarationStatement) { continue; }
+        auto* declaration = static_cast<ast::FunctionDeclarationStatement*>(statement);
+        if (!declaration->genericTypes.empty()) { continue; }  // Only its specializations are lowered
+
+        // Only the module that defines the function reports a type that can't be lowered
+        const bool isDefined = defined[index];
+        parameterTypes.clear();
+        bool isLowered = true;
+        for (const ast::FunctionParameter& parameter : declaration->parameters) {
+            llvm::Type* type = lower(parameter.type->semanticType, isDefined ? parameter.type : nullptr);
+            isLowered = isLowered && type;
+            parameterTypes.push_back(type);
+        }
+        llvm::Type* returnType = declaration->returnType
+            ? lower(declaration->returnType->semanticType, isDefined ? declaration->returnType : nullptr)
+            : builder.getVoidTy();
+        if (!isLowered || !returnType) {
+            result = Result::Failure;
+            continue;
+        }
+
+        // Private functions can only be called from this file, so the optimizer is free to inline or drop them
+        // (unless the file is split into partitions, which call each other's)
+        const bool isExported = declaration->visibility == ast::Visibility::Public || declaration->name == "main";
+        const bool isInternal = !isExported && privatePrefix.empty();
+        const std::string symbol = isExported || isInternal ? std::string(declaration->name)
+                                                            : std::format("{}.{}", privatePrefix, declaration->name);
+        llvm::Function* function = llvm::Function::Create(
+            llvm::FunctionType::get(returnType, parameterTypes, false),
+            isInternal ? llvm::GlobalValue::InternalLinkage : llvm::GlobalValue::ExternalLinkage, symbol, *module);
+        if (!isExported && !isInternal) { function->setVisibility(llvm::GlobalValue::HiddenVisibility); }
+        for (size_t i = 0; i < declaration->parameters.size(); ++i) {
+            function->getArg(static_cast<unsigned>(i))->setName(declaration->parameters[i].name);
+        }
+        functions.emplace(declaration->name, declaration);
+        declarations.emplace(declaration, function);
+    }
+    return result;
+}
+
+llvm::Type* IRGenerator::lower(const semantic::SemanticType* type, const ast::ASTNode* node) {
+    auto report = [&](std::string_view problem) -> llvm::Type* {
+        if (node) { logError(node, "Could not lower '{}' to IR: {}", node->toString(), problem); }
+        return nullptr;
+    };
+    if (!type) { return report("the analyzer didn't determine its type"); }
+
+    switch (type->kind) {
+        case semantic::Kind::Primitive: {
+            using enum ast::PrimitiveType_t;
+            switch (type->primitiveType) {
+                case i8:
+                case u8: return builder.getInt8Ty();
+                case i16:
+                case u16: return builder.getInt16Ty();
+                case i32:
+                case u32: return builder.getInt32Ty();
+                case i64:
+                case u64: return builder.getInt64Ty();
+                case i128:
+                case u128: return builder.getInt128Ty();
+                case f32: return builder.getFloatTy();
+                case f64: return builder.getDoubleTy();
+                case character: return builder.getInt32Ty();  // A code point
+                case boolean: return builder.getInt1Ty();
+                case str: return builder.getInt8PtrTy();
+                default: return report("it has no primitive type");
+            }
+        }
+        case semantic::Kind::Pointer: {
+            llvm::Type* base = lower(static_cast<const semantic::Pointer*>(type)->baseType, node);
+            return base ? base->getPointerTo() : nullptr;
+        }
+        case semantic::Kind::Array: {
+            const auto* array = static_cast<const semantic::Array*>(type);
+            llvm::Type* element = lower(array->elementType, node);
+            return element ? llvm::ArrayType::get(element, array->length) : nullptr;
+        }
+        case semantic::Kind::Function: {
+            const auto* function = static_cast<const semantic::Function*>(type);
+            llvm::SmallVector<llvm::Type*, 8> parameters;
+            for (const semantic::Parameter& parameter : function->parameterTypes) {
+                llvm::Type* parameterType = lower(parameter.type, node);
+                if (!parameterType) { return nullptr; }
+                parameters.push_back(parameterType);
+            }
+            llvm::Type* returnType = function->returnType ? lower(function->returnType, node) : builder.getVoidTy();
+            return returnType ? llvm::FunctionType::get(returnType, parameters, false)->getPointerTo() : nullptr;
+        }
+        case semantic::Kind::Aggregate: {
+            llvm::SmallVector<llvm::Type*, 8> fields;
+            for (const semantic::AggregateField& field : static_cast<const semantic::Aggregate*>(type)->fields) {
+                llvm::Type* fieldType = lower(field.type, node);
+                if (!fieldType) { return nullptr; }
+                fields.push_back(fieldType);
+            }
+            return llvm::StructType::get(context, fields);
+        }
+        case semantic::Kind::Generic: {
+            const semantic::SemanticType* specialization
+                = static_cast<const semantic::GenericInstance*>(type)->specialization.load(std::memory_order_acquire);
+            return specialization ? lower(specialization, node) : report("generic types are lowered once specialized");
+        }
+        case semantic::Kind::TypeParameter: return report("type parameters are lowered once specialized");
+    }
+    return report("unknown kind of type");
+}
+
+llvm::AllocaInst* IRGenerator::createEntryBlockAlloca(llvm::Type* type) {
+    llvm::IRBuilderBase::InsertPointGuard restore(builder);
+    llvm::BasicBlock& entry = currentFunction->getEntryBlock();
+    builder.SetInsertPoint(&entry, entry.begin());
+    return builder.CreateAlloca(type);
+}
+
+llvm::Value* IRGenerator::truthValue(llvm::Value* value) {
+    llvm::Type* type = value->getType();
+    if (type->isIntegerTy(1)) { return value; }
+    if (type->isIntegerTy()) { return builder.CreateICmpNE(value, llvm::ConstantInt::get(type, 0)); }
+    if (type->isFloatingPointTy()) { return builder.CreateFCmpUNE(value, llvm::ConstantFP::get(type, 0.0)); }
+    if (type->isPointerTy()) { return builder.CreateIsNotNull(value); }
+    return nullptr;
+}
+
+llvm::Value* IRGenerator::convert(llvm::Value* value, const semantic::SemanticType* from,
+                                  const semantic::SemanticType* to) {
+    if (from == to) { return value; }
+    if (!from || !to) { return nullptr; }
+    llvm::Type* target = lower(to);
+    if (!target) { return nullptr; }
+    if (value->getType() == target) { return value; }  // e.g. pointers that only differ in mutability
+
+    if (from->isPointer() && to->isPointer()) { return builder.CreatePointerCast(value, target); }
+    if (!from->isPrimitive() || !to->isPrimitive()) { return nullptr; }
+    const ast::PrimitiveType_t source = from->primitiveType, destination = to->primitiveType;
+    if (source == ast::PrimitiveType_t::str || destination == ast::PrimitiveType_t::str) { return nullptr; }
+    if (destination == ast::PrimitiveType_t::boolean) { return truthValue(value); }
+
+    // Booleans and characters convert like the unsigned integers they are stored as
+    const bool sourceIsSigned = semantic::isInteger(source) && !semantic::isUnsignedInteger(source);
+    const bool destinationIsSigned = semantic::isInteger(destination) && !semantic::isUnsignedInteger(destination);
+    if (semantic::isFloat(source)) {
+        if (semantic::isFloat(destination)) { return builder.CreateFPCast(value, target); }
+        return destinationIsSigned ? builder.CreateFPToSI(value, target) : builder.CreateFPToUI(value, target);
+    }
+    if (semantic::isFloat(destination)) {
+        return sourceIsSigned ? builder.CreateSIToFP(value, target) : builder.CreateUIToFP(value, target);
+    }
+    return builder.CreateIntCast(value, target, sourceIsSigned);
+}
+
+}  // namespace codegen
+}  // namespace Manganese
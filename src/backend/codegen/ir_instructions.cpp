@@ -0,0 +1,314 @@
+#include <backend/codegen/ir_generator.hpp>
+#include <backend/mir.hpp>
+#include <core.hpp>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_base.hpp>
+#include <frontend/lexer/token_type.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
+#include <mnstl/fold_result.hxx>
+#include <string>
+#include <vector>
+
+namespace Manganese {
+namespace codegen {
+
+namespace {
+
+constexpr bool isSigned(const semantic::SemanticType* type) noexcept {
+    return type && semantic::isInteger(type->primitiveType) && !semantic::isUnsignedInteger(type->primitiveType);
+}
+
+}  // namespace
+
+Result IRGenerator::lowerFunction(const mir::Function& body, llvm::Function* declaration) {
+    currentBody = &body;
+    currentFunction = declaration;
+    values.assign(body.instructions.size(), nullptr);
+    blocks.assign(body.blocks.size(), nullptr);
+    origins.clear();
+    phis.clear();
+
+    // Each block comes after the blocks that dominate it, so every value is lowered before it is used (except by phis)
+    const std::vector<mir::BlockId> order = body.reversePostorder();
+    for (mir::BlockId block : order) {
+        const std::string_view name = body.blocks[block].name;
+        blocks[block] = llvm::BasicBlock::Create(context, llvm::StringRef(name.data(), name.size()), declaration);
+        origins[blocks[block]] = block;
+    }
+    Result result = Result::Success;
+    for (mir::BlockId block : order) {
+        builder.SetInsertPoint(blocks[block]);
+        for (mir::ValueId id : body.blocks[block].instructions) {
+            values[id] = lowerInstruction(id);
+            if (!values[id]) {
+                result = Result::Failure;
+                break;
+            }
+        }
+        if (result == Result::Failure || lowerTerminator(block) == Result::Failure) {
+            result = Result::Failure;
+            break;
+        }
+    }
+
+    if (result == Result::Success) {
+        // An LLVM phi has an entry for each edge into its block, which can be more than one from the same block (e.g.
+        // a jump table's holes, which all go to the default)
+        for (auto [id, block] : phis) {
+            const mir::Instruction& instruction = body.instructions[id];
+            auto* phi = llvm::cast<llvm::PHINode>(values[id]);
+            for (llvm::BasicBlock* predecessor : llvm::predecessors(blocks[block])) {
+                const size_t index = mir::predecessorIndex(body.blocks[block], origins.lookup(predecessor));
+                const mir::ValueId operand = instruction.operands[index];
+                phi->addIncoming(operand == mir::NO_VALUE ? llvm::UndefValue::get(phi->getType()) : values[operand],
+                                 predecessor);
+            }
+        }
+    }
+    builder.ClearInsertionPoint();
+    currentBody = nullptr;
+    currentFunction = nullptr;
+    return result;
+}
+
+llvm::Value* IRGenerator::lowerInstruction(mir::ValueId id) {
+    const mir::Instruction& instruction = currentBody->instructions[id];
+    auto operand = [&](size_t i) { return values[instruction.operands[i]]; };
+    const ast::ASTNode* node = instruction.node;
+
+    switch (instruction.opcode) {
+        case mir::Opcode::Constant: return lowerConstant(instruction.constant, instruction.type, node);
+        case mir::Opcode::Zero: {
+            llvm::Type* type = lower(instruction.type, node);
+            return type ? llvm::Constant::getNullValue(type) : nullptr;
+        }
+        case mir::Opcode::Parameter: return currentFunction->getArg(instruction.index);
+        case mir::Opcode::Function: return declarations.at(instruction.callee);
+        case mir::Opcode::Slot: {
+            llvm::Type* type = lower(instruction.type, node);
+            return type ? createEntryBlockAlloca(type) : nullptr;
+        }
+        case mir::Opcode::AddressOf: {
+            llvm::Type* type = lower(instruction.type, node);
+            return type ? builder.CreatePointerCast(operand(0), type) : nullptr;
+        }
+        case mir::Opcode::Load: {
+            llvm::Type* type = lower(instruction.type, node);
+            return type ? builder.CreateLoad(type, operand(0)) : nullptr;
+        }
+        case mir::Opcode::Store: return builder.CreateStore(operand(1), operand(0));
+        case mir::Opcode::Unary: {
+            llvm::Value* value = operand(0);
+            using enum lexer::TokenType;
+            switch (instruction.operation) {
+                case UnaryMinus:
+                    return value->getType()->isFloatingPointTy() ? builder.CreateFNeg(value) : builder.CreateNeg(value);
+                case BitNot: return builder.CreateNot(value);
+                case Not:
+                    if (llvm::Value* truth = truthValue(value)) { return builder.CreateNot(truth); }
+                    break;
+                default: break;
+            }
+            DISCARD(
+                unsupported(node, std::format("the operator '{}'", lexer::tokenTypeToString(instruction.operation))));
+            return nullptr;
+        }
+        case mir::Opcode::Binary:
+            if (semantic::isRelationalOp(instruction.operation)) {
+                const semantic::SemanticType* type = currentBody->instructions[instruction.operands[0]].type;
+                return emitComparison(instruction.operation, operand(0), operand(1), type, node);
+            }
+            return emitArithmetic(instruction.operation, operand(0), operand(1), instruction.type, node);
+        case mir::Opcode::Convert: {
+            const semantic::SemanticType* from = currentBody->instructions[instruction.operands[0]].type;
+            llvm::Value* converted = convert(operand(0), from, instruction.type);
+            if (!converted) {
+                logError(node, "Cannot convert '{}' to '{}'", from ? from->toString() : "void",
+                         instruction.type->toString());
+            }
+            return converted;
+        }
+        case mir::Opcode::Call: {
+            llvm::SmallVector<llvm::Value*, 8> arguments;
+            for (size_t i = 0; i < instruction.operands.size(); ++i) { arguments.push_back(operand(i)); }
+            return builder.CreateCall(declarations.at(instruction.callee), arguments);
+        }
+        case mir::Opcode::Phi: {
+            llvm::Type* type = lower(instruction.type, node);
+            if (!type) { return nullptr; }
+            phis.emplace_back(id, instruction.block);
+            return builder.CreatePHI(type,
+                                     static_cast<unsigned>(currentBody->blocks[instruction.block].predecessors.size()));
+        }
+    }
+    ASSERT_UNREACHABLE(std::format("Unknown MIR opcode {}", static_cast<int>(instruction.opcode)));
+}
+
+Result IRGenerator::lowerTerminator(mir::BlockId block) {
+    const mir::Terminator& terminator = currentBody->blocks[block].terminator;
+    auto target = [&](size_t i) { return blocks[terminator.successors[i]]; };
+    llvm::Value* value = terminator.value == mir::NO_VALUE ? nullptr : values[terminator.value];
+
+    switch (terminator.kind) {
+        case mir::TerminatorKind::Jump: builder.CreateBr(target(0)); return Result::Success;
+        case mir::TerminatorKind::Branch: {
+            llvm::Value* condition = truthValue(value);
+            if (!condition) {
+                logError(terminator.node, "'{}' can't be used as a condition", terminator.node->toString());
+                return Result::Failure;
+            }
+            builder.CreateCondBr(condition, target(0), target(1));
+            return Result::Success;
+        }
+        case mir::TerminatorKind::Switch: {
+            const semantic::SemanticType* type = currentBody->instructions[terminator.value].type;
+            llvm::SwitchInst* instruction
+                = builder.CreateSwitch(value, target(0), static_cast<unsigned>(terminator.cases.size()));
+            for (size_t i = 0; i < terminator.cases.size(); ++i) {
+                auto* key = llvm::dyn_cast_or_null<llvm::ConstantInt>(
+                    lowerConstant(terminator.cases[i], type, terminator.node));
+                if (!key) { return Result::Failure; }
+                instruction->addCase(key, target(i + 1));
+            }
+            return Result::Success;
+        }
+        case mir::TerminatorKind::JumpTable: {
+            // A switch on the index with a case for every entry, which LLVM lowers to a jump table at any optimization
+            // level (rather than weighing the cases up itself, as it does for a sparse switch)
+            const semantic::SemanticType* type = currentBody->instructions[terminator.value].type;
+            llvm::Value* base = lowerConstant(terminator.cases[0], type, terminator.node);
+            if (!base) { return Result::Failure; }
+            const size_t size = terminator.successors.size() - 1;
+            llvm::SwitchInst* instruction
+                = builder.CreateSwitch(builder.CreateSub(value, base), target(0), static_cast<unsigned>(size));
+            for (size_t i = 0; i < size; ++i) {
+                instruction->addCase(llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(value->getType()), i),
+                                     target(i + 1));
+            }
+            return Result::Success;
+        }
+        case mir::TerminatorKind::Return:
+            if (value) {
+                builder.CreateRet(value);
+            } else {
+                builder.CreateRetVoid();
+            }
+            return Result::Success;
+        case mir::TerminatorKind::None: break;
+    }
+    LOG_INTERNAL(Error, "Block {} of '{}' has no terminator", block, currentFunction->getName().str());
+    return Result::Failure;
+}
+
+llvm::Value* IRGenerator::lowerConstant(const mnstl::fold_result_t& value, const semantic::SemanticType* type,
+                                        const ast::ASTNode* node) {
+    llvm::Type* lowered = lower(type, node);
+    if (!lowered) { return nullptr; }
+    using held = enum mnstl::fold_result_t::held_type;
+    switch (value.held_type()) {
+        case held::Boolean: return builder.getInt1(value.boolean_unchecked());
+        case held::Character: return builder.getInt32(static_cast<uint32_t>(value.character_unchecked()));
+        case held::Number: {
+            const mnstl::number_t number = value.number_unchecked();
+            if (number.is_float()) { return llvm::ConstantFP::get(lowered, number.value_as<double>()); }
+            if (!lowered->isIntegerTy()) { break; }
+            // Through the digits, which carry every bit of 128-bit values
+            return llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(lowered), number.to_string(), 10);
+        }
+        case held::String: {
+            const std::string_view string = value.string_unchecked();
+            return builder.CreateGlobalStringPtr(llvm::StringRef(string.data(), string.size()), "str");
+        }
+        case held::Void: break;
+    }
+    logError(node, "Could not lower '{}' to IR: it isn't a constant of type '{}'", node->toString(), type->toString());
+    return nullptr;
+}
+
+llvm::Value* IRGenerator::emitArithmetic(lexer::TokenType op, llvm::Value* lhs, llvm::Value* rhs,
+                                         const semantic::SemanticType* type, const ast::ASTNode* node) {
+    const bool isFloatingPoint = semantic::isFloat(type->primitiveType);
+    const bool isSignedInteger = isSigned(type);
+
+    using enum lexer::TokenType;
+    switch (op) {
+        case Plus: return isFloatingPoint ? builder.CreateFAdd(lhs, rhs) : builder.CreateAdd(lhs, rhs);
+        case Minus: return isFloatingPoint ? builder.CreateFSub(lhs, rhs) : builder.CreateSub(lhs, rhs);
+        case Mul: return isFloatingPoint ? builder.CreateFMul(lhs, rhs) : builder.CreateMul(lhs, rhs);
+        case Div:
+            if (isFloatingPoint) { return builder.CreateFDiv(lhs, rhs); }
+            return isSignedInteger ? builder.CreateSDiv(lhs, rhs) : builder.CreateUDiv(lhs, rhs);
+        case Mod:
+            if (isFloatingPoint) { return builder.CreateFRem(lhs, rhs); }
+            return isSignedInteger ? builder.CreateSRem(lhs, rhs) : builder.CreateURem(lhs, rhs);
+        case FloorDiv: {
+            if (isFloatingPoint) {
+                return builder.CreateUnaryIntrinsic(llvm::Intrinsic::floor, builder.CreateFDiv(lhs, rhs));
+            }
+            if (!isSignedInteger) { return builder.CreateUDiv(lhs, rhs); }
+            // Division truncates, so round down when there's a remainder and the operands' signs differ
+            llvm::Value* quotient = builder.CreateSDiv(lhs, rhs);
+            llvm::Value* remainder = builder.CreateSRem(lhs, rhs);
+            llvm::Value* zero = llvm::ConstantInt::get(lhs->getType(), 0);
+            llvm::Value* roundsDown = builder.CreateAnd(builder.CreateICmpNE(remainder, zero),
+                                                        builder.CreateICmpSLT(builder.CreateXor(remainder, rhs), zero));
+            return builder.CreateSub(quotient, builder.CreateZExt(roundsDown, lhs->getType()));
+        }
+        case BitAnd: return builder.CreateAnd(lhs, rhs);
+        case BitOr: return builder.CreateOr(lhs, rhs);
+        case BitXor: return builder.CreateXor(lhs, rhs);
+        case BitLShift: return builder.CreateShl(lhs, rhs);
+        case BitRShift: return isSignedInteger ? builder.CreateAShr(lhs, rhs) : builder.CreateLShr(lhs, rhs);
+        default: break;
+    }
+    DISCARD(unsupported(node, std::format("the operator '{}'", lexer::tokenTypeToString(op))));
+    return nullptr;
+}
+
+llvm::Value* IRGenerator::emitComparison(lexer::TokenType op, llvm::Value* lhs, llvm::Value* rhs,
+                                         const semantic::SemanticType* type, const ast::ASTNode* node) {
+    using enum lexer::TokenType;
+    using Predicate = llvm::CmpInst::Predicate;
+    if (lhs->getType()->isFloatingPointTy()) {
+        // Ordered comparisons, so each is false if either operand is NaN (except for !=, which is then true)
+        switch (op) {
+            case Equal: return builder.CreateFCmp(Predicate::FCMP_OEQ, lhs, rhs);
+            case NotEqual: return builder.CreateFCmp(Predicate::FCMP_UNE, lhs, rhs);
+            case LessThan: return builder.CreateFCmp(Predicate::FCMP_OLT, lhs, rhs);
+            case LessThanOrEqual: return builder.CreateFCmp(Predicate::FCMP_OLE, lhs, rhs);
+            case GreaterThan: return builder.CreateFCmp(Predicate::FCMP_OGT, lhs, rhs);
+            case GreaterThanOrEqual: return builder.CreateFCmp(Predicate::FCMP_OGE, lhs, rhs);
+            default: break;
+        }
+    } else {
+        const bool isSignedInteger = isSigned(type);
+        switch (op) {
+            case Equal: return builder.CreateICmp(Predicate::ICMP_EQ, lhs, rhs);
+            case NotEqual: return builder.CreateICmp(Predicate::ICMP_NE, lhs, rhs);
+            case LessThan:
+                return builder.CreateICmp(isSignedInteger ? Predicate::ICMP_SLT : Predicate::ICMP_ULT, lhs, rhs);
+            case LessThanOrEqual:
+                return builder.CreateICmp(isSignedInteger ? Predicate::ICMP_SLE : Predicate::ICMP_ULE, lhs, rhs);
+            case GreaterThan:
+                return builder.CreateICmp(isSignedInteger ? Predicate::ICMP_SGT : Predicate::ICMP_UGT, lhs, rhs);
+            case GreaterThanOrEqual:
+                return builder.CreateICmp(isSignedInteger ? Predicate::ICMP_SGE : Predicate::ICMP_UGE, lhs, rhs);
+            default: break;
+        }
+    }
+    DISCARD(unsupported(node, std::format("the operator '{}'", lexer::tokenTypeToString(op))));
+    return nullptr;
+}
+
+}  // namespace codegen
+}  // namespace Manganese
@@ -0,0 +1,116 @@
+#include <backend/codegen/jit.hpp>
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <format>
+#include <io/logging.hpp>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/memory_phase.hpp>
+#include <utils/trace.hpp>
+
+namespace Manganese {
+namespace codegen {
+
+namespace {
+
+void reportJITError(std::string_view what, llvm::Error error) {
+    logging::reportError(std::format("{}: {}", what, llvm::toString(std::move(error))));
+}
+
+}  // namespace
+
+std::optional<int> runMain(std::span<const std::string> modules, OptimizationLevel level) {
+    trace::Scope scope("run");
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    bool returnsVoid = false;
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit;
+    {
+        memory::PhaseScope phase(memory::Phase::Codegen);
+        llvm::Expected<llvm::orc::JITTargetMachineBuilder> target = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!target) {
+            reportJITError("Could not target this machine", target.takeError());
+            return std::nullopt;
+        }
+        target->setCodeGenOptLevel(codeGenLevel(level));
+        llvm::Expected<std::unique_ptr<llvm::orc::LLLazyJIT>> created
+            = llvm::orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(*target)).create();
+        if (!created) {
+            reportJITError("Could not create the JIT", created.takeError());
+            return std::nullopt;
+        }
+        jit = std::move(*created);
+
+        // Let the program call into the C library (and anything else this process has loaded)
+        llvm::orc::JITDylib& program = jit->getMainJITDylib();
+        llvm::Expected<std::unique_ptr<llvm::orc::DynamicLibrarySearchGenerator>> process
+            = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix());
+        if (!process) {
+            reportJITError("Could not make this process's symbols visible to the program", process.takeError());
+            return std::nullopt;
+        }
+        program.addGenerator(std::move(*process));
+
+        bool hasMain = false;
+        for (const std::string& bitcode : modules) {
+            // Each module gets a context of its own, since the JIT may compile functions from several at once
+            auto context = std::make_unique<llvm::LLVMContext>();
+            llvm::Expected<std::unique_ptr<llvm::Module>> module = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(llvm::StringRef(bitcode), "bitcode"), *context);
+            if (!module) {
+                reportJITError("Could not read the generated bitcode", module.takeError());
+                return std::nullopt;
+            }
+            if (const llvm::Function* main = (*module)->getFunction("main"); main && !main->isDeclaration()) {
+                const llvm::Type* returnType = main->getReturnType();
+                if (!main->arg_empty() || !(returnType->isVoidTy() || returnType->isIntegerTy(32))) {
+                    logging::reportError("main() must take nothing, and return an int32 or nothing");
+                    return std::nullopt;
+                }
+                hasMain = true;
+                returnsVoid = returnType->isVoidTy();
+            }
+            if (llvm::Error error
+                = jit->addLazyIRModule(llvm::orc::ThreadSafeModule(std::move(*module), std::move(context)))) {
+                reportJITError("Could not add a module to the JIT", std::move(error));
+                return std::nullopt;
+            }
+        }
+        if (!hasMain) {
+            logging::reportError("The program has no main() to run");
+            return std::nullopt;
+        }
+    }
+
+    // Only compiles main() (and the stubs for what it calls)
+    llvm::Expected<llvm::JITEvaluatedSymbol> main = jit->lookup("main");
+    if (!main) {
+        reportJITError("Could not compile main()", main.takeError());
+        return std::nullopt;
+    }
+    if (returnsVoid) {
+        reinterpret_cast<void (*)()>(main->getAddress())();
+        return 0;
+    }
+    return reinterpret_cast<int (*)()>(main->getAddress())();
+}
+
+}  // namespace codegen
+}  // namespace Manganese
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <backend/codegen/ir_generator.hpp>
+#include <backend/codegen/object_emitter.hpp>
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <format>
+#include <frontend/ast.hpp>
+#include <functional>
+#include <io/logging.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utils/memory_phase.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace codegen {
+
+namespace {
+
+// A target machine for the host. Each partition gets its own, since they hold per-compilation state
+std::unique_ptr<llvm::TargetMachine> createHostTargetMachine(OptimizationLevel level) {
+    static std::once_flag initialized;
+    std::call_once(initialized, []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+    });
+
+    const std::string triple = llvm::sys::getDefaultTargetTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        logging::reportError(std::format("No code generator for '{}': {}", triple, error));
+        return nullptr;
+    }
+    llvm::StringMap<bool> hostFeatures;
+    llvm::SubtargetFeatures features;
+    if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+        for (const auto& feature : hostFeatures) { features.AddFeature(feature.first(), feature.second); }
+    }
+    // Position independent, since the system's linker makes position independent executables by default
+    std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
+        triple, llvm::sys::getHostCPUName(), features.getString(), llvm::TargetOptions(), llvm::Reloc::PIC_,
+        llvm::None, codeGenLevel(level)));
+    if (!machine) { logging::reportError(std::format("Could not create a code generator for '{}'", triple)); }
+    return machine;
+}
+
+// Lower, optimize and emit one partition of `file`, in a context of its own
+std::optional<std::string> emitPartition(parser::ParsedFile& file, std::string_view moduleName,
+                                         std::span<const size_t> statements, const EmitOptions& options,
+                                         std::string_view privatePrefix) {
+    trace::Scope scope("codegen partition");
+    scope.setArgument("statements", statements.size());
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> module =
+        IRGenerator(file, context, moduleName).generate(statements, privatePrefix);
+    if (!module) { return std::nullopt; }
+
+    std::unique_ptr<llvm::TargetMachine> target = createHostTargetMachine(options.level);
+    if (!target) { return std::nullopt; }
+    module->setTargetTriple(target->getTargetTriple().str());
+    module->setDataLayout(target->createDataLayout());
+    optimize(*module, options.level, target.get());
+
+    memory::PhaseScope phase(memory::Phase::Codegen);
+    llvm::SmallVector<char, 0> object;
+    llvm::raw_svector_ostream stream(object);
+    if (options.format == CodeFormat::Bitcode) {
+        llvm::WriteBitcodeToFile(*module, stream);
+        return std::string(object.data(), object.size());
+    }
+    llvm::legacy::PassManager emitter;  // Instruction selection still needs the legacy pass manager
+    if (target->addPassesToEmitFile(emitter, stream, nullptr, llvm::CGFT_ObjectFile)) {
+        logging::reportError(
+            std::format("The code generator for '{}' can't emit object files", target->getTargetTriple().str()));
+        return std::nullopt;
+    }
+    emitter.run(*module);
+    return std::string(object.data(), object.size());
+}
+
+// How much work lowering a top-level statement is, roughly
+size_t weightOf(const ast::Statement* statement) noexcept {
+    if (statement->kind != ast::StatementKind::FunctionDeclarationStatement) { return 1; }
+    return static_cast<const ast::FunctionDeclarationStatement*>(statement)->body.size() + 1;
+}
+
+}  // namespace
+
+std::optional<std::vector<std::string>> emitCode(parser::ParsedFile& file, std::string_view moduleName,
+                                                 const EmitOptions& options) {
+    trace::Scope scope("codegen");
+    const ast::Block& program = file.program;
+    std::vector<size_t> functions;  // Indices into the program
+    for (size_t i = 0; i < program.size(); ++i) {
+        if (program[i]->kind == ast::StatementKind::FunctionDeclarationStatement) { functions.push_back(i); }
+    }
+    const size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t count = options.format == CodeFormat::Bitcode
+        ? 1
+        : std::clamp(functions.size() / MIN_FUNCTIONS_PER_PARTITION, size_t{1}, threads);
+
+    // Heaviest function first, each to the lightest partition so far, which keeps the partitions close in size.
+    // Everything that isn't a function goes in the first partition
+    std::vector<std::vector<size_t>> partitions(count);
+    if (count == 1) {
+        partitions[0].resize(program.size());
+        std::iota(partitions[0].begin(), partitions[0].end(), size_t{0});
+    } else {
+        std::vector<size_t> weights(count, 0);
+        for (size_t i = 0; i < program.size(); ++i) {
+            if (program[i]->kind != ast::StatementKind::FunctionDeclarationStatement) { partitions[0].push_back(i); }
+        }
+        std::ranges::stable_sort(functions, std::greater<>(), [&](size_t i) { return weightOf(program[i]); });
+        for (size_t function : functions) {
+            const size_t lightest = static_cast<size_t>(std::ranges::min_element(weights) - weights.begin());
+            partitions[lightest].push_back(function);
+            weights[lightest] += weightOf(program[function]);
+        }
+        for (std::vector<size_t>& partition : partitions) { std::ranges::sort(partition); }
+    }
+    // With one partition, private functions stay internal to it
+    const std::string_view privatePrefix = count == 1 ? std::string_view() : options.privatePrefix;
+
+    std::vector<logging::DiagnosticList> diagnostics(count);
+    std::vector<std::optional<std::string>> objects(count);
+    std::atomic<size_t> nextPartition = 0;
+    auto emit = [&]() {
+        for (size_t i; (i = nextPartition.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            logging::DiagnosticCapture capture(diagnostics[i]);
+            objects[i] = emitPartition(file, moduleName, partitions[i], options, privatePrefix);
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(count - 1);
+        for (size_t i = 0; i + 1 < count; ++i) { workers.emplace_back(emit); }
+        emit();
+    }  // Join the workers
+
+    for (const logging::DiagnosticList& buffer : diagnostics) { logging::report(buffer); }
+    std::vector<std::string> result;
+    result.reserve(count);
+    for (std::optional<std::string>& object : objects) {
+        if (!object) { return std::nullopt; }
+        result.push_back(std::move(*object));
+    }
+    return result;
+}
+
+}  // namespace codegen
+}  // namespace Manganese
@@ -0,0 +1,65 @@
+#include <backend/codegen/optimizer.hpp>
+#include <core.hpp>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/CodeGen.h>
+#include <optional>
+#include <string_view>
+#include <utils/memory_phase.hpp>
+
+namespace Manganese {
+namespace codegen {
+
+std::optional<OptimizationLevel> parseOptimizationLevel(std::string_view flag) noexcept {
+    if (flag == "O0") { return OptimizationLevel::O0; }
+    if (flag == "O1") { return OptimizationLevel::O1; }
+    if (flag == "O2") { return OptimizationLevel::O2; }
+    if (flag == "O3") { return OptimizationLevel::O3; }
+    return std::nullopt;
+}
+
+void optimize(llvm::Module& module, OptimizationLevel level, llvm::TargetMachine* target) {
+    memory::PhaseScope phase(memory::Phase::Codegen);
+
+    // Declared innermost first, so the outer managers (which hold proxies to the inner ones) are destroyed first
+    llvm::LoopAnalysisManager loopAnalyses;
+    llvm::FunctionAnalysisManager functionAnalyses;
+    llvm::CGSCCAnalysisManager sccAnalyses;
+    llvm::ModuleAnalysisManager moduleAnalyses;
+
+    llvm::PassBuilder passBuilder(target);
+    passBuilder.registerModuleAnalyses(moduleAnalyses);
+    passBuilder.registerCGSCCAnalyses(sccAnalyses);
+    passBuilder.registerFunctionAnalyses(functionAnalyses);
+    passBuilder.registerLoopAnalyses(loopAnalyses);
+    passBuilder.crossRegisterProxies(loopAnalyses, functionAnalyses, sccAnalyses, moduleAnalyses);
+
+    llvm::ModulePassManager passes;
+    switch (level) {
+        case OptimizationLevel::O0: passes = passBuilder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0); break;
+        case OptimizationLevel::O1:
+            passes = passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+            break;
+        case OptimizationLevel::O2:
+            passes = passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+            break;
+        case OptimizationLevel::O3:
+            passes = passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+            break;
+    }
+    passes.run(module, moduleAnalyses);
+}
+
+llvm::CodeGenOpt::Level codeGenLevel(OptimizationLevel level) noexcept {
+    switch (level) {
+        case OptimizationLevel::O0: return llvm::CodeGenOpt::None;
+        case OptimizationLevel::O1: return llvm::CodeGenOpt::Less;
+        case OptimizationLevel::O2: return llvm::CodeGenOpt::Default;
+        case OptimizationLevel::O3: return llvm::CodeGenOpt::Aggressive;
+    }
+    return llvm::CodeGenOpt::Default;
+}
+
+}  // namespace codegen
+}  // namespace Manganese
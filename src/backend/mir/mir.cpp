@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <backend/mir/mir.hpp>
+#include <core.hpp>
+#include <cstddef>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_base.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <mnstl/fold_result.hxx>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace mir {
+
+namespace {
+
+// Drop the edge from `from` to `to`, and the operands of the phis of `to` that came along it
+void removeEdge(Function& function, BlockId from, BlockId to) {
+    Block& block = function.blocks[to];
+    auto position = std::ranges::find(block.predecessors, from);
+    if (position == block.predecessors.end()) { return; }  // Already removed (as a duplicate successor)
+    const auto index = static_cast<size_t>(position - block.predecessors.begin());
+    block.predecessors.erase(position);
+    for (ValueId phi : block.instructions) {
+        Instruction& instruction = function.instructions[phi];
+        if (instruction.opcode != Opcode::Phi) { break; }
+        instruction.operands.erase(instruction.operands.begin() + static_cast<ptrdiff_t>(index));
+    }
+}
+
+std::string constantToString(const mnstl::fold_result_t& value) {
+    using held = enum mnstl::fold_result_t::held_type;
+    switch (value.held_type()) {
+        case held::Boolean: return value.boolean_unchecked() ? "true" : "false";
+        case held::Character: return std::format("U+{:04X}", static_cast<uint32_t>(value.character_unchecked()));
+        case held::Number: return value.number_unchecked().to_string();
+        case held::String: return std::format("\"{}\"", value.string_unchecked());
+        case held::Void: break;
+    }
+    return "void";
+}
+
+}  // namespace
+
+BlockId Function::addBlock(std::string_view name) {
+    blocks.emplace_back().name = name;
+    return static_cast<BlockId>(blocks.size() - 1);
+}
+
+ValueId Function::add(BlockId block, Instruction instruction) {
+    const auto id = static_cast<ValueId>(instructions.size());
+    instruction.block = block;
+    std::vector<ValueId>& list = blocks[block].instructions;
+    if (const Opcode opcode = instruction.opcode; opcode == Opcode::Phi || opcode == Opcode::Constant) {
+        // Folding adds constants to the entry block after the instructions that use them, so they go first
+        list.insert(std::ranges::find_if(list, [&](ValueId v) { return instructions[v].opcode != opcode; }), id);
+    } else {
+        list.push_back(id);
+    }
+    instructions.push_back(std::move(instruction));
+    replacements.push_back(NO_VALUE);
+    return id;
+}
+
+llvm::SmallVector<bool, 2> Function::setTerminator(BlockId block, Terminator terminator) {
+    for (BlockId old : blocks[block].terminator.successors) {
+        if (std::ranges::find(terminator.successors, old) == terminator.successors.end()) {
+            removeEdge(*this, block, old);
+        }
+    }
+    llvm::SmallVector<bool, 2> added;
+    for (BlockId successor : terminator.successors) {
+        std::vector<BlockId>& predecessors = blocks[successor].predecessors;
+        const bool isNew = std::ranges::find(predecessors, block) == predecessors.end();
+        if (isNew) { predecessors.push_back(block); }
+        added.push_back(isNew);
+    }
+    blocks[block].terminator = std::move(terminator);
+    return added;
+}
+
+void Function::removeBlock(BlockId block) {
+    Block& removed = blocks[block];
+    for (BlockId successor : removed.terminator.successors) { removeEdge(*this, block, successor); }
+    for (ValueId instruction : removed.instructions) { instructions[instruction].block = NO_BLOCK; }
+    removed.instructions.clear();
+    removed.terminator = Terminator{};
+    removed.isRemoved = true;
+}
+
+void Function::replace(ValueId value, ValueId with) {
+    with = resolve(with);
+    if (with == value) { return; }
+    replacements[value] = with;
+    instructions[value].block = NO_BLOCK;
+}
+
+ValueId Function::resolve(ValueId value) noexcept {
+    if (value == NO_VALUE) { return value; }
+    ValueId root = value;
+    while (replacements[root] != NO_VALUE) { root = replacements[root]; }
+    while (value != root) {  // So the next lookup of anything on the way takes one step
+        const ValueId next = replacements[value];
+        replacements[value] = root;
+        value = next;
+    }
+    return root;
+}
+
+void Function::compact() {
+    for (Instruction& instruction : instructions) {
+        if (instruction.block == NO_BLOCK) { continue; }
+        for (ValueId& operand : instruction.operands) { operand = resolve(operand); }
+    }
+    for (Block& block : blocks) {
+        block.terminator.value = resolve(block.terminator.value);
+        std::erase_if(block.instructions, [&](ValueId v) { return instructions[v].block == NO_BLOCK; });
+    }
+}
+
+std::vector<BlockId> Function::reversePostorder() const {
+    std::vector<BlockId> order;
+    if (blocks.empty()) { return order; }
+    std::vector<uint8_t> visited(blocks.size(), false);
+    // Each block on the stack with how many of its successors have been visited
+    std::vector<std::pair<BlockId, size_t>> stack{{0, 0}};
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const llvm::SmallVector<BlockId, 2>& successors = blocks[block].terminator.successors;
+        if (next == successors.size()) {
+            order.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        const BlockId successor = successors[next++];
+        if (!visited[successor]) {
+            visited[successor] = true;
+            stack.emplace_back(successor, 0);
+        }
+    }
+    std::ranges::reverse(order);
+    return order;
+}
+
+std::string Function::toString() const {
+    auto label = [&](BlockId block) { return std::format("{}.{}", blocks[block].name, block); };
+    auto value = [](ValueId v) { return v == NO_VALUE ? std::string("undef") : std::format("%{}", v); };
+
+    std::string out = std::format("func {} {{\n", declaration ? declaration->name : std::string());
+    for (BlockId b = 0; b < blocks.size(); ++b) {
+        const Block& block = blocks[b];
+        if (block.isRemoved) { continue; }
+        out += label(b);
+        for (size_t i = 0; i < block.predecessors.size(); ++i) {
+            out += std::format("{}{}", i == 0 ? " (from " : ", ", label(block.predecessors[i]));
+        }
+        out += block.predecessors.empty() ? ":\n" : "):\n";
+
+        for (ValueId id : block.instructions) {
+            const Instruction& instruction = instructions[id];
+            if (instruction.block == NO_BLOCK) { continue; }
+            out += "    ";
+            if (instruction.type) { out += std::format("%{} = ", id); }
+            std::string operands;
+            for (size_t i = 0; i < instruction.operands.size(); ++i) {
+                if (i > 0) { operands += ", "; }
+                operands += value(instruction.operands[i]);
+                if (instruction.opcode == Opcode::Phi && i < block.predecessors.size()) {
+                    operands += std::format(" from {}", label(block.predecessors[i]));
+                }
+            }
+            switch (instruction.opcode) {
+                case Opcode::Constant: out += "const " + constantToString(instruction.constant); break;
+                case Opcode::Zero: out += "zero"; break;
+                case Opcode::Parameter: out += std::format("param {}", instruction.index); break;
+                case Opcode::Function: out += "function " + instruction.callee->name; break;
+                case Opcode::Slot: out += "slot"; break;
+                case Opcode::AddressOf: out += "address " + operands; break;
+                case Opcode::Load: out += "load " + operands; break;
+                case Opcode::Store: out += "store " + operands; break;
+                case Opcode::Unary:
+                case Opcode::Binary:
+                    out += std::format("{} {}", lexer::tokenTypeToString(instruction.operation), operands);
+                    break;
+                case Opcode::Convert: out += "convert " + operands; break;
+                case Opcode::Call: out += std::format("call {}({})", instruction.callee->name, operands); break;
+                case Opcode::Phi: out += "phi " + operands; break;
+            }
+            if (instruction.type) { out += " : " + instruction.type->toString(); }
+            out += '\n';
+        }
+
+        const Terminator& terminator = block.terminator;
+        out += "    ";
+        switch (terminator.kind) {
+            case TerminatorKind::None: out += "(unterminated)"; break;
+            case TerminatorKind::Jump: out += "jump " + label(terminator.successors[0]); break;
+            case TerminatorKind::Branch:
+                out += std::format("branch {}, {}, {}", value(terminator.value), label(terminator.successors[0]),
+                                   label(terminator.successors[1]));
+                break;
+            case TerminatorKind::Switch:
+                out += std::format("switch {}", value(terminator.value));
+                for (size_t i = 0; i < terminator.cases.size(); ++i) {
+                    out += std::format(", {}: {}", constantToString(terminator.cases[i]),
+                                       label(terminator.successors[i + 1]));
+                }
+                out += ", default: " + label(terminator.successors[0]);
+                break;
+            case TerminatorKind::JumpTable:
+                out += std::format("jumptable {} from {} [", value(terminator.value),
+                                   constantToString(terminator.cases[0]));
+                for (size_t i = 1; i < terminator.successors.size(); ++i) {
+                    out += std::format("{}{}", i == 1 ? "" : ", ", label(terminator.successors[i]));
+                }
+                out += "], default: " + label(terminator.successors[0]);
+                break;
+            case TerminatorKind::Return:
+                out += terminator.value == NO_VALUE ? std::string("return") : "return " + value(terminator.value);
+                break;
+        }
+        out += '\n';
+    }
+    out += "}\n";
+    return out;
+}
+
+size_t predecessorIndex(const Block& block, BlockId predecessor) noexcept {
+    return static_cast<size_t>(std::ranges::find(block.predecessors, predecessor) - block.predecessors.begin());
+}
+
+mnstl::fold_result_t castConstant(const mnstl::fold_result_t& value, const semantic::SemanticType* type) noexcept {
+    if (!type || !type->isPrimitive() || !value.has_value()) { return mnstl::fold_result_t{}; }
+    const ast::PrimitiveType_t target = type->primitiveType;
+    if (value.is_number()) {
+        const mnstl::number_t& number = value.number_unchecked();
+        if (number.is_error()) { return mnstl::fold_result_t{}; }
+        // A float can be outside of the integer type's range, where converting it is undefined (and poison in the
+        // generated code), so that is left to run
+        if (number.is_float() && (semantic::isInteger(target) || target == ast::PrimitiveType_t::character)) {
+            return mnstl::fold_result_t{};
+        }
+    }
+    return ast::foldCast(value, target);
+}
+
+}  // namespace mir
+}  // namespace Manganese
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <backend/mir/mir_builder.hpp>
+#include <core.hpp>
+#include <cstdint>
+#include <frontend/ast.hpp>
+#include <frontend/ast/flat_ast.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace mir {
+
+bool isConvertible(const semantic::SemanticType* from, const semantic::SemanticType* to) noexcept {
+    if (from == to) { return true; }
+    if (!from || !to) { return false; }
+    if (from->isPointer() && to->isPointer()) { return true; }
+    if (from->isPrimitive() && to->isPrimitive()) {
+        return from->primitiveType != ast::PrimitiveType_t::str && to->primitiveType != ast::PrimitiveType_t::str;
+    }
+    if (to->isBoolean()) { return from->isPointer(); }  // Whether it isn't null
+    const bool isFromScalar = from->isPrimitive() || from->isPointer();
+    const bool isToScalar = to->isPrimitive() || to->isPointer();
+    return !isFromScalar && !isToScalar;
+}
+
+std::optional<Function> Builder::build(ast::FunctionDeclarationStatement* declaration) {
+    function = Function{.declaration = declaration};
+    states.clear();
+    definitions.clear();
+    variableTypes.clear();
+    locals.clear();
+    scopes.clear();
+    loops.clear();
+    addressTaken.clear();
+    returnType = declaration->returnType ? declaration->returnType->semanticType : nullptr;
+    hasError = false;
+
+    // A local whose address is taken has to live in memory, so the pointer can see (and make) changes to it
+    const ast::flat::Tree tree = ast::flat::Tree::build(declaration->body);
+    for (ast::flat::NodeId id = 0; id < tree.size(); ++id) {
+        if (tree.nodeClass(id) != ast::flat::NodeClass::Expression
+            || tree.expressionKind(id) != ast::ExpressionKind::PrefixExpression) {
+            continue;
+        }
+        const auto& prefix = tree.node<ast::PrefixExpression>(id);
+        if (prefix.op == lexer::TokenType::AddressOf
+            && prefix.right->kind == ast::ExpressionKind::IdentifierExpression) {
+            addressTaken.push_back(static_cast<const ast::IdentifierExpression*>(prefix.right)->value);
+        }
+    }
+
+    current = newBlock("entry");
+    states[current].isEntered = true;
+    scopes.push_back(locals.size());
+    for (size_t i = 0; i < declaration->parameters.size(); ++i) {
+        const ast::FunctionParameter& parameter = declaration->parameters[i];
+        const semantic::SemanticType* type = parameter.type->semanticType;
+        const ValueId argument = emit(Instruction{
+            .opcode = Opcode::Parameter, .index = static_cast<uint32_t>(i), .type = type, .node = parameter.type});
+        Local local{.name = parameter.name, .variable = 0, .slot = NO_VALUE, .type = type};
+        if (std::ranges::find(addressTaken, local.name) != addressTaken.end()) {
+            local.slot = emit(Instruction{.opcode = Opcode::Slot, .type = type, .node = parameter.type});
+            store(Place{.local = nullptr, .address = local.slot}, argument, parameter.type);
+        } else {
+            local.variable = newVariable(type, argument);
+        }
+        locals.push_back(local);
+    }
+    const Result result = visit(declaration->body);
+
+    if (current != NO_BLOCK) {
+        // Falling off the end of a function that returns a value returns zero (whether every path returns isn't
+        // checked yet)
+        const ValueId value = returnType
+            ? emit(Instruction{.opcode = Opcode::Zero, .type = returnType, .node = declaration})
+            : NO_VALUE;
+        terminate(Terminator{.kind = TerminatorKind::Return, .value = value, .node = declaration});
+    }
+    locals.clear();
+    scopes.clear();
+    if (result == Result::Failure || hasError) { return std::nullopt; }
+    return std::move(function);
+}
+
+BlockId Builder::newBlock(std::string_view name) {
+    states.emplace_back();
+    return function.addBlock(name);
+}
+
+ValueId Builder::emit(Instruction instruction) { return function.add(current, std::move(instruction)); }
+
+ValueId Builder::constant(const mnstl::fold_result_t& value, const semantic::SemanticType* type,
+                          const ast::ASTNode* node) {
+    mnstl::fold_result_t converted = castConstant(value, type);
+    if (!converted.has_value()) {
+        logError(node, "Could not lower '{}' to IR: its value isn't a constant of type '{}'", node->toString(),
+                 type ? type->toString() : "(unknown)");
+        return NO_VALUE;
+    }
+    // Constants live in the entry block, so they can be used anywhere (even after the block using them is merged away)
+    return function.add(0, Instruction{.opcode = Opcode::Constant,
+                                       .type = type,
+                                       .constant = std::move(converted),
+                                       .node = node});
+}
+
+void Builder::terminate(Terminator terminator) {
+    if (current == NO_BLOCK) { return; }  // Already left (e.g. by a return)
+    const BlockId from = current;
+    const llvm::SmallVector<BlockId, 2> successors = terminator.successors;
+    const llvm::SmallVector<bool, 2> added = function.setTerminator(from, std::move(terminator));
+    for (size_t i = 0; i < successors.size(); ++i) {
+        if (!added[i]) { continue; }  // The same block twice (e.g. a switch's cases with the default's body)
+        BlockState& successor = states[successors[i]];
+        if (!successor.isEntered) {
+            successor.incoming.push_back(definitions);
+            continue;
+        }
+        // A back edge, to a loop header
+        for (auto [variable, phi] : successor.phis) {
+            function.instructions[phi].operands.push_back(definitions[variable]);
+        }
+    }
+    current = NO_BLOCK;
+}
+
+void Builder::jump(BlockId target) {
+    terminate(Terminator{.kind = TerminatorKind::Jump, .successors = {target}});
+}
+
+void Builder::branch(ValueId condition, BlockId ifTrue, BlockId ifFalse, const ast::ASTNode* node) {
+    terminate(Terminator{
+        .kind = TerminatorKind::Branch, .value = condition, .successors = {ifTrue, ifFalse}, .node = node});
+}
+
+void Builder::enter(BlockId block) {
+    BlockState& state = states[block];
+    state.isEntered = true;
+    std::vector<std::vector<ValueId>> incoming = std::move(state.incoming);
+    if (incoming.empty()) {  // Nothing branches here, so what follows can't run
+        function.removeBlock(block);
+        current = NO_BLOCK;
+        return;
+    }
+    current = block;
+    // Locals declared on only some of the paths here are out of scope, and so never read
+    for (std::vector<ValueId>& values : incoming) { values.resize(variableTypes.size(), NO_VALUE); }
+    definitions = std::move(incoming[0]);
+    for (uint32_t variable = 0; variable < definitions.size(); ++variable) {
+        ValueId& value = definitions[variable];
+        bool isMerged = false;
+        for (size_t i = 1; i < incoming.size() && value != NO_VALUE; ++i) {
+            const ValueId other = incoming[i][variable];
+            if (other == NO_VALUE) {
+                value = NO_VALUE;
+            } else {
+                isMerged = isMerged || other != value;
+            }
+        }
+        if (!isMerged || value == NO_VALUE) { continue; }
+        Instruction phi{.opcode = Opcode::Phi, .type = variableTypes[variable]};
+        phi.operands.push_back(value);
+        for (size_t i = 1; i < incoming.size(); ++i) { phi.operands.push_back(incoming[i][variable]); }
+        value = emit(std::move(phi));
+    }
+}
+
+void Builder::enterHeader(BlockId block) {
+    BlockState& state = states[block];
+    std::vector<std::vector<ValueId>> incoming = std::move(state.incoming);
+    state.isEntered = true;
+    if (incoming.empty()) {
+        function.removeBlock(block);
+        current = NO_BLOCK;
+        return;
+    }
+    current = block;
+    for (std::vector<ValueId>& values : incoming) { values.resize(variableTypes.size(), NO_VALUE); }
+    definitions = incoming[0];
+    for (uint32_t variable = 0; variable < definitions.size(); ++variable) {
+        if (definitions[variable] == NO_VALUE) { continue; }
+        // Whether the loop changes it is only known once its back edges are, so every local gets a phi
+        Instruction phi{.opcode = Opcode::Phi, .type = variableTypes[variable]};
+        for (const std::vector<ValueId>& values : incoming) { phi.operands.push_back(values[variable]); }
+        definitions[variable] = emit(std::move(phi));
+        states[block].phis.emplace_back(variable, definitions[variable]);
+    }
+}
+
+uint32_t Builder::newVariable(const semantic::SemanticType* type, ValueId value) {
+    variableTypes.push_back(type);
+    definitions.resize(variableTypes.size(), NO_VALUE);
+    definitions.back() = value;
+    return static_cast<uint32_t>(variableTypes.size() - 1);
+}
+
+auto Builder::lookupLocal(std::string_view name) const noexcept -> const Local* {
+    for (auto it = locals.rbegin(); it != locals.rend(); ++it) {
+        if (it->name == name) { return &*it; }
+    }
+    return nullptr;
+}
+
+ValueId Builder::convert(ValueId value, const semantic::SemanticType* to, const ast::ASTNode* node) {
+    const semantic::SemanticType* from = function.instructions[value].type;
+    if (from == to) { return value; }
+    if (!isConvertible(from, to)) { return NO_VALUE; }
+    return emit(Instruction{.opcode = Opcode::Convert, .type = to, .operands = {value}, .node = node});
+}
+
+ValueId Builder::lowerCondition(ast::Expression* condition) {
+    const ValueId value = lower(condition);
+    if (value == NO_VALUE) { return NO_VALUE; }
+    const semantic::SemanticType* type = function.instructions[value].type;
+    if (!type || !(type->isPrimitive() || type->isPointer())) {
+        logError(condition, "'{}' can't be used as a condition", condition->toString());
+        return NO_VALUE;
+    }
+    return value;
+}
+
+ValueId Builder::load(const Place& place, const semantic::SemanticType* type, const ast::ASTNode* node) {
+    if (place.local && place.local->slot == NO_VALUE) { return definitions[place.local->variable]; }
+    const ValueId address = place.local ? place.local->slot : place.address;
+    return emit(Instruction{.opcode = Opcode::Load, .type = type, .operands = {address}, .node = node});
+}
+
+void Builder::store(const Place& place, ValueId value, const ast::ASTNode* node) {
+    if (place.local && place.local->slot == NO_VALUE) {
+        definitions[place.local->variable] = value;
+        return;
+    }
+    const ValueId address = place.local ? place.local->slot : place.address;
+    DISCARD(emit(Instruction{.opcode = Opcode::Store, .operands = {address, value}, .node = node}));
+}
+
+Result Builder::visit(ast::Block& block) {
+    scopes.push_back(locals.size());
+    Result result = Result::Success;
+    for (ast::Statement* statement : block) {
+        if (current == NO_BLOCK) { break; }  // Whatever follows a return, break or continue can never run
+        if (visit(statement) == Result::Failure) { result = Result::Failure; }
+    }
+    locals.resize(scopes.back());
+    scopes.pop_back();
+    return result;
+}
+
+}  // namespace mir
+}  // namespace Manganese
@@ -0,0 +1,401 @@
+#include <backend/mir/mir_builder.hpp>
+#include <core.hpp>
+#include <cstdint>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_base.hpp>
+#include <frontend/lexer/token_type.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <mnstl/fold_result.hxx>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Manganese {
+namespace mir {
+
+namespace {
+
+/**
+ * @brief The type two operands are compared in: their own, if they agree, else the one that can hold both
+ * @details Floating point beats integers, and otherwise the wider type wins. The analyzer has already checked that
+ * the operands can be compared at all
+ */
+const semantic::SemanticType* comparisonType(const semantic::SemanticType* lhs, const semantic::SemanticType* rhs) {
+    if (lhs == rhs || !lhs->isPrimitive() || !rhs->isPrimitive()) { return lhs; }
+    const bool lhsIsFloat = semantic::isFloat(lhs->primitiveType), rhsIsFloat = semantic::isFloat(rhs->primitiveType);
+    if (lhsIsFloat != rhsIsFloat) { return lhsIsFloat ? lhs : rhs; }
+    // Primitive types are declared from narrowest to widest
+    return static_cast<uint8_t>(lhs->primitiveType) >= static_cast<uint8_t>(rhs->primitiveType) ? lhs : rhs;
+}
+
+// The arithmetic operator a compound assignment applies, or the assignment itself
+constexpr lexer::TokenType arithmeticOperatorOf(lexer::TokenType op) noexcept {
+    using enum lexer::TokenType;
+    switch (op) {
+        case PlusAssign: return Plus;
+        case MinusAssign: return Minus;
+        case MulAssign: return Mul;
+        case DivAssign: return Div;
+        case FloorDivAssign: return FloorDiv;
+        case ModAssign: return Mod;
+        case BitAndAssign: return BitAnd;
+        case BitOrAssign: return BitOr;
+        case BitXorAssign: return BitXor;
+        case BitLShiftAssign: return BitLShift;
+        case BitRShiftAssign: return BitRShift;
+        default: return op;
+    }
+}
+
+constexpr bool isLowerableArithmetic(lexer::TokenType op) noexcept {
+    using enum lexer::TokenType;
+    return semantic::isArithmeticOp(op)
+        || mnstl::enum_matches<lexer::TokenType>(op, BitAnd, BitOr, BitXor, BitLShift, BitRShift);
+}
+
+}  // namespace
+
+ValueId Builder::lower(ast::Expression* expression) {
+    // Reuse the value folding already computed, rather than lowering the operators that make it up. Folding gives an
+    // error for what would trap or overflow (e.g. dividing the smallest value by -1), which is left for run time
+    const mnstl::fold_result_t& folded = expression->fold();
+    if (folded.has_value()) {
+        const mnstl::fold_result_t value = castConstant(folded, expression->semanticType);
+        if (value.has_value()) { return constant(value, expression->semanticType, expression); }
+    }
+    return visit(expression);
+}
+
+auto Builder::placeOf(ast::Expression* expression) -> std::optional<Place> {
+    if (expression->kind == ast::ExpressionKind::IdentifierExpression) {
+        const std::string& name = static_cast<ast::IdentifierExpression*>(expression)->value;
+        if (const Local* local = lookupLocal(name)) { return Place{.local = local, .address = NO_VALUE}; }
+        logError(expression, "Code generation for assigning to '{}' is not supported yet (only locals are)", name);
+        return std::nullopt;
+    }
+    if (expression->kind == ast::ExpressionKind::PrefixExpression) {
+        auto* prefix = static_cast<ast::PrefixExpression*>(expression);
+        if (prefix->op == lexer::TokenType::Dereference) {
+            const ValueId address = lower(prefix->right);
+            if (address == NO_VALUE) { return std::nullopt; }
+            return Place{.local = nullptr, .address = address};
+        }
+    }
+    DISCARD(unsupported(expression, "assigning to this kind of expression"));
+    return std::nullopt;
+}
+
+std::pair<ValueId, ValueId> Builder::step(ast::Expression* place, lexer::TokenType op, const ast::Expression* node) {
+    const std::optional<Place> target = placeOf(place);
+    if (!target) { return {NO_VALUE, NO_VALUE}; }
+    const semantic::SemanticType* type = node->semanticType;
+    if (!type || !type->isPrimitive() || !semantic::isNumeric(type->primitiveType)) {
+        DISCARD(unsupported(node, std::format("'{}' on '{}'", lexer::tokenTypeToString(op),
+                                              type ? type->toString() : place->toString())));
+        return {NO_VALUE, NO_VALUE};
+    }
+    const ValueId old = load(*target, type, node);
+    const ValueId one = constant(mnstl::fold_result_t{mnstl::number_t{int32_t{1}}}, type, node);
+    const ValueId updated = emit(Instruction{.opcode = Opcode::Binary,
+                                             .operation = op == lexer::TokenType::Inc ? lexer::TokenType::Plus
+                                                                                       : lexer::TokenType::Minus,
+                                             .type = type,
+                                             .operands = {old, one},
+                                             .node = node});
+    store(*target, updated, node);
+    return {old, updated};
+}
+
+ValueId Builder::lowerComparison(ast::BinaryExpression* expression) {
+    ValueId lhs = lower(expression->left);
+    ValueId rhs = lower(expression->right);
+    if (lhs == NO_VALUE || rhs == NO_VALUE) { return NO_VALUE; }
+    const semantic::SemanticType* type
+        = comparisonType(expression->left->semanticType, expression->right->semanticType);
+    lhs = convert(lhs, type, expression);
+    rhs = convert(rhs, type, expression);
+    if (lhs == NO_VALUE || rhs == NO_VALUE) {
+        logError(expression, "Cannot compare '{}' and '{}'", expression->left->semanticType->toString(),
+                 expression->right->semanticType->toString());
+        return NO_VALUE;
+    }
+    return emit(Instruction{.opcode = Opcode::Binary,
+                            .operation = expression->op,
+                            .type = expression->semanticType,
+                            .operands = {lhs, rhs},
+                            .node = expression});
+}
+
+ValueId Builder::lowerShortCircuit(ast::BinaryExpression* expression) {
+    const bool isAnd = expression->op == lexer::TokenType::And;
+    const semantic::SemanticType* type = expression->semanticType;
+    const ValueId lhs = lowerCondition(expression->left);
+    if (lhs == NO_VALUE) { return NO_VALUE; }
+    // The value when the left operand decides the result
+    const ValueId decided = constant(mnstl::fold_result_t{!isAnd}, type, expression);
+    if (decided == NO_VALUE) { return NO_VALUE; }
+    const BlockId rhsBlock = newBlock(isAnd ? "and.rhs" : "or.rhs");
+    const BlockId end = newBlock(isAnd ? "and.end" : "or.end");
+    // The right operand is only evaluated if the left one doesn't decide the result
+    branch(lhs, isAnd ? rhsBlock : end, isAnd ? end : rhsBlock, expression);
+
+    enter(rhsBlock);
+    ValueId rhs = lowerCondition(expression->right);
+    if (rhs == NO_VALUE) { return NO_VALUE; }
+    rhs = convert(rhs, type, expression);
+    if (rhs == NO_VALUE) {
+        logError(expression->right, "'{}' can't be used as a condition", expression->right->toString());
+        return NO_VALUE;
+    }
+    jump(end);
+
+    enter(end);  // Entered from the left operand's block first
+    return emit(Instruction{.opcode = Opcode::Phi, .type = type, .operands = {decided, rhs}, .node = expression});
+}
+
+auto Builder::visit(ast::AggregateInstantiationExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "aggregate instantiations"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::AggregateLiteralExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "aggregate literals"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::AlignofExpression* expression) -> exprvisit_t {
+    const std::optional<semantic::Layout> layout = semantic::layoutOf(expression->type->semanticType);
+    if (!layout) {
+        logError(expression, "'{}' has no layout to take the alignment of", expression->type->toString());
+        return NO_VALUE;
+    }
+    return constant(mnstl::fold_result_t{mnstl::number_t{layout->alignment}}, expression->semanticType,
+                    expression);
+}
+
+auto Builder::visit(ast::ArrayLiteralExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "array literals"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::AssignmentExpression* expression) -> exprvisit_t {
+    const std::optional<Place> place = placeOf(expression->assignee);
+    ValueId value = lower(expression->value);
+    if (!place || value == NO_VALUE) { return NO_VALUE; }
+    const semantic::SemanticType* type = expression->assignee->semanticType;
+    value = convert(value, type, expression);
+    if (value == NO_VALUE) {
+        logError(expression, "Cannot assign '{}' to '{}'", expression->value->toString(),
+                 expression->assignee->toString());
+        return NO_VALUE;
+    }
+
+    if (expression->op != lexer::TokenType::Assignment) {
+        const lexer::TokenType op = arithmeticOperatorOf(expression->op);
+        if (!type || !type->isPrimitive() || !isLowerableArithmetic(op)) {
+            DISCARD(
+                unsupported(expression, std::format("the operator '{}'", lexer::tokenTypeToString(expression->op))));
+            return NO_VALUE;
+        }
+        const ValueId previous = load(*place, type, expression);
+        value = emit(Instruction{.opcode = Opcode::Binary,
+                                 .operation = op,
+                                 .type = type,
+                                 .operands = {previous, value},
+                                 .node = expression});
+    }
+    store(*place, value, expression);
+    return value;
+}
+
+auto Builder::visit(ast::BinaryExpression* expression) -> exprvisit_t {
+    using enum lexer::TokenType;
+    if (expression->op == And || expression->op == Or) { return lowerShortCircuit(expression); }
+    if (semantic::isRelationalOp(expression->op)) { return lowerComparison(expression); }
+
+    ValueId lhs = lower(expression->left);
+    ValueId rhs = lower(expression->right);
+    if (lhs == NO_VALUE || rhs == NO_VALUE) { return NO_VALUE; }
+    const semantic::SemanticType* type = expression->semanticType;
+    if (!type || !type->isPrimitive()) {
+        DISCARD(unsupported(expression, std::format("arithmetic on '{}' and '{}'",
+                                                    expression->left->semanticType->toString(),
+                                                    expression->right->semanticType->toString())));
+        return NO_VALUE;
+    }
+    if (!isLowerableArithmetic(expression->op)) {
+        DISCARD(unsupported(expression, std::format("the operator '{}'", lexer::tokenTypeToString(expression->op))));
+        return NO_VALUE;
+    }
+    // Both operands are promoted to the type of the result
+    lhs = convert(lhs, type, expression);
+    rhs = convert(rhs, type, expression);
+    if (lhs == NO_VALUE || rhs == NO_VALUE) {
+        logError(expression, "Cannot convert the operands of '{}' to '{}'", expression->toString(), type->toString());
+        return NO_VALUE;
+    }
+    return emit(Instruction{.opcode = Opcode::Binary,
+                            .operation = expression->op,
+                            .type = type,
+                            .operands = {lhs, rhs},
+                            .node = expression});
+}
+
+auto Builder::visit(ast::BoolLiteralExpression* expression) -> exprvisit_t {
+    return constant(expression->fold(), expression->semanticType, expression);
+}
+
+auto Builder::visit(ast::CharLiteralExpression* expression) -> exprvisit_t {
+    return constant(expression->fold(), expression->semanticType, expression);
+}
+
+auto Builder::visit(ast::FunctionCallExpression* expression) -> exprvisit_t {
+    if (expression->callee->kind != ast::ExpressionKind::IdentifierExpression) {
+        DISCARD(unsupported(expression, "calls through expressions"));
+        return NO_VALUE;
+    }
+    const std::string& name = static_cast<ast::IdentifierExpression*>(expression->callee)->value;
+    auto callee = functions.find(name);
+    if (callee == functions.end()) {
+        DISCARD(unsupported(expression,
+                            std::format("calls to '{}' (only functions in this file can be called)", name)));
+        return NO_VALUE;
+    }
+
+    const ast::FunctionDeclarationStatement* declaration = callee->second;
+    const std::vector<ast::FunctionParameter>& parameters = declaration->parameters;
+    if (parameters.size() != expression->arguments.size()) {
+        logError(expression, "'{}' takes {} arguments, but was called with {}", name, parameters.size(),
+                 expression->arguments.size());
+        return NO_VALUE;
+    }
+    Instruction call{.opcode = Opcode::Call,
+                     .type = declaration->returnType ? declaration->returnType->semanticType : nullptr,
+                     .callee = declaration,
+                     .node = expression};
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        ast::Expression* argument = expression->arguments[i];
+        ValueId value = lower(argument);
+        if (value == NO_VALUE) { return NO_VALUE; }
+        value = convert(value, parameters[i].type->semanticType, argument);
+        if (value == NO_VALUE) {
+            logError(argument, "Cannot pass '{}' as parameter '{}' of '{}'", argument->toString(), parameters[i].name,
+                     name);
+            return NO_VALUE;
+        }
+        call.operands.push_back(value);
+    }
+    return emit(std::move(call));
+}
+
+auto Builder::visit(ast::GenericExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "generic expressions"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::IdentifierExpression* expression) -> exprvisit_t {
+    if (const Local* local = lookupLocal(expression->value)) {
+        return load(Place{.local = local, .address = NO_VALUE}, local->type, expression);
+    }
+    if (auto callee = functions.find(expression->value); callee != functions.end()) {
+        return emit(Instruction{.opcode = Opcode::Function,
+                                .type = expression->semanticType,
+                                .callee = callee->second,
+                                .node = expression});
+    }
+    DISCARD(unsupported(expression, std::format("'{}' (only locals and functions can be referred to)",
+                                                expression->value)));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::IndexExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "indexing"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::MemberAccessExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "member access"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::NumberLiteralExpression* expression) -> exprvisit_t {
+    return constant(expression->fold(), expression->semanticType, expression);
+}
+
+auto Builder::visit(ast::PostfixExpression* expression) -> exprvisit_t {
+    return step(expression->left, expression->op, expression).first;
+}
+
+auto Builder::visit(ast::PrefixExpression* expression) -> exprvisit_t {
+    using enum lexer::TokenType;
+    switch (expression->op) {
+        case Inc:
+        case Dec: return step(expression->right, expression->op, expression).second;
+        case AddressOf: {
+            const std::optional<Place> place = placeOf(expression->right);
+            if (!place) { return NO_VALUE; }
+            if (!place->local) { return place->address; }  // &*pointer
+            return emit(Instruction{.opcode = Opcode::AddressOf,
+                                    .type = expression->semanticType,
+                                    .operands = {place->local->slot},
+                                    .node = expression});
+        }
+        default: break;
+    }
+
+    const ValueId operand = lower(expression->right);
+    if (operand == NO_VALUE) { return NO_VALUE; }
+    switch (expression->op) {
+        case UnaryPlus: return operand;
+        case UnaryMinus:
+        case BitNot:
+        case Not:
+            return emit(Instruction{.opcode = Opcode::Unary,
+                                    .operation = expression->op,
+                                    .type = expression->semanticType,
+                                    .operands = {operand},
+                                    .node = expression});
+        case Dereference:
+            return emit(Instruction{
+                .opcode = Opcode::Load, .type = expression->semanticType, .operands = {operand}, .node = expression});
+        default: break;
+    }
+    DISCARD(unsupported(expression, std::format("the operator '{}'", lexer::tokenTypeToString(expression->op))));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::ScopeResolutionExpression* expression) -> exprvisit_t {
+    DISCARD(unsupported(expression, "members of other modules"));
+    return NO_VALUE;
+}
+
+auto Builder::visit(ast::SizeofExpression* expression) -> exprvisit_t {
+    const std::optional<semantic::Layout> layout = semantic::layoutOf(expression->type->semanticType);
+    if (!layout) {
+        logError(expression, "'{}' has no layout to take the size of", expression->type->toString());
+        return NO_VALUE;
+    }
+    return constant(mnstl::fold_result_t{mnstl::number_t{layout->size}}, expression->semanticType,
+                    expression);
+}
+
+auto Builder::visit(ast::StringLiteralExpression* expression) -> exprvisit_t {
+    return constant(mnstl::fold_result_t{std::string_view(expression->value)}, expression->semanticType, expression);
+}
+
+auto Builder::visit(ast::TypeCastExpression* expression) -> exprvisit_t {
+    const ValueId value = lower(expression->originalValue);
+    if (value == NO_VALUE) { return NO_VALUE; }
+    const ValueId converted = convert(value, expression->semanticType, expression);
+    if (converted == NO_VALUE) {
+        logError(expression, "Cannot cast '{}' to '{}'", expression->originalValue->toString(),
+                 expression->targetType->toString());
+    }
+    return converted;
+}
+
+}  // namespace mir
+}  // namespace Manganese
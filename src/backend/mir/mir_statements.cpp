@@ -0,0 +1,203 @@
+#include <backend/mir/mir_builder.hpp>
+#include <core.hpp>
+#include <frontend/ast.hpp>
+#include <utils/result.hpp>
+
+namespace Manganese {
+namespace mir {
+
+// Type declarations don't emit any code themselves: their types are lowered wherever they are used
+
+auto Builder::visit(ast::AggregateDeclarationStatement*) -> stmtvisit_t { return Result::Success; }
+auto Builder::visit(ast::AliasStatement*) -> stmtvisit_t { return Result::Success; }
+auto Builder::visit(ast::EnumDeclarationStatement*) -> stmtvisit_t { return Result::Success; }
+
+auto Builder::visit(ast::BreakStatement* statement) -> stmtvisit_t {
+    if (loops.empty()) { return unsupported(statement, "'break' outside of a loop"); }
+    jump(loops.back().breakTarget);
+    return Result::Success;
+}
+
+auto Builder::visit(ast::ContinueStatement* statement) -> stmtvisit_t {
+    if (loops.empty() || loops.back().continueTarget == NO_BLOCK) {
+        return unsupported(statement, "'continue' outside of a loop");
+    }
+    jump(loops.back().continueTarget);
+    return Result::Success;
+}
+
+auto Builder::visit(ast::EmptyStatement*) -> stmtvisit_t { return Result::Success; }
+
+auto Builder::visit(ast::ExpressionStatement* statement) -> stmtvisit_t {
+    return lower(statement->expression) != NO_VALUE ? Result::Success : Result::Failure;
+}
+
+auto Builder::visit(ast::ForLoopStatement* statement) -> stmtvisit_t {
+    Result result = Result::Success;
+    scopes.push_back(locals.size());  // The initialization step is only in scope in the loop
+    if (statement->initializationStep && visit(statement->initializationStep) == Result::Failure) {
+        result = Result::Failure;
+    }
+
+    const BlockId condition = newBlock("for.cond");
+    const BlockId body = newBlock("for.body");
+    const BlockId step = newBlock("for.step");
+    const BlockId end = newBlock("for.end");
+    jump(condition);
+
+    enterHeader(condition);
+    if (!statement->stopCondition) {
+        jump(body);
+    } else if (const ValueId test = lowerCondition(statement->stopCondition); test != NO_VALUE) {
+        branch(test, body, end, statement->stopCondition);
+    } else {
+        jump(end);
+        result = Result::Failure;
+    }
+
+    enter(body);
+    loops.push_back(Loop{.continueTarget = step, .breakTarget = end});
+    if (visit(statement->body) == Result::Failure) { result = Result::Failure; }
+    loops.pop_back();
+    jump(step);
+
+    enter(step);
+    if (statement->postExpression && current != NO_BLOCK && lower(statement->postExpression) == NO_VALUE) {
+        result = Result::Failure;
+    }
+    jump(condition);
+
+    enter(end);
+    locals.resize(scopes.back());
+    scopes.pop_back();
+    return result;
+}
+
+auto Builder::visit(ast::FunctionDeclarationStatement* statement) -> stmtvisit_t {
+    return unsupported(statement, "nested functions");
+}
+
+auto Builder::visit(ast::IfStatement* statement) -> stmtvisit_t {
+    Result result = Result::Success;
+    const BlockId end = newBlock("if.end");
+
+    // Each condition is tested in the block the previous one branches to when it is false
+    auto lowerBranch = [&](ast::Expression* condition, ast::Block& body) {
+        const ValueId test = lowerCondition(condition);
+        if (test == NO_VALUE) {
+            result = Result::Failure;
+            return;
+        }
+        const BlockId then = newBlock("if.then");
+        const BlockId otherwise = newBlock("if.else");
+        branch(test, then, otherwise, condition);
+        enter(then);
+        if (visit(body) == Result::Failure) { result = Result::Failure; }
+        jump(end);
+        enter(otherwise);
+    };
+    lowerBranch(statement->condition, statement->body);
+    for (ast::ElifClause& elif : statement->elifs) { lowerBranch(elif.condition, elif.body); }
+    if (visit(statement->elseBody) == Result::Failure) { result = Result::Failure; }
+    jump(end);
+
+    enter(end);  // Unreachable if every branch returns (or leaves a loop)
+    return result;
+}
+
+auto Builder::visit(ast::NestedBlockStatement* statement) -> stmtvisit_t { return visit(statement->block); }
+
+auto Builder::visit(ast::ReturnStatement* statement) -> stmtvisit_t {
+    if (!statement->value) {
+        terminate(Terminator{.kind = TerminatorKind::Return, .node = statement});
+        return Result::Success;
+    }
+    ValueId value = lower(statement->value);
+    if (value == NO_VALUE) { return Result::Failure; }
+    value = returnType ? convert(value, returnType, statement) : NO_VALUE;
+    if (value == NO_VALUE) {
+        logError(statement, "Cannot return '{}' from a function returning '{}'", statement->value->toString(),
+                 returnType ? returnType->toString() : "void");
+        return Result::Failure;
+    }
+    terminate(Terminator{.kind = TerminatorKind::Return, .value = value, .node = statement});
+    return Result::Success;
+}
+
+auto Builder::visit(ast::SwitchStatement* statement) -> stmtvisit_t {
+    const ValueId value = lower(statement->variable);
+    if (value == NO_VALUE) { return Result::Failure; }
+
+    // Each case leaves the switch at the end of its body (there is no fallthrough), as does a break
+    const BlockId end = newBlock("switch.end");
+    Terminator terminator{.kind = TerminatorKind::Switch, .value = value, .node = statement};
+    terminator.successors.push_back(statement->defaultBody.empty() ? end : newBlock("switch.default"));
+    for (const ast::CaseClause& clause : statement->cases) {
+        if (!clause.value.has_value()) {  // The analyzer reports a case that isn't a constant
+            logError(clause.literalValue, "Case value {} is not a constant", clause.literalValue->toString());
+            return Result::Failure;
+        }
+        terminator.cases.push_back(clause.value);
+        terminator.successors.push_back(newBlock("switch.case"));
+    }
+    const llvm::SmallVector<BlockId, 2> targets = terminator.successors;
+    terminate(std::move(terminator));
+
+    Result result = Result::Success;
+    loops.push_back(Loop{.continueTarget = loops.empty() ? NO_BLOCK : loops.back().continueTarget, .breakTarget = end});
+    auto lowerCase = [&](BlockId block, ast::Block& body) {
+        enter(block);
+        if (visit(body) == Result::Failure) { result = Result::Failure; }
+        jump(end);
+    };
+    for (size_t i = 0; i < statement->cases.size(); ++i) { lowerCase(targets[i + 1], statement->cases[i].body); }
+    if (!statement->defaultBody.empty()) { lowerCase(targets[0], statement->defaultBody); }
+    loops.pop_back();
+
+    enter(end);
+    return result;
+}
+
+auto Builder::visit(ast::VariableDeclarationStatement* statement) -> stmtvisit_t {
+    return unsupported(statement, "variable declarations");  // The analyzer doesn't type them yet
+}
+
+auto Builder::visit(ast::WhileLoopStatement* statement) -> stmtvisit_t {
+    Result result = Result::Success;
+    const BlockId condition = newBlock("while.cond");
+    const BlockId body = newBlock("while.body");
+    const BlockId end = newBlock("while.end");
+
+    // A do-while loop is entered at its body, so that is where the back edges meet the first iteration
+    auto lowerTest = [&] {
+        if (const ValueId test = lowerCondition(statement->condition); test != NO_VALUE) {
+            branch(test, body, end, statement->condition);
+        } else {
+            jump(end);
+            result = Result::Failure;
+        }
+    };
+    if (statement->isDoWhile) {
+        jump(body);
+        enterHeader(body);
+    } else {
+        jump(condition);
+        enterHeader(condition);
+        lowerTest();
+        enter(body);
+    }
+    loops.push_back(Loop{.continueTarget = condition, .breakTarget = end});
+    if (visit(statement->body) == Result::Failure) { result = Result::Failure; }
+    loops.pop_back();
+    jump(condition);
+
+    if (statement->isDoWhile) {
+        enter(condition);
+        if (current != NO_BLOCK) { lowerTest(); }
+    }
+    enter(end);
+    return result;
+}
+
+}  // namespace mir
+}  // namespace Manganese
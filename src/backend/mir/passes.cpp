@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <backend/mir/passes.hpp>
+#include <core.hpp>
+#include <cstdint>
+#include <frontend/ast.hpp>
+#include <frontend/lexer/token_type.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <mnstl/enum_matches.hxx>
+#include <mnstl/fold_result.hxx>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace mir {
+
+namespace {
+
+// How many bits values of a primitive type take (0 for those that aren't integers, characters or booleans)
+constexpr unsigned bitWidth(ast::PrimitiveType_t type) noexcept {
+    using enum ast::PrimitiveType_t;
+    switch (type) {
+        case boolean: return 1;
+        case i8:
+        case u8: return 8;
+        case i16:
+        case u16: return 16;
+        case i32:
+        case u32:
+        case character: return 32;
+        case i64:
+        case u64: return 64;
+        case i128:
+        case u128: return 128;
+        default: return 0;
+    }
+}
+
+// Whether two constants of the same type are the same value (never for floats, as 0.0 and -0.0 are equal but differ)
+bool isSameConstant(const mnstl::fold_result_t& left, const mnstl::fold_result_t& right) noexcept {
+    using held = enum mnstl::fold_result_t::held_type;
+    if (left.held_type() != right.held_type()) { return false; }
+    switch (left.held_type()) {
+        case held::Boolean: return left.boolean_unchecked() == right.boolean_unchecked();
+        case held::Character: return left.character_unchecked() == right.character_unchecked();
+        case held::Number: {
+            const mnstl::number_t l = left.number_unchecked(), r = right.number_unchecked();
+            return l.is_integer() && l.underlying_type() == r.underlying_type() && l == r;
+        }
+        case held::String:
+        case held::Void: break;
+    }
+    return false;
+}
+
+// Where a switch on an integer, character or boolean constant `value` goes, ordered as the values are
+uint64_t switchKey(const mnstl::fold_result_t& value) noexcept {
+    if (value.is_bool()) { return value.boolean_unchecked(); }
+    if (value.is_char()) { return static_cast<uint64_t>(value.character_unchecked()); }
+    const mnstl::number_t number = value.number_unchecked();
+    using held = mnstl::number_t::held_type;
+    if (mnstl::enum_matches<held>(number.underlying_type(), held::int8, held::int16, held::int32, held::int64)) {
+        // Biased, so negative values come before positive ones
+        return static_cast<uint64_t>(number.value_as<int64_t>()) ^ (uint64_t{1} << 63);
+    }
+    return number.value_as<uint64_t>();
+}
+
+class ConstantPropagator {
+   private:
+    Function& function;
+    bool isChanged = false;
+
+    const mnstl::fold_result_t* constantOf(ValueId value) noexcept {
+        value = function.resolve(value);
+        if (value == NO_VALUE || function.instructions[value].opcode != Opcode::Constant) { return nullptr; }
+        return &function.instructions[value].constant;
+    }
+
+    // Replace `value` with a constant (in the entry block, like every other constant)
+    void replaceWithConstant(ValueId value, mnstl::fold_result_t constant) {
+        const Instruction& instruction = function.instructions[value];
+        const ValueId replacement = function.add(0, Instruction{.opcode = Opcode::Constant,
+                                                                .type = instruction.type,
+                                                                .constant = std::move(constant),
+                                                                .node = instruction.node});
+        function.replace(value, replacement);
+        isChanged = true;
+    }
+
+    // The value of an operation on constants (nothing if any operand isn't one, or the result would be undefined)
+    mnstl::fold_result_t fold(const Instruction& instruction) noexcept {
+        switch (instruction.opcode) {
+            case Opcode::Unary: {
+                const mnstl::fold_result_t* operand = constantOf(instruction.operands[0]);
+                if (!operand) { break; }
+                return castConstant(ast::foldPrefixOperator(instruction.operation, *operand), instruction.type);
+            }
+            case Opcode::Binary: {
+                const mnstl::fold_result_t* lhs = constantOf(instruction.operands[0]);
+                const mnstl::fold_result_t* rhs = constantOf(instruction.operands[1]);
+                if (!lhs || !rhs || !isDefined(instruction, *rhs)) { break; }
+                return castConstant(ast::foldBinaryOperator(instruction.operation, *lhs, *rhs), instruction.type);
+            }
+            case Opcode::Convert: {
+                const mnstl::fold_result_t* operand = constantOf(instruction.operands[0]);
+                if (!operand) { break; }
+                return castConstant(*operand, instruction.type);
+            }
+            default: break;
+        }
+        return mnstl::fold_result_t{};
+    }
+
+    // Whether a binary operation with `rhs` as its right operand is defined for every left operand
+    bool isDefined(const Instruction& instruction, const mnstl::fold_result_t& rhs) noexcept {
+        if (!rhs.is_number() || !rhs.number_unchecked().is_integer()) { return true; }
+        const mnstl::number_t amount = rhs.number_unchecked();
+        using enum lexer::TokenType;
+        switch (instruction.operation) {
+            case Div:
+            case FloorDiv:
+            case Mod:
+                // Dividing the smallest signed value by -1 overflows
+                return !(amount == mnstl::number_t{int32_t{0}}) && !(amount == mnstl::number_t{int32_t{-1}});
+            case BitLShift:
+            case BitRShift: {
+                const semantic::SemanticType* type = instruction.type;
+                const unsigned width = type && type->isPrimitive() ? bitWidth(type->primitiveType) : 0;
+                return !(amount < mnstl::number_t{int32_t{0}}) && amount < mnstl::number_t{uint64_t{width}};
+            }
+            default: return true;
+        }
+    }
+
+    // The value a phi always has, if its operands are all the same (apart from itself), or the same constant
+    ValueId uniqueValueOf(ValueId phi) noexcept {
+        ValueId unique = NO_VALUE;
+        bool isUnique = true, isConstant = true;
+        for (ValueId operand : function.instructions[phi].operands) {
+            operand = function.resolve(operand);
+            if (operand == phi) { continue; }
+            if (operand == NO_VALUE) { return NO_VALUE; }  // Undefined along some edge
+            const mnstl::fold_result_t* value = constantOf(operand);
+            isConstant = isConstant && value;
+            if (unique == NO_VALUE) {
+                unique = operand;
+            } else if (operand != unique) {
+                isUnique = false;
+                isConstant = isConstant && isSameConstant(*value, function.instructions[unique].constant)
+                    && function.instructions[unique].type == function.instructions[operand].type;
+            }
+        }
+        return isUnique || isConstant ? unique : NO_VALUE;
+    }
+
+    // Turn a branch or switch on a constant into a jump to the block it always goes to
+    void foldTerminator(BlockId block) {
+        const Terminator& terminator = function.blocks[block].terminator;
+        if (terminator.kind != TerminatorKind::Branch && terminator.kind != TerminatorKind::Switch) { return; }
+        const mnstl::fold_result_t* value = constantOf(terminator.value);
+        if (!value) { return; }
+
+        BlockId target = terminator.successors[0];
+        if (terminator.kind == TerminatorKind::Branch) {
+            const mnstl::fold_result_t truth = ast::foldCast(*value, ast::PrimitiveType_t::boolean);
+            if (!truth.is_bool()) { return; }
+            target = terminator.successors[truth.boolean_unchecked() ? 0 : 1];
+        } else {
+            for (size_t i = 0; i < terminator.cases.size(); ++i) {
+                if (isSameConstant(*value, terminator.cases[i])) {
+                    target = terminator.successors[i + 1];
+                    break;
+                }
+            }
+        }
+        DISCARD(function.setTerminator(
+            block, Terminator{.kind = TerminatorKind::Jump, .successors = {target}, .node = terminator.node}));
+        isChanged = true;
+    }
+
+   public:
+    explicit ConstantPropagator(Function& _function) noexcept : function(_function) {}
+
+    bool run() {
+        for (BlockId block : function.reversePostorder()) {
+            // By index, since folding adds constants to the entry block
+            for (size_t i = 0; i < function.blocks[block].instructions.size(); ++i) {
+                const ValueId id = function.blocks[block].instructions[i];
+                const Instruction& instruction = function.instructions[id];
+                if (instruction.block == NO_BLOCK) { continue; }
+                if (instruction.opcode == Opcode::Phi) {
+                    if (const ValueId unique = uniqueValueOf(id); unique != NO_VALUE) {
+                        function.replace(id, unique);
+                        isChanged = true;
+                    }
+                    continue;
+                }
+                mnstl::fold_result_t value = fold(instruction);
+                if (value.has_value()) { replaceWithConstant(id, std::move(value)); }
+            }
+            foldTerminator(block);
+        }
+        return isChanged;
+    }
+};
+
+// Move `successor` (whose only predecessor is `block`, which only jumps to it) to the end of `block`
+void mergeBlocks(Function& function, BlockId block, BlockId successor) {
+    Block& merged = function.blocks[successor];
+    for (ValueId id : merged.instructions) {
+        Instruction& instruction = function.instructions[id];
+        if (instruction.block == NO_BLOCK) { continue; }
+        if (instruction.opcode == Opcode::Phi) {  // With one operand, from `block`
+            function.replace(id, instruction.operands[0]);
+            continue;
+        }
+        instruction.block = block;
+        function.blocks[block].instructions.push_back(id);
+    }
+    for (BlockId next : merged.terminator.successors) {
+        std::ranges::replace(function.blocks[next].predecessors, successor, block);
+    }
+    function.blocks[block].terminator = std::move(merged.terminator);
+    merged.instructions.clear();
+    merged.predecessors.clear();
+    merged.terminator = Terminator{};
+    merged.isRemoved = true;
+}
+
+}  // namespace
+
+bool propagateConstants(Function& function) { return ConstantPropagator(function).run(); }
+
+bool eliminateDeadCode(Function& function) {
+    bool isChanged = false;
+
+    const std::vector<BlockId> order = function.reversePostorder();
+    std::vector<uint8_t> isReachable(function.blocks.size(), false);
+    for (BlockId block : order) { isReachable[block] = true; }
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        if (function.blocks[block].isRemoved || isReachable[block]) { continue; }
+        function.removeBlock(block);
+        isChanged = true;
+    }
+
+    for (BlockId block : order) {
+        while (!function.blocks[block].isRemoved) {
+            const Terminator& terminator = function.blocks[block].terminator;
+            if (terminator.kind != TerminatorKind::Jump) { break; }
+            const BlockId successor = terminator.successors[0];
+            if (successor == block || successor == 0 || function.blocks[successor].predecessors.size() != 1) { break; }
+            mergeBlocks(function, block, successor);
+            isChanged = true;
+        }
+    }
+
+    // Mark what is used by something with an effect (a call, a store or a terminator), then remove the rest
+    std::vector<uint8_t> isLive(function.instructions.size(), false);
+    std::vector<ValueId> worklist;
+    auto markLive = [&](ValueId value) {
+        value = function.resolve(value);
+        if (value == NO_VALUE || isLive[value]) { return; }
+        isLive[value] = true;
+        worklist.push_back(value);
+    };
+    for (const Block& block : function.blocks) {
+        if (block.isRemoved) { continue; }
+        for (ValueId id : block.instructions) {
+            const Instruction& instruction = function.instructions[id];
+            if (instruction.block != NO_BLOCK
+                && (instruction.opcode == Opcode::Call || instruction.opcode == Opcode::Store)) {
+                markLive(id);
+            }
+        }
+        markLive(block.terminator.value);
+    }
+    while (!worklist.empty()) {
+        const ValueId value = worklist.back();
+        worklist.pop_back();
+        for (ValueId operand : function.instructions[value].operands) { markLive(operand); }
+    }
+    for (ValueId id = 0; id < function.instructions.size(); ++id) {
+        Instruction& instruction = function.instructions[id];
+        if (instruction.block == NO_BLOCK || isLive[id]) { continue; }
+        instruction.block = NO_BLOCK;
+        isChanged = true;
+    }
+    return isChanged;
+}
+
+void lowerSwitches(Function& function) {
+    std::vector<std::pair<uint64_t, size_t>> keys;  // Each case's key, by its index
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        const Terminator& terminator = function.blocks[block].terminator;
+        if (function.blocks[block].isRemoved || terminator.kind != TerminatorKind::Switch) { continue; }
+        if (terminator.cases.empty()) {
+            DISCARD(function.setTerminator(block, Terminator{.kind = TerminatorKind::Jump,
+                                                             .successors = {terminator.successors[0]},
+                                                             .node = terminator.node}));
+            continue;
+        }
+
+        const semantic::SemanticType* type = function.instructions[function.resolve(terminator.value)].type;
+        const unsigned width = type && type->isPrimitive() ? bitWidth(type->primitiveType) : 0;
+        if (width == 0 || width > 64 || terminator.cases.size() < MIN_JUMP_TABLE_CASES) { continue; }
+        keys.clear();
+        for (size_t i = 0; i < terminator.cases.size(); ++i) { keys.emplace_back(switchKey(terminator.cases[i]), i); }
+        std::ranges::sort(keys);
+        const uint64_t span = keys.back().first - keys.front().first;
+        if (span >= MAX_JUMP_TABLE_SIZE
+            || static_cast<double>(keys.size()) < MIN_JUMP_TABLE_DENSITY * static_cast<double>(span + 1)) {
+            continue;
+        }
+
+        // Every successor is already one, so no edges (or phi operands) change
+        Terminator table{.kind = TerminatorKind::JumpTable,
+                         .value = terminator.value,
+                         .successors = {},
+                         .cases = {terminator.cases[keys.front().second]},
+                         .node = terminator.node};
+        table.successors.assign(span + 2, terminator.successors[0]);
+        for (auto [key, index] : keys) {
+            table.successors[key - keys.front().first + 1] = terminator.successors[index + 1];
+        }
+        DISCARD(function.setTerminator(block, std::move(table)));
+    }
+}
+
+void optimize(Function& function) {
+    // Folding a branch can make code unreachable, and removing it can leave phis with only one value to fold
+    while (propagateConstants(function) | eliminateDeadCode(function)) { function.compact(); }
+    lowerSwitches(function);
+    function.compact();
+}
+
+}  // namespace mir
+}  // namespace Manganese
@@ -0,0 +1,169 @@
+#include <atomic>
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <driver/build_cache.hpp>
+#include <filesystem>
+#include <format>
+#include <frontend/semantic/module_interface.hpp>
+#include <fstream>
+#include <io/diagnostics.hpp>
+#include <iterator>
+#include <mnstl/content_hash.hxx>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else  // ^^ _WIN32 vv !_WIN32
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace Manganese {
+namespace driver {
+
+namespace {
+constexpr uint32_t MAGIC = 0x43424E4D;  // "MNBC" in the little-endian byte order
+// The magic number, format version, key (two words), result, and the sizes of the diagnostics and the interface
+constexpr size_t HEADER_SIZE = 28;
+
+void appendWord(std::string& out, uint32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+uint32_t readWord(std::string_view in, size_t offset) noexcept {
+    uint32_t value;
+    std::memcpy(&value, in.data() + offset, sizeof(value));
+    return value;
+}
+
+// Each diagnostic is its level, line, column and the size of its message (a word each), then the message. Only the
+// line and column are kept (see store()), since the source is gone by the time an entry is read
+constexpr size_t DIAGNOSTIC_HEADER_SIZE = 16;
+
+void appendDiagnostics(std::string& out, const logging::DiagnosticList& diagnostics) {
+    for (const logging::Diagnostic& diagnostic : diagnostics) {
+        appendWord(out, static_cast<uint32_t>(diagnostic.level));
+        appendWord(out, diagnostic.line);
+        appendWord(out, diagnostic.column);
+        appendWord(out, static_cast<uint32_t>(diagnostic.message.size()));
+        out.append(diagnostic.message);
+    }
+}
+
+std::optional<logging::DiagnosticList> readDiagnostics(std::string_view in) {
+    logging::DiagnosticList diagnostics;
+    for (size_t offset = 0; offset < in.size();) {
+        if (in.size() - offset < DIAGNOSTIC_HEADER_SIZE
+            || readWord(in, offset) > static_cast<uint32_t>(logging::LogLevel::Critical)) {
+            return std::nullopt;
+        }
+        const size_t size = readWord(in, offset + 12);
+        if (in.size() - offset - DIAGNOSTIC_HEADER_SIZE < size) { return std::nullopt; }
+        diagnostics.add({.level = static_cast<logging::LogLevel>(readWord(in, offset)),
+                         .location = {},
+                         .line = readWord(in, offset + 4),
+                         .column = readWord(in, offset + 8),
+                         .message = std::string(in.substr(offset + DIAGNOSTIC_HEADER_SIZE, size))});
+        offset += DIAGNOSTIC_HEADER_SIZE + size;
+    }
+    return diagnostics;
+}
+
+int processId() noexcept {
+#if defined(_WIN32)
+    return ::_getpid();
+#else  // ^^ _WIN32 vv !_WIN32
+    return static_cast<int>(::getpid());
+#endif  // _WIN32
+}
+}  // namespace
+
+bool writeAtomically(const std::filesystem::path& path, std::string_view contents) {
+    // Unique to this write, even among builds (i.e. processes) sharing the directory
+    static std::atomic<size_t> writes = 0;
+    const std::filesystem::path temporary = std::format("{}.{}-{}.tmp", path.string(), processId(),
+                                                        writes.fetch_add(1, std::memory_order_relaxed));
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!out) { return false; }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) { std::filesystem::remove(temporary, error); }
+    return !error;
+}
+
+BuildCache::BuildCache(const std::string& cacheDirectory) : directory(cacheDirectory) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+}
+
+std::filesystem::path BuildCache::entryPath(uint64_t key) const {
+    return directory / std::format("{:016x}{}", key, FILE_EXTENSION);
+}
+
+uint64_t BuildCache::key(uint64_t sourceHash) {
+    // Anything that changes what compiling a file produces (or how it is stored) goes into every key
+    static const std::string salt
+        = std::format("{}:{}:{}", COMPILER_VERSION, FORMAT_VERSION, semantic::ModuleInterface::VERSION);
+    return mnstl::content_hash(salt, sourceHash);
+}
+
+std::optional<BuildCache::Entry> BuildCache::lookup(uint64_t key) {
+    auto miss = [&]() -> std::optional<Entry> {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    };
+    std::ifstream in(entryPath(key), std::ios::binary);
+    if (!in) { return miss(); }
+    const std::string contents{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    const std::string_view bytes = contents;
+    if (bytes.size() < HEADER_SIZE || readWord(bytes, 0) != MAGIC || readWord(bytes, 4) != FORMAT_VERSION
+        || (readWord(bytes, 8) | (uint64_t{readWord(bytes, 12)} << 32)) != key || readWord(bytes, 16) > 1) {
+        return miss();
+    }
+    const uint64_t diagnosticsSize = readWord(bytes, 20), interfaceSize = readWord(bytes, 24);
+    if (HEADER_SIZE + diagnosticsSize + interfaceSize != bytes.size()) { return miss(); }
+
+    std::optional<logging::DiagnosticList> diagnostics = readDiagnostics(bytes.substr(HEADER_SIZE, diagnosticsSize));
+    if (!diagnostics) { return miss(); }
+    Entry entry{.result = readWord(bytes, 16) == 0 ? Result::Success : Result::Failure,
+                .diagnostics = std::move(*diagnostics),
+                .interface = std::nullopt};
+    if (interfaceSize != 0) {
+        const std::string_view interface = bytes.substr(HEADER_SIZE + diagnosticsSize);
+        entry.interface = semantic::ModuleInterface::fromBytes(std::vector<char>(interface.begin(), interface.end()));
+        if (!entry.interface) { return miss(); }
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+bool BuildCache::store(uint64_t key, Result result, const logging::DiagnosticList& diagnostics,
+                       const semantic::ModuleInterface* interface) {
+    const std::string_view encodedInterface = interface ? interface->data() : std::string_view();
+    std::string encodedDiagnostics;
+    appendDiagnostics(encodedDiagnostics, diagnostics);
+    std::string contents;
+    contents.reserve(HEADER_SIZE + encodedDiagnostics.size() + encodedInterface.size());
+    appendWord(contents, MAGIC);
+    appendWord(contents, FORMAT_VERSION);
+    appendWord(contents, static_cast<uint32_t>(key));
+    appendWord(contents, static_cast<uint32_t>(key >> 32));
+    appendWord(contents, result == Result::Success ? 0 : 1);
+    appendWord(contents, static_cast<uint32_t>(encodedDiagnostics.size()));
+    appendWord(contents, static_cast<uint32_t>(encodedInterface.size()));
+    contents.append(encodedDiagnostics);
+    contents.append(encodedInterface);
+
+    if (writeAtomically(entryPath(key), contents)) { return true; }
+    writeFailures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstddef>
+#include <driver/document.hpp>
+#include <frontend/ast.hpp>
+#include <frontend/ast/flat_ast.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <io/logging.hpp>
+#include <io/source_map.hpp>
+#include <mnstl/content_hash.hxx>
+#include <mnstl/string_pool.hxx>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+namespace {
+
+// The name a top-level statement declares, if any
+std::string_view declaredName(const ast::Statement* statement) noexcept {
+    using enum ast::StatementKind;
+    switch (statement->kind) {
+        case AggregateDeclarationStatement:
+            return static_cast<const ast::AggregateDeclarationStatement*>(statement)->name;
+        case AliasStatement: return static_cast<const ast::AliasStatement*>(statement)->alias;
+        case EnumDeclarationStatement: return static_cast<const ast::EnumDeclarationStatement*>(statement)->name;
+        case FunctionDeclarationStatement:
+            return static_cast<const ast::FunctionDeclarationStatement*>(statement)->name;
+        case VariableDeclarationStatement:
+            return static_cast<const ast::VariableDeclarationStatement*>(statement)->name;
+        default: return {};
+    }
+}
+
+// Move the locations in a statement's AST by `shift`, after the text before it changed without it being reparsed
+void relocate(ast::Statement* statement, ptrdiff_t shift) {
+    const ast::flat::Tree tree = ast::flat::Tree::build(*statement);
+    ast::flat::forEach(tree, [shift]<class Node>(ast::flat::NodeId, const Node& node) {
+        if constexpr (std::is_base_of_v<ast::ASTNode, Node>) {
+            io::SourceLocation location = node.getLocation();
+            if (!location.isValid()) { return; }
+            location.offset = static_cast<uint32_t>(static_cast<ptrdiff_t>(location.offset) + shift);
+            // The tree only views the nodes, which the document owns (and may change)
+            const_cast<Node&>(node).setLocation(location);
+        }
+    });
+}
+
+bool sharesAny(const std::vector<mnstl::string_pool::atom_t>& sorted,
+               const std::vector<mnstl::string_pool::atom_t>& names) noexcept {
+    return std::ranges::any_of(names, [&](mnstl::string_pool::atom_t name) {
+        return std::ranges::binary_search(sorted, name);
+    });
+}
+
+}  // namespace
+
+Document::Document(std::string source) :
+    text(std::move(source)), sourceId(io::sourceMap().addSource(text)), typeContext(typeArena) {
+    parseAll();
+    analyze();
+}
+
+Document::~Document() noexcept { io::sourceMap().remove(sourceId); }
+
+std::vector<Document::TopLevelStatement> Document::describe(std::span<const lexer::Token> tokens,
+                                                            const parser::ParsedFile& parsed,
+                                                            std::vector<parser::StatementDiagnostics>&& syntax,
+                                                            size_t end) const {
+    const std::vector<uint32_t>& offsets = parsed.statementOffsets;
+    std::vector<TopLevelStatement> described(parsed.program.size());
+    for (size_t i = 0; i < described.size(); ++i) {
+        TopLevelStatement& statement = described[i];
+        statement.syntax = std::move(syntax[i]);
+        const size_t next = i + 1 < offsets.size() ? offsets[i + 1] : end;
+        statement.hash = mnstl::content_hash(std::string_view(text).substr(offsets[i], next - offsets[i]));
+        const std::string_view name = declaredName(parsed.program[i]);
+        if (!name.empty()) { statement.declares.push_back(lexer::identifierPool().intern(name)); }
+    }
+
+    // Tokens before the first statement belong to the header, which nothing depends on by name
+    size_t current = 0;
+    for (const lexer::Token& token : tokens) {
+        const uint32_t offset = token.getLocation().offset;
+        if (described.empty() || offset < offsets[0]) { continue; }
+        while (current + 1 < offsets.size() && offset >= offsets[current + 1]) { ++current; }
+        switch (token.getType()) {
+            case lexer::TokenType::Identifier:
+                if (const mnstl::string_pool::atom_t atom = token.getAtom(); atom != mnstl::string_pool::invalid_atom) {
+                    described[current].references.push_back(atom);
+                }
+                break;
+            case lexer::TokenType::Import:
+            case lexer::TokenType::Module: described[current].isHeaderStatement = true; break;
+            default: break;
+        }
+    }
+    for (TopLevelStatement& statement : described) {
+        std::ranges::sort(statement.references);
+        const auto duplicates = std::ranges::unique(statement.references);
+        statement.references.erase(duplicates.begin(), duplicates.end());
+    }
+    return described;
+}
+
+void Document::parseAll() {
+    ++stats.fullParses;
+    // Nothing may point into the arena once it is reset
+    file = parser::ParsedFile{};
+    statements.clear();
+    astArena.reset();
+
+    lexer::Lexer lexer(text, sourceId, 0, text.size());
+    lexerDiagnostics.clear();
+    headerDiagnostics.clear();
+    std::vector<lexer::Token> tokens;
+    {
+        logging::DiagnosticCapture capture(lexerDiagnostics);
+        tokens = lexer.tokenizeAll();
+    }
+    std::vector<parser::StatementDiagnostics> syntax;
+    {
+        logging::DiagnosticCapture capture(headerDiagnostics);
+        parser::Parser parser(tokens, astArena);
+        parser.captureStatementDiagnostics(syntax);
+        headerHasError = parser.parseHeader().hasError;
+        file = parser.parse();
+    }
+    lexerHasError = lexer.hasError();
+    statements = describe(tokens, file, std::move(syntax), text.size());
+}
+
+bool Document::parseRange(size_t begin, size_t end, parser::ParsedFile& parsed,
+                          std::vector<TopLevelStatement>& parsedStatements) {
+    lexer::Lexer lexer(text, sourceId, begin, end);
+    logging::DiagnosticList lexed;
+    std::vector<lexer::Token> tokens;
+    {
+        logging::DiagnosticCapture capture(lexed);
+        tokens = lexer.tokenizeAll();
+    }
+    if (lexer.hasError() || !lexed.empty()) { return false; }
+
+    std::vector<parser::StatementDiagnostics> syntax;
+    parser::Parser parser(tokens, astArena);
+    parser.captureStatementDiagnostics(syntax);
+    parsed = parser.parseStatements();
+    parsedStatements = describe(tokens, parsed, std::move(syntax), end);
+    return true;
+}
+
+void Document::edit(const Edit& change) {
+    const std::vector<uint32_t>& offsets = file.statementOffsets;
+    const size_t oldSize = text.size();
+    const bool inHeader = offsets.empty() || change.offset < offsets.front();
+    text.replace(change.offset, change.length, change.text);
+    io::sourceMap().edit(sourceId, text, change.offset, change.length, change.text);
+    if (inHeader || !lexerDiagnostics.empty()) {
+        parseAll();
+        analyze();
+        return;
+    }
+
+    // The statements to reparse, as [first, last]: those the edit touches, the one before them, and any that didn't
+    // parse
+    auto containing = [&](size_t offset) {
+        return static_cast<size_t>(std::ranges::upper_bound(offsets, offset) - offsets.begin()) - 1;
+    };
+    size_t first = containing(change.offset), last = containing(change.offset + change.length);
+    first -= first > 0 ? 1 : 0;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        if (statements[i].syntax.hasError) {
+            first = std::min(first, i);
+            last = std::max(last, i);
+        }
+    }
+    const ptrdiff_t delta = static_cast<ptrdiff_t>(text.size()) - static_cast<ptrdiff_t>(oldSize);
+    const size_t begin = offsets[first];
+    const size_t oldEnd = last + 1 < offsets.size() ? offsets[last + 1] : oldSize;
+    const size_t end = static_cast<size_t>(static_cast<ptrdiff_t>(oldEnd) + delta);
+
+    parser::ParsedFile parsed;
+    std::vector<TopLevelStatement> reparsed;
+    const bool removesImports = std::ranges::any_of(statements.begin() + static_cast<ptrdiff_t>(first),
+                                                    statements.begin() + static_cast<ptrdiff_t>(last) + 1,
+                                                    &TopLevelStatement::isHeaderStatement);
+    if (removesImports || !parseRange(begin, end, parsed, reparsed)
+        || std::ranges::any_of(reparsed, &TopLevelStatement::isHeaderStatement)) {
+        parseAll();
+        analyze();
+        return;
+    }
+
+    // Reparsed statements at either end of the range whose text is the same as before keep their AST and checks
+    const size_t oldCount = last + 1 - first, newCount = reparsed.size();
+    size_t prefix = 0, suffix = 0;
+    while (prefix < std::min(oldCount, newCount) && reparsed[prefix].hash == statements[first + prefix].hash
+           && !reparsed[prefix].syntax.hasError) {
+        ++prefix;
+    }
+    while (suffix < std::min(oldCount, newCount) - prefix
+           && reparsed[newCount - 1 - suffix].hash == statements[last - suffix].hash
+           && !reparsed[newCount - 1 - suffix].syntax.hasError) {
+        ++suffix;
+    }
+    // A kept statement whose text moved has its AST relocated before the next analysis, and its diagnostics (which
+    // are still locations in the text) moved now
+    auto move = [](TopLevelStatement& statement, ptrdiff_t shift) {
+        statement.shift += shift;
+        statement.syntax.diagnostics.shift(shift);
+        statement.check.diagnostics.shift(shift);
+    };
+    auto moved = [&](size_t oldIndex, size_t newIndex) {
+        return static_cast<ptrdiff_t>(parsed.statementOffsets[newIndex]) - static_cast<ptrdiff_t>(offsets[oldIndex]);
+    };
+    for (size_t i = 0; i < prefix; ++i) {
+        parsed.program[i] = file.program[first + i];
+        reparsed[i] = std::move(statements[first + i]);
+        move(reparsed[i], moved(first + i, i));
+    }
+    for (size_t i = 0; i < suffix; ++i) {
+        parsed.program[newCount - 1 - i] = file.program[last - i];
+        reparsed[newCount - 1 - i] = std::move(statements[last - i]);
+        move(reparsed[newCount - 1 - i], moved(last - i, newCount - 1 - i));
+    }
+    const size_t changedBegin = first + prefix, oldChangedEnd = last + 1 - suffix;
+    stats.reparsedStatements += newCount - prefix - suffix;
+    stats.reusedStatements += statements.size() - (oldChangedEnd - changedBegin);
+
+    // Whatever the changed statements declare, or used to, may mean something else now
+    std::vector<mnstl::string_pool::atom_t> changedNames;
+    for (size_t i = changedBegin; i < oldChangedEnd; ++i) {
+        changedNames.insert(changedNames.end(), statements[i].declares.begin(), statements[i].declares.end());
+    }
+    for (size_t i = prefix; i < newCount - suffix; ++i) {
+        changedNames.insert(changedNames.end(), reparsed[i].declares.begin(), reparsed[i].declares.end());
+    }
+
+    // Splice the reparsed statements in, moving everything after them by the edit's length
+    auto splice = [&](auto& container, auto&& replacement) {
+        const auto at = container.begin() + static_cast<ptrdiff_t>(first);
+        container.erase(at, container.begin() + static_cast<ptrdiff_t>(last) + 1);
+        container.insert(container.begin() + static_cast<ptrdiff_t>(first),
+                         std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+    };
+    for (size_t i = last + 1; i < file.statementOffsets.size(); ++i) {
+        file.statementOffsets[i] = static_cast<uint32_t>(static_cast<ptrdiff_t>(file.statementOffsets[i]) + delta);
+        move(statements[i], delta);
+    }
+    splice(file.statementOffsets, parsed.statementOffsets);
+    splice(file.program, parsed.program);
+    splice(statements, reparsed);
+
+    const size_t newChangedEnd = changedBegin + (newCount - prefix - suffix);
+    for (size_t i = 0; i < statements.size(); ++i) {
+        if (i >= changedBegin && i < newChangedEnd) { continue; }  // Not checked yet
+        if (sharesAny(statements[i].references, changedNames)) { statements[i].check.isStale = true; }
+    }
+    analyze();
+}
+
+bool Document::hasSyntaxError() const noexcept {
+    return lexerHasError || headerHasError || std::ranges::any_of(statements, [](const TopLevelStatement& statement) {
+               return statement.syntax.hasError;
+           });
+}
+
+void Document::analyze() {
+    declarationDiagnostics.clear();
+    if (hasSyntaxError()) { return; }  // As for a whole compile, a program that didn't parse isn't analyzed
+
+    for (size_t i = 0; i < statements.size(); ++i) {
+        if (statements[i].shift != 0) {
+            relocate(file.program[i], statements[i].shift);
+            statements[i].shift = 0;
+        }
+    }
+    std::vector<semantic::StatementCheck> checks;
+    checks.reserve(statements.size());
+    for (size_t i = 0; i < statements.size(); ++i) {
+        if (file.program[i]->kind == ast::StatementKind::FunctionDeclarationStatement) {
+            ++(statements[i].check.isStale ? stats.checkedFunctions : stats.reusedChecks);
+        }
+        checks.push_back(std::move(statements[i].check));
+    }
+
+    analysisArena.reset();
+    {
+        logging::DiagnosticCapture capture(declarationDiagnostics);
+        semantic::analyzer analyzer(file, typeContext, analysisArena);
+        analysisResult = analyzer.analyze(checks);
+    }
+    for (size_t i = 0; i < statements.size(); ++i) { statements[i].check = std::move(checks[i]); }
+}
+
+logging::DiagnosticList Document::diagnostics() const {
+    logging::DiagnosticList diagnostics = lexerDiagnostics;
+    diagnostics.append(headerDiagnostics);
+    for (const TopLevelStatement& statement : statements) { diagnostics.append(statement.syntax.diagnostics); }
+    if (!hasSyntaxError()) {
+        diagnostics.append(declarationDiagnostics);
+        for (const TopLevelStatement& statement : statements) { diagnostics.append(statement.check.diagnostics); }
+    }
+    diagnostics.sort();
+    return diagnostics;
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <atomic>
+#include <backend/codegen/jit.hpp>
+#include <backend/codegen/object_emitter.hpp>
+#include <condition_variable>
+#include <core.hpp>
+#include <driver/build_cache.hpp>
+#include <driver/driver.hpp>
+#include <driver/linker.hpp>
+#include <driver/module_graph.hpp>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <frontend/parser.hpp>
+#include <frontend/semantic.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <io/logging.hpp>
+#include <io/mappedfilereader.hpp>
+#include <io/source_map.hpp>
+#include <iterator>
+#include <memory>
+#include <mnstl/chunk_allocator.hxx>
+#include <mnstl/content_hash.hxx>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utils/result.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+std::optional<uint64_t> interfaceHash(const std::string& path,
+                                      std::span<const semantic::ModuleInterface* const> imports) {
+    // Sorted by name, so the hash doesn't depend on the order the imports were found in
+    std::vector<const semantic::ModuleInterface*> sorted(imports.begin(), imports.end());
+    std::ranges::sort(sorted, {}, &semantic::ModuleInterface::moduleName);
+    std::string importHashes;
+    for (const semantic::ModuleInterface* imported : sorted) {
+        const uint64_t hash = imported->contentHash();
+        importHashes.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    }
+    const uint64_t seed = mnstl::content_hash(importHashes);
+
+    if (io::MappedFileReader::isMappable(path)) {
+        try {
+            const io::MappedFileReader file(path);
+            return mnstl::content_hash(file.view(), seed);
+        } catch (const std::runtime_error&) { return std::nullopt; }
+    }
+    // e.g. an empty file, which can't be mapped
+    std::ifstream file(path, std::ios::binary);
+    if (!file) { return std::nullopt; }
+    const std::string contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    return mnstl::content_hash(contents, seed);
+}
+
+FileResult compileFile(const std::string& path, mnstl::chunk_allocator& arena,
+                       std::span<const semantic::ModuleInterface* const> imports, std::optional<uint64_t> hash,
+                       const codegen::EmitOptions* emit) {
+    FileResult file{
+        .path = path, .diagnostics = {}, .result = Result::Success, .interface = std::nullopt, .code = {}};
+    const mnstl::chunk_allocator::marker start = arena.mark();
+    {
+        logging::DiagnosticCapture capture(file.diagnostics);
+        io::SourceScope sources;  // The file's diagnostics are resolved before it ends
+        try {
+            parser::Parser parser(path, lexer::Mode::File, arena);
+            parser::ParsedFile parsed = parser.parse();
+            // Don't analyze a program that didn't parse, since it would only pile more errors on top
+            if (parsed.hasError) {
+                file.result = Result::Failure;
+            } else {
+                semantic::analyzer analyzer(parsed, arena);
+                for (const parser::Import& import : parsed.imports) {
+                    if (import.path.size() != 1) { continue; }  // Submodules can't be resolved yet
+                    auto found = std::ranges::find(imports, std::string_view(import.path[0]),
+                                                   &semantic::ModuleInterface::moduleName);
+                    if (found == imports.end()) { continue; }
+                    analyzer.addImport(import.alias.empty() ? import.path[0] : import.alias, **found);
+                }
+                file.result = analyzer.analyze();
+
+                if (file.result == Result::Success && !parsed.moduleName.empty()) {
+                    if (!hash) { hash = interfaceHash(path, imports); }
+                    if (hash) {
+                        const std::vector<semantic::ExportedSymbol> exports = analyzer.exportedSymbols();
+                        file.interface = semantic::ModuleInterface::fromBytes(
+                            semantic::ModuleInterface::encode(parsed.moduleName, *hash, exports));
+                    }
+                }
+                // While the analyzer (which owns the types on the AST) is still alive
+                if (file.result == Result::Success && emit) {
+                    codegen::EmitOptions options = *emit;
+                    const std::string prefix = std::format("{}.{:016x}", parsed.moduleName.empty() ? "file"
+                                                                                                    : parsed.moduleName,
+                                                           mnstl::content_hash(path));
+                    options.privatePrefix = prefix;
+                    if (std::optional<std::vector<std::string>> code = codegen::emitCode(parsed, path, options)) {
+                        file.code = std::move(*code);
+                    } else {
+                        file.result = Result::Failure;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            // e.g. the file couldn't be opened
+            logging::reportError(e.what());
+            file.result = Result::Failure;
+        } catch (...) {
+            // A panic (which has already said what went wrong), so only record that this file is where it happened
+            logging::reportError("Internal compiler error");
+            file.result = Result::Failure;
+        }
+        file.diagnostics.resolve();  // Before the scope removes the sources the locations are in
+    }  // Everything in the arena must be gone before it is rewound
+    arena.rewind(start);
+    file.diagnostics.sort();
+    return file;
+}
+
+void printFileResult(const FileResult& file, std::ostream& output) {
+    if (file.diagnostics.empty()) { return; }
+    std::string text = std::format("{}In {}:{}\n", PINK, file.path, RESET);
+    file.diagnostics.render(text);
+    output.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void printResultsAsJson(std::span<const FileResult> results, std::ostream& output) {
+    std::string json = R"({"files": [)";
+    for (size_t i = 0; i < results.size(); ++i) {
+        json += i ? ",\n" : "\n";
+        json += R"({"path": )";
+        logging::appendJsonString(json, results[i].path);
+        json += std::format(R"(, "result": "{}", "diagnostics": )",
+                            results[i].result == Result::Success ? "success" : "failure");
+        results[i].diagnostics.render(json, logging::DiagnosticFormat::Json);
+        json += '}';
+    }
+    json += "\n]}\n";
+    output.write(json.data(), static_cast<std::streamsize>(json.size()));
+}
+
+size_t Driver::jobCount() const noexcept {
+    return options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+}
+
+size_t Driver::workerCount() const noexcept { return std::min(jobCount(), std::max(options.inputs.size(), size_t{1})); }
+
+namespace {
+
+// Run `work(arena)` on `workers` threads (this one included), each with its own arena drawn from `pool`
+template <class Work>
+void runWorkers(size_t workers, mnstl::chunk_pool& pool, Work&& work) {
+    auto worker = [&]() {
+        mnstl::chunk_allocator arena(pool);
+        work(arena);
+    };
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(workers - 1);
+        for (size_t i = 0; i + 1 < workers; ++i) { threads.emplace_back(worker); }
+        worker();
+    }  // Join the workers
+}
+
+// Parse just the header of `path`, failing the file (with the header's diagnostics) if it is malformed
+FileResult scanHeader(const std::string& path, mnstl::chunk_allocator& arena, parser::FileHeader& header) {
+    trace::Scope scope("header scan", path);
+    FileResult file{
+        .path = path, .diagnostics = {}, .result = Result::Success, .interface = std::nullopt, .code = {}};
+    logging::DiagnosticList diagnostics;
+    const mnstl::chunk_allocator::marker start = arena.mark();
+    {
+        logging::DiagnosticCapture capture(diagnostics);
+        io::SourceScope sources;
+        try {
+            // Only the header is lexed, so scanning every input costs next to nothing however big the files are
+            parser::Parser parser(path, lexer::Mode::FileHeader, arena);
+            header = parser.parseHeader();
+            if (header.hasError) { file.result = Result::Failure; }
+        } catch (const std::exception& e) {
+            logging::reportError(e.what());
+            file.result = Result::Failure;
+        } catch (...) {
+            logging::reportError("Internal compiler error");
+            file.result = Result::Failure;
+        }
+        diagnostics.resolve();
+    }
+    arena.rewind(start);
+    // A file whose header is fine reports everything (including any warnings about its header) when it is compiled
+    if (file.result == Result::Failure) {
+        diagnostics.sort();
+        file.diagnostics = std::move(diagnostics);
+    }
+    return file;
+}
+
+FileResult failedFile(const std::string& path, const std::string& message) {
+    FileResult file{
+        .path = path, .diagnostics = {}, .result = Result::Failure, .interface = std::nullopt, .code = {}};
+    file.diagnostics.add({.level = logging::LogLevel::Error,
+                          .location = {},
+                          .line = logging::NO_POSITION,
+                          .column = logging::NO_POSITION,
+                          .message = message});
+    return file;
+}
+
+std::string interfacePath(const std::string& directory, std::string_view module) {
+    return (std::filesystem::path(directory) / std::format("{}{}", module, semantic::ModuleInterface::FILE_EXTENSION))
+        .string();
+}
+
+}  // namespace
+
+FileResult Driver::compileInput(const std::string& path, const std::string& module, mnstl::chunk_allocator& arena,
+                                std::span<const semantic::ModuleInterface* const> imports) {
+    trace::Scope scope("compile", path);
+    // Files compiled at the same time share the threads between them
+    const codegen::EmitOptions emit{.format = options.run ? codegen::CodeFormat::Bitcode : codegen::CodeFormat::Object,
+                                    .level = options.optimization,
+                                    .threads = std::max(size_t{1}, jobCount() / workerCount()),
+                                    .privatePrefix = {}};
+    const codegen::EmitOptions* emitted = options.output.empty() && !options.run ? nullptr : &emit;
+    const bool publishes = !options.moduleDirectory.empty() && !module.empty();
+    const std::optional<uint64_t> hash = (cache || publishes) ? interfaceHash(path, imports) : std::nullopt;
+    // Nothing can be reused (or the file can't be read, which compiling it reports)
+    if (!hash) { return compileFile(path, arena, imports, std::nullopt, emitted); }
+
+    const std::string interface = publishes ? interfacePath(options.moduleDirectory, module) : std::string();
+    auto publish = [&](FileResult& file) {
+        if (!publishes || !file.interface) { return; }
+        std::optional<semantic::ModuleInterface> existing = semantic::ModuleInterface::open(interface);
+        if (existing && existing->data() == file.interface->data()) { return; }  // e.g. after a cache hit
+        existing.reset();
+        if (!writeAtomically(interface, file.interface->data())) {
+            file.diagnostics.add({.level = logging::LogLevel::Warning,
+                                  .location = {},
+                                  .line = logging::NO_POSITION,
+                                  .column = logging::NO_POSITION,
+                                  .message = std::format("Could not write the module interface '{}'", interface)});
+        }
+    };
+
+    // The cache replays everything the file reported, so it takes precedence over an up-to-date interface. Neither
+    // can stand in for a file whose native code is needed
+    const uint64_t key = cache ? BuildCache::key(*hash) : 0;
+    if (cache && !emitted) {
+        if (std::optional<BuildCache::Entry> entry = cache->lookup(key)) {
+            FileResult file{.path = path,
+                            .diagnostics = std::move(entry->diagnostics),
+                            .result = entry->result,
+                            .interface = std::move(entry->interface),
+                            .code = {}};
+            publish(file);
+            return file;
+        }
+    } else if (!emitted) {
+        std::optional<semantic::ModuleInterface> previous = semantic::ModuleInterface::open(interface);
+        if (previous && previous->moduleName() == module && previous->contentHash() == *hash) {
+            return FileResult{.path = path,
+                              .diagnostics = {},
+                              .result = Result::Success,
+                              .interface = std::move(previous),
+                              .code = {}};
+        }
+    }
+
+    FileResult file = compileFile(path, arena, imports, hash, emitted);
+    if (cache && !emitted) {  // What code generation reported would be replayed by builds that don't generate code
+        DISCARD(cache->store(key, file.result, file.diagnostics, file.interface ? &*file.interface : nullptr));
+    }
+    publish(file);
+    return file;
+}
+
+std::vector<FileResult> Driver::compile(std::ostream& output) {
+    const std::vector<std::string>& inputs = options.inputs;
+    const size_t count = inputs.size();
+    const size_t workers = workerCount();
+    std::vector<FileResult> results(count);
+
+    // Headers first, so the files can be ordered by what they import
+    std::vector<parser::FileHeader> headers(count);
+    std::atomic<size_t> nextHeader = 0;
+    runWorkers(workers, pool, [&](mnstl::chunk_allocator& arena) {
+        for (size_t i; (i = nextHeader.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            results[i] = scanHeader(inputs[i], arena, headers[i]);
+        }
+    });
+    const ModuleGraph graph(headers);
+
+    // Interfaces of imported modules that no input declares, so they must have been compiled by an earlier build: one
+    // handed to useInterfaces(), or else one found in the module directory
+    std::unordered_map<std::string_view, const semantic::ModuleInterface*> externalInterfaces;
+    std::vector<std::unique_ptr<semantic::ModuleInterface>> loadedInterfaces;
+    if (!options.moduleDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.moduleDirectory, error);  // Writing the interfaces reports failures
+    }
+    {
+        std::unordered_set<std::string_view> declared;
+        for (const parser::FileHeader& header : headers) { declared.insert(header.moduleName); }
+        for (const parser::FileHeader& header : headers) {
+            for (const parser::Import& import : header.imports) {
+                const std::string& module = import.path.front();
+                if (declared.contains(module) || externalInterfaces.contains(module)) { continue; }
+                auto known = std::ranges::find(knownInterfaces, std::string_view(module),
+                                               &semantic::ModuleInterface::moduleName);
+                if (known != knownInterfaces.end()) {
+                    externalInterfaces.emplace(module, *known);
+                    continue;
+                }
+                if (options.moduleDirectory.empty()) { continue; }
+                std::optional<semantic::ModuleInterface> interface =
+                    semantic::ModuleInterface::open(interfacePath(options.moduleDirectory, module));
+                if (interface && interface->moduleName() == module) {
+                    loadedInterfaces.push_back(std::make_unique<semantic::ModuleInterface>(std::move(*interface)));
+                    externalInterfaces.emplace(module, loadedInterfaces.back().get());
+                }
+            }
+        }
+    }
+    // The interfaces file `file` can import: those of the inputs it depends on (which are done by the time it is
+    // compiled, so are only read from here on), then any found in the module directory
+    auto importsOf = [&](size_t file) {
+        std::vector<const semantic::ModuleInterface*> imports;
+        for (size_t dependency : graph.dependencies(file)) {
+            if (results[dependency].interface) { imports.push_back(&*results[dependency].interface); }
+        }
+        for (const parser::Import& import : headers[file].imports) {
+            auto external = externalInterfaces.find(import.path.front());
+            if (external != externalInterfaces.end()) { imports.push_back(external->second); }
+        }
+        return imports;
+    };
+
+    // A file is ready once everything it imports is done. The rest of the state is guarded by `mutex`
+    std::mutex mutex;
+    std::condition_variable readyChanged;
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready;  // Earliest input first
+    std::vector<size_t> pending(count);  // How many of each file's imports aren't done yet
+    std::vector<size_t> failedImport(count, ModuleGraph::NO_FILE);  // An import of the file failed to compile
+    std::vector<uint8_t> done(count, false);  // Not vector<bool>, whose elements share words
+    size_t doneCount = 0, nextToPrint = 0;
+
+    // Once `file` is done, each dependent has one less import to wait for
+    auto release = [&](size_t file) {
+        ++doneCount;
+        for (size_t dependent : graph.dependents(file)) {
+            if (results[file].result == Result::Failure && failedImport[dependent] == ModuleGraph::NO_FILE) {
+                failedImport[dependent] = file;
+            }
+            if (--pending[dependent] == 0 && !done[dependent]) { ready.push(dependent); }
+        }
+    };
+    auto finish = [&](size_t file) {
+        done[file] = true;
+        release(file);
+    };
+    // Print every done file that is next in line, so output is in input order but doesn't wait for the whole build
+    const bool json = options.diagnosticFormat == logging::DiagnosticFormat::Json;
+    auto printDone = [&]() {
+        if (json) { return; }
+        for (; nextToPrint < count && done[nextToPrint]; ++nextToPrint) {
+            printFileResult(results[nextToPrint], output);
+        }
+    };
+
+    // Files that failed before they could be scheduled (a bad header, an import cycle, ...) are done already
+    for (size_t file = 0; file < count; ++file) {
+        pending[file] = graph.dependencies(file).size();
+        if (!graph.error(file).empty() && results[file].result == Result::Success) {
+            results[file] = failedFile(inputs[file], graph.error(file));
+        }
+    }
+    // They are all marked done before any is released, so none of them is made ready by another (e.g. the other
+    // module of a cycle of two), and compiled again
+    for (size_t file = 0; file < count; ++file) { done[file] = results[file].result == Result::Failure; }
+    for (size_t file = 0; file < count; ++file) {
+        if (done[file]) { release(file); }
+    }
+    for (size_t file = 0; file < count; ++file) {
+        if (!done[file] && graph.dependencies(file).empty()) { ready.push(file); }
+    }
+    printDone();
+
+    runWorkers(workers, pool, [&](mnstl::chunk_allocator& arena) {
+        std::unique_lock lock(mutex);
+        while (true) {
+            readyChanged.wait(lock, [&]() { return !ready.empty() || doneCount == count; });
+            if (ready.empty()) { return; }
+            const size_t file = ready.top();
+            ready.pop();
+            const size_t failed = failedImport[file];
+
+            lock.unlock();
+            if (failed == ModuleGraph::NO_FILE) {
+                const std::vector<const semantic::ModuleInterface*> imports = importsOf(file);
+                results[file] = compileInput(inputs[file], headers[file].moduleName, arena, imports);
+            } else {
+                const std::string& module = headers[failed].moduleName;
+                results[file] = failedFile(inputs[file], std::format("Not compiled, since the module '{}' it imports "
+                                                                     "failed to compile", module));
+            }
+            lock.lock();
+
+            finish(file);
+            printDone();
+            readyChanged.notify_all();  // Dependents may be ready now, or everything may be done
+        }
+    });
+    if (json) { printResultsAsJson(results, output); }
+    return results;
+}
+
+int Driver::run(std::ostream& output) {
+    const std::vector<FileResult> results = compile(output);
+    const int exitCode = summarize(results, output);
+    if (exitCode != 0) { return exitCode; }
+    if (options.run) {
+        std::vector<std::string> modules;
+        for (const FileResult& file : results) { modules.insert(modules.end(), file.code.begin(), file.code.end()); }
+        std::optional<int> status;
+        {
+            logging::DiagnosticCapture capture(output);  // Whatever stops the program from starting
+            status = codegen::runMain(modules, options.optimization);
+        }
+        return status.value_or(1);
+    }
+    return link(results, output) == Result::Failure ? 1 : 0;
+}
+
+Result Driver::link(const std::vector<FileResult>& results, std::ostream& output) const {
+    if (options.output.empty()) { return Result::Success; }
+    std::vector<std::string> objects;
+    for (const FileResult& file : results) { objects.insert(objects.end(), file.code.begin(), file.code.end()); }
+    return linkExecutable(objects, options.output, output);
+}
+
+int Driver::summarize(const std::vector<FileResult>& results, std::ostream& output) const {
+    const size_t failures = static_cast<size_t>(
+        std::ranges::count(results, Result::Failure, &FileResult::result));
+    if (options.diagnosticFormat == logging::DiagnosticFormat::Json) { return failures == 0 ? 0 : 1; }
+    if (cache) {
+        const BuildCache::Statistics statistics = cache->statistics();
+        output << std::format("Build cache: {} hits, {} misses\n", statistics.hits, statistics.misses);
+        if (statistics.writeFailures != 0) {
+            output << std::format("{}Warning: {} cache entries could not be written{}\n", YELLOW,
+                                  statistics.writeFailures, RESET);
+        }
+    }
+    if (failures == 0) { return 0; }
+    output << RED << failures << " of " << results.size() << " file" << (results.size() == 1 ? "" : "s")
+           << " failed to compile" << RESET << '\n';
+    return 1;
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -0,0 +1,91 @@
+#include <atomic>
+#include <core.hpp>
+#include <cstdlib>
+#include <driver/linker.hpp>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <io/logging.hpp>
+#include <ostream>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utils/result.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif  // !_WIN32
+
+namespace Manganese {
+namespace driver {
+
+namespace {
+
+void reportLinkError(std::ostream& diagnostics, const std::string& message) {
+    diagnostics << RED << "Error: " << message << RESET << '\n';
+}
+
+}  // namespace
+
+Result linkExecutable(std::span<const std::string> objects, const std::string& output, std::ostream& diagnostics) {
+    trace::Scope scope("link", output);
+#if defined(_WIN32)
+    DISCARD(objects);
+    reportLinkError(diagnostics, std::format("Linking '{}' isn't supported on this platform yet", output));
+    return Result::Failure;
+#else
+    // Unique to this link, even if a server links several builds at once
+    static std::atomic<size_t> links = 0;
+    std::error_code error;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(error)
+        / std::format("manganese-link-{}-{}", ::getpid(), links.fetch_add(1, std::memory_order_relaxed));
+    if (error || !std::filesystem::create_directories(directory, error)) {
+        reportLinkError(diagnostics, "Could not create a directory for the objects to link");
+        return Result::Failure;
+    }
+
+    std::vector<std::string> paths;
+    paths.reserve(objects.size());
+    for (const std::string& object : objects) {
+        paths.push_back((directory / std::format("{}.o", paths.size())).string());
+        std::ofstream file(paths.back(), std::ios::binary);
+        if (!file.write(object.data(), static_cast<std::streamsize>(object.size()))) {
+            reportLinkError(diagnostics, std::format("Could not write the object file '{}'", paths.back()));
+            std::filesystem::remove_all(directory, error);
+            return Result::Failure;
+        }
+    }
+
+    const char* compiler = std::getenv("CC");
+    const std::string linker = compiler && *compiler ? compiler : "cc";
+    std::vector<const char*> arguments = {linker.c_str(), "-o", output.c_str()};
+    for (const std::string& path : paths) { arguments.push_back(path.c_str()); }
+    arguments.push_back(nullptr);
+
+    pid_t child = 0;
+    int status = 0;
+    // posix_spawn() takes the arguments as char* const*, though it doesn't modify them
+    const int spawned = ::posix_spawnp(&child, linker.c_str(), nullptr, nullptr,
+                                       const_cast<char* const*>(arguments.data()), environ);
+    const bool waited = spawned == 0 && ::waitpid(child, &status, 0) == child;
+    std::filesystem::remove_all(directory, error);
+    if (!waited) {
+        reportLinkError(diagnostics, std::format("Could not run the linker '{}'", linker));
+        return Result::Failure;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        reportLinkError(diagnostics, std::format("Linking '{}' failed", output));
+        return Result::Failure;
+    }
+    return Result::Success;
+#endif  // _WIN32
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstdint>
+#include <deque>
+#include <driver/module_graph.hpp>
+#include <format>
+#include <frontend/parser/parser_base.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace driver {
+
+ModuleGraph::ModuleGraph(std::span<const parser::FileHeader> headers) : nodes(headers.size()) {
+    std::unordered_map<std::string_view, size_t> modules;  // Module name -> the file that declares it
+    for (size_t file = 0; file < headers.size(); ++file) {
+        const std::string& name = headers[file].moduleName;
+        if (name.empty()) { continue; }
+        if (!modules.try_emplace(name, file).second) {
+            nodes[file].error = std::format("Module '{}' is already declared by an earlier input file", name);
+        }
+    }
+
+    for (size_t file = 0; file < headers.size(); ++file) {
+        std::vector<size_t>& dependencies = nodes[file].dependencies;
+        for (const parser::Import& import : headers[file].imports) {
+            if (import.path.empty()) { continue; }
+            auto it = modules.find(import.path.front());
+            if (it == modules.end() || std::ranges::find(dependencies, it->second) != dependencies.end()) { continue; }
+            dependencies.push_back(it->second);
+        }
+        std::ranges::sort(dependencies);
+        // Visiting files in order keeps every dependents list in input order too
+        for (size_t dependency : dependencies) { nodes[dependency].dependents.push_back(file); }
+    }
+    findCycles(headers);
+}
+
+void ModuleGraph::findCycles(std::span<const parser::FileHeader> headers) {
+    // Tarjan's strongly connected components, with an explicit stack so a long chain of imports can't overflow the
+    // call stack. Every component with more than one file (or a file that imports itself) is a cycle
+    const size_t count = nodes.size();
+    std::vector<size_t> order(count, NO_FILE), lowLink(count, 0);
+    std::vector<uint8_t> onStack(count, false);
+    std::vector<size_t> stack;
+    struct Frame {
+        size_t file;
+        size_t nextDependency;
+    };
+    std::vector<Frame> frames;
+    size_t visited = 0;
+
+    auto visit = [&](size_t file) {
+        order[file] = lowLink[file] = visited++;
+        stack.push_back(file);
+        onStack[file] = true;
+        frames.push_back(Frame{.file = file, .nextDependency = 0});
+    };
+    auto reportCycle = [&](std::span<const size_t> component) {
+        std::vector<uint8_t> inComponent(count, false);
+        for (size_t file : component) { inComponent[file] = true; }
+        // Find a shortest cycle back to the first file (by input order), to show how the imports loop
+        const size_t start = *std::ranges::min_element(component);
+        std::vector<size_t> parent(count, NO_FILE);
+        std::deque<size_t> queue{start};
+        size_t last = NO_FILE;
+        while (last == NO_FILE && !queue.empty()) {
+            const size_t file = queue.front();
+            queue.pop_front();
+            for (size_t dependency : nodes[file].dependencies) {
+                if (dependency == start) {
+                    last = file;
+                    break;
+                }
+                if (!inComponent[dependency] || parent[dependency] != NO_FILE) { continue; }
+                parent[dependency] = file;
+                queue.push_back(dependency);
+            }
+        }
+        std::vector<size_t> path{start};
+        for (size_t file = last; file != start; file = parent[file]) { path.insert(path.begin() + 1, file); }
+
+        std::string cycle;
+        for (size_t file : path) { cycle += std::format("{} -> ", headers[file].moduleName); }
+        cycle += headers[start].moduleName;
+        for (size_t file : component) {
+            nodes[file].error
+                = std::format("Module '{}' is part of an import cycle: {}", headers[file].moduleName, cycle);
+        }
+    };
+
+    std::vector<size_t> component;
+    for (size_t root = 0; root < count; ++root) {
+        if (order[root] != NO_FILE) { continue; }
+        visit(root);
+        while (!frames.empty()) {
+            Frame& frame = frames.back();
+            const size_t file = frame.file;
+            const std::vector<size_t>& dependencies = nodes[file].dependencies;
+            if (frame.nextDependency < dependencies.size()) {
+                const size_t dependency = dependencies[frame.nextDependency++];
+                if (order[dependency] == NO_FILE) {
+                    visit(dependency);  // Invalidates `frame`
+                } else if (onStack[dependency]) {
+                    lowLink[file] = std::min(lowLink[file], order[dependency]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) { lowLink[frames.back().file] = std::min(lowLink[frames.back().file], lowLink[file]); }
+            if (lowLink[file] != order[file]) { continue; }
+            // `file` is the first file of its component to be visited, so the component is everything above it
+            component.clear();
+            size_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                component.push_back(member);
+            } while (member != file);
+            const bool importsItself = std::ranges::binary_search(dependencies, file);
+            if (component.size() > 1 || importsItself) { reportCycle(component); }
+        }
+    }
+}
+
+std::vector<std::vector<size_t>> ModuleGraph::waves() const {
+    std::vector<size_t> pending(nodes.size());
+    std::vector<std::vector<size_t>> result;
+    std::vector<size_t> wave;
+    for (size_t file = 0; file < nodes.size(); ++file) {
+        pending[file] = nodes[file].dependencies.size();
+        if (pending[file] == 0 && nodes[file].error.empty()) { wave.push_back(file); }
+    }
+    while (!wave.empty()) {
+        std::vector<size_t> next;
+        for (size_t file : wave) {
+            for (size_t dependent : nodes[file].dependents) {
+                if (--pending[dependent] == 0 && nodes[dependent].error.empty()) { next.push_back(dependent); }
+            }
+        }
+        std::ranges::sort(next);
+        result.push_back(std::move(wave));
+        wave = std::move(next);
+    }
+    return result;
+}
+
+}  // namespace driver
+}  // namespace Manganese
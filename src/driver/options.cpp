@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <backend/codegen/optimizer.hpp>
+#include <charconv>
+#include <core.hpp>
+#include <driver/options.hpp>
+#include <format>
+#include <io/logging.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace Manganese {
+namespace driver {
+
+namespace {
+
+std::optional<size_t> parseJobCount(std::string_view text) {
+    size_t jobs = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), jobs);
+    if (text.empty() || error != std::errc{} || end != text.data() + text.size()) { return std::nullopt; }
+    return jobs;
+}
+
+void reportBadArgument(std::string_view message) { logging::reportError(std::string(message)); }
+
+struct PathFlag {
+    std::string_view name;
+    std::string Options::*path;
+    std::string_view expected;  // What the path is of
+};
+constexpr std::array<PathFlag, 3> pathFlags = {{
+    {.name = "--module-dir", .path = &Options::moduleDirectory, .expected = "a directory"},
+    {.name = "--cache-dir", .path = &Options::cacheDirectory, .expected = "a directory"},
+    {.name = "--trace", .path = &Options::trace, .expected = "a file"},
+}};
+
+}  // namespace
+
+std::optional<Options> parseArguments(std::span<const char* const> arguments) {
+    Options options;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        const std::string_view argument = arguments[i];
+        std::optional<std::string_view> jobs;
+        // Given as `--flag PATH` or `--flag=PATH`
+        const auto pathFlag = std::ranges::find_if(pathFlags, [&](const PathFlag& flag) {
+            return argument.starts_with(flag.name)
+                && (argument.size() == flag.name.size() || argument[flag.name.size()] == '=');
+        });
+        if (pathFlag != pathFlags.end()) {
+            if (argument.size() > pathFlag->name.size()) {
+                options.*pathFlag->path = argument.substr(pathFlag->name.size() + 1);
+            } else if (i + 1 < arguments.size()) {
+                options.*pathFlag->path = arguments[++i];
+            } else {
+                reportBadArgument(std::format("Expected {} after '{}'", pathFlag->expected, argument));
+                return std::nullopt;
+            }
+            continue;
+        }
+        if (argument == "-h" || argument == "--help") {
+            options.showHelp = true;
+            continue;
+        } else if (argument == "-o") {
+            if (i + 1 == arguments.size()) {
+                reportBadArgument("Expected a file after '-o'");
+                return std::nullopt;
+            }
+            options.output = arguments[++i];
+            continue;
+        } else if (argument.starts_with("-O")) {
+            std::optional<codegen::OptimizationLevel> level = codegen::parseOptimizationLevel(argument.substr(1));
+            if (!level) {
+                reportBadArgument(std::format("Unknown optimization level '{}' (expected -O0 to -O3)", argument));
+                return std::nullopt;
+            }
+            options.optimization = *level;
+            continue;
+        } else if (argument == "--run") {
+            options.run = true;
+            continue;
+        } else if (argument == "--time-report") {
+            options.timeReport = true;
+            continue;
+        } else if (argument.starts_with("--diagnostic-format")) {
+            constexpr std::string_view flag = "--diagnostic-format";
+            std::string_view format;
+            if (argument.size() > flag.size() && argument[flag.size()] == '=') {
+                format = argument.substr(flag.size() + 1);
+            } else if (argument.size() == flag.size() && i + 1 < arguments.size()) {
+                format = arguments[++i];
+            } else if (argument.size() != flag.size()) {
+                reportBadArgument(std::format("Unknown option '{}'", argument));
+                return std::nullopt;
+            }
+            if (format == "text") {
+                options.diagnosticFormat = logging::DiagnosticFormat::Text;
+            } else if (format == "json") {
+                options.diagnosticFormat = logging::DiagnosticFormat::Json;
+            } else {
+                reportBadArgument(std::format("Unknown diagnostic format '{}' (expected text or json)", format));
+                return std::nullopt;
+            }
+            continue;
+        } else if (argument == "--server" || argument.starts_with("--server=")) {
+            options.server = true;
+            options.serverSocket = argument.substr(std::min(argument.size(), std::string_view("--server=").size()));
+            continue;
+        } else if (argument == "-j" || argument == "--jobs") {
+            if (i + 1 == arguments.size()) {
+                reportBadArgument(std::format("Expected a number of jobs after '{}'", argument));
+                return std::nullopt;
+            }
+            jobs = arguments[++i];
+        } else if (argument.starts_with("--jobs=")) {
+            jobs = argument.substr(7);
+        } else if (argument.starts_with("-j")) {
+            jobs = argument.substr(2);
+        } else if (argument.starts_with('-') && argument.size() > 1) {
+            reportBadArgument(std::format("Unknown option '{}'", argument));
+            return std::nullopt;
+        } else {
+            options.inputs.emplace_back(argument);
+            continue;
+        }
+
+        std::optional<size_t> jobCount = parseJobCount(*jobs);
+        if (!jobCount) {
+            reportBadArgument(std::format("Invalid number of jobs '{}'", *jobs));
+            return std::nullopt;
+        }
+        options.jobs = *jobCount;
+    }
+    if (options.run && !options.output.empty()) {
+        reportBadArgument("A program can't be both run (--run) and linked (-o)");
+        return std::nullopt;
+    }
+    return options;
+}
+
+std::string usage(const char* programName) {
+    return std::format(
+        "Usage: {} [options] <files...>\n"
+        "Options:\n"
+        "  -j, --jobs <n>        Compile up to <n> files at once (default: 0, one per hardware thread)\n"
+        "  --module-dir <dir>    Write each module's interface to <dir>, and reuse the ones there that are up to\n"
+        "                        date instead of compiling those modules again\n"
+        "  --cache-dir <dir>     Keep a cache of compiled files in <dir>, so unchanged files aren't compiled again\n"
+        "  -o <file>             Compile the inputs to native code and link them into the executable <file>\n"
+        "  --run                 Compile the inputs in memory and run their main(), exiting with what it returns\n"
+        "  -O0, -O1, -O2, -O3    How much to optimize the code -o or --run generates (default: -O0)\n"
+        "  --time-report         Print how long each compiler phase took, and what it produced, once done\n"
+        "  --trace <file>        Write a timeline of each file's phases on each thread to <file>, to open in\n"
+        "                        chrome://tracing or Perfetto\n"
+        "  --diagnostic-format <text|json>\n"
+        "                        Write what compiling the inputs reports as text (the default), or as one JSON\n"
+        "                        document on standard output once every file is done\n"
+        "  --server[=<socket>]   Serve compile requests on standard input (or a Unix socket) until told to stop\n"
+        "  -h, --help            Show this message\n",
+        programName);
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <core.hpp>
+#include <driver/driver.hpp>
+#include <driver/options.hpp>
+#include <driver/server.hpp>
+#include <format>
+#include <frontend/parser.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <io/logging.hpp>
+#include <io/source_map.hpp>
+#include <iostream>
+#include <mnstl/chunk_allocator.hxx>
+#include <mnstl/chunk_pool.hxx>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/result.hpp>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif  // !_WIN32
+
+namespace Manganese {
+namespace driver {
+
+namespace {
+
+constexpr std::string_view SHUTDOWN = "--shutdown";
+
+std::vector<std::string> splitArguments(std::string_view request) {
+    std::vector<std::string> arguments;
+    for (size_t start = 0; start <= request.size();) {
+        const size_t end = std::min(request.find('\t', start), request.size());
+        if (end > start) { arguments.emplace_back(request.substr(start, end - start)); }
+        start = end + 1;
+    }
+    return arguments;
+}
+
+#if !defined(_WIN32)
+// Writing to a client that has hung up fails with EPIPE instead of raising SIGPIPE, which would end the server
+#if defined(MSG_NOSIGNAL)
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else  // ^^ MSG_NOSIGNAL vv !MSG_NOSIGNAL
+constexpr int SEND_FLAGS = 0;  // The socket is set to SO_NOSIGPIPE instead
+#endif  // MSG_NOSIGNAL
+
+// A stream buffer over a connected socket: reads go through a small buffer, and writes go straight to the socket
+class SocketBuffer final : public std::streambuf {
+   private:
+    int fd;
+    char input[4096];
+
+   protected:
+    int_type underflow() override {
+        ssize_t count;
+        do { count = ::read(fd, input, sizeof(input)); } while (count < 0 && errno == EINTR);
+        if (count <= 0) { return traits_type::eof(); }
+        setg(input, input, input + count);
+        return traits_type::to_int_type(input[0]);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        std::streamsize written = 0;
+        while (written < size) {
+            const ssize_t count = ::send(fd, data + written, static_cast<size_t>(size - written), SEND_FLAGS);
+            if (count < 0 && errno == EINTR) { continue; }
+            if (count <= 0) { break; }
+            written += count;
+        }
+        return written;
+    }
+
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) { return traits_type::not_eof(c); }
+        const char ch = traits_type::to_char_type(c);
+        return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+    }
+
+   public:
+    explicit SocketBuffer(int connection) noexcept : fd(connection) {
+#if defined(SO_NOSIGPIPE) && !defined(MSG_NOSIGNAL)
+        const int on = 1;
+        DISCARD(::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on)));
+#endif  // SO_NOSIGPIPE && !MSG_NOSIGNAL
+    }
+};
+#endif  // !_WIN32
+
+// The modules the file at `path` imports, or nothing if its header can't be read
+std::optional<std::vector<std::string>> importsOf(const std::string& path, mnstl::chunk_pool& pool) {
+    mnstl::chunk_allocator arena(pool);
+    logging::DiagnosticList diagnostics;  // The file has just been compiled, so this has nothing new to say
+    logging::DiagnosticCapture capture(diagnostics);
+    io::SourceScope sources;
+    try {
+        parser::Parser parser(path, lexer::Mode::FileHeader, arena);
+        const parser::FileHeader header = parser.parseHeader();
+        if (header.hasError) { return std::nullopt; }
+        std::vector<std::string> imports;
+        for (const parser::Import& import : header.imports) { imports.emplace_back(import.path.front()); }
+        return imports;
+    } catch (const std::exception&) { return std::nullopt; }
+}
+
+}  // namespace
+
+int Server::handle(std::string_view request, std::string& output) {
+    const std::vector<std::string> arguments = splitArguments(request);
+    std::vector<const char*> argumentPointers;
+    argumentPointers.reserve(arguments.size());
+    for (const std::string& argument : arguments) { argumentPointers.push_back(argument.c_str()); }
+
+    std::ostringstream stream;
+    std::optional<Options> options;
+    {
+        // parseArguments() reports malformed arguments like any diagnostic, so they go to the requester too
+        logging::DiagnosticCapture capture(stream);
+        options = parseArguments(argumentPointers);
+    }
+    if (!options || options->server || options->run || options->showHelp || options->inputs.empty()) {
+        if (options && options->server) {
+            stream << RED << "Error: A request can't start another server" << RESET << '\n';
+        }
+        if (options && options->run) {
+            // It would run in the server's process, taking the server down with it if it crashes
+            stream << RED << "Error: A request can't run a program (link it with -o instead)" << RESET << '\n';
+        }
+        stream << usage("manganese");
+        output = std::move(stream).str();
+        return options && options->showHelp && !options->server && !options->run ? 0 : 2;
+    }
+
+    dropStaleInterfaces();
+    std::vector<const semantic::ModuleInterface*> known;
+    known.reserve(interfaces.size());
+    for (const auto& [name, cached] : interfaces) { known.push_back(&cached.interface); }
+    Driver driver(std::move(*options), pool);
+    driver.useInterfaces(known);
+    std::vector<FileResult> results = driver.compile(stream);
+    int exitCode = driver.summarize(results, stream);
+    if (exitCode == 0 && driver.link(results, stream) == Result::Failure) { exitCode = 1; }
+
+    // Keep every interface this build produced, replacing older ones (which nothing refers to once the driver is gone)
+    for (FileResult& file : results) {
+        if (!file.interface) { continue; }
+        std::optional<std::vector<std::string>> imports = importsOf(file.path, pool);
+        if (!imports) { continue; }  // It can't be checked later
+        std::string name(file.interface->moduleName());
+        interfaces.insert_or_assign(std::move(name), CachedInterface{.interface = std::move(*file.interface),
+                                                                     .path = std::move(file.path),
+                                                                     .imports = std::move(*imports)});
+    }
+    output = std::move(stream).str();
+    return exitCode;
+}
+
+void Server::dropStaleInterfaces() {
+    // Dropping an interface changes the hash of those compiled against it, so go around until nothing is dropped
+    for (bool dropped = true; dropped;) {
+        dropped = false;
+        for (auto it = interfaces.begin(); it != interfaces.end();) {
+            std::vector<const semantic::ModuleInterface*> imports;
+            for (const std::string& module : it->second.imports) {
+                if (auto found = interfaces.find(module); found != interfaces.end()) {
+                    imports.push_back(&found->second.interface);
+                }
+            }
+            if (interfaceHash(it->second.path, imports) == it->second.interface.contentHash()) {
+                ++it;
+                continue;
+            }
+            it = interfaces.erase(it);
+            dropped = true;
+        }
+    }
+}
+
+bool Server::serve(std::istream& in, std::ostream& out) {
+    std::string request, output;
+    // A client that hangs up before its reply is written leaves `out` failed, which ends the session
+    while (!stopped && out && std::getline(in, request) && !request.empty()) {
+        if (request.back() == '\r') { request.pop_back(); }
+        int exitCode = 0;
+        if (request == SHUTDOWN) {
+            stopped = true;
+            output.clear();
+        } else {
+            exitCode = handle(request, output);
+        }
+        out << exitCode << ' ' << output.size() << '\n' << output;
+        out.flush();
+    }
+    return !stopped;
+}
+
+int Server::listen(const std::string& path) {
+#if defined(_WIN32)
+    std::cerr << RED << "Error: Serving on a socket isn't supported on this platform (serve on stdio instead)" << RESET
+              << '\n';
+    DISCARD(path);
+    return 1;
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << RED << "Error: The socket path '" << path << "' is too long" << RESET << '\n';
+        return 1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str());  // A socket left behind by a server that didn't shut down cleanly
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, 8) != 0) {
+        std::cerr << RED << "Error: Could not listen on '" << path << "': " << std::strerror(errno) << RESET << '\n';
+        if (listener >= 0) { ::close(listener); }
+        return 1;
+    }
+
+    while (!stopped) {
+        const int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR) { continue; }
+            break;
+        }
+        SocketBuffer buffer(connection);
+        std::iostream stream(&buffer);
+        DISCARD(serve(stream, stream));
+        ::close(connection);
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+    return stopped ? 0 : 1;
+#endif  // _WIN32
+}
+
+}  // namespace driver
+}  // namespace Manganese
@@ -1,73 +1,219 @@
+#include <compare>
 #include <core.hpp>
 #include <format>
 #include <frontend/ast/ast_expressions.hpp>
 #include <frontend/lexer/token_type.hpp>
 #include <mnstl/fold_result.hxx>
+#include <vector>
 
 namespace Manganese {
 namespace ast {
 
-mnstl::fold_result_t BinaryExpression::fold() const noexcept {
-    using enum lexer::TokenType;
-    mnstl::fold_result_t leftResult = left->fold();
-    mnstl::fold_result_t rightResult = right->fold();
+namespace {
+
+// Call `fn` on each operand whose value an expression's foldNode() reads
+template <class Fn>
+void forEachFoldOperand(const Expression* expression, Fn&& fn) {
+    switch (expression->kind) {
+        case ExpressionKind::BinaryExpression: {
+            const auto* binary = static_cast<const BinaryExpression*>(expression);
+            fn(binary->left);
+            fn(binary->right);
+            break;
+        }
+        case ExpressionKind::PrefixExpression: fn(static_cast<const PrefixExpression*>(expression)->right); break;
+        case ExpressionKind::PostfixExpression: fn(static_cast<const PostfixExpression*>(expression)->left); break;
+        default: break;  // Literals are their own values, and nothing else folds
+    }
+}
 
-    if (!leftResult.has_value() || rightResult.has_value()) { return mnstl::fold_result_t{}; }
+}  // namespace
 
-    switch (op) {
-        case Plus: break;
-        case Minus: break;
-        case Mul: break;
-        case Div: break;
-        case FloorDiv: break;
-        case Mod: break;
-        case GreaterThan: break;
-        case GreaterThanOrEqual: break;
-        case LessThan: break;
-        case LessThanOrEqual: break;
-        case Equal: break;
-        case NotEqual: break;
-        case And: break;
-        case Or: break;
-        case Not: break;
-        case BitAnd: break;
-        case BitOr: break;
-        case BitXor: break;
-        case BitLShift: break;
-        case BitRShift: break;
-        default: ASSERT_UNREACHABLE(std::format("Unknown binary operator {}", lexer::tokenTypeToString(op)));
+const mnstl::fold_result_t& Expression::fold() const noexcept {
+    if (_isFolded) { return _folded; }
+    // An explicit stack rather than recursion, so deeply nested expressions can't overflow the call stack.
+    // Operands are folded before the nodes that use them, so foldNode() only ever reads remembered values
+    thread_local std::vector<const Expression*> pending;
+    const size_t base = pending.size();  // fold() can be reentered from a foldNode()
+    pending.push_back(this);
+    while (pending.size() > base) {
+        const Expression* expression = pending.back();
+        if (expression->_isFolded) {
+            pending.pop_back();
+            continue;
+        }
+        bool operandsFolded = true;
+        forEachFoldOperand(expression, [&](const Expression* operand) {
+            if (operand && !operand->_isFolded) {
+                pending.push_back(operand);
+                operandsFolded = false;
+            }
+        });
+        if (!operandsFolded) { continue; }
+        expression->_folded = expression->foldNode();
+        expression->_isFolded = true;
+        pending.pop_back();
     }
-    return mnstl::fold_result_t{};
+    return _folded;
+}
+
+mnstl::fold_result_t BinaryExpression::foldNode() const noexcept {
+    const mnstl::fold_result_t& leftResult = left->fold();
+    const mnstl::fold_result_t& rightResult = right->fold();
+
+    if (!leftResult.has_value() || !rightResult.has_value()) { return mnstl::fold_result_t{}; }
+    return foldBinaryOperator(op, leftResult, rightResult);
+};
+
+mnstl::fold_result_t PrefixExpression::foldNode() const noexcept {
+    const mnstl::fold_result_t& result = right->fold();
+    if (!result.has_value()) { return mnstl::fold_result_t{}; }
+    return foldPrefixOperator(op, result);
 };
 
-mnstl::fold_result_t PrefixExpression::fold() const noexcept {
-    mnstl::fold_result_t result = right->fold();
+mnstl::fold_result_t PostfixExpression::foldNode() const noexcept {
+    const mnstl::fold_result_t& result = left->fold();
     if (!result.has_value()) { return mnstl::fold_result_t{}; }
 
     using enum lexer::TokenType;
     switch (op) {
-        case AddressOf:
-        case Dereference:
         case Inc:
-        case Dec:
-        case UnaryPlus:
-        case UnaryMinus:
-        case BitNot:
-        default: ASSERT_UNREACHABLE(std::format("Unknown prefix operator {}", lexer::tokenTypeToString(op)));
+        case Dec: break;  // A constant can't be incremented
+        default: ASSERT_UNREACHABLE(std::format("Unknown postfix operator {}", lexer::tokenTypeToString(op)));
     }
+    return mnstl::fold_result_t{};
 };
 
-mnstl::fold_result_t PostfixExpression::fold() const noexcept {
-    mnstl::fold_result_t result = left->fold();
-    if (!result.has_value()) { return mnstl::fold_result_t{}; }
+namespace {
+
+// Integer division truncates (as the generated code's does), where floor_div rounds towards negative infinity
+mnstl::number_t truncatingDivide(const mnstl::number_t& left, const mnstl::number_t& right) noexcept {
+    if (right == 0) { return mnstl::number_t{"Cannot divide by 0"}; }
+    // left - left % right is a multiple of right, so flooring the division doesn't round it
+    return (left - left % right).floor_div(right);
+}
 
+template <class T>
+mnstl::fold_result_t compare(lexer::TokenType op, const T& left, const T& right) noexcept {
     using enum lexer::TokenType;
+    const std::partial_ordering order = left <=> right;
     switch (op) {
-        case Inc:
-        case Dec:
-        default: ASSERT_UNREACHABLE(std::format("Unknown postfix operator {}", lexer::tokenTypeToString(op)));
+        case GreaterThan: return mnstl::fold_result_t{order > 0};
+        case GreaterThanOrEqual: return mnstl::fold_result_t{order >= 0};
+        case LessThan: return mnstl::fold_result_t{order < 0};
+        case LessThanOrEqual: return mnstl::fold_result_t{order <= 0};
+        case Equal: return mnstl::fold_result_t{order == 0};
+        case NotEqual: return mnstl::fold_result_t{order != 0};
+        default: return mnstl::fold_result_t{};
     }
-};
+}
+
+template <class T>
+mnstl::fold_result_t convertTo(const mnstl::fold_result_t& value) noexcept {
+    using held = enum mnstl::fold_result_t::held_type;
+    switch (value.held_type()) {
+        case held::Number: return mnstl::fold_result_t{mnstl::number_t{value.number_unchecked().value_as<T>()}};
+        case held::Boolean: return mnstl::fold_result_t{mnstl::number_t{static_cast<T>(value.boolean_unchecked())}};
+        case held::Character:
+            return mnstl::fold_result_t{mnstl::number_t{static_cast<T>(value.character_unchecked())}};
+        default: return mnstl::fold_result_t{};
+    }
+}
+
+}  // namespace
+
+mnstl::fold_result_t foldBinaryOperator(lexer::TokenType op, const mnstl::fold_result_t& left,
+                                        const mnstl::fold_result_t& right) noexcept {
+    using enum lexer::TokenType;
+    using held = enum mnstl::fold_result_t::held_type;
+    if (left.held_type() != right.held_type()) { return mnstl::fold_result_t{}; }
+    switch (left.held_type()) {
+        case held::Number: {
+            const mnstl::number_t l = left.number_unchecked(), r = right.number_unchecked();
+            switch (op) {
+                case Plus: return mnstl::fold_result_t{l + r};
+                case Minus: return mnstl::fold_result_t{l - r};
+                case Mul: return mnstl::fold_result_t{l * r};
+                case Div:
+                    return mnstl::fold_result_t{l.is_integer() && r.is_integer() ? truncatingDivide(l, r)
+                                                                                 : l.true_div(r)};
+                case FloorDiv: return mnstl::fold_result_t{l.floor_div(r)};
+                case Mod: return mnstl::fold_result_t{l % r};
+                case BitAnd: return mnstl::fold_result_t{l & r};
+                case BitOr: return mnstl::fold_result_t{l | r};
+                case BitXor: return mnstl::fold_result_t{l ^ r};
+                case BitLShift: return mnstl::fold_result_t{l << r};
+                case BitRShift: return mnstl::fold_result_t{l >> r};
+                default: return compare(op, l, r);
+            }
+        }
+        case held::Character: return compare(op, left.character_unchecked(), right.character_unchecked());
+        case held::Boolean: {
+            const bool l = left.boolean_unchecked(), r = right.boolean_unchecked();
+            switch (op) {
+                case And: return mnstl::fold_result_t{l && r};
+                case Or: return mnstl::fold_result_t{l || r};
+                case Equal: return mnstl::fold_result_t{l == r};
+                case NotEqual: return mnstl::fold_result_t{l != r};
+                default: return mnstl::fold_result_t{};
+            }
+        }
+        case held::String:
+            if (op == Equal) { return mnstl::fold_result_t{left.string_unchecked() == right.string_unchecked()}; }
+            if (op == NotEqual) { return mnstl::fold_result_t{left.string_unchecked() != right.string_unchecked()}; }
+            return mnstl::fold_result_t{};
+        case held::Void: return mnstl::fold_result_t{};
+    }
+    return mnstl::fold_result_t{};
+}
+
+mnstl::fold_result_t foldPrefixOperator(lexer::TokenType op, const mnstl::fold_result_t& operand) noexcept {
+    using enum lexer::TokenType;
+    if (op == Not) {
+        return operand.is_bool() ? mnstl::fold_result_t{!operand.boolean_unchecked()} : mnstl::fold_result_t{};
+    }
+    if (!operand.is_number()) { return mnstl::fold_result_t{}; }
+    const mnstl::number_t value = operand.number_unchecked();
+    switch (op) {
+        case UnaryPlus: return mnstl::fold_result_t{+value};
+        case UnaryMinus: return mnstl::fold_result_t{-value};
+        case BitNot: {
+            const mnstl::number_t inverted = ~value;  // Nothing, for a float
+            return inverted.underlying_type() == mnstl::number_t::held_type::none ? mnstl::fold_result_t{}
+                                                                                : mnstl::fold_result_t{inverted};
+        }
+        default: return mnstl::fold_result_t{};  // e.g. a constant has no address, and can't be incremented
+    }
+}
+
+mnstl::fold_result_t foldCast(const mnstl::fold_result_t& value, PrimitiveType_t target) noexcept {
+    using enum PrimitiveType_t;
+    switch (target) {
+        case i8: return convertTo<int8_t>(value);
+        case u8: return convertTo<uint8_t>(value);
+        case i16: return convertTo<int16_t>(value);
+        case u16: return convertTo<uint16_t>(value);
+        case i32: return convertTo<int32_t>(value);
+        case u32: return convertTo<uint32_t>(value);
+        case i64: return convertTo<int64_t>(value);
+        case u64: return convertTo<uint64_t>(value);
+        case i128: return convertTo<mnstl::int128_t>(value);
+        case u128: return convertTo<mnstl::uint128_t>(value);
+        case f32: return convertTo<mnstl::float32_t>(value);
+        case f64: return convertTo<mnstl::float64_t>(value);
+        case character:
+            if (value.is_number() && value.number_unchecked().is_integer()) {
+                return mnstl::fold_result_t{static_cast<char32_t>(value.number_unchecked().value_as<uint32_t>())};
+            }
+            return value.is_char() ? value : mnstl::fold_result_t{};
+        case boolean:
+            if (value.is_number()) { return mnstl::fold_result_t{!(value.number_unchecked() == 0)}; }
+            return value.is_bool() ? value : mnstl::fold_result_t{};
+        case str: return value.is_string() ? value : mnstl::fold_result_t{};
+        case not_primitive: return value;
+    }
+    return mnstl::fold_result_t{};
+}
 
 }  // namespace ast
 }  // namespace Manganese
\ No newline at end of file
@@ -1,16 +1,32 @@
 #if MN_DEBUG  // Only include dump methods in debug builds
 
 #include <core.hpp>
+#include <format>
 #include <frontend/ast.hpp>
+#include <iterator>
 #include <mnstl/number.hxx>
+#include <ostream>
 #include <string>
+#include <utility>
 #include <utils/type_names.hpp>
 
 namespace Manganese {
 namespace ast {
 // There are lots of implicit conversions between integer types -- for convenience, ignore those warnings
 
-static inline std::string getIndent(size_t indent) { return std::string(indent * 2, ' '); }
+// Append `depth` levels of indentation, then the formatted text, straight to `out` (with no string built for either)
+template <class... Args>
+static inline void appendIndented(std::string& out, size_t depth, std::format_string<Args...> format,
+                                  Args&&... args) {
+    out.append(depth * 2, ' ');
+    std::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
+}
+
+void ASTNode::dump(std::ostream& os, size_t indentDepth) const {
+    std::string out;
+    dump(out, indentDepth);
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
 
 // Helper function to get the type of a number variant
 std::string_view getNumberTypeName(const mnstl::number_t& value) {
@@ -35,513 +51,530 @@ std::string_view getNumberTypeName(const mnstl::number_t& value) {
 
 // Expressions
 
-void AggregateInstantiationExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AggregateInstantiationExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "Name: " << name << "\n";
-    os << getIndent(indent + 1) << "fields: [\n";
+void AggregateInstantiationExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AggregateInstantiationExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "Name: {}\n", name);
+    appendIndented(out, indent + 1, "fields: [\n");
 
     for (const AggregateInstantiationField& field : fields) {
-        os << getIndent(indent + 2) << "{\n";
-        os << getIndent(indent + 3) << "name: " << field.name << "\n";
-        os << getIndent(indent + 3) << "value: \n";
-        field.value->dump(os, indent + 4);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        appendIndented(out, indent + 3, "name: {}\n", field.name);
+        appendIndented(out, indent + 3, "value: \n");
+        field.value->dump(out, indent + 4);
+        appendIndented(out, indent + 2, "}}\n");
     }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void AggregateLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AggregateLiteralExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "Elements {\n";
-    for (const Expression* element : elements) { element->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "}\n";
+void AggregateLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AggregateLiteralExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "Elements {{\n");
+    for (const Expression* element : elements) { element->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "}}\n");
 }
 
-void AlignofExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AlignofExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "type: \n";
-    type->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void AlignofExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AlignofExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "type: \n");
+    type->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void ArrayLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ArrayLiteralExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "elements: [\n";
+void ArrayLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ArrayLiteralExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "elements: [\n");
 
     for (const Expression* element : elements) {
-        os << getIndent(indent + 2) << "{\n";
-        element->dump(os, indent + 3);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        element->dump(out, indent + 3);
+        appendIndented(out, indent + 2, "}}\n");
     }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void AssignmentExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AssignmentExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "operator: " << lexer::tokenTypeToString(op) << "\n";
-    os << getIndent(indent + 1) << "assignee: \n";
-    assignee->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "value: \n";
-    value->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void AssignmentExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AssignmentExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "operator: {}\n", lexer::tokenTypeToString(op));
+    appendIndented(out, indent + 1, "assignee: \n");
+    assignee->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "value: \n");
+    value->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void BinaryExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "BinaryExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "operator: " << lexer::tokenTypeToString(op) << "\n";
-    os << getIndent(indent + 1) << "left: \n";
-    left->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "right: \n";
-    right->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void BinaryExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "BinaryExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "operator: {}\n", lexer::tokenTypeToString(op));
+    appendIndented(out, indent + 1, "left: \n");
+    left->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "right: \n");
+    right->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void BoolLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "BoolExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "value: " << toString() << "\n";
-    os << getIndent(indent) << "}\n";
+void BoolLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "BoolExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "value: ");
+    toString(out);
+    out += '\n';
+    appendIndented(out, indent, "}}\n");
 }
 
-void CharLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "CharLiteralExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "value: '" << static_cast<char>(value) << "'\n";
-    os << getIndent(indent + 1) << "code point: " << static_cast<int>(value) << "\n";
-    os << getIndent(indent) << "}\n";
+void CharLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "CharLiteralExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "value: '{}'\n", static_cast<char>(value));
+    appendIndented(out, indent + 1, "code point: {}\n", static_cast<int>(value));
+    appendIndented(out, indent, "}}\n");
 }
 
-void FunctionCallExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "FunctionCallExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "callee: \n";
-    callee->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "arguments: [\n";
+void FunctionCallExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "FunctionCallExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "callee: \n");
+    callee->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "arguments: [\n");
 
     for (const Expression* arg : arguments) {
-        os << getIndent(indent + 2) << "{\n";
-        arg->dump(os, indent + 3);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        arg->dump(out, indent + 3);
+        appendIndented(out, indent + 2, "}}\n");
     }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void GenericExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "GenericExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "identifier: " << toStringOr(identifier) << "\n";
-    os << getIndent(indent + 1) << "generic types: [\n";
+void GenericExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "GenericExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "identifier: ");
+    toStringOr(out, identifier);
+    out += '\n';
+    appendIndented(out, indent + 1, "generic types: [\n");
 
-    for (const Type* type : types) { os << getIndent(indent + 2) << toStringOr(type) << "\n"; }
+    for (const Type* type : types) {
+        appendIndented(out, indent + 2, "");
+        toStringOr(out, type);
+        out += '\n';
+    }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void IdentifierExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "IdentifierExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << value << "\n";
-    os << getIndent(indent) << "}\n";
+void IdentifierExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "IdentifierExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", value);
+    appendIndented(out, indent, "}}\n");
 }
 
-void IndexExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "IndexExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "variable: \n";
-    variable->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "index: \n";
-    index->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void IndexExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "IndexExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "variable: \n");
+    variable->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "index: \n");
+    index->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void MemberAccessExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "MemberAccessExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "object: \n";
-    object->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "property: " << property << "\n";
-    os << getIndent(indent) << "}\n";
+void MemberAccessExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "MemberAccessExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "object: \n");
+    object->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "property: {}\n", property);
+    appendIndented(out, indent, "}}\n");
 }
 
-void NumberLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "NumberLiteralExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "value: " << toString() << "\n";
-    os << getIndent(indent + 1) << "Inferred literal type: " << getNumberTypeName(value) << "\n";
-    os << getIndent(indent) << "}\n";
+void NumberLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "NumberLiteralExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "value: ");
+    toString(out);
+    out += '\n';
+    appendIndented(out, indent + 1, "Inferred literal type: {}\n", getNumberTypeName(value));
+    appendIndented(out, indent, "}}\n");
 }
 
-void PostfixExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "PostfixExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "operator: " << lexer::tokenTypeToString(op) << "\n";
-    os << getIndent(indent + 1) << "operand: \n";
-    left->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void PostfixExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "PostfixExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "operator: {}\n", lexer::tokenTypeToString(op));
+    appendIndented(out, indent + 1, "operand: \n");
+    left->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void PrefixExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "PrefixExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "operator: " << lexer::tokenTypeToString(op) << "\n";
-    os << getIndent(indent + 1) << "operand: \n";
-    right->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void PrefixExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "PrefixExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "operator: {}\n", lexer::tokenTypeToString(op));
+    appendIndented(out, indent + 1, "operand: \n");
+    right->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void ScopeResolutionExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ScopeResolutionExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "scope: \n";
-    scope->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "element: " << element << "\n";
-    os << getIndent(indent) << "}\n";
+void ScopeResolutionExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ScopeResolutionExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "scope: \n");
+    scope->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "element: {}\n", element);
+    appendIndented(out, indent, "}}\n");
 }
 
-void SizeofExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "SizeofExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "type: \n";
-    type->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void SizeofExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "SizeofExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "type: \n");
+    type->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void StringLiteralExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "StringLiteralExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "value: " << toString() << "\n";
-    os << getIndent(indent + 1) << "length: " << value.length() << "\n";
-    os << getIndent(indent) << "}\n";
+void StringLiteralExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "StringLiteralExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "value: ");
+    toString(out);
+    out += '\n';
+    appendIndented(out, indent + 1, "length: {}\n", value.length());
+    appendIndented(out, indent, "}}\n");
 }
 
-void TypeCastExpression::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "TypeCastExpression [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "expression: \n";
-    originalValue->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "target type: \n";
-    targetType->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void TypeCastExpression::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "TypeCastExpression [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "expression: \n");
+    originalValue->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "target type: \n");
+    targetType->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
 // Statements
 
-void AliasStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AliasStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "alias: " << alias << "\n";
-    os << getIndent(indent + 1) << "base type: ";
-    baseType->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void AliasStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AliasStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "alias: {}\n", alias);
+    appendIndented(out, indent + 1, "base type: ");
+    baseType->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void BreakStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "BreakStatement [" << getLine() << ":" << getColumn() << "]\n";
+void BreakStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "BreakStatement [{}:{}]\n", getLine(), getColumn());
 }
 
-void AggregateDeclarationStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "AggregateDeclarationStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << name << "\n";
-    os << getIndent(indent + 1) << "visibility: " << visibilityToString(visibility) << " \n";
-    os << getIndent(indent + 1) << "fields: [\n";
+void AggregateDeclarationStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "AggregateDeclarationStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", name);
+    appendIndented(out, indent + 1, "visibility: {} \n", visibilityToString(visibility));
+    appendIndented(out, indent + 1, "fields: [\n");
 
     for (const AggregateField& field : fields) {
-        os << getIndent(indent + 2) << "{\n";
-        os << getIndent(indent + 3) << "name: " << field.name << "\n";
-        os << getIndent(indent + 3) << "type: \n";
-        field.type->dump(os, indent + 4);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        appendIndented(out, indent + 3, "name: {}\n", field.name);
+        appendIndented(out, indent + 3, "type: \n");
+        field.type->dump(out, indent + 4);
+        appendIndented(out, indent + 2, "}}\n");
     }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void ContinueStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ContinueStatement [" << getLine() << ":" << getColumn() << "]\n";
+void ContinueStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ContinueStatement [{}:{}]\n", getLine(), getColumn());
 }
 
-void EmptyStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "EmptyStatement [" << getLine() << ":" << getColumn() << "]\n";
+void EmptyStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "EmptyStatement [{}:{}]\n", getLine(), getColumn());
 }
 
-void EnumDeclarationStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "EnumDeclarationStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << name << "\n";
-    os << getIndent(indent + 1) << "visibility: " << visibilityToString(visibility) << " \n";
-    os << getIndent(indent + 1) << "values: [\n";
+void EnumDeclarationStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "EnumDeclarationStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", name);
+    appendIndented(out, indent + 1, "visibility: {} \n", visibilityToString(visibility));
+    appendIndented(out, indent + 1, "values: [\n");
 
     for (const EnumValue& value : values) {
-        os << getIndent(indent + 2) << "{\n";
-        os << getIndent(indent + 3) << "name: " << value.name << "\n";
-        os << getIndent(indent + 3) << "value: " << value.value << "\n";
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        appendIndented(out, indent + 3, "name: {}\n", value.name);
+        appendIndented(out, indent + 3, "value: ");
+        toStringOr(out, value.value, "null");
+        out += '\n';
+        appendIndented(out, indent + 2, "}}\n");
     }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void ExpressionStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ExpressionStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    expression->dump(os, indent + 1);
-    os << getIndent(indent) << "}\n";
+void ExpressionStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ExpressionStatement [{}:{}] {{\n", getLine(), getColumn());
+    expression->dump(out, indent + 1);
+    appendIndented(out, indent, "}}\n");
 }
 
-void ForLoopStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ForLoopStatement [" << getLine() << ":" << getColumn() << "] {\n";
+void ForLoopStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ForLoopStatement [{}:{}] {{\n", getLine(), getColumn());
 
-    os << getIndent(indent + 1) << "initializationStep: \n";
+    appendIndented(out, indent + 1, "initializationStep: \n");
     if (initializationStep) {
-        initializationStep->dump(os, indent + 2);
+        initializationStep->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 2) << "null\n";
+        appendIndented(out, indent + 2, "null\n");
     }
 
-    os << getIndent(indent + 1) << "stopCondition: \n";
+    appendIndented(out, indent + 1, "stopCondition: \n");
     if (stopCondition) {
-        stopCondition->dump(os, indent + 2);
+        stopCondition->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 2) << "null\n";
+        appendIndented(out, indent + 2, "null\n");
     }
 
-    os << getIndent(indent + 1) << "postExpression: \n";
+    appendIndented(out, indent + 1, "postExpression: \n");
     if (postExpression) {
-        postExpression->dump(os, indent + 2);
+        postExpression->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 2) << "null\n";
+        appendIndented(out, indent + 2, "null\n");
     }
 
-    os << getIndent(indent + 1) << "body: [\n";
-    for (const Statement* stmt : body) { stmt->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "]\n";
+    appendIndented(out, indent + 1, "body: [\n");
+    for (const Statement* stmt : body) { stmt->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "]\n");
 
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void FunctionDeclarationStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "FunctionDeclarationStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << name << "\n";
-    os << getIndent(indent + 1) << "visibility: " << visibilityToString(visibility) << " \n";
+void FunctionDeclarationStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "FunctionDeclarationStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", name);
+    appendIndented(out, indent + 1, "visibility: {} \n", visibilityToString(visibility));
 
     if (!genericTypes.empty()) {
-        os << getIndent(indent + 1) << "generic types: [";
+        appendIndented(out, indent + 1, "generic types: [");
         for (size_t i = 0; i < genericTypes.size(); ++i) {
-            os << genericTypes[i];
-            if (i < genericTypes.size() - 1) [[likely]] { os << ", "; }
+            out += genericTypes[i];
+            if (i < genericTypes.size() - 1) [[likely]] { out += ", "; }
         }
-        os << "]\n";
+        out += "]\n";
     } else {
-        os << getIndent(indent + 1) << "generic types: []\n";
+        appendIndented(out, indent + 1, "generic types: []\n");
     }
 
-    os << getIndent(indent + 1) << "parameters: [\n";
+    appendIndented(out, indent + 1, "parameters: [\n");
     for (const FunctionParameter& param : parameters) {
-        os << getIndent(indent + 2) << "{\n";
-        os << getIndent(indent + 3) << "name: " << param.name << "\n";
-        os << getIndent(indent + 3) << "isMutable: " << (param.isMutable ? "true" : "false") << "\n";
-        os << getIndent(indent + 3) << "type: \n";
-        param.type->dump(os, indent + 4);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        appendIndented(out, indent + 3, "name: {}\n", param.name);
+        appendIndented(out, indent + 3, "isMutable: {}\n", (param.isMutable ? "true" : "false"));
+        appendIndented(out, indent + 3, "type: \n");
+        param.type->dump(out, indent + 4);
+        appendIndented(out, indent + 2, "}}\n");
     }
-    os << getIndent(indent + 1) << "]\n";
+    appendIndented(out, indent + 1, "]\n");
 
     // Return type
-    os << getIndent(indent + 1) << "returnType: ";
+    appendIndented(out, indent + 1, "returnType: ");
     if (returnType) {
-        os << "\n";
-        returnType->dump(os, indent + 2);
+        out += "\n";
+        returnType->dump(out, indent + 2);
     } else {
-        os << "void\n";
+        out += "void\n";
     }
 
     // Body
-    os << getIndent(indent + 1) << "body: [\n";
-    for (const Statement* stmt : body) { stmt->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "]\n";
+    appendIndented(out, indent + 1, "body: [\n");
+    for (const Statement* stmt : body) { stmt->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "]\n");
 
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void IfStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "IfStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "condition: \n";
-    condition->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "body: [\n";
-    for (const Statement* stmt : body) { stmt->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "]\n";
+void IfStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "IfStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "condition: \n");
+    condition->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "body: [\n");
+    for (const Statement* stmt : body) { stmt->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "]\n");
     if (!elifs.empty()) {
-        os << getIndent(indent + 1) << "elif clauses: [\n";
+        appendIndented(out, indent + 1, "elif clauses: [\n");
         for (const ElifClause& elif : elifs) {
-            os << getIndent(indent + 2) << "{\n";
-            os << getIndent(indent + 3) << "condition: \n";
-            elif.condition->dump(os, indent + 4);
-            os << getIndent(indent + 3) << "body: [\n";
-            for (const Statement* stmt : elif.body) { stmt->dump(os, indent + 4); }
-            os << getIndent(indent + 3) << "]\n";
-            os << getIndent(indent + 2) << "}\n";
+            appendIndented(out, indent + 2, "{{\n");
+            appendIndented(out, indent + 3, "condition: \n");
+            elif.condition->dump(out, indent + 4);
+            appendIndented(out, indent + 3, "body: [\n");
+            for (const Statement* stmt : elif.body) { stmt->dump(out, indent + 4); }
+            appendIndented(out, indent + 3, "]\n");
+            appendIndented(out, indent + 2, "}}\n");
         }
-        os << getIndent(indent + 1) << "]\n";
+        appendIndented(out, indent + 1, "]\n");
     }
     if (!elseBody.empty()) {
-        os << getIndent(indent + 1) << "else body: [\n";
-        for (Statement* stmt : elseBody) { stmt->dump(os, indent + 2); }
-        os << getIndent(indent + 1) << "]\n";
+        appendIndented(out, indent + 1, "else body: [\n");
+        for (Statement* stmt : elseBody) { stmt->dump(out, indent + 2); }
+        appendIndented(out, indent + 1, "]\n");
     }
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void NestedBlockStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "NestedBlockStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "body: [\n";
-    for (const Statement* stmt : block) { stmt->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+void NestedBlockStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "NestedBlockStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "body: [\n");
+    for (const Statement* stmt : block) { stmt->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void ReturnStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "ReturnStatement [" << getLine() << ":" << getColumn() << "] {\n";
+void ReturnStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "ReturnStatement [{}:{}] {{\n", getLine(), getColumn());
     if (value) {
-        os << getIndent(indent + 1) << "value: \n";
-        value->dump(os, indent + 2);
+        appendIndented(out, indent + 1, "value: \n");
+        value->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 1) << "value: null\n";
+        appendIndented(out, indent + 1, "value: null\n");
     }
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void SwitchStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "SwitchStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "variable: \n";
-    variable->dump(os, indent + 2);
-    os << getIndent(indent + 1) << "cases: [\n";
+void SwitchStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "SwitchStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "variable: \n");
+    variable->dump(out, indent + 2);
+    appendIndented(out, indent + 1, "cases: [\n");
 
     for (const CaseClause& _case : cases) {
-        os << getIndent(indent + 2) << "{\n";
-        os << getIndent(indent + 3) << "literalValue: \n";
-        _case.literalValue->dump(os, indent + 4);
-        os << getIndent(indent + 3) << "body: [\n";
-        for (const Statement* stmt : _case.body) { stmt->dump(os, indent + 4); }
-        os << getIndent(indent + 3) << "]\n";
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        appendIndented(out, indent + 3, "literalValue: \n");
+        _case.literalValue->dump(out, indent + 4);
+        appendIndented(out, indent + 3, "body: [\n");
+        for (const Statement* stmt : _case.body) { stmt->dump(out, indent + 4); }
+        appendIndented(out, indent + 3, "]\n");
+        appendIndented(out, indent + 2, "}}\n");
     }
 
     if (!defaultBody.empty()) {
-        os << getIndent(indent + 1) << "default body: [\n";
-        for (const Statement* stmt : defaultBody) { stmt->dump(os, indent + 2); }
-        os << getIndent(indent + 1) << "]\n";
+        appendIndented(out, indent + 1, "default body: [\n");
+        for (const Statement* stmt : defaultBody) { stmt->dump(out, indent + 2); }
+        appendIndented(out, indent + 1, "]\n");
     }
 
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void VariableDeclarationStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "VariableDeclarationStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << name << "\n";
-    os << getIndent(indent + 1) << "isMutable: " << (isMutable ? "true" : "false") << "\n";
+void VariableDeclarationStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "VariableDeclarationStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", name);
+    appendIndented(out, indent + 1, "isMutable: {}\n", (isMutable ? "true" : "false"));
 
-    os << getIndent(indent + 1) << "visibility: " << (visibility == Visibility::Public ? "Public" : "Private") << "\n";
+    appendIndented(out, indent + 1, "visibility: {}\n", (visibility == Visibility::Public ? "Public" : "Private"));
 
-    os << getIndent(indent + 1) << "value: \n";
+    appendIndented(out, indent + 1, "value: \n");
     if (value) {
-        value->dump(os, indent + 2);
+        value->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 2) << "null\n";
+        appendIndented(out, indent + 2, "null\n");
     }
 
-    os << getIndent(indent + 1) << "type: \n";
+    appendIndented(out, indent + 1, "type: \n");
     if (type) {
-        type->dump(os, indent + 2);
+        type->dump(out, indent + 2);
     } else {
-        os << getIndent(indent + 2) << "auto\n";
+        appendIndented(out, indent + 2, "auto\n");
     }
 
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void WhileLoopStatement::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "WhileLoopStatement [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "body: [\n";
-    for (const Statement* stmt : body) { stmt->dump(os, indent + 2); }
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent + 1) << "condition: \n";
-    condition->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void WhileLoopStatement::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "WhileLoopStatement [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "body: [\n");
+    for (const Statement* stmt : body) { stmt->dump(out, indent + 2); }
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent + 1, "condition: \n");
+    condition->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
 // Types
 
-void ArrayType::dump(std::ostream& os, size_t indent) const {
-    os << std::string(indent, ' ') << "ArrayType: " << '\n';
-    os << std::string(indent + 2, ' ') << "elementType: " << '\n';
-    elementType->dump(os, indent + 4);
+void ArrayType::dump(std::string& out, size_t indent) const {
+    out.append(indent, ' ');
+    out += "ArrayType: \n";
+    out.append(indent + 2, ' ');
+    out += "elementType: \n";
+    elementType->dump(out, indent + 4);
 
     if (lengthExpression) {
-        os << std::string(indent + 2, ' ') << "length: " << '\n';
-        lengthExpression->dump(os, indent + 4);
+        out.append(indent + 2, ' ');
+        out += "length: \n";
+        lengthExpression->dump(out, indent + 4);
     }
 }
 
-void AggregateType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "Type [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "fields: [\n";
+void AggregateType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "Type [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "fields: [\n");
 
     for (const Type* field : fieldTypes) {
-        os << getIndent(indent + 2) << "{\n";
-        field->dump(os, indent + 3);
-        os << getIndent(indent + 2) << "}\n";
+        appendIndented(out, indent + 2, "{{\n");
+        field->dump(out, indent + 3);
+        appendIndented(out, indent + 2, "}}\n");
     }
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void FunctionType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "FunctionType [" << getLine() << ":" << getColumn() << "] {\n";
+void FunctionType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "FunctionType [{}:{}] {{\n", getLine(), getColumn());
 
     // Parameter types
-    os << getIndent(indent + 1) << "parameter types: [\n";
+    appendIndented(out, indent + 1, "parameter types: [\n");
     for (const FunctionParameterType& paramType : parameterTypes) {
-        os << getIndent(indent + 2) << (paramType.isMutable ? "mut " : "") << "\n";
-        paramType.type->dump(os, indent + 2);
+        appendIndented(out, indent + 2, "{}\n", (paramType.isMutable ? "mut " : ""));
+        paramType.type->dump(out, indent + 2);
     }
-    os << getIndent(indent + 1) << "]\n";
+    appendIndented(out, indent + 1, "]\n");
 
     // Return type
-    os << getIndent(indent + 1) << "return type: ";
+    appendIndented(out, indent + 1, "return type: ");
     if (returnType) {
-        os << "\n";
-        returnType->dump(os, indent + 2);
+        out += "\n";
+        returnType->dump(out, indent + 2);
     } else {
-        os << "void\n";
+        out += "void\n";
     }
 
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent, "}}\n");
 }
 
-void GenericType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "GenericType [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "base: ";
-    baseType->dump(os, indent + 1);
-    os << "\n";
-    os << getIndent(indent + 1) << "generic types: [\n";
+void GenericType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "GenericType [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "base: ");
+    baseType->dump(out, indent + 1);
+    out += "\n";
+    appendIndented(out, indent + 1, "generic types: [\n");
 
-    for (const Type* type : typeParameters) { type->dump(os, indent + 2); }
+    for (const Type* type : typeParameters) { type->dump(out, indent + 2); }
 
-    os << getIndent(indent + 1) << "]\n";
-    os << getIndent(indent) << "}\n";
+    appendIndented(out, indent + 1, "]\n");
+    appendIndented(out, indent, "}}\n");
 }
 
-void PointerType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "PointerType [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "base type: \n";
-    baseType->dump(os, indent + 2);
-    os << getIndent(indent) << "}\n";
+void PointerType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "PointerType [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "base type: \n");
+    baseType->dump(out, indent + 2);
+    appendIndented(out, indent, "}}\n");
 }
 
-void SymbolType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "SymbolType [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "name: " << name << "\n";
-    os << getIndent(indent + 1) << "primitive type: " << primitiveTypeToString(primitiveType) << "\n";
-    os << getIndent(indent) << "}\n";
+void SymbolType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "SymbolType [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "name: {}\n", name);
+    appendIndented(out, indent + 1, "primitive type: {}\n", primitiveTypeToString(primitiveType));
+    appendIndented(out, indent, "}}\n");
 }
 
-void TypeofType::dump(std::ostream& os, size_t indent) const {
-    os << getIndent(indent) << "TypeofType [" << getLine() << ":" << getColumn() << "] {\n";
-    os << getIndent(indent + 1) << "expression: ";
-    expression->dump(os, indent + 1);
-    os << getIndent(indent) << "}\n";
+void TypeofType::dump(std::string& out, size_t indent) const {
+    appendIndented(out, indent, "TypeofType [{}:{}] {{\n", getLine(), getColumn());
+    appendIndented(out, indent + 1, "expression: ");
+    expression->dump(out, indent + 1);
+    appendIndented(out, indent, "}}\n");
 }
 
 }  // namespace ast
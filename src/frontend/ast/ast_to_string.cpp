@@ -3,347 +3,442 @@
 #include <format>
 #include <frontend/ast.hpp>
 #include <frontend/semantic/type_context.hpp>
+#include <iterator>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
 #if MN_DEBUG
-#define WRAP(str) "(" str ")"
+#define WRAP_OPEN "("
+#define WRAP_CLOSE ")"
 #else
-#define WRAP(str) str
+#define WRAP_OPEN ""
+#define WRAP_CLOSE ""
 #endif  // MN_DEBUG
 
 namespace Manganese {
 namespace ast {
 
-static inline std::string getIndent(size_t indent) { return std::string(indent * 4, ' '); }
-
-// Helpers
-std::string blockToString(const Block& block, size_t indent) {
-    std::string result = "{\n";
-    for (const Statement* stmt : block) { result += stmt->toString(indent + 1) + "\n"; }
-    result += getIndent(indent) + "}";
-    return result;
+// Everything is appended to the one buffer in place, so printing a tree is linear in the size of what is printed
+template <class... Args>
+static inline void append(std::string& out, std::format_string<Args...> format, Args&&... args) {
+    std::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
 }
 
-template <class T>
-    requires(std::derived_from<T, ASTNode>)
-std::string commaSeparatedList(const std::vector<T*>& values, size_t indent = 0) {
-    std::string result;
-    for (std::size_t i = 0; i < values.size(); ++i) {
-        result += values[i]->toString(indent);
-        if (i != values.size() - 1) [[likely]] { result += ", "; }
-    }
-    return result;
-}
+static inline void appendIndent(std::string& out, size_t indent) { out.append(indent * 4, ' '); }
 
-template <class T>
-    requires(std::same_as<T, std::string>)
-std::string commaSeparatedList(const std::vector<T>& values) {
-    std::string result;
-    for (std::size_t i = 0; i < values.size(); ++i) {
-        result += values[i];
-        if (i != values.size() - 1) [[likely]] { result += ", "; }
+// Helpers
+static void blockToString(std::string& out, const Block& block, size_t indent) {
+    out += "{\n";
+    for (const Statement* stmt : block) {
+        stmt->toString(out, indent + 1);
+        out += '\n';
+    }
+    appendIndent(out, indent);
+    out += '}';
+}
+
+template <class Range>
+static void commaSeparatedList(std::string& out, const Range& values, size_t indent = 0) {
+    bool first = true;
+    for (const auto& value : values) {
+        if (!first) [[likely]] { out += ", "; }
+        first = false;
+        if constexpr (std::same_as<std::remove_cvref_t<decltype(value)>, std::string>) {
+            out += value;
+        } else {
+            value->toString(out, indent);
+        }
     }
-    return result;
-}
-
-std::string genericsToString(const std::vector<Type*> params, size_t indent = 0) {
-    if (params.empty()) { return ""; }
-    return std::format("@[{}]", commaSeparatedList(params, indent));
 }
 
-std::string genericsToString(const std::vector<std::string> params) {
-    if (params.empty()) { return ""; }
-    return std::format("@[{}]", commaSeparatedList(params));
+template <class T>
+static void genericsToString(std::string& out, const std::vector<T>& params, size_t indent = 0) {
+    if (params.empty()) { return; }
+    out += "@[";
+    commaSeparatedList(out, params, indent);
+    out += ']';
 }
 
 // Statements
 
-std::string AggregateDeclarationStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent) + std::format("{} aggregate {}", visibilityToString(visibility), name);
-    if (!genericTypes.empty()) { result += std::format("[{}]", commaSeparatedList(genericTypes)); }
-    result += " {\n";
+void AggregateDeclarationStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    append(out, "{} aggregate {}", visibilityToString(visibility), name);
+    if (!genericTypes.empty()) {
+        out += '[';
+        commaSeparatedList(out, genericTypes);
+        out += ']';
+    }
+    out += " {\n";
     for (const AggregateField& field : fields) {
-        result += getIndent(indent + 1) + field.name + ": " + field.type->toString(indent + 1) + ";\n";
+        appendIndent(out, indent + 1);
+        append(out, "{}: ", field.name);
+        field.type->toString(out, indent + 1);
+        out += ";\n";
     }
-    result += getIndent(indent) + "}";
-    return result;
+    appendIndent(out, indent);
+    out += '}';
 }
 
-std::string AliasStatement::toString(size_t indent) const {
-    return getIndent(indent) + std::format("alias " WRAP("{}") " as {};", baseType->toString(indent), alias);
+void AliasStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "alias " WRAP_OPEN;
+    baseType->toString(out, indent);
+    append(out, WRAP_CLOSE " as {};", alias);
 }
 
-std::string BreakStatement::toString(size_t indent) const { return getIndent(indent) + "break;"; }
+void BreakStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "break;";
+}
 
-std::string ContinueStatement::toString(size_t indent) const { return getIndent(indent) + "continue;"; }
+void ContinueStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "continue;";
+}
 
-std::string EmptyStatement::toString(size_t) const { return ""; }
+void EmptyStatement::toString(std::string&, size_t) const {}
 
-std::string EnumDeclarationStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent)
-        + std::format("{} enum {}: {}", visibilityToString(visibility), name, baseType->toString(indent));
-    result += " {\n";
+void EnumDeclarationStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    append(out, "{} enum {}: ", visibilityToString(visibility), name);
+    baseType->toString(out, indent);
+    out += " {\n";
     for (std::size_t i = 0; i < values.size(); ++i) {
         const EnumValue& value = values[i];
-        result += getIndent(indent + 1) + value.name;
-        if (value.value) { result += std::format(" = {}", value.value->toString(indent + 1)); }
-        if (i != values.size() - 1) { result += ","; }
-        result += '\n';
+        appendIndent(out, indent + 1);
+        out += value.name;
+        if (value.value) {
+            out += " = ";
+            value.value->toString(out, indent + 1);
+        }
+        if (i != values.size() - 1) { out += ','; }
+        out += '\n';
     }
-    result += getIndent(indent) + "}";
-    return result;
+    appendIndent(out, indent);
+    out += '}';
 }
 
-std::string ExpressionStatement::toString(size_t indent) const {
-    return getIndent(indent) + std::format("{};", expression->toString(indent));
+void ExpressionStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    expression->toString(out, indent);
+    out += ';';
 }
 
-std::string ForLoopStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent) + "for (";
+void ForLoopStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "for (";
     if (initializationStep) {
         // Strip leading indentation from statement parts inside loop clauses if they add it
-        std::string init = initializationStep->toString(0);
-        result += init + " ";
+        initializationStep->toString(out, 0);
+        out += ' ';
     } else {
-        result += ";";
+        out += ';';
     }
     if (stopCondition) {
-        result += stopCondition->toString(0) + "; ";
+        stopCondition->toString(out, 0);
+        out += "; ";
     } else {
-        result += ";";
+        out += ';';
     }
-    if (postExpression) { result += postExpression->toString(0); }
-    result += ") ";
-    result += blockToString(body, indent);
-    return result;
+    if (postExpression) { postExpression->toString(out, 0); }
+    out += ") ";
+    blockToString(out, body, indent);
 }
 
-std::string FunctionDeclarationStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent) + std::format("{} func {}", visibilityToString(visibility), name);
+void FunctionDeclarationStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    append(out, "{} func {}", visibilityToString(visibility), name);
 
-    if (!genericTypes.empty()) { result += std::format("[{}]", commaSeparatedList(genericTypes)); }
+    if (!genericTypes.empty()) {
+        out += '[';
+        commaSeparatedList(out, genericTypes);
+        out += ']';
+    }
 
-    result += '(';
+    out += '(';
     for (size_t i = 0; i < parameters.size(); ++i) {
         const FunctionParameter& param = parameters[i];
-        result += std::format("{}: {}{}", param.name, (param.isMutable ? "mut " : ""), param.type->toString(indent));
-        if (i < parameters.size() - 1) { result += ", "; }
+        append(out, "{}: {}", param.name, (param.isMutable ? "mut " : ""));
+        param.type->toString(out, indent);
+        if (i < parameters.size() - 1) { out += ", "; }
+    }
+    out += ')';
+    if (returnType) {
+        out += " -> ";
+        returnType->toString(out, indent);
     }
-    result += ')';
-    if (returnType) { result += std::format(" -> {}", returnType->toString(indent)); }
-    result += ' ';
-    result += blockToString(body, indent);
-    return result;
+    out += ' ';
+    blockToString(out, body, indent);
 }
 
-std::string IfStatement::toString(size_t indent) const {
-    std::string result
-        = getIndent(indent) + std::format("if ({}) ", condition->toString(indent)) + blockToString(body, indent);
+void IfStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "if (";
+    condition->toString(out, indent);
+    out += ") ";
+    blockToString(out, body, indent);
     for (const ElifClause& elif : elifs) {
-        result += std::format(" elif ({}) ", elif.condition->toString(indent)) + blockToString(elif.body, indent);
+        out += " elif (";
+        elif.condition->toString(out, indent);
+        out += ") ";
+        blockToString(out, elif.body, indent);
+    }
+    if (!elseBody.empty()) {
+        out += " else ";
+        blockToString(out, elseBody, indent);
     }
-    if (!elseBody.empty()) { result += " else " + blockToString(elseBody, indent); }
-    return result;
 }
 
-std::string NestedBlockStatement::toString(size_t indent) const {
-    return getIndent(indent) + blockToString(block, indent);
+void NestedBlockStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    blockToString(out, block, indent);
 }
 
-std::string ReturnStatement::toString(size_t indent) const {
-    std::string valStr = value ? value->toString(indent) : "";
-    return getIndent(indent) + std::format("return {};", valStr);
+void ReturnStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "return ";
+    if (value) { value->toString(out, indent); }
+    out += ';';
 }
 
-std::string SwitchStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent) + std::format("switch ({})", variable->toString(indent)) + " {\n";
+void SwitchStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    out += "switch (";
+    variable->toString(out, indent);
+    out += ") {\n";
     for (const CaseClause& _case : cases) {
-        result += getIndent(indent + 1) + std::format("case {}:\n", _case.literalValue->toString(indent + 1));
-        for (const Statement* stmt : _case.body) { result += stmt->toString(indent + 2) + "\n"; }
+        appendIndent(out, indent + 1);
+        out += "case ";
+        _case.literalValue->toString(out, indent + 1);
+        out += ":\n";
+        for (const Statement* stmt : _case.body) {
+            stmt->toString(out, indent + 2);
+            out += '\n';
+        }
     }
     if (!defaultBody.empty()) {
-        result += getIndent(indent + 1) + "default:\n";
-        for (const Statement* stmt : defaultBody) { result += stmt->toString(indent + 2) + "\n"; }
+        appendIndent(out, indent + 1);
+        out += "default:\n";
+        for (const Statement* stmt : defaultBody) {
+            stmt->toString(out, indent + 2);
+            out += '\n';
+        }
     }
-    result += getIndent(indent) + "}";
-    return result;
+    appendIndent(out, indent);
+    out += '}';
 }
 
-std::string VariableDeclarationStatement::toString(size_t indent) const {
-    std::string typeName;
+void VariableDeclarationStatement::toString(std::string& out, size_t indent) const {
+    appendIndent(out, indent);
+    append(out, "({} {}: {} ", isMutable ? "let mut" : "let", name, visibilityToString(visibility));
     if (type) {
-        typeName = type->toString();
+        type->toString(out, 0);
     } else if (value && value->semanticType) {
-        typeName = value->semanticType->toString();
+        out += value->semanticType->toString();
     } else {
-        typeName = "auto";
+        out += "auto";
     }
-    std::string typeStr = std::format("{} {}", visibilityToString(visibility), typeName);
-    std::string valueStr = value ? " = " + value->toString(0) : "";
-
-    return getIndent(indent) + std::format("({} {}: {}{});", isMutable ? "let mut" : "let", name, typeStr, valueStr);
+    if (value) {
+        out += " = ";
+        value->toString(out, 0);
+    }
+    out += ");";
 }
 
-std::string WhileLoopStatement::toString(size_t indent) const {
-    std::string result = getIndent(indent);
-    const std::string whileCond = std::format("while ({})", condition->toString(indent));
+void WhileLoopStatement::toString(std::string& out, size_t indent) const {
+    auto whileCondition = [&] {
+        out += "while (";
+        condition->toString(out, indent);
+        out += ')';
+    };
+    appendIndent(out, indent);
     if (isDoWhile) {
-        result += "do ";
+        out += "do ";
     } else {
-        result += whileCond + ' ';
+        whileCondition();
+        out += ' ';
+    }
+    blockToString(out, body, indent);
+    if (isDoWhile) {
+        out += ' ';
+        whileCondition();
+        out += ';';
     }
-    result += blockToString(body, indent);
-    if (isDoWhile) { result += " " + whileCond + ";"; }
-
-    return result;
 }
 
 // Expressions (Expressions do not typically prepend self-indentation since they sit inside statements)
 
-std::string AggregateInstantiationExpression::toString(size_t indent) const {
-    std::string result = std::format("{}{} ", name, genericsToString(genericTypes, indent)) + "{";
+void AggregateInstantiationExpression::toString(std::string& out, size_t indent) const {
+    out += name;
+    genericsToString(out, genericTypes, indent);
+    out += " {";
     for (std::size_t i = 0; i < fields.size(); ++i) {
         const AggregateInstantiationField& field = fields[i];
-        result += std::format("{} = {}", field.name, field.value->toString(indent));
-        if (i != fields.size() - 1) { result += ", "; }
+        append(out, "{} = ", field.name);
+        field.value->toString(out, indent);
+        if (i != fields.size() - 1) { out += ", "; }
     }
-    result += "}";
-    return result;
+    out += '}';
 }
 
-std::string AggregateLiteralExpression::toString(size_t indent) const {
-    std::string result = "{";
-    for (size_t i = 0; i < elements.size(); ++i) {
-        result += elements[i]->toString(indent);
-        if (i < elements.size() - 1) [[likely]] { result += ", "; }
-    }
-    result += "}";
-    return result;
+void AggregateLiteralExpression::toString(std::string& out, size_t indent) const {
+    out += '{';
+    commaSeparatedList(out, elements, indent);
+    out += '}';
 }
 
-std::string AlignofExpression::toString(size_t indent) const {
-    return std::format(WRAP("alignof({})"), type->toString(indent));
+void AlignofExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN "alignof(";
+    type->toString(out, indent);
+    out += ")" WRAP_CLOSE;
 }
 
-std::string ArrayLiteralExpression::toString(size_t indent) const {
-    std::string result = "[";
-    for (size_t i = 0; i < elements.size(); ++i) {
-        result += elements[i]->toString(indent);
-        if (i < elements.size() - 1) [[likely]] { result += ", "; }
-    }
-    result += "]";
-    return result;
+void ArrayLiteralExpression::toString(std::string& out, size_t indent) const {
+    out += '[';
+    commaSeparatedList(out, elements, indent);
+    out += ']';
 }
 
-std::string AssignmentExpression::toString(size_t indent) const {
-    return std::format(WRAP("{} {} {}"), assignee->toString(indent), lexer::tokenTypeToString(op),
-                       value->toString(indent));
+void AssignmentExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN;
+    assignee->toString(out, indent);
+    append(out, " {} ", lexer::tokenTypeToString(op));
+    value->toString(out, indent);
+    out += WRAP_CLOSE;
 }
-std::string BinaryExpression::toString(size_t indent) const {
-    return std::format(WRAP("{} {} {}"), left->toString(indent), lexer::tokenTypeToString(op), right->toString(indent));
+
+void BinaryExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN;
+    left->toString(out, indent);
+    append(out, " {} ", lexer::tokenTypeToString(op));
+    right->toString(out, indent);
+    out += WRAP_CLOSE;
 }
 
-std::string BoolLiteralExpression::toString(size_t) const { return value ? "true" : "false"; }
+void BoolLiteralExpression::toString(std::string& out, size_t) const { out += value ? "true" : "false"; }
 
-std::string CharLiteralExpression::toString(size_t) const { return std::format("'{}'", static_cast<char>(value)); }
+void CharLiteralExpression::toString(std::string& out, size_t) const {
+    append(out, "'{}'", static_cast<char>(value));
+}
 
-std::string FunctionCallExpression::toString(size_t indent) const {
-    std::string result = callee->toString(indent) + "(";
-    for (size_t i = 0; i < arguments.size(); ++i) {
-        result += arguments[i]->toString(indent);
-        if (i < arguments.size() - 1) [[likely]] { result += ", "; }
-    }
-    result += ")";
-    return result;
+void FunctionCallExpression::toString(std::string& out, size_t indent) const {
+    callee->toString(out, indent);
+    out += '(';
+    commaSeparatedList(out, arguments, indent);
+    out += ')';
 }
 
-std::string GenericExpression::toString(size_t indent) const {
-    return identifier->toString(indent) + genericsToString(types, indent);
+void GenericExpression::toString(std::string& out, size_t indent) const {
+    identifier->toString(out, indent);
+    genericsToString(out, types, indent);
 }
 
-std::string IdentifierExpression::toString(size_t) const { return value; }
+void IdentifierExpression::toString(std::string& out, size_t) const { out += value; }
 
-std::string IndexExpression::toString(size_t indent) const {
-    return std::format("{}[{}]", variable->toString(indent), index->toString(indent));
+void IndexExpression::toString(std::string& out, size_t indent) const {
+    variable->toString(out, indent);
+    out += '[';
+    index->toString(out, indent);
+    out += ']';
 }
 
-std::string MemberAccessExpression::toString(size_t indent) const {
-    return std::format("{}.{}", object->toString(indent), property);
+void MemberAccessExpression::toString(std::string& out, size_t indent) const {
+    object->toString(out, indent);
+    append(out, ".{}", property);
 }
 
-std::string NumberLiteralExpression::toString(size_t) const { return value.to_string(true); }
+void NumberLiteralExpression::toString(std::string& out, size_t) const { out += value.to_string(true); }
 
-std::string PostfixExpression::toString(size_t indent) const {
-    return std::format(WRAP("{}{}"), left->toString(indent), lexer::tokenTypeToString(op));
+void PostfixExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN;
+    left->toString(out, indent);
+    out += lexer::tokenTypeToString(op);
+    out += WRAP_CLOSE;
 }
 
-std::string PrefixExpression::toString(size_t indent) const {
-    return std::format(WRAP("{}{}"), lexer::tokenTypeToString(op), right->toString(indent));
+void PrefixExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN;
+    out += lexer::tokenTypeToString(op);
+    right->toString(out, indent);
+    out += WRAP_CLOSE;
 }
 
-std::string ScopeResolutionExpression::toString(size_t indent) const {
-    return std::format("{}::{}", scope->toString(indent), element);
+void ScopeResolutionExpression::toString(std::string& out, size_t indent) const {
+    scope->toString(out, indent);
+    append(out, "::{}", element);
 }
 
-std::string SizeofExpression::toString(size_t indent) const {
-    return std::format(WRAP("sizeof({})"), type->toString(indent));
+void SizeofExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN "sizeof(";
+    type->toString(out, indent);
+    out += ")" WRAP_CLOSE;
 }
 
-std::string StringLiteralExpression::toString(size_t) const { return std::format("\"{}\"", value); }
+void StringLiteralExpression::toString(std::string& out, size_t) const { append(out, "\"{}\"", value); }
 
-std::string TypeCastExpression::toString(size_t indent) const {
-    return std::format(WRAP("{} as {}"), originalValue->toString(indent), targetType->toString(indent));
+void TypeCastExpression::toString(std::string& out, size_t indent) const {
+    out += WRAP_OPEN;
+    originalValue->toString(out, indent);
+    out += " as ";
+    targetType->toString(out, indent);
+    out += WRAP_CLOSE;
 }
 
 // Types
 
-std::string AggregateType::toString(size_t indent) const {
-    std::string result = "aggregate {";
-    for (size_t i = 0; i < fieldTypes.size(); ++i) {
-        result += fieldTypes[i]->toString(indent);
-        if (i < fieldTypes.size() - 1) [[likely]] { result += ", "; }
-    }
-    result += "}";
-    return result;
+void AggregateType::toString(std::string& out, size_t indent) const {
+    out += "aggregate {";
+    commaSeparatedList(out, fieldTypes, indent);
+    out += '}';
 }
 
-std::string ArrayType::toString(size_t indent) const {
-    std::string lengthStr;
+void ArrayType::toString(std::string& out, size_t indent) const {
+    elementType->toString(out, indent);
+    out += '[';
     if (lengthExpression) {
-        lengthStr = lengthExpression->toString();
+        lengthExpression->toString(out, 0);
     } else if (semanticType && semanticType->isArray()) {
-        lengthStr = std::to_string(static_cast<const semantic::Array*>(semanticType)->length);
+        append(out, "{}", static_cast<const semantic::Array*>(semanticType)->length);
     }
-    return std::format("{}[{}]", elementType->toString(indent), lengthStr);
+    out += ']';
 }
 
-std::string FunctionType::toString(size_t indent) const {
-    std::string result = "func(";
+void FunctionType::toString(std::string& out, size_t indent) const {
+    out += "func(";
     for (std::size_t i = 0; i < parameterTypes.size(); ++i) {
         const FunctionParameterType& param = parameterTypes[i];
-        result += std::format("{}{}", (param.isMutable ? "mut " : ""), param.type->toString(indent));
-        if (i != parameterTypes.size() - 1) { result += ", "; }
+        if (param.isMutable) { out += "mut "; }
+        param.type->toString(out, indent);
+        if (i != parameterTypes.size() - 1) { out += ", "; }
+    }
+    out += ')';
+    if (returnType) {
+        out += " -> ";
+        returnType->toString(out, indent);
     }
-    result += ")";
-    if (returnType) { result += std::format(" -> {}", returnType->toString(indent)); }
-    return result;
 }
 
-std::string GenericType::toString(size_t indent) const {
-    return baseType->toString(indent) + genericsToString(typeParameters, indent);
+void GenericType::toString(std::string& out, size_t indent) const {
+    baseType->toString(out, indent);
+    genericsToString(out, typeParameters, indent);
 }
 
-std::string PointerType::toString(size_t indent) const {
-    return std::format("ptr {}{}", (isMutable ? "mut " : ""), baseType->toString(indent));
+void PointerType::toString(std::string& out, size_t indent) const {
+    out += isMutable ? "ptr mut " : "ptr ";
+    baseType->toString(out, indent);
 }
 
-std::string SymbolType::toString(size_t) const { return name; }
+void SymbolType::toString(std::string& out, size_t) const { out += name; }
 
-std::string TypeofType::toString(size_t indent) const {
-    return std::format("typeof({})", expression->toString(indent));
+void TypeofType::toString(std::string& out, size_t indent) const {
+    out += "typeof(";
+    expression->toString(out, indent);
+    out += ')';
 }
 
 }  // namespace ast
-}  // namespace Manganese
\ No newline at end of file
+}  // namespace Manganese
@@ -0,0 +1,295 @@
+#include <core.hpp>
+#include <cstdint>
+#include <frontend/ast/flat_ast.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace ast {
+namespace flat {
+
+class TreeBuilder {
+   private:
+    struct PendingChild {
+        const void* node;  // nullptr for a missing optional child
+        NodeClass nodeClass;
+    };
+
+    Tree& tree;
+    std::vector<PendingChild> pending;  // Used as a stack, so one buffer serves every level of the tree
+
+    void push(const Block& block) { pending.push_back(PendingChild{.node = &block, .nodeClass = NodeClass::Block}); }
+    void push(const Statement* s) { pending.push_back(PendingChild{.node = s, .nodeClass = NodeClass::Statement}); }
+    void push(const Expression* e) { pending.push_back(PendingChild{.node = e, .nodeClass = NodeClass::Expression}); }
+    void push(const Type* t) { pending.push_back(PendingChild{.node = t, .nodeClass = NodeClass::Type}); }
+    template <class T>
+    void pushAll(const T& range) {
+        for (const auto* element : range) { push(element); }
+    }
+
+    void pushChildren(const Block& block) { pushAll(block); }
+    void pushChildren(const Statement* statement);
+    void pushChildren(const Expression* expression);
+    void pushChildren(const Type* type);
+
+    NodeId add(const PendingChild& child) {
+        if (tree._classes.size() >= NO_NODE) [[unlikely]] { ASSERT_UNREACHABLE("Too many nodes for a flat AST"); }
+        const NodeId id = static_cast<NodeId>(tree._classes.size());
+        io::SourceLocation location;
+        uint8_t kind = 0;
+        switch (child.nodeClass) {
+            case NodeClass::Block: {
+                const Block& block = *static_cast<const Block*>(child.node);
+                if (!block.empty()) { location = block.front()->getLocation(); }
+                break;
+            }
+            case NodeClass::Statement: {
+                const auto* statement = static_cast<const Statement*>(child.node);
+                location = statement->getLocation();
+                kind = static_cast<uint8_t>(statement->kind);
+                break;
+            }
+            case NodeClass::Expression: {
+                const auto* expression = static_cast<const Expression*>(child.node);
+                location = expression->getLocation();
+                kind = static_cast<uint8_t>(expression->kind);
+                break;
+            }
+            case NodeClass::Type: {
+                const auto* type = static_cast<const Type*>(child.node);
+                location = type->getLocation();
+                kind = static_cast<uint8_t>(type->kind);
+                break;
+            }
+        }
+        tree._classes.push_back(child.nodeClass);
+        tree._kinds.push_back(kind);
+        tree._locations.push_back(location);
+        tree._ranges.emplace_back();
+        tree._subtreeEnds.push_back(id + 1);
+        tree._origins.push_back(child.node);
+        return id;
+    }
+
+   public:
+    explicit TreeBuilder(Tree& output) noexcept : tree(output) {}
+
+    NodeId convert(const PendingChild& child) {
+        if (!child.node) { return NO_NODE; }
+        const NodeId id = add(child);
+        const size_t start = pending.size();
+        switch (child.nodeClass) {
+            case NodeClass::Block: pushChildren(*static_cast<const Block*>(child.node)); break;
+            case NodeClass::Statement: pushChildren(static_cast<const Statement*>(child.node)); break;
+            case NodeClass::Expression: pushChildren(static_cast<const Expression*>(child.node)); break;
+            case NodeClass::Type: pushChildren(static_cast<const Type*>(child.node)); break;
+        }
+        const uint32_t count = static_cast<uint32_t>(pending.size() - start);
+        const uint32_t first = static_cast<uint32_t>(tree._children.size());
+        tree._ranges[id] = ChildRange{.first = first, .count = count};
+        tree._children.resize(first + count);
+        // Converting a child pushes (and then pops) its own children, so index into `pending` rather than iterating
+        for (uint32_t i = 0; i < count; ++i) { tree._children[first + i] = convert(pending[start + i]); }
+        pending.resize(start);
+        tree._subtreeEnds[id] = static_cast<NodeId>(tree._classes.size());
+        return id;
+    }
+
+    NodeId convert(const Block& program) {
+        return convert(PendingChild{.node = &program, .nodeClass = NodeClass::Block});
+    }
+    NodeId convert(const Statement& statement) {
+        return convert(PendingChild{.node = &statement, .nodeClass = NodeClass::Statement});
+    }
+};
+
+void TreeBuilder::pushChildren(const Statement* statement) {
+    switch (statement->kind) {
+        case StatementKind::AggregateDeclarationStatement:
+            for (const AggregateField& field : static_cast<const AggregateDeclarationStatement*>(statement)->fields) {
+                push(field.type);
+            }
+            break;
+        case StatementKind::AliasStatement: push(static_cast<const AliasStatement*>(statement)->baseType); break;
+        case StatementKind::BreakStatement:
+        case StatementKind::ContinueStatement:
+        case StatementKind::EmptyStatement: break;
+        case StatementKind::EnumDeclarationStatement: {
+            const auto* enumDeclaration = static_cast<const EnumDeclarationStatement*>(statement);
+            push(enumDeclaration->baseType);
+            for (const EnumValue& value : enumDeclaration->values) { push(value.value); }
+            break;
+        }
+        case StatementKind::ExpressionStatement:
+            push(static_cast<const ExpressionStatement*>(statement)->expression);
+            break;
+        case StatementKind::ForLoopStatement: {
+            const auto* forLoop = static_cast<const ForLoopStatement*>(statement);
+            push(forLoop->initializationStep);
+            push(forLoop->stopCondition);
+            push(forLoop->postExpression);
+            push(forLoop->body);
+            break;
+        }
+        case StatementKind::FunctionDeclarationStatement: {
+            const auto* function = static_cast<const FunctionDeclarationStatement*>(statement);
+            for (const FunctionParameter& parameter : function->parameters) { push(parameter.type); }
+            push(function->returnType);
+            push(function->body);
+            break;
+        }
+        case StatementKind::IfStatement: {
+            const auto* ifStatement = static_cast<const IfStatement*>(statement);
+            push(ifStatement->condition);
+            push(ifStatement->body);
+            for (const ElifClause& elif : ifStatement->elifs) {
+                push(elif.condition);
+                push(elif.body);
+            }
+            push(ifStatement->elseBody);
+            break;
+        }
+        case StatementKind::NestedBlockStatement:
+            push(static_cast<const NestedBlockStatement*>(statement)->block);
+            break;
+        case StatementKind::ReturnStatement: push(static_cast<const ReturnStatement*>(statement)->value); break;
+        case StatementKind::SwitchStatement: {
+            const auto* switchStatement = static_cast<const SwitchStatement*>(statement);
+            push(switchStatement->variable);
+            for (const CaseClause& clause : switchStatement->cases) {
+                push(clause.literalValue);
+                push(clause.body);
+            }
+            push(switchStatement->defaultBody);
+            break;
+        }
+        case StatementKind::VariableDeclarationStatement: {
+            const auto* declaration = static_cast<const VariableDeclarationStatement*>(statement);
+            push(declaration->type);
+            push(declaration->value);
+            break;
+        }
+        case StatementKind::WhileLoopStatement: {
+            const auto* whileLoop = static_cast<const WhileLoopStatement*>(statement);
+            push(whileLoop->condition);
+            push(whileLoop->body);
+            break;
+        }
+    }
+}
+
+void TreeBuilder::pushChildren(const Expression* expression) {
+    switch (expression->kind) {
+        case ExpressionKind::AggregateInstantiationExpression: {
+            const auto* instantiation = static_cast<const AggregateInstantiationExpression*>(expression);
+            pushAll(instantiation->genericTypes);
+            for (const AggregateInstantiationField& field : instantiation->fields) { push(field.value); }
+            break;
+        }
+        case ExpressionKind::AggregateLiteralExpression:
+            pushAll(static_cast<const AggregateLiteralExpression*>(expression)->elements);
+            break;
+        case ExpressionKind::AlignofExpression: push(static_cast<const AlignofExpression*>(expression)->type); break;
+        case ExpressionKind::ArrayLiteralExpression: {
+            const auto* array = static_cast<const ArrayLiteralExpression*>(expression);
+            push(array->elementType);
+            push(array->lengthExpression);
+            pushAll(array->elements);
+            break;
+        }
+        case ExpressionKind::AssignmentExpression: {
+            const auto* assignment = static_cast<const AssignmentExpression*>(expression);
+            push(assignment->assignee);
+            push(assignment->value);
+            break;
+        }
+        case ExpressionKind::BinaryExpression: {
+            const auto* binary = static_cast<const BinaryExpression*>(expression);
+            push(binary->left);
+            push(binary->right);
+            break;
+        }
+        case ExpressionKind::BoolLiteralExpression:
+        case ExpressionKind::CharLiteralExpression:
+        case ExpressionKind::IdentifierExpression:
+        case ExpressionKind::NumberLiteralExpression:
+        case ExpressionKind::StringLiteralExpression: break;
+        case ExpressionKind::FunctionCallExpression: {
+            const auto* call = static_cast<const FunctionCallExpression*>(expression);
+            push(call->callee);
+            pushAll(call->arguments);
+            break;
+        }
+        case ExpressionKind::GenericExpression: {
+            const auto* generic = static_cast<const GenericExpression*>(expression);
+            push(generic->identifier);
+            pushAll(generic->types);
+            break;
+        }
+        case ExpressionKind::IndexExpression: {
+            const auto* index = static_cast<const IndexExpression*>(expression);
+            push(index->variable);
+            push(index->index);
+            break;
+        }
+        case ExpressionKind::MemberAccessExpression:
+            push(static_cast<const MemberAccessExpression*>(expression)->object);
+            break;
+        case ExpressionKind::PostfixExpression: push(static_cast<const PostfixExpression*>(expression)->left); break;
+        case ExpressionKind::PrefixExpression: push(static_cast<const PrefixExpression*>(expression)->right); break;
+        case ExpressionKind::ScopeResolutionExpression:
+            push(static_cast<const ScopeResolutionExpression*>(expression)->scope);
+            break;
+        case ExpressionKind::SizeofExpression: push(static_cast<const SizeofExpression*>(expression)->type); break;
+        case ExpressionKind::TypeCastExpression: {
+            const auto* cast = static_cast<const TypeCastExpression*>(expression);
+            push(cast->originalValue);
+            push(cast->targetType);
+            break;
+        }
+    }
+}
+
+void TreeBuilder::pushChildren(const Type* type) {
+    switch (type->kind) {
+        case TypeKind::AggregateType: pushAll(static_cast<const AggregateType*>(type)->fieldTypes); break;
+        case TypeKind::ArrayType: {
+            const auto* array = static_cast<const ArrayType*>(type);
+            push(array->elementType);
+            push(array->lengthExpression);
+            break;
+        }
+        case TypeKind::FunctionType: {
+            const auto* function = static_cast<const FunctionType*>(type);
+            for (const FunctionParameterType& parameter : function->parameterTypes) { push(parameter.type); }
+            push(function->returnType);
+            break;
+        }
+        case TypeKind::GenericType: {
+            const auto* generic = static_cast<const GenericType*>(type);
+            push(generic->baseType);
+            pushAll(generic->typeParameters);
+            break;
+        }
+        case TypeKind::PointerType: push(static_cast<const PointerType*>(type)->baseType); break;
+        case TypeKind::SymbolType: break;
+        case TypeKind::TypeofType: push(static_cast<const TypeofType*>(type)->expression); break;
+    }
+}
+
+Tree Tree::build(const Block& program) {
+    Tree tree;
+    TreeBuilder builder(tree);
+    DISCARD(builder.convert(program));
+    return tree;
+}
+
+Tree Tree::build(const Statement& statement) {
+    Tree tree;
+    TreeBuilder builder(tree);
+    DISCARD(builder.convert(statement));
+    return tree;
+}
+
+}  // namespace flat
+}  // namespace ast
+}  // namespace Manganese
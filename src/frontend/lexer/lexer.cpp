@@ -1,15 +1,23 @@
+#include <algorithm>
 #include <cctype>
 #include <core.hpp>
 #include <format>
 #include <frontend/lexer.hpp>
+#include <frontend/lexer/lexer_scan.hpp>
+#include <io/bufferreader.hpp>
 #include <io/filereader.hpp>
 #include <io/logging.hpp>
-#include <io/reader.hpp>
-#include <io/stringreader.hpp>
+#include <io/mappedfilereader.hpp>
+#include <io/source_map.hpp>
 #include <memory>
 #include <mnstl/number.hxx>
+#include <mnstl/string_pool.hxx>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <utils/memory_phase.hpp>
+#include <utils/time_report.hpp>
+#include <vector>
 
 namespace Manganese {
 
@@ -17,30 +25,66 @@ namespace lexer {
 
 //~ Core Lexer Functions
 
-Lexer::Lexer(const std::string& source, Mode mode) : tokenStartLine(1), tokenStartCol(1) {
+Lexer::Lexer(const std::string& source, Mode mode, size_t lookahead) :
+    lookaheadDepth(std::clamp<size_t>(lookahead, 1, MAX_LOOKAHEAD)) {
     switch (mode) {
-        case Mode::String: reader = std::make_unique<io::StringReader>(source); break;
-        case Mode::File: reader = std::make_unique<io::FileReader>(source); break;
+        case Mode::String:
+            // Copy the source so that token lexemes stay valid for as long as the lexer, whatever the caller does
+            ownedSource = source;
+            reader.reset(ownedSource);
+            break;
+        case Mode::FileHeader:
+            // Pages of a mapped file are only read once touched, so this reads little more than the header itself
+            isHeaderOnly = true;
+            [[fallthrough]];
+        case Mode::File:
+            // Map regular files directly; pipes, character devices and the like are drained into memory once
+            if (io::MappedFileReader::isMappable(source)) {
+                mappedSource = std::make_unique<io::MappedFileReader>(source);
+                reader.reset(mappedSource->view());
+            } else {
+                io::FileReader file(source);
+                while (true) {
+                    const char c = file.consumeChar();
+                    if (c == '\0' && file.done()) { break; }
+                    ownedSource += c;
+                }
+                reader.reset(ownedSource);
+            }
+            break;
     }
+    sourceId = io::sourceMap().addSource(reader.slice(0, static_cast<size_t>(reader.end() - reader.cursor())));
+}
+
+Lexer::Lexer(std::string_view source, uint32_t id, size_t begin, size_t end) :
+    ownedSource(source.substr(begin, end - begin)),
+    sourceId(id),
+    baseOffset(begin),
+    ownsSource(false),
+    lookaheadDepth(DEFAULT_LOOKAHEAD_DEPTH) {
+    // Like a chunk, the range is copied so that the reader sees a null-terminated buffer
+    reader.reset(ownedSource);
 }
 
 void Lexer::lex(size_t numTokens) {
     if (done()) { return; }
+    memory::PhaseScope phase(memory::Phase::Lex);
+    timing::PhaseTimer timer(timing::Phase::Lex);
+    // Leave room for the end of file token
+    numTokens = std::min(numTokens, TOKEN_BUFFER_CAPACITY - 1 - tokenStream.size());
     size_t numTokensMade = 0;
     char currentChar = peekChar();
     while (!done() && numTokensMade < numTokens) {
         Result result = Result::Success;
+        const size_t buffered = tokenStream.size();
         if (currentChar == '#') {
             // Single line comment
-            do {
-                advance();
-                currentChar = peekChar();
-            } while (!done() && currentChar != '\n');
+            advance(static_cast<size_t>(scan::findLineEnd(reader.cursor(), reader.end()) - reader.cursor()));
             advance();  // Skip the newline
         } else if (currentChar == '/' && peekChar(1) == '*') {
             result = skipBlockComment();
         } else if (isspace(currentChar)) [[likely]] {  // lots of whitespace
-            advance();  // Skip whitespace
+            advance(static_cast<size_t>(scan::skipWhitespace(reader.cursor(), reader.end()) - reader.cursor()));
         } else if (isalpha(currentChar) || currentChar == '_') [[likely]] {  // Mostly identifiers and keywords
             result = tokenizeKeywordOrIdentifier();
             ++numTokensMade;
@@ -58,81 +102,137 @@ void Lexer::lex(size_t numTokens) {
             result = tokenizeSymbol();
             ++numTokensMade;
         }
+        if (isHeaderOnly && tokenStream.size() > buffered && endHeaderAt(tokenStream.back())) {
+            timing::count(timing::Counter::Tokens, numTokensMade);
+            return;
+        }
         currentChar = peekChar();
-        tokenStartLine = getLine();
-        tokenStartCol = getCol();
+        tokenStart = reader.getPosition();
         _hasError = _hasError || (result == Result::Failure);
     }
     if (done()) {
         // Just finished tokenizing
-        tokenStream.emplace_back(TokenType::EndOfFile, "EOF", getLine(), getCol());
+        tokenStream.emplace_back(TokenType::EndOfFile, "EOF", currentLocation());
     }
+    timing::count(timing::Counter::Tokens, numTokensMade);
 }
 
-Token Lexer::peekToken() noexcept {
-    if (done() && tokenStream.empty()) { return Token(TokenType::EndOfFile, "EOF", getLine(), getCol()); }
-    if (tokenStream.empty()) { lex(QUEUE_LOOKAHEAD_AMOUNT); }
-    return tokenStream[0];
+bool Lexer::endHeaderAt(Token& token) noexcept {
+    if (!atHeaderStatementStart) {
+        atHeaderStatementStart = token.getType() == TokenType::Semicolon;
+        return false;
+    }
+    if (token.getType() == TokenType::Module || token.getType() == TokenType::Import) {
+        atHeaderStatementStart = false;
+        return false;
+    }
+    // The body starts here: replace its first token with the end of the input, and skip the rest without reading it
+    headerEnd = tokenStart;
+    token = Token(TokenType::EndOfFile, "EOF", token.getLocation());
+    advance(static_cast<size_t>(reader.end() - reader.cursor()));
+    return true;
+}
+
+const Token& Lexer::peekToken(size_t n) noexcept {
+    if (n >= tokenStream.size() && !done()) { lex(std::max(lookaheadDepth, n + 1 - tokenStream.size())); }
+    if (n < tokenStream.size()) [[likely]] { return tokenStream[n]; }
+    // Past the end of the input
+    endOfFile = Token(TokenType::EndOfFile, "EOF", currentLocation());
+    return endOfFile;
 }
 
 Token Lexer::consumeToken() noexcept {
-    if (tokenStream.empty()) { lex(QUEUE_LOOKAHEAD_AMOUNT); }
+    if (tokenStream.empty()) { lex(lookaheadDepth); }
     // check if queue is still empty if it is, we are done tokenizing
-    if (tokenStream.empty()) { return Token(TokenType::EndOfFile, "EOF", getLine(), getCol()); }
+    if (tokenStream.empty()) { return Token(TokenType::EndOfFile, "EOF", currentLocation()); }
     Token token = tokenStream.front();
     tokenStream.pop_front();  // get rid of the token
     return token;
 }
 
+std::vector<Token> Lexer::tokenizeAll() {
+    std::vector<Token> tokens;
+    // Rough guess at the token density, to avoid most reallocations
+    tokens.reserve(static_cast<size_t>(reader.end() - reader.cursor()) / 4 + tokenStream.size() + 1);
+    while (true) {
+        if (tokenStream.empty()) { lex(MAX_LOOKAHEAD); }
+        if (tokenStream.empty()) {
+            tokens.emplace_back(TokenType::EndOfFile, "EOF", currentLocation());
+            break;
+        }
+        // Drain the buffer in bulk rather than one consumeToken() at a time
+        while (!tokenStream.empty()) {
+            tokens.push_back(tokenStream.front());
+            tokenStream.pop_front();
+        }
+        if (tokens.back().getType() == TokenType::EndOfFile) { break; }
+    }
+    return tokens;
+}
+
 //~ Main State Machine Functions
 
 Result Lexer::tokenizeCharLiteral() {
     advance();  // Move past the opening quote
-    std::string charLiteral;
-    // For simplicity, just extract a chunk of text, handle it later
+    const size_t bodyStart = reader.getPosition();
+    // For simplicity, just find the end of the literal, handle it later
     // Look for a closing quote
     while (true) {
         if (done()) {
-            logging::logError(getLine(), getCol(), "Unclosed character literal");
-            tokenStream.emplace_back(TokenType::CharLiteral, charLiteral, tokenStartLine, tokenStartCol,
+            logging::logError(currentLocation(), "Unclosed character literal");
+            tokenStream.emplace_back(TokenType::CharLiteral, storeLexeme(literalBody(bodyStart)), tokenLocation(),
                                      /*invalid=*/true);
             return Result::Failure;
         }
         if (peekChar() == '\'') { break; }
         if (peekChar() == '\n') {
-            logging::logError(getLine(), getCol(), "Unclosed character literal");
+            logging::logError(currentLocation(), "Unclosed character literal");
 
-            tokenStream.emplace_back(TokenType::CharLiteral, charLiteral, tokenStartLine, tokenStartCol,
+            tokenStream.emplace_back(TokenType::CharLiteral, storeLexeme(literalBody(bodyStart)), tokenLocation(),
                                      /*invalid=*/true);
             return Result::Failure;
         }
-        if (peekChar() == '\\') {
-            // Skip past a \ so that in '\'' the ' preceded by a \ doesn't get misinterpreted as a closing quote
-            charLiteral += consumeChar();  // Add the backslash to the string
-        }
-        charLiteral += consumeChar();  // Add the character to the string
+        // Skip past a \ so that in '\'' the ' preceded by a \ doesn't get misinterpreted as a closing quote
+        advance(peekChar() == '\\' ? 2 : 1);
     }
+    const std::string_view charLiteral = literalBody(bodyStart);
     advance();
+    if (!validateUTF8(bodyStart, charLiteral)) {
+        tokenStream.emplace_back(TokenType::CharLiteral, storeLexeme(charLiteral), tokenLocation(), /*invalid=*/true);
+        return Result::Failure;
+    }
     Result result = Result::Success;
-    if (charLiteral[0] == '\\') {
+    if (!charLiteral.empty() && charLiteral[0] == '\\') {
         return processCharEscapeSequence(charLiteral);
     } else if (charLiteral.length() > 1) {
-        logging::logError(getLine(), getCol(), "Character literal exceeds 1 character limit");
+        logging::logError(currentLocation(), "Character literal exceeds 1 character limit");
         result = Result::Failure;
     }
-    tokenStream.emplace_back(TokenType::CharLiteral, charLiteral, tokenStartLine, tokenStartCol,
+    // Copied (unlike a string literal's body) so that the lexeme is null-terminated, as the parser reads lexeme[0]
+    tokenStream.emplace_back(TokenType::CharLiteral, storeLexeme(charLiteral), tokenLocation(),
                              /*invalid=*/result == Result::Failure);
     return result;
 }
 
 Result Lexer::tokenizeKeywordOrIdentifier() {
-    std::string lexeme = "";
-    while (!done() && (isalnum(peekChar()) || peekChar() == '_')) { lexeme += consumeChar(); }
+    const size_t start = reader.getPosition();
+    advance(static_cast<size_t>(scan::skipIdentifier(reader.cursor(), reader.end()) - reader.cursor()));
+    const std::string_view lexeme = reader.slice(start, reader.getPosition() - start);
     TokenType t = keywordLookup(lexeme);
 
-    // if t is unknown, assume it's an identifier, otherwise use the given keyword type
-    tokenStream.emplace_back(t == TokenType::Unknown ? TokenType::Identifier : t, lexeme, tokenStartLine,
-                             tokenStartCol);
+    if (t != TokenType::Unknown) {
+        tokenStream.emplace_back(t, lexeme, tokenLocation());
+        return Result::Success;
+    }
+    // Otherwise it's an identifier, whose name is interned so that later passes can compare and hash it as an integer
+    if (isChunk) {
+        // The parent lexer interns this once every chunk is done, so atoms are handed out in source order
+        tokenStream.emplace_back(TokenType::Identifier, lexeme, tokenLocation());
+        return Result::Success;
+    }
+    mnstl::string_pool& pool = identifierPool();
+    Token& token = tokenStream.emplace_back(TokenType::Identifier, pool.view(pool.intern(lexeme)), tokenLocation());
+    token._isInterned = true;
     return Result::Success;
 }
 
@@ -153,14 +253,14 @@ Result Lexer::tokenizeNumber() {
         } else if (currentChar == '.') {
             if (isFloat) {
                 // Invalid number -- two decimal points
-                logging::logError(getLine(), getCol(), "Invalid number literal: multiple decimal points");
+                logging::logError(currentLocation(), "Invalid number literal: multiple decimal points");
                 advance();
                 result = Result::Failure;
                 continue;
             }
             // Reject floating point for octal and binary numbers
             if (base == mnstl::Base::Octal || base == mnstl::Base::Binary) {
-                logging::logError(getLine(), getCol(),
+                logging::logError(currentLocation(),
                                   "Invalid number literal: floating point not allowed for {} numbers",
                                   baseToString(base));
                 advance();
@@ -176,7 +276,7 @@ Result Lexer::tokenizeNumber() {
                 // suffix starts
                 break;
             }
-            logging::logError(getLine(), getCol(), "Invalid digit '{}' in numeric constant", currentChar);
+            logging::logError(currentLocation(), "Invalid digit '{}' in numeric constant", currentChar);
             advance();
             result = Result::Failure;
             continue;
@@ -187,19 +287,21 @@ Result Lexer::tokenizeNumber() {
     // Handle scientific notation (e.g., 1.23e4), size suffixes (e.g., 1.23f), etc.
     if (processNumberSuffix(base, numberLiteral, isFloat) == Result::Failure) { result = Result::Failure; }
     if (isFloat && base != mnstl::Base::Decimal) {
-        logging::logError(getLine(), getCol(), "Invalid floating-point literal {}. Only decimal floats are supported.",
+        logging::logError(currentLocation(), "Invalid floating-point literal {}. Only decimal floats are supported.",
                           numberLiteral);
         result = Result::Failure;
     }
-    tokenStream.emplace_back(isFloat ? TokenType::FloatLiteral : TokenType::IntegerLiteral, numberLiteral,
-                             tokenStartLine, tokenStartCol, /*invalid=*/result == Result::Failure);
+    // Converted here, once, so the parser (and anything else holding the token) can read the value directly
+    tokenStream.emplace_back(isFloat ? TokenType::FloatLiteral : TokenType::IntegerLiteral,
+                             storeNumberLexeme(numberLiteral, mnstl::str_to_num(numberLiteral, isFloat)),
+                             tokenLocation(), /*invalid=*/result == Result::Failure);
     return result;
 }
 
 Result Lexer::skipBlockComment() {
     advance(2);  // Skip the /*
     int64_t commentDepth = 1;  // Allow nested comments
-    size_t startLine = getLine(), startCol = getCol();
+    const io::SourceLocation start = currentLocation();
     while (!done() && commentDepth > 0) {
         if (peekChar() == '/' && peekChar(1) == '*') {
             ++commentDepth;
@@ -213,9 +315,10 @@ Result Lexer::skipBlockComment() {
         }
     }
     if (commentDepth > 0) {
-        logging::logError(getLine(), getCol(),
-                          "Unclosed block comment at end of file (comment started at line {}, column {})", startLine,
-                          startCol);
+        const io::LineColumn startPosition = io::sourceMap().resolve(start);
+        logging::logError(currentLocation(),
+                          "Unclosed block comment at end of file (comment started at line {}, column {})",
+                          startPosition.line, startPosition.column);
         return Result::Failure;
     }
     return Result::Success;
@@ -223,52 +326,64 @@ Result Lexer::skipBlockComment() {
 
 Result Lexer::tokenizeStringLiteral() {
     advance();  // Move past the opening quote
+    const size_t bodyStart = reader.getPosition();
     bool containsEscapeSequence = false;
-    std::string stringLiteral;
 
-    // for simplicity, just extract a chunk of text until the closing quote -- check it afterwards
+    // for simplicity, just find the closing quote -- check the body afterwards
     while (true) {
         if (done()) {
-            logging::logError(getLine(), getCol(), "Unclosed string literal");
-            tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenStartLine, tokenStartCol,
+            logging::logError(currentLocation(), "Unclosed string literal");
+            tokenStream.emplace_back(TokenType::StrLiteral, literalBody(bodyStart), tokenLocation(),
                                      /*invalid=*/true);
             return Result::Failure;
         }
+        // Skip everything up to the next quote, backslash or newline in one go
+        advance(static_cast<size_t>(scan::skipStringBody(reader.cursor(), reader.end()) - reader.cursor()));
+        if (done()) { continue; }
         if (peekChar() == '"') { break; }
         if (peekChar() == '\\') {
-            if (peekChar(1) == '\n') {
-                // continuing a string literal across lines
-                advance(2);  // Skip the backslash and the newline
-                continue;
-            }
-            // Escape sequence -- skip past the next character (e.g., don't consider a \" as a closing quote)
-            stringLiteral += consumeChar();  // Add the backslash to the string
+            // Escape sequence (or a line continuation) -- skip past the next character (e.g., don't consider a \" as
+            // a closing quote), and resolve it once the whole body is known
             containsEscapeSequence = true;
-        } else if (peekChar() == '\n') {
-            logging::logError(
-                getLine(), getCol(),
-                "String literal cannot span multiple lines. If you wanted a string literal that spans lines, add a backslash ('\\') at the end of the line");
-
-            tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenStartLine, tokenStartCol,
-                                     /*invalid=*/true);
-            return Result::Failure;
+            advance(2);
+            continue;
         }
-        stringLiteral += consumeChar();  // Add the character to the string
+        // Otherwise it's a newline
+        logging::logError(
+            currentLocation(),
+            "String literal cannot span multiple lines. If you wanted a string literal that spans lines, add a backslash ('\\') at the end of the line");
+
+        tokenStream.emplace_back(TokenType::StrLiteral, literalBody(bodyStart), tokenLocation(), /*invalid=*/true);
+        return Result::Failure;
     }
 
-    Result result = Result::Success;
+    const std::string_view stringLiteral = literalBody(bodyStart);
     advance();
-    if (containsEscapeSequence) {
-        std::optional<std::string> processedString = resolveEscapeCharacters(stringLiteral);
-        if (!processedString) {
-            result = Result::Failure;
-        } else {
-            stringLiteral = std::move(*processedString);
-        }
+    if (!validateUTF8(bodyStart, stringLiteral)) {
+        tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenLocation(), /*invalid=*/true);
+        return Result::Failure;
     }
-    tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenStartLine, tokenStartCol,
-                             /*invalid=*/result == Result::Failure);
-    return result;
+    if (!containsEscapeSequence) [[likely]] {
+        // Nothing to resolve, so the lexeme is the body itself, in the source buffer (which outlives the tokens)
+        tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenLocation());
+        return Result::Success;
+    }
+    std::optional<std::string_view> processedString = decodeLiteral(stringLiteral, /*lineContinuations=*/true);
+    if (!processedString) {
+        tokenStream.emplace_back(TokenType::StrLiteral, stringLiteral, tokenLocation(), /*invalid=*/true);
+        return Result::Failure;
+    }
+    tokenStream.emplace_back(TokenType::StrLiteral, *processedString, tokenLocation());
+    return Result::Success;
+}
+
+bool Lexer::validateUTF8(size_t bodyStart, std::string_view body) {
+    const char* invalid = scan::skipValidUTF8(body.data(), body.data() + body.size());
+    if (invalid == body.data() + body.size()) [[likely]] { return true; }
+    logging::logError(location(bodyStart + static_cast<size_t>(invalid - body.data())),
+                      "Invalid UTF-8 in literal (byte 0x{:02X})",
+                      static_cast<unsigned>(static_cast<unsigned char>(*invalid)));
+    return false;
 }
 
 Result Lexer::tokenizeSymbol() {
@@ -277,7 +392,8 @@ Result Lexer::tokenizeSymbol() {
     char current = peekChar();
     char next = peekChar(1);
     char nextnext = peekChar(2);
-    std::string lexeme = std::string(1, current);
+    // Every operator is spelled exactly as it appears in the source, so only its length needs tracking
+    size_t length = 1;
 
     // In here, use TokenType::Operator as a generic value (exact enum mapping determined at the end)
     switch (current) {
@@ -292,10 +408,10 @@ Result Lexer::tokenizeSymbol() {
         // ~ Boolean / Bitwise operators
         case '&': {
             if (next == '&') {  // logical AND (&&)
-                lexeme += next;
+                ++length;
                 type = TokenType::And;
             } else if (next == '=') {
-                lexeme += next;
+                ++length;
                 type = TokenType::BitAndAssign;
             } else {
                 type = TokenType::BitAnd;
@@ -305,10 +421,10 @@ Result Lexer::tokenizeSymbol() {
             // Let the parser decide if '&' is a bitwise AND or an address-of operator, default to bitwise AND
         case '|': {
             if (next == '|') {  // logical OR (||)
-                lexeme += next;
+                ++length;
                 type = TokenType::Or;
             } else if (next == '=') {
-                lexeme += next;
+                ++length;
                 type = TokenType::BitOrAssign;
             } else {
                 type = TokenType::BitOr;
@@ -318,13 +434,13 @@ Result Lexer::tokenizeSymbol() {
         case '^': {  // Bitwise XOR
             if (next == '=') {
                 // Bitwise assignment operator (^=)
-                lexeme += '=';
+                ++length;
                 type = TokenType::BitXorAssign;
             }
             // else if (next == '^') {
             //     // Exponentiation operator (^^)
-            //     lexeme += '^';
-            //     lexeme += (nextnext == '=') ? "=" : "";  // ^^=, in place exponentiation
+            //     ++length;
+            //     length += (nextnext == '=') ? 1 : 0;  // ^^=, in place exponentiation
             //     type = (nextnext == '=') ? TokenType::ExpAssign : TokenType::Exp;
             // }
             else {
@@ -334,7 +450,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case '!': {
             if (next == '=') {  // Inequality (!=)
-                lexeme += next;
+                ++length;
                 type = TokenType::NotEqual;
             } else {
                 type = TokenType::Not;
@@ -343,7 +459,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case '~': {
             if (next == '=') {
-                lexeme += next;
+                ++length;
                 type = TokenType::BitNotAssign;
             } else {
                 type = TokenType::BitNot;
@@ -352,7 +468,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case '=': {
             if (next == '=') {  // Equality (==)
-                lexeme += next;
+                ++length;
                 type = TokenType::Equal;
             } else {
                 type = TokenType::Assignment;
@@ -362,13 +478,13 @@ Result Lexer::tokenizeSymbol() {
         case '<': {
             if (next == '=') {
                 // Less than or Equal to (<=)
-                lexeme += '=';
+                ++length;
                 type = TokenType::LessThanOrEqual;
             } else if (next == current) {
                 // Bitwise left shift (<<)
-                lexeme += next;
+                ++length;
                 // In place left shift (<<=)
-                lexeme += (nextnext == '=') ? "=" : "";
+                length += (nextnext == '=') ? 1 : 0;
                 type = (nextnext == '=') ? TokenType::BitLShiftAssign : TokenType::BitLShift;
             } else {
                 type = TokenType::LessThan;
@@ -378,13 +494,13 @@ Result Lexer::tokenizeSymbol() {
         case '>': {
             if (next == '=') {
                 // Greater than or Equal to (>=)
-                lexeme += '=';
+                ++length;
                 type = TokenType::GreaterThanOrEqual;
             } else if (next == current) {
                 // Bitwise right shift (>>)
-                lexeme += next;
+                ++length;
                 // In place right shift (>>=)
-                lexeme += (nextnext == '=') ? "=" : "";
+                length += (nextnext == '=') ? 1 : 0;
                 type = (nextnext == '=') ? TokenType::BitRShiftAssign : TokenType::BitRShift;
             } else {
                 type = TokenType::GreaterThan;
@@ -397,7 +513,7 @@ Result Lexer::tokenizeSymbol() {
         case ',': type = TokenType::Comma; break;
         case '.': {
             if (next == '.' && nextnext == '.') {
-                lexeme = "...";
+                length = 3;
                 type = TokenType::Ellipsis;
             } else {
                 type = TokenType::MemberAccess;
@@ -406,7 +522,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case ':': {
             type = (next == ':') ? TokenType::ScopeResolution : TokenType::Colon;
-            lexeme = (next == ':') ? "::" : ":";
+            length = (next == ':') ? 2 : 1;
             break;
         }
         case '@': type = TokenType::At; break;
@@ -414,10 +530,10 @@ Result Lexer::tokenizeSymbol() {
         //~ Arithmetic operators
         case '+': {
             if (next == '+') {
-                lexeme += next;
+                ++length;
                 type = TokenType::Inc;
             } else if (next == '=') {
-                lexeme += next;
+                ++length;
                 type = TokenType::PlusAssign;
             } else {
                 type = TokenType::Plus;
@@ -426,13 +542,13 @@ Result Lexer::tokenizeSymbol() {
         }
         case '-': {
             if (next == '-') {
-                lexeme += next;
+                ++length;
                 type = TokenType::Dec;
             } else if (next == '=') {
-                lexeme += next;
+                ++length;
                 type = TokenType::MinusAssign;
             } else if (next == '>') {
-                lexeme += next;
+                ++length;
                 type = TokenType::Arrow;
             } else {
                 type = TokenType::Minus;
@@ -441,7 +557,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case '%': {
             if (next == '=') {
-                lexeme += '=';
+                ++length;
                 type = TokenType::ModAssign;
             } else {
                 type = TokenType::Mod;
@@ -450,7 +566,7 @@ Result Lexer::tokenizeSymbol() {
         }
         case '*': {
             if (next == '=') {
-                lexeme += '=';
+                ++length;
                 type = TokenType::MulAssign;
             } else {
                 type = TokenType::Mul;
@@ -459,11 +575,11 @@ Result Lexer::tokenizeSymbol() {
         }
         case '/': {
             if (next == '=') {
-                lexeme += '=';
+                ++length;
                 type = TokenType::DivAssign;
             } else if (next == '/') {
-                lexeme += next;
-                lexeme += (nextnext == '=') ? "=" : "";
+                ++length;
+                length += (nextnext == '=') ? 1 : 0;
                 type = (nextnext == '=') ? TokenType::FloorDivAssign : TokenType::FloorDiv;
             } else {
                 type = TokenType::Div;
@@ -473,18 +589,29 @@ Result Lexer::tokenizeSymbol() {
         }
         default:
             type = TokenType::Unknown;
-            logging::logError(getLine(), getCol(), "Invalid character: '{}'", current);
+            logging::logError(currentLocation(), "Invalid character: '{}'", current);
             result = Result::Failure;
             break;
     }
-    advance(lexeme.length());
-    tokenStream.emplace_back(type, lexeme, tokenStartLine, tokenStartCol,
+    const size_t start = reader.getPosition();
+    advance(length);
+    tokenStream.emplace_back(type, reader.slice(start, length), tokenLocation(),
                              /*invalid=*/result == Result::Failure);
     return result;
 }
 
 //~ Helper Functions
 
+std::string_view Lexer::storeNumberLexeme(std::string_view lexeme, const NumberLiteralValue& value) {
+    auto* memory = static_cast<char*>(
+        lexemeArena.allocate(sizeof(NumberLiteralValue) + lexeme.size() + 1, alignof(NumberLiteralValue)));
+    std::construct_at(reinterpret_cast<NumberLiteralValue*>(memory), value);
+    char* characters = memory + sizeof(NumberLiteralValue);
+    std::copy(lexeme.begin(), lexeme.end(), characters);
+    characters[lexeme.size()] = '\0';
+    return std::string_view(characters, lexeme.size());
+}
+
 NumberPrefixResult Lexer::processNumberPrefix() {
     char currentChar = peekChar();
     if (currentChar != '0') {
@@ -510,14 +637,14 @@ NumberPrefixResult Lexer::processNumberPrefix() {
             return NumberPrefixResult{.base = mnstl::Base::Octal, .isValidBaseChar = isodigit, .prefix = "0o"};
         default:
             // Not a valid base indicator -- just treat it as a decimal number
-            logging::logWarning(getLine(), getCol(),
+            logging::logWarning(currentLocation(),
                                 "Leading zeros in numeric literals are treated as decimal numbers."
                                 "Use a 0o prefix for octal numbers.");
             return NumberPrefixResult{.base = mnstl::Base::Decimal, .isValidBaseChar = isdigit, .prefix = ""};
     }
 }
 
-Result Lexer::processNumberSuffix(mnstl::Base base, std::string& numberLiteral, bool isFloat) {
+Result Lexer::processNumberSuffix(mnstl::Base base, std::string& numberLiteral, bool& isFloat) {
     /*
         The valid numeric suffixes are:
         - i8, i16, i32, i64, i128 (signed integers with the corresponding bit width)
@@ -532,49 +659,10 @@ Result Lexer::processNumberSuffix(mnstl::Base base, std::string& numberLiteral,
         return value;
     };
 
-    // Suffix Handling
-
-    char currentChar = tolower(peekChar());
-    if (currentChar == 'i' || currentChar == 'u' || currentChar == 'f') {
-        char suffix = tolower(consumeChar());
-        int width = readUint();
-        if (width == 0) {
-            logging::logError(getLine(), getCol(), "Invalid Numeric Suffix {}", width);
-            return Result::Failure;
-        }
-        const bool validIntWidth = (width == 8 || width == 16 || width == 32 || width == 64 || width == 128);
-        const bool validFloatWidth = (width == 32 || width == 64);
-
-        if ((suffix == 'i' || suffix == 'u') && !validIntWidth) {
-            logging::logError(getLine(), getCol(), "Invalid integer suffix '{}': must be 8, 16, 32, 64 or 128", suffix);
-            return Result::Failure;
-        }
-        if (suffix == 'f' && !validFloatWidth) {
-            logging::logError(getLine(), getCol(), "Invalid float suffix '{}': must be 32 or 64", suffix);
-            return Result::Failure;
-        }
-        if (suffix == 'f' && !isFloat) {
-            logging::logError(getLine(), getCol(), "Float suffix '{}' can only be used with floating-point literals",
-                              suffix);
-            return Result::Failure;
-        }
-
-        if ((suffix == 'i' || suffix == 'u') && isFloat) {
-            logging::logError(getLine(), getCol(), "Integer suffix '{}' cannot be used with floating-point literals",
-                              suffix);
-            return Result::Failure;
-        }
-        numberLiteral += suffix;
-        numberLiteral += std::to_string(width);
-    }
-
     // Scientific Notation
 
-    currentChar = tolower(peekChar());
-
-    if (!isalpha(currentChar)) {  // there's no scientific notation
-        return Result::Success;
-    }
+    char currentChar = tolower(peekChar());
+    auto isSuffixStart = [](char c) { return c == 'i' || c == 'u' || c == 'f'; };
 
     auto processScientificNotation = [&](char expected) -> Result {
         if (currentChar != expected) { return Result::Failure; }
@@ -585,14 +673,14 @@ Result Lexer::processNumberSuffix(mnstl::Base base, std::string& numberLiteral,
         if (next == '+' || next == '-') { numberLiteral += consumeChar(); }
 
         if (!isdigit(peekChar())) {
-            logging::logError(getLine(), getCol(), "Invalid exponent: must be a number");
+            logging::logError(currentLocation(), "Invalid exponent: must be a number");
             return Result::Failure;
         }
         Result result = Result::Success;
 
-        while (!done() && isalnum(peekChar())) {
+        while (!done() && isalnum(peekChar()) && !isSuffixStart(tolower(peekChar()))) {
             if (!isdigit(peekChar())) {
-                logging::logError(getLine(), getCol(), "Invalid character {} in exponent", peekChar());
+                logging::logError(currentLocation(), "Invalid character {} in exponent", peekChar());
                 result = Result::Failure;
                 advance();
                 continue;
@@ -603,22 +691,67 @@ Result Lexer::processNumberSuffix(mnstl::Base base, std::string& numberLiteral,
         return result;
     };
 
-    if (base == mnstl::Base::Decimal) {
+    if (!isalpha(currentChar) || isSuffixStart(currentChar)) {
+        // There's no scientific notation
+    } else if (base == mnstl::Base::Decimal) {
         if (processScientificNotation('e') == Result::Failure) {
-            logging::logError(getLine(), getCol(), "Invalid decimal float: must have 'e' exponent");
+            logging::logError(currentLocation(), "Invalid decimal float: must have 'e' exponent");
             return Result::Failure;
         }
+        isFloat = true;  // An exponent makes a float, even without a decimal point (e.g. 1e-400)
     } else if (base == mnstl::Base::Hexadecimal && isFloat) {
         // if (processScientificNotation('p') == Result::Failure) {
-        //     logging::logError(getLine(), getCol(), "Invalid hexadecimal float: must have 'p' exponent");
+        //     logging::logError(currentLocation(), "Invalid hexadecimal float: must have 'p' exponent");
         //     return Result::Failure;
         // }
     } else {
         if (tolower(peekChar()) == 'e') {  //|| (char)std::tolower(peekChar()) == 'p') {
-            logging::logError(getLine(), getCol(), "{} numbers do not support exponents", baseToString(base));
+            logging::logError(currentLocation(), "{} numbers do not support exponents", baseToString(base));
+        }
+        while (isalnum(peekChar())) {
+            logging::logError(currentLocation(), "Invalid character {} in numeric literal", consumeChar());
+        }
+        return Result::Failure;
+    }
+
+    // Suffix Handling (after any exponent, as in 1.5e3f32)
+
+    currentChar = tolower(peekChar());
+    if (currentChar == 'i' || currentChar == 'u' || currentChar == 'f') {
+        char suffix = tolower(consumeChar());
+        int width = readUint();
+        if (width == 0) {
+            logging::logError(currentLocation(), "Invalid Numeric Suffix {}", width);
+            return Result::Failure;
+        }
+        const bool validIntWidth = (width == 8 || width == 16 || width == 32 || width == 64 || width == 128);
+        const bool validFloatWidth = (width == 32 || width == 64);
+
+        if ((suffix == 'i' || suffix == 'u') && !validIntWidth) {
+            logging::logError(currentLocation(), "Invalid integer suffix '{}': must be 8, 16, 32, 64 or 128", suffix);
+            return Result::Failure;
         }
+        if (suffix == 'f' && !validFloatWidth) {
+            logging::logError(currentLocation(), "Invalid float suffix '{}': must be 32 or 64", suffix);
+            return Result::Failure;
+        }
+        if (suffix == 'f' && !isFloat) {
+            logging::logError(currentLocation(), "Float suffix '{}' can only be used with floating-point literals",
+                              suffix);
+            return Result::Failure;
+        }
+
+        if ((suffix == 'i' || suffix == 'u') && isFloat) {
+            logging::logError(currentLocation(), "Integer suffix '{}' cannot be used with floating-point literals",
+                              suffix);
+            return Result::Failure;
+        }
+        numberLiteral += suffix;
+        numberLiteral += std::to_string(width);
+    }
+    if (isalnum(peekChar())) {
         while (isalnum(peekChar())) {
-            logging::logError(getLine(), getCol(), "Invalid character {} in numeric literal", consumeChar());
+            logging::logError(currentLocation(), "Invalid character {} in numeric literal", consumeChar());
         }
         return Result::Failure;
     }
@@ -1,11 +1,12 @@
+#include <algorithm>
+#include <cstring>
 #include <format>
 #include <frontend/lexer.hpp>
 #include <io/logging.hpp>
 #include <mnstl/number.hxx>
 #include <optional>
 #include <string>
-
-// TODO: Rework to properly handle unicode, validation, etc.
+#include <string_view>
 
 namespace Manganese {
 namespace lexer {
@@ -31,59 +32,67 @@ constexpr inline uint8_t UTF8_CONT_SHIFT = 6;
 constexpr inline uint8_t UTF8_2B_SHIFT = 12;
 constexpr inline uint8_t UTF8_3B_SHIFT = 18;
 
-std::optional<std::string> Lexer::resolveEscapeCharacters(const std::string& escapeString) {
-    std::string processed;
-    processed.reserve(escapeString.length() - 1);
-    size_t i = 0;
-    while (i < escapeString.length()) {
-        if (escapeString[i] != '\\') [[likely]] {  // Most characters are not escaped
-            processed += escapeString[i++];
-            continue;
-        }
-        ++i;  // skip the backslash
-        if (i >= escapeString.length()) {
-            logging::logError(getLine(), getCol(), "Incomplete escape sequence at end of string");
+std::optional<std::string_view> Lexer::decodeLiteral(std::string_view body, bool lineContinuations) {
+    // No escape sequence is shorter than the UTF-8 it stands for, so the decoded literal fits in the body's size
+    char* const decoded = static_cast<char*>(lexemeArena.allocate(body.size() + 1, alignof(char)));
+    char* out = decoded;
+    const char* p = body.data();
+    const char* const end = p + body.size();
+    while (true) {
+        // Most characters are not escaped, so copy everything up to the next backslash at once
+        const void* backslash = std::memchr(p, '\\', static_cast<size_t>(end - p));
+        const char* runEnd = backslash ? static_cast<const char*>(backslash) : end;
+        std::memcpy(out, p, static_cast<size_t>(runEnd - p));
+        out += runEnd - p;
+        p = runEnd;
+        if (p == end) { break; }
+        ++p;  // skip the backslash
+        if (p == end) {
+            logging::logError(currentLocation(), "Incomplete escape sequence at end of string");
             return std::nullopt;
         }
+        const char kind = *p++;
+        if (kind == '\n' && lineContinuations) { continue; }  // A line continuation stands for nothing
+        // The digits of a \u, \U or \x escape (fewer than expected if the body ends first, which is then an error)
+        auto digits = [&](size_t count) {
+            const std::string_view escDigits(p, std::min(count, static_cast<size_t>(end - p)));
+            p += escDigits.size();
+            return escDigits;
+        };
         std::optional<char32_t> escapeChar;
-        uint8_t skipLength = 1;
-        if (escapeString[i] == 'u') {
-            std::string escDigits = escapeString.substr(i + 1, 4);  // 4 for uXXXX
-            escapeChar = resolveUnicodeCharacters(escDigits, getLine(), getCol());
-            skipLength = 5;
-        } else if (escapeString[i] == 'U') {
-            std::string escDigits = escapeString.substr(i + 1, 8);  // 8 for UXXXXXXXX
-            escapeChar = resolveUnicodeCharacters(escDigits, getLine(), getCol(), /*isLongUnicode=*/true);
-            skipLength = 9;
-        } else if (escapeString[i] == 'x') [[unlikely]] {  // Hex escape sequences aren't usually used
-            std::string escDigits = escapeString.substr(i + 1, 2);  // 2 for xXX
-            escapeChar = resolveHexCharacters(escDigits);
-            skipLength = 3;
+        if (kind == 'u') {
+            escapeChar = resolveUnicodeCharacters(digits(4), currentLocation());  // 4 for uXXXX
+        } else if (kind == 'U') {
+            // 8 for UXXXXXXXX
+            escapeChar = resolveUnicodeCharacters(digits(8), currentLocation(), /*isLongUnicode=*/true);
+        } else if (kind == 'x') [[unlikely]] {  // Hex escape sequences aren't usually used
+            escapeChar = resolveHexCharacters(digits(2));  // 2 for xXX
         } else {
-            escapeChar = getEscapeCharacter(escapeString[i], getLine(), getCol());
+            escapeChar = getEscapeCharacter(kind, currentLocation());
         }
         if (!escapeChar) {
-            if (escapeString[i] == 'x') {
-                logging::logError(getLine(), getCol(), "Invalid hex escape sequence (expected \\xXX)");
-            } else if (escapeString[i] == 'u') {
-                logging::logError(getLine(), getCol(), "Invalid unicode escape sequence (expected \\uXXXX)");
+            if (kind == 'x') {
+                logging::logError(currentLocation(), "Invalid hex escape sequence (expected \\xXX)");
+            } else if (kind == 'u') {
+                logging::logError(currentLocation(), "Invalid unicode escape sequence (expected \\uXXXX)");
             }
             return std::nullopt;
         }
-        i += skipLength;
-        processed += encodeUTF8String(*escapeChar);
+        out += encodeUTF8(*escapeChar, out);
     }
-    return processed;
+    *out = '\0';  // Like storeLexeme()'s copies, so a character literal's lexeme can be read as a C string
+    return std::string_view(decoded, static_cast<size_t>(out - decoded));
 }
 
-Result Lexer::processCharEscapeSequence(const std::string& charLiteral) {
-    std::optional<std::string> resolved = resolveEscapeCharacters(charLiteral);
+Result Lexer::processCharEscapeSequence(std::string_view charLiteral) {
+    std::optional<std::string_view> resolved = decodeLiteral(charLiteral, /*lineContinuations=*/false);
     if (!resolved) {
-        logging::logError(getLine(), getCol(), "Invalid character literal", charLiteral);
-        tokenStream.emplace_back(TokenType::CharLiteral, charLiteral, getLine(), getCol(), /*invalid=*/true);
+        logging::logError(currentLocation(), "Invalid character literal", charLiteral);
+        tokenStream.emplace_back(TokenType::CharLiteral, storeLexeme(charLiteral), currentLocation(),
+                                 /*invalid=*/true);
         return Result::Failure;
     }
-    std::string processed = *resolved;
+    std::string_view processed = *resolved;
     // For escaped characters, we need to check if it represents a single code point
     // not necessarily the same as the length of the resolved string being 1
     size_t byteCount = processed.length();
@@ -96,15 +105,16 @@ Result Lexer::processCharEscapeSequence(const std::string& charLiteral) {
     }
     Result result = Result::Success;
     if (!isValidSingleCodePoint) {
-        logging::logError(getLine(), getCol(), "Invalid character literal ", charLiteral);
+        logging::logError(currentLocation(), "Invalid character literal ", charLiteral);
         result = Result::Failure;
     }
-    tokenStream.emplace_back(TokenType::CharLiteral, processed, getLine(), getCol(),
+    // Already in the arena (see decodeLiteral()), so there is nothing to copy
+    tokenStream.emplace_back(TokenType::CharLiteral, processed, currentLocation(),
                              /*invalid=*/result == Result::Failure);
     return result;
 }
 
-std::optional<char> getEscapeCharacter(const char escapeChar, size_t line, size_t col) {
+std::optional<char> getEscapeCharacter(const char escapeChar, io::SourceLocation location) {
     switch (escapeChar) {
         case '\\': return '\\';
         case '\'': return '\'';
@@ -119,7 +129,7 @@ std::optional<char> getEscapeCharacter(const char escapeChar, size_t line, size_
         case '0': return '\0';
         default:
             logging::logError(
-                line, col,
+                location,
                 "\\{} is not a valid escape sequence. If you meant to type a backslash ('\\'), use two backslashes ",
                 escapeChar);
             return std::nullopt;
@@ -133,7 +143,7 @@ inline int hexDigitToInt(char c) {
     return -1;  // Not a valid hex digit
 }
 
-std::optional<char32_t> resolveHexCharacters(const std::string& esc) {
+std::optional<char32_t> resolveHexCharacters(std::string_view esc) {
     // Check that the string is exactly 2 characters long
     if (esc.length() != 2) { return std::nullopt; }
     // Check that both characters are hex digits
@@ -144,7 +154,8 @@ std::optional<char32_t> resolveHexCharacters(const std::string& esc) {
     return hexChar;
 }
 
-std::optional<char32_t> resolveUnicodeCharacters(const std::string& esc, size_t line, size_t col, bool isLongUnicode) {
+std::optional<char32_t> resolveUnicodeCharacters(std::string_view esc, io::SourceLocation location,
+                                                 bool isLongUnicode) {
     size_t expectedLength = isLongUnicode ? 8 : 4;  // 8 for \UXXXXXXXX, 4 for \uXXXX
     if (esc.length() != expectedLength) { return std::nullopt; }
     char32_t unicodeChar = 0;
@@ -155,39 +166,42 @@ std::optional<char32_t> resolveUnicodeCharacters(const std::string& esc, size_t
     }
     if (unicodeChar >= UTF16_SURROGATE_MIN && unicodeChar <= UTF16_SURROGATE_MAX) {
         // Invalid Unicode character in the surrogate range
-        logging::logError(line, col, "Error: Invalid Unicode character in the surrogate range");
+        logging::logError(location, "Error: Invalid Unicode character in the surrogate range");
         return std::nullopt;
     }
     if (unicodeChar > UTF8_4B_MAX) {
         // Unicode character is outside the valid range for UTF-8
-        logging::logError(line, col, "Error: Unicode character is outside the valid range for UTF-8");
+        logging::logError(location, "Error: Unicode character is outside the valid range for UTF-8");
         return std::nullopt;
     }
     return unicodeChar;
 }
 
-std::string encodeUTF8String(char32_t wideChar) {
-    std::string result;
+size_t encodeUTF8(char32_t wideChar, char* out) noexcept {
     if (wideChar <= UTF8_1B_MAX) {
-        result += static_cast<char>(wideChar);  // Narrow character
-    } else if (wideChar <= UTF8_2B_MAX) {
+        out[0] = static_cast<char>(wideChar);  // Narrow character
+        return 1;
+    }
+    if (wideChar <= UTF8_2B_MAX) {
         // 2-byte UTF-8 character
-        result += static_cast<char>(UTF8_2B_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_2B_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
-    } else if (wideChar <= UTF8_3B_MAX) {
+        out[0] = static_cast<char>(UTF8_2B_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_2B_MASK));
+        out[1] = static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
+        return 2;
+    }
+    if (wideChar <= UTF8_3B_MAX) {
         // 3-byte UTF-8 character
-        result += static_cast<char>(UTF8_3B_PRE | ((wideChar >> UTF8_2B_SHIFT) & UTF8_3B_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_CONT_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
-    } else {  // No need to check the upper limit -- that was done in the escape sequence resolver
-        // 4-byte UTF-8 character (outside the Basic Multilingual Plane)
-        result += static_cast<char>(UTF8_4B_PRE | ((wideChar >> UTF8_3B_SHIFT) & UTF8_4B_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_2B_SHIFT) & UTF8_CONT_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_CONT_MASK));
-        result += static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
+        out[0] = static_cast<char>(UTF8_3B_PRE | ((wideChar >> UTF8_2B_SHIFT) & UTF8_3B_MASK));
+        out[1] = static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_CONT_MASK));
+        out[2] = static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
+        return 3;
     }
-
-    return result;
+    // No need to check the upper limit -- that was done in the escape sequence resolver
+    // 4-byte UTF-8 character (outside the Basic Multilingual Plane)
+    out[0] = static_cast<char>(UTF8_4B_PRE | ((wideChar >> UTF8_3B_SHIFT) & UTF8_4B_MASK));
+    out[1] = static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_2B_SHIFT) & UTF8_CONT_MASK));
+    out[2] = static_cast<char>(UTF8_CONT_PRE | ((wideChar >> UTF8_CONT_SHIFT) & UTF8_CONT_MASK));
+    out[3] = static_cast<char>(UTF8_CONT_PRE | (wideChar & UTF8_CONT_MASK));
+    return 4;
 }
 
 }  // namespace lexer
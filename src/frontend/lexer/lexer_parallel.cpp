@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <atomic>
+#include <core.hpp>
+#include <cstdint>
+#include <frontend/lexer.hpp>
+#include <io/logging.hpp>
+#include <memory>
+#include <mnstl/string_pool.hxx>
+#include <string_view>
+#include <thread>
+#include <utils/memory_phase.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace lexer {
+
+namespace {
+
+// More chunks than threads, so that a thread that finishes early can pick up another one
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+/**
+ * @brief Find where `source` can be split so that each piece lexes the same as it would in context
+ * @details A piece may only start after a newline that the lexer would read as whitespace, i.e. one outside any
+ * string or character literal and block comment. This follows the same rules as the lexer for where those begin and
+ * end, but without producing any tokens.
+ * @return The start offset of every piece after the first, each at least `chunkSize` after the previous one
+ */
+std::vector<size_t> findChunkBoundaries(std::string_view source, size_t chunkSize) {
+    std::vector<size_t> boundaries;
+    const size_t length = source.size();
+    size_t nextBoundary = chunkSize;
+    size_t i = 0;
+    while (i < length) {
+        const char c = source[i];
+        const char next = i + 1 < length ? source[i + 1] : '\0';
+        if (c == '\n') {
+            ++i;
+            if (i >= nextBoundary && i < length) {
+                boundaries.push_back(i);
+                nextBoundary = i + chunkSize;
+            }
+        } else if (c == '#') {
+            // The comment ends at the newline, which is handled above
+            while (i < length && source[i] != '\n') { ++i; }
+        } else if (c == '/' && next == '*') {
+            size_t depth = 1;
+            for (i += 2; i < length && depth > 0;) {
+                if (source[i] == '/' && i + 1 < length && source[i + 1] == '*') {
+                    ++depth;
+                    i += 2;
+                } else if (source[i] == '*' && i + 1 < length && source[i + 1] == '/') {
+                    --depth;
+                    i += 2;
+                } else {
+                    ++i;
+                }
+            }
+        } else if (c == '/' && next == '/') {
+            i += 2;  // Floor division, whose second '/' can't start a block comment
+        } else if (c == '"' || c == '\'') {
+            // Literals end at their closing quote, and (unless escaped) at a newline, which is then read as whitespace
+            for (++i; i < length && source[i] != c && source[i] != '\n';) { i += (source[i] == '\\') ? 2 : 1; }
+            if (i < length && source[i] == c) { ++i; }
+        } else {
+            ++i;
+        }
+    }
+    return boundaries;
+}
+
+}  // namespace
+
+Lexer::Lexer(std::string_view chunk, uint32_t source, size_t offset) :
+    ownedSource(chunk),
+    sourceId(source),
+    baseOffset(offset),
+    isChunk(true),
+    ownsSource(false),
+    lookaheadDepth(MAX_LOOKAHEAD) {
+    // The chunk is copied so that the reader sees a null-terminated buffer, just like for a whole source
+    reader.reset(ownedSource);
+}
+
+std::vector<Token> Lexer::tokenizeAllParallel(size_t threadCount, size_t minChunkSize) {
+    if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+    const std::string_view rest(reader.cursor(), static_cast<size_t>(reader.end() - reader.cursor()));
+    const size_t chunkSize = std::max({minChunkSize, rest.size() / (threadCount * CHUNKS_PER_THREAD), size_t{1}});
+    std::vector<size_t> starts;
+    if (threadCount > 1 && rest.size() >= 2 * chunkSize) { starts = findChunkBoundaries(rest, chunkSize); }
+    if (starts.empty()) { return tokenizeAll(); }
+    starts.insert(starts.begin(), 0);
+    const size_t numChunks = starts.size();
+    starts.push_back(rest.size());
+
+    // Any tokens that have already been lexed come before the rest of the input
+    std::vector<Token> tokens;
+    while (!tokenStream.empty()) {
+        tokens.push_back(tokenStream.front());
+        tokenStream.pop_front();
+    }
+
+    const size_t restOffset = baseOffset + reader.getPosition();
+    chunkLexers.resize(numChunks);
+    std::vector<std::vector<Token>> chunkTokens(numChunks);
+    std::vector<logging::DiagnosticList> chunkDiagnostics(numChunks);
+    std::atomic<size_t> nextChunk = 0;
+    auto lexChunks = [&]() {
+        memory::PhaseScope phase(memory::Phase::Lex);
+        trace::Scope scope("lex chunks");
+        for (size_t i; (i = nextChunk.fetch_add(1, std::memory_order_relaxed)) < numChunks;) {
+            logging::DiagnosticCapture capture(chunkDiagnostics[i]);
+            chunkLexers[i].reset(
+                new Lexer(rest.substr(starts[i], starts[i + 1] - starts[i]), sourceId, restOffset + starts[i]));
+            chunkTokens[i] = chunkLexers[i]->tokenizeAll();
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        const size_t numWorkers = std::min(threadCount, numChunks) - 1;  // This thread lexes chunks too
+        workers.reserve(numWorkers);
+        for (size_t i = 0; i < numWorkers; ++i) { workers.emplace_back(lexChunks); }
+        lexChunks();
+    }  // Join the workers
+
+    size_t numTokens = tokens.size() + 1;
+    for (const std::vector<Token>& chunk : chunkTokens) { numTokens += chunk.size() - 1; }
+    tokens.reserve(numTokens);
+    mnstl::string_pool& pool = identifierPool();
+    for (size_t i = 0; i < numChunks; ++i) {
+        logging::report(chunkDiagnostics[i]);
+        _hasError = _hasError || chunkLexers[i]->hasError();
+        // Skip each chunk's end of file token
+        for (auto it = chunkTokens[i].begin(); it + 1 < chunkTokens[i].end(); ++it) {
+            Token& token = tokens.emplace_back(*it);
+            if (token.getType() == TokenType::Identifier) {
+                // Interning in source order gives each name the same atom as a sequential lex would
+                token.setLexeme(pool.view(pool.intern(token.getLexeme())));
+                token._isInterned = true;
+            }
+        }
+    }
+    advance(rest.size());
+    tokens.emplace_back(TokenType::EndOfFile, "EOF", currentLocation());
+    return tokens;
+}
+
+}  // namespace lexer
+}  // namespace Manganese
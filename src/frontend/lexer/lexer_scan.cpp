@@ -0,0 +1,206 @@
+#include <bit>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <frontend/lexer/lexer_base.hpp>
+#include <frontend/lexer/lexer_scan.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MANGANESE_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MANGANESE_SCAN_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MANGANESE_SCAN_NEON 1
+#endif
+
+namespace Manganese {
+namespace lexer {
+namespace scan {
+
+namespace {
+
+//~ Vector primitives
+// gt() only needs to be correct for ASCII bounds: x86 compares signed (so bytes >= 0x80 are below every bound) and
+// NEON compares unsigned (so they are above every bound). Either way, non-ASCII bytes never fall inside a range.
+
+#if MANGANESE_SCAN_AVX2
+
+using vector_t = __m256i;
+using mask_t = uint32_t;
+constexpr size_t VECTOR_WIDTH = 32;
+constexpr unsigned BITS_PER_LANE = 1;
+constexpr mask_t FULL_MASK = 0xFFFFFFFFu;
+
+FORCE_INLINE vector_t load(const char* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+FORCE_INLINE vector_t splat(char c) noexcept { return _mm256_set1_epi8(c); }
+FORCE_INLINE vector_t eq(vector_t a, vector_t b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+FORCE_INLINE vector_t gt(vector_t a, vector_t b) noexcept { return _mm256_cmpgt_epi8(a, b); }
+FORCE_INLINE vector_t vor(vector_t a, vector_t b) noexcept { return _mm256_or_si256(a, b); }
+FORCE_INLINE vector_t vand(vector_t a, vector_t b) noexcept { return _mm256_and_si256(a, b); }
+FORCE_INLINE mask_t bits(vector_t v) noexcept { return static_cast<mask_t>(_mm256_movemask_epi8(v)); }
+// movemask only looks at each lane's top bit, which is exactly what marks a byte as outside ASCII
+FORCE_INLINE vector_t matchNonASCII(vector_t v) noexcept { return v; }
+
+#elif MANGANESE_SCAN_SSE2
+
+using vector_t = __m128i;
+using mask_t = uint32_t;
+constexpr size_t VECTOR_WIDTH = 16;
+constexpr unsigned BITS_PER_LANE = 1;
+constexpr mask_t FULL_MASK = 0xFFFFu;
+
+FORCE_INLINE vector_t load(const char* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+FORCE_INLINE vector_t splat(char c) noexcept { return _mm_set1_epi8(c); }
+FORCE_INLINE vector_t eq(vector_t a, vector_t b) noexcept { return _mm_cmpeq_epi8(a, b); }
+FORCE_INLINE vector_t gt(vector_t a, vector_t b) noexcept { return _mm_cmpgt_epi8(a, b); }
+FORCE_INLINE vector_t vor(vector_t a, vector_t b) noexcept { return _mm_or_si128(a, b); }
+FORCE_INLINE vector_t vand(vector_t a, vector_t b) noexcept { return _mm_and_si128(a, b); }
+FORCE_INLINE mask_t bits(vector_t v) noexcept { return static_cast<mask_t>(_mm_movemask_epi8(v)); }
+FORCE_INLINE vector_t matchNonASCII(vector_t v) noexcept { return v; }
+
+#elif MANGANESE_SCAN_NEON
+
+using vector_t = uint8x16_t;
+using mask_t = uint64_t;
+constexpr size_t VECTOR_WIDTH = 16;
+constexpr unsigned BITS_PER_LANE = 4;  // NEON has no movemask, so narrow each lane to a nibble instead
+constexpr mask_t FULL_MASK = ~mask_t{0};
+
+FORCE_INLINE vector_t load(const char* p) noexcept { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); }
+FORCE_INLINE vector_t splat(char c) noexcept { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+FORCE_INLINE vector_t eq(vector_t a, vector_t b) noexcept { return vceqq_u8(a, b); }
+FORCE_INLINE vector_t gt(vector_t a, vector_t b) noexcept { return vcgtq_u8(a, b); }
+FORCE_INLINE vector_t vor(vector_t a, vector_t b) noexcept { return vorrq_u8(a, b); }
+FORCE_INLINE vector_t vand(vector_t a, vector_t b) noexcept { return vandq_u8(a, b); }
+FORCE_INLINE mask_t bits(vector_t v) noexcept {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
+}
+FORCE_INLINE vector_t matchNonASCII(vector_t v) noexcept { return vcgtq_u8(v, vdupq_n_u8(0x7F)); }
+
+#endif  // MANGANESE_SCAN_AVX2
+
+#if MANGANESE_SCAN_AVX2 || MANGANESE_SCAN_SSE2 || MANGANESE_SCAN_NEON
+#define MANGANESE_SCAN_VECTORIZED 1
+
+// Whether each byte is in the inclusive ASCII range [lo, hi]
+FORCE_INLINE vector_t inRange(vector_t v, char lo, char hi) noexcept {
+    return vand(gt(v, splat(static_cast<char>(lo - 1))), gt(splat(static_cast<char>(hi + 1)), v));
+}
+
+FORCE_INLINE vector_t matchWhitespace(vector_t v) noexcept { return vor(eq(v, splat(' ')), inRange(v, '\t', '\r')); }
+
+FORCE_INLINE vector_t matchIdentifier(vector_t v) noexcept {
+    const vector_t lower = vor(v, splat(0x20));  // Folds A-Z onto a-z without moving anything else into that range
+    return vor(vor(inRange(lower, 'a', 'z'), inRange(v, '0', '9')), eq(v, splat('_')));
+}
+
+FORCE_INLINE vector_t matchStringBreak(vector_t v) noexcept {
+    return vor(vor(eq(v, splat('"')), eq(v, splat('\\'))), eq(v, splat('\n')));
+}
+
+#endif  // MANGANESE_SCAN_AVX2 || MANGANESE_SCAN_SSE2 || MANGANESE_SCAN_NEON
+
+/**
+ * @brief Advance over [begin, end) until `stops(c)` is true for a character
+ * @param stopsVector Marks every lane in a vector that should stop the scan (only used when vectorized)
+ */
+template <class VectorPredicate, class ScalarPredicate>
+FORCE_INLINE const char* scanUntil(const char* begin, const char* end, [[maybe_unused]] VectorPredicate stopsVector,
+                                   ScalarPredicate stops) noexcept {
+    const char* p = begin;
+#if MANGANESE_SCAN_VECTORIZED
+    while (static_cast<size_t>(end - p) >= VECTOR_WIDTH) {
+        const mask_t stopMask = stopsVector(load(p));
+        if (stopMask != 0) { return p + static_cast<unsigned>(std::countr_zero(stopMask)) / BITS_PER_LANE; }
+        p += VECTOR_WIDTH;
+    }
+#endif  // MANGANESE_SCAN_VECTORIZED
+    while (p < end && !stops(*p)) { ++p; }
+    return p;
+}
+
+/**
+ * @brief The length of the well-formed UTF-8 sequence at `p` (which starts with a non-ASCII byte), or 0 if it is
+ * malformed
+ * @details The ranges are those of the Unicode standard's table of well-formed byte sequences: the second byte's range
+ * depends on the first, which rules out overlong encodings, surrogates and code points past U+10FFFF.
+ */
+FORCE_INLINE size_t sequenceLength(const unsigned char* p, const unsigned char* end) noexcept {
+    const unsigned char lead = p[0];
+    size_t length;
+    unsigned char secondMin = 0x80, secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) { secondMin = 0xA0; }
+        if (lead == 0xED) { secondMax = 0x9F; }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) { secondMin = 0x90; }
+        if (lead == 0xF4) { secondMax = 0x8F; }
+    } else {
+        return 0;  // A continuation byte with no lead, or a lead byte no well-formed sequence starts with
+    }
+    if (static_cast<size_t>(end - p) < length || p[1] < secondMin || p[1] > secondMax) { return 0; }
+    for (size_t i = 2; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) { return 0; }
+    }
+    return length;
+}
+
+}  // namespace
+
+#if MANGANESE_SCAN_VECTORIZED
+// Kernels that skip a character class stop on the lanes outside it
+#define MANGANESE_STOP_OUTSIDE(match) [](vector_t v) noexcept { return ~bits(match(v)) & FULL_MASK; }
+#define MANGANESE_STOP_ON(match) [](vector_t v) noexcept { return bits(match(v)); }
+#else  // ^^ MANGANESE_SCAN_VECTORIZED vv scalar only
+#define MANGANESE_STOP_OUTSIDE(match) nullptr
+#define MANGANESE_STOP_ON(match) nullptr
+#endif  // MANGANESE_SCAN_VECTORIZED
+
+const char* skipWhitespace(const char* begin, const char* end) noexcept {
+    return scanUntil(begin, end, MANGANESE_STOP_OUTSIDE(matchWhitespace), [](char c) noexcept { return !isspace(c); });
+}
+
+const char* skipIdentifier(const char* begin, const char* end) noexcept {
+    return scanUntil(begin, end, MANGANESE_STOP_OUTSIDE(matchIdentifier),
+                     [](char c) noexcept { return !(isalpha(c) || isdigit(c) || c == '_'); });
+}
+
+const char* findLineEnd(const char* begin, const char* end) noexcept {
+    // memchr is already vectorized by every mainstream C library
+    const void* newline = std::memchr(begin, '\n', static_cast<size_t>(end - begin));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+const char* skipStringBody(const char* begin, const char* end) noexcept {
+    return scanUntil(begin, end, MANGANESE_STOP_ON(matchStringBreak),
+                     [](char c) noexcept { return c == '"' || c == '\\' || c == '\n'; });
+}
+
+const char* skipValidUTF8(const char* begin, const char* end) noexcept {
+    const char* p = begin;
+    while (true) {
+        // Skip to the next non-ASCII byte, then check the sequence it starts
+        p = scanUntil(p, end, MANGANESE_STOP_ON(matchNonASCII),
+                      [](char c) noexcept { return static_cast<unsigned char>(c) >= 0x80; });
+        if (p == end) { return end; }
+        const size_t length
+            = sequenceLength(reinterpret_cast<const unsigned char*>(p), reinterpret_cast<const unsigned char*>(end));
+        if (length == 0) { return p; }
+        p += length;
+    }
+}
+
+#undef MANGANESE_STOP_OUTSIDE
+#undef MANGANESE_STOP_ON
+
+}  // namespace scan
+}  // namespace lexer
+}  // namespace Manganese
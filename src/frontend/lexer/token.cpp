@@ -1,20 +1,18 @@
+#include <algorithm>
+#include <array>
 #include <core.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <frontend/lexer/token.hpp>
 #include <io/logging.hpp>
+#include <io/source_map.hpp>
+#include <mnstl/string_pool.hxx>
 #include <string>
-#include <utility>
+#include <string_view>
 
 namespace Manganese {
 namespace lexer {
 
-void Token::overrideType(TokenType type, std::string lexeme) {
-    logging::logInternal(logging::LogLevel::Info, "Overriding token type from {} to {} with lexeme '{}'",
-                         tokenTypeToString(_type), tokenTypeToString(type), lexeme);
-
-    _type = type;
-    if (lexeme != "") { _lexeme = std::move(lexeme); }
-}
-
 struct keyword_map_entry {
     std::string_view str;
     TokenType type;
@@ -41,16 +39,69 @@ constexpr std::array keywordTable = {
     keyword_map_entry{"uint", TokenType::UInt32},
 };
 
+//~ Keyword perfect hash
+// Every identifier the lexer produces goes through keywordLookup, so instead of scanning keywordTable, hash the
+// candidate into a table with no collisions between keywords (found at compile time) and compare against one entry
+
+constexpr unsigned KEYWORD_HASH_BITS = 8;
+constexpr size_t KEYWORD_HASH_TABLE_SIZE = size_t{1} << KEYWORD_HASH_BITS;
+constexpr uint8_t EMPTY_KEYWORD_SLOT = 0xFF;
+static_assert(keywordTable.size() < EMPTY_KEYWORD_SLOT, "Keyword indices must fit in a hash table slot");
+
+constexpr uint32_t keywordHash(std::string_view s, uint32_t seed) noexcept {
+    // FNV-1a, with a seed so that a collision-free variant can be searched for
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : s) { hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u; }
+    return hash >> (32 - KEYWORD_HASH_BITS);  // The high bits are the best mixed
+}
+
+struct keyword_hash_table {
+    uint32_t seed = 0;
+    size_t minLength = SIZE_MAX, maxLength = 0;
+    std::array<uint8_t, KEYWORD_HASH_TABLE_SIZE> slots{};  // indices into keywordTable
+};
+
+consteval keyword_hash_table makeKeywordHashTable() {
+    keyword_hash_table table;
+    for (const keyword_map_entry& entry : keywordTable) {
+        table.minLength = std::min(table.minLength, entry.str.length());
+        table.maxLength = std::max(table.maxLength, entry.str.length());
+    }
+    for (uint32_t seed = 0; seed < 10'000; ++seed) {
+        table.seed = seed;
+        table.slots.fill(EMPTY_KEYWORD_SLOT);
+        bool collided = false;
+        for (size_t i = 0; i < keywordTable.size() && !collided; ++i) {
+            uint8_t& slot = table.slots[keywordHash(keywordTable[i].str, seed)];
+            collided = slot != EMPTY_KEYWORD_SLOT;
+            slot = static_cast<uint8_t>(i);
+        }
+        if (!collided) { return table; }
+    }
+    throw "No collision-free keyword hash seed found; increase KEYWORD_HASH_BITS";
+}
+
+constexpr keyword_hash_table keywordHashTable = makeKeywordHashTable();
+
 TokenType keywordLookup(const std::string_view& s) noexcept {
-    for (const keyword_map_entry& p : keywordTable) {
-        if (p.str == s) { return p.type; }
+    if (s.length() < keywordHashTable.minLength || s.length() > keywordHashTable.maxLength) {
+        return TokenType::Unknown;
     }
-    return TokenType::Unknown;
+    const uint8_t slot = keywordHashTable.slots[keywordHash(s, keywordHashTable.seed)];
+    if (slot == EMPTY_KEYWORD_SLOT) { return TokenType::Unknown; }
+    const keyword_map_entry& entry = keywordTable[slot];
+    return entry.str == s ? entry.type : TokenType::Unknown;
+}
+
+mnstl::string_pool& identifierPool() noexcept {
+    static mnstl::string_pool pool;
+    return pool;
 }
 
 std::string Token::toString() const noexcept {
-    return std::format("Token: {} (lexeme: '{}') at line {}, column {}", tokenTypeToString(_type), _lexeme, _line,
-                       _column);
+    const io::LineColumn position = io::sourceMap().resolve(_location);
+    return std::format("Token: {} (lexeme: '{}') at line {}, column {}", tokenTypeToString(_type), getLexeme(),
+                       position.line, position.column);
 }
 
 }  // namespace lexer
@@ -0,0 +1,946 @@
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <frontend/ast.hpp>
+#include <frontend/parser/encoded_file.hpp>
+#include <memory>
+#include <mnstl/number.hxx>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace parser {
+
+using ast::flat::NodeClass, ast::flat::NodeId, ast::flat::NO_NODE;
+using ast::StatementKind, ast::ExpressionKind, ast::TypeKind;
+
+namespace {
+constexpr uint32_t MAGIC = 0x46414E4D;  // "MNAF" in the little-endian byte order
+constexpr size_t HEADER_SIZE = 68;
+constexpr size_t NODE_WORDS = 6;
+// Offsets of the header fields (each a word, except the name, which is a pair of words)
+constexpr size_t VERSION_FIELD = 4, FLAGS_FIELD = 8, NAME_FIELD = 12, NODE_COUNT_FIELD = 20, NODES_FIELD = 24,
+                 CHILD_COUNT_FIELD = 28, CHILDREN_FIELD = 32, PAYLOAD_WORDS_FIELD = 36, PAYLOADS_FIELD = 40,
+                 IMPORT_WORDS_FIELD = 44, IMPORTS_FIELD = 48, STATEMENT_COUNT_FIELD = 52, STATEMENTS_FIELD = 56,
+                 STRINGS_FIELD = 60, STRINGS_SIZE_FIELD = 64;
+constexpr uint32_t HAS_LOCATION = 1 << 16;
+
+constexpr uint32_t STATEMENT_KINDS = 0
+#define STMT(name, str) +1
+#define EXPR(name, str)
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+    ;
+constexpr uint32_t EXPRESSION_KINDS = 0
+#define STMT(name, str)
+#define EXPR(name, str) +1
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+    ;
+constexpr uint32_t TYPE_KINDS = 0
+#define STMT(name, str)
+#define EXPR(name, str)
+#define TYPE(name, str) +1
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+    ;
+constexpr uint32_t TOKEN_TYPES = 0
+#define TOKEN(name, text)    +1
+#define KEYWORD(name, text)  +1
+#define OPERATOR(name, text) +1
+#include <frontend/lexer/tokens.def>
+#undef TOKEN
+#undef KEYWORD
+#undef OPERATOR
+    ;
+
+// Whether a node's payload starts with its name (see EncodedFile::name())
+constexpr bool hasName(NodeClass nodeClass, uint32_t kind) noexcept {
+    switch (nodeClass) {
+        case NodeClass::Block: return false;
+        case NodeClass::Statement:
+            switch (static_cast<StatementKind>(kind)) {
+                case StatementKind::AggregateDeclarationStatement:
+                case StatementKind::AliasStatement:
+                case StatementKind::EnumDeclarationStatement:
+                case StatementKind::FunctionDeclarationStatement:
+                case StatementKind::VariableDeclarationStatement: return true;
+                default: return false;
+            }
+        case NodeClass::Expression:
+            switch (static_cast<ExpressionKind>(kind)) {
+                case ExpressionKind::AggregateInstantiationExpression:
+                case ExpressionKind::IdentifierExpression:
+                case ExpressionKind::MemberAccessExpression:
+                case ExpressionKind::ScopeResolutionExpression:
+                case ExpressionKind::StringLiteralExpression: return true;
+                default: return false;
+            }
+        case NodeClass::Type: return static_cast<TypeKind>(kind) == TypeKind::SymbolType;
+    }
+    return false;
+}
+
+// A number literal is its held type, then its value's bytes (or, for an error, its message)
+constexpr size_t NUMBER_WORDS = 5;
+
+template <class T>
+void appendNumber(std::vector<uint32_t>& out, const mnstl::number_t& number) {
+    static_assert(sizeof(T) <= 16 && std::is_trivially_copyable_v<T>);
+    const T value = number.value_as<T>();
+    uint32_t words[4] = {};
+    std::memcpy(words, &value, sizeof(T));
+    out.insert(out.end(), std::begin(words), std::end(words));
+}
+
+template <class T>
+mnstl::number_t readNumber(const uint32_t (&words)[4]) {
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return mnstl::number_t(value);
+}
+
+/**
+ * @brief Builds the sections of an encoded file, then lays them out in one buffer
+ * @details As for a module interface, the strings are placed straight after the header, so their offsets are known as
+ * soon as they are added.
+ */
+class Encoder {
+   private:
+    std::string strings;
+    std::unordered_map<std::string_view, uint32_t> stringOffsets;  // Keys view the strings passed to addString()
+
+   public:
+    std::vector<uint32_t> nodeWords, childWords, payloadWords, importWords;
+
+    void addString(std::vector<uint32_t>& out, std::string_view s) {
+        auto [it, inserted] = stringOffsets.try_emplace(s, static_cast<uint32_t>(HEADER_SIZE + strings.size()));
+        if (inserted) { strings.append(s); }
+        out.insert(out.end(), {it->second, static_cast<uint32_t>(s.size())});
+    }
+    void addString(std::string_view s) { addString(payloadWords, s); }
+    void add(uint32_t value) { payloadWords.push_back(value); }
+
+    // Blocks, and nodes that only have children, have no payload
+    template <class T>
+    void addPayload(const T&) {}
+
+    void addPayload(const ast::AggregateDeclarationStatement& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.visibility));
+        add(static_cast<uint32_t>(node.genericTypes.size()));
+        for (const std::string& generic : node.genericTypes) { addString(generic); }
+        for (const ast::AggregateField& field : node.fields) {
+            addString(field.name);
+            payloadWords.insert(payloadWords.end(), {field.isMutable, static_cast<uint32_t>(field.line),
+                                                     static_cast<uint32_t>(field.column)});
+        }
+    }
+    void addPayload(const ast::AliasStatement& node) {
+        addString(node.alias);
+        add(static_cast<uint32_t>(node.visibility));
+    }
+    void addPayload(const ast::EnumDeclarationStatement& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.visibility));
+        for (const ast::EnumValue& value : node.values) {
+            addString(value.name);
+            payloadWords.insert(payloadWords.end(),
+                                {static_cast<uint32_t>(value.line), static_cast<uint32_t>(value.column)});
+        }
+    }
+    void addPayload(const ast::FunctionDeclarationStatement& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.visibility));
+        add(static_cast<uint32_t>(node.genericTypes.size()));
+        for (const std::string& generic : node.genericTypes) { addString(generic); }
+        for (const ast::FunctionParameter& parameter : node.parameters) {
+            addString(parameter.name);
+            add(parameter.isMutable);
+        }
+    }
+    void addPayload(const ast::VariableDeclarationStatement& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.visibility));
+        add(node.isMutable);
+    }
+    void addPayload(const ast::WhileLoopStatement& node) { add(node.isDoWhile); }
+
+    void addPayload(const ast::AggregateInstantiationExpression& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.fields.size()));
+        for (const ast::AggregateInstantiationField& field : node.fields) { addString(field.name); }
+    }
+    void addPayload(const ast::AssignmentExpression& node) { add(static_cast<uint32_t>(node.op)); }
+    void addPayload(const ast::BinaryExpression& node) { add(static_cast<uint32_t>(node.op)); }
+    void addPayload(const ast::BoolLiteralExpression& node) { add(node.value); }
+    void addPayload(const ast::CharLiteralExpression& node) { add(static_cast<uint32_t>(node.value)); }
+    void addPayload(const ast::IdentifierExpression& node) { addString(node.value); }
+    void addPayload(const ast::MemberAccessExpression& node) { addString(node.property); }
+    void addPayload(const ast::NumberLiteralExpression& node) {
+        using held_type = mnstl::number_t::held_type;
+        const held_type type = node.value.underlying_type();
+        add(static_cast<uint32_t>(type));
+        switch (type) {
+            case held_type::int8: appendNumber<int8_t>(payloadWords, node.value); break;
+            case held_type::int16: appendNumber<int16_t>(payloadWords, node.value); break;
+            case held_type::int32: appendNumber<int32_t>(payloadWords, node.value); break;
+            case held_type::int64: appendNumber<int64_t>(payloadWords, node.value); break;
+            case held_type::uint8: appendNumber<uint8_t>(payloadWords, node.value); break;
+            case held_type::uint16: appendNumber<uint16_t>(payloadWords, node.value); break;
+            case held_type::uint32: appendNumber<uint32_t>(payloadWords, node.value); break;
+            case held_type::uint64: appendNumber<uint64_t>(payloadWords, node.value); break;
+            case held_type::int128: appendNumber<mnstl::int128_t>(payloadWords, node.value); break;
+            case held_type::uint128: appendNumber<mnstl::uint128_t>(payloadWords, node.value); break;
+            case held_type::float32: appendNumber<mnstl::float32_t>(payloadWords, node.value); break;
+            case held_type::float64: appendNumber<mnstl::float64_t>(payloadWords, node.value); break;
+            case held_type::error:
+                addString(node.value.error_unchecked());
+                payloadWords.insert(payloadWords.end(), {0, 0});
+                break;
+            case held_type::none: payloadWords.insert(payloadWords.end(), {0, 0, 0, 0}); break;
+        }
+    }
+    void addPayload(const ast::PostfixExpression& node) { add(static_cast<uint32_t>(node.op)); }
+    void addPayload(const ast::PrefixExpression& node) { add(static_cast<uint32_t>(node.op)); }
+    void addPayload(const ast::ScopeResolutionExpression& node) { addString(node.element); }
+    void addPayload(const ast::StringLiteralExpression& node) { addString(node.value); }
+
+    void addPayload(const ast::FunctionType& node) {
+        for (const ast::FunctionParameterType& parameter : node.parameterTypes) { add(parameter.isMutable); }
+    }
+    void addPayload(const ast::PointerType& node) { add(node.isMutable); }
+    void addPayload(const ast::SymbolType& node) {
+        addString(node.name);
+        add(static_cast<uint32_t>(node.primitiveType));
+    }
+
+    std::vector<char> finish(const ParsedFile& file) {
+        const std::pair<uint32_t, uint32_t> name = [&] {
+            std::vector<uint32_t> words;
+            addString(words, file.moduleName);
+            return std::pair(words[0], words[1]);
+        }();
+        const size_t nodesStart = (HEADER_SIZE + strings.size() + 3) & ~size_t{3};
+        const size_t childrenStart = nodesStart + 4 * nodeWords.size();
+        const size_t payloadsStart = childrenStart + 4 * childWords.size();
+        const size_t importsStart = payloadsStart + 4 * payloadWords.size();
+        const size_t statementsStart = importsStart + 4 * importWords.size();
+        std::vector<char> buffer(statementsStart + 4 * file.statementOffsets.size(), '\0');
+
+        auto put = [&](size_t offset, uint32_t value) { std::memcpy(buffer.data() + offset, &value, sizeof(value)); };
+        auto putAll = [&](size_t offset, const std::vector<uint32_t>& words) {
+            if (!words.empty()) { std::memcpy(buffer.data() + offset, words.data(), 4 * words.size()); }
+        };
+        put(0, MAGIC);
+        put(VERSION_FIELD, EncodedFile::VERSION);
+        put(FLAGS_FIELD, file.hasError ? 1 : 0);
+        put(NAME_FIELD, name.first);
+        put(NAME_FIELD + 4, name.second);
+        put(NODE_COUNT_FIELD, static_cast<uint32_t>(nodeWords.size() / NODE_WORDS));
+        put(NODES_FIELD, static_cast<uint32_t>(nodesStart));
+        put(CHILD_COUNT_FIELD, static_cast<uint32_t>(childWords.size()));
+        put(CHILDREN_FIELD, static_cast<uint32_t>(childrenStart));
+        put(PAYLOAD_WORDS_FIELD, static_cast<uint32_t>(payloadWords.size()));
+        put(PAYLOADS_FIELD, static_cast<uint32_t>(payloadsStart));
+        put(IMPORT_WORDS_FIELD, static_cast<uint32_t>(importWords.size()));
+        put(IMPORTS_FIELD, static_cast<uint32_t>(importsStart));
+        put(STATEMENT_COUNT_FIELD, static_cast<uint32_t>(file.statementOffsets.size()));
+        put(STATEMENTS_FIELD, static_cast<uint32_t>(statementsStart));
+        put(STRINGS_FIELD, static_cast<uint32_t>(HEADER_SIZE));
+        put(STRINGS_SIZE_FIELD, static_cast<uint32_t>(strings.size()));
+
+        std::memcpy(buffer.data() + HEADER_SIZE, strings.data(), strings.size());
+        putAll(nodesStart, nodeWords);
+        putAll(childrenStart, childWords);
+        putAll(payloadsStart, payloadWords);
+        putAll(importsStart, importWords);
+        putAll(statementsStart, file.statementOffsets);
+        return buffer;
+    }
+};
+}  // namespace
+
+std::vector<char> EncodedFile::encode(const ParsedFile& file) {
+    const ast::flat::Tree tree = ast::flat::Tree::build(file.program);
+    Encoder encoder;
+    encoder.nodeWords.reserve(NODE_WORDS * tree.size());
+    ast::flat::forEach(tree, [&]<class T>(NodeId id, const T& node) {
+        uint32_t kind = 0;
+        switch (tree.nodeClass(id)) {
+            case NodeClass::Block: break;
+            case NodeClass::Statement: kind = static_cast<uint32_t>(tree.statementKind(id)); break;
+            case NodeClass::Expression: kind = static_cast<uint32_t>(tree.expressionKind(id)); break;
+            case NodeClass::Type: kind = static_cast<uint32_t>(tree.typeKind(id)); break;
+        }
+        const io::SourceLocation location = tree.location(id);
+        const uint32_t head
+            = static_cast<uint32_t>(tree.nodeClass(id)) | (kind << 8) | (location.isValid() ? HAS_LOCATION : 0);
+        encoder.nodeWords.insert(encoder.nodeWords.end(),
+                                 {head, location.offset, static_cast<uint32_t>(encoder.childWords.size()),
+                                  static_cast<uint32_t>(tree.children(id).size()), tree.subtreeEnd(id),
+                                  static_cast<uint32_t>(encoder.payloadWords.size())});
+        encoder.childWords.insert(encoder.childWords.end(), tree.children(id).begin(), tree.children(id).end());
+        encoder.addPayload(node);
+    });
+
+    encoder.importWords.push_back(static_cast<uint32_t>(file.imports.size()));
+    for (const Import& import : file.imports) {
+        encoder.importWords.push_back(static_cast<uint32_t>(import.path.size()));
+        for (const std::string& part : import.path) { encoder.addString(encoder.importWords, part); }
+        encoder.addString(encoder.importWords, import.alias);
+    }
+    return encoder.finish(file);
+}
+
+bool EncodedFile::validate() noexcept {
+    // Whether [offset, offset + length) lies inside the buffer (computed in 64 bits, so it can't overflow)
+    auto inBounds = [&](uint64_t offset, uint64_t length) {
+        return offset <= bytes.size() && length <= bytes.size() - offset;
+    };
+    auto validString = [&](size_t field) { return inBounds(word(field), word(field + 4)); };
+
+    if (bytes.size() < HEADER_SIZE || word(0) != MAGIC || word(VERSION_FIELD) != VERSION
+        || word(FLAGS_FIELD) > 1) {
+        return false;
+    }
+    if (!validString(NAME_FIELD) || !inBounds(word(STRINGS_FIELD), word(STRINGS_SIZE_FIELD))) { return false; }
+    nodeCount = word(NODE_COUNT_FIELD);
+    nodes = word(NODES_FIELD);
+    children = word(CHILDREN_FIELD);
+    payloads = word(PAYLOADS_FIELD);
+    payloadWords = word(PAYLOAD_WORDS_FIELD);
+    const uint32_t childTableSize = word(CHILD_COUNT_FIELD);
+    if (!inBounds(nodes, uint64_t{nodeCount} * NODE_WORDS * 4) || !inBounds(children, uint64_t{childTableSize} * 4)
+        || !inBounds(payloads, uint64_t{payloadWords} * 4)
+        || !inBounds(word(STATEMENTS_FIELD), uint64_t{word(STATEMENT_COUNT_FIELD)} * 4)) {
+        return false;
+    }
+
+    // The imports: their count, then each one's path length, its path and its alias
+    const size_t imports = word(IMPORTS_FIELD), importWords = word(IMPORT_WORDS_FIELD);
+    if (!inBounds(imports, uint64_t{importWords} * 4) || importWords == 0) { return false; }
+    size_t importWord = 1;
+    for (uint32_t i = 0, count = word(imports); i < count; ++i) {
+        if (importWord >= importWords) { return false; }
+        const uint64_t pathLength = word(imports + 4 * importWord++);
+        if (importWord + 2 * pathLength + 2 > importWords) { return false; }
+        for (uint64_t part = 0; part <= pathLength; ++part, importWord += 2) {
+            if (!validString(imports + 4 * importWord)) { return false; }
+        }
+    }
+    if (importWord != importWords) { return false; }
+
+    // A program always has its block, which is the whole tree
+    if (nodeCount == 0 || nodeClass(0) != NodeClass::Block || subtreeEnd(0) != nodeCount) { return false; }
+    for (NodeId id = 0; id < nodeCount; ++id) {
+        const uint32_t head = nodeWord(id, 0);
+        const uint32_t kindCount = [&]() -> uint32_t {
+            switch (head & 0xFF) {
+                case static_cast<uint32_t>(NodeClass::Block): return 1;
+                case static_cast<uint32_t>(NodeClass::Statement): return STATEMENT_KINDS;
+                case static_cast<uint32_t>(NodeClass::Expression): return EXPRESSION_KINDS;
+                case static_cast<uint32_t>(NodeClass::Type): return TYPE_KINDS;
+                default: return 0;
+            }
+        }();
+        if (kind(id) >= kindCount || (head >> 17) != 0) { return false; }
+        if (!inBounds(children + 4 * uint64_t{nodeWord(id, 2)}, 4 * uint64_t{childCount(id)})) { return false; }
+        const uint32_t payloadEnd = id + 1 < nodeCount ? nodeWord(id + 1, 5) : payloadWords;
+        if (nodeWord(id, 5) > payloadEnd || payloadEnd > payloadWords) { return false; }
+
+        // The nodes are in pre-order: each child's subtree follows the previous one's, and together they make up the
+        // node's subtree (so every node but the root is the child of exactly one other)
+        if (subtreeEnd(id) <= id || subtreeEnd(id) > nodeCount) { return false; }
+        NodeId next = id + 1;
+        for (size_t i = 0; i < childCount(id); ++i) {
+            const NodeId c = child(id, i);
+            if (c == NO_NODE) { continue; }
+            if (c != next || subtreeEnd(c) > subtreeEnd(id)) { return false; }
+            next = subtreeEnd(c);
+        }
+        if (next != subtreeEnd(id) || !validateNode(id)) { return false; }
+    }
+    return true;
+}
+
+bool EncodedFile::validateNode(NodeId id) const noexcept {
+    auto inBounds = [&](uint64_t offset, uint64_t length) {
+        return offset <= bytes.size() && length <= bytes.size() - offset;
+    };
+    const size_t count = childCount(id);
+    const size_t words = (id + 1 < nodeCount ? nodeWord(id + 1, 5) : payloadWords) - nodeWord(id, 5);
+    auto at = [&](size_t index) { return word(payload(id) + 4 * index); };
+    auto stringAt = [&](size_t index) { return inBounds(at(index), at(index + 1)); };
+    auto isFlag = [&](size_t index) { return at(index) <= 1; };
+    auto isVisibility = [&](size_t index) {
+        return at(index) == static_cast<uint32_t>(ast::Visibility::Public)
+            || at(index) == static_cast<uint32_t>(ast::Visibility::Private);
+    };
+    auto isOperator = [&](size_t index) { return at(index) < TOKEN_TYPES; };
+    // Whether children [first, last) are all of class `nodeClass` (or, if they are optional, missing)
+    auto childrenAre = [&](size_t first, size_t last, NodeClass expected, bool optional = false) {
+        for (size_t i = first; i < last; ++i) {
+            const NodeId c = child(id, i);
+            if (c == NO_NODE ? !optional : nodeClass(c) != expected) { return false; }
+        }
+        return true;
+    };
+    auto childIs = [&](size_t index, NodeClass expected, bool optional = false) {
+        return index < count && childrenAre(index, index + 1, expected, optional);
+    };
+    // If/elif and switch/case pairs: an expression then a block, from `first` up to the last child
+    auto pairsAreClauses = [&](size_t first) {
+        for (size_t i = first; i + 1 < count; i += 2) {
+            if (!childIs(i, NodeClass::Expression) || !childIs(i + 1, NodeClass::Block)) { return false; }
+        }
+        return true;
+    };
+    // The strings at `first`, `first + stride`, ... (`count` of them)
+    auto stringsAt = [&](size_t first, size_t stride, size_t stringCount) {
+        for (size_t i = 0; i < stringCount; ++i) {
+            if (!stringAt(first + stride * i)) { return false; }
+        }
+        return true;
+    };
+    constexpr bool OPTIONAL = true;
+    using enum NodeClass;
+
+    switch (nodeClass(id)) {
+        case Block: return words == 0 && childrenAre(0, count, Statement);
+        case Statement:
+            switch (statementKind(id)) {
+                case StatementKind::AggregateDeclarationStatement: {
+                    if (words < 4 || !stringAt(0) || !isVisibility(2)) { return false; }
+                    const uint64_t generics = at(3);
+                    return words == 4 + 2 * generics + 5 * uint64_t{count} && stringsAt(4, 2, generics)
+                        && stringsAt(4 + 2 * generics, 5, count) && childrenAre(0, count, Type);
+                }
+                case StatementKind::AliasStatement:
+                    return words == 3 && stringAt(0) && isVisibility(2) && count == 1 && childIs(0, Type);
+                case StatementKind::BreakStatement:
+                case StatementKind::ContinueStatement:
+                case StatementKind::EmptyStatement: return words == 0 && count == 0;
+                case StatementKind::EnumDeclarationStatement:
+                    return count >= 1 && words == 3 + 4 * (count - 1) && stringAt(0) && isVisibility(2)
+                        && stringsAt(3, 4, count - 1) && childIs(0, Type)
+                        && childrenAre(1, count, Expression, OPTIONAL);
+                case StatementKind::ExpressionStatement: return words == 0 && count == 1 && childIs(0, Expression);
+                case StatementKind::ForLoopStatement:
+                    return words == 0 && count == 4 && childIs(0, Statement, OPTIONAL)
+                        && childIs(1, Expression, OPTIONAL) && childIs(2, Expression, OPTIONAL) && childIs(3, Block);
+                case StatementKind::FunctionDeclarationStatement: {
+                    if (count < 2 || words < 4 || !stringAt(0) || !isVisibility(2)) { return false; }
+                    const uint64_t generics = at(3), parameters = count - 2;
+                    if (words != 4 + 2 * generics + 3 * parameters || !stringsAt(4, 2, generics)
+                        || !stringsAt(4 + 2 * generics, 3, parameters)) {
+                        return false;
+                    }
+                    for (size_t p = 0; p < parameters; ++p) {
+                        if (!isFlag(4 + 2 * generics + 3 * p + 2)) { return false; }
+                    }
+                    return childrenAre(0, parameters, Type) && childIs(count - 2, Type, OPTIONAL)
+                        && childIs(count - 1, Block);
+                }
+                case StatementKind::IfStatement:
+                    return words == 0 && count >= 3 && count % 2 == 1 && pairsAreClauses(0)
+                        && childIs(count - 1, Block);
+                case StatementKind::NestedBlockStatement: return words == 0 && count == 1 && childIs(0, Block);
+                case StatementKind::ReturnStatement:
+                    return words == 0 && count == 1 && childIs(0, Expression, OPTIONAL);
+                case StatementKind::SwitchStatement:
+                    return words == 0 && count >= 2 && count % 2 == 0 && childIs(0, Expression) && pairsAreClauses(1)
+                        && childIs(count - 1, Block);
+                case StatementKind::VariableDeclarationStatement:
+                    return words == 4 && stringAt(0) && isVisibility(2) && isFlag(3) && count == 2
+                        && childIs(0, Type, OPTIONAL) && childIs(1, Expression, OPTIONAL);
+                case StatementKind::WhileLoopStatement:
+                    return words == 1 && isFlag(0) && count == 2 && childIs(0, Expression) && childIs(1, Block);
+            }
+            return false;
+        case Expression:
+            switch (expressionKind(id)) {
+                case ExpressionKind::AggregateInstantiationExpression: {
+                    if (words < 3 || !stringAt(0)) { return false; }
+                    const uint64_t fields = at(2);
+                    return words == 3 + 2 * fields && fields <= count && stringsAt(3, 2, fields)
+                        && childrenAre(0, count - fields, Type) && childrenAre(count - fields, count, Expression);
+                }
+                case ExpressionKind::AggregateLiteralExpression: return words == 0 && childrenAre(0, count, Expression);
+                case ExpressionKind::AlignofExpression:
+                case ExpressionKind::SizeofExpression: return words == 0 && count == 1 && childIs(0, Type);
+                case ExpressionKind::ArrayLiteralExpression:
+                    return words == 0 && count >= 2 && childIs(0, Type, OPTIONAL) && childIs(1, Expression, OPTIONAL)
+                        && childrenAre(2, count, Expression);
+                case ExpressionKind::AssignmentExpression:
+                case ExpressionKind::BinaryExpression:
+                case ExpressionKind::IndexExpression:
+                    return words == (expressionKind(id) == ExpressionKind::IndexExpression ? 0 : 1)
+                        && (words == 0 || isOperator(0)) && count == 2 && childrenAre(0, 2, Expression);
+                case ExpressionKind::BoolLiteralExpression: return words == 1 && isFlag(0) && count == 0;
+                case ExpressionKind::CharLiteralExpression: return words == 1 && count == 0;
+                case ExpressionKind::FunctionCallExpression:
+                case ExpressionKind::GenericExpression:
+                    return words == 0 && count >= 1 && childIs(0, Expression)
+                        && childrenAre(1, count,
+                                       expressionKind(id) == ExpressionKind::GenericExpression ? Type : Expression);
+                case ExpressionKind::IdentifierExpression:
+                case ExpressionKind::StringLiteralExpression: return words == 2 && stringAt(0) && count == 0;
+                case ExpressionKind::MemberAccessExpression:
+                case ExpressionKind::ScopeResolutionExpression:
+                    return words == 2 && stringAt(0) && count == 1 && childIs(0, Expression);
+                case ExpressionKind::NumberLiteralExpression:
+                    return words == NUMBER_WORDS && count == 0
+                        && at(0) <= static_cast<uint32_t>(mnstl::number_t::held_type::none)
+                        && (at(0) != static_cast<uint32_t>(mnstl::number_t::held_type::error) || stringAt(1));
+                case ExpressionKind::PostfixExpression:
+                case ExpressionKind::PrefixExpression:
+                    return words == 1 && isOperator(0) && count == 1 && childIs(0, Expression);
+                case ExpressionKind::TypeCastExpression:
+                    return words == 0 && count == 2 && childIs(0, Expression) && childIs(1, Type);
+            }
+            return false;
+        case Type:
+            switch (typeKind(id)) {
+                case TypeKind::AggregateType:
+                case TypeKind::GenericType:
+                    return words == 0 && (typeKind(id) == TypeKind::AggregateType || count >= 1)
+                        && childrenAre(0, count, Type);
+                case TypeKind::ArrayType:
+                    return words == 0 && count == 2 && childIs(0, Type) && childIs(1, Expression, OPTIONAL);
+                case TypeKind::FunctionType: {
+                    if (count < 1 || words != count - 1) { return false; }
+                    for (size_t p = 0; p < words; ++p) {
+                        if (!isFlag(p)) { return false; }
+                    }
+                    return childrenAre(0, count - 1, Type) && childIs(count - 1, Type, OPTIONAL);
+                }
+                case TypeKind::PointerType: return words == 1 && isFlag(0) && count == 1 && childIs(0, Type);
+                case TypeKind::SymbolType: {
+                    const uint32_t primitive = words == 3 ? at(2) : 0;
+                    return words == 3 && stringAt(0) && count == 0
+                        && (primitive <= static_cast<uint32_t>(ast::PrimitiveType_t::boolean)
+                            || primitive == static_cast<uint32_t>(ast::PrimitiveType_t::not_primitive));
+                }
+                case TypeKind::TypeofType: return words == 0 && count == 1 && childIs(0, Expression);
+            }
+            return false;
+    }
+    return false;
+}
+
+std::optional<EncodedFile> EncodedFile::load(EncodedFile file) {
+    if (!file.validate()) { return std::nullopt; }
+    return file;
+}
+
+std::optional<EncodedFile> EncodedFile::fromBytes(std::vector<char> encoded) {
+    EncodedFile file;
+    file.ownedBytes = std::move(encoded);
+    file.bytes = std::string_view(file.ownedBytes.data(), file.ownedBytes.size());
+    return load(std::move(file));
+}
+
+std::optional<EncodedFile> EncodedFile::open(const std::string& path) {
+    if (!io::MappedFileReader::isMappable(path)) { return std::nullopt; }
+    EncodedFile file;
+    try {
+        file.mapping = std::make_unique<io::MappedFileReader>(path);
+    } catch (const std::runtime_error&) { return std::nullopt; }
+    file.bytes = file.mapping->view();
+    return load(std::move(file));
+}
+
+std::vector<Import> EncodedFile::imports() const {
+    const size_t start = word(IMPORTS_FIELD);
+    std::vector<Import> result(word(start));
+    size_t offset = start + 4;
+    for (Import& import : result) {
+        import.path.resize(word(offset));
+        offset += 4;
+        for (std::string& part : import.path) {
+            part = string(offset);
+            offset += 8;
+        }
+        import.alias = string(offset);
+        offset += 8;
+    }
+    return result;
+}
+
+std::vector<uint32_t> EncodedFile::statementOffsets() const {
+    std::vector<uint32_t> result(word(STATEMENT_COUNT_FIELD));
+    if (!result.empty()) { std::memcpy(result.data(), bytes.data() + word(STATEMENTS_FIELD), 4 * result.size()); }
+    return result;
+}
+
+std::string_view EncodedFile::name(NodeId id) const noexcept {
+    return hasName(nodeClass(id), kind(id)) ? string(payload(id)) : std::string_view();
+}
+
+/**
+ * @brief Rebuilds the AST of a (validated) encoded file, nodes after their children
+ */
+class Rehydrator {
+   private:
+    const EncodedFile& file;
+    mnstl::chunk_allocator& arena;
+    uint32_t source;
+    std::vector<ast::ASTNode*> built;  // By node id (nullptr for blocks, which their parents build)
+
+    uint32_t at(NodeId id, size_t index) const noexcept { return file.word(file.payload(id) + 4 * index); }
+    std::string string(NodeId id, size_t index) const {
+        return std::string(file.string(file.payload(id) + 4 * index));
+    }
+    template <class T>
+    T* child(NodeId id, size_t index) const noexcept {
+        const NodeId c = file.child(id, index);
+        return c == NO_NODE ? nullptr : static_cast<T*>(built[c]);
+    }
+    template <class T>
+    std::vector<T*> childList(NodeId id, size_t first, size_t last) const {
+        std::vector<T*> result;
+        result.reserve(last - first);
+        for (size_t i = first; i < last; ++i) { result.push_back(child<T>(id, i)); }
+        return result;
+    }
+    mnstl::arena_vector<ast::Expression*> arenaList(NodeId id, size_t first) const {
+        mnstl::arena_vector<ast::Expression*> result(arena.resource());
+        result.reserve(file.childCount(id) - first);
+        for (size_t i = first; i < file.childCount(id); ++i) { result.push_back(child<ast::Expression>(id, i)); }
+        return result;
+    }
+    ast::Block block(NodeId id, size_t index) const {
+        const NodeId blockId = file.child(id, index);
+        ast::Block result(arena.resource());
+        result.reserve(file.childCount(blockId));
+        for (size_t i = 0; i < file.childCount(blockId); ++i) { result.push_back(child<ast::Statement>(blockId, i)); }
+        return result;
+    }
+    ast::Visibility visibility(NodeId id, size_t index) const noexcept {
+        return static_cast<ast::Visibility>(at(id, index));
+    }
+
+    // The most arena storage rebuilding the tree takes, so that it can all be reserved at once
+    size_t arenaSize() const noexcept;
+
+    ast::Statement* buildStatement(NodeId id);
+    ast::Expression* buildExpression(NodeId id);
+    ast::Type* buildType(NodeId id);
+
+   public:
+    Rehydrator(const EncodedFile& _file, mnstl::chunk_allocator& _arena, uint32_t _source) :
+        file(_file), arena(_arena), source(_source), built(_file.size(), nullptr) {}
+
+    ParsedFile run() {
+        mnstl::chunk_allocator::tag_scope tag(arena, mnstl::alloc_tag::ast);
+        arena.reserve(arenaSize());
+        // Children have higher ids than their parents, so going backwards builds every child before its parent
+        for (NodeId id = static_cast<NodeId>(file.size()); id-- > 1;) {
+            ast::ASTNode* node = nullptr;
+            switch (file.nodeClass(id)) {
+                case NodeClass::Block: continue;
+                case NodeClass::Statement: node = buildStatement(id); break;
+                case NodeClass::Expression: node = buildExpression(id); break;
+                case NodeClass::Type: node = buildType(id); break;
+            }
+            node->setLocation(file.location(id, source));
+            built[id] = node;
+        }
+        ast::Block program(arena.resource());
+        program.reserve(file.childCount(0));
+        for (size_t i = 0; i < file.childCount(0); ++i) { program.push_back(child<ast::Statement>(0, i)); }
+        return ParsedFile{.moduleName = std::string(file.moduleName()),
+                          .imports = file.imports(),
+                          .program = std::move(program),
+                          .statementOffsets = file.statementOffsets(),
+                          .hasError = file.hasError()};
+    }
+};
+
+size_t Rehydrator::arenaSize() const noexcept {
+    using mnstl::chunk_allocator;
+    constexpr size_t POINTER_LIST = alignof(void*) - 1;  // Padding for a pointer list; add sizeof(void*) per element
+    size_t total = 0;
+    for (NodeId id = 0; id < file.size(); ++id) {
+        const size_t count = file.childCount(id);
+        switch (file.nodeClass(id)) {
+            case NodeClass::Block: total += POINTER_LIST + sizeof(void*) * count; break;
+            case NodeClass::Statement:
+                switch (file.statementKind(id)) {
+#define STMT(name, str) \
+    case StatementKind::name: total += chunk_allocator::emplace_size<ast::name>(); break;
+#define EXPR(name, str)
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+                }
+                break;
+            case NodeClass::Expression:
+                switch (file.expressionKind(id)) {
+#define STMT(name, str)
+#define EXPR(name, str) \
+    case ExpressionKind::name: total += chunk_allocator::emplace_size<ast::name>(); break;
+#define TYPE(name, str)
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+                }
+                // Lists of expressions in the arena, and the messages of invalid number literals
+                switch (file.expressionKind(id)) {
+                    case ExpressionKind::AggregateLiteralExpression:
+                    case ExpressionKind::ArrayLiteralExpression:
+                    case ExpressionKind::FunctionCallExpression: total += POINTER_LIST + sizeof(void*) * count; break;
+                    case ExpressionKind::NumberLiteralExpression:
+                        if (at(id, 0) == static_cast<uint32_t>(mnstl::number_t::held_type::error)) {
+                            total += at(id, 2) + 1;
+                        }
+                        break;
+                    default: break;
+                }
+                break;
+            case NodeClass::Type:
+                switch (file.typeKind(id)) {
+#define STMT(name, str)
+#define EXPR(name, str)
+#define TYPE(name, str) \
+    case TypeKind::name: total += chunk_allocator::emplace_size<ast::name>(); break;
+#include <frontend/ast/ast.def>
+#undef STMT
+#undef EXPR
+#undef TYPE
+                }
+                break;
+        }
+    }
+    return total;
+}
+
+ast::Statement* Rehydrator::buildStatement(NodeId id) {
+    const size_t count = file.childCount(id);
+    switch (file.statementKind(id)) {
+        case StatementKind::AggregateDeclarationStatement: {
+            const size_t generics = at(id, 3);
+            std::vector<std::string> genericTypes;
+            genericTypes.reserve(generics);
+            for (size_t g = 0; g < generics; ++g) { genericTypes.push_back(string(id, 4 + 2 * g)); }
+            std::vector<ast::AggregateField> fields;
+            fields.reserve(count);
+            for (size_t f = 0; f < count; ++f) {
+                const size_t field = 4 + 2 * generics + 5 * f;
+                fields.push_back(ast::AggregateField{.name = string(id, field),
+                                                     .type = child<ast::Type>(id, f),
+                                                     .isMutable = at(id, field + 2) != 0,
+                                                     .line = at(id, field + 3),
+                                                     .column = at(id, field + 4)});
+            }
+            auto* node = arena.emplace<ast::AggregateDeclarationStatement>(string(id, 0), std::move(genericTypes),
+                                                                           std::move(fields));
+            node->visibility = visibility(id, 2);
+            return node;
+        }
+        case StatementKind::AliasStatement: {
+            auto* node = arena.emplace<ast::AliasStatement>(child<ast::Type>(id, 0), string(id, 0));
+            node->visibility = visibility(id, 2);
+            return node;
+        }
+        case StatementKind::BreakStatement: return arena.emplace<ast::BreakStatement>();
+        case StatementKind::ContinueStatement: return arena.emplace<ast::ContinueStatement>();
+        case StatementKind::EmptyStatement: return arena.emplace<ast::EmptyStatement>();
+        case StatementKind::EnumDeclarationStatement: {
+            std::vector<ast::EnumValue> values;
+            values.reserve(count - 1);
+            for (size_t v = 0; v + 1 < count; ++v) {
+                values.push_back(ast::EnumValue{.name = string(id, 3 + 4 * v),
+                                                .value = child<ast::Expression>(id, v + 1),
+                                                .line = at(id, 3 + 4 * v + 2),
+                                                .column = at(id, 3 + 4 * v + 3)});
+            }
+            auto* node = arena.emplace<ast::EnumDeclarationStatement>(string(id, 0), child<ast::Type>(id, 0),
+                                                                      std::move(values));
+            node->visibility = visibility(id, 2);
+            return node;
+        }
+        case StatementKind::ExpressionStatement:
+            return arena.emplace<ast::ExpressionStatement>(child<ast::Expression>(id, 0));
+        case StatementKind::ForLoopStatement:
+            return arena.emplace<ast::ForLoopStatement>(child<ast::Statement>(id, 0), child<ast::Expression>(id, 1),
+                                                        child<ast::Expression>(id, 2), block(id, 3));
+        case StatementKind::FunctionDeclarationStatement: {
+            const size_t generics = at(id, 3);
+            std::vector<std::string> genericTypes;
+            genericTypes.reserve(generics);
+            for (size_t g = 0; g < generics; ++g) { genericTypes.push_back(string(id, 4 + 2 * g)); }
+            std::vector<ast::FunctionParameter> parameters;
+            parameters.reserve(count - 2);
+            for (size_t p = 0; p + 2 < count; ++p) {
+                const size_t parameter = 4 + 2 * generics + 3 * p;
+                parameters.push_back(ast::FunctionParameter{.name = string(id, parameter),
+                                                            .type = child<ast::Type>(id, p),
+                                                            .isMutable = at(id, parameter + 2) != 0});
+            }
+            auto* node = arena.emplace<ast::FunctionDeclarationStatement>(
+                string(id, 0), std::move(genericTypes), std::move(parameters), child<ast::Type>(id, count - 2),
+                block(id, count - 1));
+            node->visibility = visibility(id, 2);
+            return node;
+        }
+        case StatementKind::IfStatement: {
+            std::vector<ast::ElifClause> elifs;
+            elifs.reserve((count - 3) / 2);
+            for (size_t i = 2; i + 1 < count; i += 2) {
+                elifs.emplace_back(child<ast::Expression>(id, i), block(id, i + 1));
+            }
+            return arena.emplace<ast::IfStatement>(child<ast::Expression>(id, 0), block(id, 1), std::move(elifs),
+                                                   block(id, count - 1));
+        }
+        case StatementKind::NestedBlockStatement: return arena.emplace<ast::NestedBlockStatement>(block(id, 0));
+        case StatementKind::ReturnStatement: return arena.emplace<ast::ReturnStatement>(child<ast::Expression>(id, 0));
+        case StatementKind::SwitchStatement: {
+            std::vector<ast::CaseClause> cases;
+            cases.reserve((count - 2) / 2);
+            for (size_t i = 1; i + 1 < count; i += 2) {
+                cases.push_back(
+                    ast::CaseClause{.literalValue = child<ast::Expression>(id, i), .body = block(id, i + 1)});
+            }
+            return arena.emplace<ast::SwitchStatement>(child<ast::Expression>(id, 0), std::move(cases),
+                                                       block(id, count - 1));
+        }
+        case StatementKind::VariableDeclarationStatement:
+            return arena.emplace<ast::VariableDeclarationStatement>(at(id, 3) != 0, string(id, 0), visibility(id, 2),
+                                                                    child<ast::Expression>(id, 1),
+                                                                    child<ast::Type>(id, 0));
+        case StatementKind::WhileLoopStatement:
+            return arena.emplace<ast::WhileLoopStatement>(block(id, 1), child<ast::Expression>(id, 0), at(id, 0) != 0);
+    }
+    ASSERT_UNREACHABLE("Invalid statement in a validated encoded file");
+}
+
+ast::Expression* Rehydrator::buildExpression(NodeId id) {
+    const size_t count = file.childCount(id);
+    switch (file.expressionKind(id)) {
+        case ExpressionKind::AggregateInstantiationExpression: {
+            const size_t fieldCount = at(id, 2), generics = count - fieldCount;
+            std::vector<ast::AggregateInstantiationField> fields;
+            fields.reserve(fieldCount);
+            for (size_t f = 0; f < fieldCount; ++f) {
+                fields.push_back(ast::AggregateInstantiationField{.name = string(id, 3 + 2 * f),
+                                                                  .value = child<ast::Expression>(id, generics + f)});
+            }
+            return arena.emplace<ast::AggregateInstantiationExpression>(
+                string(id, 0), childList<ast::Type>(id, 0, generics), std::move(fields));
+        }
+        case ExpressionKind::AggregateLiteralExpression:
+            return arena.emplace<ast::AggregateLiteralExpression>(arenaList(id, 0));
+        case ExpressionKind::AlignofExpression: return arena.emplace<ast::AlignofExpression>(child<ast::Type>(id, 0));
+        case ExpressionKind::ArrayLiteralExpression: {
+            auto* node = arena.emplace<ast::ArrayLiteralExpression>(arenaList(id, 2), child<ast::Type>(id, 0));
+            node->lengthExpression = child<ast::Expression>(id, 1);
+            return node;
+        }
+        case ExpressionKind::AssignmentExpression:
+            return arena.emplace<ast::AssignmentExpression>(child<ast::Expression>(id, 0),
+                                                            static_cast<lexer::TokenType>(at(id, 0)),
+                                                            child<ast::Expression>(id, 1));
+        case ExpressionKind::BinaryExpression:
+            return arena.emplace<ast::BinaryExpression>(child<ast::Expression>(id, 0),
+                                                        static_cast<lexer::TokenType>(at(id, 0)),
+                                                        child<ast::Expression>(id, 1));
+        case ExpressionKind::BoolLiteralExpression: return arena.emplace<ast::BoolLiteralExpression>(at(id, 0) != 0);
+        case ExpressionKind::CharLiteralExpression:
+            return arena.emplace<ast::CharLiteralExpression>(static_cast<char32_t>(at(id, 0)));
+        case ExpressionKind::FunctionCallExpression:
+            return arena.emplace<ast::FunctionCallExpression>(child<ast::Expression>(id, 0), arenaList(id, 1));
+        case ExpressionKind::GenericExpression:
+            return arena.emplace<ast::GenericExpression>(child<ast::Expression>(id, 0),
+                                                         childList<ast::Type>(id, 1, count));
+        case ExpressionKind::IdentifierExpression: return arena.emplace<ast::IdentifierExpression>(string(id, 0));
+        case ExpressionKind::IndexExpression:
+            return arena.emplace<ast::IndexExpression>(child<ast::Expression>(id, 0), child<ast::Expression>(id, 1));
+        case ExpressionKind::MemberAccessExpression:
+            return arena.emplace<ast::MemberAccessExpression>(child<ast::Expression>(id, 0), string(id, 0));
+        case ExpressionKind::NumberLiteralExpression: {
+            using held_type = mnstl::number_t::held_type;
+            const uint32_t words[4] = {at(id, 1), at(id, 2), at(id, 3), at(id, 4)};
+            mnstl::number_t value;
+            switch (static_cast<held_type>(at(id, 0))) {
+                case held_type::int8: value = readNumber<int8_t>(words); break;
+                case held_type::int16: value = readNumber<int16_t>(words); break;
+                case held_type::int32: value = readNumber<int32_t>(words); break;
+                case held_type::int64: value = readNumber<int64_t>(words); break;
+                case held_type::uint8: value = readNumber<uint8_t>(words); break;
+                case held_type::uint16: value = readNumber<uint16_t>(words); break;
+                case held_type::uint32: value = readNumber<uint32_t>(words); break;
+                case held_type::uint64: value = readNumber<uint64_t>(words); break;
+                case held_type::int128: value = readNumber<mnstl::int128_t>(words); break;
+                case held_type::uint128: value = readNumber<mnstl::uint128_t>(words); break;
+                case held_type::float32: value = readNumber<mnstl::float32_t>(words); break;
+                case held_type::float64: value = readNumber<mnstl::float64_t>(words); break;
+                // The message has to outlive the node, so it is kept in the arena with it
+                case held_type::error:
+                    value = mnstl::number_t(arena.copy_string(file.string(file.payload(id) + 4)).data());
+                    break;
+                case held_type::none: break;
+            }
+            return arena.emplace<ast::NumberLiteralExpression>(value);
+        }
+        case ExpressionKind::PostfixExpression:
+            return arena.emplace<ast::PostfixExpression>(child<ast::Expression>(id, 0),
+                                                         static_cast<lexer::TokenType>(at(id, 0)));
+        case ExpressionKind::PrefixExpression:
+            return arena.emplace<ast::PrefixExpression>(static_cast<lexer::TokenType>(at(id, 0)),
+                                                        child<ast::Expression>(id, 0));
+        case ExpressionKind::ScopeResolutionExpression:
+            return arena.emplace<ast::ScopeResolutionExpression>(child<ast::Expression>(id, 0), string(id, 0));
+        case ExpressionKind::SizeofExpression: return arena.emplace<ast::SizeofExpression>(child<ast::Type>(id, 0));
+        case ExpressionKind::StringLiteralExpression: return arena.emplace<ast::StringLiteralExpression>(string(id, 0));
+        case ExpressionKind::TypeCastExpression:
+            return arena.emplace<ast::TypeCastExpression>(child<ast::Expression>(id, 0), child<ast::Type>(id, 1));
+    }
+    ASSERT_UNREACHABLE("Invalid expression in a validated encoded file");
+}
+
+ast::Type* Rehydrator::buildType(NodeId id) {
+    const size_t count = file.childCount(id);
+    switch (file.typeKind(id)) {
+        case TypeKind::AggregateType: return arena.emplace<ast::AggregateType>(childList<ast::Type>(id, 0, count));
+        case TypeKind::ArrayType:
+            return arena.emplace<ast::ArrayType>(child<ast::Type>(id, 0), child<ast::Expression>(id, 1));
+        case TypeKind::FunctionType: {
+            std::vector<ast::FunctionParameterType> parameters;
+            parameters.reserve(count - 1);
+            for (size_t p = 0; p + 1 < count; ++p) { parameters.emplace_back(at(id, p) != 0, child<ast::Type>(id, p)); }
+            return arena.emplace<ast::FunctionType>(std::move(parameters), child<ast::Type>(id, count - 1));
+        }
+        case TypeKind::GenericType:
+            return arena.emplace<ast::GenericType>(child<ast::Type>(id, 0), childList<ast::Type>(id, 1, count));
+        case TypeKind::PointerType: return arena.emplace<ast::PointerType>(child<ast::Type>(id, 0), at(id, 0) != 0);
+        case TypeKind::SymbolType:
+            return arena.emplace<ast::SymbolType>(string(id, 0), static_cast<ast::PrimitiveType_t>(at(id, 2)));
+        case TypeKind::TypeofType: return arena.emplace<ast::TypeofType>(child<ast::Expression>(id, 0));
+    }
+    ASSERT_UNREACHABLE("Invalid type in a validated encoded file");
+}
+
+ParsedFile EncodedFile::rehydrate(mnstl::chunk_allocator& arena, uint32_t source) const {
+    return Rehydrator(*this, arena, source).run();
+}
+
+}  // namespace parser
+}  // namespace Manganese
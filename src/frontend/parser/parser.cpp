@@ -4,48 +4,82 @@
 #include <io/logging.hpp>
 #include <string>
 #include <utility>
+#include <utils/arena_stats.hpp>
+#include <utils/memory_phase.hpp>
+#include <utils/time_report.hpp>
+#include <utils/trace.hpp>
 
 namespace Manganese {
 namespace parser {
 
 ParsedFile Parser::parse() {
-    // Parse the header (module declaration and imports)
-    if (peekTokenType() == TokenType::Module) { parseModuleDeclarationStatement(); }
-    while (peekTokenType() == TokenType::Import) { parseImportStatement(); }
-
-    this->hasParsedFileHeader = true;  // Now, setting a module or import name should be a warning
+    memory::PhaseScope phase(memory::Phase::Parse);
+    timing::PhaseTimer timer(timing::Phase::Parse, &arena);
+    trace::Scope scope("parse");
+    mnstl::chunk_allocator::tag_scope tag(arena, mnstl::alloc_tag::ast);
+    if (!hasParsedFileHeader) { DISCARD(parseHeader()); }
 
-    ast::Block program;
+    ast::Block program(arena.resource());
+    std::vector<uint32_t> statementOffsets;
     while (!done()) {
-        // No need to move thanks to copy elision
-        program.push_back(parseStatement());
+        statementOffsets.push_back(peekToken().getLocation().offset);
+        if (statementDiagnostics) {
+            logging::DiagnosticList diagnostics;
+            const bool hadError = hasError;
+            hasError = false;
+            {
+                logging::DiagnosticCapture capture(diagnostics);
+                program.push_back(parseStatement());
+            }
+            statementDiagnostics->push_back(
+                StatementDiagnostics{.diagnostics = std::move(diagnostics), .hasError = hasError});
+            hasError = hasError || hadError;
+        } else {
+            // No need to move thanks to copy elision
+            program.push_back(parseStatement());
+        }
 
         // Lookbehind is only needed within a statement, not across them
-        previousToken.reset();
+        hasPreviousToken = false;
     }
-    program.shrink_to_fit();  // Avoid having a bunch of allocated but unused memory
-    return ParsedFile{.moduleName = moduleName, .imports = std::move(imports), .program = std::move(program)};
+    logArenaStats("parsing", arena);
+    return ParsedFile{.moduleName = moduleName,
+                      .imports = std::move(imports),
+                      .program = std::move(program),
+                      .statementOffsets = std::move(statementOffsets),
+                      .hasError = hasError || (lexer && lexer->hasError())};
+}
+
+FileHeader Parser::parseHeader() {
+    memory::PhaseScope phase(memory::Phase::Parse);
+    timing::PhaseTimer timer(timing::Phase::Parse, &arena);
+    mnstl::chunk_allocator::tag_scope tag(arena, mnstl::alloc_tag::ast);
+    if (peekTokenType() == TokenType::Module) { parseModuleDeclarationStatement(); }
+    while (peekTokenType() == TokenType::Import) { parseImportStatement(); }
+
+    this->hasParsedFileHeader = true;  // Now, setting a module or import name should be a warning
+    return FileHeader{
+        .moduleName = moduleName, .imports = imports, .hasError = hasError || (lexer && lexer->hasError())};
 }
 
 // Helper functions
 bool Parser::isUnaryContext() const noexcept {
-    if (!previousToken) {
+    if (!hasPreviousToken) {
         // No previous token (this is the start of an expression), so it's a unary context
         // e.g. -3
         return true;
     }
-    const Token& lastToken = *previousToken;
-
-    return lastToken.getType() == TokenType::LeftParen
-        || (lastToken.isOperator() && lastToken.getType() != TokenType::Inc && lastToken.getType() != TokenType::Dec);
+    return previousTokenType == TokenType::LeftParen
+        || (lexer::isOperator(previousTokenType) && previousTokenType != TokenType::Inc
+            && previousTokenType != TokenType::Dec);
 }
 
 Token Parser::expectToken(TokenType expectedType) { return expectToken(expectedType, "Unexpected token: "); }
 
 Token Parser::expectToken(TokenType expectedType, const std::string& errorMessage) {
-    Token tok = peekToken();
+    const Token& tok = peekToken();
     if (tok.getType() == expectedType) { return consumeToken(); }
-    logging::logError(tok.getLine(), tok.getColumn(), "{} (expected '{}' but got '{}')", errorMessage,
+    logging::logError(tok.getLocation(), "{} (expected '{}' but got '{}')", errorMessage,
                       lexer::tokenTypeToString(expectedType), lexer::tokenTypeToString(tok.getType()));
     this->hasError = true;
 
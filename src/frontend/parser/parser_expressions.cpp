@@ -52,15 +52,10 @@ namespace Manganese {
 namespace parser {
 
 ast::Expression* Parser::parseExpression(Precedence precedence) {
-    Token token = peekToken();
-
     // Handle operators which have a unary and a binary version
     // (e.g. `-` can be a unary negation or a binary subtraction)
-    if (isUnaryContext() && token.hasUnaryCounterpart()) {
-        token.overrideType(token.getUnaryCounterpart(), token.getLexeme());
-        precedence = Precedence::Unary;
-    }
-    TokenType type = token.getType();
+    TokenType type = operatorType(peekToken());
+    if (type != peekTokenType()) { precedence = Precedence::Unary; }
     const std::size_t index = tokenToIndex(type);
 
     nudHandler_t nudHandler = nudLookup[index];
@@ -75,13 +70,9 @@ ast::Expression* Parser::parseExpression(Precedence precedence) {
     if (type == TokenType::AddressOf || type == TokenType::Dereference) { precedence = Precedence::Default; }
 
     while (!done()) {
-        token = peekToken();
-
-        if (isUnaryContext() && token.hasUnaryCounterpart()) {
-            token.overrideType(token.getUnaryCounterpart());
-            precedence = Precedence::Unary;
-        }
-        type = token.getType();
+        const Token& token = peekToken();
+        type = operatorType(token);
+        if (type != token.getType()) { precedence = Precedence::Unary; }
         const std::size_t idx = tokenToIndex(type);
         const Operator& op = operatorPrecedenceMap[idx];
 
@@ -101,7 +92,7 @@ ast::Expression* Parser::parseExpression(Precedence precedence) {
                 // identifier, it might be an inline aggregate instantiation
                 return left;
             }
-            logError(token.getLine(), token.getColumn(),
+            logError(token.getLocation(),
                      "Left brace after an expression must be preceded by an identifier (aggregate instantiation)"
                      " or a block precursor (if/for/while, etc.)");
         }
@@ -122,7 +113,7 @@ ast::Expression* Parser::parseAggregateInstantiationExpression(ast::Expression*
     if (left->kind == ast::ExpressionKind::GenericExpression) {
         auto* genericExpr = static_cast<ast::GenericExpression*>(left);
         if (genericExpr->identifier->kind != ast::ExpressionKind::IdentifierExpression) {
-            logError(left->getLine(), left->getColumn(),
+            logError(left->getLocation(),
                      "Generic aggregate instantiation must start with an aggregate name");
         } else {
             auto* identifierExpr = static_cast<ast::IdentifierExpression*>(genericExpr->identifier);
@@ -133,7 +124,7 @@ ast::Expression* Parser::parseAggregateInstantiationExpression(ast::Expression*
         auto* underlying = static_cast<ast::IdentifierExpression*>(left);
         aggregateName = underlying->value;
     } else {
-        logError(left->getLine(), left->getColumn(),
+        logError(left->getLocation(),
                  "Aggregate instantiation expression must start with an aggregate name, not {}", ast::toStringOr(left));
     }
 
@@ -141,8 +132,8 @@ ast::Expression* Parser::parseAggregateInstantiationExpression(ast::Expression*
         if (peekTokenType() == lexer::TokenType::RightBrace) {
             break;  // Done instantiation
         }
-        std::string propertyName
-            = expectToken(lexer::TokenType::Identifier, "Expected field name in aggregate instantiation").getLexeme();
+        std::string propertyName(
+            expectToken(lexer::TokenType::Identifier, "Expected field name in aggregate instantiation").getLexeme());
         expectToken(lexer::TokenType::Assignment, "Expected '=' to assign value to aggregate field");
         // want precedence to be 1 higher than assignment (e.g. field = x = 10 is invalid)
         const auto precedence = static_cast<std::underlying_type_t<Precedence>>(Precedence::Assignment) + 1;
@@ -152,7 +143,7 @@ ast::Expression* Parser::parseAggregateInstantiationExpression(ast::Expression*
             = [propertyName](const ast::AggregateInstantiationField& field) { return field.name == propertyName; };
 
         if (std::find_if(fields.begin(), fields.end(), is_duplicate) != fields.end()) {
-            logError(value->getLine(), value->getColumn(), "Duplicate field '{}' in aggregate instantiation of '{}'",
+            logError(value->getLocation(), "Duplicate field '{}' in aggregate instantiation of '{}'",
                      propertyName, aggregateName);
         } else {
             fields.push_back({.name = propertyName, .value = value});
@@ -171,7 +162,7 @@ ast::Expression* Parser::parseAggregateLiteralExpression() {
 
     expectToken(TokenType::LeftBrace, "Expected '{' to start an aggregate literal");
 
-    std::vector<ast::Expression*> expressions;
+    mnstl::arena_vector<ast::Expression*> expressions(arena.resource());
     while (peekTokenType() != TokenType::RightBrace) {
         expressions.push_back(parseExpression(Precedence::Default));
         if (peekTokenType() != TokenType::RightBrace) {
@@ -189,7 +180,7 @@ ast::Expression* Parser::parseAlignofExpression() {
     ast::Type* type = parseType(Precedence::Default);
     if (peekTokenType() != lexer::TokenType::RightParen) {
         logError(
-            peekToken().getLine(), peekToken().getColumn(),
+            peekToken().getLocation(),
             "alignof expects a type as its argument. If you are trying to take the type of an expression, use alignof(typeof(...))");
 
         while (peekTokenType() != lexer::TokenType::RightParen && peekTokenType() != lexer::TokenType::Semicolon
@@ -208,7 +199,7 @@ ast::Expression* Parser::parseAlignofExpression() {
 
 ast::Expression* Parser::parseArrayInstantiationExpression() {
     DISCARD(consumeToken());  // Consume the left square bracket
-    std::vector<ast::Expression*> elements;
+    mnstl::arena_vector<ast::Expression*> elements(arena.resource());
     while (!done()) {
         if (peekTokenType() == lexer::TokenType::RightSquare) {
             break;  // Done instantiation
@@ -241,7 +232,7 @@ ast::Expression* Parser::parseBinaryExpression(ast::Expression* left, Precedence
 
 ast::Expression* Parser::parseFunctionCallExpression(ast::Expression* left, Precedence) {
     DISCARD(consumeToken());
-    std::vector<ast::Expression*> arguments;
+    mnstl::arena_vector<ast::Expression*> arguments(arena.resource());
 
     while (!done()) {
         if (peekTokenType() == lexer::TokenType::RightParen) {
@@ -284,7 +275,8 @@ ast::Expression* Parser::parseIndexingExpression(ast::Expression* left, Preceden
 ast::Expression* Parser::parseMemberAccessExpression(ast::Expression* left, Precedence) {
     DISCARD(consumeToken());  // Consume the member access operator (.)
     return arena.emplace<ast::MemberAccessExpression>(
-        std::move(left), expectToken(lexer::TokenType::Identifier, "Expected identifier after '.'").getLexeme());
+        std::move(left),
+        std::string(expectToken(lexer::TokenType::Identifier, "Expected identifier after '.'").getLexeme()));
 }
 
 ast::Expression* Parser::parseParenthesizedExpression() {
@@ -301,13 +293,8 @@ ast::Expression* Parser::parsePostfixExpression(ast::Expression* left, Precedenc
 }
 
 ast::Expression* Parser::parsePrefixExpression() {
-    Token token = peekToken();
-    TokenType op = token.getType();
-
-    // Check if we need to convert to a unary counterpart
-    if (token.hasUnaryCounterpart() && isUnaryContext()) { op = token.getUnaryCounterpart(); }
-
-    // Now advance past the token
+    // Check if we need to convert to a unary counterpart, then advance past the token
+    const TokenType op = operatorType(peekToken());
     DISCARD(consumeToken());
 
     ast::Expression* right = parseExpression(Precedence::Unary);
@@ -316,7 +303,7 @@ ast::Expression* Parser::parsePrefixExpression() {
 
 ast::Expression* Parser::parsePrimaryExpression() {
     lexer::Token token = consumeToken();
-    std::string lexeme = token.getLexeme();
+    std::string lexeme(token.getLexeme());
 
     switch (token.getType()) {
         case TokenType::CharLiteral: return arena.emplace<ast::CharLiteralExpression>(lexeme[0]);  // Single character
@@ -325,23 +312,23 @@ ast::Expression* Parser::parsePrimaryExpression() {
         case TokenType::True: return arena.emplace<ast::BoolLiteralExpression>(true);
         case TokenType::False: return arena.emplace<ast::BoolLiteralExpression>(false);
         case TokenType::FloatLiteral: {
-            mnstl::string_conversion_result_t<mnstl::number_t> value = mnstl::str_to_num(lexeme, true);
+            const lexer::NumberLiteralValue& value = token.getNumber();
             if (!value.exists) {
-                logError(token.getLine(), token.getColumn(), "Invalid float literal '{}'", lexeme);
+                logError(token.getLocation(), "Invalid float literal '{}'", lexeme);
                 return arena.emplace<ast::NumberLiteralExpression>(0.0);
             } else if (value.overflowed) {
-                logError(token.getLine(), token.getColumn(), "Float literal {} cannot fit in its assigned type",
+                logError(token.getLocation(), "Float literal {} cannot fit in its assigned type",
                          lexeme);
             }
             return arena.emplace<ast::NumberLiteralExpression>(value.value);
         }
         case TokenType::IntegerLiteral: {
-            mnstl::string_conversion_result_t<mnstl::number_t> value = mnstl::str_to_num(lexeme, false);
+            const lexer::NumberLiteralValue& value = token.getNumber();
             if (!value.exists) {
-                logError(token.getLine(), token.getColumn(), "Invalid integer literal '{}'", lexeme);
+                logError(token.getLocation(), "Invalid integer literal '{}'", lexeme);
                 return arena.emplace<ast::NumberLiteralExpression>(0);
             } else if (value.overflowed) {
-                logError(token.getLine(), token.getColumn(), "Integer literal {} cannot fit in its assigned type",
+                logError(token.getLocation(), "Integer literal {} cannot fit in its assigned type",
                          lexeme);
             }
             return arena.emplace<ast::NumberLiteralExpression>(value.value);
@@ -354,7 +341,7 @@ ast::Expression* Parser::parsePrimaryExpression() {
 
 ast::Expression* Parser::parseScopeResolutionExpression(ast::Expression* left, Precedence) {
     DISCARD(consumeToken());  // Consume the scope resolution operator (::)
-    std::string element = expectToken(lexer::TokenType::Identifier, "Expected identifier after '::'").getLexeme();
+    std::string element(expectToken(lexer::TokenType::Identifier, "Expected identifier after '::'").getLexeme());
     return arena.emplace<ast::ScopeResolutionExpression>(left, std::move(element));
 }
 
@@ -364,7 +351,7 @@ ast::Expression* Parser::parseSizeofExpression() {
     ast::Type* type = parseType(Precedence::Default);
     if (peekTokenType() != lexer::TokenType::RightParen) {
         logError(
-            peekToken().getLine(), peekToken().getColumn(),
+            peekToken().getLocation(),
             "sizeof expects a type as its argument. If you are trying to take the type of an expression, use sizeof(typeof(...))");
 
         while (peekTokenType() != lexer::TokenType::RightParen && peekTokenType() != lexer::TokenType::Semicolon
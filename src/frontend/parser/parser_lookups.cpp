@@ -6,192 +6,219 @@ namespace Manganese {
 namespace parser {
 // Lookup Registration Methods
 
-void Parser::registerLedHandler_binary(TokenType type, Precedence bindingPower, ledHandler_t handler) noexcept {
+constexpr void Parser::registerLedHandler_binary(ExpressionLookups& lookups, TokenType type, Precedence bindingPower,
+                                                 ledHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index] = Operator::binary(bindingPower);
-    ledLookup[_index] = handler;
+    lookups.precedence[_index] = Operator::binary(bindingPower);
+    lookups.led[_index] = handler;
 }
-void Parser::registerLedHandler_postfix(TokenType type, Precedence bindingPower, ledHandler_t handler) noexcept {
+constexpr void Parser::registerLedHandler_postfix(ExpressionLookups& lookups, TokenType type, Precedence bindingPower,
+                                                  ledHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index] = Operator::postfix(bindingPower);
-    ledLookup[_index] = handler;
+    lookups.precedence[_index] = Operator::postfix(bindingPower);
+    lookups.led[_index] = handler;
 }
-void Parser::registerLedHandler_prefix(TokenType type, Precedence bindingPower, ledHandler_t handler) noexcept {
+constexpr void Parser::registerLedHandler_prefix(ExpressionLookups& lookups, TokenType type, Precedence bindingPower,
+                                                 ledHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index] = Operator::prefix(bindingPower);
-    ledLookup[_index] = handler;
+    lookups.precedence[_index] = Operator::prefix(bindingPower);
+    lookups.led[_index] = handler;
 }
 
-void Parser::registerNudHandler_binary(TokenType type, nudHandler_t handler) noexcept {
+constexpr void Parser::registerNudHandler_binary(ExpressionLookups& lookups, TokenType type,
+                                                 nudHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index] = Operator::binary(Precedence::Default);
-    nudLookup[_index] = handler;
+    lookups.precedence[_index] = Operator::binary(Precedence::Default);
+    lookups.nud[_index] = handler;
 }
 
-void Parser::registerNudHandler_prefix(TokenType type, nudHandler_t handler) noexcept {
+constexpr void Parser::registerNudHandler_prefix(ExpressionLookups& lookups, TokenType type,
+                                                 nudHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index] = Operator::prefix();
-    nudLookup[_index] = handler;
+    lookups.precedence[_index] = Operator::prefix();
+    lookups.nud[_index] = handler;
 }
 
-void Parser::registerStmtHandler(TokenType type, statementHandler_t handler) noexcept {
+constexpr void Parser::registerStmtHandler(ExpressionLookups& lookups, TokenType type,
+                                           statementHandler_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap[_index]
+    lookups.precedence[_index]
         = Operator{.leftBindingPower = Precedence::Default, .rightBindingPower = Precedence::Default};
-    statementLookup[_index] = handler;
+    lookups.statement[_index] = handler;
 }
 
 // Type Lookup Registration Methods
 
-void Parser::registerLedHandler_type(TokenType type, Precedence precedence, ledHandler_types_t handler) noexcept {
+constexpr void Parser::registerLedHandler_type(TypeLookups& lookups, TokenType type, Precedence precedence,
+                                               ledHandler_types_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap_type[_index] = Operator::binary(precedence);
-    ledLookup_types[_index] = handler;
+    lookups.precedence[_index] = Operator::binary(precedence);
+    lookups.led[_index] = handler;
 }
 
-void Parser::registerNudHandler_type(TokenType type, nudHandler_types_t handler) noexcept {
+constexpr void Parser::registerNudHandler_type(TypeLookups& lookups, TokenType type,
+                                               nudHandler_types_t handler) noexcept {
     size_t _index = tokenToIndex(type);
-    operatorPrecedenceMap_type[_index]
+    lookups.precedence[_index]
         = Operator{.leftBindingPower = Precedence::Primary, .rightBindingPower = Precedence::Default};
-    nudLookup_types[_index] = handler;
+    lookups.nud[_index] = handler;
 }
 
 // Actually register the lookups
 
 //! Really long stuff
 
-void Parser::initializeLookups() noexcept {
+constexpr Parser::ExpressionLookups Parser::makeLookups() noexcept {
     using enum lexer::TokenType;
+    ExpressionLookups lookups;
     //~ Assignments (updating variables, not initializing them)
-    registerLedHandler_binary(Assignment, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitAndAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitLShiftAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitNotAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitOrAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitRShiftAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(BitXorAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(DivAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(FloorDivAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(MinusAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(ModAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(MulAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
-    registerLedHandler_binary(PlusAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, Assignment, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitAndAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitLShiftAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitNotAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitOrAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitRShiftAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, BitXorAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, DivAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, FloorDivAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, MinusAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, ModAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, MulAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
+    registerLedHandler_binary(lookups, PlusAssign, Precedence::Assignment, &Parser::parseAssignmentExpression);
 
     //~ Bitwise Operators
-    registerLedHandler_binary(BitAnd, Precedence::BitwiseAnd, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(BitLShift, Precedence::BitwiseShift, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(BitOr, Precedence::BitwiseOr, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(BitRShift, Precedence::BitwiseShift, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(BitXor, Precedence::BitwiseXor, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, BitAnd, Precedence::BitwiseAnd, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, BitLShift, Precedence::BitwiseShift, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, BitOr, Precedence::BitwiseOr, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, BitRShift, Precedence::BitwiseShift, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, BitXor, Precedence::BitwiseXor, &Parser::parseBinaryExpression);
 
     //~ Relational
-    registerLedHandler_binary(Equal, Precedence::Relational, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(GreaterThan, Precedence::Relational, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(GreaterThanOrEqual, Precedence::Relational, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(LessThan, Precedence::Relational, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(LessThanOrEqual, Precedence::Relational, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(NotEqual, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Equal, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, GreaterThan, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, GreaterThanOrEqual, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, LessThan, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, LessThanOrEqual, Precedence::Relational, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, NotEqual, Precedence::Relational, &Parser::parseBinaryExpression);
 
     //~ Additive, Multiplicative, Exponential, Logical
-    registerLedHandler_binary(And, Precedence::LogicalAnd, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Div, Precedence::Multiplicative, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(FloorDiv, Precedence::Multiplicative, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Minus, Precedence::Additive, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Mod, Precedence::Multiplicative, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Mul, Precedence::Multiplicative, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Or, Precedence::LogicalOr, &Parser::parseBinaryExpression);
-    registerLedHandler_binary(Plus, Precedence::Additive, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, And, Precedence::LogicalAnd, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Div, Precedence::Multiplicative, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, FloorDiv, Precedence::Multiplicative, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Minus, Precedence::Additive, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Mod, Precedence::Multiplicative, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Mul, Precedence::Multiplicative, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Or, Precedence::LogicalOr, &Parser::parseBinaryExpression);
+    registerLedHandler_binary(lookups, Plus, Precedence::Additive, &Parser::parseBinaryExpression);
 
     //~ Literals and Symbols
-    registerNudHandler_binary(CharLiteral, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(False, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(FloatLiteral, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(Identifier, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(IntegerLiteral, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(LeftParen, &Parser::parseParenthesizedExpression);
-    registerNudHandler_binary(StrLiteral, &Parser::parsePrimaryExpression);
-    registerNudHandler_binary(True, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, CharLiteral, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, False, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, FloatLiteral, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, Identifier, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, IntegerLiteral, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, LeftParen, &Parser::parseParenthesizedExpression);
+    registerNudHandler_binary(lookups, StrLiteral, &Parser::parsePrimaryExpression);
+    registerNudHandler_binary(lookups, True, &Parser::parsePrimaryExpression);
 
     //~ Prefix Operators
-    registerNudHandler_prefix(AddressOf, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(BitNot, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(Dec, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(Dereference, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(Inc, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(Not, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(UnaryMinus, &Parser::parsePrefixExpression);
-    registerNudHandler_prefix(UnaryPlus, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, AddressOf, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, BitNot, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, Dec, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, Dereference, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, Inc, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, Not, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, UnaryMinus, &Parser::parsePrefixExpression);
+    registerNudHandler_prefix(lookups, UnaryPlus, &Parser::parsePrefixExpression);
 
     //~ PostFix Expression
-    registerLedHandler_postfix(Dec, Precedence::Postfix, &Parser::parsePostfixExpression);
-    registerLedHandler_postfix(Inc, Precedence::Postfix, &Parser::parsePostfixExpression);
+    registerLedHandler_postfix(lookups, Dec, Precedence::Postfix, &Parser::parsePostfixExpression);
+    registerLedHandler_postfix(lookups, Inc, Precedence::Postfix, &Parser::parsePostfixExpression);
 
     //~ Call/Member Expressions
-    registerLedHandler_binary(At, Precedence::Postfix, &Parser::parseGenericExpression);
-    registerLedHandler_binary(LeftBrace, Precedence::Postfix, &Parser::parseAggregateInstantiationExpression);
-    registerLedHandler_binary(LeftParen, Precedence::Postfix, &Parser::parseFunctionCallExpression);
-    registerNudHandler_binary(LeftSquare, &Parser::parseArrayInstantiationExpression);
-    registerLedHandler_binary(LeftSquare, Precedence::Postfix, &Parser::parseIndexingExpression);
-    registerLedHandler_binary(MemberAccess, Precedence::Member, &Parser::parseMemberAccessExpression);
-    registerLedHandler_binary(ScopeResolution, Precedence::ScopeResolution, &Parser::parseScopeResolutionExpression);
+    registerLedHandler_binary(lookups, At, Precedence::Postfix, &Parser::parseGenericExpression);
+    registerLedHandler_binary(lookups, LeftBrace, Precedence::Postfix, &Parser::parseAggregateInstantiationExpression);
+    registerLedHandler_binary(lookups, LeftParen, Precedence::Postfix, &Parser::parseFunctionCallExpression);
+    registerNudHandler_binary(lookups, LeftSquare, &Parser::parseArrayInstantiationExpression);
+    registerLedHandler_binary(lookups, LeftSquare, Precedence::Postfix, &Parser::parseIndexingExpression);
+    registerLedHandler_binary(lookups, MemberAccess, Precedence::Member, &Parser::parseMemberAccessExpression);
+    registerLedHandler_binary(lookups, ScopeResolution, Precedence::ScopeResolution,
+                              &Parser::parseScopeResolutionExpression);
 
     //~ Statements
-    registerStmtHandler(Alias, &Parser::parseAliasStatement);
-    registerStmtHandler(Break, &Parser::parseBreakStatement);
-    registerStmtHandler(Aggregate, &Parser::parseAggregateDeclarationStatement);
-    registerStmtHandler(Continue, &Parser::parseContinueStatement);
-    registerStmtHandler(Do, &Parser::parseDoWhileLoopStatement);
-    registerStmtHandler(Enum, &Parser::parseEnumDeclarationStatement);
-    registerStmtHandler(For, &Parser::parseForLoopStatement);
-    registerStmtHandler(Func, &Parser::parseFunctionDeclarationStatement);
-    registerStmtHandler(If, &Parser::parseIfStatement);
-    registerStmtHandler(Import, &Parser::parseImportStatement);
-    registerStmtHandler(Let, &Parser::parseVariableDeclarationStatement);
-    registerStmtHandler(Module, &Parser::parseModuleDeclarationStatement);
-    registerStmtHandler(Private, &Parser::parseVisibilityAffectedStatement);
-    registerStmtHandler(Public, &Parser::parseVisibilityAffectedStatement);
-    registerStmtHandler(Return, &Parser::parseReturnStatement);
-    registerStmtHandler(Switch, &Parser::parseSwitchStatement);
-    registerStmtHandler(While, &Parser::parseWhileLoopStatement);
+    registerStmtHandler(lookups, Alias, &Parser::parseAliasStatement);
+    registerStmtHandler(lookups, Break, &Parser::parseBreakStatement);
+    registerStmtHandler(lookups, Aggregate, &Parser::parseAggregateDeclarationStatement);
+    registerStmtHandler(lookups, Continue, &Parser::parseContinueStatement);
+    registerStmtHandler(lookups, Do, &Parser::parseDoWhileLoopStatement);
+    registerStmtHandler(lookups, Enum, &Parser::parseEnumDeclarationStatement);
+    registerStmtHandler(lookups, For, &Parser::parseForLoopStatement);
+    registerStmtHandler(lookups, Func, &Parser::parseFunctionDeclarationStatement);
+    registerStmtHandler(lookups, If, &Parser::parseIfStatement);
+    registerStmtHandler(lookups, Import, &Parser::parseImportStatement);
+    registerStmtHandler(lookups, Let, &Parser::parseVariableDeclarationStatement);
+    registerStmtHandler(lookups, Module, &Parser::parseModuleDeclarationStatement);
+    registerStmtHandler(lookups, Private, &Parser::parseVisibilityAffectedStatement);
+    registerStmtHandler(lookups, Public, &Parser::parseVisibilityAffectedStatement);
+    registerStmtHandler(lookups, Return, &Parser::parseReturnStatement);
+    registerStmtHandler(lookups, Switch, &Parser::parseSwitchStatement);
+    registerStmtHandler(lookups, While, &Parser::parseWhileLoopStatement);
 
     //~ Misc
-    registerLedHandler_binary(As, Precedence::TypeCast, &Parser::parseTypeCastExpression);
-    registerStmtHandler(Semicolon, &Parser::parseRedundantSemicolon);
-    registerNudHandler_binary(Aggregate, &Parser::parseAggregateLiteralExpression);
-    registerNudHandler_binary(Sizeof, &Parser::parseSizeofExpression);
-    registerNudHandler_binary(Alignof, &Parser::parseAlignofExpression);
+    registerLedHandler_binary(lookups, As, Precedence::TypeCast, &Parser::parseTypeCastExpression);
+    registerStmtHandler(lookups, Semicolon, &Parser::parseRedundantSemicolon);
+    registerNudHandler_binary(lookups, Aggregate, &Parser::parseAggregateLiteralExpression);
+    registerNudHandler_binary(lookups, Sizeof, &Parser::parseSizeofExpression);
+    registerNudHandler_binary(lookups, Alignof, &Parser::parseAlignofExpression);
+    return lookups;
 }
 
-void Parser::initializeTypeLookups() noexcept {
+constexpr Parser::TypeLookups Parser::makeTypeLookups() noexcept {
     using enum lexer::TokenType;
+    TypeLookups lookups;
     //~ Variable declarations with primitive types
-    registerNudHandler_type(Identifier, &Parser::parseSymbolType);
-    registerNudHandler_type(Int8, &Parser::parseSymbolType);
-    registerNudHandler_type(UInt8, &Parser::parseSymbolType);
-    registerNudHandler_type(Int16, &Parser::parseSymbolType);
-    registerNudHandler_type(UInt16, &Parser::parseSymbolType);
-    registerNudHandler_type(Int32, &Parser::parseSymbolType);
-    registerNudHandler_type(UInt32, &Parser::parseSymbolType);
-    registerNudHandler_type(Int64, &Parser::parseSymbolType);
-    registerNudHandler_type(UInt64, &Parser::parseSymbolType);
-    registerNudHandler_type(Float32, &Parser::parseSymbolType);
-    registerNudHandler_type(Float64, &Parser::parseSymbolType);
-    registerNudHandler_type(Int128, &Parser::parseSymbolType);
-    registerNudHandler_type(UInt128, &Parser::parseSymbolType);
-    registerNudHandler_type(Char, &Parser::parseSymbolType);
-    registerNudHandler_type(Bool, &Parser::parseSymbolType);
-    registerNudHandler_type(String, &Parser::parseSymbolType);
-    registerNudHandler_type(Ptr, &Parser::parsePointerType);
+    registerNudHandler_type(lookups, Identifier, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Int8, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, UInt8, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Int16, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, UInt16, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Int32, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, UInt32, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Int64, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, UInt64, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Float32, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Float64, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Int128, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, UInt128, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Char, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Bool, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, String, &Parser::parseSymbolType);
+    registerNudHandler_type(lookups, Ptr, &Parser::parsePointerType);
 
     //~ Complex types
-    registerNudHandler_type(Aggregate, &Parser::parseAggregateType);
-    registerLedHandler_type(At, Precedence::Generic, &Parser::parseGenericType);
-    registerNudHandler_type(Func, &Parser::parseFunctionType);
-    registerLedHandler_type(LeftSquare, Precedence::Postfix, &Parser::parseArrayType);
-    registerNudHandler_type(LeftParen, &Parser::parseParenthesizedType);
-    registerNudHandler_type(Typeof, &Parser::parseTypeofType);
+    registerNudHandler_type(lookups, Aggregate, &Parser::parseAggregateType);
+    registerLedHandler_type(lookups, At, Precedence::Generic, &Parser::parseGenericType);
+    registerNudHandler_type(lookups, Func, &Parser::parseFunctionType);
+    registerLedHandler_type(lookups, LeftSquare, Precedence::Postfix, &Parser::parseArrayType);
+    registerNudHandler_type(lookups, LeftParen, &Parser::parseParenthesizedType);
+    registerNudHandler_type(lookups, Typeof, &Parser::parseTypeofType);
+    return lookups;
 }
 
+// The builders run once per table, but only while compiling
+constinit const std::array<Parser::statementHandler_t, Parser::lookupSize> Parser::statementLookup
+    = makeLookups().statement;
+constinit const std::array<Parser::nudHandler_t, Parser::lookupSize> Parser::nudLookup = makeLookups().nud;
+constinit const std::array<Parser::ledHandler_t, Parser::lookupSize> Parser::ledLookup = makeLookups().led;
+constinit const std::array<Operator, Parser::lookupSize> Parser::operatorPrecedenceMap = makeLookups().precedence;
+
+constinit const std::array<Parser::nudHandler_types_t, Parser::lookupSize> Parser::nudLookup_types
+    = makeTypeLookups().nud;
+constinit const std::array<Parser::ledHandler_types_t, Parser::lookupSize> Parser::ledLookup_types
+    = makeTypeLookups().led;
+constinit const std::array<Operator, Parser::lookupSize> Parser::operatorPrecedenceMap_type
+    = makeTypeLookups().precedence;
+
 }  // namespace parser
 
 }  // namespace Manganese
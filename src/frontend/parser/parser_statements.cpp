@@ -36,14 +36,14 @@ ast::Statement* Parser::parseAggregateDeclarationStatement() {
     DISCARD(consumeToken());
     std::vector<std::string> genericTypes;
     std::vector<ast::AggregateField> fields;
-    std::string name = expectToken(TokenType::Identifier, "Expected aggregate name after 'aggregate'").getLexeme();
+    std::string name(expectToken(TokenType::Identifier, "Expected aggregate name after 'aggregate'").getLexeme());
 
     if (peekTokenType() == TokenType::LeftSquare) {
         DISCARD(consumeToken());
         while (!done() && peekTokenType() != TokenType::RightSquare) {
-            std::string genericName = (expectToken(TokenType::Identifier, "Expected a generic type name").getLexeme());
+            std::string genericName(expectToken(TokenType::Identifier, "Expected a generic type name").getLexeme());
             if (std::find(genericTypes.begin(), genericTypes.end(), genericName) != genericTypes.end()) {
-                logError(peekToken().getLine(), peekToken().getColumn(),
+                logError(peekToken().getLocation(),
                          "Generic type '{}' in aggregate '{}' was already declared", genericName, name);
             } else {
                 genericTypes.push_back(genericName);
@@ -62,12 +62,12 @@ ast::Statement* Parser::parseAggregateDeclarationStatement() {
             break;  // Done declaration
         }
         if (peekTokenType() != TokenType::Identifier) {
-            logError(peekToken().getLine(), peekToken().getColumn(),
+            logError(peekToken().getLocation(),
                      "Unexpected token '{}' in aggregate declaration. Expected field name.", peekToken().getLexeme());
             DISCARD(consumeToken());  // Skip the unexpected token to avoid infinite loop
         }
         Token t = consumeToken();
-        std::string fieldName = t.getLexeme();
+        std::string fieldName(t.getLexeme());
         expectToken(TokenType::Colon, "Expected a ':' to declare an aggregate field type.");
         bool isMutable = false;
         if (peekTokenType() == TokenType::Mut) {
@@ -81,7 +81,7 @@ ast::Statement* Parser::parseAggregateDeclarationStatement() {
             return field.name == fieldName;
         });
         if (duplicate != fields.end()) {
-            logError(t.getLine(), t.getColumn(),
+            logError(t.getLocation(),
                      "Duplicate field '{}' in aggregate '{}' (previously declared at line {}, column {})", fieldName,
                      name, duplicate->line, duplicate->column);
         } else {
@@ -106,9 +106,9 @@ ast::Statement* Parser::parseAliasStatement() {
     } else {
         // If it's not a primitive type, we expect an identifier.
         // This might be a path (e.g. alias foo::bar as baz, so we need to handle that)
-        std::string path
-            = expectToken(TokenType::Identifier, "Expected an identifier after 'alias', or a primitive type.")
-                  .getLexeme();
+        std::string path(
+            expectToken(TokenType::Identifier, "Expected an identifier after 'alias', or a primitive type.")
+                .getLexeme());
         while (peekTokenType() == TokenType::ScopeResolution) {
             path += consumeToken().getLexeme();
             path += expectToken(TokenType::Identifier,
@@ -129,7 +129,7 @@ ast::Statement* Parser::parseAliasStatement() {
         }
     }
     expectToken(TokenType::As, "Expected 'as' to introduce the type alias");
-    std::string alias = expectToken(TokenType::Identifier, "Expected an alias name").getLexeme();
+    std::string alias(expectToken(TokenType::Identifier, "Expected an alias name").getLexeme());
     expectToken(TokenType::Semicolon, "Expected a ';' after an alias statement");
     return arena.emplace<ast::AliasStatement>(baseType, std::move(alias));
 }
@@ -159,21 +159,21 @@ ast::Statement* Parser::parseDoWhileLoopStatement() {
 
 ast::Statement* Parser::parseEnumDeclarationStatement() {
     Token enumStartToken = consumeToken();
-    std::string name = expectToken(TokenType::Identifier, "Expected enum name after 'enum'").getLexeme();
+    std::string name(expectToken(TokenType::Identifier, "Expected enum name after 'enum'").getLexeme());
     ast::Type* baseType = nullptr;  // default if no type specified or if there's an error
     std::vector<ast::EnumValue> values;
     if (peekTokenType() == TokenType::Colon) {
         DISCARD(consumeToken());
         Token underlyingTok = peekToken();
         if (!underlyingTok.isInteger()) {
-            logError(underlyingTok.getLine(), underlyingTok.getColumn(),
+            logError(underlyingTok.getLocation(),
                      "Enums can only have integral types as their underlying type, not {}", underlyingTok.getLexeme());
             DISCARD(consumeToken());
         } else if (underlyingTok.isPrimitiveType()) {
-            baseType = arena.emplace<ast::SymbolType>(underlyingTok.getLexeme());
+            baseType = arena.emplace<ast::SymbolType>(std::string(underlyingTok.getLexeme()));
             DISCARD(consumeToken());
         } else {
-            logError(underlyingTok.getLine(), underlyingTok.getColumn(), "Expected an underlying type for an enum");
+            logError(underlyingTok.getLocation(), "Expected an underlying type for an enum");
             // If underlying type was just missing, don't skip the opening brace since that error will cascade
             if (underlyingTok.getType() != TokenType::LeftBrace) { DISCARD(consumeToken()); }
         }
@@ -181,7 +181,7 @@ ast::Statement* Parser::parseEnumDeclarationStatement() {
     if (!baseType) { baseType = arena.emplace<ast::SymbolType>("int32"); }
     expectToken(TokenType::LeftBrace, "Expected '{' to start the enum body");
     while (!done() && peekTokenType() != TokenType::RightBrace) {
-        std::string valueName = expectToken(TokenType::Identifier, "Expected enum value name").getLexeme();
+        std::string valueName(expectToken(TokenType::Identifier, "Expected enum value name").getLexeme());
         ast::Expression* valueExpression = nullptr;
         if (peekTokenType() == TokenType::Assignment) {
             DISCARD(consumeToken());
@@ -192,7 +192,7 @@ ast::Statement* Parser::parseEnumDeclarationStatement() {
                                       [valueName](const ast::EnumValue& value) { return value.name == valueName; });
 
         if (duplicate != values.end()) {
-            logError(peekToken().getLine(), peekToken().getColumn(),
+            logError(peekToken().getLocation(),
                      "Duplicate enum value '{}' in enum '{}' (previously declared at line {}, column {})", valueName,
                      name, duplicate->line, duplicate->column);
         } else {
@@ -207,7 +207,7 @@ ast::Statement* Parser::parseEnumDeclarationStatement() {
     }
     expectToken(TokenType::RightBrace, "Expected '}' to end the enum body");
     if (values.empty()) {
-        logError(enumStartToken.getLine(), enumStartToken.getColumn(), "Enum '{}' has no values", name);
+        logError(enumStartToken.getLocation(), "Enum '{}' has no values", name);
     }
     return arena.emplace<ast::EnumDeclarationStatement>(std::move(name), baseType, std::move(values));
 }
@@ -251,11 +251,11 @@ ast::Statement* Parser::parseFunctionDeclarationStatement() {
     // TODO: Handle function default parameters
     // TODO: Handle function variadic parameters
     DISCARD(consumeToken());
-    std::string name = expectToken(TokenType::Identifier, "Expected function name").getLexeme();
+    std::string name(expectToken(TokenType::Identifier, "Expected function name").getLexeme());
     std::vector<ast::FunctionParameter> params;
     std::vector<std::string> genericTypes;
     ast::Type* returnType = nullptr;
-    ast::Block body;
+    ast::Block body(arena.resource());
 
     if (peekTokenType() == TokenType::LeftSquare) {
         // Generics
@@ -265,13 +265,13 @@ ast::Statement* Parser::parseFunctionDeclarationStatement() {
                 break;  // End of generics
             }
             if (peekTokenType() != TokenType::Identifier) {
-                logError(peekToken().getLine(), peekToken().getColumn(), "Expected a generic type name");
+                logError(peekToken().getLocation(), "Expected a generic type name");
                 DISCARD(consumeToken());  // Skip the unexpected token to avoid infinite loop
             }
             Token genericToken = expectToken(TokenType::Identifier, "Expected a generic type name");
-            std::string genericName = genericToken.getLexeme();
+            std::string genericName(genericToken.getLexeme());
             if (std::find(genericTypes.begin(), genericTypes.end(), genericName) != genericTypes.end()) {
-                logError(genericToken.getLine(), genericToken.getColumn(),
+                logError(genericToken.getLocation(),
                          "Duplicate generic type '{}' in function '{}'", genericName, name);
             } else {
                 genericTypes.push_back(std::move(genericName));
@@ -288,7 +288,7 @@ ast::Statement* Parser::parseFunctionDeclarationStatement() {
     while (!done()) {
         if (peekTokenType() == TokenType::RightParen) { break; }
         bool isMutable = false;
-        std::string param_name = expectToken(TokenType::Identifier, "Expected a variable name").getLexeme();
+        std::string param_name(expectToken(TokenType::Identifier, "Expected a variable name").getLexeme());
         expectToken(TokenType::Colon);
         if (peekTokenType() == TokenType::Mut) {
             DISCARD(consumeToken());
@@ -332,7 +332,7 @@ ast::Statement* Parser::parseIfStatement() {
 
         elifs.emplace_back(elifCondition, parseBlock("elif body"));
     }
-    ast::Block elseBody;
+    ast::Block elseBody(arena.resource());
     if (peekTokenType() == TokenType::Else) {
         DISCARD(consumeToken());
         elseBody = parseBlock("else body");
@@ -341,18 +341,17 @@ ast::Statement* Parser::parseIfStatement() {
 }
 
 ast::Statement* Parser::parseImportStatement() {
-    size_t startLine = peekToken().getLine();
-    size_t startColumn = peekToken().getColumn();
+    const io::SourceLocation start = peekToken().getLocation();
 
     if (this->hasParsedFileHeader) {
-        logging::logWarning(startLine, startColumn, "Imports should go at the top of the file");
+        logging::logWarning(start, "Imports should go at the top of the file");
     }
     DISCARD(consumeToken());
     std::vector<std::string> path;
-    path.push_back(expectToken(TokenType::Identifier, "Expected a module name or path").getLexeme());
+    path.emplace_back(expectToken(TokenType::Identifier, "Expected a module name or path").getLexeme());
     while (peekTokenType() == TokenType::ScopeResolution) {
         DISCARD(consumeToken());  // Consume '::'
-        path.push_back(expectToken(TokenType::Identifier, "Expected identifier after '::'").getLexeme());
+        path.emplace_back(expectToken(TokenType::Identifier, "Expected identifier after '::'").getLexeme());
     }
     std::string alias;
     if (peekTokenType() == TokenType::As) {
@@ -369,12 +368,12 @@ ast::Statement* Parser::parseImportStatement() {
                                   existingPath[0],  // existingPath should never be empty
                                   [](const std::string& a, const std::string& b) { return a + "::" + b; });
 
-            logging::logWarning(startLine, startColumn, "Duplicate import of {}", imported);
+            logging::logWarning(start, "Duplicate import of {}", imported);
             duplicate = true;
             break;
 
         } else if (alias == existingAlias && !alias.empty()) {
-            logging::logWarning(startLine, startColumn, "Alias {} was already used", existingAlias);
+            logging::logWarning(start, "Alias {} was already used", existingAlias);
             duplicate = true;
             break;
         }
@@ -386,15 +385,15 @@ ast::Statement* Parser::parseImportStatement() {
 
 ast::Statement* Parser::parseModuleDeclarationStatement() {
     lexer::Token temp = consumeToken();
-    size_t startLine = temp.getLine(), startColumn = temp.getColumn();
+    const io::SourceLocation start = temp.getLocation();
     if (this->hasParsedFileHeader) {
-        logging::logWarning(startLine, startColumn, "Module declarations should go at the top of the file");
+        logging::logWarning(start, "Module declarations should go at the top of the file");
     }
-    std::string name = expectToken(TokenType::Identifier, "Expected a module name").getLexeme();
+    std::string name(expectToken(TokenType::Identifier, "Expected a module name").getLexeme());
     expectToken(TokenType::Semicolon, "Expected a ';' after a module declaration");
     if (!this->moduleName.empty()) {
         logError(
-            startLine, startColumn,
+            start,
             "A module name has previously been declared in this file. Files can only have one module declaration.");
     } else {
         this->moduleName = name;
@@ -423,7 +422,7 @@ ast::Statement* Parser::parseReturnStatement() {
 
 ast::Statement* Parser::parseSwitchStatement() {
     Token temp = consumeToken();
-    size_t startLine = temp.getLine(), startColumn = temp.getColumn();
+    const io::SourceLocation start = temp.getLocation();
     expectToken(TokenType::LeftParen, "Expected '(' to introduce switch variable");
     this->isParsingBlockPrecursor = true;
     ast::Expression* variable = parseExpression(Precedence::Default);
@@ -432,12 +431,12 @@ ast::Statement* Parser::parseSwitchStatement() {
     expectToken(TokenType::LeftBrace, "Expected '{' to start the switch body");
 
     std::vector<ast::CaseClause> cases;
-    ast::Block defaultBody;
+    ast::Block defaultBody(arena.resource());
 
     while (peekTokenType() == TokenType::Case) {
         DISCARD(consumeToken());
         ast::Expression* caseValue = parseExpression(Precedence::Default);
-        ast::Block caseBody;
+        ast::Block caseBody(arena.resource());
         expectToken(TokenType::Colon, "Expected ':' after case value");
         while (peekTokenType() != TokenType::Case && peekTokenType() != TokenType::Default
                && peekTokenType() != TokenType::RightBrace) {
@@ -451,7 +450,7 @@ ast::Statement* Parser::parseSwitchStatement() {
         while (peekTokenType() != TokenType::RightBrace) { defaultBody.push_back(parseStatement()); }
     }
     if (cases.empty() && defaultBody.empty()) {
-        logging::logWarning(startLine, startColumn, "Switch statement has no cases or default body");
+        logging::logWarning(start, "Switch statement has no cases or default body");
     }
     expectToken(TokenType::RightBrace, "Expected '}' to end the switch body");
 
@@ -467,7 +466,7 @@ ast::Statement* Parser::parseVisibilityAffectedStatement() {
             ASSERT_UNREACHABLE("Unexpected token type in parseVisibilityAffectedStatement: "
                                + lexer ::tokenTypeToString(peekTokenType()));
     }
-    size_t startLine = peekToken().getLine(), startColumn = peekToken().getColumn();
+    const io::SourceLocation start = peekToken().getLocation();
     switch (peekTokenType()) {
         case TokenType::Alias: {
             auto tempAlias = static_cast<ast::AliasStatement*>(parseAliasStatement());
@@ -490,7 +489,7 @@ ast::Statement* Parser::parseVisibilityAffectedStatement() {
             return tempFunction;
         }
         default:
-            logError(startLine, startColumn, "{} cannot follow a visibility modifier",
+            logError(start, "{} cannot follow a visibility modifier",
                      lexer::tokenTypeToString(peekTokenType()));
             // Parse the statement as if it had no visibility modifier
             return parseStatement();
@@ -508,9 +507,9 @@ ast::Statement* Parser::parseVariableDeclarationStatement() {
         DISCARD(consumeToken());  // Consume the 'mut' token
         isMutable = true;
     }
-    std::string name = expectToken(TokenType::Identifier,
-                                   std::format("Expected variable name after '{}'", isMutable ? "let mut" : "let"))
-                           .getLexeme();
+    std::string name(expectToken(TokenType::Identifier,
+                                 std::format("Expected variable name after '{}'", isMutable ? "let mut" : "let"))
+                         .getLexeme());
     if (peekTokenType() == TokenType::Colon) {
         DISCARD(consumeToken());  // Consume the colon
         if (peekTokenType() == TokenType::Public) {
@@ -550,7 +549,7 @@ ast::Statement* Parser::parseWhileLoopStatement() {
 // Helper Functions
 ast::Block Parser::parseBlock(const std::string& blockName) {
     expectToken(TokenType::LeftBrace, "Expected a '{' to start " + blockName);
-    ast::Block block;
+    ast::Block block(arena.resource());
     while (!done()) {
         if (peekTokenType() == TokenType::RightBrace) {
             break;  // End of the block
@@ -559,7 +558,7 @@ ast::Block Parser::parseBlock(const std::string& blockName) {
     }
     expectToken(TokenType::RightBrace, "Expected '}' to end " + blockName);
     if (block.empty()) {
-        logging::logWarning(peekToken().getLine(), peekToken().getColumn(), "{} is empty", blockName);
+        logging::logWarning(peekToken().getLocation(), "{} is empty", blockName);
     }
     return block;
 }
@@ -1,7 +1,9 @@
 #include <core.hpp>
+#include <format>
 #include <frontend/ast.hpp>
 #include <frontend/parser.hpp>
 #include <mnstl/number.hxx>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -40,7 +42,7 @@ ast::Type* Parser::parseType(Precedence precedence) {
 ast::Type* Parser::parseAggregateType() {
     DISCARD(consumeToken());  // Consume the 'aggregate' token
     if (peekTokenType() == TokenType::Identifier) {
-        logging::logWarning(peekToken().getLine(), peekToken().getColumn(),
+        logging::logWarning(peekToken().getLocation(),
                             "Aggregate names are ignored in aggregate type declarations");
         DISCARD(consumeToken());  // Skip the identifier token
     }
@@ -50,7 +52,7 @@ ast::Type* Parser::parseAggregateType() {
 
     while (peekTokenType() != TokenType::RightBrace) {
         if (peekTokenType() == TokenType::Identifier) {
-            logging::logWarning(peekToken().getLine(), peekToken().getColumn(),
+            logging::logWarning(peekToken().getLocation(),
                                 "Variable names are ignored in aggregate type declarations");
             DISCARD(consumeToken());  // Skip the token
             expectToken(TokenType::Colon, "Expected ':' after field name in aggregate type declaration");
@@ -148,12 +150,21 @@ ast::Type* Parser::parseSymbolType() {
     using enum ast::PrimitiveType_t;
     Token token = peekToken();
     if (!token.isPrimitiveType()) {
-        // If it's not a primitive type, expect an identifier (i.e., a user-defined type)
-        return arena.emplace<ast::SymbolType>(expectToken(TokenType::Identifier).getLexeme());
+        // If it's not a primitive type, expect an identifier (i.e., a user-defined type), which might be a member of
+        // an imported module (e.g. lib::Box)
+        std::string name(expectToken(TokenType::Identifier).getLexeme());
+        while (peekTokenType() == TokenType::ScopeResolution) {
+            name += consumeToken().getLexeme();
+            name += expectToken(TokenType::Identifier,
+                                std::format("Expected an identifier after {}",
+                                            lexer::tokenTypeToString(TokenType::ScopeResolution)))
+                        .getLexeme();
+        }
+        return arena.emplace<ast::SymbolType>(std::move(name));
     }
     // If the token is a primitive type, we can directly create a SymbolType
     DISCARD(consumeToken());
-    std::string lex = token.getLexeme();
+    std::string lex(token.getLexeme());
     ast::PrimitiveType_t prim_t = not_primitive;
     if (lex == int8_str) {
         prim_t = i8;
@@ -188,7 +199,7 @@ ast::Type* Parser::parseSymbolType() {
     } else {
         ASSERT_UNREACHABLE("Unknown primitive type " + lex);
     }
-    ast::SymbolType* symbol_type = arena.emplace<ast::SymbolType>(token.getLexeme(), prim_t);
+    ast::SymbolType* symbol_type = arena.emplace<ast::SymbolType>(std::move(lex), prim_t);
     return symbol_type;
 }
 
@@ -197,7 +208,7 @@ ast::Type* Parser::parseTypeofType() {
     expectToken(lexer::TokenType::LeftParen, "Expected '(' after typeof");
     ast::Expression* innerExpression = parseExpression(Precedence::Default);
     if (!innerExpression) {
-        logError(peekToken().getLine(), peekToken().getColumn(), "Expected a valid expression inside 'typeof(...)'.");
+        logError(peekToken().getLocation(), "Expected a valid expression inside 'typeof(...)'.");
         // Error recovery: give it a safe dummy fallback expression
         innerExpression = arena.emplace<ast::NumberLiteralExpression>(mnstl::number_t{int32_t{0}});
     }
@@ -1,11 +1,23 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <core.hpp>
 #include <frontend/ast.hpp>
 #include <frontend/semantic/analyzer.hpp>
 #include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <mnstl/chunk_allocator.hxx>
 #include <mnstl/fold_result.hxx>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <utils/arena_stats.hpp>
+#include <utils/memory_phase.hpp>
+#include <utils/time_report.hpp>
+#include <utils/trace.hpp>
 #include <utils/type_names.hpp>
+#include <vector>
 
 namespace Manganese {
 namespace semantic {
@@ -14,27 +26,85 @@ constexpr static inline uint8_t f32MantissaWidth = 24;
 constexpr static inline uint8_t f64MantissaWidth = 53;
 
 Result analyzer::analyze() {
+    memory::PhaseScope phase(memory::Phase::Analyze);
+    trace::Scope scope("analyze");
     Result isSemanticallyValid = Result::Success;
     if (collectTypes() == Result::Failure) { isSemanticallyValid = Result::Failure; }
     if (collectGlobals() == Result::Failure) { isSemanticallyValid = Result::Failure; }
     if (collectAndSpecializeGenerics() == Result::Failure) { isSemanticallyValid = Result::Failure; }
     // Don't want errors cascading because of conflicting redeclarations
-    if (isSemanticallyValid == Result::Failure) { return isSemanticallyValid; }
+    if (isSemanticallyValid == Result::Failure) {
+        logArenaStats("semantic analysis", arena);
+        return isSemanticallyValid;
+    }
 
     symbolTable.switchToCheckingMode();
     isSemanticallyValid = checkStatements();
+    logArenaStats("semantic analysis", arena);
+    return isSemanticallyValid;
+}
+
+Result analyzer::analyze(std::span<StatementCheck> checks) {
+    memory::PhaseScope phase(memory::Phase::Analyze);
+    trace::Scope scope("analyze");
+    Result isSemanticallyValid = Result::Success;
+    if (collectTypes() == Result::Failure) { isSemanticallyValid = Result::Failure; }
+    if (collectGlobals() == Result::Failure) { isSemanticallyValid = Result::Failure; }
+    if (collectAndSpecializeGenerics() == Result::Failure) { isSemanticallyValid = Result::Failure; }
+    if (isSemanticallyValid == Result::Failure) {
+        for (StatementCheck& check : checks) { check.isStale = true; }
+        logArenaStats("semantic analysis", arena);
+        return isSemanticallyValid;
+    }
+
+    symbolTable.switchToCheckingMode();
+    timing::PhaseTimer timer(timing::Phase::CheckStatements, &arena);
+    const ast::Block& program = parsedFile.program;
+    for (size_t i = 0; i < program.size(); ++i) {
+        StatementCheck& check = checks[i];
+        if (check.isStale || program[i]->kind != ast::StatementKind::FunctionDeclarationStatement) {
+            check.diagnostics.clear();
+            {
+                logging::DiagnosticCapture capture(check.diagnostics);
+                check.result = visit(program[i]);
+            }
+            check.isStale = false;
+        }
+        if (check.result == Result::Failure) { isSemanticallyValid = Result::Failure; }
+    }
+    logArenaStats("semantic analysis", arena);
     return isSemanticallyValid;
 }
 
 // Placeholders to satisfy the linker
 // TODO: implement these
 Result analyzer::collectGlobals() { return Result::Success; }
-Result analyzer::collectAndSpecializeGenerics() { return Result::Success; }
 
-const SemanticType* analyzer::promoteNumericTypes(const SemanticType* lhs, const SemanticType* rhs) const {
-    DISCARD(lhs);
-    DISCARD(rhs);
-    return nullptr;
+std::vector<ExportedSymbol> analyzer::exportedSymbols() const {
+    std::vector<ExportedSymbol> exports;
+    symbolTable.forEachGlobal([&](std::string_view name, const Symbol& symbol) {
+        if (symbol.visibility != ast::Visibility::Public) { return; }
+        const SemanticType* type = symbol.type;
+        if (symbol.kind == SymbolKind::Function && !type) {
+            // A function's type follows from its signature, whose types were resolved while checking it
+            const auto* function = static_cast<const ast::FunctionDeclarationStatement*>(symbol.node);
+            std::vector<Parameter> parameters;
+            bool resolved = function->genericTypes.empty();
+            for (const ast::FunctionParameter& parameter : function->parameters) {
+                resolved = resolved && parameter.type->semanticType != nullptr;
+                parameters.push_back(Parameter{.isMutable = parameter.isMutable, .type = parameter.type->semanticType});
+            }
+            const SemanticType* returnType = function->returnType ? function->returnType->semanticType : nullptr;
+            if (function->returnType && !returnType) { resolved = false; }
+            if (resolved) { type = typeContext.getFunction(std::move(parameters), returnType); }
+        }
+        exports.push_back(ExportedSymbol{.name = name,
+                                         .kind = symbol.kind,
+                                         .isMutable = symbol.isMutable,
+                                         .type = type,
+                                         .typeParameterCount = static_cast<uint32_t>(_typeParameterCount(symbol))});
+    });
+    return exports;
 }
 
 Result analyzer::analyzePointerArithmetic(const SemanticType* lhs, const SemanticType* rhs) const {
@@ -49,6 +119,8 @@ auto analyzer::areTypesComparable(const SemanticType* lhs, const SemanticType* r
 }
 
 Result analyzer::checkStatements() {  // semantic analysis pass (this can also check the generic specializations)
+    timing::PhaseTimer timer(timing::Phase::CheckStatements, &arena);
+    if (checkingThreads != 1) { return checkStatementsInParallel(); }
     Result programIsSemanticallyValid = Result::Success;
     for (ast::Statement* stmt : parsedFile.program) {
         if (this->visit(stmt) == Result::Failure) { programIsSemanticallyValid = Result::Failure; }
@@ -56,8 +128,59 @@ Result analyzer::checkStatements() {  // semantic analysis pass (this can also c
     return programIsSemanticallyValid;
 }
 
+/**
+ * @brief Check function bodies on several threads, each with its own fork of the symbol table and its own context
+ * Everything else at the top level is checked on this thread first, since it can declare globals the functions use.
+ * Each top-level statement's diagnostics are buffered, then written out in source order, so the output is the same as
+ * a sequential check's.
+ */
+Result analyzer::checkStatementsInParallel() {
+    const ast::Block& program = parsedFile.program;
+    std::vector<logging::DiagnosticList> diagnostics(program.size());
+    std::vector<size_t> functions;  // Indices into the program
+    Result programIsSemanticallyValid = Result::Success;
+    for (size_t i = 0; i < program.size(); ++i) {
+        if (program[i]->kind == ast::StatementKind::FunctionDeclarationStatement) {
+            functions.push_back(i);
+            continue;
+        }
+        logging::DiagnosticCapture capture(diagnostics[i]);
+        if (visit(program[i]) == Result::Failure) { programIsSemanticallyValid = Result::Failure; }
+    }
+
+    std::vector<Result> results(functions.size(), Result::Success);
+    std::atomic<size_t> nextFunction = 0;
+    auto checkFunctions = [&]() {
+        memory::PhaseScope phase(memory::Phase::Analyze);
+        trace::Scope scope("check functions");
+        mnstl::chunk_allocator taskArena;
+        analyzer checker(*this, taskArena);
+        // Threads take the next unchecked function as they finish one, so a few long bodies don't hold the rest up
+        for (size_t i; (i = nextFunction.fetch_add(1, std::memory_order_relaxed)) < functions.size();) {
+            logging::DiagnosticCapture capture(diagnostics[functions[i]]);
+            results[i] = checker.visit(program[functions[i]]);
+        }
+    };
+    {
+        const size_t threads = checkingThreads ? checkingThreads : std::max(1u, std::thread::hardware_concurrency());
+        const size_t numWorkers = std::min(threads, std::max(functions.size(), size_t{1})) - 1;  // This thread too
+        std::vector<std::jthread> workers;
+        workers.reserve(numWorkers);
+        for (size_t i = 0; i < numWorkers; ++i) { workers.emplace_back(checkFunctions); }
+        checkFunctions();
+    }  // Join the workers
+
+    for (const logging::DiagnosticList& buffer : diagnostics) { logging::report(buffer); }
+    if (std::ranges::find(results, Result::Failure) != results.end()) {
+        programIsSemanticallyValid = Result::Failure;
+    }
+    return programIsSemanticallyValid;
+}
+
 // Type compatibility
 
+namespace {
+
 struct PrimitiveInfo {
     enum class Category {
         Int,
@@ -71,7 +194,7 @@ struct PrimitiveInfo {
     int bit_width = 0;
 };
 
-inline PrimitiveInfo getPrimitiveInfo(ast::PrimitiveType_t type) {
+constexpr PrimitiveInfo getPrimitiveInfo(ast::PrimitiveType_t type) {
     using enum ast::PrimitiveType_t;
     using Cat = PrimitiveInfo::Category;
 
@@ -99,106 +222,218 @@ inline PrimitiveInfo getPrimitiveInfo(ast::PrimitiveType_t type) {
     return {Cat::Int, 0};
 }
 
-auto analyzer::arePrimitivesCompatible(const SemanticType* from, const SemanticType* to) const
-    -> typeCompatibilityResult {
-    using Cat = PrimitiveInfo::Category;
-    if (from->primitiveType == to->primitiveType) { return {.result = Compatible_t::Valid}; }
+}  // namespace
 
-    PrimitiveInfo src = getPrimitiveInfo(from->primitiveType);
-    PrimitiveInfo dest = getPrimitiveInfo(to->primitiveType);
-    const bool is_conditional_context = context.ifStatementDepth || context.forLoopDepth || context.whileLoopDepth;
+/**
+ * @brief The type arithmetic on `lhs` and `rhs` produces: the wider of the two, if both are signed integers, unsigned
+ * integers or floating point numbers
+ * @details Mixing signed and unsigned integers, or integers and floating point numbers, needs an explicit cast, since
+ * either way of converting can change the value
+ */
+const SemanticType* analyzer::promoteNumericTypes(const SemanticType* lhs, const SemanticType* rhs) const {
+    if (!lhs->isPrimitive() || !rhs->isPrimitive()) { return nullptr; }
+    if (!isNumeric(lhs->primitiveType) || !isNumeric(rhs->primitiveType)) { return nullptr; }
+    if (lhs == rhs) { return lhs; }
+    const PrimitiveInfo left = getPrimitiveInfo(lhs->primitiveType);
+    const PrimitiveInfo right = getPrimitiveInfo(rhs->primitiveType);
+    if (left.category != right.category) { return nullptr; }
+    return left.bit_width >= right.bit_width ? lhs : rhs;
+}
 
-    if (dest.category == Cat::Bool && is_conditional_context) { return {.result = Compatible_t::Valid}; }
+namespace {
 
-    auto yield_warning = [this](std::string msg) -> typeCompatibilityResult {
-        if (context.typeCastDepth) { return {.result = Compatible_t::Valid}; }
-        return {.result = Compatible_t::Warning, .message = std::move(msg)};
-    };
+struct PrimitiveCompatibility {
+    Compatible_t result;
+    Incompatibility reason = Incompatibility::None;
+};
+
+// Whether `from` converts to `to` (two different primitives) outside of conditions and casts, which only relax it
+constexpr PrimitiveCompatibility comparePrimitives(ast::PrimitiveType_t from, ast::PrimitiveType_t to) {
+    using Cat = PrimitiveInfo::Category;
+    using enum Compatible_t;
+    using Reason = Incompatibility;
+    const PrimitiveInfo src = getPrimitiveInfo(from);
+    const PrimitiveInfo dest = getPrimitiveInfo(to);
 
     // String conversions
     if (src.category == Cat::String) {
-        if (dest.category == Cat::Bool) {
-            return yield_warning(std::format("Implicit conversion from '{}' to '{}'", string_str, bool_str));
-        }
-        return {.result = Compatible_t::Error,
-                .message = std::format("Cannot convert '{}' to non-boolean type", string_str)};
+        if (dest.category == Cat::Bool) { return {Warning, Reason::StringToBool}; }
+        return {Error, Reason::StringToNonBool};
     }
-
     if (dest.category == Cat::String) {
-        if (src.category == Cat::Char) {
-            return {.result = Compatible_t::Valid};  // char -> string is fine
-        }
-        return {.result = Compatible_t::Error,
-                .message = std::format("Cannot convert non-char type to '{}'", string_str)};
+        if (src.category == Cat::Char) { return {Valid}; }  // char -> string is fine
+        return {Error, Reason::NonCharToString};
     }
 
     // Bool and char to nunmeric
-    if (src.category == Cat::Bool || dest.category == Cat::Bool) {
-        // Non-conditional conversions involving bool warrant a warning
-        return yield_warning(
-            std::format("Conversion between '{}' and '{}' can alter semantics", from->toString(), to->toString()));
-    }
+    // Non-conditional conversions involving bool warrant a warning
+    if (src.category == Cat::Bool || dest.category == Cat::Bool) { return {Warning, Reason::BoolConversion}; }
 
     // Float <-> integer
     if ((src.category == Cat::Int || src.category == Cat::UInt) && dest.category == Cat::Float) {
         // Int to float can lose precision if the int width >= float mantissa width
         if (src.bit_width >= (dest.bit_width == 32 ? f32MantissaWidth : f64MantissaWidth)) {
-            return yield_warning(std::format("Conversion from '{}' to '{}' may lose precision digits", from->toString(),
-                                             to->toString()));
+            return {Warning, Reason::LosesPrecision};
         }
-        return {.result = Compatible_t::Valid};  // e.g. i16 -> f32 is completely safe
+        return {Valid};  // e.g. i16 -> f32 is completely safe
     }
-
     if (src.category == Cat::Float && (dest.category == Cat::Int || dest.category == Cat::UInt)) {
-        return yield_warning(
-            std::format("Conversion from '{}' to '{}' truncates decimal components", from->toString(), to->toString()));
+        return {Warning, Reason::TruncatesDecimals};
     }
 
     // Integer <-> Integer or Float <-> Float
     if (src.category != dest.category && src.category != Cat::Float && dest.category != Cat::Float) {
-        return yield_warning(
-            std::format("Sign mismatch: conversion between '{}' and '{}' may cause data loss or sign-flipping",
-                        from->toString(), to->toString()));
+        return {Warning, Reason::SignMismatch};
+    }
+    if (src.bit_width > dest.bit_width) { return {Warning, Reason::Narrowing}; }
+    return {Valid};  // Widening conversion is fine
+}
+
+constexpr size_t NUM_PRIMITIVES = static_cast<size_t>(ast::PrimitiveType_t::boolean) + 1;
+
+// Every pair of primitives, worked out at compile time, indexed by [from][to]
+constexpr auto primitiveCompatibility = []() {
+    std::array<std::array<PrimitiveCompatibility, NUM_PRIMITIVES>, NUM_PRIMITIVES> table{};
+    for (size_t from = 0; from < NUM_PRIMITIVES; ++from) {
+        for (size_t to = 0; to < NUM_PRIMITIVES; ++to) {
+            table[from][to] = from == to ? PrimitiveCompatibility{Compatible_t::Valid}
+                                         : comparePrimitives(static_cast<ast::PrimitiveType_t>(from),
+                                                             static_cast<ast::PrimitiveType_t>(to));
+        }
+    }
+    return table;
+}();
+
+}  // namespace
+
+std::string analyzer::typeCompatibilityResult::message() const {
+    using enum Incompatibility;
+    switch (reason) {
+        case None: return "";
+        case UndeducedType: return "Could not deduce types";
+        case StringToBool: return std::format("Implicit conversion from '{}' to '{}'", string_str, bool_str);
+        case StringToNonBool: return std::format("Cannot convert '{}' to non-boolean type", string_str);
+        case NonCharToString: return std::format("Cannot convert non-char type to '{}'", string_str);
+        case BoolConversion:
+            return std::format("Conversion between '{}' and '{}' can alter semantics", from->toString(),
+                               to->toString());
+        case LosesPrecision:
+            return std::format("Conversion from '{}' to '{}' may lose precision digits", from->toString(),
+                               to->toString());
+        case TruncatesDecimals:
+            return std::format("Conversion from '{}' to '{}' truncates decimal components", from->toString(),
+                               to->toString());
+        case SignMismatch:
+            return std::format("Sign mismatch: conversion between '{}' and '{}' may cause data loss or sign-flipping",
+                               from->toString(), to->toString());
+        case Narrowing:
+            return std::format("Narrowing conversion: potential data loss converting from '{}' to '{}'",
+                               from->toString(), to->toString());
+        default: break;
+    }
+
+    const std::string conversionError = std::format("Cannot convert {} to {}", from->toString(), to->toString());
+    switch (reason) {
+        case DifferentKinds: return conversionError;
+        case AggregateConversion: return conversionError + " (aggregates cannot be converted to other types).";
+        case ArrayLengthMismatch: return conversionError + " (cannot convert between arrays of different lengths).";
+        case ArrayElementMismatch: {
+            auto* arrFrom = static_cast<const Array*>(from);
+            auto* arrTo = static_cast<const Array*>(to);
+            return conversionError
+                + std::format(" (cannot convert an array of {} to an array of {})", arrFrom->elementType->toString(),
+                              arrTo->elementType->toString());
+        }
+        case ParameterCountMismatch: return conversionError + " (different number of parameters).";
+        case ParameterTypeMismatch: {
+            const Parameter& fromParam = static_cast<const Function*>(from)->parameterTypes[position];
+            const Parameter& toParam = static_cast<const Function*>(to)->parameterTypes[position];
+            return conversionError
+                + std::format(
+                       " (mismatch in position {}: parameter type {} is cannot be converted to parameter type {}).",
+                       position, fromParam.toString(), toParam.toString());
+        }
+        case ParameterMutabilityMismatch: {
+            const Parameter& fromParam = static_cast<const Function*>(from)->parameterTypes[position];
+            const Parameter& toParam = static_cast<const Function*>(to)->parameterTypes[position];
+            return conversionError
+                + std::format(" (parameter in position {} in {} is {} but is {} in {})", position, from->toString(),
+                              (fromParam.isMutable ? "mutable" : "immutable"),
+                              (toParam.isMutable ? "mutable" : "immutable"), toParam.toString());
+        }
+        case GenericBaseMismatch: return "";
+        case TypeArgumentCountMismatch: return conversionError + " (different number of type parameters).";
+        case TypeArgumentMismatch: {
+            const SemanticType* fromArgument = static_cast<const GenericInstance*>(from)->typeArguments[position];
+            const SemanticType* toArgument = static_cast<const GenericInstance*>(to)->typeArguments[position];
+            return conversionError
+                + std::format(" (mismatch in position {}: {} cannot convert to {})", position, fromArgument->toString(),
+                              toArgument->toString());
+        }
+        case PointerMutabilityMismatch:
+            return conversionError + " (cannot convert an immutable pointer to a mutable pointer).";
+        default: ASSERT_UNREACHABLE("Unknown incompatibility in typeCompatibilityResult::message");
+    }
+}
+
+auto analyzer::arePrimitivesCompatible(const SemanticType* from, const SemanticType* to) const
+    -> typeCompatibilityResult {
+    if (from->primitiveType == to->primitiveType) { return {.result = Compatible_t::Valid}; }
+
+    const bool is_conditional_context = context.ifStatementDepth || context.forLoopDepth || context.whileLoopDepth;
+    if (to->primitiveType == ast::PrimitiveType_t::boolean && is_conditional_context) {
+        return {.result = Compatible_t::Valid};
     }
-    if (src.bit_width > dest.bit_width) {
-        return yield_warning(std::format("Narrowing conversion: potential data loss converting from '{}' to '{}'",
-                                         from->toString(), to->toString()));
+
+    const PrimitiveCompatibility& compatibility
+        = primitiveCompatibility[static_cast<size_t>(from->primitiveType)][static_cast<size_t>(to->primitiveType)];
+    // Casting is explicit, so conversions that only warrant a warning are fine
+    if (compatibility.result == Compatible_t::Warning && context.typeCastDepth) {
+        return {.result = Compatible_t::Valid};
     }
-    return {.result = Compatible_t::Valid};  // Widening conversion is fine
+    return {.result = compatibility.result, .reason = compatibility.reason, .from = from, .to = to};
 }
 
 auto analyzer::areTypesCompatible(const SemanticType* from, const SemanticType* to) const -> typeCompatibilityResult {
     // Null pointer means something went wrong in type deduction
-    if (!from || !to) { return {.result = Compatible_t::Error, .message = "Could not deduce types"}; }
+    if (!from || !to) { return {.result = Compatible_t::Error, .reason = Incompatibility::UndeducedType}; }
 
     // Duplicated types point to the same underlying value so we can just do a fast pointer comparison
     if (from == to) { return {.result = Compatible_t::Valid}; }
+    if (from->isPrimitive() && to->isPrimitive()) { return arePrimitivesCompatible(from, to); }
+
+    // Types are interned, so a pair of (compound) types can be remembered by address. Primitives nested inside them
+    // depend on the context, so that is part of the key too
+    const CompatibilityKey key{.from = from,
+                               .to = to,
+                               .inCondition = context.ifStatementDepth || context.forLoopDepth
+                                   || context.whileLoopDepth,
+                               .inCast = context.typeCastDepth != 0};
+    if (auto it = compatibilityCache.find(key); it != compatibilityCache.end()) { return it->second; }
+    const typeCompatibilityResult result = compareCompoundTypes(from, to);
+    compatibilityCache.emplace(key, result);
+    return result;
+}
 
-    const std::string conversionError = std::format("Cannot convert {} to {}", from->toString(), to->toString());
+auto analyzer::compareCompoundTypes(const SemanticType* from, const SemanticType* to) const
+    -> typeCompatibilityResult {
+    auto incompatible = [&](Incompatibility reason, uint32_t position = 0) -> typeCompatibilityResult {
+        return {.result = Compatible_t::Error, .reason = reason, .from = from, .to = to, .position = position};
+    };
 
     // Totally distinct types are not interconvertible
-    if (from->kind != to->kind) { return {.result = Compatible_t::Error, .message = conversionError}; }
+    if (from->kind != to->kind) { return incompatible(Incompatibility::DifferentKinds); }
 
     // Same structure but different instances (e.g. pointers to different types)
     switch (from->kind) {
-        case Kind::Aggregate:
-            return {.result = Compatible_t::Error,
-                    .message = conversionError + " (aggregates cannot be converted to other types)."};
+        case Kind::Aggregate: return incompatible(Incompatibility::AggregateConversion);
         case Kind::Array: {
             auto* arrFrom = static_cast<const Array*>(from);
             auto* arrTo = static_cast<const Array*>(to);
-            if (arrFrom->length != arrTo->length) {
-                return {.result = Compatible_t::Error,
-                        .message = conversionError + " (cannot convert between arrays of different lengths)."};
-            }
+            if (arrFrom->length != arrTo->length) { return incompatible(Incompatibility::ArrayLengthMismatch); }
             typeCompatibilityResult baseCompatible = areTypesCompatible(arrFrom->elementType, arrTo->elementType);
 
-            if (!baseCompatible) {
-                return {.result = Compatible_t::Error,
-                        .message = conversionError
-                            + std::format(" (cannot convert an array of {} to an array of {})",
-                                          arrFrom->elementType->toString(), arrTo->elementType->toString())};
-            }
+            if (!baseCompatible) { return incompatible(Incompatibility::ArrayElementMismatch); }
             return baseCompatible;
         } break;
 
@@ -207,26 +442,16 @@ auto analyzer::areTypesCompatible(const SemanticType* from, const SemanticType*
             auto* funcTo = static_cast<const Function*>(to);
 
             if (funcFrom->parameterTypes.size() != funcTo->parameterTypes.size()) {
-                return {.result = Compatible_t::Error,
-                        .message = conversionError + " (different number of parameters)."};
+                return incompatible(Incompatibility::ParameterCountMismatch);
             }
             for (std::size_t i = 0; i < funcFrom->parameterTypes.size(); ++i) {
                 const Parameter& funcFromParam = funcFrom->parameterTypes[i];
                 const Parameter& funcToParam = funcTo->parameterTypes[i];
                 if (!areTypesCompatible(funcFromParam.type, funcToParam.type)) {
-                    const std::string error = std::format(
-                        " (mismatch in position {}: parameter type {} is cannot be converted to parameter type {}).", i,
-                        funcFromParam.toString(), funcToParam.toString());
-
-                    return {.result = Compatible_t::Error, .message = conversionError + error};
+                    return incompatible(Incompatibility::ParameterTypeMismatch, static_cast<uint32_t>(i));
                 }
                 if (funcFromParam.isMutable != funcToParam.isMutable) {
-                    std::string error
-                        = std::format(" (parameter in position {} in {} is {} but is {} in {})", i,
-                                      funcFrom->toString(), (funcFromParam.isMutable ? "mutable" : "immutable"),
-                                      (funcToParam.isMutable ? "mutable" : "immutable"), funcToParam.toString());
-
-                    return {.result = Compatible_t::Error, .message = conversionError + error};
+                    return incompatible(Incompatibility::ParameterMutabilityMismatch, static_cast<uint32_t>(i));
                 }
             }
             return areTypesCompatible(funcFrom->returnType, funcTo->returnType);
@@ -236,19 +461,15 @@ auto analyzer::areTypesCompatible(const SemanticType* from, const SemanticType*
             auto* genericFrom = static_cast<const GenericInstance*>(from);
             auto* genericTo = static_cast<const GenericInstance*>(to);
 
-            if (genericFrom->baseType != genericTo->baseType) { return {.result = Compatible_t::Error}; }
+            if (genericFrom->baseType != genericTo->baseType) {
+                return incompatible(Incompatibility::GenericBaseMismatch);
+            }
             if (genericFrom->typeArguments.size() != genericTo->typeArguments.size()) {
-                return {.result = Compatible_t::Error,
-                        .message = conversionError + " (different number of type parameters)."};
+                return incompatible(Incompatibility::TypeArgumentCountMismatch);
             }
             for (size_t i = 0; i < genericFrom->typeArguments.size(); ++i) {
-                const SemanticType* fromArgument = genericFrom->typeArguments[i];
-                const SemanticType* toArgument = genericTo->typeArguments[i];
-                if (!areTypesCompatible(fromArgument, toArgument)) {
-                    return {.result = Compatible_t::Error,
-                            .message = conversionError
-                                + std::format(" (mismatch in position {}: {} cannot convert to {})", i,
-                                              fromArgument->toString(), toArgument->toString())};
+                if (!areTypesCompatible(genericFrom->typeArguments[i], genericTo->typeArguments[i])) {
+                    return incompatible(Incompatibility::TypeArgumentMismatch, static_cast<uint32_t>(i));
                 }
             }
             return {.result = Compatible_t::Valid};
@@ -261,8 +482,7 @@ auto analyzer::areTypesCompatible(const SemanticType* from, const SemanticType*
             // making an immutable pointer (ptr int) mutable (ptr mut int) is not allowed
             // but making a mutable pointer (ptr mut int) mutable (ptr int) is fine
             if (!ptrFrom->isMutable && ptrTo->isMutable) {
-                return {.result = Compatible_t::Error,
-                        .message = conversionError + " (cannot convert an immutable pointer to a mutable pointer)."};
+                return incompatible(Incompatibility::PointerMutabilityMismatch);
             }
             return areTypesCompatible(ptrFrom->baseType, ptrTo->baseType);
         }; break;
@@ -270,6 +490,8 @@ auto analyzer::areTypesCompatible(const SemanticType* from, const SemanticType*
         case Kind::Primitive: {
             return arePrimitivesCompatible(from, to);
         }; break;
+        // Distinct type parameters (the same one would have been caught by from == to) stand for unrelated types
+        case Kind::TypeParameter: return incompatible(Incompatibility::DifferentKinds);
         default: ASSERT_UNREACHABLE("Unknown semantic type kind in areTypesCompatible");
     }
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <core.hpp>
 #include <frontend/ast.hpp>
 #include <frontend/lexer/token_base.hpp>
@@ -7,6 +8,9 @@
 #include <frontend/semantic/type_context.hpp>
 #include <io/logging.hpp>
 #include <mnstl/number.hxx>
+#include <optional>
+#include <string>
+#include <unordered_set>
 #include <utils/result.hpp>
 #include <vector>
 
@@ -26,7 +30,7 @@ auto analyzer::visit(ast::AggregateInstantiationExpression* expression) -> exprv
         return Result::Failure;
     }
 
-    const auto* targetType = static_cast<const Aggregate*>(symbol->type);
+    const SemanticType* instantiatedType = symbol->type;
 
     if (!expression->genericTypes.empty()) {
         std::vector<const SemanticType*> resolvedGenerics;
@@ -43,9 +47,20 @@ auto analyzer::visit(ast::AggregateInstantiationExpression* expression) -> exprv
         }
         if (result == Result::Failure) { return result; }
 
-        targetType
-            = static_cast<const Aggregate*>(typeContext.getGenericInstance(targetType, std::move(resolvedGenerics)));
+        instantiatedType = _specialize(*symbol, expression->name, resolvedGenerics, expression);
+        if (!instantiatedType) { return Result::Failure; }
+    } else if (const size_t count = _typeParameterCount(*symbol); count != 0) {
+        logError(expression, "'{}' is generic, so needs {} type argument{} to be instantiated", expression->name,
+                 count, count == 1 ? "" : "s");
+        return Result::Failure;
+    }
+    if (!instantiatedType->isAggregate()) {
+        // Only an instance whose arguments still depend on type parameters isn't specialized yet
+        logError(expression, "'{}' can't be instantiated until its type arguments are known",
+                 instantiatedType->toString());
+        return Result::Failure;
     }
+    const auto* targetType = static_cast<const Aggregate*>(instantiatedType);
 
     expression->semanticType = targetType;
 
@@ -76,13 +91,13 @@ auto analyzer::visit(ast::AggregateInstantiationExpression* expression) -> exprv
         }
 
         // Check that that field can be instantiated
-        const typeCompatibilityResult compatibility = areTypesCompatible(expectedFieldType, field.value->semanticType);
+        const typeCompatibilityResult compatibility = areTypesCompatible(field.value->semanticType, expectedFieldType);
         if (!compatibility) {
             logError(field.value, "Cannot initialize field '{}' of type {} with value of type {}", field.name,
                      expectedFieldType->toString(), field.value->semanticType->toString());
             result = Result::Failure;
         } else if (compatibility.result == Compatible_t::Warning) {
-            logWarning(field.value, "{}", compatibility.message);
+            logWarning(field.value, "{}", compatibility.message());
         }
     }
 
@@ -118,10 +133,16 @@ auto analyzer::visit(ast::AggregateLiteralExpression* expression) -> exprvisit_t
 
     expression->semanticType = typeContext.getAnonymousAggregate(std::move(elementTypes));
 
-    return result;
+    return _checkFitsInMemory(expression, expression->semanticType);
 }
 
-// auto analyzer::visit(ast::ArrayLiteralExpression* expression) -> exprvisit_t;
+auto analyzer::visit(ast::AlignofExpression* expression) -> exprvisit_t {
+    return _checkLayoutQuery(expression, expression->type, "alignment");
+}
+
+auto analyzer::visit(ast::ArrayLiteralExpression* expression) -> exprvisit_t {
+    return notYetAnalyzed(expression);
+}
 
 auto analyzer::visit(ast::AssignmentExpression* expression) -> exprvisit_t {
     auto result = Result::Success;
@@ -133,13 +154,13 @@ auto analyzer::visit(ast::AssignmentExpression* expression) -> exprvisit_t {
     // TODO: Check that the LHS can actually be assigned to
 
     const typeCompatibilityResult isAssignmentValid
-        = areTypesCompatible(expression->assignee->semanticType, expression->value->semanticType);
+        = areTypesCompatible(expression->value->semanticType, expression->assignee->semanticType);
     if (!isAssignmentValid) {
         logError(expression, "Cannot assign a value of type {} to a value of type {}",
                  expression->value->semanticType->toString(), expression->assignee->semanticType->toString());
         result = Result::Failure;
     } else if (isAssignmentValid.result == Compatible_t::Warning) {
-        logWarning(expression, "{}", isAssignmentValid.message);
+        logWarning(expression, "{}", isAssignmentValid.message());
     }
     expression->semanticType = expression->assignee->semanticType;
     return result;
@@ -212,8 +233,86 @@ auto analyzer::visit(ast::CharLiteralExpression* expression) -> exprvisit_t {
     return Result::Success;
 }
 
-// auto analyzer::visit(ast::FunctionCallExpression* expression) -> exprvisit_t;
-// auto analyzer::visit(ast::GenericExpression* expression) -> exprvisit_t;
+auto analyzer::visit(ast::FunctionCallExpression* expression) -> exprvisit_t {
+    auto result = visit(expression->callee);
+    for (ast::Expression* argument : expression->arguments) {
+        if (visit(argument) == Result::Failure) { result = Result::Failure; }
+    }
+    if (result == Result::Failure) { return result; }
+    const SemanticType* calleeType = expression->callee->semanticType;
+    if (!calleeType) { return notYetAnalyzed(expression); }  // e.g. a callee named through a module
+    if (!calleeType->isFunction()) {
+        logError(expression, "'{}' has type {}, so can't be called", expression->callee->toString(),
+                 calleeType->toString());
+        return Result::Failure;
+    }
+
+    const auto* function = static_cast<const Function*>(calleeType);
+    const size_t expected = function->parameterTypes.size();
+    if (expression->arguments.size() != expected) {
+        logError(expression, "'{}' takes {} argument{}, but was given {}", expression->callee->toString(), expected,
+                 expected == 1 ? "" : "s", expression->arguments.size());
+        return Result::Failure;
+    }
+    for (size_t i = 0; i < expected; ++i) {
+        const ast::Expression* argument = expression->arguments[i];
+        const SemanticType* parameterType = function->parameterTypes[i].type;
+        if (!argument->semanticType) {
+            logError(argument, "Could not deduce type of expression {}", argument->toString());
+            result = Result::Failure;
+            continue;
+        }
+        const typeCompatibilityResult compatibility = areTypesCompatible(argument->semanticType, parameterType);
+        if (!compatibility) {
+            logError(argument, "Cannot pass a value of type {} as argument {} of '{}', which takes {}",
+                     argument->semanticType->toString(), i + 1, expression->callee->toString(),
+                     parameterType->toString());
+            result = Result::Failure;
+        } else if (compatibility.result == Compatible_t::Warning) {
+            logWarning(expression, "{}", compatibility.message());
+        }
+    }
+    expression->semanticType = function->returnType;  // nullptr for void
+    return result;
+}
+auto analyzer::visit(ast::GenericExpression* expression) -> exprvisit_t {
+    // Only generic functions named directly (e.g. `max@[int32]`) or as a member of an imported module (e.g.
+    // `lib::max@[int32]`) can be specialized so far
+    const ast::ScopeResolutionExpression* member = nullptr;
+    if (expression->identifier->kind == ast::ExpressionKind::ScopeResolutionExpression) {
+        member = static_cast<const ast::ScopeResolutionExpression*>(expression->identifier);
+        if (member->scope->kind != ast::ExpressionKind::IdentifierExpression
+            || !_findImport(static_cast<const ast::IdentifierExpression*>(member->scope)->value)) {
+            return notYetAnalyzed(expression);
+        }
+    } else if (expression->identifier->kind != ast::ExpressionKind::IdentifierExpression) {
+        return notYetAnalyzed(expression);
+    }
+    std::vector<const SemanticType*> typeArguments;
+    typeArguments.reserve(expression->types.size());
+    for (ast::Type* typeArgument : expression->types) {
+        if (visit(typeArgument) == Result::Failure || !typeArgument->semanticType) { return Result::Failure; }
+        typeArguments.push_back(typeArgument->semanticType);
+    }
+
+    if (member) {
+        // Importers specialize an exported template themselves, and get the same types as any other importer does
+        const std::string_view moduleName = static_cast<const ast::IdentifierExpression*>(member->scope)->value;
+        const std::optional<ImportedMember> imported = _findImportedMember(moduleName, member->element, expression);
+        if (!imported) { return Result::Failure; }
+        expression->semanticType = _specialize(imported->symbol.typeParameterCount, imported->type, member->element,
+                                               typeArguments, expression);
+        return expression->semanticType ? Result::Success : Result::Failure;
+    }
+    const std::string_view name = static_cast<const ast::IdentifierExpression*>(expression->identifier)->value;
+    const Symbol* symbol = symbolTable.lookup(name);
+    if (!symbol) {
+        logError(expression, "Identifier '{}' was not found in the current scope", name);
+        return Result::Failure;
+    }
+    expression->semanticType = _specialize(*symbol, name, typeArguments, expression);
+    return expression->semanticType ? Result::Success : Result::Failure;
+}
 
 auto analyzer::visit(ast::IdentifierExpression* expression) -> exprvisit_t {
     const Symbol* symbol = symbolTable.lookup(expression->value);
@@ -259,7 +358,37 @@ auto analyzer::visit(ast::IndexExpression* expression) -> exprvisit_t {
     return result;
 }
 
-// auto analyzer::visit(ast::MemberAccessExpression* expression) -> exprvisit_t;
+auto analyzer::visit(ast::MemberAccessExpression* expression) -> exprvisit_t {
+    // Enums don't have types yet, so neither do their members
+    if (expression->object->kind == ast::ExpressionKind::IdentifierExpression) {
+        const Symbol* symbol
+            = symbolTable.lookup(static_cast<const ast::IdentifierExpression*>(expression->object)->value);
+        if (symbol && symbol->kind == SymbolKind::Enum) { return notYetAnalyzed(expression); }
+    }
+    if (visit(expression->object) == Result::Failure) { return Result::Failure; }
+    const SemanticType* objectType = expression->object->semanticType;
+    if (!objectType) {
+        logError(expression->object, "Could not deduce type of expression {}", expression->object->toString());
+        return Result::Failure;
+    }
+    if (objectType->isGeneric()) {
+        const SemanticType* specialization
+            = static_cast<const GenericInstance*>(objectType)->specialization.load(std::memory_order_acquire);
+        if (specialization) { objectType = specialization; }
+    }
+    if (!objectType->isAggregate()) {
+        logError(expression, "Cannot access field '{}' of non aggregate type {}", expression->property,
+                 objectType->toString());
+        return Result::Failure;
+    }
+    const SemanticType* fieldType = static_cast<const Aggregate*>(objectType)->getFieldType(expression->property);
+    if (!fieldType) {
+        logError(expression, "Type '{}' has no field named '{}'", objectType->toString(), expression->property);
+        return Result::Failure;
+    }
+    expression->semanticType = fieldType;
+    return Result::Success;
+}
 
 auto analyzer::visit(ast::NumberLiteralExpression* expression) -> exprvisit_t {
     using held_t = mnstl::number_t::held_type;
@@ -379,7 +508,52 @@ auto analyzer::visit(ast::PrefixExpression* expression) -> exprvisit_t {
     return Result::Success;
 }
 
-// auto analyzer::visit(ast::ScopeResolutionExpression* expression) -> exprvisit_t;
+auto analyzer::visit(ast::ScopeResolutionExpression* expression) -> exprvisit_t {
+    // Only members of imported modules so far (which are resolved from the modules' interfaces)
+    if (expression->scope->kind != ast::ExpressionKind::IdentifierExpression) { return notYetAnalyzed(expression); }
+    const std::string& scopeName = static_cast<ast::IdentifierExpression*>(expression->scope)->value;
+    const ImportedModule* imported = _findImport(scopeName);
+    if (!imported) { return notYetAnalyzed(expression); }
+
+    const std::optional<ModuleInterface::Symbol> member = imported->interface->find(expression->element);
+    if (!member) {
+        logError(expression, "Module '{}' has no public member '{}'", scopeName, expression->element);
+        return Result::Failure;
+    }
+    expression->semanticType = imported->interface->resolveType(member->type, typeContext);
+    return Result::Success;
+}
+
+auto analyzer::visit(ast::SizeofExpression* expression) -> exprvisit_t {
+    return _checkLayoutQuery(expression, expression->type, "size");
+}
+
+Result analyzer::_checkLayoutQuery(ast::Expression* expression, ast::Type* type, std::string_view property) {
+    if (visit(type) == Result::Failure || !type->semanticType) { return Result::Failure; }
+    if (!layoutOf(type->semanticType)) {
+        logError(expression, "'{}' has no {} until it is specialized", type->semanticType->toString(), property);
+        return Result::Failure;
+    }
+    expression->semanticType = typeContext.getPrimitive(ast::PrimitiveType_t::u64);
+    return Result::Success;
+}
+
+Result analyzer::_checkFitsInMemory(ast::ASTNode* node, const SemanticType* type) {
+    if (layoutOf(type)) { return Result::Success; }
+    // (Anything else without a layout is missing one because a part is, e.g. a type parameter)
+    bool partsHaveLayouts = false;
+    if (type->isArray()) {
+        partsHaveLayouts = layoutOf(static_cast<const Array*>(type)->elementType).has_value();
+    } else if (type->isAggregate()) {
+        const std::vector<AggregateField>& fields = static_cast<const Aggregate*>(type)->fields;
+        partsHaveLayouts = std::ranges::all_of(fields, [](const AggregateField& field) {
+            return layoutOf(field.type).has_value();
+        });
+    }
+    if (!partsHaveLayouts) { return Result::Success; }
+    logError(node, "'{}' is too big to fit in memory (its size doesn't fit in 64 bits)", type->toString());
+    return Result::Failure;
+}
 
 auto analyzer::visit(ast::StringLiteralExpression* expression) -> exprvisit_t {
     expression->semanticType = typeContext.getPrimitive(ast::PrimitiveType_t::str);
@@ -394,7 +568,7 @@ auto analyzer::visit(ast::TypeCastExpression* expression) -> exprvisit_t {
         return Result::Failure;
     }
     if (visit(expression->targetType) == Result::Failure) { result = Result::Failure; }
-
+    expression->semanticType = expression->targetType->semanticType;
     return result;
 }
 
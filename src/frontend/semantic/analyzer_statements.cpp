@@ -2,14 +2,33 @@
 #include <frontend/ast.hpp>
 #include <frontend/semantic.hpp>
 #include <io/logging.hpp>
+#include <mnstl/enum_matches.hxx>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <utils/result.hpp>
 
 namespace Manganese {
 namespace semantic {
 
-// auto analyzer::visit(ast::AggregateDeclarationStatement* statement) -> stmtvisit_t;
+namespace {
 
-// auto analyzer::visit(ast::AliasStatement* statement) -> stmtvisit_t;
+// The same for two case values (of the same type) exactly when they are equal
+std::string caseKey(const mnstl::fold_result_t& value) {
+    if (value.is_number()) { return value.number_unchecked().to_string(); }
+    if (value.is_char()) { return std::to_string(static_cast<uint32_t>(value.character_unchecked())); }
+    return value.boolean_unchecked() ? "true" : "false";
+}
+
+}  // namespace
+
+auto analyzer::visit(ast::AggregateDeclarationStatement* statement) -> stmtvisit_t {
+    return notYetAnalyzed(statement);
+}
+
+auto analyzer::visit(ast::AliasStatement* statement) -> stmtvisit_t {
+    return notYetAnalyzed(statement);
+}
 
 auto analyzer::visit(ast::BreakStatement* statement) -> stmtvisit_t {
     if (!context.whileLoopDepth && !context.forLoopDepth && !context.switchStatementDepth) {
@@ -31,7 +50,9 @@ auto analyzer::visit(ast::EmptyStatement*) -> stmtvisit_t {
     return Result::Success;  // nothing to check
 }
 
-// auto analyzer::visit(ast::EnumDeclarationStatement* statement) -> stmtvisit_t;
+auto analyzer::visit(ast::EnumDeclarationStatement* statement) -> stmtvisit_t {
+    return notYetAnalyzed(statement);
+}
 
 auto analyzer::visit(ast::ExpressionStatement* statement) -> stmtvisit_t { return visit(statement->expression); }
 
@@ -60,7 +81,7 @@ auto analyzer::visit(ast::ForLoopStatement* statement) -> stmtvisit_t {
                          statement->stopCondition->semanticType->toString());
                 result = Result::Failure;
             } else if (conditionCanBeBool.result == Compatible_t::Warning) {
-                logWarning(statement, "{}", conditionCanBeBool.message);
+                logWarning(statement, "{}", conditionCanBeBool.message());
             }
         }
     }
@@ -72,7 +93,42 @@ auto analyzer::visit(ast::ForLoopStatement* statement) -> stmtvisit_t {
     return result;
 }
 
-// auto analyzer::visit(ast::FunctionDeclarationStatement* statement) -> stmtvisit_t;
+auto analyzer::visit(ast::FunctionDeclarationStatement* statement) -> stmtvisit_t {
+    if (!statement->genericTypes.empty()) { return notYetAnalyzed(statement); }  // Checked once specialized
+    auto result = Result::Success;
+    // The signature's types were resolved along with the other declarations' (see collectAndSpecializeGenerics())
+    const SemanticType* returnType = statement->returnType ? statement->returnType->semanticType : nullptr;
+
+    // Loops and branches outside the function don't carry into its body
+    ContextGuard inFunction(context.inFunction, true);
+    ContextGuard returns(context.currentFunctionReturnType, returnType);
+    ContextGuard ifDepth(context.ifStatementDepth, uint8_t{0});
+    ContextGuard switchDepth(context.switchStatementDepth, uint8_t{0});
+    ContextGuard forDepth(context.forLoopDepth, uint8_t{0});
+    ContextGuard whileDepth(context.whileLoopDepth, uint8_t{0});
+
+    // Parameters are declared in the body's own scope, so the body can't redeclare them
+    symbolTable.enterScope(&statement->body);
+    for (ast::FunctionParameter& parameter : statement->parameters) {
+        Result declared = symbolTable.declare(
+            parameter.name,
+            Symbol{
+                .type = parameter.type->semanticType,
+                .node = statement,
+                .kind = parameter.isMutable ? SymbolKind::Parameter : SymbolKind::ConstantParameter,
+                .isMutable = parameter.isMutable,
+            });
+        if (declared == Result::Failure) {
+            _reportRedeclaration(parameter.name, statement);
+            result = Result::Failure;
+        }
+    }
+    for (ast::Statement* bodyStatement : statement->body) {
+        if (visit(bodyStatement) == Result::Failure) { result = Result::Failure; }
+    }
+    symbolTable.exitScope();
+    return result;
+}
 
 auto analyzer::visit(ast::IfStatement* statement) -> stmtvisit_t {
     auto result = Result::Success;
@@ -94,7 +150,7 @@ auto analyzer::visit(ast::IfStatement* statement) -> stmtvisit_t {
                      statement->condition->semanticType->toString());
             result = Result::Failure;
         } else if (conditionCanBeBool.result == Compatible_t::Warning) {
-            logWarning(statement, "{}", conditionCanBeBool.message);
+            logWarning(statement, "{}", conditionCanBeBool.message());
         }
     }
 
@@ -116,7 +172,7 @@ auto analyzer::visit(ast::IfStatement* statement) -> stmtvisit_t {
                          elif.condition->semanticType->toString());
                 result = Result::Failure;
             } else if (conditionCanBeBool.result == Compatible_t::Warning) {
-                logWarning(statement, "{}", conditionCanBeBool.message);
+                logWarning(statement, "{}", conditionCanBeBool.message());
             }
         }
 
@@ -130,6 +186,8 @@ auto analyzer::visit(ast::IfStatement* statement) -> stmtvisit_t {
     return result;
 }
 
+auto analyzer::visit(ast::NestedBlockStatement* statement) -> stmtvisit_t { return visit(statement->block); }
+
 auto analyzer::visit(ast::ReturnStatement* statement) -> stmtvisit_t {
     if (!context.inFunction) {
         logError(statement, "'return' can only be used in a function");
@@ -146,7 +204,10 @@ auto analyzer::visit(ast::ReturnStatement* statement) -> stmtvisit_t {
     }
 
     if (visit(statement->value) == Result::Failure) { return Result::Failure; }
-    if (!statement->value->semanticType) { logError(statement->value, "Could not deduce type of return expression"); }
+    if (!statement->value->semanticType) {
+        logError(statement->value, "Could not deduce type of return expression");
+        return Result::Failure;
+    }
 
     if (!areTypesCompatible(statement->value->semanticType, context.currentFunctionReturnType)) {
         logError(statement, "Function returns '{}' but expression in return statement has type '{}'",
@@ -157,8 +218,70 @@ auto analyzer::visit(ast::ReturnStatement* statement) -> stmtvisit_t {
     return Result::Success;
 }
 
-// auto analyzer::visit(ast::SwitchStatement* statement) -> stmtvisit_t;
-// auto analyzer::visit(ast::VariableDeclarationStatement* statement) -> stmtvisit_t;
+auto analyzer::visit(ast::SwitchStatement* statement) -> stmtvisit_t {
+    ContextGuard guard(context.switchStatementDepth,
+                       static_cast<decltype(context.switchStatementDepth)>(context.switchStatementDepth + 1));
+    auto result = Result::Success;
+
+    if (visit(statement->variable) == Result::Failure) { return Result::Failure; }
+    const SemanticType* type = statement->variable->semanticType;
+    if (!type) {
+        logError(statement, "Could not deduce type of switch variable {}", statement->variable->toString());
+        return Result::Failure;
+    }
+    // Cases are told apart by their values, which are only exact for these
+    using enum ast::PrimitiveType_t;
+    const bool canSwitchOn = type->isPrimitive()
+        && (isInteger(type->primitiveType)
+            || mnstl::enum_matches<ast::PrimitiveType_t>(type->primitiveType, character, boolean));
+    if (!canSwitchOn) {
+        logError(statement->variable, "Can only switch on integers, characters and booleans, not {}",
+                 type->toString());
+        result = Result::Failure;
+    }
+
+    std::unordered_map<std::string, const ast::CaseClause*> seen;  // By value
+    for (ast::CaseClause& clause : statement->cases) {
+        if (visit(clause.literalValue) == Result::Failure) {
+            result = Result::Failure;
+        } else if (canSwitchOn && clause.literalValue->semanticType) {
+            const typeCompatibilityResult compatible = areTypesCompatible(clause.literalValue->semanticType, type);
+            if (!compatible) {
+                logError(clause.literalValue, "Case value {} has type {}, so can't be compared with {}",
+                         clause.literalValue->toString(), clause.literalValue->semanticType->toString(),
+                         type->toString());
+                result = Result::Failure;
+            } else {
+                if (compatible.result == Compatible_t::Warning) {
+                    logWarning(clause.literalValue, "{}", compatible.message());
+                }
+                // (The evaluator reports why, when the value can't be evaluated)
+                const std::optional<mnstl::fold_result_t> value = constEvaluator.evaluate(clause.literalValue);
+                if (value) { clause.value = ast::foldCast(*value, type->primitiveType); }
+                if (!clause.value.has_value()) {
+                    if (value) {
+                        logError(clause.literalValue, "Case value {} can't be converted to {}",
+                                 clause.literalValue->toString(), type->toString());
+                    }
+                    result = Result::Failure;
+                } else {
+                    const auto [previous, isNew] = seen.emplace(caseKey(clause.value), &clause);
+                    if (!isNew) {
+                        logError(clause.literalValue, "Case {} has the same value as case {}",
+                                 clause.literalValue->toString(), previous->second->literalValue->toString());
+                        result = Result::Failure;
+                    }
+                }
+            }
+        }
+        if (visit(clause.body) == Result::Failure) { result = Result::Failure; }
+    }
+    if (visit(statement->defaultBody) == Result::Failure) { result = Result::Failure; }
+    return result;
+}
+auto analyzer::visit(ast::VariableDeclarationStatement* statement) -> stmtvisit_t {
+    return notYetAnalyzed(statement);
+}
 
 auto analyzer::visit(ast::WhileLoopStatement* statement) -> stmtvisit_t {
     ContextGuard guard(context.whileLoopDepth,
@@ -178,7 +301,7 @@ auto analyzer::visit(ast::WhileLoopStatement* statement) -> stmtvisit_t {
             logError(statement, "While loop condition must be a boolean value or implicitly convertible to it, not {}",
                      statement->condition->semanticType->toString());
         } else if (conditionCanBeBool.result == Compatible_t::Warning) {
-            logWarning(statement, "{}", conditionCanBeBool.message);
+            logWarning(statement, "{}", conditionCanBeBool.message());
         }
     }
 
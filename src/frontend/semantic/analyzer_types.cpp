@@ -1,10 +1,25 @@
 #include <core.hpp>
+#include <cstdint>
 #include <frontend/ast.hpp>
 #include <frontend/semantic.hpp>
+#include <optional>
+#include <string_view>
+#include <utility>
 
 namespace Manganese {
 namespace semantic {
 
+namespace {
+
+// The module and member a qualified type name (e.g. `lib::Box`) refers to, if it is qualified
+std::optional<std::pair<std::string_view, std::string_view>> splitQualifiedName(std::string_view name) noexcept {
+    const size_t separator = name.rfind("::");
+    if (separator == std::string_view::npos) { return std::nullopt; }
+    return std::pair{name.substr(0, separator), name.substr(separator + 2)};
+}
+
+}  // namespace
+
 auto analyzer::visit(ast::AggregateType* type) -> typevisit_t {
     const ast::AggregateType* aggregateType = static_cast<const ast::AggregateType*>(type);
     std::vector<const SemanticType*> resolvedFields;
@@ -17,7 +32,7 @@ auto analyzer::visit(ast::AggregateType* type) -> typevisit_t {
         resolvedFields.push_back(resolvedFieldType);
     }
     type->semanticType = typeContext.getAnonymousAggregate(std::move(resolvedFields));
-    return Result::Success;
+    return _checkFitsInMemory(type, type->semanticType);
 }
 
 auto analyzer::visit(ast::ArrayType* type) -> typevisit_t {
@@ -38,17 +53,15 @@ auto analyzer::visit(ast::ArrayType* type) -> typevisit_t {
     size_t length;
     if (arrayType->lengthExpression) {
         if (visit(arrayType->lengthExpression) == Result::Failure) { return Result::Failure; }
-        mnstl::fold_result_t fold = arrayType->lengthExpression->fold();
-        if (!fold.is_number()) {
-            logError(arrayType->lengthExpression, "Array length ({}) must be a constant expression",
+        // (The evaluator reports why, when the length can't be evaluated)
+        const std::optional<mnstl::fold_result_t> value = constEvaluator.evaluate(arrayType->lengthExpression);
+        if (!value) { return Result::Failure; }
+        if (!value->is_number()) {
+            logError(arrayType->lengthExpression, "Array length ({}) must be a number",
                      arrayType->lengthExpression->toString());
             return Result::Failure;
         }
-        const mnstl::number_t lengthValue = fold.number_unchecked();
-        if (lengthValue.is_error()) {
-            logError(arrayType->lengthExpression, "{}", lengthValue.error_unchecked());
-            return Result::Failure;
-        }
+        const mnstl::number_t lengthValue = value->number_unchecked();
         if (!lengthValue.is_integer()) {
             logError(arrayType->lengthExpression, "Array length must be an integer value");
             return Result::Failure;
@@ -67,7 +80,7 @@ auto analyzer::visit(ast::ArrayType* type) -> typevisit_t {
     }
 
     type->semanticType = typeContext.getArray(elementType, length);
-    return Result::Success;
+    return _checkFitsInMemory(type, type->semanticType);
 }
 auto analyzer::visit(ast::FunctionType* type) -> typevisit_t {
     const ast::FunctionType* functionType = static_cast<const ast::FunctionType*>(type);
@@ -91,9 +104,6 @@ auto analyzer::visit(ast::FunctionType* type) -> typevisit_t {
 }
 auto analyzer::visit(ast::GenericType* type) -> typevisit_t {
     const ast::GenericType* genericType = static_cast<const ast::GenericType*>(type);
-    visit(genericType->baseType);
-    const SemanticType* baseType = genericType->baseType->semanticType;
-    if (!baseType) { return Result::Failure; }
     std::vector<const SemanticType*> resolvedTypeParameters;
     resolvedTypeParameters.reserve(genericType->typeParameters.size());
 
@@ -103,7 +113,30 @@ auto analyzer::visit(ast::GenericType* type) -> typevisit_t {
         if (!resolvedTypeParameter) { return Result::Failure; }
         resolvedTypeParameters.push_back(resolvedTypeParameter);
     }
-    type->semanticType = typeContext.getGenericInstance(baseType, std::move(resolvedTypeParameters));
+
+    // A declaration named directly (e.g. Pair@[int32], or lib::Pair@[int32] if it is imported) is specialized, rather
+    // than resolved on its own first
+    if (genericType->baseType->kind == ast::TypeKind::SymbolType) {
+        const auto* baseType = static_cast<const ast::SymbolType*>(genericType->baseType);
+        if (const auto qualified = splitQualifiedName(baseType->name)) {
+            const std::optional<ImportedMember> imported = _findImportedMember(qualified->first, qualified->second, type);
+            if (!imported) { return Result::Failure; }
+            type->semanticType = _specialize(imported->symbol.typeParameterCount, imported->type, baseType->name,
+                                             resolvedTypeParameters, type);
+            return type->semanticType ? Result::Success : Result::Failure;
+        }
+        const Symbol* symbol = baseType->primitiveType == ast::PrimitiveType_t::not_primitive
+            ? symbolTable.lookup(baseType->name)
+            : nullptr;
+        if (symbol && (symbol->kind == SymbolKind::Aggregate || symbol->kind == SymbolKind::Function)) {
+            type->semanticType = _specialize(*symbol, baseType->name, resolvedTypeParameters, type);
+            return type->semanticType ? Result::Success : Result::Failure;
+        }
+    }
+    visit(genericType->baseType);
+    const SemanticType* baseType = genericType->baseType->semanticType;
+    if (!baseType) { return Result::Failure; }
+    type->semanticType = typeContext.getGenericInstance(baseType, resolvedTypeParameters);
     return Result::Success;
 }
 auto analyzer::visit(ast::PointerType* type) -> typevisit_t {
@@ -121,7 +154,22 @@ auto analyzer::visit(ast::SymbolType* type) -> typevisit_t {
     const ast::SymbolType* symbolType = static_cast<const ast::SymbolType*>(type);
     if (symbolType->primitiveType != ast::PrimitiveType_t::not_primitive) {
         type->semanticType = typeContext.getPrimitive(symbolType->primitiveType);
-        return Result::Failure;
+        return Result::Success;
+    }
+    if (const auto qualified = splitQualifiedName(symbolType->name)) {
+        const std::optional<ImportedMember> imported = _findImportedMember(qualified->first, qualified->second, type);
+        if (!imported) { return Result::Failure; }
+        if (!imported->type) {
+            logError(type, "'{}' is not a valid type", symbolType->name);
+            return Result::Failure;
+        }
+        if (const uint32_t count = imported->symbol.typeParameterCount; count != 0) {
+            logError(type, "'{}' is generic, so needs {} type argument{} (as in {}@[...])", symbolType->name, count,
+                     count == 1 ? "" : "s", symbolType->name);
+            return Result::Failure;
+        }
+        type->semanticType = imported->type;
+        return Result::Success;
     }
     const Symbol* symbol = symbolTable.lookup(symbolType->name);
     if (!symbol) {
@@ -132,6 +180,11 @@ auto analyzer::visit(ast::SymbolType* type) -> typevisit_t {
         logError(type, "'{}' is not a valid type", symbolType->name);
         return Result::Failure;
     }
+    if (const size_t count = _typeParameterCount(*symbol); count != 0) {
+        logError(type, "'{}' is generic, so needs {} type argument{} (as in {}@[...])", symbolType->name, count,
+                 count == 1 ? "" : "s", symbolType->name);
+        return Result::Failure;
+    }
     type->semanticType = symbol->type;
     return Result::Success;
 }
@@ -0,0 +1,809 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstddef>
+#include <format>
+#include <frontend/ast.hpp>
+#include <frontend/semantic/const_eval.hpp>
+#include <frontend/semantic/symbol_table.hpp>
+#include <frontend/semantic/type_context.hpp>
+#include <io/logging.hpp>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+
+namespace semantic {
+
+namespace {
+
+template <class... Args>
+void logError(const ast::ASTNode* node, std::format_string<Args...> message, Args&&... args) noexcept {
+    logging::logError(node->getLocation(), message, std::forward<Args>(args)...);
+}
+
+const char* describe(const mnstl::fold_result_t& value) noexcept {
+    using held = enum mnstl::fold_result_t::held_type;
+    switch (value.held_type()) {
+        case held::Boolean: return "a boolean";
+        case held::Character: return "a character";
+        case held::Number: return "a number";
+        case held::String: return "a string";
+        case held::Void: return "nothing";
+    }
+    return "nothing";
+}
+
+// Appends a key for `value` that is only equal to another value's if the two are the same value of the same type
+void appendKey(std::string& key, const mnstl::fold_result_t& value) {
+    key += static_cast<char>(value.held_type());
+    if (value.is_number()) {
+        const mnstl::number_t number = value.number_unchecked();
+        key += static_cast<char>(number.underlying_type());
+        key += number.is_float() ? std::format("{:a}", number.value_as<mnstl::float64_t>()) : number.to_string();
+    } else if (value.is_bool()) {
+        key += value.boolean_unchecked() ? '1' : '0';
+    } else if (value.is_char()) {
+        key += std::to_string(static_cast<uint32_t>(value.character_unchecked()));
+    } else if (value.is_string()) {
+        key += std::to_string(value.string_unchecked().size());
+        key += ':';
+        key += value.string_unchecked();
+    }
+    key += ',';
+}
+
+}  // namespace
+
+/**
+ * @brief Compiles an expression, or a function's body, to a chunk
+ * @details Each local (parameters included) gets a register of its own for as long as it is in scope, and an
+ * expression is compiled into the register its value is wanted in, using the registers above the locals for its
+ * operands.
+ */
+class ConstEvaluator::Compiler {
+   private:
+    struct Local {
+        std::string_view name;
+        uint32_t reg;
+        ast::PrimitiveType_t type;  // What assignments to it are converted to (not_primitive if it isn't known)
+    };
+    struct Loop {
+        std::vector<size_t> breaks, continues;  // Jumps to patch once the loop's end and continue point are known
+    };
+
+    ConstEvaluator& _evaluator;
+    Chunk& _chunk;
+    // Whether the types the analyzer recorded can be read, which is only so for the expression being evaluated
+    // (another thread may be checking the functions it calls)
+    const bool _typed;
+    std::vector<Local> _locals;  // Innermost last
+    std::vector<Loop> _loops;
+    uint32_t _nextRegister = 0;
+
+    // Releases the registers allocated since it was made, once they are no longer needed
+    struct [[nodiscard]] Temporaries {
+        uint32_t& next;
+        const uint32_t mark;
+        explicit Temporaries(uint32_t& _next) noexcept : next(_next), mark(_next) {}
+        ~Temporaries() noexcept { next = mark; }
+    };
+
+    uint32_t allocate() noexcept {
+        const uint32_t reg = _nextRegister++;
+        _chunk.registerCount = std::max(_chunk.registerCount, _nextRegister);
+        return reg;
+    }
+    size_t emit(const Instruction& instruction) {
+        _chunk.code.push_back(instruction);
+        return _chunk.code.size() - 1;
+    }
+    uint32_t here() const noexcept { return static_cast<uint32_t>(_chunk.code.size()); }
+    void patch(size_t jump) noexcept { _chunk.code[jump].b = here(); }
+    uint32_t constant(mnstl::fold_result_t value) {
+        _chunk.constants.push_back(value);
+        return static_cast<uint32_t>(_chunk.constants.size() - 1);
+    }
+    uint32_t name(std::string_view value) {
+        _chunk.names.push_back(value);
+        return static_cast<uint32_t>(_chunk.names.size() - 1);
+    }
+    const Local* local(std::string_view localName) const noexcept {
+        for (auto it = _locals.rbegin(); it != _locals.rend(); ++it) {
+            if (it->name == localName) { return &*it; }
+        }
+        return nullptr;
+    }
+
+    bool unsupported(const ast::Expression* expression) const {
+        logError(expression, "'{}' can't be evaluated at compile time", expression->toString());
+        return false;
+    }
+    bool unsupported(const ast::Statement* statement) const {
+        logError(statement, "This statement can't be evaluated at compile time{}",
+                 _chunk.name.empty() ? "" : std::format(" (in '{}')", _chunk.name));
+        return false;
+    }
+
+    // Converts what was just stored in `target` to its type (e.g. after `x += 1`)
+    void convert(const Local& target, const ast::ASTNode* node) {
+        if (target.type == ast::PrimitiveType_t::not_primitive) { return; }
+        emit(Instruction{.op = Op::Cast, .primitive = target.type, .a = target.reg, .b = target.reg, .node = node});
+    }
+
+    const SemanticType* resolve(const ast::Type* type) {
+        if (_typed) { return type->semanticType; }
+        if (type->primitiveType != ast::PrimitiveType_t::not_primitive) {
+            return _evaluator._types.getPrimitive(type->primitiveType);
+        }
+        switch (type->kind) {
+            case ast::TypeKind::SymbolType: {
+                const std::string& typeName = static_cast<const ast::SymbolType*>(type)->name;
+                const Symbol* symbol = _evaluator._symbols.lookupGlobal(typeName);
+                if (!symbol || symbol->kind != SymbolKind::Aggregate || !symbol->node) { return nullptr; }
+                const auto* declaration = static_cast<const ast::AggregateDeclarationStatement*>(symbol->node);
+                return declaration->genericTypes.empty() ? symbol->type : nullptr;
+            }
+            case ast::TypeKind::PointerType: {
+                const auto* pointer = static_cast<const ast::PointerType*>(type);
+                const SemanticType* base = resolve(pointer->baseType);
+                return base ? _evaluator._types.getPointer(base, pointer->isMutable) : nullptr;
+            }
+            case ast::TypeKind::AggregateType: {
+                std::vector<const SemanticType*> fields;
+                for (const ast::Type* field : static_cast<const ast::AggregateType*>(type)->fieldTypes) {
+                    fields.push_back(resolve(field));
+                    if (!fields.back()) { return nullptr; }
+                }
+                return _evaluator._types.getAnonymousAggregate(std::move(fields));
+            }
+            default: return nullptr;
+        }
+    }
+
+    // Compile the elements of an aggregate or array into consecutive registers, then collect them into `destination`
+    bool compound(std::span<const ast::Expression* const> elements, uint32_t names, uint32_t destination,
+                  const ast::ASTNode* node) {
+        Temporaries temporaries(_nextRegister);
+        const uint32_t first = _nextRegister;
+        for (size_t i = 0; i < elements.size(); ++i) { allocate(); }
+        for (size_t i = 0; i < elements.size(); ++i) {
+            if (!expression(elements[i], first + static_cast<uint32_t>(i))) { return false; }
+        }
+        emit(Instruction{.op = Op::MakeCompound,
+                         .a = destination,
+                         .b = names,
+                         .c = first,
+                         .count = static_cast<uint32_t>(elements.size()),
+                         .node = node});
+        return true;
+    }
+
+    bool call(const ast::FunctionCallExpression* callExpression, uint32_t destination) {
+        if (callExpression->callee->kind != ast::ExpressionKind::IdentifierExpression) {
+            return unsupported(callExpression);
+        }
+        const std::string& calleeName = static_cast<const ast::IdentifierExpression*>(callExpression->callee)->value;
+        const Symbol* symbol = local(calleeName) ? nullptr : _evaluator._symbols.lookupGlobal(calleeName);
+        if (!symbol || symbol->kind != SymbolKind::Function || !symbol->node) { return unsupported(callExpression); }
+        const auto* callee = static_cast<const ast::FunctionDeclarationStatement*>(symbol->node);
+        if (!callee->genericTypes.empty()) {
+            logError(callExpression, "Generic functions (such as '{}') can't be called at compile time", calleeName);
+            return false;
+        }
+        Temporaries temporaries(_nextRegister);
+        const uint32_t first = _nextRegister;
+        for (size_t i = 0; i < callExpression->arguments.size(); ++i) { allocate(); }
+        for (size_t i = 0; i < callExpression->arguments.size(); ++i) {
+            if (!expression(callExpression->arguments[i], first + static_cast<uint32_t>(i))) { return false; }
+        }
+        _chunk.callees.push_back(callee);
+        emit(Instruction{.op = Op::Call,
+                         .a = destination,
+                         .b = static_cast<uint32_t>(_chunk.callees.size() - 1),
+                         .c = first,
+                         .count = static_cast<uint32_t>(callExpression->arguments.size()),
+                         .node = callExpression});
+        return true;
+    }
+
+    // ++x, --x, x++ and x--, whose value is the variable's before (`postfix`) or after the step
+    bool step(const ast::Expression* stepExpression, const ast::Expression* target, lexer::TokenType op,
+              bool postfix, uint32_t destination) {
+        if (target->kind != ast::ExpressionKind::IdentifierExpression) { return unsupported(stepExpression); }
+        const Local* variable = local(static_cast<const ast::IdentifierExpression*>(target)->value);
+        if (!variable) { return unsupported(stepExpression); }
+        const uint32_t one = constant(mnstl::fold_result_t{mnstl::number_t{int8_t{1}}});
+        if (postfix) { emit(Instruction{.op = Op::Move, .a = destination, .b = variable->reg, .node = target}); }
+        Temporaries temporaries(_nextRegister);
+        const uint32_t amount = allocate();
+        emit(Instruction{.op = Op::Constant, .a = amount, .b = one, .node = stepExpression});
+        emit(Instruction{.op = Op::Binary,
+                         .operation = op == lexer::TokenType::Inc ? lexer::TokenType::Plus : lexer::TokenType::Minus,
+                         .a = variable->reg,
+                         .b = variable->reg,
+                         .c = amount,
+                         .node = stepExpression});
+        convert(*variable, stepExpression);
+        if (!postfix) { emit(Instruction{.op = Op::Move, .a = destination, .b = variable->reg, .node = target}); }
+        return true;
+    }
+
+    bool assignment(const ast::AssignmentExpression* assignmentExpression, uint32_t destination) {
+        const ast::Expression* assignee = assignmentExpression->assignee;
+        if (assignee->kind != ast::ExpressionKind::IdentifierExpression) { return unsupported(assignmentExpression); }
+        const Local* variable = local(static_cast<const ast::IdentifierExpression*>(assignee)->value);
+        if (!variable) { return unsupported(assignmentExpression); }
+        Temporaries temporaries(_nextRegister);
+        const uint32_t value = allocate();
+        if (!expression(assignmentExpression->value, value)) { return false; }
+        if (assignmentExpression->op == lexer::TokenType::Assignment) {
+            emit(Instruction{.op = Op::Move, .a = variable->reg, .b = value, .node = assignmentExpression});
+        } else {
+            emit(Instruction{.op = Op::Binary,
+                             .operation = lexer::getBinaryOperatorFromAssignmentOperator(assignmentExpression->op),
+                             .a = variable->reg,
+                             .b = variable->reg,
+                             .c = value,
+                             .node = assignmentExpression});
+        }
+        convert(*variable, assignmentExpression);
+        emit(Instruction{.op = Op::Move, .a = destination, .b = variable->reg, .node = assignmentExpression});
+        return true;
+    }
+
+    bool binary(const ast::BinaryExpression* binaryExpression, uint32_t destination) {
+        using enum lexer::TokenType;
+        if (binaryExpression->op == And || binaryExpression->op == Or) {
+            // The right operand is only evaluated if the left one doesn't decide the result
+            if (!expression(binaryExpression->left, destination)) { return false; }
+            emit(Instruction{.op = Op::RequireBool, .a = destination, .node = binaryExpression->left});
+            const size_t skip = emit(Instruction{.op = binaryExpression->op == And ? Op::JumpIfFalse : Op::JumpIfTrue,
+                                                 .a = destination,
+                                                 .node = binaryExpression});
+            if (!expression(binaryExpression->right, destination)) { return false; }
+            emit(Instruction{.op = Op::RequireBool, .a = destination, .node = binaryExpression->right});
+            patch(skip);
+            return true;
+        }
+        Temporaries temporaries(_nextRegister);
+        const uint32_t left = allocate(), right = allocate();
+        if (!expression(binaryExpression->left, left) || !expression(binaryExpression->right, right)) { return false; }
+        emit(Instruction{.op = Op::Binary,
+                         .operation = binaryExpression->op,
+                         .a = destination,
+                         .b = left,
+                         .c = right,
+                         .node = binaryExpression});
+        return true;
+    }
+
+    bool layoutQuery(const ast::Expression* query, const ast::Type* type, bool size, uint32_t destination) {
+        const SemanticType* resolved = resolve(type);
+        const std::optional<Layout> layout = resolved ? layoutOf(resolved) : std::nullopt;
+        if (!layout) { return unsupported(query); }
+        const uint64_t value = size ? layout->size : layout->alignment;
+        emit(Instruction{.op = Op::Constant,
+                         .a = destination,
+                         .b = constant(mnstl::fold_result_t{mnstl::number_t{value}}),
+                         .node = query});
+        return true;
+    }
+
+    bool expression(const ast::Expression* expr, uint32_t destination) {
+        using enum ast::ExpressionKind;
+        switch (expr->kind) {
+            case NumberLiteralExpression:
+            case BoolLiteralExpression:
+            case CharLiteralExpression:
+            case StringLiteralExpression: {
+                // Read straight from the literal, rather than through fold(), which records what it finds
+                mnstl::fold_result_t value;
+                if (expr->kind == NumberLiteralExpression) {
+                    value = mnstl::fold_result_t{static_cast<const ast::NumberLiteralExpression*>(expr)->value};
+                } else if (expr->kind == BoolLiteralExpression) {
+                    value = mnstl::fold_result_t{static_cast<const ast::BoolLiteralExpression*>(expr)->value};
+                } else if (expr->kind == CharLiteralExpression) {
+                    value = mnstl::fold_result_t{static_cast<const ast::CharLiteralExpression*>(expr)->value};
+                } else {
+                    value = mnstl::fold_result_t{
+                        std::string_view{static_cast<const ast::StringLiteralExpression*>(expr)->value}};
+                }
+                emit(Instruction{.op = Op::Constant, .a = destination, .b = constant(value), .node = expr});
+                return true;
+            }
+            case IdentifierExpression: {
+                const std::string& identifier = static_cast<const ast::IdentifierExpression*>(expr)->value;
+                const Local* variable = local(identifier);
+                if (!variable) {
+                    logError(expr, "'{}' isn't known at compile time", identifier);
+                    return false;
+                }
+                emit(Instruction{.op = Op::Move, .a = destination, .b = variable->reg, .node = expr});
+                return true;
+            }
+            case BinaryExpression: return binary(static_cast<const ast::BinaryExpression*>(expr), destination);
+            case PrefixExpression: {
+                const auto* prefix = static_cast<const ast::PrefixExpression*>(expr);
+                if (prefix->op == lexer::TokenType::Inc || prefix->op == lexer::TokenType::Dec) {
+                    return step(prefix, prefix->right, prefix->op, false, destination);
+                }
+                if (prefix->op == lexer::TokenType::AddressOf || prefix->op == lexer::TokenType::Dereference) {
+                    return unsupported(expr);
+                }
+                if (!expression(prefix->right, destination)) { return false; }
+                emit(Instruction{
+                    .op = Op::Unary, .operation = prefix->op, .a = destination, .b = destination, .node = expr});
+                return true;
+            }
+            case PostfixExpression: {
+                const auto* postfix = static_cast<const ast::PostfixExpression*>(expr);
+                return step(postfix, postfix->left, postfix->op, true, destination);
+            }
+            case AssignmentExpression:
+                return assignment(static_cast<const ast::AssignmentExpression*>(expr), destination);
+            case FunctionCallExpression:
+                return call(static_cast<const ast::FunctionCallExpression*>(expr), destination);
+            case TypeCastExpression: {
+                const auto* castExpression = static_cast<const ast::TypeCastExpression*>(expr);
+                const ast::PrimitiveType_t target = castExpression->targetType->primitiveType;
+                if (target == ast::PrimitiveType_t::not_primitive) { return unsupported(expr); }
+                if (!expression(castExpression->originalValue, destination)) { return false; }
+                emit(Instruction{
+                    .op = Op::Cast, .primitive = target, .a = destination, .b = destination, .node = castExpression});
+                return true;
+            }
+            case SizeofExpression:
+                return layoutQuery(expr, static_cast<const ast::SizeofExpression*>(expr)->type, true, destination);
+            case AlignofExpression:
+                return layoutQuery(expr, static_cast<const ast::AlignofExpression*>(expr)->type, false, destination);
+            case AggregateInstantiationExpression: {
+                const auto* instantiation = static_cast<const ast::AggregateInstantiationExpression*>(expr);
+                std::vector<const ast::Expression*> values;
+                values.reserve(instantiation->fields.size());
+                const uint32_t names = static_cast<uint32_t>(_chunk.names.size());
+                for (const ast::AggregateInstantiationField& field : instantiation->fields) {
+                    values.push_back(field.value);
+                    name(field.name);
+                }
+                return compound(values, names, destination, expr);
+            }
+            case AggregateLiteralExpression: {
+                const auto& elements = static_cast<const ast::AggregateLiteralExpression*>(expr)->elements;
+                return compound({elements.data(), elements.size()}, NO_NAMES, destination, expr);
+            }
+            case ArrayLiteralExpression: {
+                const auto& elements = static_cast<const ast::ArrayLiteralExpression*>(expr)->elements;
+                return compound({elements.data(), elements.size()}, NO_NAMES, destination, expr);
+            }
+            case MemberAccessExpression: {
+                const auto* access = static_cast<const ast::MemberAccessExpression*>(expr);
+                Temporaries temporaries(_nextRegister);
+                const uint32_t object = allocate();
+                if (!expression(access->object, object)) { return false; }
+                emit(Instruction{
+                    .op = Op::GetField, .a = destination, .b = object, .c = name(access->property), .node = expr});
+                return true;
+            }
+            case IndexExpression: {
+                const auto* index = static_cast<const ast::IndexExpression*>(expr);
+                Temporaries temporaries(_nextRegister);
+                const uint32_t array = allocate(), position = allocate();
+                if (!expression(index->variable, array) || !expression(index->index, position)) { return false; }
+                emit(Instruction{.op = Op::Index, .a = destination, .b = array, .c = position, .node = expr});
+                return true;
+            }
+            default: return unsupported(expr);
+        }
+    }
+
+    bool block(const ast::Block& statements) {
+        Temporaries temporaries(_nextRegister);
+        const size_t locals = _locals.size();
+        bool result = true;
+        for (const ast::Statement* statement : statements) {
+            if (!this->statement(statement)) {
+                result = false;
+                break;
+            }
+        }
+        _locals.resize(locals);
+        return result;
+    }
+
+    // Compiles `condition` and a jump (to be patched) past whatever follows it, taken if the condition is false
+    std::optional<size_t> branchUnless(const ast::Expression* condition) {
+        Temporaries temporaries(_nextRegister);
+        const uint32_t value = allocate();
+        if (!expression(condition, value)) { return std::nullopt; }
+        return emit(Instruction{.op = Op::JumpIfFalse, .a = value, .node = condition});
+    }
+
+    bool ifStatement(const ast::IfStatement* ifStmt) {
+        std::vector<size_t> ends;
+        auto clause = [&](const ast::Expression* condition, const ast::Block& body) {
+            const std::optional<size_t> skip = branchUnless(condition);
+            if (!skip || !block(body)) { return false; }
+            ends.push_back(emit(Instruction{.op = Op::Jump, .node = condition}));
+            patch(*skip);
+            return true;
+        };
+        if (!clause(ifStmt->condition, ifStmt->body)) { return false; }
+        for (const ast::ElifClause& elif : ifStmt->elifs) {
+            if (!clause(elif.condition, elif.body)) { return false; }
+        }
+        if (!block(ifStmt->elseBody)) { return false; }
+        for (size_t end : ends) { patch(end); }
+        return true;
+    }
+
+    // The loop's body, then `next` (where `continue` goes, which jumps back to the start), then where `break` goes
+    template <class Next>
+    bool loop(const ast::Block& body, std::optional<size_t> exit, Next&& next) {
+        _loops.emplace_back();
+        const bool compiled = block(body);
+        Loop current = std::move(_loops.back());
+        _loops.pop_back();
+        if (!compiled) { return false; }
+        for (size_t jump : current.continues) { patch(jump); }
+        if (!next()) { return false; }
+        if (exit) { patch(*exit); }
+        for (size_t jump : current.breaks) { patch(jump); }
+        return true;
+    }
+
+    bool whileLoop(const ast::WhileLoopStatement* whileStmt) {
+        const uint32_t start = here();
+        std::optional<size_t> exit;
+        if (!whileStmt->isDoWhile) {
+            exit = branchUnless(whileStmt->condition);
+            if (!exit) { return false; }
+        }
+        return loop(whileStmt->body, exit, [&] {
+            if (!whileStmt->isDoWhile) {
+                emit(Instruction{.op = Op::Jump, .b = start, .node = whileStmt});
+                return true;
+            }
+            Temporaries temporaries(_nextRegister);
+            const uint32_t value = allocate();
+            if (!expression(whileStmt->condition, value)) { return false; }
+            emit(Instruction{.op = Op::JumpIfTrue, .a = value, .b = start, .node = whileStmt->condition});
+            return true;
+        });
+    }
+
+    bool forLoop(const ast::ForLoopStatement* forStmt) {
+        // The initialization's variables are only in scope in the loop
+        Temporaries temporaries(_nextRegister);
+        const size_t locals = _locals.size();
+        bool result = !forStmt->initializationStep || statement(forStmt->initializationStep);
+        if (result) {
+            const uint32_t start = here();
+            std::optional<size_t> exit;
+            if (forStmt->stopCondition) { exit = branchUnless(forStmt->stopCondition); }
+            result = (!forStmt->stopCondition || exit) && loop(forStmt->body, exit, [&] {
+                if (forStmt->postExpression) {
+                    Temporaries postTemporaries(_nextRegister);
+                    if (!expression(forStmt->postExpression, allocate())) { return false; }
+                }
+                emit(Instruction{.op = Op::Jump, .b = start, .node = forStmt});
+                return true;
+            });
+        }
+        _locals.resize(locals);
+        return result;
+    }
+
+    bool statement(const ast::Statement* stmt) {
+        using enum ast::StatementKind;
+        switch (stmt->kind) {
+            case EmptyStatement: return true;
+            case ExpressionStatement: {
+                Temporaries temporaries(_nextRegister);
+                return expression(static_cast<const ast::ExpressionStatement*>(stmt)->expression, allocate());
+            }
+            case VariableDeclarationStatement: {
+                const auto* declaration = static_cast<const ast::VariableDeclarationStatement*>(stmt);
+                if (!declaration->value) { return unsupported(stmt); }
+                // The register stays allocated (outliving any temporaries) until the enclosing block ends
+                const uint32_t reg = allocate();
+                if (!expression(declaration->value, reg)) { return false; }
+                const ast::PrimitiveType_t type =
+                    declaration->type ? declaration->type->primitiveType : ast::PrimitiveType_t::not_primitive;
+                _locals.push_back(Local{.name = declaration->name, .reg = reg, .type = type});
+                convert(_locals.back(), declaration);
+                return true;
+            }
+            case ReturnStatement: {
+                const ast::Expression* value = static_cast<const ast::ReturnStatement*>(stmt)->value;
+                if (!value) {
+                    emit(Instruction{.op = Op::Return, .node = stmt});
+                    return true;
+                }
+                Temporaries temporaries(_nextRegister);
+                const uint32_t reg = allocate();
+                if (!expression(value, reg)) { return false; }
+                emit(Instruction{.op = Op::Return, .a = reg, .b = 1, .node = stmt});
+                return true;
+            }
+            case IfStatement: return ifStatement(static_cast<const ast::IfStatement*>(stmt));
+            case WhileLoopStatement: return whileLoop(static_cast<const ast::WhileLoopStatement*>(stmt));
+            case ForLoopStatement: return forLoop(static_cast<const ast::ForLoopStatement*>(stmt));
+            case BreakStatement:
+            case ContinueStatement:
+                if (_loops.empty()) { return unsupported(stmt); }
+                (stmt->kind == BreakStatement ? _loops.back().breaks : _loops.back().continues)
+                    .push_back(emit(Instruction{.op = Op::Jump, .node = stmt}));
+                return true;
+            case NestedBlockStatement: return block(static_cast<const ast::NestedBlockStatement*>(stmt)->block);
+            default: return unsupported(stmt);
+        }
+    }
+
+   public:
+    Compiler(ConstEvaluator& evaluator, Chunk& chunk, bool typed) noexcept :
+        _evaluator(evaluator), _chunk(chunk), _typed(typed) {}
+
+    bool compileExpression(const ast::Expression* expr) {
+        _chunk.returnsValue = true;
+        const uint32_t result = allocate();
+        if (!expression(expr, result)) { return false; }
+        emit(Instruction{.op = Op::Return, .a = result, .b = 1, .node = expr});
+        return true;
+    }
+
+    bool compileFunction(const ast::FunctionDeclarationStatement* function) {
+        _chunk.name = function->name;
+        for (const ast::FunctionParameter& parameter : function->parameters) {
+            _locals.push_back(Local{.name = parameter.name, .reg = allocate(), .type = parameter.type->primitiveType});
+            _chunk.parameterTypes.push_back(parameter.type->primitiveType);
+        }
+        if (function->returnType) {
+            _chunk.returnsValue = true;
+            _chunk.returnType = function->returnType->primitiveType;
+        }
+        if (!block(function->body)) { return false; }
+        emit(Instruction{.op = Op::Return, .node = function});  // For running off the end
+        return true;
+    }
+};
+
+const ConstEvaluator::Chunk* ConstEvaluator::_compiled(const ast::FunctionDeclarationStatement* function) {
+    if (auto found = _functions.find(function); found != _functions.end()) { return found->second.get(); }
+    auto chunk = std::make_unique<Chunk>();
+    if (!Compiler(*this, *chunk, false).compileFunction(function)) { chunk.reset(); }
+    return _functions.emplace(function, std::move(chunk)).first->second.get();
+}
+
+std::optional<mnstl::fold_result_t> ConstEvaluator::evaluate(const ast::Expression* expression) {
+    _steps = 0;
+    _elements.clear();
+    _elementNames.clear();
+    Chunk chunk;
+    if (!Compiler(*this, chunk, true).compileExpression(expression)) { return std::nullopt; }
+    const std::optional<Value> value = _run(chunk);
+    if (!value) { return std::nullopt; }
+    if (value->isCompound) {
+        logError(expression, "'{}' is an aggregate or array, where a single value is needed", expression->toString());
+        return std::nullopt;
+    }
+    return value->scalar;
+}
+
+std::optional<ConstEvaluator::Value> ConstEvaluator::_run(const Chunk& entry) {
+    struct Frame {
+        const Chunk* chunk = nullptr;
+        size_t pc = 0;
+        size_t base = 0;  // Where its registers start
+        size_t result = 0;  // The caller's register its result goes in
+        std::string key = {};  // What its result is remembered under (empty if it isn't)
+    };
+    std::vector<Value> registers(entry.registerCount);
+    std::vector<Frame> frames;
+    frames.push_back(Frame{.chunk = &entry});
+    std::vector<Value> arguments;
+
+    // An operator's result, or nothing (having reported it) if the operator doesn't apply
+    auto checked = [](const mnstl::fold_result_t& result, const Instruction& instruction,
+                      std::string_view operands) -> bool {
+        if (!result.has_value()) {
+            logError(instruction.node, "Can't apply '{}' to {} at compile time",
+                     lexer::tokenTypeToString(instruction.operation), operands);
+            return false;
+        }
+        if (result.is_number() && result.number_unchecked().is_error()) {
+            logError(instruction.node, "{}", result.number_unchecked().error_unchecked());
+            return false;
+        }
+        return true;
+    };
+    auto scalar = [](const Value& value, const Instruction& instruction) -> bool {
+        if (value.isCompound) {
+            logError(instruction.node, "Expected a single value at compile time, but got an aggregate or array");
+        }
+        return !value.isCompound;
+    };
+    auto condition = [&](const Value& value, const Instruction& instruction) -> std::optional<bool> {
+        if (!scalar(value, instruction)) { return std::nullopt; }
+        if (!value.scalar.is_bool()) {
+            logError(instruction.node, "Expected a boolean, but got {}", describe(value.scalar));
+            return std::nullopt;
+        }
+        return value.scalar.boolean_unchecked();
+    };
+    auto convert = [](Value& value, ast::PrimitiveType_t type, const Instruction& instruction) -> bool {
+        if (type == ast::PrimitiveType_t::not_primitive || value.isCompound) { return true; }
+        const mnstl::fold_result_t converted = ast::foldCast(value.scalar, type);
+        if (!converted.has_value()) {
+            logError(instruction.node, "Can't convert {} to {} at compile time", describe(value.scalar),
+                     ast::primitiveTypeToString(type));
+            return false;
+        }
+        value.scalar = converted;
+        return true;
+    };
+
+    while (true) {
+        Frame& frame = frames.back();
+        const Instruction& instruction = frame.chunk->code[frame.pc++];
+        if (++_steps > _stepBudget) [[unlikely]] {
+            logError(instruction.node,
+                     "Evaluating this at compile time took over {} steps, so was stopped (is there an infinite loop?)",
+                     _stepBudget);
+            return std::nullopt;
+        }
+        Value* r = registers.data() + frame.base;
+        switch (instruction.op) {
+            case Op::Constant: r[instruction.a] = Value{.scalar = frame.chunk->constants[instruction.b]}; break;
+            case Op::Move: r[instruction.a] = r[instruction.b]; break;
+            case Op::Unary: {
+                const Value& operand = r[instruction.b];
+                if (!scalar(operand, instruction)) { return std::nullopt; }
+                const mnstl::fold_result_t result = ast::foldPrefixOperator(instruction.operation, operand.scalar);
+                if (!checked(result, instruction, describe(operand.scalar))) { return std::nullopt; }
+                r[instruction.a] = Value{.scalar = result};
+                break;
+            }
+            case Op::Binary: {
+                const Value &left = r[instruction.b], &right = r[instruction.c];
+                if (!scalar(left, instruction) || !scalar(right, instruction)) { return std::nullopt; }
+                const mnstl::fold_result_t result =
+                    ast::foldBinaryOperator(instruction.operation, left.scalar, right.scalar);
+                if (!checked(result, instruction,
+                             std::format("{} and {}", describe(left.scalar), describe(right.scalar)))) {
+                    return std::nullopt;
+                }
+                r[instruction.a] = Value{.scalar = result};
+                break;
+            }
+            case Op::RequireBool:
+                if (!condition(r[instruction.a], instruction)) { return std::nullopt; }
+                break;
+            case Op::Cast: {
+                Value value = r[instruction.b];
+                if (!scalar(value, instruction) || !convert(value, instruction.primitive, instruction)) {
+                    return std::nullopt;
+                }
+                r[instruction.a] = value;
+                break;
+            }
+            case Op::Jump: frame.pc = instruction.b; break;
+            case Op::JumpIfFalse:
+            case Op::JumpIfTrue: {
+                const std::optional<bool> value = condition(r[instruction.a], instruction);
+                if (!value) { return std::nullopt; }
+                if (*value == (instruction.op == Op::JumpIfTrue)) { frame.pc = instruction.b; }
+                break;
+            }
+            case Op::Call: {
+                const ast::FunctionDeclarationStatement* callee = frame.chunk->callees[instruction.b];
+                const Chunk* chunk = _compiled(callee);
+                if (!chunk) {
+                    logError(instruction.node, "'{}' can't be called at compile time", callee->name);
+                    return std::nullopt;
+                }
+                if (chunk->parameterTypes.size() != instruction.count) {
+                    logError(instruction.node, "'{}' takes {} arguments, but was given {}", callee->name,
+                             chunk->parameterTypes.size(), instruction.count);
+                    return std::nullopt;
+                }
+                // Calls taking (and returning) scalars are remembered, by the callee and the converted arguments
+                std::string key(reinterpret_cast<const char*>(&callee), sizeof(callee));
+                arguments.assign(r + instruction.c, r + instruction.c + instruction.count);
+                for (size_t i = 0; i < arguments.size(); ++i) {
+                    if (!convert(arguments[i], chunk->parameterTypes[i], instruction)) { return std::nullopt; }
+                    if (arguments[i].isCompound) {
+                        key.clear();
+                    } else if (!key.empty()) {
+                        appendKey(key, arguments[i].scalar);
+                    }
+                }
+                if (auto found = _results.find(key); !key.empty() && found != _results.end()) {
+                    r[instruction.a] = Value{.scalar = found->second};
+                    break;
+                }
+                if (frames.size() >= MAX_CALL_DEPTH) {
+                    logError(instruction.node, "Evaluating this at compile time needs calls over {} deep",
+                             MAX_CALL_DEPTH);
+                    return std::nullopt;
+                }
+                const size_t base = registers.size();
+                const size_t result = frame.base + instruction.a;
+                registers.resize(base + chunk->registerCount);  // (Invalidates r and frame)
+                std::copy(arguments.begin(), arguments.end(), registers.begin() + static_cast<ptrdiff_t>(base));
+                frames.push_back(Frame{.chunk = chunk, .base = base, .result = result, .key = std::move(key)});
+                break;
+            }
+            case Op::Return: {
+                Value result = instruction.b ? r[instruction.a] : Value{};
+                if (frame.chunk->returnsValue && !instruction.b) {
+                    logError(instruction.node, "'{}' finished without returning a value", frame.chunk->name);
+                    return std::nullopt;
+                }
+                if (instruction.b && !convert(result, frame.chunk->returnType, instruction)) { return std::nullopt; }
+                if (frames.size() == 1) { return result; }
+                if (!frame.key.empty() && !result.isCompound) { _results.emplace(std::move(frame.key), result.scalar); }
+                const size_t destination = frame.result, base = frame.base;
+                frames.pop_back();
+                registers.resize(base);
+                registers[destination] = result;
+                break;
+            }
+            case Op::MakeCompound: {
+                const Value value{.first = static_cast<uint32_t>(_elements.size()),
+                                  .count = instruction.count,
+                                  .isCompound = true};
+                for (uint32_t i = 0; i < instruction.count; ++i) {
+                    _elements.push_back(r[instruction.c + i]);
+                    _elementNames.push_back(instruction.b == NO_NAMES ? std::string_view{}
+                                                                      : frame.chunk->names[instruction.b + i]);
+                }
+                r[instruction.a] = value;
+                break;
+            }
+            case Op::GetField: {
+                const Value object = r[instruction.b];
+                const std::string_view field = frame.chunk->names[instruction.c];
+                if (!object.isCompound) {
+                    logError(instruction.node, "Can't access field '{}' of {}", field, describe(object.scalar));
+                    return std::nullopt;
+                }
+                const auto names = std::span(_elementNames).subspan(object.first, object.count);
+                const auto found = std::find(names.begin(), names.end(), field);
+                if (found == names.end()) {
+                    logError(instruction.node, "This value has no field named '{}' at compile time", field);
+                    return std::nullopt;
+                }
+                r[instruction.a] = _elements[object.first + static_cast<size_t>(found - names.begin())];
+                break;
+            }
+            case Op::Index: {
+                const Value array = r[instruction.b], index = r[instruction.c];
+                if (!array.isCompound) {
+                    logError(instruction.node, "Can't index into {}", describe(array.scalar));
+                    return std::nullopt;
+                }
+                if (!index.scalar.is_number() || !index.scalar.number_unchecked().is_integer()) {
+                    logError(instruction.node, "An index must be an integer (got {})", describe(index.scalar));
+                    return std::nullopt;
+                }
+                const mnstl::number_t position = index.scalar.number_unchecked();
+                if (position < 0 || !(position < mnstl::number_t{uint64_t{array.count}})) {
+                    logError(instruction.node, "Index {} is out of bounds for a length of {}", position.to_string(),
+                             array.count);
+                    return std::nullopt;
+                }
+                r[instruction.a] = _elements[array.first + position.value_as<size_t>()];
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace semantic
+
+}  // namespace Manganese
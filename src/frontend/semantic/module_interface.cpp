@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <frontend/lexer.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace semantic {
+
+namespace {
+constexpr uint32_t MAGIC = 0x494D4E4D;  // "MNMI" in the little-endian byte order
+constexpr size_t HEADER_SIZE = 48;
+constexpr size_t SYMBOL_SIZE = 16;
+// Offsets of the header fields (each a word, except the hash and the name, which are pairs of words)
+constexpr size_t VERSION_FIELD = 4, NAME_FIELD = 16, TYPE_COUNT_FIELD = 24, TYPE_TABLE_FIELD = 28,
+                 SYMBOL_COUNT_FIELD = 32, SYMBOLS_FIELD = 36, STRINGS_FIELD = 40, STRINGS_SIZE_FIELD = 44;
+
+constexpr uint32_t recordHead(Kind kind, ast::PrimitiveType_t primitive = ast::PrimitiveType_t::not_primitive,
+                              bool flag = false) noexcept {
+    return static_cast<uint32_t>(kind) | (static_cast<uint32_t>(primitive) << 8) | (uint32_t{flag} << 16);
+}
+
+/**
+ * @brief Builds the sections of an interface, then lays them out in one buffer
+ * @details The names are placed straight after the header, so their offsets are known as soon as they are added.
+ * Types are added children first, so a record's references always point to earlier entries in the table.
+ */
+class Encoder {
+   private:
+    std::string strings;
+    std::unordered_map<std::string_view, uint32_t> stringOffsets;  // Keys view the strings passed to addString()
+    std::vector<uint32_t> records;  // Every type record, back to back
+    std::vector<uint32_t> recordStarts;  // The word each record starts at, by type index
+    std::unordered_map<const SemanticType*, uint32_t> typeIndices;
+
+   public:
+    std::pair<uint32_t, uint32_t> addString(std::string_view s) {
+        auto [it, inserted] = stringOffsets.try_emplace(s, static_cast<uint32_t>(HEADER_SIZE + strings.size()));
+        if (inserted) { strings.append(s); }
+        return {it->second, static_cast<uint32_t>(s.size())};
+    }
+
+    uint32_t addType(const SemanticType* type) {
+        if (!type) { return ModuleInterface::NO_TYPE; }
+        if (auto it = typeIndices.find(type); it != typeIndices.end()) { return it->second; }
+
+        std::vector<uint32_t> record;
+        switch (type->kind) {
+            case Kind::Primitive: record = {recordHead(Kind::Primitive, type->primitiveType)}; break;
+            case Kind::Pointer: {
+                const auto* pointer = static_cast<const Pointer*>(type);
+                record = {recordHead(Kind::Pointer, ast::PrimitiveType_t::not_primitive, pointer->isMutable),
+                          addType(pointer->baseType)};
+                break;
+            }
+            case Kind::Array: {
+                const auto* array = static_cast<const Array*>(type);
+                const uint64_t length = array->length;
+                record = {recordHead(Kind::Array), addType(array->elementType), static_cast<uint32_t>(length),
+                          static_cast<uint32_t>(length >> 32)};
+                break;
+            }
+            case Kind::Function: {
+                const auto* function = static_cast<const Function*>(type);
+                record = {recordHead(Kind::Function), addType(function->returnType),
+                          static_cast<uint32_t>(function->parameterTypes.size())};
+                for (const Parameter& parameter : function->parameterTypes) {
+                    record.push_back(addType(parameter.type));
+                    record.push_back(parameter.isMutable);
+                }
+                break;
+            }
+            case Kind::Aggregate: {
+                const auto* aggregate = static_cast<const Aggregate*>(type);
+                const auto [nameOffset, nameLength] = addString(aggregate->name);
+                record = {recordHead(Kind::Aggregate), nameOffset, nameLength,
+                          static_cast<uint32_t>(aggregate->fields.size())};
+                for (const AggregateField& field : aggregate->fields) {
+                    const auto [fieldOffset, fieldLength] = addString(field.name);
+                    record.insert(record.end(), {fieldOffset, fieldLength, addType(field.type)});
+                }
+                break;
+            }
+            case Kind::Generic: {
+                const auto* generic = static_cast<const GenericInstance*>(type);
+                record = {recordHead(Kind::Generic), addType(generic->baseType),
+                          static_cast<uint32_t>(generic->typeArguments.size())};
+                for (const SemanticType* argument : generic->typeArguments) { record.push_back(addType(argument)); }
+                break;
+            }
+            case Kind::TypeParameter: {
+                // So that importers get exported generic declarations as templates, which they specialize themselves
+                const auto* parameter = static_cast<const TypeParameter*>(type);
+                const auto [nameOffset, nameLength] = addString(parameter->name);
+                record = {recordHead(Kind::TypeParameter), nameOffset, nameLength, parameter->index};
+                break;
+            }
+        }
+        const uint32_t index = static_cast<uint32_t>(recordStarts.size());
+        recordStarts.push_back(static_cast<uint32_t>(records.size()));
+        records.insert(records.end(), record.begin(), record.end());
+        typeIndices.emplace(type, index);
+        return index;
+    }
+
+    std::vector<char> finish(std::pair<uint32_t, uint32_t> moduleName, uint64_t contentHash,
+                             const std::vector<uint32_t>& symbolWords) const {
+        const size_t typeTable = (HEADER_SIZE + strings.size() + 3) & ~size_t{3};
+        const size_t recordsStart = typeTable + 4 * recordStarts.size();
+        const size_t symbols = recordsStart + 4 * records.size();
+        std::vector<char> buffer(symbols + 4 * symbolWords.size(), '\0');
+
+        auto put = [&](size_t offset, uint32_t value) { std::memcpy(buffer.data() + offset, &value, sizeof(value)); };
+        put(0, MAGIC);
+        put(VERSION_FIELD, ModuleInterface::VERSION);
+        put(8, static_cast<uint32_t>(contentHash));
+        put(12, static_cast<uint32_t>(contentHash >> 32));
+        put(NAME_FIELD, moduleName.first);
+        put(NAME_FIELD + 4, moduleName.second);
+        put(TYPE_COUNT_FIELD, static_cast<uint32_t>(recordStarts.size()));
+        put(TYPE_TABLE_FIELD, static_cast<uint32_t>(typeTable));
+        put(SYMBOL_COUNT_FIELD, static_cast<uint32_t>(symbolWords.size() * 4 / SYMBOL_SIZE));
+        put(SYMBOLS_FIELD, static_cast<uint32_t>(symbols));
+        put(STRINGS_FIELD, static_cast<uint32_t>(HEADER_SIZE));
+        put(STRINGS_SIZE_FIELD, static_cast<uint32_t>(strings.size()));
+
+        std::memcpy(buffer.data() + HEADER_SIZE, strings.data(), strings.size());
+        for (size_t i = 0; i < recordStarts.size(); ++i) {
+            put(typeTable + 4 * i, static_cast<uint32_t>(recordsStart + 4 * recordStarts[i]));
+        }
+        for (size_t i = 0; i < records.size(); ++i) { put(recordsStart + 4 * i, records[i]); }
+        for (size_t i = 0; i < symbolWords.size(); ++i) { put(symbols + 4 * i, symbolWords[i]); }
+        return buffer;
+    }
+};
+}  // namespace
+
+std::vector<char> ModuleInterface::encode(std::string_view moduleName, uint64_t contentHash,
+                                          std::span<const ExportedSymbol> exports) {
+    std::vector<const ExportedSymbol*> sorted;
+    sorted.reserve(exports.size());
+    for (const ExportedSymbol& symbol : exports) { sorted.push_back(&symbol); }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const ExportedSymbol* a, const ExportedSymbol* b) { return a->name < b->name; });
+
+    Encoder encoder;
+    const auto name = encoder.addString(moduleName);
+    std::vector<uint32_t> symbolWords;
+    symbolWords.reserve(sorted.size() * SYMBOL_SIZE / 4);
+    for (const ExportedSymbol* symbol : sorted) {
+        const auto [nameOffset, nameLength] = encoder.addString(symbol->name);
+        const uint32_t type = encoder.addType(symbol->type);
+        const uint32_t flags = static_cast<uint32_t>(symbol->kind) | (uint32_t{symbol->isMutable} << 8)
+            | (symbol->typeParameterCount << 16);
+        symbolWords.insert(symbolWords.end(), {nameOffset, nameLength, type, flags});
+    }
+    return encoder.finish(name, contentHash, symbolWords);
+}
+
+bool ModuleInterface::validate() noexcept {
+    // Whether [offset, offset + length) lies inside the buffer (computed in 64 bits, so it can't overflow)
+    auto inBounds = [&](uint64_t offset, uint64_t length) {
+        return offset <= bytes.size() && length <= bytes.size() - offset;
+    };
+    auto validString = [&](size_t field) { return inBounds(word(field), word(field + 4)); };
+
+    if (bytes.size() < HEADER_SIZE || word(0) != MAGIC || word(VERSION_FIELD) != VERSION) { return false; }
+    if (!validString(NAME_FIELD) || !inBounds(word(STRINGS_FIELD), word(STRINGS_SIZE_FIELD))) { return false; }
+    typeCount = word(TYPE_COUNT_FIELD);
+    typeTable = word(TYPE_TABLE_FIELD);
+    symbolCount = word(SYMBOL_COUNT_FIELD);
+    symbols = word(SYMBOLS_FIELD);
+    if (!inBounds(typeTable, uint64_t{typeCount} * 4) || !inBounds(symbols, uint64_t{symbolCount} * SYMBOL_SIZE)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < typeCount; ++i) {
+        const uint64_t start = word(typeTable + 4 * size_t{i});
+        // A reference to an earlier type (or, where allowed, to no type)
+        auto earlier = [&](uint32_t reference, bool allowNone = false) {
+            return reference < i || (allowNone && reference == NO_TYPE);
+        };
+        if (!inBounds(start, 4)) { return false; }
+        const uint32_t head = word(start);
+        const auto kind = static_cast<Kind>(head & 0xFF);
+        // The words of the record after its head, which must all be in bounds
+        auto hasWords = [&](uint64_t count) { return inBounds(start + 4, count * 4); };
+        auto at = [&](size_t index) { return word(start + 4 + 4 * index); };
+        switch (kind) {
+            case Kind::Primitive:
+                if (((head >> 8) & 0xFF) > static_cast<uint32_t>(ast::PrimitiveType_t::boolean)) { return false; }
+                break;
+            case Kind::Pointer:
+                if (!hasWords(1) || !earlier(at(0), true)) { return false; }
+                break;
+            case Kind::Array:
+                if (!hasWords(3) || !earlier(at(0), true)) { return false; }
+                break;
+            case Kind::Function: {
+                if (!hasWords(2) || !earlier(at(0), true) || !hasWords(2 + uint64_t{at(1)} * 2)) { return false; }
+                for (size_t p = 0; p < at(1); ++p) {
+                    if (!earlier(at(2 + 2 * p), true)) { return false; }
+                }
+                break;
+            }
+            case Kind::Aggregate: {
+                if (!hasWords(3) || !validString(start + 4) || !hasWords(3 + uint64_t{at(2)} * 3)) { return false; }
+                for (size_t f = 0; f < at(2); ++f) {
+                    if (!validString(start + 4 + 4 * (3 + 3 * f)) || !earlier(at(5 + 3 * f), true)) { return false; }
+                }
+                break;
+            }
+            case Kind::Generic: {
+                if (!hasWords(2) || !earlier(at(0), true) || !hasWords(2 + uint64_t{at(1)})) { return false; }
+                for (size_t a = 0; a < at(1); ++a) {
+                    if (!earlier(at(2 + a), true)) { return false; }
+                }
+                break;
+            }
+            case Kind::TypeParameter:
+                if (!hasWords(3) || !validString(start + 4)) { return false; }
+                break;
+            default: return false;
+        }
+    }
+
+    std::string_view previous;
+    for (uint32_t i = 0; i < symbolCount; ++i) {
+        const size_t start = symbols + SYMBOL_SIZE * size_t{i};
+        if (!validString(start)) { return false; }
+        const uint32_t type = word(start + 8), flags = word(start + 12);
+        if ((type >= typeCount && type != NO_TYPE) || (flags & 0xFF) >= static_cast<uint32_t>(SymbolKind::Invalid)) {
+            return false;
+        }
+        const std::string_view name = string(start);
+        if (i > 0 && !(previous < name)) { return false; }  // Sorted, and so also without duplicates
+        previous = name;
+    }
+    return true;
+}
+
+std::optional<ModuleInterface> ModuleInterface::load(ModuleInterface interface) {
+    if (!interface.validate()) { return std::nullopt; }
+    return interface;
+}
+
+std::optional<ModuleInterface> ModuleInterface::fromBytes(std::vector<char> encoded) {
+    ModuleInterface interface;
+    interface.ownedBytes = std::move(encoded);
+    interface.bytes = std::string_view(interface.ownedBytes.data(), interface.ownedBytes.size());
+    return load(std::move(interface));
+}
+
+std::optional<ModuleInterface> ModuleInterface::open(const std::string& path) {
+    if (!io::MappedFileReader::isMappable(path)) { return std::nullopt; }
+    ModuleInterface interface;
+    try {
+        interface.mapping = std::make_unique<io::MappedFileReader>(path);
+    } catch (const std::runtime_error&) { return std::nullopt; }
+    interface.bytes = interface.mapping->view();
+    return load(std::move(interface));
+}
+
+ModuleInterface::Symbol ModuleInterface::symbolAt(size_t index) const noexcept {
+    const size_t start = symbols + SYMBOL_SIZE * index;
+    const uint32_t flags = word(start + 12);
+    return Symbol{.name = string(start),
+                  .kind = static_cast<SymbolKind>(flags & 0xFF),
+                  .isMutable = ((flags >> 8) & 1) != 0,
+                  .type = word(start + 8),
+                  .typeParameterCount = flags >> 16};
+}
+
+std::optional<ModuleInterface::Symbol> ModuleInterface::find(std::string_view name) const noexcept {
+    size_t low = 0, high = symbolCount;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const std::string_view candidate = string(symbols + SYMBOL_SIZE * middle);
+        if (candidate == name) { return symbolAt(middle); }
+        if (candidate < name) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return std::nullopt;
+}
+
+const SemanticType* ModuleInterface::resolveType(uint32_t type, TypeContext& context) const {
+    if (type == NO_TYPE) { return nullptr; }
+    const size_t start = word(typeTable + 4 * size_t{type});
+    const uint32_t head = word(start);
+    auto at = [&](size_t index) { return word(start + 4 + 4 * index); };
+    switch (static_cast<Kind>(head & 0xFF)) {
+        case Kind::Primitive: return context.getPrimitive(static_cast<ast::PrimitiveType_t>((head >> 8) & 0xFF));
+        case Kind::Pointer: return context.getPointer(resolveType(at(0), context), ((head >> 16) & 1) != 0);
+        case Kind::Array:
+            return context.getArray(resolveType(at(0), context), at(1) | (static_cast<uint64_t>(at(2)) << 32));
+        case Kind::Function: {
+            std::vector<Parameter> parameters;
+            parameters.reserve(at(1));
+            for (size_t p = 0; p < at(1); ++p) {
+                parameters.push_back(
+                    Parameter{.isMutable = at(3 + 2 * p) != 0, .type = resolveType(at(2 + 2 * p), context)});
+            }
+            return context.getFunction(std::move(parameters), resolveType(at(0), context));
+        }
+        case Kind::Aggregate: {
+            const std::string_view name = string(start + 4);
+            // Field names outlive this interface in the identifier pool, as the types they belong to must
+            std::vector<AggregateField> fields;
+            fields.reserve(at(2));
+            for (size_t f = 0; f < at(2); ++f) {
+                mnstl::string_pool& pool = lexer::identifierPool();
+                const std::string_view fieldName = pool.view(pool.intern(string(start + 4 + 4 * (3 + 3 * f))));
+                fields.push_back(AggregateField{.name = fieldName, .type = resolveType(at(5 + 3 * f), context)});
+            }
+            if (!name.empty()) { return context.getNamedAggregate(name, std::move(fields)); }
+            std::vector<const SemanticType*> fieldTypes;
+            fieldTypes.reserve(fields.size());
+            for (const AggregateField& field : fields) { fieldTypes.push_back(field.type); }
+            return context.getAnonymousAggregate(std::move(fieldTypes));
+        }
+        case Kind::Generic: {
+            std::vector<const SemanticType*> arguments;
+            arguments.reserve(at(1));
+            for (size_t a = 0; a < at(1); ++a) { arguments.push_back(resolveType(at(2 + a), context)); }
+            return context.getGenericInstance(resolveType(at(0), context), arguments);
+        }
+        case Kind::TypeParameter: {
+            mnstl::string_pool& pool = lexer::identifierPool();
+            return context.getTypeParameter(pool.view(pool.intern(string(start + 4))), at(2));
+        }
+    }
+    ASSERT_UNREACHABLE("Invalid type in a validated module interface");
+}
+
+}  // namespace semantic
+}  // namespace Manganese
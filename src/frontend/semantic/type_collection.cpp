@@ -1,8 +1,13 @@
+#include <algorithm>
 #include <core.hpp>
 #include <frontend/ast.hpp>
 #include <frontend/semantic.hpp>
 #include <io/logging.hpp>
+#include <optional>
+#include <span>
 #include <string_view>
+#include <utils/time_report.hpp>
+#include <vector>
 
 namespace Manganese {
 
@@ -12,6 +17,7 @@ namespace semantic {
 // Types are set later on
 
 Result analyzer::collectTypes() {
+    timing::PhaseTimer timer(timing::Phase::CollectTypes, &arena);
     // first pass -- collect all user-defined types
     Result result = Result::Success;
     for (ast::Statement* stmt : parsedFile.program) {
@@ -21,7 +27,7 @@ Result analyzer::collectTypes() {
 }
 
 void analyzer::_reportRedeclaration(std::string_view redeclaredSymbolName, ast::ASTNode* node) const {
-    logging::logError(node->getLine(), node->getColumn(), "'{}' was already declared in this scope",
+    logging::logError(node->getLocation(), "'{}' was already declared in this scope",
                       redeclaredSymbolName);
 }
 
@@ -111,7 +117,7 @@ Result analyzer::_collectTypesInStatement(ast::Statement* stmt) {
 }
 
 Result analyzer::_collectTypesInStatementBody(const ast::Block& body) {
-    symbolTable.enterScope();
+    symbolTable.enterScope(&body);
     Result result = Result::Success;
 
     for (ast::Statement* subStatement : body) {
@@ -122,6 +128,154 @@ Result analyzer::_collectTypesInStatementBody(const ast::Block& body) {
     return result;
 }
 
+Result analyzer::collectAndSpecializeGenerics() {
+    // Give each top-level aggregate and function its type (for a generic declaration, the type its specializations are
+    // made from). This goes in source order, so a declaration can use the aggregates (and, in an array length, the
+    // functions) declared before it
+    Result result = Result::Success;
+    for (ast::Statement* stmt : parsedFile.program) {
+        if (stmt->kind == ast::StatementKind::AggregateDeclarationStatement) {
+            if (_resolveAggregate(static_cast<ast::AggregateDeclarationStatement*>(stmt)) == Result::Failure) {
+                result = Result::Failure;
+            }
+        } else if (stmt->kind == ast::StatementKind::FunctionDeclarationStatement) {
+            if (_resolveSignature(static_cast<ast::FunctionDeclarationStatement*>(stmt)) == Result::Failure) {
+                result = Result::Failure;
+            }
+        }
+    }
+    return result;
+}
+
+Result analyzer::_declareTypeParameters(const std::vector<std::string>& names, ast::ASTNode* owner) {
+    Result result = Result::Success;
+    mnstl::string_pool& pool = lexer::identifierPool();
+    for (size_t i = 0; i < names.size(); ++i) {
+        // The parameter's name outlives the AST in the identifier pool, as the types mentioning it may
+        const mnstl::string_pool::atom_t name = pool.intern(names[i]);
+        Result declared = symbolTable.declare(name, Symbol{
+                                                         .type = typeContext.getTypeParameter(pool.view(name),
+                                                                                              static_cast<uint32_t>(i)),
+                                                         .node = owner,
+                                                         .kind = SymbolKind::GenericType,
+                                                         .isMutable = false,
+                                                     });
+        if (declared == Result::Failure) {
+            _reportRedeclaration(names[i], owner);
+            result = Result::Failure;
+        }
+    }
+    return result;
+}
+
+Result analyzer::_resolveAggregate(ast::AggregateDeclarationStatement* aggregateStmt) {
+    // A generic aggregate's parameters are only visible to its fields, in a scope of its own
+    const bool isGeneric = !aggregateStmt->genericTypes.empty();
+    if (isGeneric) { symbolTable.enterScope(aggregateStmt); }
+    Result result = isGeneric ? _declareTypeParameters(aggregateStmt->genericTypes, aggregateStmt) : Result::Success;
+    std::vector<AggregateField> fields;
+    fields.reserve(aggregateStmt->fields.size());
+    mnstl::string_pool& pool = lexer::identifierPool();
+    for (const ast::AggregateField& field : aggregateStmt->fields) {
+        if (visit(field.type) == Result::Failure || !field.type->semanticType) {
+            result = Result::Failure;
+            continue;
+        }
+        fields.push_back(AggregateField{.name = pool.view(pool.intern(field.name)), .type = field.type->semanticType});
+    }
+    if (isGeneric) { symbolTable.exitScope(); }
+    if (result == Result::Failure) { return result; }
+    // (A redeclaration, already reported, doesn't get to replace the type of what it redeclares)
+    const mnstl::string_pool::atom_t name = pool.intern(aggregateStmt->name);
+    if (const Symbol* symbol = symbolTable.lookup(name); symbol && symbol->node == aggregateStmt) {
+        const SemanticType* aggregate = typeContext.getNamedAggregate(aggregateStmt->name, std::move(fields));
+        symbolTable.setGlobalType(name, aggregate);
+        return _checkFitsInMemory(aggregateStmt, aggregate);
+    }
+    return Result::Success;
+}
+
+Result analyzer::_resolveSignature(ast::FunctionDeclarationStatement* funcStmt) {
+    // Type parameters are visible throughout the function, so they go in its body's scope
+    const bool isGeneric = !funcStmt->genericTypes.empty();
+    if (isGeneric) { symbolTable.enterScope(&funcStmt->body); }
+    Result result = isGeneric ? _declareTypeParameters(funcStmt->genericTypes, funcStmt) : Result::Success;
+    std::vector<Parameter> parameters;
+    parameters.reserve(funcStmt->parameters.size());
+    for (const ast::FunctionParameter& parameter : funcStmt->parameters) {
+        if (visit(parameter.type) == Result::Failure || !parameter.type->semanticType) {
+            result = Result::Failure;
+            continue;
+        }
+        parameters.push_back(Parameter{.isMutable = parameter.isMutable, .type = parameter.type->semanticType});
+    }
+    const SemanticType* returnType = nullptr;  // void
+    if (funcStmt->returnType) {
+        if (visit(funcStmt->returnType) == Result::Failure || !funcStmt->returnType->semanticType) {
+            result = Result::Failure;
+        }
+        returnType = funcStmt->returnType->semanticType;
+    }
+    if (isGeneric) { symbolTable.exitScope(); }
+    if (result == Result::Failure) { return result; }
+    const mnstl::string_pool::atom_t name = lexer::identifierPool().intern(funcStmt->name);
+    if (const Symbol* symbol = symbolTable.lookup(name); symbol && symbol->node == funcStmt) {
+        symbolTable.setGlobalType(name, typeContext.getFunction(std::move(parameters), returnType));
+    }
+    return Result::Success;
+}
+
+size_t analyzer::_typeParameterCount(const Symbol& symbol) noexcept {
+    if (!symbol.node) { return 0; }  // e.g. an imported symbol
+    if (symbol.kind == SymbolKind::Aggregate) {
+        return static_cast<const ast::AggregateDeclarationStatement*>(symbol.node)->genericTypes.size();
+    }
+    if (symbol.kind == SymbolKind::Function) {
+        return static_cast<const ast::FunctionDeclarationStatement*>(symbol.node)->genericTypes.size();
+    }
+    return 0;
+}
+
+const SemanticType* analyzer::_specialize(size_t typeParameterCount, const SemanticType* type,
+                                          std::string_view name, std::span<const SemanticType* const> typeArguments,
+                                          const ast::ASTNode* node) {
+    const size_t expected = typeParameterCount;
+    if (expected == 0) {
+        logError(node, "'{}' is not generic, so can't be given type arguments", name);
+        return nullptr;
+    }
+    if (typeArguments.size() != expected) {
+        logError(node, "'{}' takes {} type argument{}, but was given {}", name, expected, expected == 1 ? "" : "s",
+                 typeArguments.size());
+        return nullptr;
+    }
+    if (!type) {
+        logError(node, "'{}' can't be specialized, since its declaration is invalid", name);
+        return nullptr;
+    }
+    return typeContext.specialize(type, typeArguments);
+}
+
+auto analyzer::_findImport(std::string_view name) const noexcept -> const ImportedModule* {
+    auto imported = std::ranges::find(importedModules, name, &ImportedModule::name);
+    return imported == importedModules.end() ? nullptr : &*imported;
+}
+
+auto analyzer::_findImportedMember(std::string_view module, std::string_view member, const ast::ASTNode* node) const
+    -> std::optional<ImportedMember> {
+    const ImportedModule* imported = _findImport(module);
+    if (!imported) {
+        logError(node, "Module '{}' is not imported", module);
+        return std::nullopt;
+    }
+    const std::optional<ModuleInterface::Symbol> symbol = imported->interface->find(member);
+    if (!symbol) {
+        logError(node, "Module '{}' has no public member '{}'", module, member);
+        return std::nullopt;
+    }
+    return ImportedMember{.symbol = *symbol, .type = imported->interface->resolveType(symbol->type, typeContext)};
+}
+
 }  // namespace semantic
 
 }  // namespace Manganese
\ No newline at end of file
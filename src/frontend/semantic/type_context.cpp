@@ -3,9 +3,19 @@
 #include <core.hpp>
 #include <frontend/ast/ast_base.hpp>
 #include <frontend/semantic.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <mnstl/string_pool.hxx>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <utils/time_report.hpp>
 #include <vector>
 
 namespace Manganese {
@@ -22,6 +32,108 @@ std::string Aggregate::toString() const {
     return result;
 }
 
+namespace {
+constexpr inline uint64_t POINTER_SIZE = sizeof(void*);  // Compiled code runs on the host (see the JIT)
+
+constexpr Layout primitiveLayout(ast::PrimitiveType_t primitive) noexcept {
+    using enum ast::PrimitiveType_t;
+    switch (primitive) {
+        case i8:
+        case u8:
+        case boolean: return {.size = 1, .alignment = 1};
+        case i16:
+        case u16: return {.size = 2, .alignment = 2};
+        case i32:
+        case u32:
+        case f32:
+        case character: return {.size = 4, .alignment = 4};  // A character is a code point
+        case i64:
+        case u64:
+        case f64: return {.size = 8, .alignment = 8};
+        case i128:
+        case u128: return {.size = 16, .alignment = 16};
+        case str: return {.size = POINTER_SIZE, .alignment = POINTER_SIZE};
+        default: return {.size = 0, .alignment = 1};
+    }
+}
+
+// Whether a + b wraps around; if it doesn't, `sum` holds it
+constexpr bool addOverflows(uint64_t a, uint64_t b, uint64_t& sum) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, &sum);
+#else
+    sum = a + b;
+    return sum < a;
+#endif  // __GNUC__ || __clang__
+}
+
+// Round `offset` up to a multiple of `alignment` (a power of two), or nullopt if that doesn't fit in 64 bits
+constexpr std::optional<uint64_t> alignUp(uint64_t offset, uint64_t alignment) noexcept {
+    uint64_t padded;
+    if (addOverflows(offset, alignment - 1, padded)) { return std::nullopt; }
+    return padded & ~(alignment - 1);
+}
+}  // namespace
+
+std::optional<Layout> layoutOf(const SemanticType* type) noexcept {
+    if (!type) { return std::nullopt; }
+    switch (type->kind) {
+        case Kind::Primitive: return primitiveLayout(type->primitiveType);
+        case Kind::Pointer:
+        case Kind::Function: return Layout{.size = POINTER_SIZE, .alignment = POINTER_SIZE};  // Functions are pointers
+        case Kind::Array: {
+            const auto* array = static_cast<const Array*>(type);
+            const std::optional<Layout> element = layoutOf(array->elementType);
+            if (!element || (element->size != 0 && array->length > UINT64_MAX / element->size)) {
+                return std::nullopt;  // Too big to be addressed
+            }
+            return Layout{.size = element->size * array->length, .alignment = element->alignment};
+        }
+        case Kind::Aggregate: return static_cast<const Aggregate*>(type)->layout;
+        case Kind::Generic: {
+            // An instance is laid out as what it specializes to
+            const SemanticType* specialization
+                = static_cast<const GenericInstance*>(type)->specialization.load(std::memory_order_acquire);
+            return specialization ? layoutOf(specialization) : std::nullopt;
+        }
+        case Kind::TypeParameter: return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+void Aggregate::_layOut() {
+    mnstl::string_pool& pool = lexer::identifierPool();
+    for (size_t i = 0; i < fields.size(); ++i) {
+        // (A repeated name, which the declaration reports, keeps its first field)
+        if (!fields[i].name.empty()) { fieldIndices.try_emplace(pool.intern(fields[i].name), static_cast<uint32_t>(i)); }
+    }
+    Layout aggregateLayout{.size = 0, .alignment = 1};
+    fieldOffsets.reserve(fields.size());
+    for (const AggregateField& field : fields) {
+        const std::optional<Layout> fieldLayout = layoutOf(field.type);
+        if (!fieldLayout) {
+            fieldOffsets.clear();
+            return;
+        }
+        // (Fields too big to place within 64 bits leave it without a layout, as a field without one does)
+        const std::optional<uint64_t> offset = alignUp(aggregateLayout.size, fieldLayout->alignment);
+        if (!offset || addOverflows(*offset, fieldLayout->size, aggregateLayout.size)) {
+            fieldOffsets.clear();
+            return;
+        }
+        fieldOffsets.push_back(*offset);
+        aggregateLayout.alignment = std::max(aggregateLayout.alignment, fieldLayout->alignment);
+    }
+    // Padded to its alignment, so that each element of an array of it is aligned too
+    const std::optional<uint64_t> paddedSize = alignUp(aggregateLayout.size, aggregateLayout.alignment);
+    if (!paddedSize) {
+        fieldOffsets.clear();
+        return;
+    }
+    aggregateLayout.size = *paddedSize;
+    layout = aggregateLayout;
+}
+
 std::string Array::toString() const { return std::format("{}[{}]", elementType->toString(), length); }
 
 std::string Function::toString() const {
@@ -37,7 +149,10 @@ std::string Function::toString() const {
 }
 
 std::string GenericInstance::toString() const {
-    std::string result = baseType->toString() + "@[";
+    // A generic aggregate goes by its name, rather than its fields (which mention its type parameters)
+    const bool isNamed = baseType->isAggregate() && !static_cast<const Aggregate*>(baseType)->name.empty();
+    std::string result = (isNamed ? std::string(static_cast<const Aggregate*>(baseType)->name) : baseType->toString())
+        + "@[";
     for (std::size_t i = 0; i < typeArguments.size(); ++i) {
         result += typeArguments[i]->toString();
         if (i != typeArguments.size() - 1) [[likely]] { result += ", "; }
@@ -57,103 +172,203 @@ inline size_t hash_combine(size_t seed, size_t value) noexcept {
     return seed ^= value + GOLDEN_RATIO + (seed << 6) + (seed >> 2);
 }
 
-size_t TypeLookup::operator()(const SemanticType* t) const noexcept {
-    if (!t) { return 0; }
-    // start by hashing the type kind (isolates primitives, pointers, etc)
-    size_t hash = std::hash<kind_int_t>{}(static_cast<kind_int_t>(t->kind));
-    switch (t->kind) {
-        case Kind::Aggregate: {
-            auto* aggregate = static_cast<const Aggregate*>(t);
-            // For an anonymous aggregate, hash the fields
-            // Use the Boost Hash Combine algorithm
-            if (aggregate->name.empty()) {
-                for (const AggregateField& field : aggregate->fields) {
-                    // the bitwise shifts scramble the bits of previous fields
-                    // since order matters (e.g. aggregate{int, bool} should hash differently to aggregate{bool, int})
-                    hash = hash_combine(hash, std::hash<std::string_view>{}(field.name));
-                    hash = hash_combine(hash, std::hash<const SemanticType*>{}(field.type));
-                }
-            } else {
-                // Since named aggregates must be unique we can just hash their names
-                hash = hash_combine(hash, std::hash<std::string_view>{}(aggregate->name));
-            }
-            return hash;
-        }
-        case Kind::Array: {
-            // Since array types have a fixed structure we can just hash the member types
-            auto* array = static_cast<const Array*>(t);
-            hash = hash_combine(hash, std::hash<const SemanticType*>{}(array->elementType));
-            return hash_combine(hash, std::hash<size_t>{}(array->length));
-        }
-        case Kind::Function: {
-            auto* function = static_cast<const Function*>(t);
-            // Mix the return type first to establish the base function signature
-            hash = hash_combine(hash, std::hash<const SemanticType*>{}(function->returnType));
-            // Hash in each parameter sequentially
-            // Include the type and the mutability flag (e.g., func(int) and func(mut int) are different signatures)
-            for (const Parameter& param : function->parameterTypes) {
-                hash = hash_combine(hash, std::hash<const SemanticType*>{}(param.type));
-                hash = hash_combine(hash, std::hash<bool>{}(param.isMutable));
-            }
-            return hash;
+namespace {
+
+// Interning keys: each hashes like, and compares equal to, the type it describes, without that type having to exist
+
+inline size_t hashKind(Kind kind) noexcept {
+    return std::hash<std::underlying_type_t<Kind>>{}(static_cast<std::underlying_type_t<Kind>>(kind));
+}
+
+struct PointerKey {
+    const SemanticType* baseType;
+    bool isMutable;
+
+    size_t hash() const noexcept {
+        // like arrays, just hash the fields
+        size_t hash = hash_combine(hashKind(Kind::Pointer), std::hash<const SemanticType*>{}(baseType));
+        return hash_combine(hash, std::hash<bool>{}(isMutable));
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isPointer()) { return false; }
+        auto* pointer = static_cast<const Pointer*>(t);
+        return pointer->baseType == baseType && pointer->isMutable == isMutable;
+    }
+};
+
+struct ArrayKey {
+    const SemanticType* elementType;
+    size_t length;
+
+    size_t hash() const noexcept {
+        // Since array types have a fixed structure we can just hash the member types
+        size_t hash = hash_combine(hashKind(Kind::Array), std::hash<const SemanticType*>{}(elementType));
+        return hash_combine(hash, std::hash<size_t>{}(length));
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isArray()) { return false; }
+        auto* array = static_cast<const Array*>(t);
+        return array->elementType == elementType && array->length == length;
+    }
+};
+
+// An aggregate's fields, given either in full or (for an anonymous aggregate's unnamed fields) as just their types
+template <class Field>
+struct AggregateKey {
+    mnstl::string_pool::atom_t nameAtom;
+    std::span<const Field> fields;
+
+    constexpr static std::string_view fieldName(const AggregateField& field) noexcept { return field.name; }
+    constexpr static std::string_view fieldName(const SemanticType*) noexcept { return ""; }
+    constexpr static const SemanticType* fieldType(const AggregateField& field) noexcept { return field.type; }
+    constexpr static const SemanticType* fieldType(const SemanticType* type) noexcept { return type; }
+
+    size_t hash() const noexcept {
+        size_t hash = hashKind(Kind::Aggregate);
+        if (nameAtom != mnstl::string_pool::empty_atom) {
+            // Since named aggregates must be unique we can just hash their (interned) names
+            return hash_combine(hash, std::hash<mnstl::string_pool::atom_t>{}(nameAtom));
         }
-        case Kind::Generic: {
-            auto* generic = static_cast<const GenericInstance*>(t);
-            // Mix the base generic template type (e.g., the List in List@[int])
-            hash = hash_combine(hash, std::hash<const SemanticType*>{}(generic->baseType));
-            for (const SemanticType* arg : generic->typeArguments) {
-                hash = hash_combine(hash, std::hash<const SemanticType*>{}(arg));
-            }
-            return hash;
+        // For an anonymous aggregate, hash the fields
+        // Use the Boost Hash Combine algorithm
+        for (const Field& field : fields) {
+            // the bitwise shifts scramble the bits of previous fields
+            // since order matters (e.g. aggregate{int, bool} should hash differently to aggregate{bool, int})
+            hash = hash_combine(hash, std::hash<std::string_view>{}(fieldName(field)));
+            hash = hash_combine(hash, std::hash<const SemanticType*>{}(fieldType(field)));
         }
-        case Kind::Pointer: {
-            // like arrays, just hash the fields
-            auto* pointer = static_cast<const Pointer*>(t);
-            hash = hash_combine(hash, std::hash<const SemanticType*>{}(pointer->baseType));
-            return hash_combine(hash, std::hash<bool>{}(pointer->isMutable));
+        return hash;
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isAggregate()) { return false; }
+        auto* aggregate = static_cast<const Aggregate*>(t);
+        if (aggregate->nameAtom != nameAtom || aggregate->fields.size() != fields.size()) { return false; }
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const AggregateField& field = aggregate->fields[i];
+            if (field.name != fieldName(fields[i]) || field.type != fieldType(fields[i])) { return false; }
         }
-        case Kind::Primitive:
-            // Since each primitive value is unique we can just hash the enum type
-            return hash_combine(hash, std::hash<prim_int_t>{}(static_cast<prim_int_t>(t->primitiveType)));
-        default: ASSERT_UNREACHABLE("Unknown semantic type kind in TypeLookup hash");
+        return true;
     }
-}
+};
 
-bool TypeLookup::operator()(const SemanticType* lhs, const SemanticType* rhs) const noexcept {
-    if (lhs == rhs) { return true; }
-    if (!lhs || !rhs) { return false; }  // no deduced type; can't be equal
-    if (lhs->kind != rhs->kind) { return false; }
+struct FunctionKey {
+    std::span<const Parameter> parameterTypes;
+    const SemanticType* returnType;
 
-    switch (lhs->kind) {
-        case Kind::Primitive: return lhs->primitiveType == rhs->primitiveType;
-        case Kind::Pointer: {
-            auto* left = static_cast<const Pointer*>(lhs);
-            auto* right = static_cast<const Pointer*>(rhs);
-            return (left->baseType == right->baseType) && (left->isMutable == right->isMutable);
+    size_t hash() const noexcept {
+        // Mix the return type first to establish the base function signature
+        size_t hash = hash_combine(hashKind(Kind::Function), std::hash<const SemanticType*>{}(returnType));
+        // Hash in each parameter sequentially
+        // Include the type and the mutability flag (e.g., func(int) and func(mut int) are different signatures)
+        for (const Parameter& param : parameterTypes) {
+            hash = hash_combine(hash, std::hash<const SemanticType*>{}(param.type));
+            hash = hash_combine(hash, std::hash<bool>{}(param.isMutable));
         }
-        case Kind::Array: {
-            auto* left = static_cast<const Array*>(lhs);
-            auto* right = static_cast<const Array*>(rhs);
-            return (left->elementType == right->elementType) && (left->length == right->length);
+        return hash;
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isFunction()) { return false; }
+        auto* function = static_cast<const Function*>(t);
+        return function->returnType == returnType && std::ranges::equal(function->parameterTypes, parameterTypes);
+    }
+};
+
+struct GenericKey {
+    const SemanticType* baseType;
+    std::span<const SemanticType* const> typeArguments;
+
+    size_t hash() const noexcept {
+        // Mix the base generic template type (e.g., the List in List@[int])
+        size_t hash = hash_combine(hashKind(Kind::Generic), std::hash<const SemanticType*>{}(baseType));
+        for (const SemanticType* arg : typeArguments) {
+            hash = hash_combine(hash, std::hash<const SemanticType*>{}(arg));
         }
-        case Kind::Aggregate: {
-            auto* left = static_cast<const Aggregate*>(lhs);
-            auto* right = static_cast<const Aggregate*>(rhs);
+        return hash;
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isGeneric()) { return false; }
+        auto* generic = static_cast<const GenericInstance*>(t);
+        return generic->baseType == baseType && std::ranges::equal(generic->typeArguments, typeArguments);
+    }
+};
+
+struct TypeParameterKey {
+    std::string_view name;
+    uint32_t index;
 
-            return (left->name == right->name) && (left->fields == right->fields);
+    size_t hash() const noexcept {
+        size_t hash = hash_combine(hashKind(Kind::TypeParameter), std::hash<std::string_view>{}(name));
+        return hash_combine(hash, std::hash<uint32_t>{}(index));
+    }
+    bool matches(const SemanticType* t) const noexcept {
+        if (!t->isTypeParameter()) { return false; }
+        auto* parameter = static_cast<const TypeParameter*>(t);
+        return parameter->name == name && parameter->index == index;
+    }
+};
+
+}  // namespace
+
+template <class Key, class Create>
+const SemanticType* TypeContext::_intern(const Key& key, Create&& create) {
+    const size_t hash = key.hash();
+    // Spread the hash so that both the shard (from the top bits) and the slot (from the middle bits) are well mixed
+    const uint64_t spread = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    Shard& shard = _shards[static_cast<size_t>(spread >> (64 - SHARD_BITS))];
+    const size_t home = static_cast<size_t>(spread >> 16);
+
+    auto find = [&]() -> const SemanticType* {
+        if (shard.slots.empty()) { return nullptr; }
+        const size_t mask = shard.slots.size() - 1;
+        // The load factor is capped below 1, so an empty slot always ends the probe
+        for (size_t i = home & mask;; i = (i + 1) & mask) {
+            const SemanticType* t = shard.slots[i];
+            if (!t) { return nullptr; }
+            if (t->_hash == hash && key.matches(t)) { return t; }
         }
-        case Kind::Function: {
-            auto* left = static_cast<const Function*>(lhs);
-            auto* right = static_cast<const Function*>(rhs);
-            return (left->returnType == right->returnType) && (left->parameterTypes == right->parameterTypes);
+    };
+    {
+        std::shared_lock lock(shard.mutex);
+        if (const SemanticType* existing = find()) {
+            timing::count(timing::Counter::TypeCacheHits);
+            return existing;
         }
-        case Kind::Generic: {
-            auto* left = static_cast<const GenericInstance*>(lhs);
-            auto* right = static_cast<const GenericInstance*>(rhs);
-            return (left->baseType == right->baseType) && (left->typeArguments == right->typeArguments);
+    }
+    std::unique_lock lock(shard.mutex);
+    // Another thread may have created the type between the two locks
+    if (const SemanticType* existing = find()) {
+        timing::count(timing::Counter::TypeCacheHits);
+        return existing;
+    }
+    timing::count(timing::Counter::TypesInterned);
+
+    // Keep at least one slot in eight empty, so probes stay short
+    if ((shard.size + 1) * 8 > shard.slots.size() * 7) {
+        std::vector<const SemanticType*> grown(std::max(shard.slots.size() * 2, size_t{16}), nullptr);
+        const size_t mask = grown.size() - 1;
+        for (const SemanticType* t : shard.slots) {
+            if (!t) { continue; }
+            // Types keep their hashes, so growing never rehashes a type's fields
+            size_t i = static_cast<size_t>((static_cast<uint64_t>(t->_hash) * 0x9E3779B97F4A7C15ull) >> 16) & mask;
+            while (grown[i]) { i = (i + 1) & mask; }
+            grown[i] = t;
         }
-        default: ASSERT_UNREACHABLE("Unknown semantic type kind in TypeLookup search");
+        shard.slots = std::move(grown);
     }
+
+    SemanticType* created;
+    {
+        std::lock_guard allocatorLock(_allocatorMutex);
+        mnstl::chunk_allocator::tag_scope tag(_allocator, mnstl::alloc_tag::types);
+        created = create();
+    }
+    created->_hash = hash;
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = home & mask;
+    while (shard.slots[i]) { i = (i + 1) & mask; }
+    shard.slots[i] = created;
+    ++shard.size;
+    return created;
 }
 
 const SemanticType* TypeContext::getPrimitive(ast::PrimitiveType_t primitive) const noexcept {
@@ -161,53 +376,151 @@ const SemanticType* TypeContext::getPrimitive(ast::PrimitiveType_t primitive) co
 }
 
 const SemanticType* TypeContext::getPointer(const SemanticType* baseType, bool isMutable) {
-    Pointer tmp(baseType, isMutable);
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    Pointer* heapAlloc = _allocator.emplace<Pointer>(baseType, isMutable);
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+    return _intern(PointerKey{.baseType = baseType, .isMutable = isMutable},
+                   [&]() { return _allocator.emplace<Pointer>(baseType, isMutable); });
 }
 
 const SemanticType* TypeContext::getArray(const SemanticType* elementType, size_t length) {
-    Array tmp(elementType, length);
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    Array* heapAlloc = _allocator.emplace<Array>(elementType, length);
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+    return _intern(ArrayKey{.elementType = elementType, .length = length},
+                   [&]() { return _allocator.emplace<Array>(elementType, length); });
 }
 
 const SemanticType* TypeContext::getAnonymousAggregate(std::vector<const SemanticType*>&& fieldTypes) {
-    Aggregate tmp(std::move(fieldTypes));
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    Aggregate* heapAlloc = _allocator.emplace<Aggregate>(std::move(tmp.fields));
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+    const AggregateKey<const SemanticType*> key{.nameAtom = mnstl::string_pool::empty_atom, .fields = fieldTypes};
+    return _intern(key, [&]() { return _allocator.emplace<Aggregate>(_allocator.resource(), std::move(fieldTypes)); });
 }
 
 const SemanticType* TypeContext::getNamedAggregate(std::string_view name, std::vector<AggregateField>&& fieldTypes) {
     // Named types are nominal: they are unique by their declaration name.
-    Aggregate tmp(std::move(fieldTypes), name);
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    Aggregate* heapAlloc = _allocator.emplace<Aggregate>(std::move(tmp.fields), name);
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+    const AggregateKey<AggregateField> key{.nameAtom = lexer::identifierPool().intern(name), .fields = fieldTypes};
+    return _intern(key,
+                   [&]() { return _allocator.emplace<Aggregate>(_allocator.resource(), std::move(fieldTypes), name); });
 }
 
 const SemanticType* TypeContext::getFunction(std::vector<Parameter>&& parameterTypes, const SemanticType* returnType) {
-    Function tmp(std::move(parameterTypes), returnType);
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    Function* heapAlloc = _allocator.emplace<Function>(std::move(tmp.parameterTypes), returnType);
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+    return _intern(FunctionKey{.parameterTypes = parameterTypes, .returnType = returnType},
+                   [&]() { return _allocator.emplace<Function>(std::move(parameterTypes), returnType); });
 }
 
 const SemanticType* TypeContext::getGenericInstance(const SemanticType* baseType,
-                                                    std::vector<const SemanticType*>&& typeArguments) {
-    GenericInstance tmp(baseType, std::move(typeArguments));
-    if (auto it = _cache.find(static_cast<const SemanticType*>(&tmp)); it != _cache.end()) { return *it; }
-    GenericInstance* heapAlloc = _allocator.emplace<GenericInstance>(baseType, std::move(tmp.typeArguments));
-    _cache.insert(heapAlloc);
-    return heapAlloc;
+                                                    std::span<const SemanticType* const> typeArguments) {
+    // The arguments are only copied (into the instance) if the instance is new
+    return _intern(GenericKey{.baseType = baseType, .typeArguments = typeArguments},
+                   [&]() { return _allocator.emplace<GenericInstance>(baseType, typeArguments); });
+}
+
+const SemanticType* TypeContext::getTypeParameter(std::string_view name, uint32_t index) {
+    return _intern(TypeParameterKey{.name = name, .index = index},
+                   [&]() { return _allocator.emplace<TypeParameter>(name, index); });
+}
+
+bool TypeContext::dependsOnTypeParameters(const SemanticType* type) noexcept {
+    if (!type) { return false; }
+    switch (type->kind) {
+        case Kind::TypeParameter: return true;
+        case Kind::Primitive: return false;
+        case Kind::Pointer: return dependsOnTypeParameters(static_cast<const Pointer*>(type)->baseType);
+        case Kind::Array: return dependsOnTypeParameters(static_cast<const Array*>(type)->elementType);
+        case Kind::Function: {
+            const auto* function = static_cast<const Function*>(type);
+            return dependsOnTypeParameters(function->returnType)
+                || std::ranges::any_of(function->parameterTypes, [](const Parameter& parameter) {
+                       return dependsOnTypeParameters(parameter.type);
+                   });
+        }
+        case Kind::Aggregate: {
+            // A named aggregate is only ever generic through an instance of it, so is complete as it is
+            const auto* aggregate = static_cast<const Aggregate*>(type);
+            return aggregate->name.empty()
+                && std::ranges::any_of(aggregate->fields,
+                                       [](const AggregateField& field) { return dependsOnTypeParameters(field.type); });
+        }
+        case Kind::Generic:
+            return std::ranges::any_of(static_cast<const GenericInstance*>(type)->typeArguments,
+                                       [](const SemanticType* argument) { return dependsOnTypeParameters(argument); });
+    }
+    return false;
+}
+
+const SemanticType* TypeContext::_substitute(const SemanticType* type,
+                                             std::span<const SemanticType* const> arguments) {
+    if (!dependsOnTypeParameters(type)) { return type; }  // Which leaves the types that don't untouched, and shared
+    switch (type->kind) {
+        case Kind::TypeParameter: {
+            const uint32_t index = static_cast<const TypeParameter*>(type)->index;
+            return index < arguments.size() ? arguments[index] : type;
+        }
+        case Kind::Pointer: {
+            const auto* pointer = static_cast<const Pointer*>(type);
+            return getPointer(_substitute(pointer->baseType, arguments), pointer->isMutable);
+        }
+        case Kind::Array: {
+            const auto* array = static_cast<const Array*>(type);
+            return getArray(_substitute(array->elementType, arguments), array->length);
+        }
+        case Kind::Function: {
+            const auto* function = static_cast<const Function*>(type);
+            std::vector<Parameter> parameters;
+            parameters.reserve(function->parameterTypes.size());
+            for (const Parameter& parameter : function->parameterTypes) {
+                parameters.push_back(
+                    Parameter{.isMutable = parameter.isMutable, .type = _substitute(parameter.type, arguments)});
+            }
+            return getFunction(std::move(parameters), _substitute(function->returnType, arguments));
+        }
+        case Kind::Aggregate: {  // An anonymous one (see dependsOnTypeParameters())
+            std::vector<const SemanticType*> fields;
+            fields.reserve(static_cast<const Aggregate*>(type)->fields.size());
+            for (const AggregateField& field : static_cast<const Aggregate*>(type)->fields) {
+                fields.push_back(_substitute(field.type, arguments));
+            }
+            return getAnonymousAggregate(std::move(fields));
+        }
+        case Kind::Generic: {
+            // e.g. a Box@[T] inside Pair[T], which can be specialized now that T is known
+            const auto* generic = static_cast<const GenericInstance*>(type);
+            std::vector<const SemanticType*> substituted;
+            substituted.reserve(generic->typeArguments.size());
+            for (const SemanticType* argument : generic->typeArguments) {
+                substituted.push_back(_substitute(argument, arguments));
+            }
+            return specialize(generic->baseType, substituted);
+        }
+        case Kind::Primitive: return type;
+    }
+    return type;
+}
+
+const SemanticType* TypeContext::specialize(const SemanticType* genericType,
+                                            std::span<const SemanticType* const> typeArguments) {
+    const auto* instance = static_cast<const GenericInstance*>(getGenericInstance(genericType, typeArguments));
+    if (const SemanticType* specialized = instance->specialization.load(std::memory_order_acquire)) {
+        return specialized;
+    }
+    if (std::ranges::any_of(typeArguments,
+                            [](const SemanticType* argument) { return dependsOnTypeParameters(argument); })) {
+        return instance;
+    }
+
+    // Threads specializing the same instance at once build it out of the same interned types, so they all get the
+    // same type, and whichever stores it first wins
+    const SemanticType* specialized;
+    if (genericType->isAggregate()) {
+        const auto* aggregate = static_cast<const Aggregate*>(genericType);
+        std::vector<AggregateField> fields;
+        fields.reserve(aggregate->fields.size());
+        for (const AggregateField& field : aggregate->fields) {
+            fields.push_back(AggregateField{.name = field.name, .type = _substitute(field.type, typeArguments)});
+        }
+        specialized = getNamedAggregate(instance->toString(), std::move(fields));
+    } else {
+        specialized = _substitute(genericType, typeArguments);  // e.g. a generic function's signature
+    }
+    const SemanticType* expected = nullptr;
+    if (instance->specialization.compare_exchange_strong(expected, specialized, std::memory_order_acq_rel)) {
+        timing::count(timing::Counter::Specializations);
+    }
+    return specialized;
 }
 }  // namespace semantic
 }  // namespace Manganese
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <io/diagnostics.hpp>
+#include <io/logging.hpp>
+#include <io/source_map.hpp>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Manganese {
+namespace logging {
+
+namespace {
+
+constexpr const char* levelName(LogLevel level) noexcept {
+    switch (level) {
+        case LogLevel::Info: return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error: return "error";
+        case LogLevel::Critical: return "critical";
+    }
+    ASSERT_UNREACHABLE("Unknown log level");
+}
+
+// Where a diagnostic is as a line and column, resolving its location if it is still one
+std::pair<uint32_t, uint32_t> position(const Diagnostic& diagnostic) {
+    if (!diagnostic.location.isValid()) { return {diagnostic.line, diagnostic.column}; }
+    const io::LineColumn resolved = io::sourceMap().resolve(diagnostic.location);
+    if (resolved.line == 0) { return {NO_POSITION, NO_POSITION}; }  // Its source is gone
+    return {static_cast<uint32_t>(resolved.line), static_cast<uint32_t>(resolved.column)};
+}
+
+}  // namespace
+
+void Diagnostic::resolve() {
+    if (!location.isValid()) { return; }
+    std::tie(line, column) = position(*this);
+    location = {};
+}
+
+void DiagnosticList::resolve() {
+    for (Diagnostic& diagnostic : diagnostics) { diagnostic.resolve(); }
+}
+
+void DiagnosticList::shift(ptrdiff_t offset) noexcept {
+    for (Diagnostic& diagnostic : diagnostics) {
+        if (!diagnostic.location.isValid()) { continue; }
+        diagnostic.location.offset = static_cast<uint32_t>(static_cast<ptrdiff_t>(diagnostic.location.offset) + offset);
+    }
+}
+
+void DiagnosticList::sort() {
+    resolve();
+    // Those about no place in particular go after the rest, as if they were at the end of the file
+    auto position = [](const Diagnostic& diagnostic) { return std::pair(diagnostic.line, diagnostic.column); };
+    std::ranges::stable_sort(diagnostics, {}, position);
+    // Duplicates are at the same place, so each only has to be looked for among those at its place
+    std::vector<Diagnostic> unique;
+    unique.reserve(diagnostics.size());
+    for (size_t i = 0; i < diagnostics.size();) {
+        const auto place = position(diagnostics[i]);
+        const size_t placeStart = unique.size();
+        for (; i < diagnostics.size() && position(diagnostics[i]) == place; ++i) {
+            if (std::find(unique.begin() + static_cast<ptrdiff_t>(placeStart), unique.end(), diagnostics[i])
+                == unique.end()) {
+                unique.push_back(std::move(diagnostics[i]));
+            }
+        }
+    }
+    diagnostics = std::move(unique);
+}
+
+void DiagnosticList::render(std::string& output, DiagnosticFormat format) const {
+    if (format == DiagnosticFormat::Text) {
+        for (const Diagnostic& diagnostic : diagnostics) { renderDiagnostic(output, diagnostic); }
+        return;
+    }
+    output += '[';
+    for (size_t i = 0; i < diagnostics.size(); ++i) {
+        const Diagnostic& diagnostic = diagnostics[i];
+        output += std::format(R"({}{{"level": "{}", )", i ? ", " : "", levelName(diagnostic.level));
+        if (const auto [line, column] = position(diagnostic); line != NO_POSITION) {
+            output += std::format(R"("line": {}, "column": {}, )", line, column);
+        }
+        output += R"("message": )";
+        appendJsonString(output, diagnostic.message);
+        output += '}';
+    }
+    output += ']';
+}
+
+std::string DiagnosticList::render(DiagnosticFormat format) const {
+    std::string output;
+    render(output, format);
+    return output;
+}
+
+void renderDiagnostic(std::string& output, const Diagnostic& diagnostic) {
+    switch (diagnostic.level) {
+        case LogLevel::Info: return;  // No user info
+        case LogLevel::Warning: output += std::format("{}Warning: {}{}", YELLOW, diagnostic.message, RESET); break;
+        case LogLevel::Error: output += std::format("{}Error: {}{}", RED, diagnostic.message, RESET); break;
+        case LogLevel::Critical:
+            output += std::format("{}Critical error: {} Compilation aborted.{}", CRITICAL, diagnostic.message, RESET);
+            break;
+    }
+    if (const auto [line, column] = position(diagnostic); line != NO_POSITION) {
+        output += std::format(" (line {}, column {})", line, column);
+    }
+    output += '\n';
+}
+
+void appendJsonString(std::string& output, std::string_view text) {
+    output += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            output += '\\';
+            output += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            output += std::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            output += c;
+        }
+    }
+    output += '"';
+}
+
+void report(Diagnostic&& diagnostic) noexcept {
+    if (DiagnosticList* list = diagnosticList()) {
+        list->add(std::move(diagnostic));
+        return;
+    }
+    std::string text;
+    renderDiagnostic(text, diagnostic);
+    diagnosticStream()->write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void report(const DiagnosticList& diagnostics) noexcept {
+    if (DiagnosticList* list = diagnosticList()) {
+        list->append(diagnostics);
+        return;
+    }
+    const std::string text = diagnostics.render();
+    diagnosticStream()->write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+}  // namespace logging
+}  // namespace Manganese
@@ -15,7 +15,7 @@ FileReader::FileReader(const std::string& filename, size_t bufferCapacity) :
     _position(0), _line(1), _column(1), _filePtr(nullptr), _bufferSize(0), _bufferCapacity(bufferCapacity) {
     _filePtr = std::fopen(filename.c_str(), "r");
     if (!_filePtr) {
-        logging::logCritical(0, 0, "Could not open file {}", filename);
+        logging::logCritical(SourceLocation{}, "Could not open file {}", filename);
         throw std::runtime_error("Critical error encountered.");  // Note: exception here means hard error and exit
         return;
     }
@@ -26,7 +26,7 @@ FileReader::FileReader(const std::string& filename, size_t bufferCapacity) :
     _bufferSize = std::fread(_buffer.get(), sizeof(char), bufferCapacity, _filePtr);  // initial read
 
     if (_bufferSize == 0) {
-        logging::logError(0, 0, "File {} is empty or could not be read", filename);
+        logging::logError(SourceLocation{}, "File {} is empty or could not be read", filename);
         throw std::runtime_error("Critical error encountered.");  // Note: exception here means hard error and exit
         return;
     }
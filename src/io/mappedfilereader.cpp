@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstring>
+#include <format>
+#include <io/logging.hpp>
+#include <io/mappedfilereader.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#else  // ^^ _WIN32 vv POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace Manganese {
+namespace io {
+
+[[noreturn]] static void fail(const std::string& filename, const char* reason) {
+    logging::logCritical(SourceLocation{}, "Could not map file {} ({})", filename, reason);
+    throw std::runtime_error("Critical error encountered.");  // Note: exception here means hard error and exit
+}
+
+#if defined(_WIN32)
+
+bool MappedFileReader::isMappable(const std::string& filename) noexcept {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &attributes)) { return false; }
+    if (attributes.dwFileAttributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE)) { return false; }
+    return attributes.nFileSizeHigh != 0 || attributes.nFileSizeLow != 0;
+}
+
+MappedFileReader::MappedFileReader(const std::string& filename) : _position(0), _line(1), _column(1) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { fail(filename, "could not open file"); }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        fail(filename, "file is empty or its size could not be read");
+    }
+    const size_t length = static_cast<size_t>(fileSize.QuadPart);
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    if (length % systemInfo.dwPageSize == 0) {
+        // The view would end exactly on a page boundary, leaving no zero-filled byte for the terminator
+        _ownedBuffer = std::make_unique_for_overwrite<char[]>(length + 1);
+        size_t totalRead = 0;
+        while (totalRead < length) {
+            DWORD bytesRead = 0;
+            const DWORD toRead = static_cast<DWORD>(std::min<size_t>(length - totalRead, 1u << 30));
+            if (!ReadFile(file, _ownedBuffer.get() + totalRead, toRead, &bytesRead, nullptr) || bytesRead == 0) {
+                CloseHandle(file);
+                fail(filename, "could not read file");
+            }
+            totalRead += bytesRead;
+        }
+        CloseHandle(file);
+        _ownedBuffer[length] = '\0';
+        _source = std::string_view(_ownedBuffer.get(), length);
+        return;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // The mapping object keeps its own reference to the file
+    if (!mappingHandle) { fail(filename, "could not create file mapping"); }
+
+    _mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mappingHandle);  // The view keeps the mapping alive
+    if (!_mapping) { fail(filename, "could not map view of file"); }
+    _mappingSize = length;
+
+    // The remainder of the last page is zero-filled, so the byte at data()[length] is '\0'
+    _source = std::string_view(static_cast<const char*>(_mapping), length);
+}
+
+void MappedFileReader::unmap() noexcept {
+    if (_mapping) { UnmapViewOfFile(_mapping); }
+    _mapping = nullptr;
+    _mappingSize = 0;
+}
+
+#else  // ^^ _WIN32 vv POSIX
+
+bool MappedFileReader::isMappable(const std::string& filename) noexcept {
+    struct stat info;
+    if (::stat(filename.c_str(), &info) != 0) { return false; }
+    return S_ISREG(info.st_mode) && info.st_size > 0;
+}
+
+MappedFileReader::MappedFileReader(const std::string& filename) : _position(0), _line(1), _column(1) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) { fail(filename, "could not open file"); }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        ::close(fd);
+        fail(filename, "not a regular, non-empty file");
+    }
+    const size_t length = static_cast<size_t>(info.st_size);
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+    if (length % pageSize == 0) {
+        // The mapping would end exactly on a page boundary, leaving no zero-filled byte for the terminator
+        _ownedBuffer = std::make_unique_for_overwrite<char[]>(length + 1);
+        size_t totalRead = 0;
+        while (totalRead < length) {
+            const ssize_t bytesRead = ::read(fd, _ownedBuffer.get() + totalRead, length - totalRead);
+            if (bytesRead <= 0) {
+                ::close(fd);
+                fail(filename, "could not read file");
+            }
+            totalRead += static_cast<size_t>(bytesRead);
+        }
+        ::close(fd);
+        _ownedBuffer[length] = '\0';
+        _source = std::string_view(_ownedBuffer.get(), length);
+        return;
+    }
+
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid after the descriptor is closed
+    if (mapping == MAP_FAILED) { fail(filename, "mmap failed"); }
+#if defined(MADV_SEQUENTIAL)
+    // The lexer reads front to back, so let the kernel read ahead aggressively
+    DISCARD(::madvise(mapping, length, MADV_SEQUENTIAL));
+#endif  // MADV_SEQUENTIAL
+
+    _mapping = mapping;
+    _mappingSize = length;
+    // POSIX zero-fills the remainder of the last page, so the byte at data()[length] is '\0'
+    _source = std::string_view(static_cast<const char*>(mapping), length);
+}
+
+void MappedFileReader::unmap() noexcept {
+    if (_mapping) { ::munmap(_mapping, _mappingSize); }
+    _mapping = nullptr;
+    _mappingSize = 0;
+}
+
+#endif  // _WIN32
+
+void MappedFileReader::setPosition(size_t newPosition) noexcept {
+    newPosition = std::min(newPosition, _source.length());
+    if (newPosition <= _position) { return; }  // Like the other readers, only seek forwards
+
+    // Update the line/column in one pass over the skipped bytes, rather than consuming them one at a time
+    const std::string_view skipped = _source.substr(_position, newPosition - _position);
+    const size_t lastNewline = skipped.rfind('\n');
+    if (lastNewline == std::string_view::npos) {
+        _column += skipped.length();
+    } else {
+        _line += static_cast<size_t>(std::count(skipped.begin(), skipped.end(), '\n'));
+        _column = skipped.length() - lastNewline;
+    }
+    _position = newPosition;
+}
+
+}  // namespace io
+}  // namespace Manganese
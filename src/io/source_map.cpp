@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <io/source_map.hpp>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace Manganese {
+namespace io {
+
+namespace {
+
+thread_local std::vector<uint32_t>* scopeSources = nullptr;  // Those of this thread's innermost SourceScope
+
+}  // namespace
+
+void LineTable::build() {
+    // Roughly one line per 32 bytes of source code is a reasonable first guess
+    _lineStarts.reserve(_source.size() / 32 + 1);
+    _lineStarts.push_back(0);
+    const char* const begin = _source.data();
+    const char* const end = begin + _source.size();
+    const char* p = begin;
+    // memchr is vectorized by the C library, so this scans for newlines 16-64 bytes at a time
+    while (p < end && (p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p))))) {
+        ++p;
+        _lineStarts.push_back(static_cast<uint32_t>(p - begin));
+    }
+    _source = std::string_view();
+    _isBuilt = true;
+}
+
+LineColumn LineTable::resolve(uint32_t offset) {
+    std::call_once(_built, &LineTable::build, this);
+    // The line containing `offset` is the last one starting at or before it
+    auto lineStart = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset) - 1;
+    return LineColumn{.line = static_cast<size_t>(lineStart - _lineStarts.begin()) + 1,
+                      .column = static_cast<size_t>(offset - *lineStart) + 1};
+}
+
+void LineTable::edit(std::string_view source, size_t offset, size_t removedLength, std::string_view inserted) {
+    if (!_isBuilt) {
+        _source = source;
+        return;
+    }
+    // Lines start after each newline, so those starting in (offset, offset + removedLength] were removed
+    const auto removedBegin = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset);
+    const auto removedEnd = std::upper_bound(removedBegin, _lineStarts.end(), offset + removedLength);
+    const auto after = _lineStarts.erase(removedBegin, removedEnd);
+    const auto delta = static_cast<uint32_t>(inserted.size() - removedLength);  // Wraps around for a net removal
+    std::for_each(after, _lineStarts.end(), [delta](uint32_t& start) { start += delta; });
+
+    std::vector<uint32_t> added;
+    for (size_t i = inserted.find('\n'); i != std::string_view::npos; i = inserted.find('\n', i + 1)) {
+        added.push_back(static_cast<uint32_t>(offset + i + 1));
+    }
+    _lineStarts.insert(std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset), added.begin(), added.end());
+}
+
+std::shared_ptr<LineTable> SourceMap::table(uint32_t source) const noexcept {
+    std::lock_guard lock(_mutex);
+    return source < _tables.size() ? _tables[source] : nullptr;
+}
+
+uint32_t SourceMap::addSource(std::string_view source) {
+    uint32_t id;
+    {
+        std::lock_guard lock(_mutex);
+        id = static_cast<uint32_t>(_tables.size());
+        _tables.push_back(std::make_shared<LineTable>(source));
+    }
+    if (scopeSources) { scopeSources->push_back(id); }
+    return id;
+}
+
+void SourceMap::release(uint32_t source, size_t usedLength) {
+    if (const std::shared_ptr<LineTable> lines = table(source)) { lines->detach(usedLength); }
+}
+
+void SourceMap::edit(uint32_t source, std::string_view text, size_t offset, size_t removedLength,
+                     std::string_view inserted) {
+    if (const std::shared_ptr<LineTable> lines = table(source)) { lines->edit(text, offset, removedLength, inserted); }
+}
+
+void SourceMap::remove(uint32_t source) {
+    std::shared_ptr<LineTable> removed;  // Freed (unless a reader still has it) after unlocking
+    std::lock_guard lock(_mutex);
+    if (source >= _tables.size() || !_tables[source]) { return; }
+    removed = std::move(_tables[source]);
+    ++_removedCount;
+}
+
+size_t SourceMap::sourceCount() const {
+    std::lock_guard lock(_mutex);
+    return _tables.size() - _removedCount;
+}
+
+LineColumn SourceMap::resolve(SourceLocation location) {
+    const std::shared_ptr<LineTable> lines = location.isValid() ? table(location.source) : nullptr;
+    return lines ? lines->resolve(location.offset) : LineColumn{};
+}
+
+SourceScope::SourceScope() noexcept : outer(scopeSources) { scopeSources = &sources; }
+
+SourceScope::~SourceScope() noexcept {
+    scopeSources = outer;
+    for (uint32_t source : sources) { sourceMap().remove(source); }
+}
+
+SourceMap& sourceMap() noexcept {
+    // Deliberately never destroyed, so lexers with static storage duration can still release their sources at exit
+    static SourceMap* map = new SourceMap();
+    return *map;
+}
+
+}  // namespace io
+}  // namespace Manganese
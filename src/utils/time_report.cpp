@@ -0,0 +1,50 @@
+#include <chrono>
+#include <core.hpp>
+#include <cstdint>
+#include <format>
+#include <io/logging.hpp>
+#include <ostream>
+#include <utils/time_report.hpp>
+
+namespace Manganese {
+namespace timing {
+
+bool enable() noexcept {
+#if TIME_REPORT
+    detail::enabled.store(true, std::memory_order_relaxed);
+    return true;
+#else  // ^^ TIME_REPORT vv !TIME_REPORT
+    return false;
+#endif  // TIME_REPORT
+}
+
+void printReport(std::ostream& output, std::chrono::steady_clock::duration total) {
+    const double totalMilliseconds = std::chrono::duration<double, std::milli>(total).count();
+    output << PINK << "Time report (" << std::format("{:.3f}", totalMilliseconds) << "ms in total)" << RESET << '\n';
+#if TIME_REPORT
+    // Whatever was counted on this thread outside any phase
+    detail::flushCounts();
+    output << PINK << std::format("  {:<20} {:>12} {:>7} {:>10} {:>12}", "Phase", "Time", "%", "Calls", "Arena")
+           << RESET << '\n';
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        const detail::PhaseTotals& phase = detail::phases[i];
+        const double milliseconds = static_cast<double>(phase.nanoseconds.load(std::memory_order_relaxed)) / 1e6;
+        output << std::format("  {:<20} {:>10.3f}ms {:>6.1f}% {:>10} {:>10.1f}KB", PHASE_NAMES[i], milliseconds,
+                              totalMilliseconds > 0 ? 100 * milliseconds / totalMilliseconds : 0.0,
+                              phase.calls.load(std::memory_order_relaxed),
+                              static_cast<double>(phase.arenaBytes.load(std::memory_order_relaxed)) / 1024)
+               << '\n';
+    }
+    output << PINK << std::format("  {:<20} {:>12}", "Counter", "Count") << RESET << '\n';
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        output << std::format("  {:<20} {:>12}", COUNTER_NAMES[i], detail::counters[i].load(std::memory_order_relaxed))
+               << '\n';
+    }
+    output << "  (Times of phases run on several threads at once are summed, so they can add up to more than 100%)\n";
+#else  // ^^ TIME_REPORT vv !TIME_REPORT
+    output << "  (Phases aren't timed in this build, which was configured without TIME_REPORT)\n";
+#endif  // TIME_REPORT
+}
+
+}  // namespace timing
+}  // namespace Manganese
@@ -0,0 +1,127 @@
+#include <chrono>
+#include <core.hpp>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <io/diagnostics.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/result.hpp>
+#include <utils/time_report.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+namespace Manganese {
+namespace trace {
+
+namespace {
+
+// One thread's events: appended to until full, then used as a ring (`next` wrapping round to the oldest event)
+struct ThreadBuffer {
+    uint32_t thread = 0;  // Numbered in the order threads first record an event (the main thread is 0)
+    // Only ever contended while write() reads the events, which can be while other threads are still tracing
+    std::mutex mutex;
+    std::vector<detail::Event> events;
+    size_t next = 0;
+    size_t overwritten = 0;
+};
+
+std::chrono::steady_clock::time_point traceStart;
+std::mutex buffersMutex;
+// Kept after their threads exit, so the events of workers that are long gone are still written out
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+ThreadBuffer& buffer() {
+    if (!threadBuffer) {
+        std::lock_guard lock(buffersMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        threadBuffer = buffers.back().get();
+        threadBuffer->thread = static_cast<uint32_t>(buffers.size() - 1);
+    }
+    return *threadBuffer;
+}
+
+}  // namespace
+
+namespace detail {
+
+int64_t now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceStart).count();
+}
+
+void record(Event&& event) {
+    ThreadBuffer& thread = buffer();
+    std::lock_guard lock(thread.mutex);
+    if (thread.events.size() < MAX_EVENTS_PER_THREAD) {
+        thread.events.push_back(std::move(event));
+        return;
+    }
+    thread.events[thread.next] = std::move(event);
+    thread.next = (thread.next + 1) % MAX_EVENTS_PER_THREAD;
+    ++thread.overwritten;
+}
+
+}  // namespace detail
+
+void enable() {
+    traceStart = std::chrono::steady_clock::now();
+    DISCARD(buffer());  // So this thread is thread 0
+    // Timing lets events say how long they spent lexing (if this build can time phases)
+    DISCARD(timing::enable());
+    detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+Result write(const std::string& path) {
+    std::ofstream output(path);
+    output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    // Times are in (fractional) microseconds
+    auto microseconds = [](int64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1e3; };
+    bool first = true;
+    std::lock_guard lock(buffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& thread : buffers) {
+        std::lock_guard threadLock(thread->mutex);
+        output << (first ? "" : ",\n")
+               << std::format(R"({{"name": "thread_name", "ph": "M", "pid": 1, "tid": {}, "args": {{"name": "{}"}}}})",
+                              thread->thread, thread->thread ? std::format("worker {}", thread->thread) : "main");
+        first = false;
+        for (const detail::Event& event : thread->events) {
+            output << std::format(R"(,
+{{"name": "{}", "ph": "X", "pid": 1, "tid": {}, "ts": {:.3f}, "dur": {:.3f}, "args": {{)",
+                                  event.name, thread->thread, microseconds(event.start),
+                                  microseconds(event.duration));
+            const char* separator = "";
+            if (!event.detail.empty()) {
+                std::string file = R"("file": )";
+                logging::appendJsonString(file, event.detail);
+                output << file;
+                separator = ", ";
+            }
+            if (event.argumentName) {
+                output << std::format(R"({}"{}": {})", separator, event.argumentName, event.argument);
+                separator = ", ";
+            }
+            if (event.lexNanoseconds) {
+                output << std::format(R"({}"lex_ms": {:.3f})", separator,
+                                      static_cast<double>(event.lexNanoseconds) / 1e6);
+            }
+            output << "}}";
+        }
+        if (thread->overwritten) {
+            // Marks where the thread's surviving events begin
+            output << std::format(R"(,
+{{"name": "{} earlier events overwritten", "ph": "i", "s": "t", "pid": 1, "tid": {}, "ts": {:.3f}}})",
+                                  thread->overwritten, thread->thread,
+                                  microseconds(thread->events[thread->next].start));
+        }
+    }
+    output << "\n]}\n";
+    output.flush();
+    return output ? Result::Success : Result::Failure;
+}
+
+}  // namespace trace
+}  // namespace Manganese
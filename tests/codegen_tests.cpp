@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <backend/codegen.hpp>
+#include <backend/mir.hpp>
+#include <core.hpp>
+#include <format>
+#include <frontend/parser.hpp>
+#include <frontend/semantic.hpp>
+#include <io/logging.hpp>
+#include <iostream>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <mnstl/chunk_allocator.hxx>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "testrunner.hpp"
+
+namespace Manganese {
+namespace tests {
+
+// Parse, analyze and lower `source`, collecting what that reported (nullptr if any stage failed)
+std::unique_ptr<llvm::Module> generateModule(const std::string& source, llvm::LLVMContext& context,
+                                             std::string& diagnostics) {
+    mnstl::chunk_allocator arena, typeArena;
+    semantic::TypeContext types(typeArena);  // The generator reads the types the analysis leaves on the AST
+    parser::Parser parser(source, lexer::Mode::String, arena);
+    parser::ParsedFile file = parser.parse();
+    std::ostringstream buffer;
+    std::unique_ptr<llvm::Module> module;
+    {
+        logging::DiagnosticCapture capture(buffer);
+        semantic::analyzer analyzer(file, types, arena);
+        if (!file.hasError && analyzer.analyze() == Result::Success) {
+            module = codegen::IRGenerator(file, context, "test").generate();
+        }
+    }
+    diagnostics = buffer.str();
+    return module;
+}
+
+std::string printModule(const llvm::Module& module) {
+    std::string text;
+    llvm::raw_string_ostream stream(text);
+    module.print(stream, nullptr);
+    return stream.str();
+}
+
+bool testIRGeneration() {
+    const std::string source = "public func factorial(n: mut int64, acc: mut int64) -> int64 {\n"
+                               "    while (n > 1) { acc = acc * n; n = n - 1; }\n"
+                               "    return acc;\n"
+                               "}\n"
+                               "public func mean(total: float64, count: int32) -> float64 {\n"
+                               "    return total / (count as float64);\n"
+                               "}\n"
+                               "func compare(x: int32) -> int32 {\n"
+                               "    if (x < 10) { return 1; } elif (x == 10) { return 2; } else { return 3; }\n"
+                               "}\n"
+                               "public func between(x: uint8, low: uint8, high: uint8) -> bool {\n"
+                               "    return low <= x && x < high;\n"
+                               "}\n"
+                               "public func layout() -> uint64 {\n"
+                               "    return sizeof(aggregate{int8, int64}) * alignof(int32);\n"
+                               "}\n";
+    llvm::LLVMContext context;
+    std::string diagnostics;
+    std::unique_ptr<llvm::Module> module = generateModule(source, context, diagnostics);
+    if (!module) {
+        std::cerr << "ERROR: Expected the program to lower to IR, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string ir = printModule(*module);
+    for (std::string_view expected : {
+             "define i64 @factorial(i64 %n, i64 %acc)",
+             "mul i64",
+             "sitofp i32",
+             "fdiv double",
+             "define internal i32 @compare(i32 %x)",  // Private functions aren't visible outside the module,
+             "icmp slt i32",
+             "icmp ule i8",  // and unsigned operands compare as unsigned
+             "phi i1",  // && only evaluates its right operand if it must
+             "ret i64 64",  // sizeof and alignof are constants
+         }) {
+        if (ir.find(expected) == std::string::npos) {
+            std::cerr << "ERROR: Expected the IR to contain '" << expected << "', got:\n" << ir;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testIROptimization() {
+    const std::string source = "public func five() -> int32 { if (true) { return 5; } return 6; }\n"
+                               "func twice(x: int32) -> int32 { return x + x; }\n"
+                               "public func floorDivide(a: int32, b: int32) -> int32 { return a // b; }\n";
+    for (codegen::OptimizationLevel level : {codegen::OptimizationLevel::O0, codegen::OptimizationLevel::O1,
+                                             codegen::OptimizationLevel::O2, codegen::OptimizationLevel::O3}) {
+        llvm::LLVMContext context;
+        std::string diagnostics;
+        std::unique_ptr<llvm::Module> module = generateModule(source, context, diagnostics);
+        if (!module) {
+            std::cerr << "ERROR: Expected the program to lower to IR, got:\n" << diagnostics;
+            return false;
+        }
+        codegen::optimize(*module, level);
+        if (llvm::verifyModule(*module, &llvm::errs())) {
+            std::cerr << "ERROR: The optimized module doesn't verify\n";
+            return false;
+        }
+        const std::string ir = printModule(*module);
+        const bool isOptimized = level != codegen::OptimizationLevel::O0;
+        // Stack slots are promoted to registers, branches on constants folded, and unused private functions dropped
+        if (isOptimized
+            && (ir.find("alloca") != std::string::npos || ir.find("ret i32 5") == std::string::npos
+                || ir.find("@twice") != std::string::npos)) {
+            std::cerr << "ERROR: Expected the optimized IR to be simplified, got:\n" << ir;
+            return false;
+        }
+        // The mid-level IR already folds what is constant, and only keeps locals whose address is taken in memory
+        if (!isOptimized
+            && (ir.find("alloca") != std::string::npos || ir.find("ret i32 5") == std::string::npos
+                || ir.find("@twice") == std::string::npos)) {
+            std::cerr << "ERROR: Expected O0 to only simplify what the mid-level IR does, got:\n" << ir;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testTrappingConstants() {
+    // Constant operations the hardware traps on (or doesn't define) aren't folded, but left for run time
+    const std::string source = "public func g() -> int64 { return (0 - 9223372036854775807 - 1) / -1; }\n"
+                               "public func h() -> int64 { return (0 - 9223372036854775807 - 1) % -1; }\n"
+                               "public func k(x: int32) -> int32 { return x / 0 + (1 << 70); }\n";
+    llvm::LLVMContext context;
+    std::string diagnostics;
+    std::unique_ptr<llvm::Module> module = generateModule(source, context, diagnostics);
+    if (!module) {
+        std::cerr << "ERROR: Expected the program to lower to IR, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string ir = printModule(*module);
+    // (LLVM folds the constant divisions itself, to poison)
+    for (std::string_view expected : {"define i64 @g()", "define i64 @h()", "sdiv i32"}) {
+        if (ir.find(expected) == std::string::npos) {
+            std::cerr << "ERROR: Expected the IR to contain '" << expected << "', got:\n" << ir;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testMidLevelIR() {
+    const std::string source = "func folded(n: mut int32) -> int32 {\n"
+                               "    n = 4;\n"
+                               "    n = n * 2;\n"
+                               "    if (n == 8) { return n + 1; }\n"
+                               "    return n - 1;\n"
+                               "}\n"
+                               "func dense(x: int32) -> int32 {\n"
+                               "    switch (x) {\n"
+                               "        case 3: return 30; case 4: return 40; case 6: return 60; case 7: return 70;\n"
+                               "        default: return 0;\n"
+                               "    }\n"
+                               "}\n"
+                               "func sparse(x: int32) -> int32 {\n"
+                               "    switch (x) {\n"
+                               "        case 1: return 1; case 900: return 2; case 50000: return 3; case 8: return 4;\n"
+                               "        default: return 0;\n"
+                               "    }\n"
+                               "}\n";
+    mnstl::chunk_allocator arena, typeArena;
+    semantic::TypeContext types(typeArena);
+    parser::Parser parser(source, lexer::Mode::String, arena);
+    parser::ParsedFile file = parser.parse();
+    semantic::analyzer analyzer(file, types, arena);
+    if (file.hasError || analyzer.analyze() == Result::Failure) {
+        std::cerr << "ERROR: Expected the program to analyze\n";
+        return false;
+    }
+    mir::FunctionTable functions;
+    for (ast::Statement* statement : file.program) {
+        auto* declaration = static_cast<ast::FunctionDeclarationStatement*>(statement);
+        functions.emplace(declaration->name, declaration);
+    }
+
+    mir::Builder builder(functions);
+    // Each function's optimized IR, with what it must and mustn't contain
+    const std::vector<std::tuple<std::string_view, std::vector<std::string_view>, std::vector<std::string_view>>>
+        expectations{
+            // The stores to n are folded through its SSA values, so the branch and the code it skips are gone
+            {"folded", {"const 9 : int32", "return %"}, {"branch", "*", "phi", "const 7 : int32"}},
+            {"dense", {"jumptable %0 from 3"}, {"switch %"}},
+            {"sparse", {"switch %0"}, {"jumptable"}},
+        };
+    for (const auto& [name, present, absent] : expectations) {
+        std::optional<mir::Function> function = builder.build(functions.at(name));
+        if (!function) {
+            std::cerr << "ERROR: Expected '" << name << "' to lower to the mid-level IR\n";
+            return false;
+        }
+        mir::optimize(*function);
+        const std::string text = function->toString();
+        auto contains = [&](std::string_view part) { return text.find(part) != std::string::npos; };
+        if (!std::ranges::all_of(present, contains) || std::ranges::any_of(absent, contains)) {
+            std::cerr << "ERROR: Unexpected mid-level IR for '" << name << "':\n" << text;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testSwitchExecution() {
+    // Dense and sparse switches, breaks out of a switch in a loop, and a parameter whose address is taken
+    const std::string source = "func dense(x: int32) -> int32 {\n"
+                               "    switch (x) {\n"
+                               "        case 0: return 3; case 1: return 5; case 2: return 7; case 3: return 7;\n"
+                               "        case 5: return 11; default: return 1;\n"
+                               "    }\n"
+                               "}\n"
+                               "func sparse(x: int64) -> int32 {\n"
+                               "    switch (x) { case 4000000000: return 2; case 3: return 4; default: return 6; }\n"
+                               "}\n"
+                               "func bump(p: ptr mut int32) -> int32 { (*p) = *p + 1; return (*p); }\n"
+                               "func total(n: mut int32, sum: mut int32) -> int32 {\n"
+                               "    while (n > 0) {\n"
+                               "        switch (n % 4) {\n"
+                               "            case 0: sum = sum + dense(n % 6);\n"
+                               "            case 1: break;\n"
+                               "            case 2: sum = sum - 1;\n"
+                               "            default: bump(&sum);\n"
+                               "        }\n"
+                               "        n = n - 1;\n"
+                               "    }\n"
+                               "    return sum;\n"
+                               "}\n"
+                               "public func main() -> int32 {\n"
+                               "    return total(10, 0) * 10 + sparse(4000000000) + sparse(3) * 100;\n"
+                               "}\n";
+    // n = 10..1: 10 -> 2: -1; 9 -> 1; 8 -> 0: dense(2) = 7; 7 -> 3: +1; 6 -> 2: -1; 5 -> 1; 4 -> 0: dense(4) = 1;
+    // 3 -> 3: +1; 2 -> 2: -1; 1 -> 1, so the total is 7
+    constexpr int expected = 7 * 10 + 2 + 4 * 100;
+    for (codegen::OptimizationLevel level : {codegen::OptimizationLevel::O0, codegen::OptimizationLevel::O2}) {
+        mnstl::chunk_allocator arena;
+        parser::Parser parser(source, lexer::Mode::String, arena);
+        parser::ParsedFile file = parser.parse();
+        std::ostringstream buffer;
+        std::optional<std::vector<std::string>> modules;
+        std::optional<int> exitCode;
+        {
+            logging::DiagnosticCapture capture(buffer);
+            semantic::analyzer analyzer(file, arena);
+            if (!file.hasError && analyzer.analyze() == Result::Success) {
+                modules = codegen::emitCode(file, "test", {.format = codegen::CodeFormat::Bitcode, .level = level});
+            }
+            if (modules) { exitCode = codegen::runMain(*modules, level); }
+        }
+        if (exitCode != expected) {
+            std::cerr << "ERROR: Expected the program to return " << expected << ", got "
+                      << (exitCode ? std::to_string(*exitCode) : "nothing") << ":\n" << buffer.str();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testUnsupportedCodeGeneration() {
+    // Constructs the analyzer doesn't type yet are reported rather than lowered
+    const std::string source = "func f() -> int32 { let x: int32 = 1; return 2; }\n";
+    llvm::LLVMContext context;
+    std::string diagnostics;
+    if (generateModule(source, context, diagnostics)
+        || diagnostics.find("Code generation for variable declarations is not supported yet") == std::string::npos) {
+        std::cerr << "ERROR: Expected the variable declaration to be reported, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+bool testPartitionedCodeGeneration() {
+    // Enough functions for four partitions, which call each other's, and one construct that can't be lowered
+    std::string source;
+    for (size_t i = 1; i <= 4 * codegen::MIN_FUNCTIONS_PER_PARTITION; ++i) {
+        source += std::format("func f{}(x: int32) -> int32 {{ return x + {}; }}\n", i, i);
+    }
+    source += "public func main() -> int32 { f1(2); f32(3); return 4; }\n";
+    const std::string broken = source + "func g() -> int32 { let x: int32 = 1; return 2; }\n";
+
+    // How many objects `text` lowers to with `threads` threads (0 if it can't be lowered), and what that reported
+    auto emit = [](const std::string& text, size_t threads, std::string& diagnostics) -> size_t {
+        mnstl::chunk_allocator arena;
+        parser::Parser parser(text, lexer::Mode::String, arena);
+        parser::ParsedFile file = parser.parse();
+        std::ostringstream buffer;
+        std::optional<std::vector<std::string>> objects;
+        {
+            logging::DiagnosticCapture capture(buffer);
+            semantic::analyzer analyzer(file, arena);
+            if (!file.hasError && analyzer.analyze() == Result::Success) {
+                objects = codegen::emitCode(file, "test",
+                                            {.format = codegen::CodeFormat::Object,
+                                             .level = codegen::OptimizationLevel::O1,
+                                             .threads = threads,
+                                             .privatePrefix = "t"});
+            }
+        }
+        diagnostics = buffer.str();
+        return objects && std::ranges::none_of(*objects, &std::string::empty) ? objects->size() : 0;
+    };
+
+    std::string diagnostics;
+    for (auto [threads, expected] : {std::pair<size_t, size_t>{1, 1}, {4, 4}, {16, 4}}) {
+        const size_t objects = emit(source, threads, diagnostics);
+        if (objects != expected) {
+            std::cerr << "ERROR: Expected " << expected << " objects with " << threads << " threads, got " << objects
+                      << ":\n" << diagnostics;
+            return false;
+        }
+    }
+    // Only the partition that defines g() reports it
+    std::string sequential;
+    if (emit(broken, 1, sequential) != 0 || emit(broken, 4, diagnostics) != 0 || diagnostics != sequential
+        || diagnostics.find("variable declarations") == std::string::npos) {
+        std::cerr << "ERROR: Expected the partitions to report g() once, as one partition does, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+void runCodeGenerationTests(TestRunner& runner) {
+    runner.runTest("IR Generation", testIRGeneration);
+    runner.runTest("IR Optimization", testIROptimization);
+    runner.runTest("Trapping Constants", testTrappingConstants);
+    runner.runTest("Mid-Level IR", testMidLevelIR);
+    runner.runTest("Switch Execution", testSwitchExecution);
+    runner.runTest("Unsupported Code Generation", testUnsupportedCodeGeneration);
+    runner.runTest("Partitioned Code Generation", testPartitionedCodeGeneration);
+}
+
+}  // namespace tests
+}  // namespace Manganese
@@ -0,0 +1,921 @@
+#include <algorithm>
+#include <array>
+#include <backend/codegen/optimizer.hpp>
+#include <chrono>
+#include <core.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <driver/document.hpp>
+#include <driver/driver.hpp>
+#include <driver/module_graph.hpp>
+#include <driver/options.hpp>
+#include <driver/server.hpp>
+#include <filesystem>
+#include <frontend/lexer.hpp>
+#include <frontend/parser/parser_base.hpp>
+#include <fstream>
+#include <io/diagnostics.hpp>
+#include <io/logging.hpp>
+#include <io/source_map.hpp>
+#include <iostream>
+#include <mnstl/chunk_allocator.hxx>
+#include <optional>
+#include <sstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <utils/time_report.hpp>
+#include <utils/trace.hpp>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+#include "testrunner.hpp"
+
+namespace Manganese {
+namespace tests {
+
+bool testDriverArguments() {
+    std::array arguments = {"a.mn", "-j", "4", "b.mn", "-j8", "--jobs=2", "--cache-dir", "cache", "-O2",
+                            "--module-dir=modules", "-o", "app", "--time-report", "--trace=build.json",
+                            "--diagnostic-format", "json", "c.mn"};
+    std::optional<driver::Options> options = driver::parseArguments(arguments);
+    if (!options || options->jobs != 2 || options->inputs != std::vector<std::string>{"a.mn", "b.mn", "c.mn"}
+        || options->cacheDirectory != "cache" || options->moduleDirectory != "modules" || options->output != "app"
+        || options->optimization != codegen::OptimizationLevel::O2 || !options->timeReport
+        || options->trace != "build.json" || options->diagnosticFormat != logging::DiagnosticFormat::Json) {
+        std::cerr << "ERROR: Options were not parsed as expected\n";
+        return false;
+    }
+
+    const std::array<std::vector<const char*>, 12> malformed = {{{"-jx"},
+                                                                {"a.mn", "--jobs"},
+                                                                {"--jobs=4x"},
+                                                                {"--unknown"},
+                                                                {"--cache-dir"},
+                                                                {"--cache-directory=x"},
+                                                                {"a.mn", "-o"},
+                                                                {"-O4"},
+                                                                {"--run", "-o", "app"},
+                                                                {"a.mn", "--trace"},
+                                                                {"--diagnostic-format=xml", "a.mn"},
+                                                                {"a.mn", "--diagnostic-format"}}};
+    for (const std::vector<const char*>& command : malformed) {
+        if (driver::parseArguments(command)) {
+            std::cerr << "ERROR: Expected '" << command.back() << "' to be rejected\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testDriverBuild() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_driver_tests";
+    std::filesystem::create_directories(directory);
+    const std::array<const char*, 4> sources = {
+        "let x: int32 = 1;\nlet y = x + 2;",
+        "let b: bool = true;\nlet c = !b;",
+        "let w: int32 = (1;",  // A parse error
+        "let z: float64 = 1.5;",
+    };
+
+    driver::Options options;
+    for (size_t i = 0; i < 24; ++i) {
+        std::filesystem::path path = directory / ("file" + std::to_string(i) + ".mn");
+        std::ofstream(path) << sources[i % sources.size()] << '\n';
+        options.inputs.push_back(path.string());
+    }
+    options.inputs.push_back((directory / "missing.mn").string());
+
+    std::vector<std::string> outputs;
+    for (size_t jobs : {1, 4, 16}) {
+        options.jobs = jobs;
+        std::ostringstream output;
+        std::vector<driver::FileResult> results = driver::Driver(options).compile(output);
+        if (results.size() != options.inputs.size()) {
+            std::cerr << "ERROR: Expected a result for every input\n";
+            return false;
+        }
+        for (size_t i = 0; i < results.size(); ++i) {
+            const bool shouldFail = i == results.size() - 1 || i % sources.size() == 2;
+            if (results[i].path != options.inputs[i] || (results[i].result == Result::Failure) != shouldFail) {
+                std::cerr << "ERROR: Unexpected result for " << options.inputs[i] << " with " << jobs << " jobs\n";
+                return false;
+            }
+        }
+        outputs.push_back(std::move(output).str());
+    }
+    std::filesystem::remove_all(directory);
+
+    std::cout << outputs.front();
+    for (const std::string& output : outputs) {
+        if (output != outputs.front()) {
+            std::cerr << "ERROR: Diagnostics depend on the number of jobs\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testModuleGraph() {
+    auto header = [](std::string name, std::vector<std::string> imports) {
+        parser::FileHeader result{.moduleName = std::move(name), .imports = {}, .hasError = false};
+        for (std::string& import : imports) {
+            result.imports.push_back(parser::Import{.path = {std::move(import), "item"}, .alias = ""});
+        }
+        return result;
+    };
+    const std::vector<parser::FileHeader> headers = {
+        header("app", {"net", "util", "io"}),  // io isn't an input, so it adds no edge
+        header("net", {"util"}),
+        header("util", {}),
+        header("a", {"b"}),
+        header("b", {"c"}),
+        header("c", {"a"}),
+        header("user", {"a"}),  // Depends on a cycle
+        header("self", {"self"}),
+        header("", {"util"}),
+        header("util", {}),  // Already declared
+    };
+    const driver::ModuleGraph graph(headers);
+
+    bool passed = true;
+    auto check = [&](bool condition, const char* message) {
+        if (!condition) {
+            std::cerr << "ERROR: " << message << '\n';
+            passed = false;
+        }
+    };
+    check(std::ranges::equal(graph.dependencies(0), std::array<size_t, 2>{1, 2}), "Wrong dependencies for 'app'");
+    check(std::ranges::equal(graph.dependents(2), std::array<size_t, 3>{0, 1, 8}), "Wrong dependents for 'util'");
+    for (size_t file : {3, 4, 5, 7}) { check(!graph.error(file).empty(), "Expected a cycle to be reported"); }
+    check(graph.error(3).find("a -> b -> c -> a") != std::string::npos, "Expected the cycle's path in the error");
+    check(graph.error(6).empty() && graph.error(8).empty(), "Only files in a cycle should have a cycle error");
+    check(!graph.error(9).empty(), "Expected a duplicate module declaration to be reported");
+
+    const std::vector<std::vector<size_t>> expected = {{2}, {1, 8}, {0}};
+    check(graph.waves() == expected, "Wrong waves");
+    return passed;
+}
+
+bool testDriverModuleOrder() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_module_tests";
+    std::filesystem::create_directories(directory);
+    const std::array<std::pair<const char*, const char*>, 7> sources = {{
+        {"app", "module app;\nimport lib;\nimport broken;\nlet x: int32 = 1;"},
+        {"lib", "module lib;\nimport base;\nlet y: int32 = 2;"},
+        {"base", "module base;\nlet z: int32 = 3;"},
+        {"broken", "module broken;\nlet w: int32 = (1;"},
+        {"loop", "module loop;\nimport loop;"},
+        {"ping", "module ping;\nimport pong;"},  // A cycle of two, each of which the other waits for
+        {"pong", "module pong;\nimport ping;"},
+    }};
+    driver::Options options{.inputs = {}, .jobs = 4, .moduleDirectory = {}, .cacheDirectory = {}, .output = {},
+                            .optimization = codegen::OptimizationLevel::O0, .run = false, .server = false,
+                            .serverSocket = {}, .timeReport = false, .trace = {},
+                            .diagnosticFormat = logging::DiagnosticFormat::Text, .showHelp = false};
+    for (const auto& [name, source] : sources) {
+        std::filesystem::path path = directory / (std::string(name) + ".mn");
+        std::ofstream(path) << source << '\n';
+        options.inputs.push_back(path.string());
+    }
+    const std::array<Result, 7> expected = {Result::Failure, Result::Success, Result::Success, Result::Failure,
+                                            Result::Failure, Result::Failure, Result::Failure};
+    bool passed = true;
+    for (size_t jobs : {size_t{1}, size_t{4}}) {
+        options.jobs = jobs;
+        std::ostringstream output;
+        std::vector<driver::FileResult> results = driver::Driver(options).compile(output);
+        std::cout << output.view();
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (results[i].result != expected[i]) {
+                std::cerr << "ERROR: Unexpected result for module '" << sources[i].first << "' with " << jobs
+                          << " jobs\n";
+                passed = false;
+            }
+        }
+        if (results[0].diagnostics.render().find("'broken'") == std::string::npos
+            || std::ranges::any_of(std::span(results).subspan(4), [](const driver::FileResult& result) {
+                   return result.diagnostics.render().find("import cycle") == std::string::npos;
+               })) {
+            std::cerr << "ERROR: Expected diagnostics for the failed import and the cycles\n";
+            passed = false;
+        }
+    }
+    std::filesystem::remove_all(directory);
+    return passed;
+}
+
+bool testDriverModuleInterfaces() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_interface_tests";
+    const std::filesystem::path interfaces = directory / "interfaces";
+    std::filesystem::create_directories(directory);
+    const std::string lib = (directory / "lib.mn").string(), app = (directory / "app.mn").string();
+    std::ofstream(lib) << "module lib;\npublic func add(a: int32, b: int32) -> int32 { return a; }\n";
+    auto writeApp = [&](const char* member) {
+        std::ofstream(app) << "module app;\nimport lib;\nfunc f() { lib::" << member << "; }\n";
+    };
+    auto build = [&](std::vector<std::string> inputs) {
+        std::ostringstream output;
+        driver::Options options{.inputs = std::move(inputs),
+                                .jobs = 2,
+                                .moduleDirectory = interfaces.string(),
+                                .cacheDirectory = {},
+                                .output = {},
+                                .optimization = codegen::OptimizationLevel::O0,
+                                .run = false,
+                                .server = false,
+                                .serverSocket = {},
+                                .timeReport = false,
+                                .trace = {},
+                                .diagnosticFormat = logging::DiagnosticFormat::Text,
+                                .showHelp = false};
+        std::vector<driver::FileResult> results = driver::Driver(options).compile(output);
+        std::cout << output.view();
+        return results;
+    };
+
+    bool passed = true;
+    auto check = [&](bool condition, const char* message) {
+        if (!condition) {
+            std::cerr << "ERROR: " << message << '\n';
+            passed = false;
+        }
+    };
+    writeApp("add");
+    std::vector<driver::FileResult> results = build({lib, app});
+    const std::filesystem::path libInterface = interfaces / "lib.mni";
+    check(results[0].result == Result::Success && results[1].result == Result::Success, "Expected both to compile");
+    check(std::filesystem::exists(libInterface) && std::filesystem::exists(interfaces / "app.mni"),
+          "Expected an interface for each module");
+    const std::filesystem::file_time_type written = std::filesystem::last_write_time(libInterface);
+
+    // Nothing changed, so lib's interface is reused rather than rewritten
+    results = build({lib, app});
+    check(results[0].result == Result::Success && results[0].interface
+              && std::filesystem::last_write_time(libInterface) == written,
+          "Expected lib's interface to be reused");
+
+    // lib isn't an input this time, so its members come from the interface it left behind
+    writeApp("missing");
+    results = build({app});
+    check(results[0].result == Result::Failure
+              && results[0].diagnostics.render().find("no public member 'missing'") != std::string::npos,
+          "Expected lib::missing to be checked against lib's interface");
+
+    std::filesystem::remove_all(directory);
+    return passed;
+}
+
+bool testDriverGenericImports() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_generic_import_tests";
+    std::filesystem::create_directories(directory);
+    // `first` and `second` each specialize lib's templates themselves. app then passes what one returns to the other,
+    // which only checks if both (and app, which specializes Box@[int32] too) ended up with the same type
+    std::ofstream(directory / "lib.mn") << "module lib;\n"
+                                           "public aggregate Box[T] { value: T; }\n"
+                                           "public func pick[T](a: T, b: T) -> T { return a; }\n";
+    std::ofstream(directory / "first.mn") << "module first;\nimport lib;\n"
+                                             "public func unwrap(box: lib::Box@[int32]) -> int32 {\n"
+                                             "    return lib::pick@[int32](box.value, 2);\n"
+                                             "}\n";
+    std::ofstream(directory / "second.mn") << "module second;\nimport lib;\n"
+                                              "public func pass(box: lib::Box@[int32]) -> lib::Box@[int32] {\n"
+                                              "    return box;\n"
+                                              "}\n";
+    std::ofstream(directory / "app.mn") << "module app;\nimport lib;\nimport first;\nimport second;\n"
+                                           "func f(box: lib::Box@[int32]) -> int32 {\n"
+                                           "    return first::unwrap(second::pass(box));\n"
+                                           "}\n";
+    std::ofstream(directory / "misuse.mn") << "module misuse;\nimport lib;\n"
+                                              "func f(a: lib::Box@[int32, bool], b: lib::Box, c: lib::missing@[int32]) {}\n";
+    driver::Options options{.inputs = {(directory / "app.mn").string(), (directory / "second.mn").string(),
+                                       (directory / "first.mn").string(), (directory / "lib.mn").string(),
+                                       (directory / "misuse.mn").string()},
+                            .jobs = 2,
+                            .moduleDirectory = {},
+                            .cacheDirectory = {},
+                            .output = {},
+                            .optimization = codegen::OptimizationLevel::O0,
+                            .run = false,
+                            .server = false,
+                            .serverSocket = {},
+                            .timeReport = false,
+                            .trace = {},
+                            .diagnosticFormat = logging::DiagnosticFormat::Text,
+                            .showHelp = false};
+    std::ostringstream output;
+    const std::vector<driver::FileResult> results = driver::Driver(options).compile(output);
+    std::filesystem::remove_all(directory);
+    std::cout << output.view();
+
+    if (std::ranges::any_of(results.begin(), results.begin() + 4,
+                            [](const driver::FileResult& file) { return file.result != Result::Success; })) {
+        std::cerr << "ERROR: Expected every importer to get the same Box@[int32]\n";
+        return false;
+    }
+    const std::string misuse = results[4].diagnostics.render();
+    if (misuse.find("'lib::Box' takes 1 type argument, but was given 2") == std::string::npos
+        || misuse.find("'lib::Box' is generic, so needs 1 type argument") == std::string::npos
+        || misuse.find("Module 'lib' has no public member 'missing'") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for misusing lib's templates, got:\n" << misuse;
+        return false;
+    }
+    return true;
+}
+
+bool testDriverBuildCache() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_cache_tests";
+    std::filesystem::create_directories(directory);
+    auto write = [&](const char* name, const char* source) {
+        std::ofstream(directory / name) << source << '\n';
+        return (directory / name).string();
+    };
+    const std::vector<std::string> inputs = {
+        write("base.mn", "module base;\npublic func one() -> int32 { return 1; }"),
+        write("user.mn", "module user;\nimport base;\nfunc f() { base::one; }"),
+        write("broken.mn", "let w: int32 = (1;"),
+        write("plain.mn", "let b: bool = true;\nlet c = !b;"),
+    };
+    // Each build gets a fresh driver, as a separate run of the compiler would
+    auto build = [&](std::string& output) {
+        driver::Options options{.inputs = inputs,
+                                .jobs = 2,
+                                .moduleDirectory = {},
+                                .cacheDirectory = (directory / "cache").string(),
+                                .output = {},
+                                .optimization = codegen::OptimizationLevel::O0,
+                                .run = false,
+                                .server = false,
+                                .serverSocket = {},
+                                .timeReport = false,
+                                .trace = {},
+                                .diagnosticFormat = logging::DiagnosticFormat::Text,
+                                .showHelp = false};
+        driver::Driver driver(options);
+        std::ostringstream stream;
+        std::vector<driver::FileResult> results = driver.compile(stream);
+        output = stream.str();
+        std::cout << output;
+        return std::pair{std::move(results), driver.cacheStatistics()};
+    };
+
+    bool passed = true;
+    auto check = [&](bool condition, const char* message) {
+        if (!condition) {
+            std::cerr << "ERROR: " << message << '\n';
+            passed = false;
+        }
+    };
+    std::string first, second, third;
+    const auto [firstResults, cold] = build(first);
+    check(cold.hits == 0 && cold.misses == 4, "Expected every file to miss a cold cache");
+    const auto [secondResults, warm] = build(second);
+    check(warm.hits == 4 && warm.misses == 0, "Expected every file to hit a warm cache");
+    check(second == first && secondResults[2].result == Result::Failure && secondResults[1].interface,
+          "A hit should reproduce the file's result, diagnostics and interface");
+
+    // A change to base changes the key of everything that imports it too
+    write("base.mn", "module base;\npublic func one() -> int32 { return 2; }");
+    const auto [thirdResults, changed] = build(third);
+    check(changed.hits == 2 && changed.misses == 2, "Expected only base and user to miss after base changed");
+
+    std::filesystem::remove_all(directory);
+    return passed;
+}
+
+bool testCompileServer() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_server_tests";
+    std::filesystem::create_directories(directory);
+    const std::string lib = (directory / "lib.mn").string(), app = (directory / "app.mn").string();
+    std::ofstream(lib) << "module lib;\npublic func one() -> int32 { return 1; }\n";
+    std::ofstream(app) << "module app;\nimport lib;\nfunc f() { lib::missing; }\n";
+
+    // lib is only compiled by the first request, so the second can only check lib::missing against the interface the
+    // server kept from it. Once lib changes (between sessions), that interface is out of date, so isn't used again
+    std::istringstream requests(lib + "\n" + "-j\t2\t" + app + "\n--jobs=x\n");
+    std::ostringstream responses;
+    driver::Server server;
+    bool keepServing = server.serve(requests, responses);
+    std::ofstream(lib, std::ios::trunc) << "module lib;\npublic func missing() -> int32 { return 1; }\n";
+    std::istringstream laterRequests(app + "\n--shutdown\n" + lib + "\n");
+    keepServing = keepServing && server.serve(laterRequests, responses);
+    std::filesystem::remove_all(directory);
+
+    std::istringstream in(responses.str());
+    std::vector<std::pair<int, std::string>> answers;
+    int exitCode;
+    size_t size;
+    while (in >> exitCode >> size && in.get() == '\n') {
+        std::string output(size, '\0');
+        in.read(output.data(), static_cast<std::streamsize>(size));
+        answers.emplace_back(exitCode, std::move(output));
+    }
+    std::cout << responses.view();
+    if (keepServing || answers.size() != 5) {
+        std::cerr << "ERROR: Expected five responses, with the server stopping at the shutdown request\n";
+        return false;
+    }
+    if (answers[0].first != 0 || answers[1].first != 1 || answers[2].first != 2 || answers[3].first != 0
+        || answers[4].first != 0 || answers[1].second.find("no public member 'missing'") == std::string::npos
+        || answers[2].second.find("Invalid number of jobs") == std::string::npos) {
+        std::cerr << "ERROR: Unexpected responses from the server\n";
+        return false;
+    }
+    return true;
+}
+
+bool testIncrementalDocument() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "manganese_document_test.mn";
+    driver::Document document("module doc;\n"
+                              "func one() -> int32 { return 1; }\n"
+                              "func two() -> int32 { return 2; }\n"
+                              "func three() -> bool { return 3; }\n"
+                              "func four() -> int32 { return 4; }\n");
+    bool passed = true;
+    auto check = [&](bool condition, const char* message) {
+        if (!condition) {
+            std::cerr << "ERROR: " << message << '\n';
+            passed = false;
+        }
+    };
+    // Whatever has been reused, the document should report what compiling its text from scratch does
+    auto matchesCompile = [&](const char* step) {
+        std::ofstream(path, std::ios::trunc) << document.source();
+        mnstl::chunk_allocator arena;
+        const driver::FileResult compiled = driver::compileFile(path.string(), arena);
+        std::cout << document.diagnostics().render();
+        if (compiled.diagnostics != document.diagnostics() || compiled.result != document.result()) {
+            std::cerr << "ERROR: The document's diagnostics differ from a compile's after " << step << ":\n"
+                      << compiled.diagnostics.render();
+            passed = false;
+        }
+    };
+    auto edit = [&](std::string_view find, std::string_view replacement) {
+        const size_t offset = document.source().find(find);
+        document.edit({.offset = offset, .length = find.size(), .text = replacement});
+    };
+    matchesCompile("opening the document");
+
+    // Only `three` changes (`two`, before it, is reparsed too, but its text hasn't changed)
+    edit("return 3", "return true");
+    driver::Document::Statistics statistics = document.statistics();
+    check(statistics.fullParses == 1 && statistics.reparsedStatements == 1 && statistics.reusedStatements == 3,
+          "Expected only the edited statement to be reparsed");
+    check(statistics.checkedFunctions == 5 && statistics.reusedChecks == 3,
+          "Expected only the edited function to be checked again");
+    matchesCompile("editing a function body");
+
+    // `four` refers to `one`, so changing `one` checks both again
+    edit("return 4", "return one");
+    edit("func one() -> int32", "func one() -> bool");
+    statistics = document.statistics();
+    check(statistics.checkedFunctions == 8, "Expected a function to be checked again when what it refers to changes");
+    matchesCompile("editing a function another refers to");
+
+    // A syntax error stops analysis until it is fixed, and is reparsed along with the next edit (wherever it is)
+    edit("return 2;", "return (2;");
+    check(document.result() == Result::Failure, "Expected a syntax error");
+    matchesCompile("introducing a syntax error");
+    edit("func four", "\n\nfunc four");
+    matchesCompile("an edit after the syntax error");
+    edit("return (2;", "return 2;");
+    check(document.diagnostics().render().find("right parenthesis") == std::string::npos,
+          "Expected the syntax error to be gone");
+    matchesCompile("fixing the syntax error");
+
+    // `four` keeps its AST while lines are added before it, and is checked again since it refers to `one`
+    edit("func one() -> bool {", "func one() -> bool {\n\n   ");
+    matchesCompile("moving a statement that is checked again");
+
+    // The header is always reparsed with the rest of the file
+    edit("module doc;", "module document;");
+    check(document.statistics().fullParses == 2, "Expected an edit to the header to parse the whole file again");
+    matchesCompile("editing the header");
+    std::filesystem::remove(path);
+    return passed;
+}
+
+bool testSourceScope() {
+    // Compiling a file removes the sources it registered, so a scope around it has nothing left to remove
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "manganese_source_scope_test.mn";
+    std::ofstream(path) << "func f() -> int32 { return 1; }\n";
+    io::SourceScope scope;
+    mnstl::chunk_allocator arena;
+    const driver::FileResult compiled = driver::compileFile(path.string(), arena);
+    std::filesystem::remove(path);
+    if (compiled.result != Result::Success || scope.size() != 0) {
+        std::cerr << "ERROR: Expected compiling a file to remove its sources from the source map\n";
+        return false;
+    }
+    {
+        lexer::Lexer lexer("func f() {}", lexer::Mode::String);
+        DISCARD(lexer.tokenizeAll());
+    }
+    if (scope.size() != 1) {
+        std::cerr << "ERROR: Expected the scope to track the lexer's source\n";
+        return false;
+    }
+    return true;
+}
+
+bool testSourceMapRemoval() {
+    // A location that outlives its source mustn't resolve to the lines of a source added after it was removed
+    io::SourceMap map;
+    const uint32_t removed = map.addSource("a\nb\nc\n");
+    const io::SourceLocation stale{.source = removed, .offset = 4};
+    if (map.resolve(stale).line != 3) {
+        std::cerr << "ERROR: Expected the location to resolve while its source is registered\n";
+        return false;
+    }
+    map.remove(removed);
+    const uint32_t added = map.addSource("first line\nsecond line\nthird line\n");
+    const io::LineColumn position = map.resolve(stale);
+    if (added == removed || position.line != 0 || position.column != 0) {
+        std::cerr << "ERROR: A location in a removed source resolved to " << position.line << ':' << position.column
+                  << " after another source was added\n";
+        return false;
+    }
+    if (map.sourceCount() != 1) {
+        std::cerr << "ERROR: Expected one source to be left registered, not " << map.sourceCount() << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool testSourceMapEdits() {
+    // A table that follows edits should resolve every offset as one built from the edited text does
+    std::string text = "first\nsecond line\n\nfourth\n";
+    io::LineTable lines(text);
+    DISCARD(lines.resolve(0));  // Build it, so that edits shift its lines
+    const struct {
+        size_t offset, length;
+        std::string_view inserted;
+    } edits[] = {{3, 0, "\n\n"}, {0, 9, "x"}, {5, 4, "a\nb"}, {0, 0, "\n"}, {4, 10, ""}};
+    for (const auto& edit : edits) {
+        text.replace(edit.offset, edit.length, edit.inserted);
+        lines.edit(text, edit.offset, edit.length, edit.inserted);
+        io::LineTable fresh(text);
+        for (uint32_t offset = 0; offset <= text.size(); ++offset) {
+            const io::LineColumn edited = lines.resolve(offset), expected = fresh.resolve(offset);
+            if (edited.line != expected.line || edited.column != expected.column) {
+                std::cerr << "ERROR: Offset " << offset << " resolved to " << edited.line << ':' << edited.column
+                          << " after an edit, rather than " << expected.line << ':' << expected.column << '\n';
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool testServerHangUp() {
+#if defined(_WIN32)
+    return true;  // Serving on a socket isn't supported there
+#else
+    const std::string path = (std::filesystem::temp_directory_path() / "manganese_hang_up_test.sock").string();
+    driver::Server server;
+    int exitCode = -1;
+    std::jthread serving([&]() { exitCode = server.listen(path); });
+    // Connect once the server is listening, and send a request
+    auto request = [&](std::string_view line) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        for (int attempt = 0; ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0;
+             ++attempt) {
+            if (attempt == 500) { return -1; }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        DISCARD(::write(fd, line.data(), line.size()));
+        return fd;
+    };
+
+    // A client hangs up without reading its reply, which the server mustn't die of (SIGPIPE would end the whole test
+    // binary). It is queued behind a session that is still open, so it is gone by the time the server answers it
+    const int blocking = request("");
+    const int early = request("--jobs=x\n");
+    if (early >= 0) { ::close(early); }
+    if (blocking >= 0) { ::close(blocking); }
+    const int later = request("--shutdown\n");
+    std::string reply;
+    if (later >= 0) {
+        char buffer[64];
+        for (ssize_t count; (count = ::read(later, buffer, sizeof(buffer))) > 0;) {
+            reply.append(buffer, static_cast<size_t>(count));
+        }
+        ::close(later);
+    }
+    serving.join();
+    if (blocking < 0 || early < 0 || later < 0 || reply != "0 0\n" || exitCode != 0 || std::filesystem::exists(path)) {
+        std::cerr << "ERROR: Expected the server to keep serving after a client hung up, then shut down cleanly\n";
+        return false;
+    }
+    return true;
+#endif  // _WIN32
+}
+
+bool testDriverExecutable() {
+#if defined(_WIN32)
+    return true;  // Linking isn't supported there yet
+#else
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_executable_tests";
+    std::filesystem::create_directories(directory);
+    // main() calls private functions in its own file, and `big` has enough functions to be split into partitions
+    // (which call each other's). Both files have a private `step`, which mustn't clash
+    std::ofstream(directory / "main.mn") << "func step(x: int32) -> int32 { return x + 1; }\n"
+                                            "public func sum(n: mut int32, total: mut int32) -> int32 {\n"
+                                            "    while (n > 1) { total = total + n; n = n - 1; }\n"
+                                            "    return total;\n"
+                                            "}\n"
+                                            "public func main() -> int32 { step(1); sum(4, 1); return 42; }\n";
+    {
+        std::ofstream big(directory / "big.mn");
+        for (int i = 1; i <= 40; ++i) { big << "func f" << i << "(x: int32) -> int32 { return x + " << i << "; }\n"; }
+        big << "func step(x: int32) -> int32 { return x; }\n";
+        big << "public func entry() -> int32 { f1(1); f40(2); step(3); return 5; }\n";
+    }
+
+    bool passed = true;
+    for (size_t jobs : {1, 8}) {
+        for (codegen::OptimizationLevel level : {codegen::OptimizationLevel::O0, codegen::OptimizationLevel::O2}) {
+            const std::string executable = (directory / "app").string();
+            driver::Options options{.inputs = {(directory / "main.mn").string(), (directory / "big.mn").string()},
+                                    .jobs = jobs,
+                                    .moduleDirectory = {},
+                                    .cacheDirectory = {},
+                                    .output = executable,
+                                    .optimization = level,
+                                    .run = false,
+                                    .server = false,
+                                    .serverSocket = {},
+                                    .timeReport = false,
+                                    .trace = {},
+                                    .diagnosticFormat = logging::DiagnosticFormat::Text,
+                                    .showHelp = false};
+            std::ostringstream output;
+            const int exitCode = driver::Driver(options).run(output);
+            std::cout << output.view();
+            const int status = exitCode == 0 ? std::system(executable.c_str()) : -1;
+            if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 42) {
+                std::cerr << "ERROR: Expected an executable that exits with 42 (with " << jobs << " jobs)\n";
+                passed = false;
+            }
+            std::filesystem::remove(executable);
+        }
+    }
+    std::filesystem::remove_all(directory);
+    return passed;
+#endif  // _WIN32
+}
+
+bool testDriverRun() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_run_tests";
+    std::filesystem::create_directories(directory);
+    const std::string program = (directory / "main.mn").string(), library = (directory / "library.mn").string();
+    std::ofstream(program) << "func count(n: mut int32, steps: mut int32) -> int32 {\n"
+                              "    while (n > 1) {\n"
+                              "        if (n % 2 == 1) { n = 3 * n + 1; } else { n = n // 2; }\n"
+                              "        steps = steps + 1;\n"
+                              "    }\n"
+                              "    return steps;\n"
+                              "}\n"
+                              "public func main() -> int32 { count(27, 1); return 17; }\n";
+    // Never called, so never compiled
+    std::ofstream(library) << "public func unused(x: float64) -> float64 { return x // 2.5; }\n";
+
+    auto run = [&](std::vector<std::string> inputs, codegen::OptimizationLevel level, std::string& output) {
+        driver::Options options{.inputs = std::move(inputs),
+                                .jobs = 2,
+                                .moduleDirectory = {},
+                                .cacheDirectory = {},
+                                .output = {},
+                                .optimization = level,
+                                .run = true,
+                                .server = false,
+                                .serverSocket = {},
+                                .timeReport = false,
+                                .trace = {},
+                                .diagnosticFormat = logging::DiagnosticFormat::Text,
+                                .showHelp = false};
+        std::ostringstream stream;
+        const int exitCode = driver::Driver(options).run(stream);
+        output = std::move(stream).str();
+        std::cout << output;
+        return exitCode;
+    };
+
+    bool passed = true;
+    std::string output;
+    for (codegen::OptimizationLevel level : {codegen::OptimizationLevel::O0, codegen::OptimizationLevel::O3}) {
+        if (run({program, library}, level, output) != 17) {
+            std::cerr << "ERROR: Expected the program to exit with what main() returns\n";
+            passed = false;
+        }
+    }
+    if (run({library}, codegen::OptimizationLevel::O0, output) != 1 || output.find("no main()") == std::string::npos) {
+        std::cerr << "ERROR: Expected a program without main() to be reported\n";
+        passed = false;
+    }
+    std::filesystem::remove_all(directory);
+    return passed;
+}
+
+bool testTimeReport() {
+    // Timing stays on for the rest of the tests, which (since it only counts) doesn't change what they do
+    if (!timing::enable()) {
+        std::cout << "Skipping the time report test: this build was configured without TIME_REPORT\n";
+        return true;
+    }
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "manganese_time_report.mn";
+    // The second pointer type is found in the type context's cache, and Box@[int32] is specialized
+    std::ofstream(path) << "aggregate Box[T] { value: T; }\n"
+                           "func f(a: int32, p: ptr int32, q: ptr int32, b: Box@[int32]) -> int32 {\n"
+                           "    if (a > 1) { return a * 2; }\n"
+                           "    return a;\n"
+                           "}\n";
+    mnstl::chunk_allocator arena;
+    const driver::FileResult result = driver::compileFile(path.string(), arena);
+    std::filesystem::remove(path);
+    std::ostringstream report;
+    timing::printReport(report, std::chrono::seconds(1));
+    std::cout << report.view();
+
+    bool passed = result.result == Result::Success;
+    for (const char* name : timing::PHASE_NAMES) { passed = passed && report.view().find(name) != std::string::npos; }
+    // Every phase ran and every counter counted something (the report lists them in the same order as the enums)
+    for (const char* name : timing::COUNTER_NAMES) {
+        const size_t line = report.view().find(std::string("  ") + name);
+        const size_t end = report.view().find('\n', line);
+        passed = passed && line != std::string::npos && report.view().substr(end - 2, 2) != " 0";
+    }
+    if (!passed) { std::cerr << "ERROR: Expected every phase to be timed and every counter to be counted\n"; }
+    return passed;
+}
+
+bool testTrace() {
+    // Tracing stays on for the rest of the tests, which only adds to the events kept in memory
+    trace::enable();
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_trace_tests";
+    std::filesystem::create_directories(directory);
+    driver::Options options{.inputs = {}, .jobs = 2, .moduleDirectory = {}, .cacheDirectory = {}, .output = {},
+                            .optimization = codegen::OptimizationLevel::O0, .run = false, .server = false,
+                            .serverSocket = {}, .timeReport = false, .trace = {},
+                            .diagnosticFormat = logging::DiagnosticFormat::Text, .showHelp = false};
+    for (size_t i = 0; i < 4; ++i) {
+        const std::filesystem::path path = directory / std::format("\"file\" {}.mn", i);  // Quotes to escape
+        std::ofstream(path) << "func f(a: int32) -> int32 { return a; }\n";
+        options.inputs.push_back(path.string());
+    }
+    std::ostringstream output;
+    const std::vector<driver::FileResult> results = driver::Driver(options).compile(output);
+    const std::string tracePath = (directory / "trace.json").string();
+    const Result written = trace::write(tracePath);
+    std::ifstream file(tracePath);
+    const std::string json{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    std::filesystem::remove_all(directory);
+
+    bool passed = written == Result::Success && json.starts_with("{\"displayTimeUnit\"") && json.ends_with("]}\n");
+    for (const std::string& input : options.inputs) {
+        std::string escaped;
+        for (char c : input) { escaped += c == '"' ? std::string("\\\"") : std::string(1, c); }
+        // Each input gets a compile event (one per line), naming the file with its quotes escaped
+        const std::string fileArgument = std::format(R"("file": "{}")", escaped);
+        std::istringstream lines(json);
+        bool compiled = false;
+        for (std::string line; std::getline(lines, line);) {
+            compiled = compiled
+                       || (line.starts_with(R"({"name": "compile")") && line.find(fileArgument) != std::string::npos);
+        }
+        passed = passed && compiled;
+    }
+    for (const char* phase : {"\"header scan\"", "\"parse\"", "\"analyze\"", "\"thread_name\""}) {
+        passed = passed && json.find(phase) != std::string::npos;
+    }
+    if (!passed) { std::cerr << "ERROR: Expected a trace of every file's phases\n"; }
+    return passed
+           && std::ranges::all_of(results, [](const driver::FileResult& r) { return r.result == Result::Success; });
+}
+
+bool testDiagnosticLocations() {
+    // A diagnostic keeps its location until it is written out or resolved, so moving it follows its text
+    const uint32_t source = io::sourceMap().addSource("one\ntwo\nthree\n");
+    logging::DiagnosticList list;
+    list.add({.level = logging::LogLevel::Error,
+              .location = {.source = source, .offset = 8},
+              .line = logging::NO_POSITION,
+              .column = logging::NO_POSITION,
+              .message = "here"});
+    bool passed = list.render().find("(line 3, column 1)") != std::string::npos;
+    list.shift(-4);
+    passed = passed && list.render().find("(line 2, column 1)") != std::string::npos;
+
+    // Once resolved, it no longer needs its source
+    logging::DiagnosticList resolved = list;
+    resolved.resolve();
+    io::sourceMap().remove(source);
+    std::cout << resolved.render() << list.render();
+    passed = passed && resolved.render().find("(line 2, column 1)") != std::string::npos
+             && list.render().find("(line") == std::string::npos;
+    if (!passed) { std::cerr << "ERROR: Expected diagnostics to resolve their locations when written out\n"; }
+    return passed;
+}
+
+bool testJsonDiagnostics() {
+    // Sorted by place (those about no place in particular last), with the duplicate dropped
+    logging::DiagnosticList list;
+    list.add({.level = logging::LogLevel::Error, .location = {}, .line = logging::NO_POSITION,
+              .column = logging::NO_POSITION, .message = "no place"});
+    list.add({.level = logging::LogLevel::Error, .location = {}, .line = 4, .column = 2, .message = "later"});
+    list.add({.level = logging::LogLevel::Warning, .location = {}, .line = 1, .column = 9, .message = "earlier"});
+    list.add({.level = logging::LogLevel::Error, .location = {}, .line = 4, .column = 2, .message = "later"});
+    list.add({.level = logging::LogLevel::Error, .location = {}, .line = 4, .column = 2, .message = "same place"});
+    list.sort();
+    std::vector<std::string> order;
+    for (const logging::Diagnostic& diagnostic : list) { order.push_back(diagnostic.message); }
+    if (order != std::vector<std::string>{"earlier", "later", "same place", "no place"}) {
+        std::cerr << "ERROR: Expected the diagnostics in order of place, without duplicates\n";
+        return false;
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "manganese_json_tests";
+    std::filesystem::create_directories(directory);
+    const std::string path = (directory / "quote\".mn").string();
+    std::ofstream(path) << "func f() -> int32 {\n    return missing;\n}\nfunc g() -> int32 { return 0; }\n";
+    driver::Options options{.inputs = {path, (directory / "absent.mn").string()}, .jobs = 2, .moduleDirectory = {},
+                            .cacheDirectory = {}, .output = {}, .optimization = codegen::OptimizationLevel::O0,
+                            .run = false, .server = false, .serverSocket = {}, .timeReport = false, .trace = {},
+                            .diagnosticFormat = logging::DiagnosticFormat::Json, .showHelp = false};
+    std::ostringstream output;
+    driver::Driver driver(options);
+    const std::vector<driver::FileResult> results = driver.compile(output);
+    const int exitCode = driver.summarize(results, output);
+    std::filesystem::remove_all(directory);
+    std::cout << output.view();
+
+    // Everything written is the one document (no colors or summary), naming each file with its quotes escaped
+    const std::string_view json = output.view();
+    std::string escaped;
+    for (char c : path) { escaped += c == '"' ? std::string("\\\"") : std::string(1, c); }
+    bool passed = exitCode == 1 && json.starts_with(R"({"files": [)") && json.ends_with("]}\n")
+                  && json.find('\033') == std::string_view::npos;
+    const std::array<std::string, 5> expected = {std::format(R"({{"path": "{}", "result": "failure")", escaped),
+                                                 R"("level": "error")", "Identifier 'missing' was not found",
+                                                 R"({"level": "warning", "line": 4, "column": 28, "message": )",
+                                                 R"(absent.mn", "result": "failure")"};
+    for (const std::string& part : expected) { passed = passed && json.find(part) != std::string_view::npos; }
+    if (!passed) { std::cerr << "ERROR: Expected every file's diagnostics in one JSON document\n"; }
+    return passed;
+}
+
+bool testInternalLogging() {
+    size_t evaluated = 0;
+    auto describe = [&]() {
+        ++evaluated;
+        return std::string("an argument");
+    };
+    logging::setInternalLogLevel(logging::LogLevel::Error);
+    LOG_INTERNAL(Warning, "Skipped at runtime, so {} is never evaluated", describe());
+    logging::setInternalLogLevel(logging::LogLevel::Info);
+    LOG_INTERNAL(Info, "Logged (if this build compiles info messages in), evaluating {}", describe());
+    // Compiled out, the arguments aren't evaluated at all
+    const size_t expected = logging::isInternalLogCompiled(logging::LogLevel::Info) ? 1 : 0;
+    if (evaluated != expected) {
+        std::cerr << "ERROR: Expected only the logged message's arguments to be evaluated\n";
+        return false;
+    }
+    return true;
+}
+
+void runDriverTests(TestRunner& runner) {
+    runner.runTest("Driver Arguments", testDriverArguments);
+    runner.runTest("Driver Build", testDriverBuild);
+    runner.runTest("Module Graph", testModuleGraph);
+    runner.runTest("Driver Module Order", testDriverModuleOrder);
+    runner.runTest("Driver Module Interfaces", testDriverModuleInterfaces);
+    runner.runTest("Driver Generic Imports", testDriverGenericImports);
+    runner.runTest("Driver Build Cache", testDriverBuildCache);
+    runner.runTest("Driver Executable", testDriverExecutable);
+    runner.runTest("Driver Run", testDriverRun);
+    runner.runTest("Compile Server", testCompileServer);
+    runner.runTest("Server Hang Up", testServerHangUp);
+    runner.runTest("Incremental Document", testIncrementalDocument);
+    runner.runTest("Source Map Edits", testSourceMapEdits);
+    runner.runTest("Source Scope", testSourceScope);
+    runner.runTest("Source Map Removal", testSourceMapRemoval);
+    runner.runTest("Time Report", testTimeReport);
+    runner.runTest("Trace", testTrace);
+    runner.runTest("Diagnostic Locations", testDiagnosticLocations);
+    runner.runTest("JSON Diagnostics", testJsonDiagnostics);
+    runner.runTest("Internal Logging", testInternalLogging);
+}
+
+}  // namespace tests
+}  // namespace Manganese
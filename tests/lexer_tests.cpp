@@ -1,9 +1,14 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <core.hpp>
 #include <filesystem>
 #include <frontend/lexer.hpp>
+#include <fstream>
 #include <io/logging.hpp>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,8 +34,12 @@ inline void printAllTokens(const std::vector<Token>& tokens, bool verbose = true
     std::cout << RESET << '\n';
 }
 
+// Token lexemes view storage owned by their lexer, so the lexers are kept alive for as long as the tokens are checked
+// (one list per thread, since tests run at the same time)
+thread_local std::vector<std::unique_ptr<lexer::Lexer>> testLexers;
+
 std::vector<Token> tokensFromString(const std::string& source) {
-    lexer::Lexer lexer(source, lexer::Mode::String);
+    lexer::Lexer& lexer = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(source, lexer::Mode::String));
     std::vector<Token> tokens;
 
     // Consume tokens until we hit EOF
@@ -45,7 +54,8 @@ std::vector<Token> tokensFromString(const std::string& source) {
 
 std::vector<Token> tokensFromFile(const std::filesystem::path& filename) {
     std::filesystem::path fullPath = std::filesystem::current_path() / filename;
-    lexer::Lexer lexer(fullPath.string(), lexer::Mode::File);
+    lexer::Lexer& lexer
+        = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(fullPath.string(), lexer::Mode::File));
     std::vector<Token> tokens;
 
     // Consume tokens until we hit EOF
@@ -108,6 +118,93 @@ bool testIdentifiers() {
         && checkToken(tokens[4], TokenType::Identifier, "var123");
 }
 
+bool testIdentifierInterning() {
+    std::vector<Token> tokens = tokensFromString("foo bar foo let");
+    printAllTokens(tokens);
+    if (tokens.size() != 4) {
+        std::cout << "Expected 4 tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    if (tokens[0].getAtom() != tokens[2].getAtom() || tokens[0].getAtom() == tokens[1].getAtom()) {
+        std::cout << "Expected identical identifiers (and only identical identifiers) to share an atom" << '\n';
+        return false;
+    }
+    if (lexer::identifierPool().view(tokens[1].getAtom()) != "bar") {
+        std::cout << "Expected atom " << tokens[1].getAtom() << " to name 'bar'" << '\n';
+        return false;
+    }
+    // Keywords aren't interned
+    return tokens[3].getAtom() == mnstl::string_pool::invalid_atom;
+}
+
+bool testLongRuns() {
+    // Runs longer than a vector register, and ones that end part way through one, to exercise the scanning kernels
+    const std::string identifier = "a_very_long_identifier_that_spans_several_vector_registers_0123456789";
+    const std::string body = "a string body that is longer than a vector register";
+    std::vector<Token> tokens = tokensFromString(std::string(70, ' ') + identifier + std::string(33, '\n') + "\""
+                                                 + body + "\\n\" x # a comment that is also quite long indeed\ny");
+    printAllTokens(tokens);
+    if (tokens.size() != 4) {
+        std::cout << "Expected 4 tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    if (tokens[0].getLine() != 1 || tokens[0].getColumn() != 71 || tokens[3].getLine() != 35) {
+        std::cout << "Token positions were not tracked correctly across long runs" << '\n';
+        return false;
+    }
+    return checkToken(tokens[0], TokenType::Identifier, identifier)
+        && checkToken(tokens[1], TokenType::StrLiteral, body + "\n")
+        && checkToken(tokens[2], TokenType::Identifier, "x") && checkToken(tokens[3], TokenType::Identifier, "y");
+}
+
+bool testLookahead() {
+    // Look further ahead than a single refill, with a buffer that has to wrap around several times
+    std::string source;
+    for (int i = 0; i < 100; ++i) { source += "t" + std::to_string(i) + " "; }
+    lexer::Lexer& lexer = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(source, lexer::Mode::String, 4));
+    for (int i = 0; i < 100; ++i) {
+        const size_t ahead = std::min<size_t>(20, static_cast<size_t>(99 - i));
+        const Token& peeked = lexer.peekToken(ahead);
+        if (peeked.getLexeme() != "t" + std::to_string(static_cast<size_t>(i) + ahead)) {
+            std::cout << "Looking " << ahead << " tokens ahead of token " << i << " gave " << peeked.toString() << '\n';
+            return false;
+        }
+        if (!checkToken(lexer.consumeToken(), TokenType::Identifier, "t" + std::to_string(i))) { return false; }
+    }
+    return lexer.peekToken(5).getType() == TokenType::EndOfFile
+        && lexer.consumeToken().getType() == TokenType::EndOfFile;
+}
+
+bool testParallelTokenization() {
+    // Quotes, comment markers and newlines in places where splitting the input there would change how it lexes
+    const std::string snippet = "let x = \"a # not a comment\\\n still /* the string\";"
+                                "  # a \"comment\" with 'quotes'\n"
+                                "/* a block /* nested */\n spans \"lines\" */ x //= 2; y = a//*b*/c;\n"
+                                "let c = '\\n'; let d = '\"'; let e = '\n";
+    std::string source;
+    for (int i = 0; i < 200; ++i) { source += snippet + "v" + std::to_string(i) + " = " + std::to_string(i) + ";\n"; }
+
+    lexer::Lexer& sequential = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(source, lexer::Mode::String));
+    lexer::Lexer& parallel = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(source, lexer::Mode::String));
+    const std::vector<Token> expected = sequential.tokenizeAll();
+    const std::vector<Token> tokens = parallel.tokenizeAllParallel(4, 64);
+    if (tokens.size() != expected.size()) {
+        std::cout << "Expected " << expected.size() << " tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens[i].getType() != expected[i].getType() || tokens[i].getLexeme() != expected[i].getLexeme()
+            || tokens[i].getLocation().offset != expected[i].getLocation().offset
+            || tokens[i].getAtom() != expected[i].getAtom() || tokens[i].isInvalid() != expected[i].isInvalid()) {
+            std::cout << "Token " << i << " was " << tokens[i].toString() << ", expected " << expected[i].toString()
+                      << '\n';
+            return false;
+        }
+    }
+    // The unclosed character literals are errors either way
+    return sequential.hasError() && parallel.hasError() && parallel.done();
+}
+
 bool testKeywords() {
     std::vector<Token> tokens
         = tokensFromString("alias as uint128 bool break aggregate case char mut foo while string");
@@ -160,6 +257,38 @@ bool testFloatLiterals() {
         && checkToken(tokens[4], TokenType::IntegerLiteral, "0b10010") && tokens[4].isInvalid();
 }
 
+bool testNumberLiteralValues() {
+    // Long enough for whole 8-digit chunks, in every base, with suffixes, exponents and values that don't fit. Floats
+    // that don't fit become 0 if they are below 1 (whatever their integer part) and infinite otherwise
+    std::vector<Token> tokens = tokensFromString("1234567890123 0xDEAD_beef 0b1010 0o777 255u8 256u8 1.5e3 2.5 "
+                                                 "1.0e-400 340282366920938463463374607431768211455 0.5e400 0.5e39f32 "
+                                                 "1e-400");
+    if (tokens.size() != 13) {
+        std::cout << "Expected 13 tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    using mnstl::number_t;
+    auto holds = [&](size_t index, number_t expected, bool overflowed = false) {
+        const lexer::NumberLiteralValue& value = tokens[index].getNumber();
+        if (value.exists && value.overflowed == overflowed
+            && value.value.underlying_type() == expected.underlying_type()
+            && ((overflowed && !expected.is_float()) || value.value == expected)) {
+            return true;
+        }
+        std::cout << "Literal " << tokens[index].getLexeme() << " was converted to " << value.value.to_string()
+                  << " (expected " << expected.to_string() << ")\n";
+        return false;
+    };
+    return holds(0, number_t{int64_t{1234567890123}}) && holds(1, number_t{int64_t{0xDEADBEEF}})
+        && holds(2, number_t{int32_t{10}}) && holds(3, number_t{int32_t{0777}}) && holds(4, number_t{uint8_t{255}})
+        && holds(5, number_t{uint8_t{0}}, /*overflowed=*/true) && holds(6, number_t{mnstl::float32_t{1500}})
+        && holds(7, number_t{mnstl::float32_t{2.5}}) && holds(8, number_t{mnstl::float64_t{0}}, /*overflowed=*/true)
+        && holds(9, number_t{std::numeric_limits<mnstl::uint128_t>::max()})
+        && holds(10, number_t{std::numeric_limits<mnstl::float64_t>::infinity()}, /*overflowed=*/true)
+        && holds(11, number_t{std::numeric_limits<mnstl::float32_t>::infinity()}, /*overflowed=*/true)
+        && holds(12, number_t{mnstl::float64_t{0}}, /*overflowed=*/true);
+}
+
 bool testCharLiterals() {
     std::vector<Token> tokens = tokensFromString("'a' '\\n' '\\'' '\\\\' '\\t' '\\u1234'");
     printAllTokens(tokens);
@@ -187,6 +316,36 @@ bool testStringLiterals() {
         && checkToken(tokens[2], TokenType::StrLiteral, "escaped \"quote\"");
 }
 
+bool testLiteralDecoding() {
+    // Escapes of every kind, a line continuation, and UTF-8 past the first vector register's worth of the body
+    const std::string padding(40, 'x');
+    std::vector<Token> tokens = tokensFromString("\"tab\\there \\x41\\u00e9\\U0001F600 \\\njoined\" '\\u00e9' \""
+                                                 + padding + "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\"");
+    printAllTokens(tokens);
+    if (tokens.size() != 3) {
+        std::cout << "Expected 3 tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    if (!checkToken(tokens[0], TokenType::StrLiteral, "tab\there A\xC3\xA9\xF0\x9F\x98\x80 joined")
+        || !checkToken(tokens[1], TokenType::CharLiteral, "\xC3\xA9")
+        || !checkToken(tokens[2], TokenType::StrLiteral, padding + "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80")) {
+        return false;
+    }
+
+    // Malformed UTF-8: a stray continuation byte (after a vector register's worth), an overlong encoding, an encoded
+    // surrogate, a code point past U+10FFFF, and a sequence cut short by the closing quote
+    tokens = tokensFromString("\"" + padding
+                              + "\x80\" \"\xC0\xAF\" \"\xED\xA0\x80\" \"\xF4\x90\x80\x80\" \"\xE2\x82\"");
+    printAllTokens(tokens);
+    if (tokens.size() != 5) {
+        std::cout << "Expected 5 tokens, got " << tokens.size() << '\n';
+        return false;
+    }
+    return std::ranges::all_of(tokens, [](const Token& token) {
+        return token.getType() == TokenType::StrLiteral && token.isInvalid();
+    });
+}
+
 bool testOperators() {
     std::vector<Token> tokens = tokensFromString(
         "+ - * / // % ++ -- += -= *= /= //= %= == != && || ! & | ~ ^ &= |= ~= ^= . : :: = -> ... @ < <= > >= << >> <<= >>=");
@@ -311,6 +470,31 @@ bool testInvalidEscapeSequence() {
     return tokens[0].getType() == TokenType::CharLiteral;
 }
 
+bool testHeaderOnlyLexing() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "manganese_header_test.mn";
+    // The body has a lexing error, which a header-only lexer never gets far enough to see
+    std::ofstream(path) << "module app;\nimport lib::thing as t; # comment\nimport base;\n"
+                        << "let s = \"unterminated\nlet x = 1;\n";
+    lexer::Lexer& header
+        = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(path.string(), lexer::Mode::FileHeader));
+    lexer::Lexer& full = *testLexers.emplace_back(std::make_unique<lexer::Lexer>(path.string(), lexer::Mode::File));
+    const std::vector<Token> tokens = header.tokenizeAll();
+    const bool fullHasError = !full.tokenizeAll().empty() && full.hasError();
+    std::filesystem::remove(path);
+
+    const std::vector<TokenType> expected
+        = {TokenType::Module,     TokenType::Identifier,      TokenType::Semicolon,  TokenType::Import,
+           TokenType::Identifier, TokenType::ScopeResolution, TokenType::Identifier, TokenType::As,
+           TokenType::Identifier, TokenType::Semicolon,       TokenType::Import,     TokenType::Identifier,
+           TokenType::Semicolon,  TokenType::EndOfFile};
+    printAllTokens(tokens);
+    if (!std::ranges::equal(tokens, expected, {}, &Token::getType)) {
+        std::cout << "Expected only the header's tokens\n";
+        return false;
+    }
+    return !header.hasError() && fullHasError;
+}
+
 bool testBadFileAccess() {
     try {
         tokensFromFile("__nonexistentfile.mn");
@@ -319,23 +503,30 @@ bool testBadFileAccess() {
 }
 
 void runLexerTests(TestRunner& runner) {
-    // Register all tests
+    // Register all tests (with budgets on those that lex enough for a slowdown to show)
     runner.runTest("Empty String", testEmptyString);
     runner.runTest("Whitespace", testWhitespace);
     runner.runTest("Comments", testComments);
     runner.runTest("Identifiers", testIdentifiers);
+    runner.runTest("Identifier Interning", testIdentifierInterning);
+    runner.runTest("Long Runs", testLongRuns, {.time = std::chrono::milliseconds(100)});
+    runner.runTest("Lookahead", testLookahead);
+    runner.runTest("Parallel Tokenization", testParallelTokenization, {.time = std::chrono::milliseconds(500)});
     runner.runTest("Keywords", testKeywords);
     runner.runTest("Operators", testOperators);
     runner.runTest("Integer Literals", testIntegerLiterals);
     runner.runTest("Float Literals", testFloatLiterals);
+    runner.runTest("Number Literal Values", testNumberLiteralValues);
     runner.runTest("Character Literals", testCharLiterals);
     runner.runTest("String Literals", testStringLiterals);
+    runner.runTest("Literal Decoding", testLiteralDecoding);
     runner.runTest("Brackets", testBrackets);
     runner.runTest("Punctuation", testPunctuation);
     runner.runTest("Nested Brackets", testNestedBrackets);
     runner.runTest("Invalid Character", testInvalidChar);
     runner.runTest("Invalid Escape Sequence", testInvalidEscapeSequence);
-    runner.runTest("Complete Program", testCompleteProgram);
+    runner.runTest("Complete Program", testCompleteProgram, {.time = std::chrono::milliseconds(100)});
+    runner.runTest("Header Only Lexing", testHeaderOnlyLexing);
     runner.runTest("Invalid File", testBadFileAccess);
 }
 }  // namespace tests
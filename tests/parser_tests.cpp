@@ -1,11 +1,26 @@
 #include <array>
+#include <chrono>
 #include <core.hpp>
+#include <cstring>
 #include <filesystem>
 #include <frontend/parser.hpp>
+#include <frontend/parser/encoded_file.hpp>
+#include <frontend/semantic/analyzer.hpp>
+#include <frontend/semantic/module_interface.hpp>
+#include <frontend/semantic/symbol_table.hpp>
 #include <fstream>
 #include <iostream>
+#include <io/logging.hpp>
+#include <limits>
+#include <mnstl/flat_map.hxx>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "testrunner.hpp"
 
@@ -17,10 +32,17 @@ namespace Manganese {
 namespace tests {
 
 static const char* logFileName = "logs/parser_tests.log";
-mnstl::chunk_allocator allocator;
+
+// Tests run at the same time, so each one builds up its log and appends it here in a single write
+void appendToLog(std::string_view text) {
+    std::ofstream logFile(logFileName, std::ios::app);
+    if (!logFile.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+        std::cerr << "ERROR: Could not write to the log file.\n";
+    }
+}
 
 ast::Block getParserResults(const std::string& source, lexer::Mode mode = lexer::Mode::String) {
-    parser::Parser parser(source, mode, allocator);
+    parser::Parser parser(source, mode, testArena());
     parser::ParsedFile file = parser.parse();
 
     if (!file.moduleName.empty()) { std::cout << "module " << file.moduleName << "\n"; }
@@ -33,24 +55,18 @@ ast::Block getParserResults(const std::string& source, lexer::Mode mode = lexer:
 
 template <size_t N>
 bool validateStatements(const ast::Block& block, const std::array<std::string, N>& expected, const char* testName) {
-    std::ofstream logFile(logFileName, std::ios::app);
-    if (!logFile) {
-        std::cerr << "ERROR: Could not open log file for writing.\n";
-    } else {
-        logFile << "Test: " << testName << '\n';
-    }
+    std::ostringstream logFile;
+    logFile << "Test: " << testName << '\n';
     std::cout << "Parsed " << testName << " AST:" << '\n';
     for (const auto& stmt : block) {
         std::string stmtStr = stmt->toString(0);
         std::cout << stmtStr << '\n';
-        if (logFile) {
-            logFile << "String representation: " << stmtStr << '\n';
-            logFile << "Dumping statement:\n";
-            stmt->dump(logFile);
-            logFile << "---------------------\n";
-        }
+        logFile << "String representation: " << stmtStr << '\n';
+        logFile << "Dumping statement:\n";
+        stmt->dump(logFile);
+        logFile << "---------------------\n";
     }
-    if (logFile) { logFile.close(); }
+    appendToLog(logFile.view());
 
     if (block.size() != N) {
         std::cerr << "ERROR: Expected " << N << " statements, got " << block.size() << " in test: " << testName << '\n';
@@ -71,23 +87,18 @@ bool validateStatements(const ast::Block& block, const std::array<std::string, N
 }
 
 bool validateStatement(const ast::Block& block, const std::string& expected, const std::string& testName) {
-    std::ofstream logFile(logFileName, std::ios::app);
-    if (!logFile) {
-        std::cerr << "ERROR: Could not open log file for writing.\n";
-    } else {
-        logFile << "Test: " << testName << '\n';
-    }
+    std::ostringstream logFile;
+    logFile << "Test: " << testName << '\n';
     std::cout << "Parsed " << testName << " AST:" << '\n';
     for (const auto& stmt : block) {
         std::string stmtStr = stmt->toString(0);
         std::cout << stmtStr << '\n';
-        if (logFile) {
-            logFile << "String representation: " << stmtStr << '\n';
-            logFile << "Dumping statement:\n";
-            stmt->dump(logFile);
-            logFile << "---------------------\n";
-        }
+        logFile << "String representation: " << stmtStr << '\n';
+        logFile << "Dumping statement:\n";
+        stmt->dump(logFile);
+        logFile << "---------------------\n";
     }
+    appendToLog(logFile.view());
 
     if (block.size() != 1) {
         std::cerr << "ERROR: Expected 1 statement, got " << block.size() << " in test: " << testName << '\n';
@@ -535,6 +546,575 @@ bool testParseFromFile() {
     return true;
 }
 
+bool testParseFromTokenArray() {
+    std::string expression = "let x = a + b * c;\nlet y: int = x;";
+    lexer::Lexer lexer(expression, lexer::Mode::String);
+    std::vector<lexer::Token> tokens = lexer.tokenizeAll();
+    if (tokens.empty() || tokens.back().getType() != lexer::TokenType::EndOfFile) {
+        std::cerr << "ERROR: Expected tokenizeAll() to end with an end of file token\n";
+        return false;
+    }
+    parser::Parser parser(tokens, testArena());
+    std::array<std::string, 2> expected
+        = {"(let x: private auto = (a + (b * c)));", "(let y: private int32 = x);"};
+    return validateStatements(parser.parse().program, expected, "Parse From Token Array");
+}
+
+// Counts how many times the arena runs its destructor
+struct ArenaCounted {
+    int& destroyed;
+    std::vector<int> payload = {1, 2, 3};  // Not trivially destructible
+    ~ArenaCounted() noexcept { ++destroyed; }
+};
+
+bool testArenaReset() {
+    int destroyed = 0;
+    mnstl::chunk_allocator arena;
+    for (int i = 0; i < 3; ++i) { arena.emplace<ArenaCounted>(destroyed); }
+    arena.reset();
+    if (destroyed != 3) {
+        std::cerr << "ERROR: Expected reset() to run 3 destructors, but it ran " << destroyed << "\n";
+        return false;
+    }
+
+    // The arena's chunks are reused for the next compilation
+    std::array<std::string, 1> expected = {"(let x: private auto = (a + (b * c)));"};
+    for (int i = 0; i < 2; ++i) {
+        parser::Parser parser(std::string("let x = a + b * c;"), lexer::Mode::String, arena);
+        ast::Block program = parser.parse().program;
+        if (program.get_allocator().resource() != arena.resource()) {
+            std::cerr << "ERROR: Expected the parsed block to allocate from the parser's arena\n";
+            return false;
+        }
+        if (!validateStatements(program, expected, "Arena Reset")) { return false; }
+        arena.reset();
+    }
+    return true;
+}
+
+bool testArenaRewind() {
+    int destroyed = 0;
+    mnstl::chunk_allocator arena(mnstl::chunk_growth_policy{.initial_size = 256, .growth_factor = 2, .max_size = 4096});
+    int* kept = arena.emplace<int>(42);
+    ArenaCounted* keptCounted = arena.emplace<ArenaCounted>(destroyed);
+    const mnstl::chunk_allocator::marker start = arena.mark();
+    void* first = arena.allocate(16, 8);
+    for (int i = 0; i < 2; ++i) { arena.emplace<ArenaCounted>(destroyed); }
+    DISCARD(arena.allocate(10000));  // Bigger than any chunk the policy would add
+    for (int i = 0; i < 100; ++i) { DISCARD(arena.allocate(64)); }
+    arena.rewind(start);
+    if (destroyed != 2) {
+        std::cerr << "ERROR: Expected rewind() to run 2 destructors, but it ran " << destroyed << "\n";
+        return false;
+    }
+    if (arena.allocate(16, 8) != first || *kept != 42 || keptCounted->payload.size() != 3) {
+        std::cerr << "ERROR: Expected rewind() to keep earlier allocations and reuse later ones\n";
+        return false;
+    }
+    return true;
+}
+
+bool testArenaStatistics() {
+    mnstl::chunk_allocator arena(mnstl::chunk_growth_policy{.initial_size = 256, .growth_factor = 2, .max_size = 4096});
+    {
+        parser::Parser parser(std::string("let x = foo(a, b + c, [1, 2, 3]);"), lexer::Mode::String, arena);
+        DISCARD(parser.parse());
+    }
+    const mnstl::chunk_allocator_stats stats = arena.stats();
+    std::cout << stats.to_string() << '\n';
+    const size_t astBytes = stats.bytes_by_tag[static_cast<size_t>(mnstl::alloc_tag::ast)];
+    if (astBytes == 0 || stats.bytes_by_tag[static_cast<size_t>(mnstl::alloc_tag::types)] != 0) {
+        std::cerr << "ERROR: Expected the parse to be attributed to the AST tag\n";
+        return false;
+    }
+    if (stats.chunks < 2 || stats.bytes_in_use > stats.bytes_reserved || stats.high_water_mark != stats.bytes_in_use
+        || stats.bytes_in_use < astBytes + stats.alignment_padding) {
+        std::cerr << "ERROR: Inconsistent arena statistics\n";
+        return false;
+    }
+    arena.reset();
+    const mnstl::chunk_allocator_stats afterReset = arena.stats();
+    return afterReset.bytes_in_use == 0 && afterReset.high_water_mark == stats.high_water_mark
+        && afterReset.bytes_by_tag[static_cast<size_t>(mnstl::alloc_tag::ast)] == 0;
+}
+
+bool testFlatMap() {
+    mnstl::chunk_allocator arena;
+    mnstl::flat_map<uint32_t, std::string, 8> map(arena.resource());
+    constexpr uint32_t numKeys = 200;
+    for (uint32_t key = 0; key < numKeys; ++key) {
+        if (!map.try_emplace(key * 7, std::to_string(key)).second) {
+            std::cerr << "ERROR: Key " << key * 7 << " was reported as already present\n";
+            return false;
+        }
+        if (map.is_spilled() != (key >= map.inline_capacity())) {
+            std::cerr << "ERROR: Map should only leave its inline storage once it is full\n";
+            return false;
+        }
+    }
+    if (map.try_emplace(7, "replaced").second || *map.find(7) != "1") {
+        std::cerr << "ERROR: Inserting an existing key should leave its value alone\n";
+        return false;
+    }
+    for (uint32_t key = 0; key < numKeys; ++key) {
+        const std::string* value = map.find(key * 7);
+        if (!value || *value != std::to_string(key) || map.contains(key * 7 + 1)) {
+            std::cerr << "ERROR: Lookup of key " << key * 7 << " failed\n";
+            return false;
+        }
+    }
+    size_t visited = 0;
+    map.for_each([&](uint32_t, const std::string&) { ++visited; });
+    map.clear();
+    return visited == numKeys && map.empty() && !map.contains(0);
+}
+
+bool testSymbolTableScoping() {
+    mnstl::chunk_allocator arena;
+    semantic::SymbolTable table(arena);
+    auto symbolOf = [](bool isMutable) {
+        return semantic::Symbol{.kind = semantic::SymbolKind::Variable, .isMutable = isMutable};
+    };
+    DISCARD(table.declare("shadowed", symbolOf(false)));
+    table.enterScope();
+    DISCARD(table.declare("shadowed", symbolOf(true)));
+    table.enterScope();
+    const semantic::Symbol* inner = table.lookup("shadowed");
+    const bool innerResolved = inner && inner->isMutable && !table.lookupAtCurrentDepth("shadowed");
+    table.exitScope();
+    table.exitScope();
+    const semantic::Symbol* outer = table.lookup("shadowed");
+    if (!innerResolved || !outer || outer->isMutable || table.lookup("neverDeclared")) {
+        std::cerr << "ERROR: Names should resolve to their innermost visible declaration\n";
+        return false;
+    }
+
+    // The second pass re-enters the recorded scopes, which should make their symbols visible again
+    table.switchToCheckingMode();
+    table.enterScope();
+    const semantic::Symbol* reentered = table.lookupAtCurrentDepth("shadowed");
+    table.exitScope();
+    return reentered && reentered->isMutable && !table.lookup("shadowed")->isMutable;
+}
+
+bool testRecordedScopes() {
+    mnstl::chunk_allocator arena;
+    semantic::SymbolTable table(arena);
+    auto symbolOf = [](bool isMutable) {
+        return semantic::Symbol{.kind = semantic::SymbolKind::Variable, .isMutable = isMutable};
+    };
+    // Stand-ins for the blocks that own each scope: two sibling function bodies, the second with a nested block
+    const int first = 0, second = 0, nested = 0;
+    table.enterScope(&first);
+    DISCARD(table.declare("x", symbolOf(false)));
+    table.exitScope();
+    table.enterScope(&second);
+    DISCARD(table.declare("x", symbolOf(true)));
+    table.enterScope(&nested);
+    DISCARD(table.declare("y", symbolOf(true)));
+    table.exitScope();
+    table.exitScope();
+
+    // Checking can visit the recorded scopes in any order, even jumping straight into a nested one
+    table.switchToCheckingMode();
+    table.enterScope(&nested);
+    const semantic::Symbol* fromNested = table.lookup("x");
+    const bool nestedResolved = fromNested && fromNested->isMutable && table.lookupAtCurrentDepth("y");
+    table.exitScope();
+    table.exitScope();
+    table.enterScope(&first);
+    const semantic::Symbol* fromFirst = table.lookup("x");
+    const bool firstResolved = fromFirst && !fromFirst->isMutable && !table.lookup("y");
+    table.exitScope();
+    if (!nestedResolved || !firstResolved || table.lookup("x")) {
+        std::cerr << "ERROR: A recorded scope should see exactly its own and its ancestors' symbols\n";
+        return false;
+    }
+    return true;
+}
+
+bool testTypeInterning() {
+    mnstl::chunk_allocator arena;
+    semantic::TypeContext types(arena);
+    const semantic::SemanticType* i32 = types.getPrimitive(ast::PrimitiveType_t::i32);
+    const semantic::SemanticType* boolean = types.getPrimitive(ast::PrimitiveType_t::boolean);
+    auto function = [&]() {
+        return types.getFunction({{.isMutable = true, .type = i32}, {.isMutable = false, .type = boolean}}, i32);
+    };
+    if (types.getPointer(i32, true) != types.getPointer(i32, true)
+        || types.getPointer(i32, true) == types.getPointer(i32, false) || function() != function()
+        || types.getAnonymousAggregate({i32, boolean}) != types.getNamedAggregate("", {{"", i32}, {"", boolean}})
+        || types.getAnonymousAggregate({i32, boolean}) == types.getAnonymousAggregate({boolean, i32})) {
+        std::cerr << "ERROR: Equal types should be interned as one type, and distinct types kept apart\n";
+        return false;
+    }
+
+    // Threads asking for the same types at once (enough to grow every shard) should all get the same ones
+    constexpr size_t numThreads = 4, numTypes = 2000;
+    std::vector<std::vector<const semantic::SemanticType*>> seen(numThreads);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&, i]() {
+                for (size_t length = 0; length < numTypes; ++length) {
+                    seen[i].push_back(types.getArray(types.getPointer(i32, i % 2 == 0), length));
+                }
+            });
+        }
+    }
+    for (size_t length = 0; length < numTypes; ++length) {
+        const semantic::SemanticType* expected = types.getArray(types.getPointer(i32, true), length);
+        if (seen[0][length] != expected || seen[2][length] != expected || seen[1][length] != seen[3][length]
+            || seen[1][length] == expected) {
+            std::cerr << "ERROR: Array type of length " << length << " was interned more than once\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Run semantic analysis on `source`, collecting its diagnostics
+Result analyzeSource(const std::string& source, size_t threads, std::string& diagnostics);
+
+bool testAggregateLayout() {
+    mnstl::chunk_allocator& arena = testArena();
+    semantic::TypeContext types(arena);
+    auto primitive = [&](ast::PrimitiveType_t p) { return types.getPrimitive(p); };
+    using enum ast::PrimitiveType_t;
+    // Each field goes at the next offset its alignment allows, and the whole is padded to its own alignment
+    const auto* padded = static_cast<const semantic::Aggregate*>(
+        types.getNamedAggregate("Padded", {{"a", primitive(i8)}, {"b", primitive(i32)}, {"c", primitive(i8)}}));
+    const auto* nested = static_cast<const semantic::Aggregate*>(types.getAnonymousAggregate(
+        {primitive(boolean), padded, types.getArray(primitive(i16), 3), primitive(i128)}));
+    if (padded->layout != semantic::Layout{.size = 12, .alignment = 4}
+        || padded->fieldOffsets != std::vector<uint64_t>{0, 4, 8}
+        || nested->layout != semantic::Layout{.size = 48, .alignment = 16}
+        || nested->fieldOffsets != std::vector<uint64_t>{0, 4, 16, 32}) {
+        std::cerr << "ERROR: Aggregates should be laid out with each field aligned, as in C\n";
+        return false;
+    }
+    mnstl::string_pool& pool = lexer::identifierPool();
+    if (padded->getFieldIndex(pool.intern("c")) != 2 || padded->getFieldIndex(pool.intern("d")) != -1
+        || padded->getFieldType("b") != primitive(i32) || padded->getFieldType("never interned as a name")) {
+        std::cerr << "ERROR: Fields should be found by their interned names\n";
+        return false;
+    }
+    // Nothing made from a type parameter has a layout until it is specialized
+    const semantic::SemanticType* T = types.getTypeParameter(pool.view(pool.intern("T")), 0);
+    const semantic::SemanticType* box = types.getNamedAggregate("Box", {{"value", T}, {"count", primitive(i64)}});
+    const std::array<const semantic::SemanticType*, 1> ofChar = {primitive(character)};
+    if (semantic::layoutOf(box) || semantic::layoutOf(types.getArray(T, 2))
+        || semantic::layoutOf(types.specialize(box, ofChar)) != semantic::Layout{.size = 16, .alignment = 8}
+        || semantic::layoutOf(types.getGenericInstance(box, ofChar)) != semantic::Layout{.size = 16, .alignment = 8}
+        || semantic::layoutOf(types.getPointer(T, false)) != semantic::layoutOf(primitive(str))) {
+        std::cerr << "ERROR: Only types that don't depend on type parameters should have a layout\n";
+        return false;
+    }
+    // Nor does one whose size wraps past 64 bits, whether adding up its fields or padding them
+    const semantic::SemanticType* half = types.getArray(primitive(i8), uint64_t{1} << 63);
+    if (semantic::layoutOf(half) != semantic::Layout{.size = uint64_t{1} << 63, .alignment = 1}
+        || semantic::layoutOf(types.getAnonymousAggregate({half, half}))
+        || semantic::layoutOf(types.getAnonymousAggregate({types.getArray(primitive(i8), UINT64_MAX), primitive(i16)}))
+        || semantic::layoutOf(types.getArray(types.getAnonymousAggregate({half, primitive(i8)}), 2))) {
+        std::cerr << "ERROR: Types too big for their size to fit in 64 bits should have no layout\n";
+        return false;
+    }
+
+    const std::string source = "aggregate Point { x: int8; y: int64; }\n"
+                               "func y(p: Point) -> int64 { return p.y; }\n"
+                               "func size() -> uint64 { return sizeof(Point) + alignof(Point); }\n";
+    std::string diagnostics;
+    if (analyzeSource(source, 1, diagnostics) != Result::Success) {
+        std::cerr << "ERROR: Expected the field access and layout queries to check, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string invalid = "aggregate Point { x: int8; y: int64; }\n"
+                                "func z(p: Point) -> int64 { return p.z; }\n"
+                                "func w(n: int32) -> int32 { return n.w; }\n";
+    if (analyzeSource(invalid, 1, diagnostics) != Result::Failure
+        || diagnostics.find("has no field named 'z'") == std::string::npos
+        || diagnostics.find("Cannot access field 'w' of non aggregate type int32") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the missing fields, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string huge = "aggregate Huge { a: int16[4611686018427387904]; b: int16[4611686018427387904]; }\n"
+                             "func f(big: int64[4611686018427387904][2]) {}\n";
+    if (analyzeSource(huge, 1, diagnostics) != Result::Failure
+        || diagnostics.find("'Huge { a: int16[4611686018427387904], b: int16[4611686018427387904]}' is too big")
+            == std::string::npos
+        || diagnostics.find("'int64[4611686018427387904]' is too big") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the types too big to fit in memory, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+bool testGenericSpecialization() {
+    mnstl::chunk_allocator& arena = testArena();
+    semantic::TypeContext types(arena);
+    const semantic::SemanticType* i32 = types.getPrimitive(ast::PrimitiveType_t::i32);
+    const semantic::SemanticType* boolean = types.getPrimitive(ast::PrimitiveType_t::boolean);
+    mnstl::string_pool& pool = lexer::identifierPool();
+    const semantic::SemanticType* T = types.getTypeParameter(pool.view(pool.intern("T")), 0);
+    // aggregate Box[T] { value: T; } and aggregate Pair[T] { first: Box@[T]; second: ptr T; }
+    const semantic::SemanticType* box = types.getNamedAggregate("Box", {{"value", T}});
+    const std::array<const semantic::SemanticType*, 1> boxOfT = {T};
+    const semantic::SemanticType* pair = types.getNamedAggregate(
+        "Pair", {{"first", types.getGenericInstance(box, boxOfT)}, {"second", types.getPointer(T, false)}});
+
+    const std::array<const semantic::SemanticType*, 1> ofInt = {i32}, ofBool = {boolean};
+    const semantic::SemanticType* pairOfInt = types.specialize(pair, ofInt);
+    const semantic::SemanticType* expected = types.getNamedAggregate(
+        "Pair@[int32]", {{"first", types.specialize(box, ofInt)}, {"second", types.getPointer(i32, false)}});
+    if (pairOfInt != expected || pairOfInt != types.specialize(pair, ofInt)
+        || pairOfInt == types.specialize(pair, ofBool)
+        || types.specialize(box, ofInt) != types.getNamedAggregate("Box@[int32]", {{"value", i32}})) {
+        std::cerr << "ERROR: Each instance should be specialized once, with its arguments substituted throughout\n";
+        return false;
+    }
+    // An instance whose arguments are still type parameters stays an instance until they are known
+    const semantic::SemanticType* dependent = types.specialize(box, boxOfT);
+    if (dependent != types.getGenericInstance(box, boxOfT) || !semantic::TypeContext::dependsOnTypeParameters(dependent)
+        || semantic::TypeContext::dependsOnTypeParameters(types.getGenericInstance(box, ofInt))) {
+        std::cerr << "ERROR: Instances depending on type parameters shouldn't be specialized\n";
+        return false;
+    }
+
+    // Threads specializing the same instances at once should all get the same specializations
+    constexpr size_t numThreads = 4, numLengths = 200;
+    std::vector<std::vector<const semantic::SemanticType*>> seen(numThreads);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&, i]() {
+                for (size_t length = 1; length <= numLengths; ++length) {
+                    const std::array<const semantic::SemanticType*, 1> argument = {types.getArray(i32, length)};
+                    seen[i].push_back(types.specialize(pair, argument));
+                }
+            });
+        }
+    }
+    for (size_t i = 1; i < numThreads; ++i) {
+        if (seen[i] != seen[0]) {
+            std::cerr << "ERROR: An instance specialized from several threads was specialized more than once\n";
+            return false;
+        }
+    }
+
+    // Through the analyzer: the declaration is specialized wherever it is named with arguments
+    const std::string source = "aggregate Pair[T] { first: T; second: T; }\n"
+                               "func make() -> Pair@[int32] { return Pair@[int32]{first = 1, second = 2}; }\n"
+                               "func copy(p: Pair@[int32]) -> Pair@[int32] { return p; }\n";
+    std::string diagnostics;
+    if (analyzeSource(source, 1, diagnostics) != Result::Success) {
+        std::cerr << "ERROR: Expected the specialized aggregate to check, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string invalid = "aggregate Pair[T] { first: T; second: T; }\n"
+                                "aggregate Point { x: int32; }\n"
+                                "func f(a: Pair@[int32, bool]) {}\n"
+                                "func g(b: Point@[int32]) {}\n"
+                                "func h(c: Pair) {}\n";
+    if (analyzeSource(invalid, 1, diagnostics) != Result::Failure
+        || diagnostics.find("'Pair' takes 1 type argument, but was given 2") == std::string::npos
+        || diagnostics.find("'Point' is not generic") == std::string::npos
+        || diagnostics.find("'Pair' is generic, so needs 1 type argument") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the wrong number of type arguments, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+bool testConstantEvaluation() {
+    const std::string source =
+        "aggregate Pair { first: int32; second: int32; }\n"
+        "func square(n: int64) -> int64 { return n * n; }\n"
+        "func fib(n: int64) -> int64 { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+        "func oddSum(n: mut int32, total: mut int32) -> int32 {\n"
+        "    while (n >= 1) { if (n % 2 == 1) { total += n; } n = n - 1; }\n"
+        "    return total;\n"
+        "}\n"
+        "func second(p: Pair) -> int32 { return p.second; }\n"
+        "func take(a: int32[25], b: int32[102334155], c: char[17], d: bool[8], e: int8[2]) {}\n"
+        "func check(a: int32[oddSum(9, 1) - 1], b: int32[fib(40)], c: char[(square(3) as uint64) + sizeof(int64)],\n"
+        "           d: bool[second(Pair { first = 1, second = 8 })], e: int8[(1 - 8) / 2 + 5]) {\n"
+        "    take(a, b, c, d, e);\n"
+        "}\n";
+    std::string diagnostics;
+    // fib(40) makes hundreds of millions of calls, unless each call is only evaluated once. Checking threads can each
+    // evaluate functions that another is checking
+    if (analyzeSource(source, 1, diagnostics) != Result::Success
+        || analyzeSource(source, 4, diagnostics) != Result::Success) {
+        std::cerr << "ERROR: Expected the array lengths to be evaluated at compile time, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string invalid = "func spin() -> int32 { while (true) {} return 1; }\n"
+                                "func address(n: int32) -> int32 { let p = &n; return n; }\n"
+                                "func f(a: int32[spin()], b: int32[address(2)]) {}\n";
+    if (analyzeSource(invalid, 1, diagnostics) != Result::Failure || diagnostics.find("took over") == std::string::npos
+        || diagnostics.find("can't be evaluated at compile time") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the unending and unevaluable lengths, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string overflowing = "func negate(n: int64) -> int64 { return n / -1; }\n"
+                                    "func f(a: int32[(0 - 9223372036854775807 - 1) / -1],\n"
+                                    "       b: int32[(0 - 9223372036854775807 - 1) % -1],\n"
+                                    "       c: int32[negate(0 - 9223372036854775807 - 1)], d: int32[1 << 70],\n"
+                                    "       e: int32[9223372036854775807 + 1]) {}\n";
+    const std::string_view overflow = "Integer overflow in constant expression";
+    size_t overflows = 0;
+    if (analyzeSource(overflowing, 1, diagnostics) == Result::Failure) {
+        for (size_t at = diagnostics.find(overflow); at != std::string::npos; at = diagnostics.find(overflow, at + 1)) {
+            ++overflows;
+        }
+    }
+    if (overflows != 4 || diagnostics.find("Cannot shift an integer") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the overflowing arithmetic and the out of range shift, got:\n"
+                  << diagnostics;
+        return false;
+    }
+    const std::string mismatched = "func four() -> int64 { return 4; }\n"
+                                   "func take(a: int32[4]) {}\n"
+                                   "func f(a: int32[four() + 1]) { take(a); }\n";
+    if (analyzeSource(mismatched, 1, diagnostics) != Result::Failure
+        || diagnostics.find("int32[5]") == std::string::npos) {
+        std::cerr << "ERROR: Expected the evaluated length not to match, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+Result analyzeSource(const std::string& source, size_t threads, std::string& diagnostics) {
+    mnstl::chunk_allocator& arena = testArena();
+    parser::Parser parser(source, lexer::Mode::String, arena);
+    parser::ParsedFile file = parser.parse();
+    std::ostringstream buffer;
+    Result result;
+    {
+        logging::DiagnosticCapture capture(buffer);
+        semantic::analyzer analyzer(file, arena, threads);
+        result = analyzer.analyze();
+    }
+    diagnostics = buffer.str();
+    return result;
+}
+
+bool testParallelSemanticChecking() {
+    const std::string source = "func first(a: int32) -> int32 { return a; }\n"
+                               "func second() -> bool { return missing; }\n"
+                               "func third(flag: bool) { while (flag) { break; } continue; }\n"
+                               "func fourth(b: bool) -> bool { if (b) { return b; } return unknown; }\n";
+    std::string sequential, parallel;
+    const Result sequentialResult = analyzeSource(source, 1, sequential);
+    const Result parallelResult = analyzeSource(source, 4, parallel);
+    if (sequentialResult != Result::Failure || sequential.find("missing") == std::string::npos
+        || sequential.find("'continue'") == std::string::npos || sequential.find("unknown") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for 'missing', 'continue' and 'unknown', got:\n" << sequential;
+        return false;
+    }
+    if (parallelResult != sequentialResult || parallel != sequential) {
+        std::cerr << "ERROR: Checking in parallel should report the same diagnostics, in the same order, got:\n"
+                  << parallel;
+        return false;
+    }
+    return true;
+}
+
+bool testTypeCompatibilityDiagnostics() {
+    // A narrowing assignment, and a pair of pointer types compared twice outside of a condition (the second time from
+    // the cache) and once inside one, where converting to bool is fine
+    const std::string source = "func f(wide: int64, narrow: mut int8, counts: ptr int32, flags: mut ptr bool) {\n"
+                               "    narrow = wide; flags = counts; flags = counts;\n"
+                               "    if (wide) { narrow = wide; flags = counts; }\n"
+                               "}\n";
+    std::string diagnostics;
+    const Result result = analyzeSource(source, 1, diagnostics);
+    auto count = [&](std::string_view message) {
+        size_t found = 0;
+        for (size_t at = diagnostics.find(message); at != std::string::npos; at = diagnostics.find(message, at + 1)) {
+            ++found;
+        }
+        return found;
+    };
+    const size_t narrowing = count("Narrowing conversion: potential data loss converting from 'int64' to 'int8'");
+    const size_t boolConversion = count("Conversion between 'int32' and 'bool' can alter semantics");
+    if (result != Result::Success || narrowing != 2 || boolConversion != 2 || count("from 'int8'") != 0) {
+        std::cerr << "ERROR: Expected two narrowing warnings and two (not three) bool conversion warnings, got:\n"
+                  << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+bool testSwitchAnalysis() {
+    // Cases are evaluated at compile time, so they can call functions, and are converted to the switched-on type
+    const std::string source = "func four() -> int64 { return 4; }\n"
+                               "func f(x: int8, c: char) -> int32 {\n"
+                               "    switch (x) { case 1 + 1: return 2; case four(): return 4; case 127: return 5; }\n"
+                               "    switch (c) { case 'a': return 1; case 'b': return 2; default: return 3; }\n"
+                               "}\n";
+    std::string diagnostics;
+    if (analyzeSource(source, 1, diagnostics) != Result::Success) {
+        std::cerr << "ERROR: Expected the switches to be valid, got:\n" << diagnostics;
+        return false;
+    }
+    const std::string invalid = "func f(x: int32, y: int32, z: float64) {\n"
+                                "    switch (x) { case 2: ; case 1 + 1: ; case y: ; case \"a\": ; }\n"
+                                "    switch (z) { case 1: ; }\n"
+                                "}\n";
+    if (analyzeSource(invalid, 1, diagnostics) != Result::Failure
+        || diagnostics.find("Case (1 + 1) has the same value as case 2") == std::string::npos
+        || diagnostics.find("'y' isn't known at compile time") == std::string::npos
+        || diagnostics.find("Case value \"a\" has type str") == std::string::npos
+        || diagnostics.find("Can only switch on integers, characters and booleans, not float64") == std::string::npos) {
+        std::cerr << "ERROR: Expected errors for the duplicate, unevaluable and mistyped cases, got:\n" << diagnostics;
+        return false;
+    }
+    return true;
+}
+
+bool testSharedChunkPool() {
+    // Workers fill arenas drawn from one pool, then hand them (and everything in them) back to this thread
+    mnstl::chunk_pool pool(4096);
+    constexpr size_t numWorkers = 4, numAllocations = 300;
+    auto runWorkers = [&]() {
+        std::vector<mnstl::chunk_allocator> arenas;
+        std::vector<std::vector<int*>> values(numWorkers);
+        arenas.reserve(numWorkers);
+        for (size_t i = 0; i < numWorkers; ++i) { arenas.emplace_back(pool); }
+        {
+            std::vector<std::jthread> workers;
+            for (size_t i = 0; i < numWorkers; ++i) {
+                workers.emplace_back([&, i]() {
+                    mnstl::chunk_allocator arena(pool);
+                    for (size_t j = 0; j < numAllocations; ++j) {
+                        values[i].push_back(arena.emplace<int>(static_cast<int>(i * numAllocations + j)));
+                        DISCARD(arena.allocate(48));
+                    }
+                    arenas[i] = std::move(arena);
+                });
+            }
+        }
+        for (size_t i = 0; i < numWorkers; ++i) {
+            for (size_t j = 0; j < numAllocations; ++j) {
+                if (*values[i][j] != static_cast<int>(i * numAllocations + j)) { return false; }
+            }
+        }
+        return true;  // The arenas give their chunks back to the pool here
+    };
+    if (!runWorkers()) {
+        std::cerr << "ERROR: Values allocated on worker threads were not intact after being handed over\n";
+        return false;
+    }
+    const size_t created = pool.blocks_created();
+    if (!runWorkers() || pool.blocks_created() != created) {
+        std::cerr << "ERROR: Expected the second round of arenas to reuse the pool's " << created << " blocks, but "
+                  << pool.blocks_created() << " were created\n";
+        return false;
+    }
+    return true;
+}
+
 bool testRedundantSemicolons() {
     std::string expression = "let x = 1 + 2;;;;;";
     std::array<std::string, 5> expected = {"(let x: private auto = (1 + 2));", "", "", "", ""};
@@ -579,6 +1159,389 @@ bool testNestedBlocks() {
     return validateStatement(getParserResults(expression), expected, "Nested Blocks");
 }
 
+bool testConstantFolding() {
+    // Deep enough that folding it recursively would risk overflowing the stack
+    constexpr size_t depth = 5000;
+    std::string source = "let x = 1";
+    for (size_t i = 0; i < depth; ++i) { source += " + 1"; }
+    source += "; let y = 'a'; let z = (1 - 8) / 2 == 4 - 7 && !(1.5 > 2.0);";
+    const ast::Block program = getParserResults(source);
+    if (program.size() != 3) {
+        std::cerr << "ERROR: Expected three declarations, got " << program.size() << '\n';
+        return false;
+    }
+    const auto* sum = static_cast<const ast::VariableDeclarationStatement*>(program[0])->value;
+    const auto* character = static_cast<const ast::VariableDeclarationStatement*>(program[1])->value;
+    const auto* condition = static_cast<const ast::VariableDeclarationStatement*>(program[2])->value;
+
+    const mnstl::fold_result_t& first = sum->fold();
+    if (&first != &sum->fold()) {
+        std::cerr << "ERROR: Folding an expression again should return its remembered value\n";
+        return false;
+    }
+    // Every operand was folded (and remembered) along the way
+    const ast::Expression* leftmost = sum;
+    while (leftmost->kind == ast::ExpressionKind::BinaryExpression) {
+        leftmost = static_cast<const ast::BinaryExpression*>(leftmost)->left;
+    }
+    if (!leftmost->fold().is_number() || character->fold().character() != U'a') {
+        std::cerr << "ERROR: Literals should fold to their own values\n";
+        return false;
+    }
+    // (Integer division truncates, as it does at run time)
+    if (first.number() != mnstl::number_t{int32_t{depth + 1}} || condition->fold().boolean() != true) {
+        std::cerr << "ERROR: Operators on constants should fold to their values\n";
+        return false;
+    }
+    return true;
+}
+
+bool testNumberArithmetic() {
+    using mnstl::number_t, mnstl::arithmetic_op;
+    const number_t sum = number_t{int32_t{2}} + number_t{int32_t{3}};
+    const number_t mixed = number_t{int32_t{2}} * number_t{int64_t{3}};
+    if (sum.underlying_type() != number_t::held_type::int32 || sum.value_as<int32_t>() != 5
+        || mixed.underlying_type() != number_t::held_type::int64 || mixed.value_as<int64_t>() != 6) {
+        std::cerr << "ERROR: Arithmetic should keep the operands' common type\n";
+        return false;
+    }
+    if (!(number_t{std::numeric_limits<int32_t>::max()} + number_t{int32_t{1}}).is_error()
+        || !(number_t{std::numeric_limits<int64_t>::min()} * number_t{int64_t{-1}}).is_error()
+        || (number_t{std::numeric_limits<uint32_t>::max()} + number_t{uint32_t{1}}).value_as<uint32_t>() != 0) {
+        std::cerr << "ERROR: Signed overflow should be an error, and unsigned arithmetic should wrap\n";
+        return false;
+    }
+    // Operands of different (or narrow) types overflow as their common type does
+    if (!(number_t{std::numeric_limits<int64_t>::max()} + number_t{int32_t{1}}).is_error()
+        || !(number_t{std::numeric_limits<int32_t>::max()} + number_t{int8_t{1}}).is_error()
+        || !(number_t{int8_t{127}} + number_t{int8_t{1}}).is_error()
+        || !(number_t{int16_t{-300}} * number_t{int16_t{120}}).is_error()
+        || (number_t{int16_t{-300}} * number_t{int8_t{120}}).value_as<int32_t>() != -36000
+        || (number_t{int8_t{100}} + number_t{int8_t{20}}).value_as<int8_t>() != 120) {
+        std::cerr << "ERROR: Signed overflow of mixed or narrow operands should be an error\n";
+        return false;
+    }
+    // Which the hardware traps on (or doesn't define), rather than wrapping
+    const number_t smallest{std::numeric_limits<int64_t>::min()}, minusOne{int64_t{-1}};
+    if (!(smallest % minusOne).is_error() || !smallest.floor_div(minusOne).is_error()
+        || !(number_t{int32_t{1}} << number_t{int32_t{70}}).is_error()
+        || !(number_t{int32_t{1}} >> number_t{int32_t{-1}}).is_error()
+        || (number_t{int32_t{1}} << number_t{int32_t{31}}).value_as<int32_t>() != std::numeric_limits<int32_t>::min()
+        || (number_t{uint8_t{128}} >> number_t{uint8_t{7}}).value_as<uint8_t>() != 1) {
+        std::cerr << "ERROR: Overflowing division and out of range shifts should be errors\n";
+        return false;
+    }
+
+    std::vector<number_t> operands(100, number_t{int64_t{1}});
+    if (number_t::fold(arithmetic_op::add, operands).value_as<int64_t>() != 100) {
+        std::cerr << "ERROR: Folding a chain of same-type operands gave the wrong result\n";
+        return false;
+    }
+    operands.back() = number_t{2.5};
+    const number_t mixedFold = number_t::fold(arithmetic_op::add, operands);
+    if (mixedFold.underlying_type() != number_t::held_type::float64 || mixedFold.value_as<double>() != 101.5
+        || !number_t::fold(arithmetic_op::add, {}).to_string().empty()) {
+        std::cerr << "ERROR: Folding mixed or no operands gave the wrong result\n";
+        return false;
+    }
+    return true;
+}
+
+bool test128BitIntegers() {
+    using mnstl::int128_t, mnstl::uint128_t;
+    constexpr uint64_t allOnes = std::numeric_limits<uint64_t>::max();
+    // (2^64 - 1)^2 = 2^128 - 2^65 + 1, which needs the full 128 bits
+    constexpr uint128_t square = uint128_t{allOnes} * uint128_t{allOnes};
+    static_assert(square == uint128_t{allOnes - 1, 1}, "128-bit multiplication should work at compile time");
+    if (uint128_t{allOnes} * uint128_t{allOnes} != square || square / uint128_t{allOnes} != uint128_t{allOnes}
+        || square % uint128_t{1'000'000'007} != uint128_t{114'944'269}) {
+        std::cerr << "ERROR: 128-bit multiplication or division gave the wrong result\n";
+        return false;
+    }
+    const int128_t negative = -int128_t{square >> 2};
+    if (negative / int128_t{-3} * int128_t{-3} + negative % int128_t{-3} != negative) {
+        std::cerr << "ERROR: Signed 128-bit division should truncate towards zero\n";
+        return false;
+    }
+    if (mnstl::to_string_uint128(std::numeric_limits<uint128_t>::max()) != "340282366920938463463374607431768211455"
+        || mnstl::to_string_uint128(uint128_t{uint64_t{10'000'000'000'000'000'000ull}} * uint128_t{100})
+               != "1000000000000000000000"
+        || mnstl::to_string_int128(std::numeric_limits<int128_t>::min()) != "-170141183460469231731687303715884105728"
+        || static_cast<double>(uint128_t{1, 0}) != 18446744073709551616.0) {
+        std::cerr << "ERROR: 128-bit integers were converted to strings or floats incorrectly\n";
+        return false;
+    }
+    return true;
+}
+
+bool testModuleInterfaces() {
+    const std::string library = "public func add(a: int32, b: mut int64) -> int32 { return a; }\n"
+                                "func hidden() {}\n"
+                                "public aggregate Point { x: int32; }\n";
+    std::vector<char> encoded;
+    {
+        mnstl::chunk_allocator arena;
+        parser::Parser parser(library, lexer::Mode::String, arena);
+        parser::ParsedFile file = parser.parse();
+        semantic::analyzer analyzer(file, arena);
+        if (analyzer.analyze() == Result::Failure) {
+            std::cerr << "ERROR: The library should analyze without errors\n";
+            return false;
+        }
+        const std::vector<semantic::ExportedSymbol> exports = analyzer.exportedSymbols();
+        encoded = semantic::ModuleInterface::encode("lib", 0x0123456789ABCDEFull, exports);
+    }  // Nothing read from the interface may refer to the library's arena
+
+    {
+        std::vector<char> truncated(encoded.begin(), encoded.end() - 1);
+        std::vector<char> badMagic = encoded;
+        badMagic[0] ^= 1;
+        if (semantic::ModuleInterface::fromBytes(std::move(truncated))
+            || semantic::ModuleInterface::fromBytes(std::move(badMagic))) {
+            std::cerr << "ERROR: A malformed interface should be rejected\n";
+            return false;
+        }
+    }
+    const std::optional<semantic::ModuleInterface> interface = semantic::ModuleInterface::fromBytes(encoded);
+    if (!interface || interface->moduleName() != "lib" || interface->contentHash() != 0x0123456789ABCDEFull
+        || interface->size() != 2 || interface->find("hidden")) {
+        std::cerr << "ERROR: Expected the module's two public symbols, its name and its hash\n";
+        return false;
+    }
+
+    mnstl::chunk_allocator arena;
+    semantic::TypeContext types(arena);
+    const std::optional<semantic::ModuleInterface::Symbol> add = interface->find("add");
+    const std::optional<semantic::ModuleInterface::Symbol> point = interface->find("Point");
+    const semantic::SemanticType* expected
+        = types.getFunction({{.isMutable = false, .type = types.getPrimitive(ast::PrimitiveType_t::i32)},
+                             {.isMutable = true, .type = types.getPrimitive(ast::PrimitiveType_t::i64)}},
+                            types.getPrimitive(ast::PrimitiveType_t::i32));
+    if (!add || add->kind != semantic::SymbolKind::Function || interface->resolveType(add->type, types) != expected
+        || !point || point->kind != semantic::SymbolKind::Aggregate) {
+        std::cerr << "ERROR: 'add' should keep its function type, and 'Point' its kind\n";
+        return false;
+    }
+
+    const std::string importer = "import lib;\nfunc f() { lib::add; lib::missing; }\n";
+    parser::Parser parser(importer, lexer::Mode::String, arena);
+    parser::ParsedFile file = parser.parse();
+    std::ostringstream diagnostics;
+    Result result;
+    {
+        logging::DiagnosticCapture capture(diagnostics);
+        semantic::analyzer analyzer(file, arena);
+        analyzer.addImport("lib", *interface);
+        result = analyzer.analyze();
+    }
+    if (result != Result::Failure || diagnostics.view().find("no public member 'missing'") == std::string::npos
+        || diagnostics.view().find("'add'") != std::string::npos) {
+        std::cerr << "ERROR: Only 'lib::missing' should be reported, got:\n" << diagnostics.view();
+        return false;
+    }
+    return true;
+}
+
+bool testFlatAST() {
+    const ast::Block program
+        = getParserResults("func foo(a: int) -> int { if (a > 1) { return a * 2; } return a + 1; }");
+    const ast::flat::Tree tree = ast::flat::Tree::build(program);
+    using ast::flat::NodeClass, ast::flat::NodeId;
+
+    // program, function, parameter type, return type, body, if, condition (3 nodes), if body, return, a * 2 (3 nodes),
+    // else body, return, a + 1 (3 nodes)
+    if (tree.size() != 19 || tree.children(tree.root()).size() != 1) {
+        std::cerr << "ERROR: Expected 19 nodes with one top-level statement, got " << tree.size() << '\n';
+        return false;
+    }
+    const NodeId function = tree.child(tree.root(), 0);
+    if (tree.statementKind(function) != ast::StatementKind::FunctionDeclarationStatement
+        || tree.children(function).size() != 3 || tree.nodeClass(tree.child(function, 2)) != NodeClass::Block
+        || tree.node<ast::FunctionDeclarationStatement>(function).name != "foo") {
+        std::cerr << "ERROR: Function declaration was not flattened as parameters, return type, body\n";
+        return false;
+    }
+    const NodeId ifStatement = tree.child(tree.child(function, 2), 0);
+    if (tree.children(ifStatement).size() != 3 || tree.children(tree.child(ifStatement, 2)).size() != 0) {
+        std::cerr << "ERROR: If statement should have a condition, a body and an empty else body\n";
+        return false;
+    }
+
+    // Ids are in pre-order, so every child comes after its parent and within its subtree
+    for (NodeId id = 0; id < tree.size(); ++id) {
+        for (NodeId child : tree.children(id)) {
+            if (child <= id || child >= tree.subtreeEnd(id) || tree.subtreeEnd(child) > tree.subtreeEnd(id)) {
+                std::cerr << "ERROR: Node " << child << " is out of place under node " << id << '\n';
+                return false;
+            }
+        }
+    }
+
+    size_t identifiers = 0, visited = 0;
+    ast::flat::forEach(tree, [&]<class T>(NodeId, const T& node) {
+        ++visited;
+        if constexpr (std::is_same_v<T, ast::IdentifierExpression>) { identifiers += (node.value == "a") ? 1 : 0; }
+    });
+    if (visited != tree.size() || identifiers != 3) {
+        std::cerr << "ERROR: Expected to visit 3 uses of 'a' among " << tree.size() << " nodes, got " << identifiers
+                  << " among " << visited << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool testStreamingPrinters() {
+    // A deep tree printed into one buffer should come out as it went in (parenthesized expressions print as written)
+    constexpr size_t depth = 400;
+    std::string nested = "1";
+    for (size_t i = 0; i < depth; ++i) { nested = "(" + nested + " + " + std::to_string(i) + ")"; }
+    const ast::Block program = getParserResults("let x = " + nested + "; func f() -> int { return x; }");
+    if (program.size() != 2) {
+        std::cerr << "ERROR: Expected 2 statements, got " << program.size() << '\n';
+        return false;
+    }
+    const std::string expected = "(let x: private auto = " + nested + ");";
+
+    std::string out = "prefix ";
+    program[0]->toString(out);
+    if (out != "prefix " + expected || program[0]->toString() != expected) {
+        std::cerr << "ERROR: Printing into a buffer did not append the statement to it\n";
+        return false;
+    }
+
+    // Every statement goes into the same buffer, in order
+    out.clear();
+    for (const ast::Statement* statement : program) {
+        statement->toString(out, 1);
+        out += '\n';
+    }
+    if (out != program[0]->toString(1) + '\n' + program[1]->toString(1) + '\n') {
+        std::cerr << "ERROR: Printing the program into one buffer differs from printing each statement\n";
+        return false;
+    }
+
+#if MN_DEBUG
+    std::ostringstream stream;
+    program[1]->dump(stream, 1);
+    std::string dumped = "prefix ";
+    program[1]->dump(dumped, 1);
+    if (stream.str().empty() || dumped != "prefix " + stream.str()) {
+        std::cerr << "ERROR: Dumping into a buffer differs from dumping to a stream\n";
+        return false;
+    }
+#endif  // MN_DEBUG
+    return true;
+}
+
+bool testASTEncoding() {
+    const std::string source = "module shapes;\n"
+                               "import math::vector as vec;\n"
+                               "import std::io;\n"
+                               "public aggregate Pair[T] { first: T; second: mut ptr int32; }\n"
+                               "enum Color: int8 { Red, Green = 2, }\n"
+                               "alias func(mut int32, char) -> bool as Predicate;\n"
+                               "func area[T](w: T, h: mut int64[4]) -> float64 {\n"
+                               "    let mut total: uint128 = 340282366920938463463374607431768211455u128;\n"
+                               "    for (let i = 0; i < 10; ++i) { total += w * h[i]; }\n"
+                               "    do { total--; } while (!(total > 3.5f32));\n"
+                               "    if (w == 'a') { return 1.0; } elif (w != 2) { break; } else { continue; }\n"
+                               "    switch (w) { case 1: { ; } default: return sizeof(T) + alignof(char); }\n"
+                               "    let p = Pair@[int32]{first = 1, second = &total};\n"
+                               "    let list = [\"one\", \"two\"];\n"
+                               "    let lit = aggregate{true, 3, vec::length(p.first)};\n"
+                               "    let t: typeof(p) = (single@[char](w) as int8);\n"
+                               "}\n";
+    parser::Parser parser(source, lexer::Mode::String, testArena());
+    const parser::ParsedFile file = parser.parse();
+    const std::vector<char> encoded = parser::EncodedFile::encode(file);
+    const std::optional<parser::EncodedFile> decoded = parser::EncodedFile::fromBytes(encoded);
+    if (!decoded || decoded->moduleName() != "shapes" || decoded->hasError()
+        || decoded->statementOffsets() != file.statementOffsets || decoded->imports().size() != 2
+        || parser::importToString(decoded->imports()[0]) != parser::importToString(file.imports[0])) {
+        std::cerr << "ERROR: The encoded file should keep the module name, imports and statement offsets\n";
+        return false;
+    }
+
+    // Walked in place, the tree is the flat tree of the program
+    const ast::flat::Tree tree = ast::flat::Tree::build(file.program);
+    if (decoded->size() != tree.size()) {
+        std::cerr << "ERROR: Expected " << tree.size() << " encoded nodes, got " << decoded->size() << '\n';
+        return false;
+    }
+    for (ast::flat::NodeId id = 0; id < tree.size(); ++id) {
+        bool same = decoded->nodeClass(id) == tree.nodeClass(id) && decoded->subtreeEnd(id) == tree.subtreeEnd(id)
+            && decoded->childCount(id) == tree.children(id).size()
+            && decoded->location(id, tree.location(id).source).offset == tree.location(id).offset;
+        for (size_t i = 0; same && i < tree.children(id).size(); ++i) {
+            same = decoded->child(id, i) == tree.child(id, i);
+        }
+        if (!same) {
+            std::cerr << "ERROR: Encoded node " << id << " differs from the flat tree's\n";
+            return false;
+        }
+    }
+    const ast::flat::NodeId function = tree.child(tree.root(), 3);
+    if (decoded->statementKind(function) != ast::StatementKind::FunctionDeclarationStatement
+        || decoded->name(function) != "area" || !decoded->name(tree.root()).empty()) {
+        std::cerr << "ERROR: Expected the fourth statement to be 'area'\n";
+        return false;
+    }
+
+    // Rehydrated, in one go, into an arena with small chunks, it prints as the original did
+    mnstl::chunk_allocator arena(mnstl::chunk_growth_policy{.initial_size = 256, .growth_factor = 1, .max_size = 256});
+    const size_t chunksBefore = arena.stats().chunks;
+    const uint32_t sourceId = file.program[0]->getLocation().source;
+    const parser::ParsedFile rehydrated = decoded->rehydrate(arena, sourceId);
+    if (arena.stats().chunks > chunksBefore + 1) {
+        std::cerr << "ERROR: Rehydrating took " << arena.stats().chunks - chunksBefore << " chunks instead of one\n";
+        return false;
+    }
+    if (rehydrated.program.size() != file.program.size() || rehydrated.moduleName != "shapes"
+        || rehydrated.imports.size() != 2) {
+        std::cerr << "ERROR: The rehydrated file should have the original's statements, name and imports\n";
+        return false;
+    }
+    for (size_t i = 0; i < file.program.size(); ++i) {
+        if (rehydrated.program[i]->toString() != file.program[i]->toString()
+            || rehydrated.program[i]->getLine() != file.program[i]->getLine()) {
+            std::cerr << "ERROR: Rehydrated statement differs:\n"
+                      << rehydrated.program[i]->toString() << "\nexpected:\n"
+                      << file.program[i]->toString() << '\n';
+            return false;
+        }
+    }
+
+    // Mapped from a file, it is read the same way
+    const std::filesystem::path path = std::filesystem::temp_directory_path()
+        / ("manganese_ast_encoding" + std::string(parser::EncodedFile::FILE_EXTENSION));
+    std::ofstream(path, std::ios::binary).write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    const std::optional<parser::EncodedFile> mapped = parser::EncodedFile::open(path.string());
+    std::filesystem::remove(path);
+    if (!mapped || mapped->data() != decoded->data() || mapped->name(function) != "area") {
+        std::cerr << "ERROR: The mapped file should read as the encoded bytes did\n";
+        return false;
+    }
+
+    // Anything malformed is turned away when it is loaded
+    std::vector<char> truncated(encoded.begin(), encoded.end() - 4);
+    std::vector<char> badVersion = encoded;
+    badVersion[4] ^= 1;
+    std::vector<char> badChild = encoded;  // With the function's first child pointing at the root
+    auto readWord = [&](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, encoded.data() + offset, sizeof(value));
+        return value;
+    };
+    const uint32_t root = 0, firstChild = readWord(readWord(24) + 24 * function + 8);
+    std::memcpy(badChild.data() + readWord(32) + 4 * firstChild, &root, sizeof(root));
+    if (parser::EncodedFile::fromBytes(std::move(truncated)) || parser::EncodedFile::fromBytes(std::move(badVersion))
+        || parser::EncodedFile::fromBytes(std::move(badChild))) {
+        std::cerr << "ERROR: A malformed encoded file should be rejected\n";
+        return false;
+    }
+    return true;
+}
+
 static bool miscTests() {
     std::string expression = "let x = aggregate{1, \"asdf\", 3.1f32};";
     ast::Block x = getParserResults(expression);
@@ -595,13 +1558,14 @@ void runParserTests(TestRunner& runner) {
     runner.runTest("Assignment Expressions", testAssignmentExpressions);
     runner.runTest("Prefix Operators", testPrefixOperators);
     runner.runTest("Parenthesized Expressions", testParenthesizedExpressions);
+    runner.runTest("Parse From Token Array", testParseFromTokenArray);
     runner.runTest("Address and Dereference Operators", testPointerOperators);
     runner.runTest("Typed Variable Declaration", testTypedVariableDeclaration);
     runner.runTest("Postfix Operators", testPostfixOperators);
     runner.runTest("Bitwise Operators", testBitwiseOperators);
     runner.runTest("Aggregate Declaration and Instantiation", testAggregateDeclarationAndInstantiation);
     runner.runTest("Function Declaration and Call", testFunctionDeclarationAndCall);
-    runner.runTest("Loops", testLoops);
+    runner.runTest("Loops", testLoops, {.arenaBytes = 16 * 1024});
     runner.runTest("If/Elif/Else Statements", testIfElseStatements);
     runner.runTest("Enum Declaration Statement", testEnumDeclarationStatement);
     runner.runTest("Switch Statement", testSwitchStatement);
@@ -609,9 +1573,32 @@ void runParserTests(TestRunner& runner) {
     runner.runTest("Generics", testGenerics);
     runner.runTest("Imports and Type Aliases", testImportsAndAliases);
     runner.runTest("Parsing from file", testParseFromFile);
+    runner.runTest("Arena Reset", testArenaReset);
+    runner.runTest("Arena Rewind", testArenaRewind);
+    runner.runTest("Arena Statistics", testArenaStatistics);
+    runner.runTest("Shared Chunk Pool", testSharedChunkPool);
+    runner.runTest("Flat Map", testFlatMap);
+    runner.runTest("Symbol Table Scoping", testSymbolTableScoping);
+    runner.runTest("Recorded Scopes", testRecordedScopes);
+    runner.runTest("Type Interning", testTypeInterning);
+    runner.runTest("Generic Specialization", testGenericSpecialization);
+    runner.runTest("Aggregate Layout", testAggregateLayout);
+    runner.runTest("Constant Evaluation", testConstantEvaluation);
+    runner.runTest("Parallel Semantic Checking", testParallelSemanticChecking);
+    runner.runTest("Type Compatibility Diagnostics", testTypeCompatibilityDiagnostics);
+    runner.runTest("Switch Analysis", testSwitchAnalysis);
     runner.runTest("Redundant Semicolons", testRedundantSemicolons);
     runner.runTest("Sizeof, Typeof & Alignof", testSizeofTypeofAlignof);
     runner.runTest("Nested Blocks", testNestedBlocks);
+    runner.runTest("Constant Folding", testConstantFolding,
+                   {.time = std::chrono::milliseconds(500), .arenaBytes = 2 * 1024 * 1024});
+    runner.runTest("Number Arithmetic", testNumberArithmetic);
+    runner.runTest("128-bit Integers", test128BitIntegers);
+    runner.runTest("Flat AST", testFlatAST);
+    runner.runTest("Streaming Printers", testStreamingPrinters,
+                   {.time = std::chrono::milliseconds(250), .arenaBytes = 256 * 1024});
+    runner.runTest("AST Encoding", testASTEncoding, {.time = std::chrono::milliseconds(100), .arenaBytes = 32 * 1024});
+    runner.runTest("Module Interfaces", testModuleInterfaces);
     runner.runTest("Miscellaneous Tests", miscTests);
 }
 }  // namespace tests
@@ -1,9 +1,21 @@
 #include "testrunner.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <core.hpp>
+#include <exception>
+#include <format>
 #include <io/logging.hpp>
 #include <iostream>
+#include <latch>
+#include <mutex>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 constexpr float percentage(const int part, const int total) {
     return static_cast<float>(part) / static_cast<float>(total) * 100.0f;
@@ -11,18 +23,186 @@ constexpr float percentage(const int part, const int total) {
 
 namespace Manganese {
 namespace tests {
-void TestRunner::runTest(const std::string& testName, bool (*testFunction)()) {
-    std::cout << "Running test: " << testName << "...\n";
 
-    bool result = testFunction();
-    std::cout << (result ? GREEN : RED) << std::format("Test '{}' {}", testName, (result ? "PASSED" : "FAILED"))
-              << RESET << "\n";
+namespace {
 
-    if (result) {
-        ++passed;
-    } else {
-        ++failed;
-        failedTests += testName + '\n';
+thread_local mnstl::chunk_allocator* currentArena = nullptr;
+thread_local std::string* capturedOutput = nullptr;  // Where the running test's output goes, if it is being kept
+
+/**
+ * @brief A stream buffer that keeps what a test writes (see capturedOutput), and passes anything else on to the
+ * stream's own buffer, one write at a time
+ */
+class OutputRouter : public std::streambuf {
+   private:
+    std::streambuf* original;
+    std::mutex& mutex;
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) { return traits_type::not_eof(c); }
+        const char character = traits_type::to_char_type(c);
+        return xsputn(&character, 1) == 1 ? c : traits_type::eof();
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (capturedOutput) {
+            capturedOutput->append(s, static_cast<size_t>(n));
+            return n;
+        }
+        std::scoped_lock lock(mutex);
+        return original->sputn(s, n);
+    }
+    int sync() override {
+        if (capturedOutput) { return 0; }
+        std::scoped_lock lock(mutex);
+        return original->pubsync();
+    }
+
+   public:
+    OutputRouter(std::streambuf* _original, std::mutex& _mutex) : original(_original), mutex(_mutex) {}
+    std::streambuf* target() const noexcept { return original; }
+};
+
+/**
+ * @brief Routes std::cout and std::cerr through OutputRouters for as long as it exists
+ */
+class OutputCapture {
+   private:
+    std::mutex mutex;
+    OutputRouter out, err;
+
+   public:
+    OutputCapture() : out(std::cout.rdbuf(), mutex), err(std::cerr.rdbuf(), mutex) {
+        std::cout.rdbuf(&out);
+        std::cerr.rdbuf(&err);
+    }
+    ~OutputCapture() {
+        std::cout.rdbuf(out.target());
+        std::cerr.rdbuf(err.target());
+    }
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+};
+
+struct Outcome {
+    bool passed = false;
+    double seconds = 0;
+    size_t arenaBytes = 0;
+    std::string output;  // If it was kept
+};
+
+Outcome run(bool (*function)(), const TestBudget& budget, double budgetScale, bool keepOutput) {
+    Outcome outcome;
+    mnstl::chunk_allocator arena;
+    currentArena = &arena;
+    capturedOutput = keepOutput ? &outcome.output : nullptr;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        outcome.passed = function();
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: Uncaught exception: " << e.what() << '\n';
+    }
+    outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    outcome.arenaBytes = arena.stats().high_water_mark;
+
+    const double timeLimit = std::chrono::duration<double>(budget.time).count() * budgetScale;
+    if (timeLimit > 0 && outcome.seconds > timeLimit) {
+        std::cerr << std::format("ERROR: Took {:.3f} ms, over the budget of {:.3f} ms\n", outcome.seconds * 1e3,
+                                 timeLimit * 1e3);
+        outcome.passed = false;
+    }
+    if (budget.arenaBytes && outcome.arenaBytes > budget.arenaBytes) {
+        std::cerr << std::format("ERROR: Used {} bytes of arena, over the budget of {}\n", outcome.arenaBytes,
+                                 budget.arenaBytes);
+        outcome.passed = false;
+    }
+    capturedOutput = nullptr;
+    currentArena = nullptr;
+    return outcome;
+}
+
+}  // namespace
+
+mnstl::chunk_allocator& testArena() noexcept {
+    if (!currentArena) { ASSERT_UNREACHABLE("testArena() is only available while a test is running"); }
+    return *currentArena;
+}
+
+void TestRunner::runTest(const std::string& testName, bool (*testFunction)(), TestBudget budget) {
+    queued.push_back(Test{.name = testName, .function = testFunction, .budget = budget});
+}
+
+void TestRunner::runQueued() {
+    const std::vector<Test> tests = std::exchange(queued, {});
+    auto record = [&](const Test& test, Outcome& outcome) {
+        std::cout << outcome.output
+                  << (outcome.passed ? GREEN : RED)
+                  << std::format("Test '{}' {} ({:.3f} ms)", test.name, (outcome.passed ? "PASSED" : "FAILED"),
+                                 outcome.seconds * 1e3)
+                  << RESET << "\n";
+        timings.push_back(Timing{.name = test.name, .seconds = outcome.seconds, .arenaBytes = outcome.arenaBytes});
+        if (outcome.passed) {
+            ++passed;
+        } else {
+            ++failed;
+            failedTests += test.name + '\n';
+        }
+    };
+
+    if (jobs == 1 || tests.size() <= 1) {
+        for (const Test& test : tests) {
+            std::cout << "Running test: " << test.name << "...\n";
+            Outcome outcome = run(test.function, test.budget, budgetScale, false);
+            record(test, outcome);
+        }
+        return;
+    }
+
+    // Time budgets are wall-clock, so a test that shares the machine with others could run over its budget only
+    // because of them. Tests with one are kept out of the parallel batch and run one at a time once it is over.
+    std::vector<size_t> parallel, serial;
+    for (size_t i = 0; i < tests.size(); ++i) {
+        (budgetScale > 0 && tests[i].budget.time.count() > 0 ? serial : parallel).push_back(i);
+    }
+
+    // Each worker takes the next test left; this thread writes each one out once it (and those before it) are done
+    std::vector<Outcome> outcomes(tests.size());
+    std::vector<bool> done(tests.size(), false);
+    std::mutex doneMutex;
+    std::condition_variable finished;
+    std::atomic<size_t> next = 0;
+    OutputCapture capture;
+    auto runAndStore = [&](size_t i) {
+        Outcome outcome = run(tests[i].function, tests[i].budget, budgetScale, true);
+        {
+            std::scoped_lock lock(doneMutex);
+            outcomes[i] = std::move(outcome);
+            done[i] = true;
+        }
+        finished.notify_all();
+    };
+    const size_t numWorkers = std::max<size_t>(std::min(jobs, parallel.size()), 1);
+    std::latch workersDone(static_cast<std::ptrdiff_t>(numWorkers));
+    auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < parallel.size();) {
+            runAndStore(parallel[i]);
+        }
+        workersDone.count_down();
+    };
+    std::vector<std::jthread> workers;
+    workers.reserve(numWorkers + 1);
+    for (size_t i = 0; i < numWorkers; ++i) { workers.emplace_back(worker); }
+    workers.emplace_back([&]() {
+        workersDone.wait();
+        for (size_t i : serial) { runAndStore(i); }
+    });
+    for (size_t i = 0; i < tests.size(); ++i) {
+        {
+            std::unique_lock lock(doneMutex);
+            finished.wait(lock, [&] { return done[i]; });
+        }
+        std::cout << "Running test: " << tests[i].name << "...\n";
+        record(tests[i], outcomes[i]);
     }
 }
 
@@ -33,6 +213,18 @@ void TestRunner::printSummary() noexcept {
     std::cout << GREEN << std::format("Passed: {}/{} ({:.2f}%)\n", passed, total, percentage(passed, total)) << RESET;
     std::cout << RED << std::format("Failed: {}/{} ({:.2f}%)\n", failed, total, percentage(failed, total)) << RESET;
     std::cout << PINK << "Total: " << total << RESET << '\n';
+
+    // The slowest tests are where to look first when the suite gets slower
+    std::vector<Timing> slowest = timings;
+    const size_t shown = std::min<size_t>(slowest.size(), 5);
+    std::ranges::partial_sort(slowest, slowest.begin() + static_cast<std::ptrdiff_t>(shown), std::ranges::greater{},
+                              &Timing::seconds);
+    std::cout << PINK << "Slowest Tests" << RESET << '\n';
+    for (size_t i = 0; i < shown; ++i) {
+        std::cout << std::format("{:>10.3f} ms {:>10} KiB  {}\n", slowest[i].seconds * 1e3,
+                                 (slowest[i].arenaBytes + 1023) / 1024, slowest[i].name);
+    }
+
     if (failed > 0) {
         std::cout << PINK << "Failed Tests" << RESET << '\n';
         std::cout << RED << failedTests << RESET;
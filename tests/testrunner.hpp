@@ -1,24 +1,73 @@
 #ifndef MANGANESE_TESTS_TEST_RUNNER_HPP
 #define MANGANESE_TESTS_TEST_RUNNER_HPP
 
+#include <chrono>
 #include <core.hpp>
+#include <cstddef>
+#include <mnstl/chunk_allocator.hxx>
 #include <string>
+#include <vector>
 
 namespace Manganese {
 namespace tests {
 
+/**
+ * @brief Limits a test must stay within to pass, so that a performance regression fails like a wrong answer does
+ * @details Zero means no limit. `time` is scaled by TestRunner's budget scale (e.g. for sanitizer builds). It is
+ * wall-clock time, so tests with a time budget are not run alongside others (see TestRunner).
+ */
+struct TestBudget {
+    std::chrono::milliseconds time{0};
+    size_t arenaBytes = 0;  // The most the test's arena (see testArena()) may hold at once
+};
+
+/**
+ * @brief The arena of the test running on this thread, a fresh one per test
+ */
+mnstl::chunk_allocator& testArena() noexcept;
+
+/**
+ * @brief Runs tests on a few threads, timing each one and checking it against its budget
+ * @details Tests are queued by runTest() and run by runQueued(), so that a suite's tests can run at the same time.
+ * While they do, what each thread writes to std::cout and std::cerr is kept, and written out test by test in the order
+ * the tests were queued, so the output reads the same however many threads there are. Tests with a time budget run
+ * one at a time after the rest, so that other tests cannot slow them down past it.
+ */
 class TestRunner {
    private:
+    struct Test {
+        std::string name;
+        bool (*function)();
+        TestBudget budget;
+    };
+    struct Timing {
+        std::string name;
+        double seconds;
+        size_t arenaBytes;
+    };
+
+    size_t jobs;
+    double budgetScale;
+    std::vector<Test> queued;
+    std::vector<Timing> timings;
     int passed = 0;
     int failed = 0;
     std::string failedTests = "";  // Keep track of failed tests for debugging
 
    public:
-    void runTest(const std::string& testName, bool (*testFunction)());
+    /**
+     * @param jobs_ How many tests to run at once (1 runs them one by one, with their output written as it happens)
+     * @param budgetScale_ What to multiply each test's time budget by (0 to not check time budgets at all)
+     */
+    explicit TestRunner(size_t jobs_ = 1, double budgetScale_ = 1) :
+        jobs(jobs_ ? jobs_ : 1), budgetScale(budgetScale_) {}
+
+    void runTest(const std::string& testName, bool (*testFunction)(), TestBudget budget = {});
+    void runQueued();
     void printSummary() noexcept;
     constexpr bool allTestsPassed() const noexcept { return failed == 0; }
 };
 }  // namespace tests
 }  // namespace Manganese
 
-#endif  // MANGANESE_TESTS_TEST_RUNNER_HPP
\ No newline at end of file
+#endif  // MANGANESE_TESTS_TEST_RUNNER_HPP
@@ -8,6 +8,7 @@ namespace Manganese {
 namespace tests {
 void runLexerTests(TestRunner& runner);
 void runParserTests(TestRunner& runner);
+void runDriverTests(TestRunner& runner);
 void runSemanticAnalysisTests(TestRunner& runner);
 void runCodeGenerationTests(TestRunner& runner);
 